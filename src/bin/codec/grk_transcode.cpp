@@ -58,6 +58,14 @@ static void printUsage(const char* prog)
           "  -R, --max-res <N>       Keep at most N resolution levels (0 = all)\n"
           "  -p, --progression <P>   Reorder to progression P\n"
           "                          (LRCP, RLCP, RPCL, PCRL, CPRL)\n"
+          "  -H, --ht                Recode Part 1 code blocks with the HT block coder\n"
+          "                          (HTJ2K), keeping wavelet coefficients, quantization,\n"
+          "                          tiling and precincts; layers are merged into one\n"
+          "  -T, --target-size <N>   Truncate Part 1 code blocks to a code stream of at\n"
+          "                          most N bytes, without decoding or coding them again;\n"
+          "                          layers are merged into one\n"
+          "  -C, --crop <x0,y0,x1,y1> Keep only the tiles that intersect this region of\n"
+          "                          the image, copied without decoding\n"
           "  -h, --help              Print this help message\n"
           "  -v, --version           Print library version\n",
           prog);
@@ -268,6 +276,9 @@ int main(int argc, char* argv[])
   uint16_t maxLayers = 0;
   uint8_t maxRes = 0;
   GRK_PROG_ORDER progOrder = GRK_PROG_UNKNOWN;
+  bool recodeHT = false;
+  uint64_t targetSize = 0;
+  uint32_t crop[4] = {};
 
   for(int i = 1; i < argc; ++i)
   {
@@ -296,6 +307,20 @@ int main(int argc, char* argv[])
         return 1;
       }
     }
+    else if(strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--ht") == 0)
+      recodeHT = true;
+    else if((strcmp(argv[i], "-T") == 0 || strcmp(argv[i], "--target-size") == 0) &&
+            i + 1 < argc)
+      targetSize = strtoull(argv[++i], nullptr, 10);
+    else if((strcmp(argv[i], "-C") == 0 || strcmp(argv[i], "--crop") == 0) && i + 1 < argc)
+    {
+      if(sscanf(argv[++i], "%u,%u,%u,%u", crop, crop + 1, crop + 2, crop + 3) != 4 ||
+         crop[2] <= crop[0] || crop[3] <= crop[1])
+      {
+        fprintf(stderr, "Error: invalid crop region '%s'\n", argv[i]);
+        return 1;
+      }
+    }
     else if(strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
     {
       printUsage(argv[0]);
@@ -344,7 +369,8 @@ int main(int argc, char* argv[])
   }
 
   bool hasModifications = writeTlm || writePlt || writeSop || writeEph || maxLayers > 0 ||
-                          maxRes > 0 || progOrder != GRK_PROG_UNKNOWN;
+                          maxRes > 0 || progOrder != GRK_PROG_UNKNOWN || recodeHT ||
+                          targetSize > 0 || crop[2] > 0;
 
   /* JP2/JPH -> J2K: strip boxes, output raw codestream */
   if(inputFmt == TFMT_CONTAINER && outputFmt == TFMT_CODESTREAM)
@@ -406,6 +432,12 @@ int main(int argc, char* argv[])
     cparams.max_layers_transcode = maxLayers;
     cparams.max_res_transcode = maxRes;
     cparams.transcode_prog_order = progOrder;
+    cparams.transcode_ht = recodeHT;
+    cparams.transcode_target_size = targetSize;
+    cparams.transcode_crop_x0 = crop[0];
+    cparams.transcode_crop_y0 = crop[1];
+    cparams.transcode_crop_x1 = crop[2];
+    cparams.transcode_crop_y1 = crop[3];
 
     grk_stream_params dstStreamParams{};
     safe_strcpy(dstStreamParams.file, tmpPath.c_str());
@@ -479,6 +511,12 @@ int main(int argc, char* argv[])
   cparams.max_layers_transcode = maxLayers;
   cparams.max_res_transcode = maxRes;
   cparams.transcode_prog_order = progOrder;
+  cparams.transcode_ht = recodeHT;
+  cparams.transcode_target_size = targetSize;
+  cparams.transcode_crop_x0 = crop[0];
+  cparams.transcode_crop_y0 = crop[1];
+  cparams.transcode_crop_x1 = crop[2];
+  cparams.transcode_crop_y1 = crop[3];
 
   grk_stream_params dstStreamParams{};
   safe_strcpy(dstStreamParams.file, outputFile);
@@ -63,6 +63,7 @@ using namespace grk;
 #include "grk_string.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "GrkCompress.h"
+#include "BatchPipeline.h"
 #include "Messenger.h"
 #include "XYZTransform.h"
 
@@ -114,6 +115,9 @@ static uint64_t pluginCompressCallback(grk_plugin_compress_user_callback_info* i
 
 grk_img_fol img_fol_plugin, out_fol_plugin;
 
+// pixels in the last image compressed by this thread: each batch lane is its own thread
+thread_local uint64_t compressedPixels = 0;
+
 static void compress_help_display(void)
 {
   fprintf(stdout,
@@ -279,6 +283,16 @@ static grk_image* loadInputImage(const char* filename, grk_cparameters* paramete
       return nullptr;
     fmt = (GRK_SUPPORTED_FILE_FMT)f;
   }
+  // only PNM and RAW readers can leave their samples in a memory-mapped file
+  if(fmt != GRK_FMT_PXM && fmt != GRK_FMT_RAW && fmt != GRK_FMT_RAWL)
+    parameters->pixel_source.file[0] = 0;
+  // the compressor reads mapped samples on the full resolution grid only
+  if(parameters->pixel_source.file[0] &&
+     (parameters->subsampling_dx != 1 || parameters->subsampling_dy != 1))
+  {
+    spdlog::warn("{} cannot be memory mapped with subsampling: reading it instead", filename);
+    parameters->pixel_source.file[0] = 0;
+  }
   switch(fmt)
   {
     case GRK_FMT_PGX: {
@@ -371,6 +385,8 @@ int GrkCompress::main(int argc, const char** argv, grk_image* in_image, grk_stre
     {
       auto mct = initParams.parameters.mct;
       auto rate_control_algorithm = initParams.parameters.rate_control_algorithm;
+      // frames are held in memory by the MJ2 writer, so --mmap-input does not apply
+      initParams.parameters.pixel_source.file[0] = 0;
       std::string mj2OutputPath = initParams.parameters.outfile;
       grk_object* codec = nullptr;
       bool first = true;
@@ -478,6 +494,7 @@ int GrkCompress::main(int argc, const char** argv, grk_image* in_image, grk_stre
 
     // cache certain settings
     grk_cparameters parametersCache = initParams.parameters;
+    BatchPipeline pipeline(initParams.batchLanes, initParams.parameters.num_threads);
     auto start = std::chrono::high_resolution_clock::now();
     for(uint32_t i = 0; i < initParams.parameters.repeats; ++i)
     {
@@ -494,21 +511,16 @@ int GrkCompress::main(int argc, const char** argv, grk_image* in_image, grk_stre
       }
       else
       {
-        for(const auto& entry :
-            std::filesystem::directory_iterator(initParams.inputFolder.imgdirpath))
-        {
-          initParams.parameters = parametersCache;
-          if(compress(entry.path().filename().string(), &initParams) == 1)
-          {
-            spdlog::info("Compressed file {}", initParams.parameters.outfile);
-            numCompressedFiles++;
-          }
-        }
+        numCompressedFiles += batchCompress(&initParams, parametersCache, pipeline);
       }
     }
     auto finish = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = finish - start;
-    if(numCompressedFiles)
+    if(initParams.inputFolder.set_imgdir)
+    {
+      pipeline.report("compress", elapsed);
+    }
+    else if(numCompressedFiles)
     {
       spdlog::info("compress time: {} {}", (elapsed.count() * 1000) / (double)numCompressedFiles,
                    numCompressedFiles > 1 ? "ms/image" : "ms");
@@ -524,6 +536,27 @@ cleanup:
   return success;
 }
 
+uint32_t GrkCompress::batchCompress(CompressInitParams* initParams,
+                                    const grk_cparameters& parameters, BatchPipeline& pipeline)
+{
+  // each lane compresses with its own copy of the settings; the folders, and the
+  // comments and MCT data the settings point to, are shared
+  std::vector<grk_cparameters> laneParameters(pipeline.numLanes());
+
+  return pipeline.run(BatchPipeline::listFiles(initParams->inputFolder.imgdirpath),
+                      [&](uint32_t lane, const std::string& fileName, uint64_t& pixels) {
+                        auto laneParams = &laneParameters[lane];
+                        *laneParams = parameters;
+                        int rc = compress(fileName, initParams, laneParams);
+                        if(rc == 1)
+                        {
+                          spdlog::info("Compressed file {}", laneParams->outfile);
+                          pixels = compressedPixels;
+                        }
+                        return rc;
+                      });
+}
+
 int GrkCompress::shmBatchCompress(CompressInitParams* initParams)
 {
   using namespace grk_plugin;
@@ -967,6 +1000,8 @@ GrkRC GrkCompress::parseCommandLine(int argc, const char* argv[], CompressInitPa
   auto batchSrcOpt = app.add_option("-y,--batch-src", batchSrc,
                                     "Source image directory OR comma separated list of compression "
                                     "settings for shared memory interface");
+  auto batchLanesOpt = app.add_option("--batch-lanes", initParams->batchLanes,
+                                      "Number of --batch-src images compressed concurrently");
   auto mctOpt = app.add_option("-Y,--mct", mct, "Multi component transform")->default_val(0);
   bool verbose = false;
   app.add_flag("-v,--verbose", verbose, "Verbose output");
@@ -978,6 +1013,9 @@ GrkRC GrkCompress::parseCommandLine(int argc, const char* argv[], CompressInitPa
   bool xyzTransform;
   auto xyzOpt = app.add_flag("--xyz", xyzTransform,
                              "Apply Rec.709 RGB to DCI X'Y'Z' colour transform before compression");
+  bool mmapInput;
+  auto mmapInputOpt = app.add_flag("--mmap-input", mmapInput,
+                                   "Memory map binary PNM / RAW input and fill tiles directly");
 
   app.set_help_flag("-h", "Show abreviated usage");
   app.set_version_flag("-V,--version", grk_version(), "Show version");
@@ -1032,6 +1070,26 @@ GrkRC GrkCompress::parseCommandLine(int argc, const char* argv[], CompressInitPa
     parameters->progressive_rate_control = true;
   if(xyzOpt->count() > 0)
     parameters->apply_xyz_transform = true;
+  if(mmapInputOpt->count() > 0)
+  {
+    if(inputFileOpt->count() == 0 && batchSrcOpt->count() == 0)
+    {
+      spdlog::error("--mmap-input requires an input file or directory");
+      return GrkRCFail;
+    }
+    // colour transforms rewrite the samples, which a read-only mapping can not hold
+    if(parameters->apply_icc || parameters->apply_xyz_transform)
+    {
+      spdlog::warn("--mmap-input cannot be combined with colour transforms: "
+                   "reading the input instead");
+    }
+    else
+    {
+      // non-empty file marks the request; each input file name is filled in at load time
+      safe_strcpy(parameters->pixel_source.file,
+                  inputFileOpt->count() > 0 ? inputFile.c_str() : batchSrc.c_str());
+    }
+  }
   if(repetitionsOpt->count() > 0)
     parameters->repeats = repetitions;
   if(rateControlAlgorithmOpt->count() > 0)
@@ -1995,6 +2053,8 @@ GrkRC GrkCompress::parseCommandLine(int argc, const char* argv[], CompressInitPa
     initParams->license_ = license;
   }
 
+  if(batchLanesOpt->count() > 0 && !inputFolder->set_imgdir)
+    spdlog::warn("--batch-lanes is ignored without --batch-src");
   if(inputFolder->set_imgdir)
   {
     if(!(parameters->infile[0] == 0))
@@ -2104,6 +2164,9 @@ static uint64_t pluginCompressCallback(grk_plugin_compress_user_callback_info* i
   bool createdImage = false;
   std::string outfile;
   std::string temp_ofname;
+  // --mmap-input: readers that can map the input keep pixel_source.file, others clear it
+  std::string mapRequest = parameters->pixel_source.file;
+  parameters->pixel_source.file[0] = 0;
 
   bool hasStreamParams = info->stream_params.file[0] || info->stream_params.buf;
   // get output file
@@ -2151,6 +2214,8 @@ static uint64_t pluginCompressCallback(grk_plugin_compress_user_callback_info* i
       }
     }
     /* decode the source image */
+    if(!mapRequest.empty())
+      safe_strcpy(parameters->pixel_source.file, info->input_file_name);
     image = loadInputImage<int32_t>(info->input_file_name, info->compressor_parameters);
     if(!image)
     {
@@ -2324,11 +2389,13 @@ static uint64_t pluginCompressCallback(grk_plugin_compress_user_callback_info* i
     spdlog::error("failed to compress image: grk_compress");
     goto cleanup;
   }
+  compressedPixels = (uint64_t)(image->x1 - image->x0) * (image->y1 - image->y0);
 
 cleanup:
   grk_object_unref(codec);
   if(createdImage)
     grk_object_unref(&image->obj);
+  safe_strcpy(parameters->pixel_source.file, mapRequest.c_str());
   if(!compressedBytes)
   {
     spdlog::error("failed to compress image");
@@ -2347,30 +2414,36 @@ cleanup:
 // returns 0 if failed, 1 if succeeded,
 // and 2 if file is not suitable for compression
 int GrkCompress::compress(const std::string& inputFile, CompressInitParams* initParams)
+{
+  return compress(inputFile, initParams, &initParams->parameters);
+}
+
+int GrkCompress::compress(const std::string& inputFile, CompressInitParams* initParams,
+                          grk_cparameters* parameters)
 {
   // clear for next file compress
-  initParams->parameters.write_capture_resolution_from_file = false;
+  parameters->write_capture_resolution_from_file = false;
   // don't reset format if reading from STDIN
-  if(initParams->parameters.infile[0])
-    initParams->parameters.decod_format = GRK_FMT_UNK;
+  if(parameters->infile[0])
+    parameters->decod_format = GRK_FMT_UNK;
   if(initParams->inputFolder.set_imgdir)
   {
     if(nextFile(inputFile, &initParams->inputFolder,
                 initParams->outFolder.set_imgdir ? &initParams->outFolder
                                                  : &initParams->inputFolder,
-                &initParams->parameters))
+                parameters))
     {
       return 2;
     }
   }
   grk_plugin_compress_user_callback_info callbackInfo;
   memset(&callbackInfo, 0, sizeof(grk_plugin_compress_user_callback_info));
-  callbackInfo.compressor_parameters = &initParams->parameters;
+  callbackInfo.compressor_parameters = parameters;
   callbackInfo.image = initParams->in_image;
   if(initParams->stream_)
     callbackInfo.stream_params = *initParams->stream_;
-  callbackInfo.output_file_name = initParams->parameters.outfile;
-  callbackInfo.input_file_name = initParams->parameters.infile;
+  callbackInfo.output_file_name = parameters->outfile;
+  callbackInfo.input_file_name = parameters->infile;
 
   uint64_t compressedBytes = pluginCompressCallback(&callbackInfo);
   if(initParams->stream_)
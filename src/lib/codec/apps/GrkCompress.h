@@ -27,12 +27,16 @@ struct Messenger;
 
 namespace grk
 {
+class BatchPipeline;
+
 struct CompressInitParams
 {
   CompressInitParams();
   ~CompressInitParams();
   bool initialized = false;
   bool usePlugin = true;
+  // concurrent lanes for a --batch-src directory: 0 picks them from the thread count
+  uint32_t batchLanes = 0;
   grk_cparameters parameters = {};
   char pluginPath[GRK_PATH_LEN];
   grk_img_fol inputFolder;
@@ -56,6 +60,11 @@ private:
   GrkRC pluginMain(int argc, const char* argv[], CompressInitParams* initParams);
   GrkRC parseCommandLine(int argc, const char* argv[], CompressInitParams* initParams);
   int compress(const std::string& inputFile, CompressInitParams* initParams);
+  int compress(const std::string& inputFile, CompressInitParams* initParams,
+               grk_cparameters* parameters);
+  // compresses every file in the batch directory; returns the number compressed
+  uint32_t batchCompress(CompressInitParams* initParams, const grk_cparameters& parameters,
+                         BatchPipeline& pipeline);
 
   grk_plugin::Messenger* messenger_;
 };
@@ -34,6 +34,7 @@
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <memory>
 
 #include "grk_apps_config.h"
 #include "common.h"
@@ -55,6 +56,7 @@
 #endif
 #include "grk_string.h"
 #include "GrkDecompress.h"
+#include "BatchPipeline.h"
 #include "codestream/CodeStreamLimits.h"
 #include "Messenger.h"
 
@@ -111,8 +113,8 @@ static void decompress_help_display(void)
 }
 GrkDecompress::GrkDecompress()
     : storeToDisk(true), incrementalWriteActive_(false), incrementalBandFormat_(nullptr),
-      incrementalBandRowsWritten_(0), incrementalBandRowsExpected_(0), imageFormat(nullptr),
-      messenger_(nullptr)
+      incrementalBandRowsWritten_(0), incrementalBandRowsExpected_(0), decompressedPixels_(0),
+      imageFormat(nullptr), messenger_(nullptr)
 {}
 GrkDecompress::~GrkDecompress(void)
 {
@@ -395,13 +397,13 @@ GrkRC GrkDecompress::parseCommandLine(int argc, const char* argv[],
   CLI::App cmd("grk_decompress command line", grk_version());
 
   std::string outDir, compression, decodeRegion, pluginPathStr, inputFile, outputFile, outFor,
-      precision, rescale, logfile, inDir, components;
+      precision, rescale, logfile, inDir, components, pyramid, tiffTileSize;
   auto& compIndices = initParams->compIndices;
   uint32_t repetitions = 0, numThreads = 0, kernelBuildOptions = 0,
            compressionLevel = std::numeric_limits<uint32_t>::max(), disableRandomAccess = 0,
            tile = 0, duration = 0;
-  uint8_t reduce = 0;
-  uint16_t layer = 0;
+  uint8_t reduce = 0, targetPrecision = 0;
+  uint16_t layer = 0, componentGroup = 0;
   int32_t deviceId = 0;
   bool forceRgb = false, splitPnm = false, upsample = false, xml = false, applyPalette = false;
 
@@ -442,12 +444,33 @@ GrkRC GrkDecompress::parseCommandLine(int argc, const char* argv[],
                      "Last entry applies to remaining components. Runs before -p.");
   auto reduceOpt = cmd.add_option("-r,--reduce", reduce, "Number of final resolutions to skip")
                        ->check(CLI::Range(0, GRK_MAXRLVLS - 1));
+  auto targetPrecisionOpt =
+      cmd.add_option("--target-precision", targetPrecision,
+                     "Skip the code block bit planes that cannot change output at this "
+                     "precision (within one code), e.g. 8 for previews of 16-bit images")
+          ->check(CLI::Range(1, GRK_MAX_SUPPORTED_IMAGE_PRECISION));
+  auto componentGroupOpt =
+      cmd.add_option("--component-group", componentGroup,
+                     "Number of components decompressed together, to bound the working set "
+                     "of images with many bands");
+  auto pyramidOpt =
+      cmd.add_option("--pyramid", pyramid,
+                     "Comma-separated reductions (e.g. '1,2,3') to emit from the same "
+                     "decompress as overview levels; TIFF output stores them as "
+                     "reduced-resolution images after the full one, and must not be "
+                     "post-processed (precision, colour or palette conversion)");
+  auto tiffTileSizeOpt =
+      cmd.add_option("--tiff-tile-size", tiffTileSize,
+                     "Write TIFF output as tiles of W[,H] pixels (multiples of 16; H defaults "
+                     "to W), compressed concurrently; overview levels are tiled too");
   auto splitPnmOpt = cmd.add_flag("-s,--split-pnm", splitPnm, "Split PNM");
   auto tileOpt = cmd.add_option("-t,--tile-index", tile, "Index of tile to decompress");
   auto upsampleOpt = cmd.add_flag("-u,--upsample", upsample, "Upsample");
   cmd.add_option("-W,--log-file", logfile, "Log file path");
   auto xmlOpt = cmd.add_flag("-X,--xml", xml, "XML metadata");
   auto inDirOpt = cmd.add_option("-y,--batch-src", inDir, "Input source");
+  auto batchLanesOpt = cmd.add_option("--batch-lanes", initParams->batchLanes,
+                                      "Number of --batch-src images decompressed concurrently");
   auto durationOpt = cmd.add_option("-z,--duration", duration, "Duration in seconds");
 
   cmd.set_help_flag("-h", "Show abreviated usage");
@@ -637,11 +660,74 @@ GrkRC GrkDecompress::parseCommandLine(int argc, const char* argv[],
     strcpy(inputFolder->imgdirpath, inDir.c_str());
     inputFolder->set_imgdir = true;
   }
+  else if(batchLanesOpt->count() > 0)
+  {
+    spdlog::warn("--batch-lanes is ignored without --batch-src");
+  }
 
   if(reduceOpt->count() > 0)
     parameters->core.reduce = reduce;
   if(layerOpt->count() > 0)
     parameters->core.layers_to_decompress = layer;
+  if(targetPrecisionOpt->count() > 0)
+    parameters->core.target_precision = targetPrecision;
+  if(componentGroupOpt->count() > 0)
+    parameters->core.component_group_size = componentGroup;
+  if(pyramidOpt->count() > 0)
+  {
+    std::istringstream iss(pyramid);
+    std::string token;
+    while(std::getline(iss, token, ','))
+    {
+      try
+      {
+        int val = std::stoi(token);
+        if(val < 1 || val > 31)
+        {
+          spdlog::error("Pyramid reduction {} out of range [1, 31]", val);
+          return GrkRCParseArgsFailed;
+        }
+        parameters->core.pyramid_reductions |= 1U << val;
+      }
+      catch(...)
+      {
+        spdlog::error("Invalid pyramid reduction: {}", token);
+        return GrkRCParseArgsFailed;
+      }
+    }
+  }
+  if(tiffTileSizeOpt->count() > 0)
+  {
+    uint32_t dims[2] = {0, 0};
+    std::istringstream iss(tiffTileSize);
+    std::string token;
+    uint32_t numDims = 0;
+    while(std::getline(iss, token, ','))
+    {
+      try
+      {
+        int val = numDims < 2 ? std::stoi(token) : 0;
+        if(val <= 0 || (val & 15))
+        {
+          spdlog::error("TIFF tile size {} must be a positive multiple of 16", token);
+          return GrkRCParseArgsFailed;
+        }
+        dims[numDims++] = (uint32_t)val;
+      }
+      catch(...)
+      {
+        spdlog::error("Invalid TIFF tile size: {}", tiffTileSize);
+        return GrkRCParseArgsFailed;
+      }
+    }
+    if(!numDims)
+    {
+      spdlog::error("Invalid TIFF tile size: {}", tiffTileSize);
+      return GrkRCParseArgsFailed;
+    }
+    parameters->output_tile_width = dims[0];
+    parameters->output_tile_height = numDims > 1 ? dims[1] : dims[0];
+  }
   if(componentsOpt->count() > 0)
   {
     std::istringstream iss(components);
@@ -804,11 +890,14 @@ int GrkDecompress::decompress(const std::string& fileName, DecompressInitParams*
   info.header_info.split_by_component = info.decompressor_parameters->split_by_component;
   info.header_info.single_tile_decompress = info.decompressor_parameters->single_tile_decompress;
 
+  decompressedPixels_ = 0;
   if(preProcess(&info))
   {
     grk_object_unref(info.codec);
     return 0;
   }
+  if(info.image)
+    decompressedPixels_ = (uint64_t)info.image->decompress_width * info.image->decompress_height;
   if(postProcess(&info))
   {
     grk_object_unref(info.codec);
@@ -1049,6 +1138,9 @@ bool GrkDecompress::writeInit(grk_plugin_decompress_callback_info* info)
   else if(cod_format == GRK_FMT_JPG || cod_format == GRK_FMT_PNG)
     compression_level = parameters->compression_level;
   auto fmt = info->format_private ? (IImageFormat*)info->format_private : imageFormat;
+  if(parameters->output_tile_width &&
+     !fmt->setTileSize(parameters->output_tile_width, parameters->output_tile_height))
+    spdlog::warn("Output format cannot store tiles; writing {} without them", outfileStr);
   if(!fmt->writeInit(info->image, outfileStr, compression_level,
                      info->decompressor_parameters->num_threads
                          ? info->decompressor_parameters->num_threads
@@ -1199,6 +1291,16 @@ int GrkDecompress::preProcess(grk_plugin_decompress_callback_info* info)
       goto cleanup;
     }
   }
+  // overview levels are stored as decompressed, so a TIFF whose full image is
+  // post-processed (precision, colour conversion, palette) cannot carry them
+  if(parameters->core.pyramid_reductions && info->codec && cod_format == GRK_FMT_TIF &&
+     !grk::isStreamOutput(outfile ? outfile : "") &&
+     !grk_image_is_post_process_no_op(info->image))
+  {
+    spdlog::error("--pyramid cannot be combined with precision, colour or palette conversion "
+                  "of TIFF output");
+    goto cleanup;
+  }
   // 3a. initialize writer before decompress so it's ready for incremental output.
   // Only call writeInit early when postProcess is a no-op, so we can write header
   // and enable incremental band writes.  When post-processing is needed, defer
@@ -1209,8 +1311,10 @@ int GrkDecompress::preProcess(grk_plugin_decompress_callback_info* info)
   incrementalBandFormat_ = nullptr;
   incrementalBandRowsWritten_ = 0;
   incrementalBandRowsExpected_ = 0;
+  // A decompress window streams too: the library only schedules the tile rows it
+  // crosses and clips each band to it, and the header carries the window's size.
   if(storeToDisk && !parameters->single_tile_decompress && !info->init_decompressors_func &&
-     grk_image_is_post_process_no_op(info->image) && parameters->dw_y1 == 0)
+     grk_image_is_post_process_no_op(info->image))
   {
     if(!writeInit(info))
       goto cleanup;
@@ -1428,6 +1532,32 @@ int GrkDecompress::postProcess(grk_plugin_decompress_callback_info* info)
       spdlog::error("Outfile {} not generated", outfileStr);
       goto cleanup;
     }
+    if(info->decompressor_parameters->core.pyramid_reductions && info->codec)
+    {
+      auto cod_format = info->cod_format != GRK_FMT_UNK ? info->cod_format
+                                                        : info->decompressor_parameters->cod_format;
+      if(cod_format == GRK_FMT_TIF && grk::isStreamOutput(outfileStr))
+      {
+        spdlog::warn("Overview levels cannot be appended to a TIFF stream");
+      }
+      else if(cod_format == GRK_FMT_TIF)
+      {
+#ifdef GROK_HAVE_LIBTIFF
+        grk_image* levels[32] = {};
+        for(uint8_t k = 1; k < 32; ++k)
+          levels[k] = grk_decompress_get_pyramid_image(info->codec, k);
+        if(!tiffAppendOverviews(outfileStr, levels, 32))
+        {
+          spdlog::error("Overview levels not written to {}", outfileStr);
+          goto cleanup;
+        }
+#endif
+      }
+      else
+      {
+        spdlog::warn("Overview levels are only stored in TIFF output");
+      }
+    }
   }
   failed = false;
 cleanup:
@@ -1631,6 +1761,7 @@ int GrkDecompress::main(int argc, const char* argv[])
       }
     }
 
+    BatchPipeline pipeline(initParams.batchLanes, initParams.parameters.num_threads);
     auto start = std::chrono::high_resolution_clock::now();
     for(uint32_t i = 0; i < initParams.parameters.repeats; ++i)
     {
@@ -1649,24 +1780,13 @@ int GrkDecompress::main(int argc, const char* argv[])
       }
       else
       {
-        auto path = initParams.inputFolder.imgdirpath;
-        auto count = std::count_if(
-            std::filesystem::directory_iterator(path), std::filesystem::directory_iterator{},
-            [&initParams, this](const auto& entry) {
-              return entry.is_regular_file() &&
-                     decompress(entry.path().filename().string(),
-                                const_cast<grk::DecompressInitParams*>(&initParams)) == 1;
-            });
-
-        if(count > std::numeric_limits<uint32_t>::max())
-        {
-          throw std::overflow_error("Count exceeds uint32_t range");
-        }
-
-        numDecompressed = static_cast<uint32_t>(count);
+        numDecompressed += batchDecompress(&initParams, pipeline);
       }
     }
-    printTiming(numDecompressed, std::chrono::high_resolution_clock::now() - start);
+    if(initParams.inputFolder.set_imgdir)
+      pipeline.report("decompress", std::chrono::high_resolution_clock::now() - start);
+    else
+      printTiming(numDecompressed, std::chrono::high_resolution_clock::now() - start);
   }
   catch([[maybe_unused]] const std::bad_alloc& ba)
   {
@@ -1679,6 +1799,46 @@ cleanup:
   return rc;
 }
 
+static void copyFolder(const grk_img_fol& src, grk_img_fol& dest)
+{
+  dest = src;
+  if(src.imgdirpath)
+  {
+    dest.imgdirpath = (char*)malloc(strlen(src.imgdirpath) + 1);
+    strcpy(dest.imgdirpath, src.imgdirpath);
+  }
+}
+
+uint32_t GrkDecompress::batchDecompress(DecompressInitParams* initParams, BatchPipeline& pipeline)
+{
+  // each lane decompresses with its own decompressor state, parameters and output
+  // format; the component indices and precision the parameters point to are shared
+  struct Lane
+  {
+    GrkDecompress decompressor;
+    DecompressInitParams initParams;
+  };
+  std::vector<std::unique_ptr<Lane>> lanes;
+  for(uint32_t i = 0; i < pipeline.numLanes(); ++i)
+  {
+    auto lane = std::make_unique<Lane>();
+    lane->initParams.initialized = true;
+    lane->initParams.usePlugin = false;
+    lane->initParams.parameters = initParams->parameters;
+    copyFolder(initParams->inputFolder, lane->initParams.inputFolder);
+    copyFolder(initParams->outFolder, lane->initParams.outFolder);
+    lanes.push_back(std::move(lane));
+  }
+
+  return pipeline.run(BatchPipeline::listFiles(initParams->inputFolder.imgdirpath),
+                      [&lanes](uint32_t lane, const std::string& fileName, uint64_t& pixels) {
+                        auto& l = *lanes[lane];
+                        int rc = l.decompressor.decompress(fileName, &l.initParams);
+                        pixels = l.decompressor.decompressedPixels_;
+                        return rc;
+                      });
+}
+
 int GrkDecompress::shmBatchDecompress(DecompressInitParams* initParams)
 {
   using namespace grk_plugin;
@@ -28,6 +28,8 @@ struct Messenger;
 
 namespace grk
 {
+class BatchPipeline;
+
 struct DecompressInitParams
 {
   DecompressInitParams() : initialized(false)
@@ -44,6 +46,8 @@ struct DecompressInitParams
   }
   bool initialized;
   bool usePlugin = true;
+  // concurrent lanes for a --batch-src directory: 0 picks them from the thread count
+  uint32_t batchLanes = 0;
   grk_decompress_parameters parameters;
   std::vector<uint16_t> compIndices;
   char pluginPath[GRK_PATH_LEN];
@@ -80,12 +84,16 @@ private:
   void destoryParams(grk_decompress_parameters* parameters);
   void printTiming(uint32_t num_images, std::chrono::duration<double> elapsed);
   int shmBatchDecompress(DecompressInitParams* initParams);
+  // decompresses every file in the batch directory; returns the number decompressed
+  uint32_t batchDecompress(DecompressInitParams* initParams, BatchPipeline& pipeline);
 
   bool storeToDisk;
   bool incrementalWriteActive_;
   IImageFormat* incrementalBandFormat_;
   uint32_t incrementalBandRowsWritten_;
   uint32_t incrementalBandRowsExpected_;
+  // pixels in the last image decompressed
+  uint64_t decompressedPixels_;
   IImageFormat* imageFormat;
   grk_plugin::Messenger* messenger_;
 };
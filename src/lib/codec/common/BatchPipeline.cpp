@@ -0,0 +1,142 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+
+#include "spdlogwrapper.h"
+#include "BatchPipeline.h"
+
+namespace grk
+{
+
+// library threads per lane when the lane count is picked automatically: enough for
+// a few tiles or code block rows of a small image, so that lanes rather than
+// threads are added as the core count grows
+const uint32_t autoThreadsPerLane = 4;
+const uint32_t maxAutoLanes = 8;
+
+BatchPipeline::BatchPipeline(uint32_t numLanes, uint32_t numThreads) : numLanes_(numLanes)
+{
+  if(!numLanes_)
+  {
+    if(!numThreads)
+      numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    numLanes_ = std::clamp(numThreads / autoThreadsPerLane, 1U, maxAutoLanes);
+  }
+}
+
+std::vector<std::string> BatchPipeline::listFiles(const std::string& dir)
+{
+  std::vector<std::string> files;
+  for(const auto& entry : std::filesystem::directory_iterator(dir))
+  {
+    if(entry.is_regular_file())
+      files.push_back(entry.path().filename().string());
+  }
+  std::sort(files.begin(), files.end());
+
+  return files;
+}
+
+uint32_t BatchPipeline::numLanes(void) const
+{
+  return numLanes_;
+}
+
+uint32_t BatchPipeline::numProcessed(void) const
+{
+  return numProcessed_;
+}
+
+uint32_t BatchPipeline::numFailed(void) const
+{
+  return numFailed_;
+}
+
+uint32_t BatchPipeline::numUnsuitable(void) const
+{
+  return numUnsuitable_;
+}
+
+uint32_t BatchPipeline::run(const std::vector<std::string>& files, const Job& job)
+{
+  std::atomic<size_t> next = 0;
+  std::atomic<uint32_t> numProcessed = 0;
+  auto lane = [&](uint32_t laneIndex) {
+    for(size_t i = next++; i < files.size(); i = next++)
+    {
+      uint64_t pixels = 0;
+      int rc = 0;
+      try
+      {
+        rc = job(laneIndex, files[i], pixels);
+      }
+      catch([[maybe_unused]] const std::bad_alloc& ba)
+      {
+        spdlog::error("Out of memory processing {}", files[i]);
+      }
+      if(rc == 1)
+      {
+        numProcessed++;
+        numPixels_ += pixels;
+      }
+      else if(rc == 2)
+      {
+        numUnsuitable_++;
+      }
+      else
+      {
+        numFailed_++;
+      }
+    }
+  };
+  auto numLanes = (uint32_t)std::min<size_t>(numLanes_, files.size());
+  if(numLanes <= 1)
+  {
+    lane(0);
+  }
+  else
+  {
+    std::vector<std::thread> threads;
+    threads.reserve(numLanes);
+    for(uint32_t i = 0; i < numLanes; ++i)
+      threads.emplace_back(lane, i);
+    for(auto& t : threads)
+      t.join();
+  }
+  numProcessed_ += numProcessed;
+
+  return numProcessed;
+}
+
+void BatchPipeline::report(const char* operation, std::chrono::duration<double> elapsed) const
+{
+  uint32_t numProcessed = numProcessed_;
+  if(!numProcessed)
+    return;
+  double secs = std::max(elapsed.count(), 1e-9);
+  spdlog::info("{} batch: {} images in {:.3f} s with {} lanes, {} ms/image, {:.2f} images/s, "
+               "{:.2f} MPix/s",
+               operation, numProcessed, secs, numLanes_, secs * 1000 / numProcessed,
+               numProcessed / secs, (double)numPixels_ / 1e6 / secs);
+  if(numFailed_)
+    spdlog::warn("{} batch: {} images failed", operation, (uint32_t)numFailed_);
+}
+
+} // namespace grk
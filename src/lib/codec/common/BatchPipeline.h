@@ -0,0 +1,105 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace grk
+{
+
+/**
+ * @class BatchPipeline
+ * @brief Runs a directory batch through several concurrent lanes
+ *
+ * Each lane takes the next file as soon as it is done with its current one, so that one
+ * file's header read and input load overlap the other lanes' compress or decompress, and
+ * several small images keep the library's shared thread pool busy between files. Lanes
+ * share nothing but the file list and the counters: each job keeps its own parameters
+ * and output format, whose writes go through that format's own @ref FileOrchestratorIO.
+ */
+class BatchPipeline
+{
+public:
+  /**
+   * @brief Processes one file in a lane
+   *
+   * @param lane lane index, in [0, number of lanes)
+   * @param fileName file name, relative to the batch directory
+   * @param pixels set to the number of pixels in the image
+   * @return 0 for failure, 1 for success, and 2 if the file is not suitable
+   */
+  using Job = std::function<int(uint32_t lane, const std::string& fileName, uint64_t& pixels)>;
+
+  /**
+   * @brief Constructs a BatchPipeline
+   *
+   * @param numLanes number of concurrent lanes: 0 picks one from the number of threads
+   * @param numThreads number of library threads, or 0 for all cores
+   */
+  BatchPipeline(uint32_t numLanes, uint32_t numThreads);
+
+  /**
+   * @brief Lists the regular files in a directory, sorted by name
+   */
+  static std::vector<std::string> listFiles(const std::string& dir);
+
+  uint32_t numLanes(void) const;
+
+  /**
+   * @brief Number of files processed successfully by every @ref run so far
+   */
+  uint32_t numProcessed(void) const;
+
+  /**
+   * @brief Number of files that failed, or ran out of memory, in every @ref run so far
+   */
+  uint32_t numFailed(void) const;
+
+  /**
+   * @brief Number of files found not suitable in every @ref run so far
+   */
+  uint32_t numUnsuitable(void) const;
+
+  /**
+   * @brief Runs @p job on every file, and returns when all lanes are done
+   *
+   * @return number of files processed successfully
+   */
+  uint32_t run(const std::vector<std::string>& files, const Job& job);
+
+  /**
+   * @brief Logs the aggregate throughput of every @ref run so far
+   *
+   * @param operation "compress" or "decompress"
+   * @param elapsed wall time of the runs
+   */
+  void report(const char* operation, std::chrono::duration<double> elapsed) const;
+
+private:
+  uint32_t numLanes_;
+  std::atomic<uint32_t> numProcessed_ = 0;
+  std::atomic<uint32_t> numFailed_ = 0;
+  std::atomic<uint32_t> numUnsuitable_ = 0;
+  std::atomic<uint64_t> numPixels_ = 0;
+};
+
+} // namespace grk
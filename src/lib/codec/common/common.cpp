@@ -183,6 +183,17 @@ bool useStdio(const std::string& filename)
   return filename.empty();
 }
 
+bool isStreamOutput(const std::string& filename)
+{
+  if(useStdio(filename))
+    return true;
+  std::error_code ec;
+  auto type = std::filesystem::status(filename, ec).type();
+  return !ec && (type == std::filesystem::file_type::fifo ||
+                 type == std::filesystem::file_type::socket ||
+                 type == std::filesystem::file_type::character);
+}
+
 bool supportedStdioFormat(GRK_SUPPORTED_FILE_FMT format, bool compress)
 {
   if(compress)
@@ -77,7 +77,7 @@ void log(grk_msg_callback msg_handler, void* data, char const* const format, Arg
 const GRK_SUPPORTED_FILE_FMT supportedStdoutFileFormatsCompress[] = {
     GRK_FMT_PNG, GRK_FMT_PXM, GRK_FMT_RAW, GRK_FMT_RAWL, GRK_FMT_JPG};
 const GRK_SUPPORTED_FILE_FMT supportedStdoutFileFormatsDecompress[] = {
-    GRK_FMT_BMP, GRK_FMT_PNG, GRK_FMT_PXM, GRK_FMT_RAW, GRK_FMT_RAWL, GRK_FMT_JPG};
+    GRK_FMT_BMP, GRK_FMT_PNG, GRK_FMT_PXM, GRK_FMT_RAW, GRK_FMT_RAWL, GRK_FMT_JPG, GRK_FMT_TIF};
 
 const size_t maxICCProfileBufferLen = 10000000;
 
@@ -114,6 +114,8 @@ std::string convertFileFmtToString(GRK_SUPPORTED_FILE_FMT fmt);
 bool parseWindowBounds(char* inArg, double* dw_x0, double* dw_y0, double* dw_x1, double* dw_y1);
 bool safe_fclose(FILE* fd);
 bool useStdio(const std::string& filename);
+// true for stdout, pipes and devices: outputs that can only be written front to back
+bool isStreamOutput(const std::string& filename);
 bool supportedStdioFormat(GRK_SUPPORTED_FILE_FMT format, bool compress);
 bool grk_open_for_output(FILE** fdest, const char* outfile, bool writeToStdout);
 bool grk_set_binary_mode(FILE* file);
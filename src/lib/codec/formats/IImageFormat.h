@@ -131,6 +131,15 @@ public:
    */
   virtual bool supportsIncrementalBandWrite(void) const = 0;
 
+  /**
+   * @brief Requests tiled pixel layout instead of strips. Call before writeHeader().
+   *
+   * @param tileWidth tile width in pixels
+   * @param tileHeight tile height in pixels
+   * @return false if the format cannot store tiles
+   */
+  virtual bool setTileSize(uint32_t tileWidth, uint32_t tileHeight) = 0;
+
   /**
    * @brief Writes a single strip of pre-packed pixel data (push-based, incremental).
    *
@@ -87,6 +87,11 @@ bool ImageFormat::supportsIncrementalBandWrite(void) const
 {
   return false;
 }
+bool ImageFormat::setTileSize([[maybe_unused]] uint32_t tileWidth,
+                              [[maybe_unused]] uint32_t tileHeight)
+{
+  return false;
+}
 /***
  * library-orchestrated pixel encoding
  */
@@ -42,6 +42,7 @@ public:
                          uint32_t concurrency) override;
   virtual void setImage(grk_image* image) override;
   bool supportsIncrementalBandWrite(void) const override;
+  bool setTileSize(uint32_t tileWidth, uint32_t tileHeight) override;
   virtual bool writeStrip(uint32_t workerId, grk_io_buf pixels) override;
   virtual bool writeFinish(void) override;
   uint32_t getWriteState(void) override;
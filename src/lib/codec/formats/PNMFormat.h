@@ -81,7 +81,7 @@ private:
   bool readBytes(FILE* fp, grk_image* image, size_t area, uint32_t maxval);
   bool closeStream(void);
 
-  grk_image* readImage(const grk_cparameters* parameters);
+  grk_image* readImage(grk_cparameters* parameters);
   bool decodeHeader(struct pnm_header* ph);
 };
 
@@ -997,7 +997,7 @@ bool PNMFormat<T>::readBytes(FILE* fp, grk_image* image, size_t area, uint32_t m
 }
 
 template<typename T>
-grk_image* PNMFormat<T>::readImage(const grk_cparameters* parameters)
+grk_image* PNMFormat<T>::readImage(grk_cparameters* parameters)
 {
   uint8_t subsampling_dx = parameters->subsampling_dx;
   uint8_t subsampling_dy = parameters->subsampling_dy;
@@ -1011,6 +1011,7 @@ grk_image* PNMFormat<T>::readImage(const grk_cparameters* parameters)
   struct pnm_header header_info;
   uint64_t area = 0;
   bool success = false;
+  bool mapped = false;
 
   if(fileIO_)
     delete fileIO_;
@@ -1078,7 +1079,22 @@ grk_image* PNMFormat<T>::readImage(const grk_cparameters* parameters)
     cmptparm[i].w = w;
     cmptparm[i].h = h;
   }
-  image = grk_image_new(decompress_num_comps, &cmptparm[0], color_space, true);
+  /* binary maps whose maxval fills the sample width can be mapped as is:
+   * no sample can exceed maxval, so the compressor may read them unchecked */
+  if(parameters->pixel_source.file[0])
+  {
+    mapped = (format == 5 || format == 6 ||
+              (format == 7 && header_info.colour_space != PNM_BW &&
+               header_info.colour_space != PNM_UNKNOWN)) &&
+             (header_info.maxval == 0xFF || header_info.maxval == 0xFFFF) &&
+             !(GRK_IS_CINEMA(parameters->rsiz) && header_info.maxval == 0xFFFF);
+    if(!mapped)
+    {
+      spdlog::warn("{} cannot be memory mapped: reading it instead", fileName_);
+      parameters->pixel_source.file[0] = 0;
+    }
+  }
+  image = grk_image_new(decompress_num_comps, &cmptparm[0], color_space, !mapped);
   if(!image)
   {
     spdlog::error("pnmtoimage: Failed to create image");
@@ -1095,7 +1111,19 @@ grk_image* PNMFormat<T>::readImage(const grk_cparameters* parameters)
   stride_diff = image->comps[0].stride - width;
   counter = 0;
 
-  if(format == 1)
+  if(mapped)
+  {
+    /* samples follow the header */
+    int64_t pos = GRK_FTELL(fileIO_->getFileHandle());
+    if(pos == -1)
+      goto cleanup;
+    auto src = &parameters->pixel_source;
+    src->offset = (uint64_t)pos;
+    src->bytes_per_sample = header_info.maxval == 0xFF ? 1 : 2;
+    src->big_endian = true;
+    src->interleaved = true;
+  }
+  else if(format == 1)
   { /* ascii bitmap */
     const size_t chunkSize = 4096;
     uint8_t chunk[chunkSize];
@@ -33,12 +33,19 @@ public:
   bool writeHeader(void) override;
   bool writeImage() override;
   bool writeImageBand(uint32_t yBegin, uint32_t yEnd) override;
+  bool supportsIncrementalBandWrite(void) const override;
   using ImageFormat::writeStrip;
   bool writeFinish(void) override;
   grk_image* readImage(const std::string& filename, grk_cparameters* parameters) override;
 
 private:
   bool bigEndian;
+  /** rows of each component written by band writes so far */
+  uint32_t bandRowsWritten_ = 0;
+  /** checks that all components can share one sample layout */
+  bool checkComponents(void);
+  /** writes rows y up to y + rows of a component at the current file position */
+  bool writeRows(const grk_image_comp* comp, uint32_t y, uint32_t rows);
   grk_image* readImage(const char* filename, grk_cparameters* parameters, bool big_endian);
 
   template<typename WT>
@@ -113,154 +120,161 @@ bool RAWFormat<T>::writeHeader(void)
 }
 
 template<typename T>
-bool RAWFormat<T>::writeImage(void)
+bool RAWFormat<T>::checkComponents(void)
 {
-  const char* outfile = fileName_.c_str();
-  uint16_t compno, numcomps;
-  bool success = false;
-
   if((image_->decompress_num_comps * image_->x1 * image_->y1) == 0)
   {
     spdlog::error("writeImage: invalid raw image_ parameters");
-    goto beach;
+    return false;
   }
+  uint16_t numcomps = image_->decompress_num_comps;
+  for(uint16_t compno = 1; compno < numcomps; ++compno)
+  {
+    if(image_->comps[0].dx != image_->comps[compno].dx ||
+       image_->comps[0].dy != image_->comps[compno].dy ||
+       image_->comps[0].prec != image_->comps[compno].prec ||
+       image_->comps[0].sgnd != image_->comps[compno].sgnd)
+    {
+      spdlog::error("writeImage: All components shall have the same subsampling, same bit depth, "
+                    "same sign.");
+      return false;
+    }
+  }
+  for(uint16_t compno = 0; compno < numcomps; ++compno)
+  {
+    if(!image_->comps[compno].data)
+    {
+      spdlog::error("writeImage: component {} is null.", compno);
+      return false;
+    }
+    if(image_->comps[compno].prec > 16)
+    {
+      spdlog::error("writeImage: invalid precision: {}", image_->comps[compno].prec);
+      return false;
+    }
+  }
+
+  return true;
+}
 
-  numcomps = image_->decompress_num_comps;
-  for(compno = 1; compno < numcomps; ++compno)
+template<typename T>
+bool RAWFormat<T>::writeRows(const grk_image_comp* comp, uint32_t y, uint32_t rows)
+{
+  auto w = comp->w;
+  auto stride = comp->stride;
+  bool sgnd = comp->sgnd;
+  auto prec = comp->prec;
+  T lower = sgnd ? -(1 << (prec - 1)) : 0;
+  T upper = sgnd ? -lower - 1 : (1 << comp->prec) - 1;
+  auto fileHandle = fileIO_->getFileHandle();
+
+  std::unique_ptr<T[]> widened;
+  T* ptr;
+  if(comp->data_type == GRK_INT_16)
   {
-    if(image_->comps[0].dx != image_->comps[compno].dx)
-      break;
-    if(image_->comps[0].dy != image_->comps[compno].dy)
-      break;
-    if(image_->comps[0].prec != image_->comps[compno].prec)
-      break;
-    if(image_->comps[0].sgnd != image_->comps[compno].sgnd)
-      break;
+    // widen int16 → int32 for writeToFile
+    auto src16 = (int16_t*)comp->data + (uint64_t)y * stride;
+    widened = std::make_unique<T[]>((uint64_t)stride * rows);
+    for(uint64_t idx = 0; idx < (uint64_t)stride * rows; ++idx)
+      widened[idx] = src16[idx];
+    ptr = widened.get();
   }
-  if(compno != numcomps)
+  else
   {
-    spdlog::error("writeImage: All components shall have the same subsampling, same bit depth, "
-                  "same sign.");
-    goto beach;
+    ptr = (T*)comp->data + (uint64_t)y * stride;
   }
+  bool rc;
+  if(prec <= 8)
+    rc = sgnd ? writeToFile<int8_t>(fileHandle, bigEndian, ptr, w, stride, rows, lower, upper)
+              : writeToFile<uint8_t>(fileHandle, bigEndian, ptr, w, stride, rows, lower, upper);
+  else
+    rc = sgnd ? writeToFile<int16_t>(fileHandle, bigEndian, ptr, w, stride, rows, lower, upper)
+              : writeToFile<uint16_t>(fileHandle, bigEndian, ptr, w, stride, rows, lower, upper);
+  if(!rc)
+    spdlog::error("writeImage: failed to write bytes for {}", fileName_);
+
+  return rc;
+}
+
+template<typename T>
+bool RAWFormat<T>::writeImage(void)
+{
+  if(!checkComponents())
+    return false;
   if(fileIO_)
     delete fileIO_;
   fileIO_ = new FileStandardIO();
-  if(!fileIO_->open(outfile, "wb"))
-    goto beach;
+  if(!fileIO_->open(fileName_, "wb"))
+    return false;
 
   spdlog::info("writeImage: raw image_ characteristics: {} components",
                image_->decompress_num_comps);
-
-  for(compno = 0; compno < image_->decompress_num_comps; compno++)
+  for(uint16_t compno = 0; compno < image_->decompress_num_comps; compno++)
   {
     auto comp = image_->comps + compno;
     spdlog::info("Component {} characteristics: {}x{}x{} {}", compno, comp->w, comp->h, comp->prec,
                  comp->sgnd == 1 ? "signed" : "unsigned");
-
-    if(!comp->data)
-    {
-      spdlog::error("writeImage: component {} is null.", compno);
-
-      goto beach;
-    }
-    auto w = comp->w;
-    auto h = comp->h;
-    auto stride = comp->stride;
-    bool sgnd = comp->sgnd;
-    auto prec = comp->prec;
-
-    T lower = sgnd ? -(1 << (prec - 1)) : 0;
-    T upper = sgnd ? -lower - 1 : (1 << comp->prec) - 1;
-    bool isInt16 = comp->data_type == GRK_INT_16;
-
-    bool rc;
-    if(prec <= 8)
-    {
-      if(isInt16)
-      {
-        // widen int16 → int32 for writeToFile; data is 8-bit so this path is rare
-        auto src16 = (int16_t*)comp->data;
-        auto widened = std::make_unique<T[]>((uint64_t)stride * h);
-        for(uint64_t idx = 0; idx < (uint64_t)stride * h; ++idx)
-          widened[idx] = src16[idx];
-        if(sgnd)
-          rc = writeToFile<int8_t>(fileIO_->getFileHandle(), bigEndian, widened.get(), w, stride, h,
-                                   lower, upper);
-        else
-          rc = writeToFile<uint8_t>(fileIO_->getFileHandle(), bigEndian, widened.get(), w, stride,
-                                    h, lower, upper);
-      }
-      else
-      {
-        auto ptr = (T*)comp->data;
-        if(sgnd)
-          rc = writeToFile<int8_t>(fileIO_->getFileHandle(), bigEndian, ptr, w, stride, h, lower,
-                                   upper);
-        else
-          rc = writeToFile<uint8_t>(fileIO_->getFileHandle(), bigEndian, ptr, w, stride, h, lower,
-                                    upper);
-      }
-      if(!rc)
-        spdlog::error("writeImage: failed to write bytes for {}", outfile);
-    }
-    else if(prec <= 16)
-    {
-      if(isInt16)
-      {
-        auto src16 = (int16_t*)comp->data;
-        auto widened = std::make_unique<T[]>((uint64_t)stride * h);
-        for(uint64_t idx = 0; idx < (uint64_t)stride * h; ++idx)
-          widened[idx] = src16[idx];
-        if(sgnd)
-          rc = writeToFile<int16_t>(fileIO_->getFileHandle(), bigEndian, widened.get(), w, stride,
-                                    h, lower, upper);
-        else
-          rc = writeToFile<uint16_t>(fileIO_->getFileHandle(), bigEndian, widened.get(), w, stride,
-                                     h, lower, upper);
-      }
-      else
-      {
-        auto ptr = (T*)comp->data;
-        if(sgnd)
-          rc = writeToFile<int16_t>(fileIO_->getFileHandle(), bigEndian, ptr, w, stride, h, lower,
-                                    upper);
-        else
-          rc = writeToFile<uint16_t>(fileIO_->getFileHandle(), bigEndian, ptr, w, stride, h, lower,
-                                     upper);
-      }
-      if(!rc)
-        spdlog::error("writeImage: failed to write bytes for {}", outfile);
-    }
-    else
-    {
-      spdlog::error("writeImage: invalid precision: {}", comp->prec);
-      goto beach;
-    }
+    if(!writeRows(comp, 0, comp->h))
+      return false;
   }
-  success = true;
 
-beach:
+  return true;
+}
 
-  return success;
+template<typename T>
+bool RAWFormat<T>::supportsIncrementalBandWrite(void) const
+{
+  if(!image_)
+    return false;
+  for(uint16_t compno = 0; compno < image_->decompress_num_comps; ++compno)
+  {
+    if(image_->comps[compno].dx != 1 || image_->comps[compno].dy != 1)
+      return false;
+  }
+  // components are stored one after the other, so a band of several components
+  // lands in as many places in the file, which a stream cannot seek to
+  return image_->decompress_num_comps == 1 || !grk::isStreamOutput(fileName_);
 }
 
 template<typename T>
 bool RAWFormat<T>::writeImageBand(uint32_t yBegin, uint32_t yEnd)
 {
-  // RAW writes component-planar data — band-by-band not supported
-  if(yBegin != 0 || yEnd != image_->comps[0].h)
-  {
-    spdlog::error("RAWFormat: partial band writing not supported");
+  if(!checkComponents())
     return false;
+  if(!fileIO_)
+  {
+    fileIO_ = new FileStandardIO();
+    if(!fileIO_->open(fileName_, "wb"))
+      return false;
   }
-  return writeImage();
+  uint16_t numcomps = image_->decompress_num_comps;
+  uint64_t sampleBytes = image_->comps[0].prec <= 8 ? 1 : 2;
+  uint64_t rowBytes = (uint64_t)image_->comps[0].w * sampleBytes;
+  for(uint16_t compno = 0; compno < numcomps; ++compno)
+  {
+    if(numcomps > 1)
+    {
+      uint64_t offset =
+          ((uint64_t)compno * image_->decompress_height + bandRowsWritten_) * rowBytes;
+      if(fileIO_->seek((int64_t)offset, SEEK_SET) != 0)
+      {
+        spdlog::error("RAWFormat: unable to seek to component {} in {}", compno, fileName_);
+        return false;
+      }
+    }
+    if(!writeRows(image_->comps + compno, yBegin, yEnd - yBegin))
+      return false;
+  }
+  bandRowsWritten_ += yEnd - yBegin;
+
+  return true;
 }
 
 template<typename T>
 bool RAWFormat<T>::writeFinish(void)
 {
-  return fileIO_->close();
+  // a band write that failed before its first band never opened the file
+  return fileIO_ ? fileIO_->close() : true;
 }
 
 template<typename T>
@@ -284,6 +298,14 @@ grk_image* RAWFormat<T>::readImage(const char* filename, grk_cparameters* parame
   grk_image* image = nullptr;
   uint16_t ch;
   bool success = false;
+  // cinema profiles reduce deeper samples to 12 bits, which a read-only mapping can not hold
+  bool mapped = parameters->pixel_source.file[0] && raw_cp->prec <= 16 &&
+                !(GRK_IS_CINEMA(parameters->rsiz) && raw_cp->prec > 12);
+  if(parameters->pixel_source.file[0] && !mapped)
+  {
+    spdlog::warn("{} cannot be memory mapped: reading it instead", filename);
+    parameters->pixel_source.file[0] = 0;
+  }
 
   if(!(raw_cp->width && raw_cp->height && raw_cp->numcomps && raw_cp->prec))
   {
@@ -335,7 +357,7 @@ grk_image* RAWFormat<T>::readImage(const char* filename, grk_cparameters* parame
     }
   }
   /* create the image */
-  image = grk_image_new(numcomps, &cmptparm[0], color_space, true);
+  image = grk_image_new(numcomps, &cmptparm[0], color_space, !mapped);
   delete[] cmptparm;
 
   /* set image offset and reference grid */
@@ -344,7 +366,16 @@ grk_image* RAWFormat<T>::readImage(const char* filename, grk_cparameters* parame
   image->x1 = parameters->image_offset_x0 + (w - 1) * subsampling_dx + 1;
   image->y1 = parameters->image_offset_y0 + (h - 1) * subsampling_dy + 1;
 
-  if(raw_cp->prec <= 8)
+  if(mapped)
+  {
+    /* planar samples from the start of the file; length is checked by the compressor */
+    auto src = &parameters->pixel_source;
+    src->offset = 0;
+    src->bytes_per_sample = raw_cp->prec <= 8 ? 1 : 2;
+    src->big_endian = bigEndian;
+    src->interleaved = false;
+  }
+  else if(raw_cp->prec <= 8)
   {
     for(compno = 0; compno < numcomps; compno++)
     {
@@ -393,7 +424,7 @@ grk_image* RAWFormat<T>::readImage(const char* filename, grk_cparameters* parame
     goto cleanup;
   }
 
-  if(fread(&ch, 1, 1, fileIO_->getFileHandle()))
+  if(!mapped && fread(&ch, 1, 1, fileIO_->getFileHandle()))
     spdlog::warn("End of raw file not reached... processing anyway");
   success = true;
 cleanup:
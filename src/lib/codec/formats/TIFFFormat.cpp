@@ -20,6 +20,8 @@
 #ifdef GROK_HAVE_LIBTIFF
 
 #include "TIFFFormat.h"
+#include <bit>
+#include <cmath>
 
 static void tiff_error(const char* msg, [[maybe_unused]] void* client_data)
 {
@@ -58,4 +60,579 @@ void tiffSetErrorAndWarningHandlers(bool verbose)
   TIFFSetWarningHandler(MyTiffWarningHandler);
 }
 
+TiffTileEncoder::~TiffTileEncoder()
+{
+  if(tif_)
+  {
+    // the directory libtiff flushes on close is dropped
+    capture_ = nullptr;
+    TIFFClose(tif_);
+  }
+}
+
+bool TiffTileEncoder::supports(uint16_t compression)
+{
+  switch(compression)
+  {
+    case COMPRESSION_NONE:
+    case COMPRESSION_LZW:
+    case COMPRESSION_ADOBE_DEFLATE:
+    case COMPRESSION_DEFLATE:
+    case COMPRESSION_PACKBITS:
+    case COMPRESSION_ZSTD:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool TiffTileEncoder::init(TIFF* model)
+{
+  tif_ = TIFFClientOpen("tile encoder", "wb", this, read, write, seek, close, size, nullptr,
+                        nullptr);
+  if(!tif_)
+    return false;
+  uint32_t val32 = 0;
+  uint16_t val16 = 0;
+  const uint32_t tags32[] = {TIFFTAG_IMAGEWIDTH, TIFFTAG_IMAGELENGTH, TIFFTAG_TILEWIDTH,
+                             TIFFTAG_TILELENGTH};
+  for(auto tag : tags32)
+  {
+    if(!TIFFGetField(model, tag, &val32) || !TIFFSetField(tif_, tag, val32))
+      return false;
+  }
+  const uint32_t tags16[] = {TIFFTAG_SAMPLESPERPIXEL, TIFFTAG_BITSPERSAMPLE, TIFFTAG_SAMPLEFORMAT,
+                             TIFFTAG_PLANARCONFIG, TIFFTAG_PHOTOMETRIC, TIFFTAG_COMPRESSION};
+  for(auto tag : tags16)
+  {
+    if(!TIFFGetFieldDefaulted(model, tag, &val16))
+      continue;
+    // photometric only matters to the codecs; a palette would need a colormap here
+    if(tag == TIFFTAG_PHOTOMETRIC && val16 == PHOTOMETRIC_PALETTE)
+      val16 = PHOTOMETRIC_MINISBLACK;
+    if(!TIFFSetField(tif_, tag, val16))
+      return false;
+  }
+
+  return true;
+}
+
+bool TiffTileEncoder::encode(uint32_t tileIndex, uint8_t* data, tmsize_t len,
+                             std::vector<uint8_t>& out)
+{
+  out.clear();
+  capture_ = &out;
+  bool rc = TIFFWriteEncodedTile(tif_, tileIndex, data, len) != -1;
+  capture_ = nullptr;
+
+  return rc;
+}
+
+TiffTileWorkers::~TiffTileWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for(auto& t : threads_)
+    t.join();
+}
+
+void TiffTileWorkers::run(uint32_t numWorkers, const std::function<void(uint32_t)>& job)
+{
+  if(numWorkers <= 1)
+  {
+    job(0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while(threads_.size() + 1 < numWorkers)
+      threads_.emplace_back(&TiffTileWorkers::loop, this, (uint32_t)threads_.size() + 1);
+    job_ = &job;
+    numActive_ = numWorkers - 1;
+    numPending_ = numActive_;
+    generation_++;
+  }
+  start_.notify_all();
+  job(0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return numPending_ == 0; });
+  job_ = nullptr;
+}
+
+void TiffTileWorkers::loop(uint32_t workerId)
+{
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while(true)
+  {
+    start_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+    if(stop_)
+      return;
+    seen = generation_;
+    // a narrow row of tiles leaves the higher workers idle
+    if(workerId > numActive_)
+      continue;
+    auto job = job_;
+    lock.unlock();
+    (*job)(workerId);
+    lock.lock();
+    if(--numPending_ == 0)
+      done_.notify_one();
+  }
+}
+
+tmsize_t TiffTileEncoder::read([[maybe_unused]] thandle_t handle, [[maybe_unused]] void* buf,
+                               [[maybe_unused]] tmsize_t size)
+{
+  return 0;
+}
+
+tmsize_t TiffTileEncoder::write(thandle_t handle, void* buf, tmsize_t size)
+{
+  auto encoder = (TiffTileEncoder*)handle;
+  encoder->offset_ += (uint64_t)size;
+  if(encoder->capture_)
+  {
+    // captured bytes never land in the file, so every tile appends at the same
+    // offset and the in-memory file stays far from the classic TIFF size limit
+    auto bytes = (uint8_t*)buf;
+    encoder->capture_->insert(encoder->capture_->end(), bytes, bytes + size);
+  }
+  else
+  {
+    encoder->size_ = (std::max)(encoder->size_, encoder->offset_);
+  }
+
+  return size;
+}
+
+uint64_t TiffTileEncoder::seek(thandle_t handle, uint64_t off, int whence)
+{
+  auto encoder = (TiffTileEncoder*)handle;
+  switch(whence)
+  {
+    case SEEK_SET:
+      encoder->offset_ = off;
+      break;
+    case SEEK_CUR:
+      encoder->offset_ += off;
+      break;
+    case SEEK_END:
+      encoder->offset_ = encoder->size_ + off;
+      break;
+    default:
+      return (uint64_t)-1;
+  }
+
+  return encoder->offset_;
+}
+
+int TiffTileEncoder::close([[maybe_unused]] thandle_t handle)
+{
+  return 0;
+}
+
+uint64_t TiffTileEncoder::size(thandle_t handle)
+{
+  return ((TiffTileEncoder*)handle)->size_;
+}
+
+namespace
+{
+struct StreamIfdEntry
+{
+  uint16_t tag;
+  uint16_t type;
+  uint32_t count;
+  std::vector<uint8_t> value;
+};
+} // namespace
+
+bool tiffStreamHeader(const grk_image* image, std::vector<uint8_t>& header)
+{
+  const bool bigEndian = std::endian::native == std::endian::big;
+  uint32_t width = image->decompress_width;
+  uint32_t height = image->decompress_height;
+  uint16_t numcomps = image->decompress_num_comps;
+  uint32_t rowsPerStrip = image->rows_per_strip;
+  uint64_t rowBytes = image->packed_row_bytes;
+  auto colourSpace = image->decompress_colour_space;
+  if(!width || !height || !numcomps || !rowsPerStrip || !rowBytes)
+  {
+    spdlog::error("TIFF stream: invalid image dimensions");
+    return false;
+  }
+  if(grk::isFinalOutputSubsampled((grk_image*)image))
+  {
+    spdlog::error("TIFF stream: subsampled output cannot be streamed");
+    return false;
+  }
+  if(image->meta && image->meta->color.palette && !image->apply_palette)
+  {
+    spdlog::error("TIFF stream: palette output cannot be streamed");
+    return false;
+  }
+  uint16_t photometric = PHOTOMETRIC_MINISBLACK;
+  if(colourSpace == GRK_CLRSPC_CMYK)
+  {
+    if(numcomps != 4)
+    {
+      spdlog::error("TIFF stream: CMYK output needs exactly 4 components");
+      return false;
+    }
+    photometric = PHOTOMETRIC_SEPARATED;
+  }
+  else if(numcomps > 2)
+  {
+    switch(colourSpace)
+    {
+      case GRK_CLRSPC_EYCC:
+      case GRK_CLRSPC_SYCC:
+      case GRK_CLRSPC_DEFAULT_CIE:
+      case GRK_CLRSPC_CUSTOM_CIE:
+        spdlog::error("TIFF stream: YCbCr and CIE output cannot be streamed");
+        return false;
+      default:
+        photometric = PHOTOMETRIC_RGB;
+        break;
+    }
+  }
+  uint32_t numStrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+  uint64_t pixelBytes = rowBytes * height;
+
+  auto shorts = [bigEndian](std::initializer_list<uint32_t> values, uint32_t repeat = 1) {
+    std::vector<uint8_t> rc(values.size() * repeat * 2);
+    auto p = rc.data();
+    for(uint32_t r = 0; r < repeat; ++r)
+    {
+      for(auto v : values)
+      {
+        exifWriteU16(p, (uint16_t)v, bigEndian);
+        p += 2;
+      }
+    }
+    return rc;
+  };
+  auto longs = [bigEndian](std::initializer_list<uint32_t> values) {
+    std::vector<uint8_t> rc(values.size() * 4);
+    auto p = rc.data();
+    for(auto v : values)
+    {
+      exifWriteU32(p, v, bigEndian);
+      p += 4;
+    }
+    return rc;
+  };
+  auto bytes = [](const uint8_t* buf, size_t len) { return std::vector<uint8_t>(buf, buf + len); };
+
+  // tags in ascending order, as the IFD requires
+  std::vector<StreamIfdEntry> entries;
+  entries.push_back({TIFFTAG_IMAGEWIDTH, TIFF_LONG, 1, longs({width})});
+  entries.push_back({TIFFTAG_IMAGELENGTH, TIFF_LONG, 1, longs({height})});
+  entries.push_back(
+      {TIFFTAG_BITSPERSAMPLE, TIFF_SHORT, numcomps, shorts({image->decompress_prec}, numcomps)});
+  entries.push_back({TIFFTAG_COMPRESSION, TIFF_SHORT, 1, shorts({COMPRESSION_NONE})});
+  entries.push_back({TIFFTAG_PHOTOMETRIC, TIFF_SHORT, 1, shorts({photometric})});
+  // strip offsets are filled in once the header size is known
+  size_t stripOffsetsEntry = entries.size();
+  entries.push_back(
+      {TIFFTAG_STRIPOFFSETS, TIFF_LONG, numStrips, std::vector<uint8_t>((size_t)numStrips * 4)});
+  entries.push_back({TIFFTAG_ORIENTATION, TIFF_SHORT, 1, shorts({ORIENTATION_TOPLEFT})});
+  entries.push_back({TIFFTAG_SAMPLESPERPIXEL, TIFF_SHORT, 1, shorts({numcomps})});
+  entries.push_back({TIFFTAG_ROWSPERSTRIP, TIFF_LONG, 1, longs({rowsPerStrip})});
+  std::vector<uint8_t> byteCounts((size_t)numStrips * 4);
+  for(uint32_t i = 0; i < numStrips; ++i)
+  {
+    uint32_t rows = (std::min)(rowsPerStrip, height - i * rowsPerStrip);
+    exifWriteU32(byteCounts.data() + (size_t)i * 4, (uint32_t)(rowBytes * rows), bigEndian);
+  }
+  entries.push_back({TIFFTAG_STRIPBYTECOUNTS, TIFF_LONG, numStrips, std::move(byteCounts)});
+  bool hasResolution = image->capture_resolution[0] > 0 && image->capture_resolution[1] > 0;
+  if(hasResolution)
+  {
+    // capture resolution is in pixels per metre, and the tags in pixels per centimetre
+    for(uint8_t i = 0; i < 2; ++i)
+      entries.push_back({(uint16_t)(TIFFTAG_XRESOLUTION + i), TIFF_RATIONAL, 1,
+                         longs({(uint32_t)std::lround(image->capture_resolution[i]), 100})});
+  }
+  entries.push_back({TIFFTAG_PLANARCONFIG, TIFF_SHORT, 1, shorts({PLANARCONFIG_CONTIG})});
+  if(hasResolution)
+    entries.push_back({TIFFTAG_RESOLUTIONUNIT, TIFF_SHORT, 1, shorts({RESUNIT_CENTIMETER})});
+  // non-colour channels become extra samples, as libtiff output records them, and
+  // only when they come after the colour channels
+  std::vector<uint8_t> extra;
+  int32_t firstExtra = -1;
+  for(uint16_t i = 0; i < image->numcomps; ++i)
+  {
+    if(image->comps[i].type == GRK_CHANNEL_TYPE_COLOUR)
+      continue;
+    if(firstExtra == -1)
+      firstExtra = i;
+    if(i >= numcomps)
+      continue;
+    auto type = image->comps[i].type;
+    uint16_t val = type == GRK_CHANNEL_TYPE_OPACITY                 ? EXTRASAMPLE_UNASSALPHA
+                   : type == GRK_CHANNEL_TYPE_PREMULTIPLIED_OPACITY ? EXTRASAMPLE_ASSOCALPHA
+                                                                    : EXTRASAMPLE_UNSPECIFIED;
+    extra.resize(extra.size() + 2);
+    exifWriteU16(extra.data() + extra.size() - 2, val, bigEndian);
+  }
+  uint32_t numExtra = (uint32_t)(extra.size() / 2);
+  if(numExtra && (uint32_t)firstExtra >= numcomps - numExtra)
+    entries.push_back({TIFFTAG_EXTRASAMPLES, TIFF_SHORT, numExtra, std::move(extra)});
+  uint32_t sampleFormat = image->comps[0].sgnd ? SAMPLEFORMAT_INT : SAMPLEFORMAT_UINT;
+  entries.push_back(
+      {TIFFTAG_SAMPLEFORMAT, TIFF_SHORT, numcomps, shorts({sampleFormat}, numcomps)});
+  auto meta = image->meta;
+  if(meta && meta->xmp_buf && meta->xmp_len)
+    entries.push_back({TIFFTAG_XMLPACKET, TIFF_BYTE, (uint32_t)meta->xmp_len,
+                       bytes(meta->xmp_buf, meta->xmp_len)});
+  if(meta && meta->color.icc_profile_buf && colourSpace == GRK_CLRSPC_ICC)
+    entries.push_back({TIFFTAG_ICCPROFILE, TIFF_UNDEFINED, meta->color.icc_profile_len,
+                       bytes(meta->color.icc_profile_buf, meta->color.icc_profile_len)});
+  if(meta && ((meta->exif_buf && meta->exif_len) || (meta->iptc_buf && meta->iptc_len)))
+    spdlog::warn("TIFF stream: EXIF and IPTC metadata are not written to a stream");
+
+  // [0]   8-byte header, [8] IFD, then out-of-line values, then pixels
+  uint64_t ifdSize = 2 + (uint64_t)entries.size() * 12 + 4;
+  uint64_t valuesSize = 0;
+  for(auto& e : entries)
+  {
+    if(e.value.size() > 4)
+      valuesSize += (e.value.size() + 1) & ~(size_t)1;
+  }
+  uint64_t headerSize = 8 + ifdSize + valuesSize;
+  if(headerSize + pixelBytes > UINT32_MAX)
+  {
+    spdlog::error("TIFF stream: output larger than 4 GB cannot be streamed");
+    return false;
+  }
+  auto& offsets = entries[stripOffsetsEntry].value;
+  for(uint32_t i = 0; i < numStrips; ++i)
+    exifWriteU32(offsets.data() + (size_t)i * 4,
+                 (uint32_t)(headerSize + rowBytes * rowsPerStrip * i), bigEndian);
+
+  header.assign(headerSize, 0);
+  auto blob = header.data();
+  blob[0] = blob[1] = bigEndian ? 'M' : 'I';
+  exifWriteU16(blob + 2, 42, bigEndian);
+  exifWriteU32(blob + 4, 8, bigEndian);
+  auto p = blob + 8;
+  exifWriteU16(p, (uint16_t)entries.size(), bigEndian);
+  p += 2;
+  uint32_t valueCursor = (uint32_t)(8 + ifdSize);
+  for(auto& e : entries)
+  {
+    exifWriteU16(p, e.tag, bigEndian);
+    exifWriteU16(p + 2, e.type, bigEndian);
+    exifWriteU32(p + 4, e.count, bigEndian);
+    if(e.value.size() <= 4)
+    {
+      memcpy(p + 8, e.value.data(), e.value.size());
+    }
+    else
+    {
+      exifWriteU32(p + 8, valueCursor, bigEndian);
+      memcpy(blob + valueCursor, e.value.data(), e.value.size());
+      valueCursor += (uint32_t)((e.value.size() + 1) & ~(size_t)1);
+    }
+    p += 12;
+  }
+  // next IFD offset stays zero
+
+  return true;
+}
+
+namespace
+{
+// layout of the full image's directory, which every overview level repeats
+struct TiffOverviewLayout
+{
+  uint16_t samplesPerPixel = 0;
+  uint16_t bitsPerSample = 0;
+  uint16_t sampleFormat = SAMPLEFORMAT_UINT;
+  uint16_t photometric = PHOTOMETRIC_MINISBLACK;
+  uint16_t compression = COMPRESSION_NONE;
+  uint32_t tileWidth = 0;
+  uint32_t tileHeight = 0;
+  std::vector<uint16_t> extraSamples;
+  std::vector<uint16_t> colourMap[3];
+  std::vector<uint8_t> iccProfile;
+};
+
+bool tiffReadOverviewLayout(const std::string& filename, TiffOverviewLayout& layout)
+{
+  TIFF* tif = TIFFOpen(filename.c_str(), "r");
+  if(!tif)
+    return false;
+  TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &layout.samplesPerPixel);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &layout.bitsPerSample);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &layout.sampleFormat);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_PHOTOMETRIC, &layout.photometric);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &layout.compression);
+  if(TIFFIsTiled(tif))
+  {
+    TIFFGetField(tif, TIFFTAG_TILEWIDTH, &layout.tileWidth);
+    TIFFGetField(tif, TIFFTAG_TILELENGTH, &layout.tileHeight);
+  }
+  uint16_t numExtra = 0;
+  uint16_t* extra = nullptr;
+  if(TIFFGetField(tif, TIFFTAG_EXTRASAMPLES, &numExtra, &extra) && extra)
+    layout.extraSamples.assign(extra, extra + numExtra);
+  uint16_t* maps[3] = {};
+  if(layout.photometric == PHOTOMETRIC_PALETTE &&
+     TIFFGetField(tif, TIFFTAG_COLORMAP, maps, maps + 1, maps + 2))
+  {
+    size_t mapSize = (size_t)1 << layout.bitsPerSample;
+    for(uint8_t c = 0; c < 3; ++c)
+      layout.colourMap[c].assign(maps[c], maps[c] + mapSize);
+  }
+  uint32_t iccLen = 0;
+  uint8_t* icc = nullptr;
+  if(TIFFGetField(tif, TIFFTAG_ICCPROFILE, &iccLen, &icc) && icc)
+    layout.iccProfile.assign(icc, icc + iccLen);
+  TIFFClose(tif);
+
+  return layout.bitsPerSample != 0;
+}
+
+bool tiffWriteOverview(TIFF* tif, const grk_image* level, const TiffOverviewLayout& layout)
+{
+  uint16_t numcomps = level->numcomps;
+  auto comp0 = level->comps;
+  for(uint16_t i = 0; i < numcomps; ++i)
+  {
+    auto comp = level->comps + i;
+    if(!comp->data || comp->data_type != GRK_INT_32 || comp->w != comp0->w || comp->h != comp0->h)
+    {
+      spdlog::warn("TIFF overview: components differ in size or type - skipping level");
+      return true;
+    }
+  }
+  if(numcomps != layout.samplesPerPixel)
+  {
+    spdlog::warn("TIFF overview: {} components, full image has {} samples - skipping level",
+                 numcomps, layout.samplesPerPixel);
+    return true;
+  }
+  uint8_t bps = (uint8_t)layout.bitsPerSample;
+  std::unique_ptr<grk::PlanarToInterleaved<int32_t>> interleaver(
+      grk::InterleaverFactory<int32_t>::makeInterleaver(bps));
+  if(!interleaver)
+  {
+    spdlog::warn("TIFF overview: {} bits per sample are not supported - skipping level", bps);
+    return true;
+  }
+  TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE);
+  TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, comp0->w);
+  TIFFSetField(tif, TIFFTAG_IMAGELENGTH, comp0->h);
+  TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, numcomps);
+  TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, layout.bitsPerSample);
+  TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, layout.sampleFormat);
+  TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+  TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+  TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, layout.photometric);
+  if(layout.photometric == PHOTOMETRIC_YCBCR)
+    TIFFSetField(tif, TIFFTAG_YCBCRSUBSAMPLING, 1, 1);
+  if(!layout.extraSamples.empty())
+    TIFFSetField(tif, TIFFTAG_EXTRASAMPLES, (uint16_t)layout.extraSamples.size(),
+                 layout.extraSamples.data());
+  if(!layout.colourMap[0].empty())
+    TIFFSetField(tif, TIFFTAG_COLORMAP, layout.colourMap[0].data(), layout.colourMap[1].data(),
+                 layout.colourMap[2].data());
+  if(!layout.iccProfile.empty())
+    TIFFSetField(tif, TIFFTAG_ICCPROFILE, (uint32_t)layout.iccProfile.size(),
+                 layout.iccProfile.data());
+  TIFFSetField(tif, TIFFTAG_COMPRESSION, layout.compression);
+  uint32_t tileWidth = layout.tileWidth;
+  uint32_t tileHeight = layout.tileHeight;
+  if(tileWidth && tileHeight)
+  {
+    TIFFSetField(tif, TIFFTAG_TILEWIDTH, tileWidth);
+    TIFFSetField(tif, TIFFTAG_TILELENGTH, tileHeight);
+  }
+  else
+  {
+    TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, TIFFDefaultStripSize(tif, 0));
+  }
+
+  // samples are packed as the full image's writer packs them
+  std::vector<int32_t*> planes(numcomps);
+  auto pack = [&](uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, uint8_t* dest,
+                  uint64_t destStride) {
+    for(uint16_t i = 0; i < numcomps; ++i)
+    {
+      auto comp = level->comps + i;
+      planes[i] = (int32_t*)comp->data + (size_t)y0 * comp->stride + x0;
+    }
+    interleaver->interleave(planes.data(), numcomps, dest, w, comp0->stride, destStride, h, 0);
+  };
+  if(tileWidth && tileHeight)
+  {
+    // the full image is only tiled with whole-byte samples
+    uint64_t tileRowBytes = grk::PlanarToInterleaved<int32_t>::getPackedBytes(
+        numcomps, tileWidth, bps);
+    std::vector<uint8_t> tile((size_t)(tileRowBytes * tileHeight));
+    for(uint32_t ty = 0; ty < comp0->h; ty += tileHeight)
+    {
+      for(uint32_t tx = 0; tx < comp0->w; tx += tileWidth)
+      {
+        // edge tiles are padded to full size
+        std::fill(tile.begin(), tile.end(), (uint8_t)0);
+        uint32_t w = (std::min)(tileWidth, comp0->w - tx);
+        uint32_t h = (std::min)(tileHeight, comp0->h - ty);
+        pack(tx, ty, w, h, tile.data(), tileRowBytes);
+        if(TIFFWriteEncodedTile(tif, TIFFComputeTile(tif, tx, ty, 0, 0), tile.data(),
+                                (tmsize_t)tile.size()) == -1)
+          return false;
+      }
+    }
+  }
+  else
+  {
+    uint64_t rowBytes =
+        grk::PlanarToInterleaved<int32_t>::getPackedBytes(numcomps, comp0->w, bps);
+    std::vector<uint8_t> row((size_t)rowBytes);
+    for(uint32_t y = 0; y < comp0->h; ++y)
+    {
+      pack(0, y, comp0->w, 1, row.data(), rowBytes);
+      if(TIFFWriteScanline(tif, row.data(), y, 0) < 0)
+        return false;
+    }
+  }
+
+  return TIFFWriteDirectory(tif) != 0;
+}
+} // namespace
+
+bool tiffAppendOverviews(const std::string& filename, grk_image* const* levels,
+                         uint8_t numLevels)
+{
+  TiffOverviewLayout layout;
+  if(!tiffReadOverviewLayout(filename, layout))
+  {
+    spdlog::error("TIFF overview: failed to read the full image's layout from {}", filename);
+    return false;
+  }
+  // append mode starts a new directory after the last one
+  TIFF* tif = TIFFOpen(filename.c_str(), "a");
+  if(!tif)
+  {
+    spdlog::error("TIFF overview: failed to open {} for appending", filename);
+    return false;
+  }
+  bool success = true;
+  for(uint8_t i = 0; success && i < numLevels; ++i)
+  {
+    if(levels[i])
+      success = tiffWriteOverview(tif, levels[i], layout);
+  }
+  TIFFClose(tif);
+
+  return success;
+}
+
 #endif
@@ -36,8 +36,12 @@
 #include "common.h"
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -622,6 +626,121 @@ static inline bool writeExifToTiff(TIFF* tif, const uint8_t* exifBuf, uint32_t e
 /* TIFF conversion*/
 void tiffSetErrorAndWarningHandlers(bool verbose);
 
+/**
+ * @class TiffTileEncoder
+ * @brief Compresses tiles for a tiled output TIFF away from its handle
+ *
+ * A libtiff handle runs one codec, so it cannot compress tiles concurrently. Each
+ * encoder owns an in-memory TIFF with the output's layout and compression, and keeps
+ * the bytes its codec emits for a tile instead of writing them anywhere; the output
+ * then stores them in tile order with TIFFWriteRawTile.
+ *
+ * Only the layout tags and the compression are mirrored, so this only works for codecs
+ * whose tiles need nothing else from the directory: JPEG, for one, keeps its tables in
+ * the encoder's own JPEGTABLES tag.
+ */
+class TiffTileEncoder
+{
+public:
+  ~TiffTileEncoder();
+  /**
+   * @brief True if tiles compressed with @p compression decode without any state
+   * kept in the directory
+   */
+  static bool supports(uint16_t compression);
+  /**
+   * @brief Mirrors the layout and compression tags of @p model
+   *
+   * @param model output TIFF, with its tags set
+   * @return true if successful
+   */
+  bool init(TIFF* model);
+  /**
+   * @brief Compresses one tile
+   *
+   * @param tileIndex tile index in @p model
+   * @param data interleaved tile samples, full tile size
+   * @param len length of @p data in bytes
+   * @param out receives the compressed tile
+   * @return true if successful
+   */
+  bool encode(uint32_t tileIndex, uint8_t* data, tmsize_t len, std::vector<uint8_t>& out);
+
+private:
+  static tmsize_t read(thandle_t handle, void* buf, tmsize_t size);
+  static tmsize_t write(thandle_t handle, void* buf, tmsize_t size);
+  static uint64_t seek(thandle_t handle, uint64_t off, int whence);
+  static int close(thandle_t handle);
+  static uint64_t size(thandle_t handle);
+
+  TIFF* tif_ = nullptr;
+  std::vector<uint8_t>* capture_ = nullptr;
+  uint64_t offset_ = 0;
+  uint64_t size_ = 0;
+};
+
+/**
+ * @class TiffTileWorkers
+ * @brief Threads that live for a whole tiled write and compress each row of tiles
+ *
+ * Threads are started the first time a row needs them and are reused for every
+ * later row. The calling thread always works as worker 0.
+ */
+class TiffTileWorkers
+{
+public:
+  ~TiffTileWorkers();
+  /**
+   * @brief Runs @p job on workers 0 to @p numWorkers - 1 and waits for all of them
+   *
+   * @param numWorkers number of workers, counting the calling thread
+   * @param job called once by each worker, with its id
+   */
+  void run(uint32_t numWorkers, const std::function<void(uint32_t)>& job);
+
+private:
+  void loop(uint32_t workerId);
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  const std::function<void(uint32_t)>* job_ = nullptr;
+  uint64_t generation_ = 0;
+  uint32_t numActive_ = 0;
+  uint32_t numPending_ = 0;
+  bool stop_ = false;
+};
+
+/**
+ * @brief Appends overview levels to a finished TIFF as reduced-resolution IFDs
+ *
+ * Each level becomes one more directory with SUBFILETYPE = FILETYPE_REDUCEDIMAGE, with
+ * the full image's sample layout, photometric, colour map, ICC profile, compression and
+ * tiling. Levels are not post-processed, so the full image must not be either.
+ *
+ * @param filename TIFF file, already closed by its writer
+ * @param levels overview images, largest first
+ * @param numLevels number of entries in @p levels
+ * @return true if every level was written
+ */
+bool tiffAppendOverviews(const std::string& filename, grk_image* const* levels,
+                         uint8_t numLevels);
+
+/**
+ * @brief Builds the header of an uncompressed strip TIFF for output that cannot seek
+ *
+ * libtiff writes the directory after the pixels, and patches it when it closes the file.
+ * This header puts the directory first, with strip offsets and byte counts computed from
+ * image->rows_per_strip and image->packed_row_bytes, so that the strips can follow it
+ * front to back. Values are in native byte order, as the interleavers write them.
+ *
+ * @param image image to write, with its decompress_* fields set
+ * @param header receives the header bytes
+ * @return true if the image can be written this way
+ */
+bool tiffStreamHeader(const grk_image* image, std::vector<uint8_t>& header);
+
 /**
  * @class TIFFFormat
  * @brief TIFF format reader/writer with SIMD-accelerated pixel interleaving.
@@ -639,6 +758,7 @@ public:
 
   bool writeInit(grk_image* image, const std::string& filename, uint32_t compression_level,
                  uint32_t concurrency) override;
+  bool setTileSize(uint32_t tileWidth, uint32_t tileHeight) override;
   bool writeHeader(void) override;
   /***
    * application-orchestrated pixel encoding
@@ -675,6 +795,11 @@ private:
   TIFF* MyTIFFOpen(const char* name, const char* mode);
 #endif
   bool writeHeader(TIFF* tif);
+  /***
+   * stdout and pipes: write a header that describes every strip up front,
+   * then the strips in order, without libtiff
+   */
+  bool writeStreamHeader(void);
   /***
    * Common core pixel encoding write to disk
    */
@@ -693,6 +818,13 @@ private:
    */
   template<typename P>
   bool writeBandStrips(grk::PlanarToInterleaved<P>* interleaver, P** planes, uint32_t rows);
+  /***
+   * tiled layout: bands collect into a row of tiles, and each full row is cut into
+   * tiles that are compressed concurrently and then written in order
+   */
+  template<typename P>
+  bool writeBandTiles(grk::PlanarToInterleaved<P>* interleaver, P** planes, uint32_t rows);
+  bool writeTileRow(void);
   TIFF* tif_;
   uint32_t chroma_subsample_x;
   uint32_t chroma_subsample_y;
@@ -704,6 +836,16 @@ private:
   GrkIOBuf stripCarryBuf_;
   uint32_t stripCarryRows_ = 0;
   uint32_t stripRowsWritten_ = 0;
+  uint32_t tileWidth_ = 0;
+  uint32_t tileHeight_ = 0;
+  uint32_t concurrency_ = 1;
+  std::vector<uint8_t> tileRowBuf_;
+  std::vector<std::unique_ptr<TiffTileEncoder>> tileEncoders_;
+  std::unique_ptr<TiffTileWorkers> tileWorkers_;
+  std::vector<std::vector<uint8_t>> tileScratch_;
+  std::vector<std::vector<uint8_t>> encodedTiles_;
+  bool streamOut_ = false;
+  uint32_t streamStripsWritten_ = 0;
 };
 
 #ifdef GRK_CUSTOM_TIFF_IO
@@ -807,9 +949,26 @@ bool TIFFFormat<T>::writeInit(grk_image* image, const std::string& filename,
     return true;
   }
 
+  concurrency_ = (std::max)(concurrency, 1U);
+
   return ImageFormat::writeInit(image, filename, compression_level, concurrency);
 }
 
+template<typename T>
+bool TIFFFormat<T>::setTileSize(uint32_t tileWidth, uint32_t tileHeight)
+{
+  if(!tileWidth || !tileHeight || (tileWidth & 15) || (tileHeight & 15))
+  {
+    spdlog::error("TIFFFormat: tile dimensions {}x{} must be non-zero multiples of 16",
+                  tileWidth, tileHeight);
+    return false;
+  }
+  tileWidth_ = tileWidth;
+  tileHeight_ = tileHeight;
+
+  return true;
+}
+
 template<typename T>
 bool TIFFFormat<T>::writeHeader(void)
 {
@@ -818,6 +977,8 @@ bool TIFFFormat<T>::writeHeader(void)
 
   if(!image_)
     return false;
+  if(grk::isStreamOutput(fileName_))
+    return writeStreamHeader();
 
   uint32_t width = image_->decompress_width;
   uint32_t height = image_->decompress_height;
@@ -851,6 +1012,37 @@ bool TIFFFormat<T>::writeHeader(void)
   return writeHeader(tif_);
 }
 
+template<typename T>
+bool TIFFFormat<T>::writeStreamHeader(void)
+{
+  if(compressionLevel_ != 0)
+  {
+    spdlog::error("TIFFFormat: a TIFF stream can only be written uncompressed");
+    return false;
+  }
+  if(tileWidth_)
+  {
+    spdlog::warn("TIFFFormat: a TIFF stream is written in strips");
+    tileWidth_ = 0;
+    tileHeight_ = 0;
+  }
+  std::vector<uint8_t> header;
+  if(!tiffStreamHeader(image_, header))
+    return false;
+  if(!orchestrator.open(fileName_, "wb", true))
+    return false;
+  if(orchestrator.write(header.data(), header.size()) != header.size())
+  {
+    spdlog::error("TIFFFormat: failed to write the TIFF stream header");
+    orchestrator.close();
+    return false;
+  }
+  streamOut_ = true;
+  writeState_ = IMAGE_FORMAT_HEADER_WRITTEN;
+
+  return true;
+}
+
 template<typename T>
 bool TIFFFormat<T>::writeHeader(TIFF* tif)
 {
@@ -990,7 +1182,22 @@ bool TIFFFormat<T>::writeHeader(TIFF* tif)
   TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
   TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
   TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, tiPhoto);
-  TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, image_->rows_per_strip);
+  if(tileWidth_ && (subsampled || (bps & 7)))
+  {
+    spdlog::warn("TIFFFormat: tiles need whole-byte samples without chroma subsampling - "
+                 "writing strips");
+    tileWidth_ = 0;
+    tileHeight_ = 0;
+  }
+  if(tileWidth_)
+  {
+    TIFFSetField(tif, TIFFTAG_TILEWIDTH, tileWidth_);
+    TIFFSetField(tif, TIFFTAG_TILELENGTH, tileHeight_);
+  }
+  else
+  {
+    TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, image_->rows_per_strip);
+  }
   if(writePalette)
   {
     auto pal = image_->meta->color.palette;
@@ -1158,6 +1365,102 @@ bool TIFFFormat<T>::writeBandStrips(grk::PlanarToInterleaved<P>* interleaver, P*
   return true;
 }
 
+template<typename T>
+template<typename P>
+bool TIFFFormat<T>::writeBandTiles(grk::PlanarToInterleaved<P>* interleaver, P** planes,
+                                   uint32_t rows)
+{
+  uint64_t rowBytes = image_->packed_row_bytes;
+  if(tileRowBuf_.empty())
+    tileRowBuf_.resize(rowBytes * tileHeight_);
+  while(rows)
+  {
+    uint32_t rowsTaken = (std::min)(tileHeight_ - stripCarryRows_, rows);
+    interleaver->interleave(planes, image_->decompress_num_comps,
+                            tileRowBuf_.data() + rowBytes * stripCarryRows_,
+                            image_->decompress_width, image_->comps[0].stride, rowBytes, rowsTaken,
+                            0);
+    stripCarryRows_ += rowsTaken;
+    stripRowsWritten_ += rowsTaken;
+    rows -= rowsTaken;
+    if(stripCarryRows_ < tileHeight_ && stripRowsWritten_ != image_->decompress_height)
+      continue;
+    if(!writeTileRow())
+      return false;
+    stripCarryRows_ = 0;
+  }
+  return true;
+}
+
+template<typename T>
+bool TIFFFormat<T>::writeTileRow(void)
+{
+  uint32_t width = image_->decompress_width;
+  uint64_t rowBytes = image_->packed_row_bytes;
+  size_t pixelBytes = (size_t)(rowBytes / width);
+  size_t tileRowBytes = (size_t)tileWidth_ * pixelBytes;
+  size_t tileBytes = tileRowBytes * tileHeight_;
+  uint32_t y0 = stripRowsWritten_ - stripCarryRows_;
+  uint32_t tilesAcross = (width + tileWidth_ - 1) / tileWidth_;
+  uint16_t compression = COMPRESSION_NONE;
+  TIFFGetFieldDefaulted(tif_, TIFFTAG_COMPRESSION, &compression);
+  // other codecs compress on the output handle, one tile at a time
+  bool concurrent = TiffTileEncoder::supports(compression);
+  uint32_t numThreads = concurrent ? (std::min)(concurrency_, tilesAcross) : 1;
+  while(concurrent && tileEncoders_.size() < numThreads)
+  {
+    auto encoder = std::make_unique<TiffTileEncoder>();
+    if(!encoder->init(tif_))
+    {
+      spdlog::error("TIFFFormat: failed to set up a tile encoder");
+      return false;
+    }
+    tileEncoders_.push_back(std::move(encoder));
+  }
+  if(!tileWorkers_)
+    tileWorkers_ = std::make_unique<TiffTileWorkers>();
+  tileScratch_.resize(numThreads);
+  encodedTiles_.resize(tilesAcross);
+  auto& encoded = encodedTiles_;
+  std::atomic<bool> encodeError{false};
+  std::function<void(uint32_t)> worker = [&](uint32_t workerId) {
+    auto& tile = tileScratch_[workerId];
+    tile.resize(tileBytes);
+    for(uint32_t tx = workerId; tx < tilesAcross && !encodeError.load(); tx += numThreads)
+    {
+      // edge tiles are padded to full size
+      uint32_t x0 = tx * tileWidth_;
+      size_t copyBytes = (size_t)(std::min)(tileWidth_, width - x0) * pixelBytes;
+      std::fill(tile.begin(), tile.end(), (uint8_t)0);
+      for(uint32_t y = 0; y < stripCarryRows_; ++y)
+        memcpy(tile.data() + y * tileRowBytes,
+               tileRowBuf_.data() + y * rowBytes + (size_t)x0 * pixelBytes, copyBytes);
+      auto tileIndex = TIFFComputeTile(tif_, x0, y0, 0, 0);
+      bool rc = concurrent ? tileEncoders_[workerId]->encode(tileIndex, tile.data(),
+                                                             (tmsize_t)tileBytes, encoded[tx])
+                           : TIFFWriteEncodedTile(tif_, tileIndex, tile.data(),
+                                                  (tmsize_t)tileBytes) != -1;
+      if(!rc)
+        encodeError = true;
+    }
+  };
+  tileWorkers_->run(numThreads, worker);
+  if(encodeError.load())
+  {
+    spdlog::error("TIFFFormat: failed to compress tile row at y = {}", y0);
+    return false;
+  }
+  for(uint32_t tx = 0; concurrent && tx < tilesAcross; ++tx)
+  {
+    auto& tile = encoded[tx];
+    if(TIFFWriteRawTile(tif_, TIFFComputeTile(tif_, tx * tileWidth_, y0, 0, 0), tile.data(),
+                        (tmsize_t)tile.size()) == -1)
+      return false;
+  }
+
+  return true;
+}
+
 template<typename T>
 bool TIFFFormat<T>::writeImageBand(uint32_t yBegin, uint32_t yEnd)
 {
@@ -1353,7 +1656,8 @@ bool TIFFFormat<T>::writeImageBand(uint32_t yBegin, uint32_t yEnd)
       if(!interleaver16_)
         goto cleanup;
     }
-    if(!writeBandStrips(interleaver16_, planes16, yEnd - yBegin))
+    if(tileWidth_ ? !writeBandTiles(interleaver16_, planes16, yEnd - yBegin)
+                  : !writeBandStrips(interleaver16_, planes16, yEnd - yBegin))
       goto cleanup;
   }
   else
@@ -1368,7 +1672,8 @@ bool TIFFFormat<T>::writeImageBand(uint32_t yBegin, uint32_t yEnd)
       if(!interleaver_)
         goto cleanup;
     }
-    if(!writeBandStrips(interleaver_, planes, yEnd - yBegin))
+    if(tileWidth_ ? !writeBandTiles(interleaver_, planes, yEnd - yBegin)
+                  : !writeBandStrips(interleaver_, planes, yEnd - yBegin))
       goto cleanup;
   }
   success = true;
@@ -1383,6 +1688,20 @@ cleanup:
 template<typename T>
 bool TIFFFormat<T>::writeStripToDisk(grk_io_buf pixels)
 {
+  if(streamOut_)
+  {
+    // the header already fixed where each strip lives, and a stream cannot seek to it
+    if(pixels.index != streamStripsWritten_)
+    {
+      spdlog::error("TIFFFormat: strip {} arrived while the stream expected strip {}",
+                    pixels.index, streamStripsWritten_);
+      return false;
+    }
+    if(orchestrator.write(pixels.data, pixels.len) != pixels.len)
+      return false;
+    streamStripsWritten_++;
+    return true;
+  }
   tmsize_t written = TIFFWriteEncodedStrip(tif_, pixels.index, pixels.data, (tmsize_t)pixels.len);
   return written != -1;
 }
@@ -1396,11 +1715,18 @@ bool TIFFFormat<T>::writeFinish(void)
     return true;
   }
   // an aborted decode can leave a partial strip unwritten
-  if(stripCarryRows_)
-  {
+  if(stripCarryRows_ && !tileWidth_)
     pool.put(stripCarryBuf_);
-    stripCarryBuf_ = GrkIOBuf();
-    stripCarryRows_ = 0;
+  stripCarryBuf_ = GrkIOBuf();
+  stripCarryRows_ = 0;
+  tileWorkers_.reset();
+  tileEncoders_.clear();
+  tileScratch_.clear();
+  encodedTiles_.clear();
+  if(streamOut_)
+  {
+    writeState_ |= IMAGE_FORMAT_PIXELS_WRITTEN;
+    return orchestrator.close();
   }
   // save EXIF data before closing the primary TIFF handle
   const uint8_t* exifBuf = nullptr;
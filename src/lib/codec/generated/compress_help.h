@@ -92,6 +92,10 @@ Path to the folder where the images to be compressed are stored. Either this arg
 
 **MJ2 multi-frame mode:** When the output file (`-o`) has a `.mj2` extension, all images in the input directory are compressed into a single MJ2 (Motion JPEG 2000) file. Files are sorted alphabetically to ensure deterministic frame order. Example: `grk_compress -y /path/to/frames/ -o output.mj2`
 
+`--batch-lanes [number of lanes]`
+
+Number of images from `--batch-src` that are compressed concurrently. Each lane takes the next file as soon as it finishes its current one, so that reading one file overlaps the compression of the others, and small images share the thread pool instead of draining it between files. A value of `0`, the default, picks one lane for every four threads, up to eight lanes. When the batch finishes, the aggregate throughput is reported in images/s and MPix/s.
+
 `-a, --out-dir [output directory]`
 
 Output directory where compressed files are stored. Only relevant when the `--batch-src` flag is set. Default: same directory as specified by `-y`.
@@ -116,6 +120,10 @@ Example of a raw `512x512` unsigned image with `4:2:0` sub-sampling
 
 Apply ICC profile before compression, if present.
 
+`--mmap-input`
+
+Memory map binary `PNM` (`P5`, `P6` and `P7` with maxval 255 or 65535) and `RAW`/`RAWL` input instead of reading it into memory. Each tile is filled directly from the mapped file by the thread that compresses it, so full image planes are never allocated. Other inputs, and inputs combined with `--apply-icc`, `--xyz`, subsampling or a cinema profile deeper than 12 bits, are read as usual with a warning.
+
 `-A, --rate--control-algorithm [0|1]`
 
 Select algorithm used for rate control.
@@ -124,13 +132,13 @@ Select algorithm used for rate control.
 
 `-r, --compression-ratios [<compression ratio>,<compression ratio>,...]`
 
-Note: not supported for Part 15 (HTJ2K) compression
+Note: Part 15 (HTJ2K) compression supports a single quality layer; only the last value is used
 
 Compression ratio values (double precision, greater than or equal to one). Each value is a factor of compression, thus 20 means 20 times compressed. Each value represents a quality layer. The order used to define the different levels of compression is important and must be from left to right in descending order. A final lossless quality layer (including all remaining code passes) will be signified by the value 1. Default: 1 single lossless quality layer.
 
 `-q, -quality [quality in dB,quality in dB,...]`
 
-Note: not supported for Part 15 (HTJ2K) compression
+Note: Part 15 (HTJ2K) compression supports a single quality layer; only the last value is used
 
 Quality values (double precision, greater than or equal to zero). Each value is a PSNR measure, given in dB, representing a quality layer. The order used to define the different PSNR values is important and must be from left to right in ascending order. A value of 0 signifies a final lossless quality layer (including all remaining code passes) Default: 1 single lossless quality layer.
 
@@ -270,7 +278,8 @@ Divide packets of every tile into tile-parts. The division is made by grouping R
 
 `-R, -ROI [c=component index,U=upshifting value]`
 
-Quantization indices upshifted for a component. 
+)HELPTEXT"
+    R"HELPTEXT(Quantization indices upshifted for a component. 
 
 Warning: This option does not implement the usual ROI (Region of Interest). It should be understood as a "Component of Interest". It offers the possibility to upshift the value of a component during quantization step. The value after `c=` is the component number `[0, 1, 2, ...]` and the value after `U=` is the value of upshifting. U must be in the range `[0, 37]`.
 
@@ -280,8 +289,7 @@ Offset of the image origin. The division in tile could be modified as the anchor
 
 `-T, --tile-offset [x offset,y offset]`
 
-)HELPTEXT"
-    R"HELPTEXT(Offset of the tile origin. The two values are respectively for X and Y axis offset. The tile anchor point can not be inside the image area. Default: no offset.
+Offset of the tile origin. The two values are respectively for X and Y axis offset. The tile anchor point can not be inside the image area. Default: no offset.
 
 `-Y, -MCT [0|1|2]`
 
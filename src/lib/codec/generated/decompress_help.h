@@ -73,6 +73,10 @@ Output file. Required when using `-i` option. See above for supported file types
 
 Path to the folder where the compressed images are stored. Either this argument or the `-i` argument described above is required. When image files are in the same directory as the executable, this can be indicated by a dot `.` argument. When using this option, the output format must be specified using `--out-fmt`. Output images are saved in the same folder.
 
+`--batch-lanes [number of lanes]`
+
+Number of images from `--batch-src` that are decompressed concurrently. Each lane takes the next file as soon as it finishes its current one, so that reading one file overlaps the decompression of the others, and small images share the thread pool instead of draining it between files. A value of `0`, the default, picks one lane for every four threads, up to eight lanes. When the batch finishes, the aggregate throughput is reported in images/s and MPix/s.
+
 `-a, --out-dir [output directory]`
 
 Output directory where compressed files are stored. Only relevant when the `--batch-src` flag is set. Default: same directory as specified by `--batch-src`.
@@ -85,6 +89,16 @@ Output format used to decompress the code streams. Required when `--batch-src` o
 
 Reduce factor. Set the number of highest resolution levels to be discarded. The image resolution is effectively divided by 2 to the power of the number of discarded levels. The reduce factor is limited by the smallest total number of decomposition levels among tiles.
 
+`--pyramid [reduction,reduction,...]`
+
+Comma-separated list of reductions, each from 1 to 31, to emit as overview levels from the same decompress. Every resolution is entropy decoded once: a level is taken from the inverse wavelet transform as it passes through that resolution. For `TIF` output, the levels are stored as reduced-resolution images after the full one; this cannot be combined with precision, colour or palette conversion, and a TIFF written to a stream gets no overview levels. Other output formats ignore the levels. Reductions at or below `-r`, or beyond a tile's decomposition levels, are skipped, and the option has no effect with a decompress region, Part-2 transforms or a custom multi-component transform.
+
+Example:
+
+     --pyramid 1,2,3
+
+Store overviews at 1/2, 1/4 and 1/8 of the full resolution.
+
 `-l, --layers [number of layers]`
 
 Layer number. Set the maximum number of quality layers to decode. If there are fewer quality layers than the specified number, all quality layers will be decoded.
@@ -103,6 +117,10 @@ Decode only the first component (e.g. the Red channel of an RGB image).
 
 Decode components 0 and 2.
 
+`--component-group [number of components]`
+
+Number of components decompressed together, for images with many components such as hyperspectral bands. Each tile's components go through block decoding and the inverse wavelet transform one group at a time, and the code blocks and wavelet scratch of a group are released before the next group starts, so that the working set is bounded by the group size rather than by the number of bands. A custom (Part 2) multi-component transform is applied once all groups of a tile are done. A value of `0`, the default, decompresses all components of a tile at once.
+
 `-d, -region [x0,y0,x1,y1]`
 
 Decompress a region of the image. If `(X,Y)` is a location in the image, then it will only be decoded
@@ -151,6 +169,16 @@ Grok default value is 3.
 Note: PNG is always lossless, so using a different level will not affect the image quality. It only changes
 the speed vs file size tradeoff.
 
+`--tiff-tile-size [width[,height]]`
+
+Write `TIF` output as tiles of `width` x `height` pixels rather than strips. Both must be positive multiples of 16, and the height defaults to the width. With `NONE`, `LZW`, `ZIP`, `PACKBITS` or `ZSTD` compression, the tiles of each row are compressed concurrently; other codecs, such as `JPEG`, compress one tile at a time. Overview levels written with `--pyramid` are tiled too. Strips are written instead for a TIFF stream, for chroma-subsampled images and for samples that are not a whole number of bytes.
+
+Example:
+
+     --tiff-tile-size 256
+
+Write 256 x 256 tiles.
+
 `-t, --tile-index [tile index]`
 
 Only decode tile with specified index. Index follows the JPEG2000 convention from top-left to bottom-right. By default all tiles are decoded.
@@ -48,6 +48,12 @@
 #include <cassert>
 #include <cstdarg>
 #include <cinttypes>
+#include <climits>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -60,6 +66,11 @@
 #include <sys/mman.h>
 #include <semaphore.h>
 #include <signal.h>
+#ifdef __linux__
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 #endif
 
 namespace grk_plugin
@@ -215,6 +226,14 @@ inline IMessengerLogger* getMessengerLogger(void)
 }
 
 /*************************** Messenger Initialization *******************************/
+enum MessengerTransport
+{
+  // one message buffer per direction, handed over with a semaphore ping-pong
+  MESSENGER_TRANSPORT_SEMAPHORE,
+  // multi-slot single-producer/single-consumer ring per direction
+  MESSENGER_TRANSPORT_RING
+};
+
 struct MessengerInit
 {
   // server constructor (grok side): knows frame sizes at init time
@@ -227,7 +246,8 @@ struct MessengerInit
         outboundReceiveReadySynch(outReceiveReady), inboundMessageBuf(inBuf),
         inboundSentSynch(inSent), inboundReceiveReadySynch(inReceiveReady), processor_(processor),
         numProcessingThreads_(numProcessingThreads), uncompressedFrameSize_(uncompressedFrameSize),
-        compressedFrameSize_(compressedFrameSize), numFrames_(numFrames)
+        compressedFrameSize_(compressedFrameSize), numFrames_(numFrames),
+        transport_(transportFromEnv())
   {
     if(firstLaunch(isClient_))
       unlink();
@@ -245,8 +265,22 @@ struct MessengerInit
 #ifndef _WIN32
     shm_unlink(grokToClientMessageBuf.c_str());
     shm_unlink(clientToGrokMessageBuf.c_str());
+    shm_unlink(ringName(grokToClientMessageBuf).c_str());
+    shm_unlink(ringName(clientToGrokMessageBuf).c_str());
 #endif
   }
+  // Both processes must use the same transport. The client launches the server,
+  // which inherits its environment, so GRK_MESSENGER_RING=1 selects the ring
+  // for both; the semaphore transport stays the default for existing clients.
+  static MessengerTransport transportFromEnv(void)
+  {
+    const char* env = std::getenv("GRK_MESSENGER_RING");
+    return (env && env[0] == '1') ? MESSENGER_TRANSPORT_RING : MESSENGER_TRANSPORT_SEMAPHORE;
+  }
+  static std::string ringName(const std::string& messageBuf)
+  {
+    return messageBuf + "_ring";
+  }
   static bool firstLaunch(bool isClient)
   {
     bool debugGrok = false;
@@ -268,6 +302,8 @@ struct MessengerInit
   size_t uncompressedFrameSize_;
   size_t compressedFrameSize_;
   size_t numFrames_;
+
+  MessengerTransport transport_;
 };
 
 /*************************** Synchronization *******************************/
@@ -707,6 +743,140 @@ private:
   size_t max_size_;
 };
 
+/*************************** Shared Memory Ring *******************************/
+// Blocks while *word == expected, for at most timeoutMs. On Linux this is a
+// process-shared futex; elsewhere it falls back to a short sleep.
+inline void ringWait(std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs)
+{
+#ifdef __linux__
+  struct timespec ts;
+  ts.tv_sec = timeoutMs / 1000;
+  ts.tv_nsec = (long)(timeoutMs % 1000) * 1000000L;
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+  (void)timeoutMs;
+  if(word->load() == expected)
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+}
+inline void ringWake(std::atomic<uint32_t>* word)
+{
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+  (void)word;
+#endif
+}
+
+/**
+ * Lock-free single-producer/single-consumer message ring living in shared memory.
+ *
+ * Each slot holds a length-prefixed message, so a send is a memcpy and two
+ * atomic stores. Producer and consumer only make a system call when the ring
+ * is full or empty and the other side has announced that it is sleeping.
+ * All-zero memory is a valid empty ring, so a freshly created segment needs
+ * no initialization.
+ */
+struct MessengerRing
+{
+  static constexpr uint32_t numSlots = 1024; // power of two
+  static constexpr uint32_t slotSize = messageBufferLen;
+  static constexpr uint32_t maxMessageLen = slotSize - sizeof(uint32_t);
+  static constexpr int waitTimeoutMs = 100;
+
+  struct Header
+  {
+    alignas(64) std::atomic<uint32_t> head; // next slot to write, advanced by the producer
+    std::atomic<uint32_t> consumerWaiting;
+    alignas(64) std::atomic<uint32_t> tail; // next slot to read, advanced by the consumer
+    std::atomic<uint32_t> producerWaiting;
+  };
+  static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex words must be lock-free");
+  static_assert((numSlots & (numSlots - 1)) == 0, "slot count must be a power of two");
+
+  static constexpr size_t bytes(void)
+  {
+    return sizeof(Header) + (size_t)numSlots * slotSize;
+  }
+
+  explicit MessengerRing(char* mem)
+      : header_(reinterpret_cast<Header*>(mem)), slots_(mem + sizeof(Header))
+  {}
+
+  // Blocks while the ring is full. Returns false if the message is too long,
+  // or if running is cleared before a slot frees up.
+  bool push(const std::string& message, const std::atomic_bool& running)
+  {
+    if(message.size() > maxMessageLen)
+    {
+      getMessengerLogger()->error("Message of %zu bytes exceeds ring slot size %u",
+                                  message.size(), maxMessageLen);
+      return false;
+    }
+    while(true)
+    {
+      uint32_t head = header_->head.load(std::memory_order_relaxed);
+      uint32_t tail = header_->tail.load(std::memory_order_acquire);
+      if(head - tail < numSlots)
+      {
+        char* slot = slots_ + (size_t)(head & (numSlots - 1)) * slotSize;
+        uint32_t len = (uint32_t)message.size();
+        memcpy(slot, &len, sizeof(len));
+        memcpy(slot + sizeof(len), message.data(), len);
+        header_->head.store(head + 1, std::memory_order_seq_cst);
+        if(header_->consumerWaiting.load(std::memory_order_seq_cst))
+          ringWake(&header_->head);
+        return true;
+      }
+      if(!running)
+        return false;
+      header_->producerWaiting.store(1, std::memory_order_seq_cst);
+      if(header_->tail.load(std::memory_order_seq_cst) == tail)
+        ringWait(&header_->tail, tail, waitTimeoutMs);
+      header_->producerWaiting.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Blocks while the ring is empty. Returns false once running is cleared
+  // and the ring is empty.
+  bool pop(std::string& message, const std::atomic_bool& running)
+  {
+    while(true)
+    {
+      uint32_t tail = header_->tail.load(std::memory_order_relaxed);
+      uint32_t head = header_->head.load(std::memory_order_acquire);
+      if(head != tail)
+      {
+        const char* slot = slots_ + (size_t)(tail & (numSlots - 1)) * slotSize;
+        uint32_t len = 0;
+        memcpy(&len, slot, sizeof(len));
+        message.assign(slot + sizeof(len), std::min(len, maxMessageLen));
+        header_->tail.store(tail + 1, std::memory_order_seq_cst);
+        if(header_->producerWaiting.load(std::memory_order_seq_cst))
+          ringWake(&header_->tail);
+        return true;
+      }
+      if(!running)
+        return false;
+      header_->consumerWaiting.store(1, std::memory_order_seq_cst);
+      if(header_->head.load(std::memory_order_seq_cst) == tail)
+        ringWait(&header_->head, tail, waitTimeoutMs);
+      header_->consumerWaiting.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // wake both sides, e.g. on shutdown
+  void wakeAll(void)
+  {
+    ringWake(&header_->head);
+    ringWake(&header_->tail);
+  }
+
+private:
+  Header* header_;
+  char* slots_;
+};
+
 /*************************** Buffer Source *******************************/
 struct BufferSrc
 {
@@ -735,6 +905,7 @@ struct BufferSrc
 struct Messenger;
 static void outboundThread(Messenger* messenger, const std::string& sendBuf, Synch* synch);
 static void inboundThread(Messenger* messenger, const std::string& receiveBuf, Synch* synch);
+static void inboundRingThread(Messenger* messenger, const std::string& receiveBuf);
 static void processorThread(Messenger* messenger, std::function<void(std::string)> processor);
 
 struct Messenger
@@ -774,6 +945,11 @@ struct Messenger
       inboundSynch_->post(SYNCH_SENT);
       inbound.join();
     }
+    else if(inbound.joinable())
+    {
+      // the ring thread re-checks running at least every MessengerRing::waitTimeoutMs
+      inbound.join();
+    }
 
     for(auto& p : processors_)
       p.join();
@@ -781,17 +957,27 @@ struct Messenger
     delete outboundSynch_;
     delete inboundSynch_;
 
+    closeOutboundRing();
     deinitShm();
   }
   void startThreads(void)
   {
-    outboundSynch_ =
-        new Synch(init_.isClient_, init_.outboundSentSynch, init_.outboundReceiveReadySynch);
-    outbound = std::thread(outboundThread, this, init_.outboundMessageBuf, outboundSynch_);
+    if(init_.transport_ == MESSENGER_TRANSPORT_RING)
+    {
+      // send() writes straight into the outbound ring, so only inbound needs a thread
+      inbound = std::thread(inboundRingThread, this,
+                            MessengerInit::ringName(init_.inboundMessageBuf));
+    }
+    else
+    {
+      outboundSynch_ =
+          new Synch(init_.isClient_, init_.outboundSentSynch, init_.outboundReceiveReadySynch);
+      outbound = std::thread(outboundThread, this, init_.outboundMessageBuf, outboundSynch_);
 
-    inboundSynch_ =
-        new Synch(init_.isClient_, init_.inboundSentSynch, init_.inboundReceiveReadySynch);
-    inbound = std::thread(inboundThread, this, init_.inboundMessageBuf, inboundSynch_);
+      inboundSynch_ =
+          new Synch(init_.isClient_, init_.inboundSentSynch, init_.inboundReceiveReadySynch);
+      inbound = std::thread(inboundThread, this, init_.inboundMessageBuf, inboundSynch_);
+    }
 
     for(size_t i = 0; i < init_.numProcessingThreads_; ++i)
       processors_.push_back(std::thread(processorThread, this, init_.processor_));
@@ -865,15 +1051,47 @@ struct Messenger
 
     return rc;
   }
+  // Returns false, after logging, if the message was dropped: the ring could not be
+  // mapped or was shut down, or the queue was full or deactivated.
   template<typename... Args>
-  void send(const std::string& str, Args... args)
+  bool send(const std::string& str, Args... args)
   {
     std::ostringstream oss;
     oss << str;
     int dummy[] = {0, ((void)(oss << ',' << args), 0)...};
     static_cast<void>(dummy);
 
-    sendQueue.push(oss.str());
+    bool rc = init_.transport_ == MESSENGER_TRANSPORT_RING ? sendRing(oss.str())
+                                                           : sendQueue.push(oss.str());
+    if(!rc)
+      getMessengerLogger()->error("Messenger: unable to send message %s", oss.str().c_str());
+
+    return rc;
+  }
+  // Senders on any thread are serialized here, which keeps the ring single-producer.
+  // The ring is mapped on first use, by which time the server has created it.
+  bool sendRing(const std::string& message)
+  {
+    std::lock_guard<std::mutex> lk(outboundRingMutex_);
+    if(!outboundRing_)
+    {
+      if(!SharedMemoryManager::initShm(MessengerInit::ringName(init_.outboundMessageBuf),
+                                       MessengerRing::bytes(), &outboundRingFd_,
+                                       &outboundRingMem_, !init_.isClient_))
+        return false;
+      outboundRing_ = std::make_unique<MessengerRing>(outboundRingMem_);
+    }
+    return outboundRing_->push(message, running);
+  }
+  void closeOutboundRing(void)
+  {
+    std::lock_guard<std::mutex> lk(outboundRingMutex_);
+    if(!outboundRing_)
+      return;
+    outboundRing_->wakeAll();
+    outboundRing_.reset();
+    SharedMemoryManager::deinitShm(MessengerInit::ringName(init_.outboundMessageBuf),
+                                   MessengerRing::bytes(), outboundRingFd_, &outboundRingMem_);
   }
   bool launch(const std::string& cmd, const std::string& dir)
   {
@@ -1013,6 +1231,11 @@ private:
   std::thread inbound;
   Synch* inboundSynch_ = nullptr;
 
+  std::mutex outboundRingMutex_;
+  std::unique_ptr<MessengerRing> outboundRing_;
+  grk_handle outboundRingFd_ = 0;
+  char* outboundRingMem_ = nullptr;
+
   std::vector<std::thread> processors_;
   char* uncompressed_buffer_ = nullptr;
   char* compressed_buffer_ = nullptr;
@@ -1066,6 +1289,21 @@ static void inboundThread(Messenger* messenger, const std::string& receiveBuf, S
   SharedMemoryManager::deinitShm(receiveBuf, messageBufferLen, shm_fd, &receive_buffer);
 }
 
+static void inboundRingThread(Messenger* messenger, const std::string& receiveBuf)
+{
+  grk_handle shm_fd = 0;
+  char* receive_buffer = nullptr;
+
+  if(!SharedMemoryManager::initShm(receiveBuf, MessengerRing::bytes(), &shm_fd, &receive_buffer,
+                                   !messenger->isClient()))
+    return;
+  MessengerRing ring(receive_buffer);
+  std::string message;
+  while(ring.pop(message, messenger->running))
+    messenger->receiveQueue.push(message);
+  SharedMemoryManager::deinitShm(receiveBuf, MessengerRing::bytes(), shm_fd, &receive_buffer);
+}
+
 /*************************** Message Parser *******************************/
 struct Msg
 {
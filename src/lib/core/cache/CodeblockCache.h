@@ -0,0 +1,210 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "LRUCache.h"
+
+namespace grk
+{
+
+/**
+ * @struct CodeblockCacheKey
+ * @brief Identifies the T1 output of one code block decoded with a given set of layers
+ *
+ * The compressed length and segment count are part of the key, so a code block
+ * that has since received more data (e.g. a truncated or progressively fetched
+ * stream) never matches an entry decoded from less.
+ */
+struct CodeblockCacheKey
+{
+  uint16_t tileIndex = 0;
+  uint16_t compno = 0;
+  uint8_t resno = 0;
+  uint8_t bandIndex = 0;
+  uint16_t layers = 0;
+  /* least significant bit planes left undecoded for a target precision */
+  uint8_t skipBitPlanes = 0;
+  /* code block origin in band canvas coordinates */
+  uint32_t x0 = 0;
+  uint32_t y0 = 0;
+  uint64_t compressedLength = 0;
+  uint16_t numSegments = 0;
+
+  bool operator==(const CodeblockCacheKey& rhs) const
+  {
+    return tileIndex == rhs.tileIndex && compno == rhs.compno && resno == rhs.resno &&
+           bandIndex == rhs.bandIndex && layers == rhs.layers &&
+           skipBitPlanes == rhs.skipBitPlanes && x0 == rhs.x0 && y0 == rhs.y0 &&
+           compressedLength == rhs.compressedLength && numSegments == rhs.numSegments;
+  }
+};
+
+} // namespace grk
+
+template<>
+struct std::hash<grk::CodeblockCacheKey>
+{
+  size_t operator()(const grk::CodeblockCacheKey& k) const noexcept
+  {
+    uint64_t h = ((uint64_t)k.tileIndex << 48) ^ ((uint64_t)k.compno << 32) ^
+                 ((uint64_t)k.resno << 24) ^ ((uint64_t)k.bandIndex << 16) ^ k.layers;
+    h ^= (((uint64_t)k.x0 << 32) | k.y0) * 0x9E3779B97F4A7C15ULL;
+    h ^= (k.compressedLength + k.numSegments) * 0xC2B2AE3D27D4EB4FULL;
+    return (size_t)(h ^ (h >> 29));
+  }
+};
+
+namespace grk
+{
+
+/**
+ * @class CodeblockCache
+ * @brief Byte-budgeted LRU cache of decoded code block coefficients
+ *
+ * Holds the raw T1 output of each code block, i.e. the samples handed to the
+ * block post-processor before dequantization and region clipping. A decode
+ * whose window overlaps an earlier one replays the cached samples through the
+ * post-processor instead of running the block coder again, so panning a window
+ * only pays T1 for newly exposed code blocks.
+ *
+ * The cache is owned by the code stream and outlives tile processors, so it
+ * also survives tile LRU eviction and grk_decompress_update() window changes.
+ * A budget of 0 disables it.
+ */
+class CodeblockCache
+{
+public:
+  /**
+   * @struct Entry
+   * @brief Code block samples packed row after row, width x height
+   */
+  struct Entry
+  {
+    std::shared_ptr<const std::vector<int32_t>> data;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    /* stride the coder passed to the post-processor; 0 means packed */
+    uint16_t coderStride = 0;
+  };
+
+  explicit CodeblockCache(size_t maxBytes = 0)
+      : cache_(maxBytes,
+               [](const Entry& e) {
+                 return sizeof(Entry) + (e.data ? e.data->size() * sizeof(int32_t) : 0);
+               }),
+        hits_(0), misses_(0)
+  {
+    setMaxBytes(maxBytes);
+  }
+
+  /**
+   * @brief Sets the byte budget, evicting as needed. 0 disables and empties the cache.
+   */
+  void setMaxBytes(size_t maxBytes)
+  {
+    enabled_ = maxBytes > 0;
+    if(enabled_)
+    {
+      cache_.setMaxBytes(maxBytes);
+    }
+    else
+    {
+      cache_.clear();
+      cache_.setMaxBytes(0);
+    }
+  }
+
+  bool enabled(void) const
+  {
+    return enabled_;
+  }
+
+  /**
+   * @brief Looks up a code block, counting the hit or miss
+   * @param key @ref CodeblockCacheKey
+   * @param entry receives the cached samples on a hit
+   * @return true on a hit
+   */
+  bool lookup(const CodeblockCacheKey& key, Entry& entry)
+  {
+    auto cached = cache_.getCopy(key);
+    if(!cached)
+    {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    entry = std::move(*cached);
+    return true;
+  }
+
+  /**
+   * @brief Stores the T1 output of a code block
+   * @param key @ref CodeblockCacheKey
+   * @param src T1 output
+   * @param width code block width
+   * @param height code block height
+   * @param coderStride stride the coder passes to the post-processor (0 = packed)
+   */
+  void store(const CodeblockCacheKey& key, const int32_t* src, uint32_t width, uint32_t height,
+             uint16_t coderStride)
+  {
+    size_t area = (size_t)width * height;
+    // an entry larger than the whole budget would only evict everything else
+    if(!enabled_ || !area || area * sizeof(int32_t) >= cache_.maxBytes())
+      return;
+    auto data = std::make_shared<std::vector<int32_t>>(area);
+    uint32_t srcStride = coderStride ? coderStride : width;
+    for(uint32_t j = 0; j < height; ++j)
+      memcpy(data->data() + (size_t)j * width, src + (size_t)j * srcStride,
+             width * sizeof(int32_t));
+    Entry entry;
+    entry.data = std::move(data);
+    entry.width = width;
+    entry.height = height;
+    entry.coderStride = coderStride;
+    cache_.put(key, std::move(entry));
+  }
+
+  /**
+   * @brief Fills @ref grk_codeblock_cache_stats
+   */
+  void getStats(grk_codeblock_cache_stats* stats) const
+  {
+    stats->hits = hits_.load(std::memory_order_relaxed);
+    stats->misses = misses_.load(std::memory_order_relaxed);
+    stats->bytes = cache_.currentBytes();
+    stats->entries = cache_.size();
+    stats->max_bytes = enabled_ ? cache_.maxBytes() : 0;
+  }
+
+private:
+  LRUCache<CodeblockCacheKey, Entry> cache_;
+  std::atomic<bool> enabled_ = false;
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+};
+
+} // namespace grk
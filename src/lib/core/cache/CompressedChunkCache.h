@@ -28,6 +28,7 @@
 #include <vector>
 
 #include "DiskCache.h"
+#include "EnvVarManager.h"
 #include "TPFetchSeq.h"
 #include "MemStream.h"
 #include "IStream.h"
@@ -372,26 +373,10 @@ private:
     if(provided > 0)
       return provided;
 
-    const char* env = std::getenv("GRK_CACHEMAX");
-    if(!env)
-      env = std::getenv("GDAL_CACHEMAX");
+    auto bytes = EnvVarManager::get("GRK_CACHEMAX") ? EnvVarManager::get_size("GRK_CACHEMAX")
+                                                    : EnvVarManager::get_size("GDAL_CACHEMAX");
 
-    if(env)
-    {
-      std::string s(env);
-      if(s.empty())
-        return kDefaultMaxBytes;
-
-      char suffix = s.back();
-      if(suffix == 'M' || suffix == 'm')
-        return static_cast<size_t>(std::stoull(s.substr(0, s.size() - 1))) * 1024 * 1024;
-      if(suffix == 'G' || suffix == 'g')
-        return static_cast<size_t>(std::stoull(s.substr(0, s.size() - 1))) * 1024 * 1024 * 1024;
-
-      return static_cast<size_t>(std::stoull(s));
-    }
-
-    return kDefaultMaxBytes;
+    return bytes ? static_cast<size_t>(*bytes) : kDefaultMaxBytes;
   }
 
   static constexpr size_t kDefaultMaxBytes = 256 * 1024 * 1024; // 256 MB
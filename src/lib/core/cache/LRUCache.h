@@ -110,6 +110,25 @@ public:
     return &(it->second->second);
   }
 
+  /**
+   * @brief Look up an entry and return a copy of its value. Moves it to the front.
+   *
+   * Unlike get(), the result stays valid while other threads insert and evict.
+   * @param key  cache key
+   * @return copy of the value, or std::nullopt if not found
+   */
+  std::optional<Value> getCopy(const Key& key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = map_.find(key);
+    if(it == map_.end())
+      return std::nullopt;
+
+    list_.splice(list_.begin(), list_, it->second);
+    return it->second->second;
+  }
+
   /**
    * @brief Check if a key exists without promoting it in the LRU order.
    */
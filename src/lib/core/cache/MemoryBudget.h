@@ -0,0 +1,355 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "EnvVarManager.h"
+
+namespace grk
+{
+
+/**
+ * @class MemoryBudget
+ * @brief Byte budget with a high-water mark, optionally nested in a parent budget
+ *
+ * Every charge is also made against the parent, so codecs that each have their own
+ * budget can share a process-wide one. acquire() never fails: past the limit it first
+ * asks its caller to evict, then waits while its caller still has charges in flight
+ * that will be released, and finally goes over the limit rather than stall a decode
+ * that has nothing left to wait for.
+ *
+ * The process-wide limit comes from GRK_MEMORY_BUDGET (bytes, or with an M/MB/G/GB
+ * suffix), defaulting to 0 = unlimited.
+ */
+class MemoryBudget
+{
+public:
+  /**
+   * @brief Creates a budget
+   * @param limit byte limit, 0 = unlimited
+   * @param parent budget that is charged along with this one, or nullptr
+   */
+  explicit MemoryBudget(uint64_t limit = 0, MemoryBudget* parent = nullptr)
+      : limit_(limit), parent_(parent)
+  {}
+
+  ~MemoryBudget()
+  {
+    if(parent_ && used_)
+      parent_->release(used_);
+  }
+
+  /**
+   * @brief The process-wide budget
+   */
+  static MemoryBudget& process(void)
+  {
+    static MemoryBudget budget(resolveLimit());
+    return budget;
+  }
+
+  void setLimit(uint64_t limit)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      limit_ = limit;
+    }
+    cv_.notify_all();
+  }
+
+  uint64_t limit(void) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limit_;
+  }
+
+  /**
+   * @brief True if this budget or one of its parents has a limit
+   */
+  bool enabled(void) const
+  {
+    return limit() || (parent_ && parent_->enabled());
+  }
+
+  /**
+   * @brief Charges @p bytes, evicting and waiting while that would go over a limit
+   *
+   * @param bytes bytes to charge
+   * @param evict releases some of the caller's evictable charges, returning false
+   * when nothing is left to evict
+   * @param canWait returns true while the caller has charges in flight that will be
+   * released, so that waiting for them makes progress
+   */
+  void acquire(uint64_t bytes, const std::function<bool()>& evict,
+               const std::function<bool()>& canWait)
+  {
+    while(!tryCharge(bytes))
+    {
+      if(evict && evict())
+        continue;
+      if(!canWait || !canWait())
+      {
+        charge(bytes);
+        return;
+      }
+      // a release in the parent comes from another codec, so poll for it too
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+  }
+
+  /**
+   * @brief Charges @p bytes if that keeps this budget and its parents within their limits
+   *
+   * Checking and charging happen under one lock per budget, so that concurrent callers
+   * cannot all pass the check and then overshoot the limit together.
+   * @return true if charged
+   */
+  bool tryCharge(uint64_t bytes)
+  {
+    if(!bytes)
+      return true;
+    // the parent is charged while this budget stays locked; locks are only ever
+    // taken child first, so this cannot deadlock
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(limit_ && used_ + bytes > limit_)
+      return false;
+    if(parent_ && !parent_->tryCharge(bytes))
+      return false;
+    used_ += bytes;
+    if(used_ > highWater_)
+      highWater_ = used_;
+
+    return true;
+  }
+
+  /**
+   * @brief Charges @p bytes without checking the limits
+   */
+  void charge(uint64_t bytes)
+  {
+    if(!bytes)
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      used_ += bytes;
+      if(used_ > highWater_)
+        highWater_ = used_;
+    }
+    if(parent_)
+      parent_->charge(bytes);
+  }
+
+  void release(uint64_t bytes)
+  {
+    if(!bytes)
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      used_ = bytes < used_ ? used_ - bytes : 0;
+    }
+    cv_.notify_all();
+    if(parent_)
+      parent_->release(bytes);
+  }
+
+  uint64_t used(void) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+  }
+
+  uint64_t highWater(void) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return highWater_;
+  }
+
+private:
+  static uint64_t resolveLimit(void)
+  {
+    return EnvVarManager::get_size("GRK_MEMORY_BUDGET").value_or(0);
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t limit_ = 0;
+  uint64_t used_ = 0;
+  uint64_t highWater_ = 0;
+  MemoryBudget* parent_ = nullptr;
+};
+
+/**
+ * @class TileMemoryBudget
+ * @brief A codec's MemoryBudget, charged per tile
+ *
+ * A tile is charged its estimated working set when it is scheduled and stays
+ * "in flight" until settle(), which replaces that charge with what the tile cache
+ * keeps of the tile: its coefficients, which LRU eviction can release, and its image.
+ */
+class TileMemoryBudget
+{
+public:
+  TileMemoryBudget() : budget_(0, &MemoryBudget::process()) {}
+
+  void init(uint16_t numTiles)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(charges_.size() < numTiles)
+      charges_.resize(numTiles);
+  }
+
+  void setLimit(uint64_t limit)
+  {
+    budget_.setLimit(limit);
+  }
+
+  bool enabled(void) const
+  {
+    return budget_.enabled();
+  }
+
+  /**
+   * @brief Charges a tile that is about to be decompressed
+   *
+   * @param tileIndex tile index
+   * @param bytes estimated working set of the tile
+   * @param mayWait false on a worker thread, which must not block on other tiles
+   * @param evict releases the coefficients of some cached tile (see releaseCoefficients())
+   * @param abandon returns true once waiting is pointless, e.g. the decode failed
+   */
+  void acquire(uint16_t tileIndex, uint64_t bytes, bool mayWait, const std::function<bool()>& evict,
+               const std::function<bool()>& abandon)
+  {
+    if(tileIndex >= charges_.size())
+      return;
+    // a tile decompressed again first gives back what it held
+    settle(tileIndex, 0, 0);
+    budget_.acquire(bytes, evict, [this, mayWait, &abandon]() {
+      return mayWait && inFlight_.load() > 0 && !(abandon && abandon());
+    });
+    std::lock_guard<std::mutex> lock(mutex_);
+    charges_[tileIndex].inFlight = bytes;
+    inFlight_++;
+  }
+
+  /**
+   * @brief Replaces a tile's charge with what the tile cache keeps of it
+   *
+   * @param tileIndex tile index
+   * @param coefficientBytes bytes of decoded coefficients kept with the tile
+   * @param imageBytes bytes of the tile image kept with the tile
+   */
+  void settle(uint16_t tileIndex, uint64_t coefficientBytes, uint64_t imageBytes)
+  {
+    uint64_t released = 0;
+    uint64_t charged = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(tileIndex >= charges_.size())
+        return;
+      auto& c = charges_[tileIndex];
+      if(c.inFlight)
+        inFlight_--;
+      released = c.inFlight + c.coefficients + c.image;
+      charged = coefficientBytes + imageBytes;
+      c = {0, coefficientBytes, imageBytes};
+    }
+    if(charged > released)
+      budget_.charge(charged - released);
+    else
+      budget_.release(released - charged);
+  }
+
+  /**
+   * @brief Releases the charge for a tile's coefficients, after LRU eviction freed them
+   */
+  void releaseCoefficients(uint16_t tileIndex)
+  {
+    uint64_t released = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(tileIndex >= charges_.size())
+        return;
+      released = charges_[tileIndex].coefficients;
+      charges_[tileIndex].coefficients = 0;
+    }
+    budget_.release(released);
+  }
+
+  /**
+   * @brief True if the tile holds coefficients that eviction could release
+   */
+  bool holdsCoefficients(uint16_t tileIndex) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tileIndex < charges_.size() && charges_[tileIndex].coefficients;
+  }
+
+  /**
+   * @brief Drops the in-flight charges of tiles that never settled, e.g. after a failed
+   * or cancelled decompress
+   */
+  void settleInFlight(void)
+  {
+    uint64_t released = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for(auto& c : charges_)
+      {
+        released += c.inFlight;
+        c.inFlight = 0;
+      }
+      inFlight_ = 0;
+    }
+    budget_.release(released);
+  }
+
+  void getStats(grk_memory_budget_stats* stats) const
+  {
+    stats->limit = budget_.limit();
+    stats->bytes = budget_.used();
+    stats->high_water = budget_.highWater();
+    stats->process_limit = MemoryBudget::process().limit();
+    stats->process_bytes = MemoryBudget::process().used();
+    stats->process_high_water = MemoryBudget::process().highWater();
+  }
+
+private:
+  struct TileCharge
+  {
+    uint64_t inFlight = 0;
+    uint64_t coefficients = 0;
+    uint64_t image = 0;
+  };
+  mutable std::mutex mutex_;
+  std::vector<TileCharge> charges_;
+  std::atomic<uint32_t> inFlight_{0};
+  MemoryBudget budget_;
+};
+
+} // namespace grk
@@ -0,0 +1,255 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "EnvVarManager.h"
+#include "LRUCache.h"
+
+namespace grk
+{
+
+/**
+ * @struct SharedTilePartKey
+ * @brief Identifies one tile part of one version of a remote file
+ *
+ * @p identity names the resource and its version (URL plus ETag or
+ * modification time, see IFetcher::identity()), so a file that changes
+ * on the server never matches bytes fetched from the old version.
+ */
+struct SharedTilePartKey
+{
+  std::string identity;
+  uint16_t tileIndex = 0;
+  uint8_t tilePart = 0;
+  uint64_t offset = 0;
+  uint64_t length = 0;
+
+  bool operator==(const SharedTilePartKey& rhs) const
+  {
+    return tileIndex == rhs.tileIndex && tilePart == rhs.tilePart && offset == rhs.offset &&
+           length == rhs.length && identity == rhs.identity;
+  }
+};
+
+} // namespace grk
+
+template<>
+struct std::hash<grk::SharedTilePartKey>
+{
+  size_t operator()(const grk::SharedTilePartKey& k) const noexcept
+  {
+    size_t h = std::hash<std::string>{}(k.identity);
+    uint64_t v = ((uint64_t)k.tileIndex << 8 | k.tilePart) ^ (k.offset * 0x9E3779B97F4A7C15ULL) ^
+                 (k.length << 32);
+    return h ^ (size_t)(v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2));
+  }
+};
+
+namespace grk
+{
+
+/**
+ * @class SharedTilePartCache
+ * @brief Process-wide cache of fetched tile-part bytes, shared by all codecs
+ *
+ * CompressedChunkCache belongs to one codec, so N codecs opening the same
+ * remote file (one per worker thread is the usual GDAL pattern) would each
+ * fetch and hold their own copy of every tile part. This cache sits in front
+ * of the fetcher instead: tile parts are stored once, as immutable buffers
+ * that every codec's TPFetch shares, under a process-wide byte budget.
+ *
+ * Concurrent misses on the same tile are coalesced: the first codec to
+ * claim() a tile fetches it, and the others wait on the returned future
+ * and then read the tile from the cache.
+ *
+ * The budget comes from GRK_SHARED_CACHEMAX (bytes, or with an M/MB/G/GB suffix),
+ * defaulting to 256 MB; 0 disables the cache.
+ */
+class SharedTilePartCache
+{
+public:
+  /**
+   * @brief Longest a codec waits on another codec's fetch before fetching the tile itself
+   */
+  static constexpr std::chrono::milliseconds kMaxCoalesceWait{10000};
+
+  /**
+   * @brief Creates a cache
+   * @param maxBytes byte budget, 0 = disabled
+   */
+  explicit SharedTilePartCache(size_t maxBytes)
+      : maxBytes_(maxBytes), cache_(maxBytes, [](const Entry& e) { return sizeof(Entry) + e.length; })
+  {}
+
+  /**
+   * @brief The process-wide instance
+   */
+  static SharedTilePartCache& instance(void)
+  {
+    static SharedTilePartCache cache(resolveMaxBytes());
+    return cache;
+  }
+
+  bool enabled(void) const
+  {
+    return maxBytes_ > 0;
+  }
+
+  /**
+   * @brief Looks up a tile part
+   * @return shared buffer holding the tile part, or nullptr
+   */
+  std::shared_ptr<uint8_t[]> get(const SharedTilePartKey& key)
+  {
+    if(!enabled())
+      return nullptr;
+    auto entry = cache_.getCopy(key);
+    if(!entry)
+    {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return entry->data;
+  }
+
+  /**
+   * @brief Stores a fetched tile part. The buffer must not be modified afterwards.
+   */
+  void put(const SharedTilePartKey& key, std::shared_ptr<uint8_t[]> data)
+  {
+    // a tile part larger than the whole budget would only evict everything else
+    if(!enabled() || !data || !key.length || key.length >= maxBytes_)
+      return;
+    cache_.put(key, Entry{std::move(data), key.length});
+  }
+
+  /**
+   * @brief Claims the fetch of a tile
+   *
+   * @param identity resource identity
+   * @param tileIndex tile index
+   * @param inFlight set when another codec is already fetching the tile;
+   * it resolves to true once that codec has stored the tile, false if its fetch failed
+   * @param ticket set when the claim is taken, identifies it to release()
+   * @return true if the caller now owns the fetch and must call release()
+   */
+  bool claim(const std::string& identity, uint16_t tileIndex, std::shared_future<bool>& inFlight,
+             uint64_t& ticket)
+  {
+    std::lock_guard<std::mutex> lock(claimMutex_);
+    auto [it, inserted] = claims_.try_emplace(claimKey(identity, tileIndex));
+    if(inserted)
+    {
+      it->second.future = it->second.promise.get_future().share();
+      it->second.ticket = ++lastTicket_;
+      ticket = it->second.ticket;
+      return true;
+    }
+    coalesced_.fetch_add(1, std::memory_order_relaxed);
+    inFlight = it->second.future;
+    return false;
+  }
+
+  /**
+   * @brief Ends a claimed fetch and wakes the codecs waiting on it
+   *
+   * Releasing a claim that has already ended is a no-op, even once another codec
+   * has claimed the tile again, so a fetch can be released on success and again,
+   * unconditionally, when the batch ends.
+   * @param ticket ticket that claim() returned
+   * @param success true if the tile parts were stored
+   */
+  void release(const std::string& identity, uint16_t tileIndex, uint64_t ticket, bool success)
+  {
+    std::lock_guard<std::mutex> lock(claimMutex_);
+    auto it = claims_.find(claimKey(identity, tileIndex));
+    if(it == claims_.end() || it->second.ticket != ticket)
+      return;
+    it->second.promise.set_value(success);
+    claims_.erase(it);
+  }
+
+  uint64_t hits(void) const
+  {
+    return hits_.load(std::memory_order_relaxed);
+  }
+  uint64_t misses(void) const
+  {
+    return misses_.load(std::memory_order_relaxed);
+  }
+  /**
+   * @brief Number of fetches avoided because another codec was already fetching the tile
+   */
+  uint64_t coalesced(void) const
+  {
+    return coalesced_.load(std::memory_order_relaxed);
+  }
+  size_t currentBytes(void) const
+  {
+    return cache_.currentBytes();
+  }
+
+private:
+  struct Entry
+  {
+    std::shared_ptr<uint8_t[]> data;
+    uint64_t length = 0;
+  };
+  struct Claim
+  {
+    std::promise<bool> promise;
+    std::shared_future<bool> future;
+    uint64_t ticket = 0;
+  };
+
+  static std::string claimKey(const std::string& identity, uint16_t tileIndex)
+  {
+    return identity + '#' + std::to_string(tileIndex);
+  }
+
+  static size_t resolveMaxBytes(void)
+  {
+    auto bytes = EnvVarManager::get_size("GRK_SHARED_CACHEMAX");
+    return bytes ? static_cast<size_t>(*bytes) : kDefaultMaxBytes;
+  }
+
+  static constexpr size_t kDefaultMaxBytes = 256 * 1024 * 1024; // 256 MB
+
+  size_t maxBytes_;
+  LRUCache<SharedTilePartKey, Entry> cache_;
+  std::mutex claimMutex_;
+  std::unordered_map<std::string, Claim> claims_;
+  uint64_t lastTicket_ = 0;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> coalesced_{0};
+};
+
+} // namespace grk
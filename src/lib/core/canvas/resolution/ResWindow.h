@@ -314,6 +314,50 @@ private:
 
     return true;
   }
+  /**
+   * Gets the bytes of the buffers this window allocated and still holds
+   */
+  uint64_t allocatedBytes(void) const
+  {
+    uint64_t bytes = resWindowBuffer_->ownedBytes() + resWindowBufferREL_->ownedBytes();
+    for(auto& b : bandWindowsBuffersPadded_)
+      bytes += b->ownedBytes();
+    for(auto& b : bandWindowsBuffersPaddedREL_)
+      bytes += b->ownedBytes();
+    for(uint32_t i = 0; i < SPLIT_NUM_ORIENTATIONS; ++i)
+    {
+      if(resWindowBufferSplit_[i])
+        bytes += resWindowBufferSplit_[i]->ownedBytes();
+      if(resWindowBufferSplitREL_[i])
+        bytes += resWindowBufferSplitREL_[i]->ownedBytes();
+    }
+    return bytes;
+  }
+  /**
+   * Frees the band and split buffers once the wavelet has run, and the resolution
+   * buffer as well unless it holds the decompressed samples
+   */
+  void releaseWorkingBuffers(bool keepResolution)
+  {
+    for(auto& b : bandWindowsBuffersPadded_)
+      b->dealloc();
+    for(auto& b : bandWindowsBuffersPaddedREL_)
+      b->dealloc();
+    for(uint32_t i = 0; i < SPLIT_NUM_ORIENTATIONS; ++i)
+    {
+      if(resWindowBufferSplit_[i])
+        resWindowBufferSplit_[i]->dealloc();
+      if(resWindowBufferSplitREL_[i])
+        resWindowBufferSplitREL_[i]->dealloc();
+    }
+    if(!keepResolution)
+    {
+      resWindowBuffer_->dealloc();
+      resWindowBufferREL_->dealloc();
+    }
+    // a later decompress into this window allocates afresh
+    allocated_ = false;
+  }
 
   /**
    * Get band window (in tile component coordinates) for specified number
@@ -282,6 +282,19 @@ struct TileComponent : public Rect32
     window_ = nullptr;
   }
 
+  /**
+   * @brief Releases the sparse canvas and the window's band and lower resolution
+   * buffers once the component is decompressed, keeping its output samples
+   *
+   */
+  void releaseWorkingBuffers(void)
+  {
+    delete regionWindow_;
+    regionWindow_ = nullptr;
+    if(window_)
+      window_->releaseWorkingBuffers();
+  }
+
   /**
    * @brief Initalizes tile component
    *
@@ -436,6 +449,154 @@ struct TileComponent : public Rect32
     window_->postProcessBlockHT(srcData, block, stride, regionWindow_);
   }
 
+  /**
+   * @brief Lower resolution copied out of the window on the inverse wavelet's way up
+   */
+  struct PyramidLevel
+  {
+    /**
+     * @brief resolution number
+     */
+    uint8_t resno;
+    /**
+     * @brief resolution bounds, in component canvas coordinates at that resolution
+     */
+    Rect32 bounds;
+    /**
+     * @brief row-major samples: int32 for 5/3, float bits for 9/7
+     */
+    std::vector<int32_t> samples;
+  };
+
+  /**
+   * @brief Selects the resolutions to copy out before the inverse wavelet overwrites them
+   *
+   * @param resolutionMask bit r set: keep resolution r
+   */
+  void setPyramidResolutions(uint32_t resolutionMask)
+  {
+    pyramidResolutions_ = resolutionMask;
+    pyramid_.clear();
+  }
+  /**
+   * @brief Checks if resolution @p resno is to be copied out
+   */
+  bool wantsPyramidLevel(uint8_t resno) const
+  {
+    return (pyramidResolutions_ >> resno) & 1;
+  }
+
+  /**
+   * @brief Copies resolution @p resno out of the window
+   *
+   * Only valid for a whole-tile int32 window, after the resolution has been synthesized
+   * and before the next level's horizontal pass reuses its samples. The wavelet runs one
+   * level after the other, so captures of one component never race.
+   *
+   * @param resno resolution number
+   */
+  void capturePyramidLevel(uint8_t resno)
+  {
+    auto res = resolutions_ + resno;
+    auto src = getWindow()->getResWindowBufferSimple(resno);
+    uint32_t w = res->width();
+    uint32_t h = res->height();
+    PyramidLevel level{resno, Rect32(res), std::vector<int32_t>((size_t)w * h)};
+    for(uint32_t y = 0; y < h; ++y)
+      memcpy(level.samples.data() + (size_t)y * w, src.buf_ + (size_t)y * src.stride_,
+             (size_t)w * sizeof(int32_t));
+    pyramid_.push_back(std::move(level));
+  }
+
+  /**
+   * @brief Gets the level captured for resolution @p resno
+   *
+   * @param resno resolution number
+   * @return level, or nullptr if it was not captured
+   */
+  PyramidLevel* pyramidLevel(uint8_t resno)
+  {
+    for(auto& level : pyramid_)
+    {
+      if(level.resno == resno)
+        return &level;
+    }
+    return nullptr;
+  }
+  /**
+   * @brief Frees the captured levels
+   */
+  void releasePyramid(void)
+  {
+    pyramid_.clear();
+  }
+
+  /**
+   * @brief Keeps resolution @p resno of the window for the next differential decompress
+   *
+   * Same constraints as @ref capturePyramidLevel, for an int32 or an int16 window.
+   *
+   * @param resno resolution number
+   */
+  void retainSynthesizedLevel(uint8_t resno)
+  {
+    if(synthesized_.size() < num_resolutions_)
+      synthesized_.resize(num_resolutions_);
+    auto& level = synthesized_[resno];
+    level.resize(synthesizedLevelBytes(resno));
+    auto dest = level.data();
+    forEachResolutionRow(resno, [&dest](uint8_t* row, size_t rowBytes) {
+      memcpy(dest, row, rowBytes);
+      dest += rowBytes;
+    });
+  }
+
+  /**
+   * @brief Checks if resolution @p resno was kept from the last decompress
+   *
+   * @param resno resolution number
+   * @return true if it was kept for the current window and sample type
+   */
+  bool hasSynthesizedLevel(uint8_t resno) const
+  {
+    return resno < synthesized_.size() && !synthesized_[resno].empty() &&
+           synthesized_[resno].size() == synthesizedLevelBytes(resno);
+  }
+
+  /**
+   * @brief Writes the kept resolution @p resno back into the window, in place of
+   * synthesizing it again from unchanged sub-bands
+   *
+   * @param resno resolution number
+   */
+  void restoreSynthesizedLevel(uint8_t resno)
+  {
+    auto src = synthesized_[resno].data();
+    forEachResolutionRow(resno, [&src](uint8_t* row, size_t rowBytes) {
+      memcpy(row, src, rowBytes);
+      src += rowBytes;
+    });
+  }
+
+  /**
+   * @brief Frees the kept resolutions
+   */
+  void releaseSynthesized(void)
+  {
+    synthesized_.clear();
+  }
+
+  /**
+   * @brief Gets the bytes of the window buffers and kept resolutions still allocated
+   */
+  uint64_t allocatedBytes(void) const
+  {
+    uint64_t bytes = window_ ? window_->allocatedBytes() : 0;
+    for(const auto& level : synthesized_)
+      bytes += level.size();
+    return bytes;
+  }
+
   /**
    * @brief array of @ref Resolution
    *
@@ -491,6 +652,47 @@ private:
    *
    */
   TileComponentCodingParams* tccp_;
+  /**
+   * @brief bit r set: copy resolution r out during the inverse wavelet
+   *
+   */
+  uint32_t pyramidResolutions_ = 0;
+  /**
+   * @brief captured @ref PyramidLevel objects
+   *
+   */
+  std::vector<PyramidLevel> pyramid_;
+  /**
+   * @brief row-major bytes of the resolutions kept from the last whole-tile synthesis,
+   * indexed by resolution: empty if not kept
+   *
+   */
+  std::vector<std::vector<uint8_t>> synthesized_;
+
+  size_t synthesizedLevelBytes(uint8_t resno) const
+  {
+    auto res = resolutions_ + resno;
+    return (size_t)res->width() * res->height() *
+           (use16BitDwt_ ? sizeof(int16_t) : sizeof(int32_t));
+  }
+  template<typename F>
+  void forEachResolutionRow(uint8_t resno, F&& f)
+  {
+    auto res = resolutions_ + resno;
+    uint32_t h = res->height();
+    if(use16BitDwt_)
+    {
+      auto win = getWindow16()->getResWindowBufferSimple(resno);
+      for(uint32_t y = 0; y < h; ++y)
+        f((uint8_t*)(win.buf_ + (size_t)y * win.stride_), (size_t)res->width() * sizeof(int16_t));
+    }
+    else
+    {
+      auto win = getWindow()->getResWindowBufferSimple(resno);
+      for(uint32_t y = 0; y < h; ++y)
+        f((uint8_t*)(win.buf_ + (size_t)y * win.stride_), (size_t)res->width() * sizeof(int32_t));
+    }
+  }
 };
 
 } // namespace grk
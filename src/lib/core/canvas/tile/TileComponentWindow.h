@@ -60,6 +60,8 @@ struct ITileComponentWindow
 
   // Allocation
   virtual bool alloc() = 0;
+  virtual void releaseWorkingBuffers() = 0;
+  virtual uint64_t allocatedBytes() const = 0;
 
   // Geometry
   virtual Rect32 bounds() const = 0;
@@ -184,6 +186,21 @@ struct TileComponentWindowBase : public ITileComponentWindow
     return std::all_of(resWindows.begin(), resWindows.end(),
                        [this](const auto& b) { return b->alloc(!compress_); });
   }
+  /**
+   * Frees every buffer but the highest resolution, which holds the decompressed samples
+   */
+  void releaseWorkingBuffers() override
+  {
+    for(auto& b : resWindows)
+      b->releaseWorkingBuffers(b == resWindows.back());
+  }
+  uint64_t allocatedBytes() const override
+  {
+    uint64_t bytes = 0;
+    for(auto& b : resWindows)
+      bytes += b->allocatedBytes();
+    return bytes;
+  }
 
 protected:
   bool useBandWindows() const
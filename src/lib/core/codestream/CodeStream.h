@@ -106,6 +106,7 @@ const uint32_t MCT_ELEMENT_SIZE[] = {2, 4, 4, 8};
 typedef std::function<bool(void)> PROCEDURE_FUNC;
 
 class TileCache;
+class CodeblockCache;
 
 class CodeStream
 {
@@ -125,6 +126,10 @@ public:
   {
     return nullptr;
   }
+  virtual CodeblockCache* getCodeblockCache()
+  {
+    return nullptr;
+  }
 
 protected:
   bool exec(std::vector<PROCEDURE_FUNC>& procedureList);
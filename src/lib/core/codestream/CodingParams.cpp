@@ -109,6 +109,7 @@ struct ITileProcessorCompress;
 
 #include "TileComponentWindow.h"
 #include "PacketManager.h"
+#include "PacketOrder.h"
 #include "canvas/tile/TileComponent.h"
 #include "canvas/tile/Tile.h"
 #include "mct.h"
@@ -168,7 +169,8 @@ namespace
 CodingParams::CodingParams()
     : rsiz_(0), pcap_(0), ccap_{}, tx0_(0), ty0_(0), t_width_(0), t_height_(0), numComments_(0),
       comment_{}, commentLength_{}, isBinaryComment_{}, t_grid_width_(0), t_grid_height_(0),
-      asynchronous_(false), simulate_synchronous_(false), decompressCallback_(nullptr),
+      packetOrders_(std::make_unique<PacketOrderCache>()), asynchronous_(false),
+      simulate_synchronous_(false), decompressCallback_(nullptr),
       decompressCallbackUserData_(nullptr)
 {
   codingParams_ = {};
@@ -196,13 +198,22 @@ void CodingParams::init(grk_decompress_parameters* parameters,
   auto core = &parameters->core;
   codingParams_.dec_.reduce_ = core->reduce;
   codingParams_.dec_.disableRandomAccessFlags_ = core->disable_random_access_flags;
-  codingParams_.dec_.skipAllocateComposite_ = core->skip_allocate_composite;
+  // tiles stored straight into a caller's buffer never need the int32 composite
+  codingParams_.dec_.skipAllocateComposite_ =
+      core->skip_allocate_composite || core->output_buffer != nullptr;
   if(core->layers_to_decompress != codingParams_.dec_.layersToDecompress_ ||
-     core->reduce != codingParams_.dec_.reduce_)
+     core->reduce != codingParams_.dec_.reduce_ ||
+     core->target_precision != codingParams_.dec_.targetPrecision_ ||
+     core->pyramid_reductions != codingParams_.dec_.pyramidReductions_)
   {
     tileCache->setDirty(true);
   }
   codingParams_.dec_.layersToDecompress_ = core->layers_to_decompress;
+  codingParams_.dec_.targetPrecision_ = core->target_precision;
+  codingParams_.dec_.pyramidReductions_ = core->pyramid_reductions;
+  codingParams_.dec_.componentGroupSize_ = core->component_group_size;
+  codingParams_.dec_.scaledWidth_ = core->scaled_width;
+  codingParams_.dec_.scaledHeight_ = core->scaled_height;
   if(core->num_comps_to_decode > 0 && core->comps_to_decode)
     compsToDecompress_.assign(core->comps_to_decode,
                               core->comps_to_decode + core->num_comps_to_decode);
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <mutex>
 
@@ -402,6 +403,12 @@ struct EncodingParams
   uint32_t rateControlAlgorithm_;
   /* progressive rate control during T1 encoding */
   bool progressiveRateControl_;
+  /* memory-mapped sample source: tiles are filled from here instead of image data */
+  const uint8_t* pixelSource_;
+  uint64_t pixelSourceLength_;
+  uint8_t pixelSourceBytesPerSample_;
+  bool pixelSourceBigEndian_;
+  bool pixelSourceInterleaved_;
 };
 
 struct DecodingParams
@@ -414,6 +421,16 @@ struct DecodingParams
   uint16_t layersToDecompress_;
   uint32_t disableRandomAccessFlags_;
   bool skipAllocateComposite_;
+  /** if != 0, code blocks skip the bit planes that cannot move a sample by a step at this
+   *  precision */
+  uint8_t targetPrecision_;
+  /** bit k set: also emit the image at reduction k from the same decompress */
+  uint32_t pyramidReductions_;
+  /** if != 0, each tile's components are decompressed this many at a time */
+  uint16_t componentGroupSize_;
+  /** if != 0, the window is also resampled to scaledWidth_ x scaledHeight_ */
+  uint32_t scaledWidth_;
+  uint32_t scaledHeight_;
   // decided in CodeStreamDecompress::activateScratch and read back by TileProcessor, so the
   // tiles and the composite buffer can never pick different sample types
   bool use16BitDwt_;
@@ -445,6 +462,13 @@ private:
 };
 
 class TileCache;
+class PacketOrderCache;
+class GrkImage;
+struct Tile;
+namespace t1
+{
+  struct CompressBlockExec;
+}
 
 /**
  * Coding parameters
@@ -509,6 +533,8 @@ struct CodingParams
   std::vector<uint16_t> compsToDecompress_;
   std::unique_ptr<TLMMarker> tlmMarkers_;
   std::unique_ptr<PLMarker> plmMarkers_;
+  /** packet orders shared by tiles of the same geometry (see @ref PacketOrderCache) */
+  std::unique_ptr<PacketOrderCache> packetOrders_;
   bool asynchronous_;
   bool simulate_synchronous_;
   grk_decompress_callback decompressCallback_;
@@ -525,6 +551,36 @@ struct CodingParams
   };
   bool recordPacketLengths_ = false;
   std::vector<std::vector<RecordedPacketInfo>> recordedPacketInfo_; /* [tileIndex] → packets */
+  /**
+   * @brief Codeblock transcoding: a handler sees the tile's quantized wavelet coefficients
+   *
+   * On decompress, a set sink stops each tile after T1, with no inverse DWT, MCT or DC
+   * shift, and is passed the tile and its coding parameters. On compress, a set source
+   * fills the tile windows with coefficients in place of DC shift, forward MCT and DWT.
+   * A handler returning false fails the tile.
+   */
+  using TileHandler = std::function<bool(uint16_t tileIndex, Tile* tile, TileCodingParams* tcp)>;
+  TileHandler coefficientSink_;
+  TileHandler coefficientSource_;
+  /**
+   * @brief Truncating transcode: a handler sees code blocks as coded, with no T1
+   *
+   * On decompress, a set sink stops each tile after T2 and is passed the tile with the
+   * coding passes and data that its packets carry. On compress, a set source gives each
+   * code block its coding passes and data in place of T1; rate control and T2 then
+   * run as usual, on tiles with no DC shift, MCT or DWT.
+   */
+  using CodeblockHandler = std::function<bool(uint16_t tileIndex, t1::CompressBlockExec* block)>;
+  TileHandler codeblockSink_;
+  CodeblockHandler codeblockSource_;
+  /**
+   * @brief Band streaming: gets the composite image that each component group of a tile
+   * is copied into, and released, before the next group is decompressed
+   *
+   * Unset, or returning null, when the whole tile image is needed after the tile, e.g.
+   * by a callback, a tile cache or a single-tile image: the groups then stay in the tile.
+   */
+  std::function<GrkImage*(void)> componentGroupTarget_;
 };
 
 } // namespace grk
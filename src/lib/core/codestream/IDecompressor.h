@@ -119,6 +119,74 @@ public:
    */
   virtual void dump(uint32_t flag, FILE* outputFileStream) = 0;
 
+  /**
+   * @brief Gets decoded code block cache counters
+   *
+   * @param stats @ref grk_codeblock_cache_stats
+   * @return true if the decompressor has a code block cache
+   */
+  virtual bool getCodeblockCacheStats([[maybe_unused]] grk_codeblock_cache_stats* stats)
+  {
+    return false;
+  }
+
+  /**
+   * @brief Gets an overview level emitted by the last decompress
+   *
+   * @param reduction number of discarded resolution levels
+   * @return @ref GrkImage, or nullptr if that level was not emitted
+   */
+  virtual GrkImage* getPyramidImage([[maybe_unused]] uint8_t reduction)
+  {
+    return nullptr;
+  }
+
+  /**
+   * @brief Gets the scaled image of the last decompress
+   *
+   * @return @ref GrkImage, or nullptr if no scaled size was requested
+   */
+  virtual GrkImage* getScaledImage(void)
+  {
+    return nullptr;
+  }
+
+  /**
+   * @brief Gets memory budget counters
+   *
+   * @param stats @ref grk_memory_budget_stats
+   * @return true if the decompressor has a memory budget
+   */
+  virtual bool getMemoryBudgetStats([[maybe_unused]] grk_memory_budget_stats* stats)
+  {
+    return false;
+  }
+
+  /**
+   * @brief Schedules the tiles nearest a point first
+   *
+   * @param x reference grid x
+   * @param y reference grid y
+   * @return true if the decompressor schedules tiles by priority
+   */
+  virtual bool setFocus([[maybe_unused]] uint32_t x, [[maybe_unused]] uint32_t y)
+  {
+    return false;
+  }
+
+  /**
+   * @brief Sets a tile's scheduling priority: lower values are scheduled sooner
+   *
+   * @param tile_index tile index
+   * @param priority priority
+   * @return true if the decompressor schedules tiles by priority
+   */
+  virtual bool setTilePriority([[maybe_unused]] uint16_t tile_index,
+                               [[maybe_unused]] uint32_t priority)
+  {
+    return false;
+  }
+
   virtual uint32_t getNumSamples(void)
   {
     return 1;
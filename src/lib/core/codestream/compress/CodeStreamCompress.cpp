@@ -15,6 +15,7 @@
  *
  */
 
+#include <cinttypes>
 #include <optional>
 
 #include "TFSingleton.h"
@@ -61,6 +62,7 @@ struct ITileProcessor;
 #include "Qfactor.h"
 #include "TileProcessorCompress.h"
 #include "XYZTransform.h"
+#include "MappedFile.h"
 
 namespace grk
 {
@@ -102,6 +104,8 @@ static prog_order prog_order_list[] = {{GRK_CPRL, "CPRL"}, {GRK_LRCP, "LRCP"},
 
 CodeStreamCompress::CodeStreamCompress(IStream* stream) : CodeStream(stream), totalTileParts_(0) {}
 
+CodeStreamCompress::~CodeStreamCompress() = default;
+
 char* CodeStreamCompress::convertProgressionOrder(GRK_PROG_ORDER prg_order)
 {
   prog_order* po;
@@ -180,6 +184,73 @@ static void reduceComponentPrecision(grk_image_comp* comp, uint8_t targetPrec)
   comp->prec = targetPrec;
 }
 
+bool CodeStreamCompress::initPixelSource(grk_cparameters* parameters, GrkImage* image)
+{
+  auto src = &parameters->pixel_source;
+  cp_.codingParams_.enc_.pixelSource_ = nullptr;
+  if(!src->file[0])
+    return true;
+  if(parameters->apply_icc || parameters->apply_xyz_transform)
+  {
+    grklog.error("Pixel source cannot be combined with ICC or XYZ colour transforms");
+    return false;
+  }
+  if(src->bytes_per_sample != 1 && src->bytes_per_sample != 2)
+  {
+    grklog.error("Pixel source: unsupported sample size of %u bytes", src->bytes_per_sample);
+    return false;
+  }
+  auto comp0 = image->comps;
+  for(uint16_t i = 0; i < image->numcomps; ++i)
+  {
+    auto comp = image->comps + i;
+    if(comp->data)
+    {
+      grklog.error("Pixel source: image component %u must not carry its own data", i);
+      return false;
+    }
+    if(comp->dx != 1 || comp->dy != 1 || comp->w != comp0->w || comp->h != comp0->h ||
+       comp->sgnd != comp0->sgnd)
+    {
+      grklog.error("Pixel source: all components must have identical dimensions and "
+                   "signedness, with no subsampling");
+      return false;
+    }
+    if(comp->prec > 8U * src->bytes_per_sample)
+    {
+      grklog.error("Pixel source: component %u precision %u exceeds %u byte samples", i,
+                   comp->prec, src->bytes_per_sample);
+      return false;
+    }
+    if(GRK_IS_CINEMA(parameters->rsiz) && comp->prec > 12)
+    {
+      grklog.error("Pixel source: cinema profiles require precision <= 12 bits");
+      return false;
+    }
+  }
+  pixelSourceView_ = std::make_unique<MappedFileView>();
+  if(!pixelSourceView_->open(src->file, src->interleaved ? GrkAccessPattern::ACCESS_NORMAL
+                                                          : GrkAccessPattern::ACCESS_RANDOM))
+    return false;
+  uint64_t needed =
+      (uint64_t)comp0->w * comp0->h * image->numcomps * src->bytes_per_sample + src->offset;
+  if(pixelSourceView_->size() < needed)
+  {
+    grklog.error("Pixel source %s: file length %" PRIu64 " is less than the %" PRIu64
+                 " bytes the image needs",
+                 src->file, pixelSourceView_->size(), needed);
+    return false;
+  }
+  auto enc = &cp_.codingParams_.enc_;
+  enc->pixelSource_ = pixelSourceView_->data() + src->offset;
+  enc->pixelSourceLength_ = needed - src->offset;
+  enc->pixelSourceBytesPerSample_ = src->bytes_per_sample;
+  enc->pixelSourceBigEndian_ = src->big_endian;
+  enc->pixelSourceInterleaved_ = src->interleaved;
+
+  return true;
+}
+
 bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 {
   if(!parameters || !image)
@@ -216,6 +287,9 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
       return false;
     }
   }
+  if(!initPixelSource(parameters, image))
+    return false;
+
   if(parameters->apply_icc)
     image->applyICC<int32_t>();
 
@@ -266,13 +340,18 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 
   if(isHT)
   {
-    if(parameters->numlayers > 1 || parameters->layer_rate[0] != 0)
+    // HT code blocks are truncated once, by rate control, so there is a single layer,
+    // built to the final layer's target
+    if(parameters->numlayers > 1)
     {
-      grklog.warn("Rate control not supported for HTJ2K compression.");
+      grklog.warn("HTJ2K compression supports a single quality layer: "
+                  "using the final layer's target");
+      parameters->layer_rate[0] = parameters->layer_rate[parameters->numlayers - 1];
+      parameters->layer_distortion[0] = parameters->layer_distortion[parameters->numlayers - 1];
       parameters->numlayers = 1;
-      parameters->layer_rate[0] = 0;
     }
-    parameters->allocation_by_rate_distortion = true;
+    if(!parameters->allocation_by_quality)
+      parameters->allocation_by_rate_distortion = true;
   }
 
   if((parameters->numresolution == 0) || (parameters->numresolution > GRK_MAXRLVLS))
@@ -569,15 +648,15 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
         if(tileno == parameters->progression[i].tileno)
         {
           auto tcp_poc = tcp->progressionOrderChange_ + numTileProgressions;
-
-          tcp_poc->res_s = parameters->progression[numTileProgressions].res_s;
-          tcp_poc->comp_s = parameters->progression[numTileProgressions].comp_s;
-          tcp_poc->lay_e = parameters->progression[numTileProgressions].lay_e;
-          tcp_poc->res_e = parameters->progression[numTileProgressions].res_e;
-          tcp_poc->comp_e = parameters->progression[numTileProgressions].comp_e;
-          tcp_poc->specified_compression_poc_prog =
-              parameters->progression[numTileProgressions].specified_compression_poc_prog;
-          tcp_poc->tileno = parameters->progression[numTileProgressions].tileno;
+          auto poc = parameters->progression + i;
+
+          tcp_poc->res_s = poc->res_s;
+          tcp_poc->comp_s = poc->comp_s;
+          tcp_poc->lay_e = poc->lay_e;
+          tcp_poc->res_e = poc->res_e;
+          tcp_poc->comp_e = poc->comp_e;
+          tcp_poc->specified_compression_poc_prog = poc->specified_compression_poc_prog;
+          tcp_poc->tileno = poc->tileno;
           numTileProgressions++;
         }
       }
@@ -818,7 +897,18 @@ uint64_t CodeStreamCompress::compress(grk_plugin_tile* tile)
   for(uint16_t i = 0; i < numTiles; ++i)
     tileProcessors[i] = new TileProcessorCompress(i, cp_.tcps_.get(i), this, stream_);
 
-  // Phase 1: preCompress all tiles (parallel via TFSingleton)
+  // Phase 1: preCompress all tiles (parallel via TFSingleton). A coefficient source
+  // may decompress its own source as each tile asks, which must not block a worker,
+  // so its tiles are prepared in turn on this thread.
+  if(cp_.coefficientSource_)
+  {
+    for(uint16_t j = 0; j < numTiles && success; ++j)
+    {
+      if(!tileProcessors[j]->preCompressTile(0))
+        success = false;
+    }
+  }
+  else
   {
     tf::Taskflow preFlow;
     for(uint16_t j = 0; j < numTiles; ++j)
@@ -972,7 +1062,7 @@ bool CodeStreamCompress::init_header_writing(void)
   if(cp_.codingParams_.enc_.writeTlm_)
     procedureList_.push_back(std::bind(&CodeStreamCompress::write_tlm_begin, this));
   if(cp_.tcps_.get(0)->hasPoc())
-    procedureList_.push_back(std::bind(&CodeStreamCompress::writePoc, this));
+    procedureList_.push_back(std::bind(&CodeStreamCompress::writePoc, this, cp_.tcps_.get(0)));
 
   procedureList_.push_back(std::bind(&CodeStreamCompress::write_regions, this));
   procedureList_.push_back(std::bind(&CodeStreamCompress::write_com, this));
@@ -1000,9 +1090,9 @@ bool CodeStreamCompress::writeTilePart(ITileProcessorCompress* tileProcessor)
   // 2. write POC marker to first tile part
   if(tileProcessor->canWritePocMarker())
   {
-    if(!writePoc())
-      return false;
     auto tcp = cp_.tcps_.get(tileProcessor->getIndex());
+    if(!writePoc(tcp))
+      return false;
     tilePartBytesWritten += getPocSize(headerImage_->numcomps, tcp->getNumProgressions());
   }
   // 3. compress tile part and write to stream
@@ -1346,9 +1436,8 @@ bool CodeStreamCompress::compare_qcc(uint16_t first_comp_no, uint16_t second_com
 {
   return compare_SQcd_SQcc(first_comp_no, second_comp_no);
 }
-bool CodeStreamCompress::writePoc()
+bool CodeStreamCompress::writePoc(TileCodingParams* tcp)
 {
-  auto tcp = cp_.tcps_.get(0);
   auto tccp = tcp->tccps_;
   auto image = getHeaderImage();
   uint16_t numComps = image->numcomps;
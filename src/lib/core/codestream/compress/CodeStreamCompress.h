@@ -20,11 +20,13 @@
 namespace grk
 {
 
+class MappedFileView;
+
 class CodeStreamCompress : public CodeStream, public ICompressor
 {
 public:
   explicit CodeStreamCompress(IStream* stream);
-  virtual ~CodeStreamCompress() = default;
+  virtual ~CodeStreamCompress();
 
   static char* convertProgressionOrder(GRK_PROG_ORDER prg_order);
   static uint16_t getPocSize(uint16_t num_components, uint32_t l_nb_poc);
@@ -124,8 +126,9 @@ private:
   /**
    * Writes the POC marker (Progression Order Change)
    *
+   * @param tcp coding parameters of the tile whose progressions are written
    */
-  bool writePoc();
+  bool writePoc(TileCodingParams* tcp);
 
   /**
    * End writing the updated tlm.
@@ -305,6 +308,16 @@ private:
 
   bool init_mct_encoding(TileCodingParams* tcp, GrkImage* image);
 
+  /**
+   * @brief Validates the memory-mapped sample source (if any) and maps its file
+   *
+   * @param       parameters  compression parameters
+   * @param       image       image describing the geometry of the mapped samples
+   *
+   * @return true if there is no pixel source, or it is valid and mapped
+   */
+  bool initPixelSource(grk_cparameters* parameters, GrkImage* image);
+
   uint32_t totalTileParts_;
 
   /**
@@ -322,6 +335,11 @@ private:
    * @brief Worker count of localExecutor_, reported to TFSingleton while it is active.
    */
   size_t localNumThreads_ = 1;
+
+  /**
+   * @brief Mapping backing EncodingParams::pixelSource_, when a pixel source is set
+   */
+  std::unique_ptr<MappedFileView> pixelSourceView_;
 };
 
 } // namespace grk
@@ -0,0 +1,659 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#include "TFSingleton.h"
+#include "CodeStreamLimits.h"
+#include "TileWindow.h"
+#include "Quantizer.h"
+#include "Logger.h"
+#include "buffer.h"
+#include "GrkObjectWrapper.h"
+#include "TileFutureManager.h"
+#include "FlowComponent.h"
+#include "IStream.h"
+#include "FetchCommon.h"
+#include "TPFetchSeq.h"
+#include "GrkImageMeta.h"
+#include "GrkImage.h"
+#include "ICompressor.h"
+#include "IDecompressor.h"
+#include "MarkerParser.h"
+#include "PLMarker.h"
+#include "SIZMarker.h"
+#include "PPMMarker.h"
+namespace grk
+{
+struct ITileProcessor;
+}
+#include "CodeStream.h"
+#include "PacketLengthCache.h"
+#include "ICoder.h"
+#include "CoderPool.h"
+#include "BitIO.h"
+#include "TagTree.h"
+#include "CodeblockCompress.h"
+#include "CodeblockDecompress.h"
+#include "Precinct.h"
+#include "Subband.h"
+#include "Resolution.h"
+#include "TileComponentWindow.h"
+#include "canvas/tile/Tile.h"
+#include "BlockExec.h"
+#include "BlockCoder.h"
+#include "FileFormatJP2Family.h"
+#include "FileFormatJP2Decompress.h"
+#include "Codec.h"
+#include "CodeblockTranscoder.h"
+
+namespace grk
+{
+
+namespace
+{
+  /**
+   * @brief Calls f(band, x, y) for each sub-band of a tile component, with the offset
+   * of the band in the highest resolution buffer
+   */
+  template<typename F>
+  void forEachBand(TileComponent* tilec, F&& f)
+  {
+    for(uint8_t resno = 0; resno < tilec->num_resolutions_; ++resno)
+    {
+      auto res = tilec->resolutions_ + resno;
+      for(uint8_t bandIndex = 0; bandIndex < res->numBands_; ++bandIndex)
+      {
+        auto band = res->band + bandIndex;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        if(resno > 0)
+        {
+          auto lower = tilec->resolutions_ + resno - 1;
+          if(band->orientation_ & 1)
+            x = lower->width();
+          if(band->orientation_ & 2)
+            y = lower->height();
+        }
+        f(band, x, y);
+      }
+    }
+  }
+
+} // namespace
+
+bool CodeblockTranscoder::ComponentCoding::sameStructure(const ComponentCoding& rhs) const
+{
+  return csty == rhs.csty && numresolutions == rhs.numresolutions && cblkw == rhs.cblkw &&
+         cblkh == rhs.cblkh && qmfbid == rhs.qmfbid && numgbits == rhs.numgbits &&
+         memcmp(precWidthExp, rhs.precWidthExp, sizeof(precWidthExp)) == 0 &&
+         memcmp(precHeightExp, rhs.precHeightExp, sizeof(precHeightExp)) == 0;
+}
+
+CodeblockTranscoder::CodeblockTranscoder(Mode mode) : mode_(mode) {}
+
+CodeblockTranscoder::~CodeblockTranscoder()
+{
+  grk_object_unref(source_);
+}
+
+bool CodeblockTranscoder::failed(void) const
+{
+  return failed_;
+}
+
+const char* CodeblockTranscoder::label(void) const
+{
+  return mode_ == Mode::HT ? "HT transcode" : "Truncating transcode";
+}
+
+void CodeblockTranscoder::record(TileCoefficients& t, Tile* tile, TileCodingParams* tcp)
+{
+  t.ht = tcp->isHT();
+  t.csty = tcp->csty_;
+  t.prg = tcp->prg_;
+  t.mct = tcp->mct_;
+  t.numLayers = tcp->numLayers_;
+  t.coding.resize(tile->numcomps_);
+  for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+  {
+    auto tccp = tcp->tccps_ + compno;
+    auto& coding = t.coding[compno];
+    coding.csty = tccp->csty_;
+    coding.cblkSty = tccp->cblkStyle_;
+    coding.numresolutions = tccp->numresolutions_;
+    coding.cblkw = tccp->cblkw_expn_;
+    coding.cblkh = tccp->cblkh_expn_;
+    coding.qmfbid = tccp->qmfbid_;
+    coding.numgbits = tccp->numgbits_;
+    coding.roishift = tccp->roishift_;
+    coding.part2 = tccp->usesPart2Transform();
+    memcpy(coding.precWidthExp, tccp->precWidthExp_, sizeof(coding.precWidthExp));
+    memcpy(coding.precHeightExp, tccp->precHeightExp_, sizeof(coding.precHeightExp));
+    coding.steps.clear();
+    if(!coding.part2)
+    {
+      for(uint8_t b = 0; b < tccp->numStepSizesNeeded(); ++b)
+        coding.steps.push_back(
+            (uint16_t)((tccp->stepsizes_[b].expn << 11) | tccp->stepsizes_[b].mant));
+    }
+  }
+}
+
+bool CodeblockTranscoder::capture(uint16_t tileIndex, Tile* tile, TileCodingParams* tcp)
+{
+  if(tileIndex >= tiles_.size())
+    return false;
+  auto& t = tiles_[tileIndex];
+  record(t, tile, tcp);
+  t.widths.resize(tile->numcomps_);
+  t.heights.resize(tile->numcomps_);
+  t.samples.resize(tile->numcomps_);
+  for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+  {
+    auto tilec = tile->comps_ + compno;
+    auto tccp = tcp->tccps_ + compno;
+    const auto& coding = t.coding[compno];
+
+    auto window = tilec->getWindow();
+    if(!window || tilec->is16BitDwt())
+      return false;
+    auto src = window->getResWindowBufferHighestSimple();
+    uint32_t w = tilec->width();
+    uint32_t h = tilec->height();
+    t.widths[compno] = w;
+    t.heights[compno] = h;
+    auto& samples = t.samples[compno];
+    samples.resize((size_t)w * h);
+    if(src.buf_)
+    {
+      for(uint32_t j = 0; j < h; ++j)
+        memcpy(samples.data() + (size_t)j * w, src.buf_ + (size_t)j * src.stride_,
+               (size_t)w * sizeof(int32_t));
+    }
+    // the decoder scaled irreversible samples by half the step size
+    if(tccp->qmfbid_ == 0 && !coding.part2)
+    {
+      forEachBand(tilec, [&](Subband* band, uint32_t x, uint32_t y) {
+        float scale = band->stepsize_ / 2;
+        for(uint32_t j = 0; j < band->height(); ++j)
+        {
+          auto row = samples.data() + (size_t)(y + j) * w + x;
+          for(uint32_t i = 0; i < band->width(); ++i)
+            row[i] = (int32_t)std::lround(std::bit_cast<float>(row[i]) / scale);
+        }
+      });
+    }
+  }
+  t.captured = true;
+
+  return true;
+}
+
+bool CodeblockTranscoder::decompressTile(uint16_t tileIndex)
+{
+  // the source decompresses one tile at a time
+  std::lock_guard<std::mutex> lock(sourceMutex_);
+  if(!source_ || !grk_decompress_tile(source_, tileIndex) || !tiles_[tileIndex].captured)
+  {
+    grklog.error("%s: failed to decompress source tile %u", label(), tileIndex);
+    return false;
+  }
+  const auto& first = tiles_.front();
+  const auto& t = tiles_[tileIndex];
+  if(t.ht != first.ht || t.mct != first.mct || t.coding != first.coding)
+  {
+    grklog.error("%s: tile %u is coded differently from tile 0", label(), tileIndex);
+    return false;
+  }
+
+  return true;
+}
+
+bool CodeblockTranscoder::fill(uint16_t tileIndex, Tile* tile,
+                               [[maybe_unused]] TileCodingParams* tcp)
+{
+  if(tileIndex >= tiles_.size() || (!tiles_[tileIndex].captured && !decompressTile(tileIndex)))
+    return false;
+  auto& t = tiles_[tileIndex];
+  if(t.samples.size() != tile->numcomps_)
+  {
+    grklog.error("%s: no source coefficients for tile %u", label(), tileIndex);
+    return false;
+  }
+  for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+  {
+    auto tilec = tile->comps_ + compno;
+    uint32_t w = tilec->width();
+    uint32_t h = tilec->height();
+    if(w != t.widths[compno] || h != t.heights[compno])
+    {
+      grklog.error("%s: tile %u component %u is %ux%u, but %ux%u in the source", label(),
+                   tileIndex, compno, w, h, t.widths[compno], t.heights[compno]);
+      return false;
+    }
+    auto& samples = t.samples[compno];
+    // the HT coder quantizes irreversible samples with the compressor's step sizes
+    if(t.coding[compno].qmfbid == 0)
+    {
+      forEachBand(tilec, [&](Subband* band, uint32_t x, uint32_t y) {
+        float scale = band->stepsize_ / 2;
+        for(uint32_t j = 0; j < band->height(); ++j)
+        {
+          auto row = samples.data() + (size_t)(y + j) * w + x;
+          for(uint32_t i = 0; i < band->width(); ++i)
+            row[i] = std::bit_cast<int32_t>((float)row[i] * scale);
+        }
+      });
+    }
+    auto dest = tilec->getWindow()->getResWindowBufferHighestSimple();
+    if(!dest.buf_)
+      return false;
+    for(uint32_t j = 0; j < h; ++j)
+      memcpy(dest.buf_ + (size_t)j * dest.stride_, samples.data() + (size_t)j * w,
+             (size_t)w * sizeof(int32_t));
+    std::vector<int32_t>().swap(samples);
+  }
+  t.captured = false;
+
+  return true;
+}
+
+bool CodeblockTranscoder::captureBlocks(uint16_t tileIndex, Tile* tile, TileCodingParams* tcp)
+{
+  if(tileIndex >= tiles_.size())
+    return false;
+  auto& t = tiles_[tileIndex];
+  record(t, tile, tcp);
+  if(t.ht)
+  {
+    t.captured = true;
+    return true;
+  }
+  for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+  {
+    auto tilec = tile->comps_ + compno;
+    for(uint8_t resno = 0; resno < tilec->num_resolutions_; ++resno)
+    {
+      auto res = tilec->resolutions_ + resno;
+      for(uint8_t bandIndex = 0; bandIndex < res->numBands_; ++bandIndex)
+      {
+        auto band = res->band + bandIndex;
+        for(auto prc : band->precincts_)
+        {
+          for(uint32_t cblkno = 0; cblkno < prc->getNumCblks(); ++cblkno)
+          {
+            auto cblk = prc->tryGetDecompressBlock(cblkno);
+            if(!cblk || !cblk->getNumDataParsedSegments())
+              continue;
+            SourceBlock block;
+            block.numbps = cblk->numbps();
+            for(uint16_t segno = 0; segno < cblk->getNumDataParsedSegments(); ++segno)
+            {
+              auto seg = cblk->getSegment(segno);
+              size_t offset = block.data.size();
+              block.data.resize(offset + seg->getDataChunksLength());
+              seg->copyDataChunksToContiguous(block.data.data() + offset);
+              // the layers that added passes to the segment, as far as data was parsed
+              uint8_t passes = 0;
+              uint32_t bytes = 0;
+              for(uint16_t layno = 0; layno < seg->numLayers_; ++layno)
+              {
+                uint8_t layerPasses = seg->calculatedPassesInLayer_[layno];
+                if(!layerPasses)
+                  continue;
+                if(passes + layerPasses > seg->totalPasses_)
+                  break;
+                passes = (uint8_t)(passes + layerPasses);
+                bytes += seg->signalledBytesInLayer_[layno];
+                block.contributions.push_back(
+                    {layerPasses, seg->signalledBytesInLayer_[layno], false});
+              }
+              if(passes != seg->totalPasses_ || bytes != block.data.size() - offset)
+              {
+                grklog.error("%s: tile %u has a code block whose segment %u can't be split "
+                             "into layer contributions",
+                             label(), tileIndex, segno);
+                return false;
+              }
+              if(!block.contributions.empty() && seg->totalPasses_ == seg->maxPasses_)
+                block.contributions.back().term = true;
+            }
+            BlockKey key{compno, resno, band->orientation_, cblk->x0(), cblk->y0()};
+            t.blocks.emplace(key, std::move(block));
+          }
+        }
+      }
+    }
+  }
+  t.captured = true;
+
+  return true;
+}
+
+bool CodeblockTranscoder::fillBlock(uint16_t tileIndex, t1::CompressBlockExec* block)
+{
+  auto cblk = block->cblk;
+  cblk->setNumBps(0);
+  cblk->setNumPasses(0);
+  block->distortion = 0;
+  if(tileIndex >= tiles_.size())
+  {
+    failed_ = true;
+    return false;
+  }
+  // a block that no source packet included stays empty
+  const auto& blocks = tiles_[tileIndex].blocks;
+  auto it = blocks.find(
+      BlockKey{block->compno, block->resno, (uint8_t)block->bandOrientation, cblk->x0(),
+               cblk->y0()});
+  if(it == blocks.end())
+    return true;
+  const auto& src = it->second;
+  uint32_t numPasses = 0;
+  for(const auto& c : src.contributions)
+    numPasses += c.passes;
+  if(!numPasses)
+    return true;
+  if(src.data.size() > cblk->getCompressedStreamCapacity() || numPasses > 3 * 32 - 2 ||
+     src.numbps == 0)
+  {
+    grklog.error("%s: tile %u has a code block with %u passes and %u bytes that can't be kept",
+                 label(), tileIndex, numPasses, (uint32_t)src.data.size());
+    failed_ = true;
+    return false;
+  }
+  memcpy(cblk->getPaddedCompressedStream(), src.data.data(), src.data.size());
+  cblk->setNumBps(src.numbps);
+  cblk->setNumPasses((uint8_t)numPasses);
+
+  // Distortion decrease is estimated without decoding: each byte of a contribution
+  // is taken to reduce the squared error in proportion to the square of the weighted
+  // magnitude of the bit plane its pass codes. Only the last pass of a contribution
+  // is a truncation point, the others add neither bytes nor distortion decrease.
+  double w1 = 1.0;
+  if(block->mct_norms && block->compno < block->mct_numcomps)
+    w1 = block->mct_norms[block->compno];
+  double w2 = t1::BlockCoder::getnorm(block->level, block->bandOrientation, block->qmfbid == 1);
+  double weight = w1 * w2 * block->stepsize;
+  weight *= weight;
+  uint8_t passno = 0;
+  uint32_t rate = 0;
+  double distortion = 0;
+  for(const auto& c : src.contributions)
+  {
+    double planeEnergy = 0;
+    for(uint8_t i = 0; i < c.passes; ++i)
+    {
+      // pass 0 is the first cleanup pass, then three passes for each lower bit plane
+      int32_t plane = (int32_t)src.numbps - 1 - (passno + i + 2) / 3;
+      planeEnergy += std::ldexp(1.0, 2 * std::max(plane, 0));
+    }
+    rate += c.bytes;
+    distortion += weight * planeEnergy * c.bytes / c.passes;
+    for(uint8_t i = 0; i < c.passes; ++i, ++passno)
+    {
+      auto pass = cblk->getPass(passno);
+      bool last = i == c.passes - 1;
+      pass->rate_ = (uint16_t)rate;
+      pass->distortiondec_ = distortion;
+      pass->len_ = last ? c.bytes : 0;
+      pass->term_ = last && c.term;
+      pass->slope_ = 0;
+    }
+  }
+  block->distortion = distortion;
+
+  return true;
+}
+
+bool CodeblockTranscoder::validate(size_t numTiles)
+{
+  if(tiles_.empty() || numTiles > tiles_.size())
+    return false;
+  for(uint16_t i = 0; i < numTiles; ++i)
+  {
+    if(!tiles_[i].captured)
+    {
+      grklog.error("%s: tile %u of the source was not decompressed", label(), i);
+      return false;
+    }
+  }
+  const auto& first = tiles_.front();
+  if(first.ht)
+  {
+    grklog.error(mode_ == Mode::HT ? "%s: the source is already HTJ2K"
+                                   : "%s: HTJ2K sources are not supported",
+                 label());
+    return false;
+  }
+  if(first.mct == 2)
+  {
+    grklog.error("%s: custom multi-component transforms are not supported", label());
+    return false;
+  }
+  for(uint16_t compno = 0; compno < first.coding.size(); ++compno)
+  {
+    const auto& coding = first.coding[compno];
+    if(coding.part2)
+    {
+      grklog.error("%s: Part 2 wavelet decompositions are not supported", label());
+      return false;
+    }
+    if(coding.roishift)
+    {
+      grklog.error("%s: region of interest shifts are not supported", label());
+      return false;
+    }
+    // the compressor codes every component with the same structure, and truncated
+    // blocks keep their coding style
+    if(!coding.sameStructure(first.coding.front()) ||
+       (mode_ == Mode::Truncate && coding.cblkSty != first.coding.front().cblkSty))
+    {
+      grklog.error("%s: component %u is coded differently from component 0", label(),
+                   compno);
+      return false;
+    }
+  }
+  for(uint16_t i = 1; i < numTiles; ++i)
+  {
+    const auto& t = tiles_[i];
+    if(t.ht != first.ht || t.mct != first.mct || t.coding != first.coding)
+    {
+      grklog.error("%s: tile %u is coded differently from tile 0", label(), i);
+      return false;
+    }
+  }
+  if(first.numLayers > 1)
+    grklog.info("%s: merging %u quality layers into one", label(), first.numLayers);
+
+  return true;
+}
+
+bool CodeblockTranscoder::decompress(const grk_stream_params* src, grk_cparameters* parameters)
+{
+  grk_stream_params streamParams = *src;
+  streamParams.is_read_stream = true;
+  grk_decompress_parameters decompressParams{};
+  decompressParams.core.skip_allocate_composite = true;
+  decompressParams.core.layers_to_decompress = parameters->max_layers_transcode;
+  auto codec = grk_decompress_init(&streamParams, &decompressParams);
+  if(!codec)
+  {
+    grklog.error("%s: failed to open the source", label());
+    return false;
+  }
+  grk_header_info header{};
+  bool rc = grk_decompress_read_header(codec, &header);
+  CodingParams* cp = nullptr;
+  if(rc)
+  {
+    auto decompressor = Codec::getImpl(codec)->decompressor_;
+    if(auto jp2 = dynamic_cast<FileFormatJP2Decompress*>(decompressor))
+      cp = jp2->getCodingParams();
+    else if(auto j2k = dynamic_cast<CodeStream*>(decompressor))
+      cp = j2k->getCodingParams();
+    rc = cp != nullptr;
+  }
+  if(rc)
+  {
+    tiles_.clear();
+    tiles_.resize((size_t)cp->t_grid_width_ * cp->t_grid_height_);
+    tx0_ = cp->tx0_;
+    ty0_ = cp->ty0_;
+    tileWidth_ = cp->t_width_;
+    tileHeight_ = cp->t_height_;
+    // tiles are captured concurrently, each into its own entry
+    auto& sink = mode_ == Mode::HT ? cp->coefficientSink_ : cp->codeblockSink_;
+    if(mode_ == Mode::HT)
+      sink = [this](uint16_t tileIndex, Tile* tile, TileCodingParams* tcp) {
+        return capture(tileIndex, tile, tcp);
+      };
+    else
+      sink = [this](uint16_t tileIndex, Tile* tile, TileCodingParams* tcp) {
+        return captureBlocks(tileIndex, tile, tcp);
+      };
+    // coefficients are decompressed tile by tile as the compressor fills its tiles,
+    // starting with the first tile here for the coding to reproduce. Coded blocks
+    // are all kept, since rate control truncates them against the whole stream.
+    if(mode_ == Mode::HT)
+    {
+      rc = grk_decompress_tile(codec, 0);
+      source_ = codec;
+      codec = nullptr;
+    }
+    else
+    {
+      rc = grk_decompress(codec, nullptr);
+      sink = nullptr;
+    }
+  }
+  grk_object_unref(codec);
+  if(!rc)
+  {
+    grklog.error("%s: failed to decompress the source", label());
+    return false;
+  }
+  if(!validate(mode_ == Mode::HT ? 1 : tiles_.size()))
+    return false;
+
+  const auto& first = tiles_.front();
+  const auto& coding = first.coding.front();
+  parameters->tile_size_on = true;
+  parameters->tx0 = tx0_;
+  parameters->ty0 = ty0_;
+  parameters->t_width = tileWidth_;
+  parameters->t_height = tileHeight_;
+  parameters->numresolution = coding.numresolutions;
+  parameters->cblockw_init = 1U << coding.cblkw;
+  parameters->cblockh_init = 1U << coding.cblkh;
+  parameters->cblk_sty = mode_ == Mode::HT ? GRK_CBLKSTY_HT_ONLY : coding.cblkSty;
+  parameters->irreversible = coding.qmfbid == 0;
+  parameters->mct = first.mct;
+  parameters->numgbits = coding.numgbits;
+  parameters->csty = first.csty;
+  if(parameters->write_sop)
+    parameters->csty |= CP_CSTY_SOP;
+  if(parameters->write_eph)
+    parameters->csty |= CP_CSTY_EPH;
+  parameters->res_spec = 0;
+  if(coding.csty & CCP_CSTY_PRECINCT)
+  {
+    // attach() sets the exact exponents, these only select custom precincts
+    parameters->res_spec = coding.numresolutions;
+    for(uint8_t p = 0; p < coding.numresolutions; ++p)
+    {
+      uint8_t resno = (uint8_t)(coding.numresolutions - 1 - p);
+      parameters->prcw_init[p] = 1U << coding.precWidthExp[resno];
+      parameters->prch_init[p] = 1U << coding.precHeightExp[resno];
+    }
+  }
+  parameters->prog_order = parameters->transcode_prog_order != GRK_PROG_UNKNOWN
+                               ? parameters->transcode_prog_order
+                               : first.prg;
+  parameters->numpocs = 0;
+  parameters->numlayers = 1;
+  parameters->layer_rate[0] = 0;
+  parameters->allocation_by_rate_distortion = mode_ == Mode::Truncate;
+  parameters->allocation_by_quality = false;
+  parameters->max_cs_size = mode_ == Mode::Truncate ? parameters->transcode_target_size : 0;
+  parameters->qfactor = 0;
+  parameters->roi_compno = -1;
+  parameters->roi_shift = 0;
+
+  return true;
+}
+
+bool CodeblockTranscoder::attach(CodingParams* cp, uint16_t numcomps)
+{
+  const auto& first = tiles_.front();
+  if(numcomps != first.coding.size())
+  {
+    grklog.error("%s: the image has %u components, the source %u", label(), numcomps,
+                 (uint32_t)first.coding.size());
+    return false;
+  }
+  if((size_t)cp->t_grid_width_ * cp->t_grid_height_ != tiles_.size())
+  {
+    grklog.error("%s: the tile grid differs from the source", label());
+    return false;
+  }
+  for(uint16_t tileIndex = 0; tileIndex < tiles_.size(); ++tileIndex)
+  {
+    auto tcp = cp->tcps_.get(tileIndex);
+    if(tcp->mct_ != first.mct)
+    {
+      grklog.error("%s: the source multi-component transform can't be kept", label());
+      return false;
+    }
+    for(uint16_t compno = 0; compno < numcomps; ++compno)
+    {
+      auto tccp = tcp->tccps_ + compno;
+      const auto& coding = first.coding[compno];
+      if(tccp->numresolutions_ != coding.numresolutions)
+      {
+        grklog.error("%s: the source's %u resolutions can't be kept", label(),
+                     coding.numresolutions);
+        return false;
+      }
+      tccp->csty_ = coding.csty & CCP_CSTY_PRECINCT;
+      memcpy(tccp->precWidthExp_, coding.precWidthExp, sizeof(coding.precWidthExp));
+      memcpy(tccp->precHeightExp_, coding.precHeightExp, sizeof(coding.precHeightExp));
+      for(size_t b = 0; b < coding.steps.size(); ++b)
+      {
+        tccp->stepsizes_[b].expn = (uint8_t)(coding.steps[b] >> 11);
+        tccp->stepsizes_[b].mant = (uint16_t)(coding.steps[b] & 0x7FF);
+      }
+    }
+    // CAP and any other marker derived from the quantizer must see the same steps
+    tcp->qcd_->push(tcp->tccps_->stepsizes_);
+  }
+  if(mode_ == Mode::HT)
+    cp->coefficientSource_ = [this](uint16_t tileIndex, Tile* tile, TileCodingParams* tcp) {
+      return fill(tileIndex, tile, tcp);
+    };
+  else
+    cp->codeblockSource_ = [this](uint16_t tileIndex, t1::CompressBlockExec* block) {
+      return fillBlock(tileIndex, block);
+    };
+
+  return true;
+}
+
+} // namespace grk
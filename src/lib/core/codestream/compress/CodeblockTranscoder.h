@@ -0,0 +1,254 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace grk
+{
+
+struct CodingParams;
+struct TileCodingParams;
+struct Tile;
+namespace t1
+{
+  struct CompressBlockExec;
+}
+
+/**
+ * @class CodeblockTranscoder
+ * @brief Transcodes a Part 1 code stream code block by code block
+ *
+ * Tiling, code blocks, precincts, wavelet and quantization are those of the source,
+ * and there is no inverse or forward DWT, MCT or DC shift.
+ *
+ * In @ref Mode::HT, the source is decompressed only as far as T1: its quantized
+ * coefficients are handed to the compressor in the wavelet domain, which codes them
+ * again with the HT block coder. Both block coders run in parallel across code blocks.
+ * Each source tile is decompressed when the compressor asks for it, and its
+ * coefficients are released once handed over, so no more than one source tile is held.
+ * A source whose code blocks end on a bit plane, as every block of a single layer or
+ * fully decoded stream does, is transcoded losslessly.
+ *
+ * In @ref Mode::Truncate, the source is decompressed only as far as T2: each code
+ * block's coded bytes are handed to the compressor in place of T1, with a distortion
+ * decrease for each contribution estimated from its length and bit planes. Rate
+ * control truncates the blocks to the target size, and T2 writes new packets.
+ */
+class CodeblockTranscoder
+{
+public:
+  /**
+   * @brief What the transcode does with the source's code blocks
+   */
+  enum class Mode
+  {
+    /** code the coefficients again with the HT block coder */
+    HT,
+    /** truncate the coded blocks to a target size */
+    Truncate
+  };
+
+  /**
+   * @brief Constructs a CodeblockTranscoder
+   *
+   * @param mode @ref Mode of the transcode
+   */
+  explicit CodeblockTranscoder(Mode mode = Mode::HT);
+
+  /**
+   * @brief Destroys a CodeblockTranscoder, closing the source
+   */
+  ~CodeblockTranscoder();
+
+  /**
+   * @brief Decompresses the source to its coefficients or coded blocks, and sets the
+   * compress parameters that reproduce its coding in the transcode
+   *
+   * In @ref Mode::HT, only the first tile is decompressed here, and the source stays
+   * open for the others
+   *
+   * @param src source stream
+   * @param parameters @ref grk_cparameters to update
+   * @return true if successful
+   */
+  bool decompress(const grk_stream_params* src, grk_cparameters* parameters);
+
+  /**
+   * @brief Gives an initialized compressor the source step sizes and precincts, and
+   * its tiles the source coefficients or coded blocks
+   *
+   * @param cp compressor @ref CodingParams
+   * @param numcomps number of image components
+   * @return true if successful
+   */
+  bool attach(CodingParams* cp, uint16_t numcomps);
+
+  /**
+   * @brief true if a code block could not be given its source coding passes
+   */
+  bool failed(void) const;
+
+private:
+  /**
+   * @struct ComponentCoding
+   * @brief Coding parameters of a tile component that the transcode must keep
+   */
+  struct ComponentCoding
+  {
+    uint8_t csty = 0;
+    uint8_t cblkSty = 0;
+    uint8_t numresolutions = 0;
+    uint8_t cblkw = 0;
+    uint8_t cblkh = 0;
+    uint8_t qmfbid = 0;
+    uint8_t numgbits = 0;
+    uint8_t roishift = 0;
+    bool part2 = false;
+    uint8_t precWidthExp[GRK_MAXRLVLS] = {};
+    uint8_t precHeightExp[GRK_MAXRLVLS] = {};
+    /** (exponent << 11) | mantissa of each band */
+    std::vector<uint16_t> steps;
+    /**
+     * @brief true if @p rhs differs at most in step sizes
+     */
+    bool sameStructure(const ComponentCoding& rhs) const;
+    bool operator==(const ComponentCoding& rhs) const = default;
+  };
+
+  /**
+   * @struct BlockKey
+   * @brief Identifies a code block by component, resolution, band and canvas origin
+   */
+  struct BlockKey
+  {
+    uint16_t compno = 0;
+    uint8_t resno = 0;
+    uint8_t orientation = 0;
+    uint32_t x0 = 0;
+    uint32_t y0 = 0;
+    auto operator<=>(const BlockKey& rhs) const = default;
+  };
+
+  /**
+   * @struct SourceBlock
+   * @brief Coded bytes of a source code block, and the contributions they were sent in
+   *
+   * A contribution is the passes one layer adds to one segment: the finest truncation
+   * point the source's packet headers signal.
+   */
+  struct SourceBlock
+  {
+    struct Contribution
+    {
+      uint8_t passes = 0;
+      uint16_t bytes = 0;
+      /** true if the contribution ends its segment */
+      bool term = false;
+    };
+    uint8_t numbps = 0;
+    std::vector<uint8_t> data;
+    std::vector<Contribution> contributions;
+  };
+
+  /**
+   * @struct TileCoefficients
+   * @brief Coefficients or coded blocks of a source tile
+   *
+   * In @ref Mode::HT, each component is the tile component's highest resolution buffer,
+   * with the sub-bands in their quadrants: reversible samples as the Part 1 decoder
+   * reconstructs them, irreversible samples as quantization indices with one
+   * fractional bit. In @ref Mode::Truncate, the tile's code blocks are kept as coded.
+   */
+  struct TileCoefficients
+  {
+    bool captured = false;
+    bool ht = false;
+    uint8_t csty = 0;
+    GRK_PROG_ORDER prg = GRK_PROG_UNKNOWN;
+    uint8_t mct = 0;
+    uint16_t numLayers = 0;
+    std::vector<ComponentCoding> coding;
+    std::vector<uint32_t> widths;
+    std::vector<uint32_t> heights;
+    std::vector<std::vector<int32_t>> samples;
+    std::map<BlockKey, SourceBlock> blocks;
+  };
+
+  /**
+   * @brief Records the tile coding that the transcode must keep
+   */
+  void record(TileCoefficients& t, Tile* tile, TileCodingParams* tcp);
+
+  /**
+   * @brief Coefficient sink: copies a decompressed tile's coefficients
+   */
+  bool capture(uint16_t tileIndex, Tile* tile, TileCodingParams* tcp);
+
+  /**
+   * @brief Coefficient source: fills a compress tile with the source coefficients,
+   * decompressing the source tile first if it is not yet captured
+   */
+  bool fill(uint16_t tileIndex, Tile* tile, TileCodingParams* tcp);
+
+  /**
+   * @brief Decompresses one tile of the open source into its coefficients
+   */
+  bool decompressTile(uint16_t tileIndex);
+
+  /**
+   * @brief Code block sink: copies a parsed tile's coded blocks
+   */
+  bool captureBlocks(uint16_t tileIndex, Tile* tile, TileCodingParams* tcp);
+
+  /**
+   * @brief Code block source: gives a compress block the source block's coding passes
+   */
+  bool fillBlock(uint16_t tileIndex, t1::CompressBlockExec* block);
+
+  /**
+   * @brief Checks that every source tile was captured, with a coding the transcode
+   * can keep
+   *
+   * @param numTiles number of tiles to check, from the first
+   */
+  bool validate(size_t numTiles);
+
+  /**
+   * @brief Name of the transcode, for log messages
+   */
+  const char* label(void) const;
+
+  Mode mode_;
+  std::atomic<bool> failed_ = false;
+  std::vector<TileCoefficients> tiles_;
+  /** the open source in @ref Mode::HT, whose tiles are decompressed as they are filled */
+  grk_object* source_ = nullptr;
+  std::mutex sourceMutex_;
+  uint32_t tx0_ = 0;
+  uint32_t ty0_ = 0;
+  uint32_t tileWidth_ = 0;
+  uint32_t tileHeight_ = 0;
+};
+
+} // namespace grk
@@ -17,6 +17,7 @@
 
 #include <chrono>
 #include <cmath>
+#include <deque>
 #include <functional>
 #include <optional>
 
@@ -58,6 +59,7 @@ struct ITileProcessor;
 
 #include "TileProcessor.h"
 #include "TileCache.h"
+#include "SharedTilePartCache.h"
 #include "TileCompletion.h"
 #include "GrkImageSIMD.h"
 #include "CodeStreamDecompress.h"
@@ -70,10 +72,14 @@ CodeStreamDecompress::CodeStreamDecompress(IStream* stream)
     : CodeStream(stream), markerCache_(std::make_unique<MarkerCache>()),
       defaultTcp_(std::make_unique<TileCodingParams>(&cp_)),
       multiTileComposite_(new GrkImage(), RefCountedDeleter<GrkImage>()),
-      tileCache_(std::make_unique<TileCache>())
+      tileCache_(std::make_unique<TileCache>()),
+      codeblockCache_(std::make_unique<CodeblockCache>())
 {
   headerImage_ = new GrkImage();
   headerImage_->meta = grk_image_meta_new();
+  tileCache_->setReleaseHook([this](uint16_t tileIndex, ITileProcessor* tileProcessor) {
+    settleTileCharge(tileIndex, tileProcessor);
+  });
   markerParser_.add({
       {SIZ, new MarkerProcessor(
                 SIZ, [this](uint8_t* data, uint16_t len) { return readSIZ(data, len); })},
@@ -144,6 +150,40 @@ CodeStreamDecompress::CodeStreamDecompress(IStream* stream)
   if(TFSingleton::isSingleThreaded())
     localExecutor_ = std::make_unique<tf::Executor>(0);
 }
+
+CodeStreamDecompress::~CodeStreamDecompress()
+{
+  if(decompressQueue_)
+    decompressQueue_->close();
+  // Fetch callbacks and shared-cache fetch helpers push onto decompressQueue_,
+  // so outstanding fetches must finish before it is destroyed. Lift the row
+  // throttle first: nobody is consuming swaths any more.
+  if(!fetchByTileFutures_.empty())
+  {
+    if(tileCompletion_)
+      tileCompletion_->setLastClearedTileY(INT16_MAX);
+    auto fetcher = stream_ ? stream_->getFetcher() : nullptr;
+    if(fetcher)
+      fetcher->notifyThrottleRelease();
+    for(auto& ff : fetchByTileFutures_)
+    {
+      if(ff.valid())
+        ff.wait();
+    }
+  }
+  if(decompressConsumer_.joinable())
+    decompressConsumer_.join();
+  if(decompressWorker_.joinable())
+    decompressWorker_.join();
+  // Wait on this codec's own executor when it owns one (single-threaded mode);
+  // the decode scope has already exited so the thread-local override is gone.
+  if(localExecutor_)
+    localExecutor_->wait_for_all();
+  else
+    TFSingleton::get().wait_for_all();
+  releasePyramid();
+}
+
 void CodeStreamDecompress::init(grk_decompress_parameters* parameters)
 {
   assert(parameters);
@@ -151,11 +191,15 @@ void CodeStreamDecompress::init(grk_decompress_parameters* parameters)
   auto core = &parameters->core;
   tileCache_->setStrategy(core->tile_cache_strategy);
   tileCache_->setMaxActiveTiles(core->max_active_tiles);
+  memoryBudget_.setLimit(core->memory_budget_bytes);
+  tileCache_->setTrackLRU(memoryBudget_.enabled());
+  codeblockCache_->setMaxBytes((size_t)core->codeblock_cache_bytes);
   ioBufferCallback_ = core->io_buffer_callback;
   ioUserData_ = core->io_user_data;
   grkRegisterReclaimCallback_ = core->io_register_client_callback;
   ioBandCallback_ = core->io_band_callback;
   ioBandUserData_ = core->io_band_user_data;
+  outputBuffer_ = core->output_buffer;
 
   // guard on null: never replace an executor a decode may already be running on
   if(parameters->num_threads && !localExecutor_)
@@ -181,6 +225,21 @@ void CodeStreamDecompress::init(grk_decompress_parameters* parameters)
         std::make_unique<CompressedChunkCache>(0, diskCache, stream_->getFormat());
   }
 
+  // Read-ahead for local files. Its buffers are released with the tile, so it
+  // is skipped for cache strategies that re-decode a tile from parsed packets.
+  bool reusesPackets = core->tile_cache_strategy & (GRK_TILE_CACHE_ALL | GRK_TILE_CACHE_LRU);
+  if(!core->read_ahead_tiles || reusesPackets || inputFilePath_.empty() || stream_->getFetcher())
+  {
+    readAhead_.reset();
+  }
+  else if(!readAhead_ || readAhead_->depth() != core->read_ahead_tiles)
+  {
+    readAhead_ = std::make_unique<TileReadAhead>(inputFilePath_, stream_->getFormat(),
+                                                 core->read_ahead_tiles);
+    if(!readAhead_->open())
+      readAhead_.reset();
+  }
+
   postReadHeader();
 }
 void CodeStreamDecompress::setBandCallback(grk_io_band_callback callback, void* user_data)
@@ -188,6 +247,36 @@ void CodeStreamDecompress::setBandCallback(grk_io_band_callback callback, void*
   ioBandCallback_ = callback;
   ioBandUserData_ = user_data;
 }
+bool CodeStreamDecompress::getCodeblockCacheStats(grk_codeblock_cache_stats* stats)
+{
+  codeblockCache_->getStats(stats);
+  return true;
+}
+GrkImage* CodeStreamDecompress::getPyramidImage(uint8_t reduction)
+{
+  return reduction < pyramid_.size() ? pyramid_[reduction] : nullptr;
+}
+GrkImage* CodeStreamDecompress::getScaledImage(void)
+{
+  return resampler_ ? resampler_->getImage() : nullptr;
+}
+bool CodeStreamDecompress::getMemoryBudgetStats(grk_memory_budget_stats* stats)
+{
+  memoryBudget_.getStats(stats);
+  return true;
+}
+
+bool CodeStreamDecompress::setFocus(uint32_t x, uint32_t y)
+{
+  tilePriority_.setFocus(x, y);
+  return true;
+}
+
+bool CodeStreamDecompress::setTilePriority(uint16_t tile_index, uint32_t priority)
+{
+  tilePriority_.set(tile_index, priority);
+  return true;
+}
 
 // Multi Tile //////////////////////////////////////////////////////////
 
@@ -259,6 +348,11 @@ bool CodeStreamDecompress::decompress(grk_plugin_tile* tile)
     return success_;
 
   multiTileComposite_->postReadHeader(&cp_);
+  if(!prepareDirectOutput())
+    return false;
+  preparePyramid(true);
+  if(!prepareScaled())
+    return false;
   // LOCAL-ONLY: mercury streaming fast path — decodes eligible streams
   // through grok T1 via the mercury shim, either streaming rows_per_strip
   // bands into ioBandCallback_ (O(strip) memory) or filling
@@ -569,9 +663,12 @@ bool CodeStreamDecompress::startTLMDecompress(std::set<uint16_t>& pendingTiles)
   // begin network fetch
   auto generator = [this](ITileProcessor* tp) { return postMultiTile(tp); };
 
-  // Try selective fetch for reduced resolution over network
-  uint8_t reduce = cp_.codingParams_.dec_.reduce_;
-  if(reduce > 0 && stream_->getFetcher())
+  // Try selective fetch over network when the decode needs only part of each tile:
+  // reduced resolution, fewer layers, a subset of components or a window
+  auto& dec = cp_.codingParams_.dec_;
+  bool partialTiles = dec.reduce_ > 0 || !cp_.compsToDecompress_.empty() || !region_.empty() ||
+                      (dec.layersToDecompress_ && dec.layersToDecompress_ < defaultTcp_->numLayers_);
+  if(partialTiles && stream_->getFetcher())
   {
     if(fetchByTileSelective(pendingTiles, scratchImage_->getBounds(), generator))
       return true;
@@ -586,6 +683,10 @@ bool CodeStreamDecompress::startTLMDecompress(std::set<uint16_t>& pendingTiles)
       std::make_shared<std::unordered_map<uint16_t, std::shared_ptr<TPFetchSeq>>>();
   TPFetchSeq::genCollections(&cp_.tlmMarkers_->getTileParts(), pendingTiles, tilePartFetchFlat_,
                              tilePartFetchByTile_);
+  // index order; scheduleByPriority() plans again in priority order
+  if(readAhead_)
+    readAhead_->plan(&cp_.tlmMarkers_->getTileParts(),
+                     std::vector<uint16_t>(pendingTiles.begin(), pendingTiles.end()));
 
   // single thread: run the producer inline on the caller, no worker thread
   if(TFSingleton::isSingleThreaded())
@@ -655,6 +756,7 @@ bool CodeStreamDecompress::bandRowFullyScheduled(uint16_t tileY)
 
 bool CodeStreamDecompress::schedule(ITileProcessor* tileProcessor, bool multiTile)
 {
+  chargeTile(tileProcessor);
   if(tileCompletion_ && !bandRowScheduledTiles_.empty())
   {
     uint16_t tileY = tileProcessor->getIndex() / tileCompletion_->getNumTileCols();
@@ -666,10 +768,16 @@ bool CodeStreamDecompress::schedule(ITileProcessor* tileProcessor, bool multiTil
   if(cp_.hasTLM())
   {
     auto generator = [this](ITileProcessor* tp) { return postMultiTile(tp); };
-    auto decompressTileTask =
-        genDecompressTileTLMTask(tileProcessor, (*tilePartFetchByTile_)[tileProcessor->getIndex()],
-                                 scratchImage_->getBounds(), generator);
-    return decompressTileTask();
+    auto tileIndex = tileProcessor->getIndex();
+    auto tilePartFetchSeq = readAhead_ ? readAhead_->take(tileIndex) : nullptr;
+    if(!tilePartFetchSeq)
+      tilePartFetchSeq = (*tilePartFetchByTile_)[tileIndex];
+    auto decompressTileTask = genDecompressTileTLMTask(tileProcessor, tilePartFetchSeq,
+                                                       scratchImage_->getBounds(), generator);
+    if(decompressTileTask())
+      return true;
+    settleTileCharge(tileIndex, tileProcessor);
+    return false;
   }
   else
   {
@@ -695,6 +803,12 @@ void CodeStreamDecompress::decompressTLM(const std::set<uint16_t>& pendingTiles)
   // 1 schedule all pending tiles
   if(!doTileBatching())
   {
+    // strip-based band callbacks drain rows in order, so they keep index order
+    if(tilePriority_.active() && !ioBandCallback_ && !TFSingleton::isSingleThreaded())
+    {
+      scheduleByPriority(pendingTiles);
+      return;
+    }
     for(const auto& tileIndex : pendingTiles)
     {
       // Backpressure for strip-based band callback: block if this tile's row
@@ -733,10 +847,15 @@ void CodeStreamDecompress::decompressTLM(const std::set<uint16_t>& pendingTiles)
   batchTileScheduledRows_ = batchTileInitialRows_;
   {
     std::lock_guard<std::mutex> lock(batchTileQueueMutex_);
+    std::vector<uint16_t> batch;
     for(size_t i = 0; i < initialBatchCount && !batchTileQueueTLM_.empty(); ++i)
     {
-      auto tileIndex = batchTileQueueTLM_.front();
+      batch.push_back(batchTileQueueTLM_.front());
       batchTileQueueTLM_.pop();
+    }
+    sortBatch(batch);
+    for(auto tileIndex : batch)
+    {
       if(!schedule(getTileProcessor(tileIndex), true))
         return; // Stop on scheduling failure
     }
@@ -749,6 +868,71 @@ void CodeStreamDecompress::decompressTLM(const std::set<uint16_t>& pendingTiles)
   }
 }
 
+void CodeStreamDecompress::scheduleByPriority(const std::set<uint16_t>& pendingTiles)
+{
+  tilePriority_.setGrid(cp_.tx0_, cp_.ty0_, cp_.t_width_, cp_.t_height_, cp_.t_grid_width_,
+                        headerImage_->x0, headerImage_->y0, headerImage_->x1, headerImage_->y1);
+  tilePriority_.assign(pendingTiles);
+
+  // the executor runs tiles in the order they are handed to it, so keep two tiles per
+  // worker in flight - enough for idle workers to steal from while a tile winds down -
+  // and leave the rest waiting here, where a new focus can still reorder them
+  size_t maxInFlight = std::max<size_t>(2 * TFSingleton::num_threads(), 2);
+  std::vector<uint16_t> inFlight;
+  {
+    std::lock_guard<std::mutex> lock(tilePostedMutex_);
+    postedTiles_.clear();
+    trackPostedTiles_ = true;
+  }
+  uint64_t orderVersion = 0;
+  std::vector<uint16_t> order;
+  while(success_)
+  {
+    // wait for any tile in flight to finish, before popping, so that a reorder
+    // made meanwhile still decides the next tile
+    {
+      std::unique_lock<std::mutex> lock(tilePostedMutex_);
+      while(success_)
+      {
+        // a failed tile skips its post step, but its future still completes
+        std::erase_if(inFlight, [this](uint16_t index) {
+          return std::find(postedTiles_.begin(), postedTiles_.end(), index) !=
+                     postedTiles_.end() ||
+                 decompressTileFutureManager_.ready(index);
+        });
+        postedTiles_.clear();
+        if(inFlight.size() < maxInFlight)
+          break;
+        tilePostedCV_.wait_for(lock, std::chrono::milliseconds(100));
+      }
+    }
+    if(!success_)
+      break;
+    // the read-ahead queues the tiles that follow each one taken in its plan,
+    // so plan the waiting tiles in the order they will be popped
+    if(readAhead_ && tilePriority_.order(order, orderVersion))
+      readAhead_->plan(&cp_.tlmMarkers_->getTileParts(), std::move(order));
+    uint16_t tileIndex;
+    if(!tilePriority_.pop(tileIndex))
+      break;
+    if(!schedule(getTileProcessor(tileIndex), true))
+      break;
+    inFlight.push_back(tileIndex);
+  }
+  std::lock_guard<std::mutex> lock(tilePostedMutex_);
+  trackPostedTiles_ = false;
+  postedTiles_.clear();
+}
+
+void CodeStreamDecompress::sortBatch(std::vector<uint16_t>& batch)
+{
+  if(!tilePriority_.active())
+    return;
+  tilePriority_.setGrid(cp_.tx0_, cp_.ty0_, cp_.t_width_, cp_.t_height_, cp_.t_grid_width_,
+                        headerImage_->x0, headerImage_->y0, headerImage_->x1, headerImage_->y1);
+  tilePriority_.sort(batch);
+}
+
 std::function<bool()> CodeStreamDecompress::genDecompressTileTLMTask(
     ITileProcessor* tileProcessor, const std::shared_ptr<TPFetchSeq>& tilePartFetchSeq,
     Rect32 unreducedImageBounds,
@@ -821,6 +1005,12 @@ void CodeStreamDecompress::decompressSequential(const std::set<uint16_t>& pendin
     if(chunkBuffer_)
       chunkBuffer_->free_before(stream_->tell() - chunkBuffer_->initialOffset());
 
+    // without TLM the next tiles' ranges are unknown: pull the bytes past the
+    // parser into the page cache while this tile decodes
+    if(readAhead_)
+      readAhead_->warm(stream_->tell(),
+                       (uint64_t)readAhead_->depth() * currTilePartInfo_.tilePartLength_);
+
     // 2. find next tile (or EOC)
     try
     {
@@ -1037,6 +1227,11 @@ bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
   TFSingleton::ScopedExecutor scopedExec(localExecutor_.get(), localNumThreads_);
 
   multiTileComposite_->postReadHeader(&cp_);
+  if(!prepareDirectOutput())
+    return false;
+  preparePyramid(false);
+  // the scaled image covers a whole decompress, not single tiles
+  resampler_.reset();
 
   // 1. sanity check on tile index
   uint16_t numTilesToDecompress = (uint16_t)(cp_.t_grid_width_ * cp_.t_grid_height_);
@@ -1053,7 +1248,10 @@ bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
   auto cacheEntry = tileCache_->get(tileIndex);
   if(cacheEntry && cacheEntry->processor() && cacheEntry->processor()->getImage() &&
      !cacheEntry->dirty())
+  {
+    storeDirectOutput(cacheEntry->processor()->getImage());
     return true;
+  }
 
   // 3. schedule / execute tile decompression
   if(!decompressTileImpl(tileIndex))
@@ -1061,7 +1259,13 @@ bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
 
   // 4. wait if synchronous
   if(!cp_.asynchronous_)
+  {
     wait(nullptr);
+    // the tile can still fail once scheduled, e.g. in its inverse MCT
+    auto entry = tileCache_->get(tileIndex);
+    if(entry && entry->processor() && entry->processor()->hasError())
+      return false;
+  }
 
   return true;
 }
@@ -1191,8 +1395,17 @@ bool CodeStreamDecompress::decompressTileImpl(uint16_t tileIndex)
 
   const auto tileProcessor = cacheEntry ? cacheEntry->processor() : getTileProcessor(tileIndex);
   auto post = postSingleTile(tileProcessor);
-  tilePartFetchFlat_ = std::make_shared<TPFetchSeq>();
-  tilePartFetchFlat_->push_back(tileIndex, cp_.tlmMarkers_->getTileParts()[tileIndex]);
+  tilePartFetchFlat_ = nullptr;
+  if(readAhead_)
+  {
+    readAhead_->planSequential(&cp_.tlmMarkers_->getTileParts());
+    tilePartFetchFlat_ = readAhead_->take(tileIndex);
+  }
+  if(!tilePartFetchFlat_)
+  {
+    tilePartFetchFlat_ = std::make_shared<TPFetchSeq>();
+    tilePartFetchFlat_->push_back(tileIndex, cp_.tlmMarkers_->getTileParts()[tileIndex]);
+  }
   try
   {
     if(!tileProcessor->decompressWithTLM(tilePartFetchFlat_, &coderPool_, headerImage_->getBounds(),
@@ -1215,12 +1428,21 @@ bool CodeStreamDecompress::decompressTileImpl(uint16_t tileIndex)
 std::function<void()> CodeStreamDecompress::postSingleTile(ITileProcessor* tileProcessor)
 {
   return [this, tileProcessor]() {
+    // a failed tile leaves nothing worth storing
+    if(tileProcessor->hasError())
+    {
+      settleTileCharge(tileProcessor->getIndex(), tileProcessor);
+      return;
+    }
     auto rawActive = activeImage_.release();
     tileProcessor->post_decompressT2T1(scratchImage_.get());
+    storeDirectOutput(scratchImage_.get());
+    storePyramid(tileProcessor);
     scratchImage_->transferDataTo(rawActive);
     postProcess(rawActive);
     tileProcessor->setImage(rawActive);
     tileCache_->setDirty(tileProcessor->getIndex(), false);
+    settleTileCharge(tileProcessor->getIndex(), tileProcessor);
     if(cp_.decompressCallback_)
     {
       cp_.decompressCallback_(this, tileProcessor->getIndex(), rawActive,
@@ -1267,6 +1489,8 @@ std::function<void()> CodeStreamDecompress::postMultiTile(void)
       uint32_t decompressed = numTilesDecompressed_;
       grklog.warn("Only %u out of %u tiles were decompressed", decompressed, numTilesToDecompress);
     }
+    if(resampler_)
+      resampler_->finish();
     if(!cp_.codingParams_.dec_.skipAllocateComposite_)
     {
       // an empty scratch would replace the composite pixels with nulls: incremental band
@@ -1295,7 +1519,7 @@ std::function<void()> CodeStreamDecompress::postMultiTile(void)
 std::function<void()> CodeStreamDecompress::postMultiTile(ITileProcessor* tileProcessor)
 {
   return [this, tileProcessor]() {
-    auto releaseThrottle = [this]() {
+    auto releaseThrottle = [this, tileProcessor]() {
       if(maxDecompressInFlight_ > 0)
       {
         {
@@ -1304,16 +1528,23 @@ std::function<void()> CodeStreamDecompress::postMultiTile(ITileProcessor* tilePr
         }
         decompressThrottleCV_.notify_one();
       }
+      {
+        std::lock_guard<std::mutex> lock(tilePostedMutex_);
+        if(trackPostedTiles_)
+          postedTiles_.push_back(tileProcessor->getIndex());
+      }
+      tilePostedCV_.notify_one();
       // Wake the fetcher so it can schedule more HTTP requests
       auto fetcher = stream_->getFetcher();
       if(fetcher)
         fetcher->notifyThrottleRelease();
     };
 
-    if(!success_ || !ensureScratchData())
+    if(!success_ || tileProcessor->hasError() || !ensureScratchData())
     {
       success_ = false;
       releaseThrottle();
+      settleTileCharge(tileProcessor->getIndex(), tileProcessor);
       // Always mark tile as complete so row callbacks can fire and
       // backpressure unblocks, even when the decompress failed.
       if(tileCompletion_)
@@ -1329,6 +1560,11 @@ std::function<void()> CodeStreamDecompress::postMultiTile(ITileProcessor* tilePr
     releaseThrottle();
 
     auto tileImage = tileProcessor->getImage();
+    // a single-tile image leaves its samples in the scratch image
+    storeDirectOutput(scratchImage_->has_multiple_tiles ? tileImage : scratchImage_.get());
+    storePyramid(tileProcessor);
+    if(resampler_)
+      resampler_->resample(scratchImage_->has_multiple_tiles ? tileImage : scratchImage_.get());
     if(!cp_.codingParams_.dec_.skipAllocateComposite_ && scratchImage_->has_multiple_tiles &&
        tileImage)
     {
@@ -1346,9 +1582,16 @@ std::function<void()> CodeStreamDecompress::postMultiTile(ITileProcessor* tilePr
                               cp_.decompressCallbackUserData_);
 
     if(tileCompletion_)
+    {
+      // settle first: completing a row can schedule tiles, which may wait on the budget
+      settleTileCharge(tileIndex, tileProcessor);
       tileCompletion_->complete(tileIndex);
+    }
     else
+    {
       tileProcessor->release();
+      settleTileCharge(tileIndex, tileProcessor);
+    }
   };
 }
 
@@ -1668,6 +1911,8 @@ void CodeStreamDecompress::wait(grk_wait_swath* swath)
   if(!success_)
     decompressTileFutureManager_.cancelAll();
   decompressTileFutureManager_.waitAndClear();
+  // cancelled tiles never ran their post step
+  memoryBudget_.settleInFlight();
 
   // 5. Run postMulti_: transfers scratchImage_ data to multiTileComposite_
   // and applies postProcess (colour, ICC, precision, etc.).
@@ -1821,10 +2066,15 @@ void CodeStreamDecompress::scheduleTileBatch()
       std::unique_lock<std::mutex> lock(batchTileQueueMutex_);
       size_t tilesToSchedule =
           batchTileHeadroomIncrement(rowsToSchedule, (uint16_t)batchTileQueueTLM_.size());
+      std::vector<uint16_t> batch;
       for(size_t i = 0; i < tilesToSchedule; ++i)
       {
-        auto tileIndex = batchTileQueueTLM_.front();
+        batch.push_back(batchTileQueueTLM_.front());
         batchTileQueueTLM_.pop();
+      }
+      sortBatch(batch);
+      for(auto tileIndex : batch)
+      {
         if(!schedule(getTileProcessor(tileIndex), true))
         {
           lock.unlock();
@@ -1872,6 +2122,61 @@ void CodeStreamDecompress::startDecompressConsumer(uint16_t maxInFlight)
 
 // Fetching ////////////////////////////////////////////////////////
 
+/**
+ * @brief Builds a decompress sequence for a tile from SharedTilePartCache
+ *
+ * @return sequence with shared buffers and MemStreams, or nullptr unless
+ * every tile part of the tile is cached
+ */
+static std::shared_ptr<TPFetchSeq> lookupSharedTile(const std::string& identity,
+                                                    uint16_t tileIndex,
+                                                    const std::unique_ptr<TPSeq>& tileParts,
+                                                    GRK_CODEC_FORMAT format)
+{
+  if(!tileParts || tileParts->empty())
+    return nullptr;
+  auto& sharedCache = SharedTilePartCache::instance();
+  auto seq = std::make_shared<TPFetchSeq>();
+  uint8_t partIndex = 0;
+  for(auto& part : *tileParts)
+  {
+    auto data =
+        sharedCache.get({identity, tileIndex, partIndex++, part->offset_, (uint64_t)part->length_});
+    if(!data)
+      return nullptr;
+    auto fetch = std::make_shared<TPFetch>(part->offset_, part->length_, tileIndex);
+    fetch->data_ = std::move(data);
+    fetch->fetchOffset_ = (size_t)part->length_;
+    fetch->stream_ =
+        std::unique_ptr<IStream>(memStreamCreate(fetch->data_.get(), part->length_, format, true));
+    seq->SharedPtrSeq<TPFetch>::push_back(fetch);
+  }
+  return seq;
+}
+
+/**
+ * @brief Publishes a fully fetched tile to SharedTilePartCache and, when this
+ * codec holds the tile's claim, wakes any codecs waiting for it
+ *
+ * @param tickets claims this codec took, by tile index
+ */
+static void publishSharedTile(const std::string& identity, uint16_t tileIndex,
+                              TPFetchSeq& tilePartSeq,
+                              const std::map<uint16_t, uint64_t>& tickets)
+{
+  auto& sharedCache = SharedTilePartCache::instance();
+  for(size_t i = 0; i < tilePartSeq.size(); ++i)
+  {
+    auto& tp = tilePartSeq[i];
+    sharedCache.put({identity, tileIndex, (uint8_t)i, tp->offset_, (uint64_t)tp->length_},
+                    tp->data_);
+  }
+  // a tile fetched as a fallback is claimed by another codec, which releases it
+  auto ticket = tickets.find(tileIndex);
+  if(ticket != tickets.end())
+    sharedCache.release(identity, tileIndex, ticket->second, true);
+}
+
 bool CodeStreamDecompress::fetchByTile(
     std::set<uint16_t>& slated, Rect32 unreducedImageBounds,
     std::function<std::function<void()>(ITileProcessor*)> postGenerator)
@@ -1888,39 +2193,103 @@ bool CodeStreamDecompress::fetchByTile(
   auto numTileCols = cp_.t_grid_width_;
   installFetchThrottle(fetcher);
 
-  fetchByTileFutures_.push_back(fetcher->fetchTiles(
-      cp_.tlmMarkers_->getTileParts(), slated, nullptr,
-      [this, numTileCols, unreducedImageBounds, postGenerator](size_t requestIndex,
-                                                               TileFetchContext* context) {
-        auto& tilePart = (*context->requests_)[requestIndex];
-        tilePart->stream_ = std::unique_ptr<IStream>(
-            memStreamCreate(tilePart->data_.get(), tilePart->length_, stream_->getFormat(), true));
-        auto& tilePartSeq = (*context->tilePartFetchByTile_)[tilePart->tileIndex_];
-        if(tilePartSeq->incrementFetchCount() == tilePartSeq->size())
-        {
-          auto tileIndex = tilePart->tileIndex_;
+  // Tile parts are shared with other codecs reading the same resource only
+  // when the fetcher can vouch for the resource version (ETag / mtime)
+  auto& sharedCache = SharedTilePartCache::instance();
+  auto identity = sharedCache.enabled() ? fetcher->identity() : std::string();
+  // filled before any fetch starts, and only read afterwards
+  auto tickets = std::make_shared<std::map<uint16_t, uint64_t>>();
+
+  TileFetchCallback callback = [this, numTileCols, unreducedImageBounds, postGenerator, identity,
+                                tickets](size_t requestIndex, TileFetchContext* context) {
+    auto& tilePart = (*context->requests_)[requestIndex];
+    tilePart->stream_ = std::unique_ptr<IStream>(
+        memStreamCreate(tilePart->data_.get(), tilePart->length_, stream_->getFormat(), true));
+    auto& tilePartSeq = (*context->tilePartFetchByTile_)[tilePart->tileIndex_];
+    if(tilePartSeq->incrementFetchCount() == tilePartSeq->size())
+    {
+      auto tileIndex = tilePart->tileIndex_;
+      if(!identity.empty())
+        publishSharedTile(identity, tileIndex, *tilePartSeq, *tickets);
+      enqueueTileForDecompress(tileIndex, tilePartSeq, numTileCols, unreducedImageBounds,
+                               postGenerator, nullptr);
+    }
+  };
 
-          // Register compressed data with cache for re-decompression
-          if(compressedChunkCache_)
-            compressedChunkCache_->put(tileIndex, tilePartSeq);
+  const auto& allTileParts = cp_.tlmMarkers_->getTileParts();
+  if(identity.empty())
+  {
+    fetchByTileFutures_.push_back(fetcher->fetchTiles(allTileParts, slated, nullptr, callback));
+    return true;
+  }
 
-          // Track the highest tile row that has been fully fetched
-          int32_t tileRow = tileIndex / numTileCols;
-          int32_t prev = maxFetchedTileRow_.load(std::memory_order_acquire);
-          while(prev < tileRow &&
-                !maxFetchedTileRow_.compare_exchange_weak(prev, tileRow, std::memory_order_release,
-                                                          std::memory_order_acquire))
-          {
-          }
-          auto tilePartSeqCopy = tilePartSeq;
-          decompressQueue_->push(
-              [this, tileIndex, tilePartSeqCopy, unreducedImageBounds, postGenerator]() {
-                const auto tileProcessor = getTileProcessor(tileIndex);
-                auto decompressTask = genDecompressTileTLMTask(tileProcessor, tilePartSeqCopy,
-                                                               unreducedImageBounds, postGenerator);
-                decompressTask();
-              });
+  // Serve cached tiles directly, wait for tiles another codec is already
+  // fetching, and claim the rest
+  std::set<uint16_t> claimed;
+  std::vector<std::pair<uint16_t, std::shared_future<bool>>> awaited;
+  for(auto tileIndex : slated)
+  {
+    auto cached = lookupSharedTile(identity, tileIndex, allTileParts[tileIndex],
+                                   stream_->getFormat());
+    if(cached)
+    {
+      enqueueTileForDecompress(tileIndex, cached, numTileCols, unreducedImageBounds, postGenerator,
+                               nullptr);
+      continue;
+    }
+    std::shared_future<bool> inFlight;
+    uint64_t ticket = 0;
+    if(sharedCache.claim(identity, tileIndex, inFlight, ticket))
+    {
+      claimed.insert(tileIndex);
+      (*tickets)[tileIndex] = ticket;
+    }
+    else
+      awaited.emplace_back(tileIndex, std::move(inFlight));
+  }
+  if(claimed.empty() && awaited.empty())
+    return true;
+
+  std::future<bool> ownFetch;
+  if(!claimed.empty())
+    ownFetch = fetcher->fetchTiles(allTileParts, claimed, nullptr, callback);
+
+  fetchByTileFutures_.push_back(std::async(
+      std::launch::async,
+      [this, fetcher, identity, callback, numTileCols, unreducedImageBounds, postGenerator, tickets,
+       awaited = std::move(awaited),
+       ownFetch = std::move(ownFetch)]() mutable {
+        auto& sharedCache = SharedTilePartCache::instance();
+        const auto& allTileParts = cp_.tlmMarkers_->getTileParts();
+
+        // Tiles whose fetch failed or timed out elsewhere are fetched here
+        std::set<uint16_t> fallback;
+        for(auto& [tileIndex, inFlight] : awaited)
+        {
+          std::shared_ptr<TPFetchSeq> cached;
+          if(inFlight.wait_for(SharedTilePartCache::kMaxCoalesceWait) ==
+                 std::future_status::ready &&
+             inFlight.get())
+            cached = lookupSharedTile(identity, tileIndex, allTileParts[tileIndex],
+                                      stream_->getFormat());
+          if(cached)
+            enqueueTileForDecompress(tileIndex, cached, numTileCols, unreducedImageBounds,
+                                     postGenerator, nullptr);
+          else
+            fallback.insert(tileIndex);
         }
+        bool success = true;
+        if(!fallback.empty())
+          success = fetcher->fetchTiles(allTileParts, fallback, nullptr, callback).get();
+        if(ownFetch.valid())
+          success = ownFetch.get() && success;
+
+        // Completed tiles were released by the callback; this wakes the
+        // waiters on any tile whose fetch failed
+        for(const auto& [tileIndex, ticket] : *tickets)
+          sharedCache.release(identity, tileIndex, ticket, false);
+
+        return success;
       }));
 
   return true;
@@ -1928,35 +2297,44 @@ bool CodeStreamDecompress::fetchByTile(
 
 void CodeStreamDecompress::enqueueTileForDecompress(
     uint16_t tileIndex, std::shared_ptr<TPFetchSeq> decompressSeq, uint16_t numTileCols,
-    Rect32 unreducedImageBounds,
-    std::function<std::function<void()>(ITileProcessor*)> postGenerator)
+    Rect32 unreducedImageBounds, std::function<std::function<void()>(ITileProcessor*)> postGenerator,
+    std::shared_ptr<const std::vector<bool>> fetchedPackets)
 {
+  // Register compressed data with cache for re-decompression
   if(compressedChunkCache_)
     compressedChunkCache_->put(tileIndex, decompressSeq);
 
+  // Track the highest tile row that has been fully fetched
   int32_t tileRow = tileIndex / numTileCols;
   int32_t prev = maxFetchedTileRow_.load(std::memory_order_acquire);
   while(prev < tileRow && !maxFetchedTileRow_.compare_exchange_weak(
                               prev, tileRow, std::memory_order_release, std::memory_order_acquire))
   {
   }
-  decompressQueue_->push([this, tileIndex, decompressSeq, unreducedImageBounds, postGenerator]() {
-    const auto tileProcessor = getTileProcessor(tileIndex);
-    auto* tp = dynamic_cast<TileProcessor*>(tileProcessor);
-    if(tp)
-      tp->setSelectiveFetch(true);
-    auto decompressTask =
-        genDecompressTileTLMTask(tileProcessor, decompressSeq, unreducedImageBounds, postGenerator);
-    decompressTask();
-  });
+  decompressQueue_->push(
+      [this, tileIndex, decompressSeq, unreducedImageBounds, postGenerator, fetchedPackets]() {
+        const auto tileProcessor = getTileProcessor(tileIndex);
+        if(fetchedPackets)
+        {
+          auto* tp = dynamic_cast<TileProcessor*>(tileProcessor);
+          if(tp)
+            tp->setSelectiveFetch(fetchedPackets);
+        }
+        auto decompressTask = genDecompressTileTLMTask(tileProcessor, decompressSeq,
+                                                       unreducedImageBounds, postGenerator);
+        decompressTask();
+      });
 }
 
 void CodeStreamDecompress::buildSelectiveTileParts(uint16_t tileIndex, const TileHeaderResult& hdr,
-                                                   const TPSEQ_VEC& allTileParts, uint8_t reduce)
+                                                   const TPSEQ_VEC& allTileParts,
+                                                   Rect32 unreducedImageBounds,
+                                                   uint64_t gapThreshold)
 {
   auto numComps = headerImage_->numcomps;
   Rect32 imageBounds(headerImage_->x0, headerImage_->y0, headerImage_->x1, headerImage_->y1);
   auto& srcParts = allTileParts[tileIndex];
+  selectiveLayouts_[tileIndex] = SelectiveTileLayout();
 
   auto copyFullTileParts = [&]() {
     selectiveTileParts_[tileIndex] = std::make_unique<TPSeq>();
@@ -1968,7 +2346,7 @@ void CodeStreamDecompress::buildSelectiveTileParts(uint16_t tileIndex, const Til
     }
   };
 
-  bool allValid = true;
+  bool allValid = hdr.headerInfos.size() == srcParts->size();
   for(auto& info : hdr.headerInfos)
   {
     if(!info.valid || info.pltLengths.empty())
@@ -1978,7 +2356,9 @@ void CodeStreamDecompress::buildSelectiveTileParts(uint16_t tileIndex, const Til
     }
   }
 
-  if(!allValid)
+  // packet order can't be modelled with a progression order change
+  auto tcp = defaultTcp_.get();
+  if(!allValid || tcp->hasPoc())
   {
     copyFullTileParts();
     return;
@@ -1988,16 +2368,15 @@ void CodeStreamDecompress::buildSelectiveTileParts(uint16_t tileIndex, const Til
   uint16_t tileX = tileIndex % cp_.t_grid_width_;
   uint16_t tileY = tileIndex / cp_.t_grid_width_;
   auto tileBounds = cp_.getTileBounds(imageBounds, tileX, tileY);
-
-  // Get coding params from default TCP (main header - tile TCPs aren't parsed yet)
-  auto tcp = defaultTcp_.get();
+  auto window = unreducedImageBounds.intersection(tileBounds);
+  bool wholeTile = window == tileBounds;
 
   // Combine PLT lengths from all tile-parts
   std::vector<uint32_t> allPltLengths;
   for(auto& info : hdr.headerInfos)
     allPltLengths.insert(allPltLengths.end(), info.pltLengths.begin(), info.pltLengths.end());
 
-  // Build TilePacketInfo
+  // Build TilePacketInfo, and the precincts the decode window touches
   TilePacketInfo tpi;
   tpi.progression = tcp->prg_;
   tpi.numComponents = numComps;
@@ -2006,6 +2385,9 @@ void CodeStreamDecompress::buildSelectiveTileParts(uint16_t tileIndex, const Til
   tpi.precinctsPerRes.resize(numComps);
   tpi.pltLengths = std::move(allPltLengths);
 
+  PacketSelection selection;
+  if(!wholeTile)
+    selection.precincts.resize(numComps);
   for(uint16_t compno = 0; compno < numComps; ++compno)
   {
     auto tccp = tcp->tccps_ + compno;
@@ -2023,102 +2405,162 @@ void CodeStreamDecompress::buildSelectiveTileParts(uint16_t tileIndex, const Til
       tpi.precinctsPerRes[compno][resno] =
           computeNumPrecincts(tcx0, tcy0, tcx1, tcy1, tccp->numresolutions_, resno,
                               tccp->precWidthExp_[resno], tccp->precHeightExp_[resno]);
+      if(!wholeTile)
+      {
+        // generous padding: a precinct the decoder wants but the plan misses
+        // is skipped rather than misread, but it still costs quality
+        constexpr uint32_t windowPadding = 16;
+        selection.precincts[compno].push_back(computeWindowPrecincts(
+            tcx0, tcy0, tcx1, tcy1, tccp->numresolutions_, resno, tccp->precWidthExp_[resno],
+            tccp->precHeightExp_[resno], (window.x0 + comp->dx - 1) / comp->dx,
+            (window.y0 + comp->dy - 1) / comp->dy, (window.x1 + comp->dx - 1) / comp->dx,
+            (window.y1 + comp->dy - 1) / comp->dy, windowPadding));
+      }
     }
   }
 
   // Compute target resolution count (total res - reduce)
+  uint8_t reduce = cp_.codingParams_.dec_.reduce_;
   uint8_t maxRes = 0;
   for(uint16_t c = 0; c < numComps; ++c)
     maxRes = std::max(maxRes, tpi.numResolutions[c]);
-  uint8_t targetRes = (maxRes > reduce) ? (maxRes - reduce) : 1;
-
-  auto ranges = computeSelectiveFetchRanges(tpi, targetRes);
+  selection.resolutionsToDecompress = (maxRes > reduce) ? (maxRes - reduce) : 1;
+  if(cp_.codingParams_.dec_.layersToDecompress_)
+    selection.layersToDecompress = cp_.codingParams_.dec_.layersToDecompress_;
 
-  if(ranges.empty())
+  // Components, with the MCT triple kept whole as TileProcessor::shouldDecodeComponent does
+  auto& comps = cp_.compsToDecompress_;
+  if(!comps.empty())
   {
-    copyFullTileParts();
-    return;
+    selection.components.assign(numComps, false);
+    bool mctTriple = false;
+    for(auto c : comps)
+    {
+      if(c < numComps)
+        selection.components[c] = true;
+      mctTriple |= c <= 2;
+    }
+    if(mctTriple && tcp->mct_ == 1 && numComps >= 3)
+      std::fill(selection.components.begin(), selection.components.begin() + 3, true);
   }
 
-  // Check if ranges are contiguous starting at offset 0 (RLCP/RPCL/single-layer LRCP)
-  bool contiguous = (ranges.size() == 1 && ranges[0].offset == 0);
-
-  selectiveTileParts_[tileIndex] = std::make_unique<TPSeq>();
+  // Tile-part i holds packet data [dataStart[i], dataStart[i+1]) of the concatenated packets
+  std::vector<uint64_t> dataStart(srcParts->size() + 1, 0);
+  for(size_t i = 0; i < srcParts->size(); ++i)
+  {
+    uint64_t headerLen = hdr.headerInfos[i].sodOffset + 2;
+    auto partLen = (*srcParts)[i]->length_;
+    dataStart[i + 1] = dataStart[i] + (partLen > headerLen ? partLen - headerLen : 0);
+  }
 
-  if(contiguous)
+  // Plan, widening the gap until every tile part's entries fit a TPSeq (uint8_t count)
+  SelectiveFetchPlan plan;
+  std::vector<std::pair<uint8_t, FetchRange>> pieces; // (tile part, range in file)
+  while(true)
   {
-    // Contiguous case: single truncated fetch per tile-part
-    uint64_t neededDataBytes = ranges[0].length;
-    if(srcParts->size() == 1)
+    plan = planSelectiveFetch(tpi, selection, gapThreshold);
+    if(plan.ranges.empty() || plan.totalBytes != dataStart.back())
     {
-      auto& part = (*srcParts)[0];
-      auto& headerInfo = hdr.headerInfos[0];
-      uint64_t truncatedLen = headerInfo.sodOffset + 2 + neededDataBytes;
-      truncatedLen = std::min<uint64_t>(truncatedLen, part->length_);
-      selectiveTileParts_[tileIndex]->push_back(0, 1, part->offset_, (uint32_t)truncatedLen);
+      copyFullTileParts();
+      return;
     }
-    else
+    pieces.clear();
+    for(auto& range : plan.ranges)
     {
-      // Multiple tile-parts: distribute needed bytes across tile-parts
-      uint64_t remainingNeeded = neededDataBytes;
       for(size_t i = 0; i < srcParts->size(); ++i)
       {
-        auto& part = (*srcParts)[i];
-        auto& headerInfo = hdr.headerInfos[i];
-        if(!headerInfo.valid)
-        {
-          selectiveTileParts_[tileIndex]->push_back((uint8_t)i, (uint8_t)srcParts->size(),
-                                                    part->offset_, (uint32_t)part->length_);
+        uint64_t begin = std::max(range.offset, dataStart[i]);
+        uint64_t end = std::min(range.end(), dataStart[i + 1]);
+        if(begin >= end)
           continue;
-        }
-        uint64_t tpDataSize = part->length_ - headerInfo.sodOffset - 2;
-        if(remainingNeeded >= tpDataSize)
-        {
-          selectiveTileParts_[tileIndex]->push_back((uint8_t)i, (uint8_t)srcParts->size(),
-                                                    part->offset_, (uint32_t)part->length_);
-          remainingNeeded -= tpDataSize;
-        }
-        else
-        {
-          uint64_t truncatedLen = headerInfo.sodOffset + 2 + remainingNeeded;
-          selectiveTileParts_[tileIndex]->push_back((uint8_t)i, (uint8_t)srcParts->size(),
-                                                    part->offset_, (uint32_t)truncatedLen);
-          remainingNeeded = 0;
-        }
+        uint64_t fileOffset =
+            (*srcParts)[i]->offset_ + hdr.headerInfos[i].sodOffset + 2 + begin - dataStart[i];
+        pieces.emplace_back((uint8_t)i, FetchRange{fileOffset, end - begin});
       }
     }
+    if(srcParts->size() + pieces.size() <= UINT8_MAX)
+      break;
+    gapThreshold = gapThreshold ? gapThreshold * 2 : FetchLinkStats::kMinGap;
   }
-  else
+  if(plan.fetchBytes() == plan.totalBytes)
   {
-    // Disjoint case: create synthetic entries for header + each data range
-    // Only supports single tile-part tiles
-    if(srcParts->size() != 1)
-    {
-      // Fallback: fetch full for multi-tile-part tiles with disjoint ranges
-      copyFullTileParts();
-      return;
-    }
-
-    auto& part = (*srcParts)[0];
-    auto& headerInfo = hdr.headerInfos[0];
-    uint8_t numEntries = (uint8_t)(1 + ranges.size()); // header + data ranges
-
-    // Entry 0: header (tile-part start to SOD+2)
-    uint32_t headerLen = (uint32_t)(headerInfo.sodOffset + 2);
-    selectiveTileParts_[tileIndex]->push_back(0, numEntries, part->offset_, headerLen);
+    copyFullTileParts();
+    return;
+  }
+  auto& layout = selectiveLayouts_[tileIndex];
+  layout.fetchedPackets = std::make_shared<const std::vector<bool>>(std::move(plan.fetchedPackets));
 
-    // Entries 1..N: data ranges (offset relative to tile-part packet data start)
-    uint64_t dataStart = part->offset_ + headerInfo.sodOffset + 2;
-    for(size_t r = 0; r < ranges.size(); ++r)
+  // Contiguous from offset 0 (RLCP/RPCL/single-layer LRCP): one truncated fetch per
+  // tile part, down to the bare header for tile parts past the needed data
+  selectiveTileParts_[tileIndex] = std::make_unique<TPSeq>();
+  auto& entries = selectiveTileParts_[tileIndex];
+  if(plan.ranges.size() == 1 && plan.ranges[0].offset == 0)
+  {
+    uint64_t needed = plan.ranges[0].length;
+    for(size_t i = 0; i < srcParts->size(); ++i)
     {
-      uint64_t rangeFileOffset = dataStart + ranges[r].offset;
-      uint32_t rangeLen = (uint32_t)ranges[r].length;
-      selectiveTileParts_[tileIndex]->push_back((uint8_t)(1 + r), numEntries, rangeFileOffset,
-                                                rangeLen);
+      auto& part = (*srcParts)[i];
+      uint64_t headerLen = hdr.headerInfos[i].sodOffset + 2;
+      uint64_t dataLen = std::clamp(needed, dataStart[i], dataStart[i + 1]) - dataStart[i];
+      entries->push_back((uint8_t)i, (uint8_t)srcParts->size(), part->offset_,
+                         (uint32_t)std::min<uint64_t>(headerLen + dataLen, part->length_));
     }
+    return;
+  }
+
+  // Disjoint: per tile part, a header entry (SOT through SOD) followed by the
+  // data ranges inside that tile part, assembled again after the fetch
+  std::vector<std::pair<uint8_t, FetchRange>> layoutEntries;
+  size_t piece = 0;
+  for(size_t i = 0; i < srcParts->size(); ++i)
+  {
+    auto& part = (*srcParts)[i];
+    layoutEntries.emplace_back((uint8_t)i,
+                               FetchRange{part->offset_, hdr.headerInfos[i].sodOffset + 2});
+    for(; piece < pieces.size() && pieces[piece].first == i; ++piece)
+      layoutEntries.push_back(pieces[piece]);
+  }
+  auto numEntries = (uint8_t)layoutEntries.size();
+  for(size_t e = 0; e < layoutEntries.size(); ++e)
+  {
+    auto& [tilePart, range] = layoutEntries[e];
+    entries->push_back((uint8_t)e, numEntries, range.offset, (uint32_t)range.length);
+    layout.tilePartOfEntry.push_back(tilePart);
   }
 }
 
+std::shared_ptr<TPFetchSeq> CodeStreamDecompress::assembleSelectiveTile(
+    uint16_t tileIndex, const std::function<const uint8_t*(size_t entry)>& entryData)
+{
+  auto& entries = *selectiveTileParts_[tileIndex];
+  auto& tilePartOfEntry = selectiveLayouts_[tileIndex].tilePartOfEntry;
+  auto seq = std::make_shared<TPFetchSeq>();
+  size_t e = 0;
+  while(e < entries.size())
+  {
+    size_t end = e;
+    uint64_t totalSize = 0;
+    while(end < entries.size() && tilePartOfEntry[end] == tilePartOfEntry[e])
+      totalSize += entries[end++]->length_;
+
+    auto assembled = std::make_shared<uint8_t[]>(totalSize);
+    uint64_t pos = 0;
+    for(; e < end; ++e)
+    {
+      auto src = entryData(e);
+      if(src)
+        std::memcpy(assembled.get() + pos, src, entries[e]->length_);
+      pos += entries[e]->length_;
+    }
+    auto fetch = std::make_shared<TPFetch>(0, totalSize, tileIndex);
+    fetch->data_ = std::move(assembled);
+    fetch->stream_ = std::unique_ptr<IStream>(
+        memStreamCreate(fetch->data_.get(), totalSize, stream_->getFormat(), true));
+    seq->SharedPtrSeq<TPFetch>::push_back(fetch);
+  }
+  return seq;
+}
+
 std::vector<std::pair<uint16_t, std::shared_ptr<TPFetchSeq>>> CodeStreamDecompress::reusePhase1Data(
     std::shared_ptr<std::set<uint16_t>>& selectiveFetchTiles,
     const std::unordered_map<uint16_t, TileHeaderResult>& headerResults,
@@ -2138,45 +2580,19 @@ std::vector<std::pair<uint16_t, std::shared_ptr<TPFetchSeq>>> CodeStreamDecompre
     }
     auto& hdr = headerIt->second;
     auto& srcParts = allTileParts[tileIndex];
-    bool isDjoint = (selParts->size() != srcParts->size());
+    auto& tilePartOfEntry = selectiveLayouts_[tileIndex].tilePartOfEntry;
+    bool isDisjoint = !tilePartOfEntry.empty();
 
-    // Check if all entries' data fits within Phase 1 buffers
+    // Check if all entries' data fits within the Phase 1 buffer of their tile part.
+    // Contiguous entries map 1:1 onto tile parts.
     bool allFit = true;
-    if(!isDjoint)
+    for(size_t i = 0; i < selParts->size() && allFit; ++i)
     {
-      // Contiguous: each entry maps 1:1 to a tile-part's Phase 1 buffer
-      for(size_t i = 0; i < selParts->size(); ++i)
-      {
-        if(i >= hdr.headerSizes.size() || !hdr.headerData[i] ||
-           (*selParts)[i]->length_ > hdr.headerSizes[i])
-        {
-          allFit = false;
-          break;
-        }
-      }
-    }
-    else
-    {
-      // Disjoint (single tile-part only): entries are sub-ranges within the one buffer
-      if(srcParts->size() != 1 || hdr.headerSizes.empty() || !hdr.headerData[0])
-      {
-        allFit = false;
-      }
-      else
-      {
-        uint64_t baseOffset = (*srcParts)[0]->offset_;
-        uint32_t bufSize = hdr.headerSizes[0];
-        for(size_t i = 0; i < selParts->size(); ++i)
-        {
-          auto& entry = (*selParts)[i];
-          uint64_t relOff = entry->offset_ - baseOffset;
-          if(relOff + entry->length_ > bufSize)
-          {
-            allFit = false;
-            break;
-          }
-        }
-      }
+      auto& entry = (*selParts)[i];
+      size_t tilePart = isDisjoint ? tilePartOfEntry[i] : i;
+      uint64_t relOff = entry->offset_ - (*srcParts)[tilePart]->offset_;
+      allFit = tilePart < hdr.headerSizes.size() && hdr.headerData[tilePart] &&
+               relOff + entry->length_ <= hdr.headerSizes[tilePart];
     }
     if(!allFit)
     {
@@ -2185,9 +2601,10 @@ std::vector<std::pair<uint16_t, std::shared_ptr<TPFetchSeq>>> CodeStreamDecompre
     }
 
     // Build decompression sequence from Phase 1 data
-    if(!isDjoint)
+    std::shared_ptr<TPFetchSeq> decompressSeq;
+    if(!isDisjoint)
     {
-      auto decompressSeq = std::make_shared<TPFetchSeq>();
+      decompressSeq = std::make_shared<TPFetchSeq>();
       for(size_t i = 0; i < selParts->size(); ++i)
       {
         auto& entry = (*selParts)[i];
@@ -2198,34 +2615,16 @@ std::vector<std::pair<uint16_t, std::shared_ptr<TPFetchSeq>>> CodeStreamDecompre
             memStreamCreate(fetch->data_.get(), fetch->length_, stream_->getFormat(), true));
         decompressSeq->SharedPtrSeq<TPFetch>::push_back(fetch);
       }
-      prefetchedTiles.push_back({tileIndex, decompressSeq});
     }
     else
     {
-      // Disjoint: assemble header + data ranges into single contiguous buffer
-      uint64_t baseOffset = (*srcParts)[0]->offset_;
-      uint64_t totalSize = 0;
-      for(size_t i = 0; i < selParts->size(); ++i)
-        totalSize += (*selParts)[i]->length_;
-
-      auto assembled = std::make_unique<uint8_t[]>(totalSize);
-      uint64_t pos = 0;
-      for(size_t i = 0; i < selParts->size(); ++i)
-      {
-        auto& entry = (*selParts)[i];
-        uint64_t relOff = entry->offset_ - baseOffset;
-        std::memcpy(assembled.get() + pos, hdr.headerData[0].get() + relOff, entry->length_);
-        pos += entry->length_;
-      }
-
-      auto decompressSeq = std::make_shared<TPFetchSeq>();
-      auto assembledFetch = std::make_shared<TPFetch>(0, totalSize, tileIndex);
-      assembledFetch->data_ = std::move(assembled);
-      assembledFetch->stream_ = std::unique_ptr<IStream>(
-          memStreamCreate(assembledFetch->data_.get(), totalSize, stream_->getFormat(), true));
-      decompressSeq->SharedPtrSeq<TPFetch>::push_back(assembledFetch);
-      prefetchedTiles.push_back({tileIndex, decompressSeq});
+      decompressSeq = assembleSelectiveTile(tileIndex, [&](size_t i) -> const uint8_t* {
+        auto tilePart = tilePartOfEntry[i];
+        uint64_t relOff = (*selParts)[i]->offset_ - (*srcParts)[tilePart]->offset_;
+        return hdr.headerData[tilePart].get() + relOff;
+      });
     }
+    prefetchedTiles.push_back({tileIndex, decompressSeq});
     it = selectiveFetchTiles->erase(it);
   }
 
@@ -2376,8 +2775,12 @@ bool CodeStreamDecompress::fetchByTileSelective(
   phase1Future.get();
   grklog.debug("fetchByTileSelective: Phase 1 complete");
 
-  // Phase 2: Compute needed lengths and fetch truncated tile-parts
+  // Phase 2: plan each tile down to the precincts the decode needs, then fetch
+  // every tile's ranges in one batch. Phase 1 requests have measured the link by now,
+  // so the gap threshold reflects its actual latency and transfer rate.
+  auto gapThreshold = fetcher->rangeGapThreshold();
   selectiveTileParts_.resize(allTileParts.size());
+  selectiveLayouts_.resize(allTileParts.size());
   auto selectiveFetchTiles = std::make_shared<std::set<uint16_t>>();
 
   for(auto tileIndex : slated)
@@ -2386,7 +2789,8 @@ bool CodeStreamDecompress::fetchByTileSelective(
     if(it == headerResults->end())
       continue;
 
-    buildSelectiveTileParts(tileIndex, it->second, allTileParts, reduce);
+    buildSelectiveTileParts(tileIndex, it->second, allTileParts, unreducedImageBounds,
+                            gapThreshold);
     if(selectiveTileParts_[tileIndex])
       selectiveFetchTiles->insert(tileIndex);
   }
@@ -2400,17 +2804,8 @@ bool CodeStreamDecompress::fetchByTileSelective(
 
   if(selectiveFetchTiles->empty() && prefetchedTiles.empty())
     return false;
-  grklog.debug("fetchByTileSelective: %zu tiles to fetch", selectiveFetchTiles->size());
-
-  // Track which tiles have disjoint (sparse) fetch entries
-  auto disjointTiles = std::make_shared<std::set<uint16_t>>();
-  for(auto tileIndex : *selectiveFetchTiles)
-  {
-    auto& srcParts = allTileParts[tileIndex];
-    auto& selParts = selectiveTileParts_[tileIndex];
-    if(selParts && selParts->size() > srcParts->size())
-      disjointTiles->insert(tileIndex);
-  }
+  grklog.debug("fetchByTileSelective: %zu tiles to fetch, gap threshold %llu bytes",
+               selectiveFetchTiles->size(), (unsigned long long)gapThreshold);
 
   // Phase 2: Fetch truncated tile-parts through existing pipeline
   maxFetchedTileRow_.store(-1, std::memory_order_release);
@@ -2423,7 +2818,7 @@ bool CodeStreamDecompress::fetchByTileSelective(
   // Queue pre-fetched tiles directly for decompression (reusing Phase 1 data)
   for(auto& [tileIndex, decompressSeq] : prefetchedTiles)
     enqueueTileForDecompress(tileIndex, decompressSeq, numTileCols, unreducedImageBounds,
-                             postGenerator);
+                             postGenerator, selectiveLayouts_[tileIndex].fetchedPackets);
 
   if(!selectiveFetchTiles->empty())
   {
@@ -2431,13 +2826,15 @@ bool CodeStreamDecompress::fetchByTileSelective(
 
     fetchByTileFutures_.push_back(fetcher->fetchTiles(
         selectiveTileParts_, *selectiveFetchTiles, nullptr,
-        [this, numTileCols, unreducedImageBounds, postGenerator, selectiveFetchTiles,
-         disjointTiles](size_t requestIndex, TileFetchContext* context) {
+        [this, numTileCols, unreducedImageBounds, postGenerator,
+         selectiveFetchTiles](size_t requestIndex, TileFetchContext* context) {
           auto& tilePart = (*context->requests_)[requestIndex];
           auto tileIndex = tilePart->tileIndex_;
           auto& tilePartSeq = (*context->tilePartFetchByTile_)[tileIndex];
+          auto& layout = selectiveLayouts_[tileIndex];
+          bool disjoint = !layout.tilePartOfEntry.empty();
 
-          if(!disjointTiles->count(tileIndex))
+          if(!disjoint)
           {
             // Contiguous case: create MemStream per entry (standard path)
             tilePart->stream_ = std::unique_ptr<IStream>(memStreamCreate(
@@ -2446,41 +2843,17 @@ bool CodeStreamDecompress::fetchByTileSelective(
 
           if(tilePartSeq->incrementFetchCount() == tilePartSeq->size())
           {
-            std::shared_ptr<TPFetchSeq> decompressSeq;
-
-            if(disjointTiles->count(tileIndex))
-            {
-              // Disjoint case: assemble header + data ranges into single buffer
-              // Entry 0 = header (with SOT), entries 1..N = data ranges
-              uint64_t totalSize = 0;
-              for(size_t i = 0; i < tilePartSeq->size(); ++i)
-                totalSize += (*tilePartSeq)[i]->length_;
-
-              auto assembled = std::make_unique<uint8_t[]>(totalSize);
-              uint64_t pos = 0;
-              for(size_t i = 0; i < tilePartSeq->size(); ++i)
-              {
-                auto& tp = (*tilePartSeq)[i];
-                if(tp->data_)
-                  std::memcpy(assembled.get() + pos, tp->data_.get(), tp->length_);
-                pos += tp->length_;
-              }
-
-              // Create single-entry TPFetchSeq with assembled data
-              decompressSeq = std::make_shared<TPFetchSeq>();
-              auto assembledFetch = std::make_shared<TPFetch>(0, totalSize, tileIndex);
-              assembledFetch->data_ = std::move(assembled);
-              assembledFetch->stream_ = std::unique_ptr<IStream>(memStreamCreate(
-                  assembledFetch->data_.get(), totalSize, stream_->getFormat(), true));
-              decompressSeq->SharedPtrSeq<TPFetch>::push_back(assembledFetch);
-            }
-            else
+            std::shared_ptr<TPFetchSeq> decompressSeq = tilePartSeq;
+            if(disjoint)
             {
-              decompressSeq = tilePartSeq;
+              // Disjoint case: reassemble each tile part from its header and data ranges
+              auto entryData = [&tilePartSeq](size_t i) -> const uint8_t* {
+                return (*tilePartSeq)[i]->data_.get();
+              };
+              decompressSeq = assembleSelectiveTile(tileIndex, entryData);
             }
-
             enqueueTileForDecompress(tileIndex, decompressSeq, numTileCols, unreducedImageBounds,
-                                     postGenerator);
+                                     postGenerator, layout.fetchedPackets);
           }
         }));
   } // if(!selectiveFetchTiles->empty())
@@ -2529,6 +2902,7 @@ bool CodeStreamDecompress::activateScratch(bool singleTile, GrkImage* scratch)
   scratchDataPending_ = false;
   scratchDataAllocated_ = false;
   scratchBandRowHeights_.clear();
+  cp_.componentGroupTarget_ = nullptr;
 
   // The single 16-bit DWT eligibility decision for this decode. TileProcessor reads it back
   // out of the coding params, so a tile can never decode into a sample type the composite
@@ -2548,6 +2922,15 @@ bool CodeStreamDecompress::activateScratch(bool singleTile, GrkImage* scratch)
       break;
     }
   }
+  // a custom MCT transforms int32 and float windows
+  if(defaultTcp_->mct_ == 2)
+    allEligible = false;
+  // overview levels are copied out of int32 windows
+  if(cp_.codingParams_.dec_.pyramidReductions_)
+    allEligible = false;
+  // as are coefficients handed to a coefficient sink
+  if(cp_.coefficientSink_ || cp_.codeblockSink_)
+    allEligible = false;
   cp_.codingParams_.dec_.use16BitDwt_ = allEligible;
 
   // Decide the composite sample type from the same inputs TileProcessor uses, and set it
@@ -2611,9 +2994,288 @@ bool CodeStreamDecompress::activateScratch(bool singleTile, GrkImage* scratch)
   }
 
   scratchDataPending_ = !cp_.codingParams_.dec_.skipAllocateComposite_;
+  // band streaming copies each component group into the composite as soon as it is
+  // decompressed, unless something after the tile needs the whole tile image
+  if(cp_.codingParams_.dec_.componentGroupSize_ && scratchDataPending_ &&
+     !cp_.decompressCallback_ && !directOutput_.data && !resampler_ && pyramid_.empty() &&
+     tileCache_->getStrategy() == GRK_TILE_CACHE_NONE)
+  {
+    cp_.componentGroupTarget_ = [this]() -> GrkImage* {
+      if(!ensureScratchData() || scratchImage_->interleaved_data.data)
+        return nullptr;
+      return scratchImage_.get();
+    };
+  }
   return true;
 }
 
+bool CodeStreamDecompress::prepareDirectOutput(void)
+{
+  directOutput_ = {};
+  if(!outputBuffer_)
+    return true;
+  auto buf = *outputBuffer_;
+  if(!buf.data || !buf.numcomps || (buf.prec != 8 && buf.prec != 16 && buf.prec != 32))
+  {
+    grklog.error("Output buffer needs data, at least one band and a precision of 8, 16 or 32");
+    return false;
+  }
+  if(ioBandCallback_)
+  {
+    grklog.error("An output buffer cannot be combined with a band callback");
+    return false;
+  }
+  for(uint16_t i = 0; i < buf.numcomps; ++i)
+  {
+    int compno = buf.band_map ? buf.band_map[i] - 1 : (int)i;
+    if(compno < 0 || compno >= (int)headerImage_->numcomps)
+    {
+      grklog.error("Output buffer band %u maps to missing component %d", i, compno);
+      return false;
+    }
+    auto comp = headerImage_->comps + compno;
+    if(comp->dx != 1 || comp->dy != 1)
+    {
+      grklog.error("Output buffer band %u: sub-sampled component %d is not supported", i, compno);
+      return false;
+    }
+  }
+  if(buf.x1 <= buf.x0 || buf.y1 <= buf.y0)
+  {
+    // composite bounds are unreduced until the decompress runs
+    auto bounds = multiTileComposite_->getBounds();
+    uint8_t reduce = cp_.codingParams_.dec_.reduce_;
+    buf.x0 = ceildivpow2<uint32_t>(bounds.x0, reduce);
+    buf.y0 = ceildivpow2<uint32_t>(bounds.y0, reduce);
+    buf.x1 = ceildivpow2<uint32_t>(bounds.x1, reduce);
+    buf.y1 = ceildivpow2<uint32_t>(bounds.y1, reduce);
+  }
+  if(!multiTileComposite_->isPostProcessNoOp())
+    grklog.warn("Output buffer receives raw decoded samples: colour and precision "
+                "post-processing is not applied");
+  directOutput_ = buf;
+  return true;
+}
+
+void CodeStreamDecompress::storeDirectOutput(const grk_image* tileImage)
+{
+  if(directOutput_.data && tileImage)
+    hwy_copy_tile_to_swath(tileImage, &directOutput_);
+}
+
+void CodeStreamDecompress::preparePyramid(bool reset)
+{
+  if(reset)
+    releasePyramid();
+  uint32_t reductions = cp_.codingParams_.dec_.pyramidReductions_;
+  if(!reductions)
+    return;
+  if(!region_.empty())
+  {
+    grklog.warn("Overview levels are not supported with a decompress window: ignored");
+    return;
+  }
+  uint8_t maxResolutions = 0;
+  for(uint16_t compno = 0; compno < headerImage_->numcomps; ++compno)
+    maxResolutions = std::max(maxResolutions, defaultTcp_->tccps_[compno].numresolutions_);
+  pyramid_.resize(maxResolutions, nullptr);
+  for(uint8_t reduction = (uint8_t)(cp_.codingParams_.dec_.reduce_ + 1);
+      reduction < maxResolutions; ++reduction)
+  {
+    if(!((reductions >> reduction) & 1) || pyramid_[reduction])
+      continue;
+    auto level = new GrkImage();
+    headerImage_->copyHeaderTo(level);
+    bool ok = level->subsampleAndReduce(reduction);
+    for(uint16_t compno = 0; ok && compno < level->numcomps; ++compno)
+    {
+      auto comp = level->comps + compno;
+      comp->data_type = GRK_INT_32;
+      ok = GrkImage::allocData(comp, true);
+    }
+    if(!ok)
+    {
+      grklog.warn("Unable to allocate overview level at reduction %u: skipped", reduction);
+      grk_unref(level);
+      continue;
+    }
+    pyramid_[reduction] = level;
+  }
+}
+
+void CodeStreamDecompress::selectScaledReduce(void)
+{
+  auto& dec = cp_.codingParams_.dec_;
+  if(!dec.scaledWidth_ || !dec.scaledHeight_)
+    return;
+  if(cp_.dw_reduced)
+  {
+    grklog.warn("Scaled output needs a decompress window in full resolution coordinates: "
+                "scaling ignored");
+    dec.scaledWidth_ = 0;
+    dec.scaledHeight_ = 0;
+    return;
+  }
+  // full resolution size of the window, as setDecompressRegion will resolve it
+  auto image = headerImage_;
+  double width = image->x1 - image->x0;
+  double height = image->y1 - image->y0;
+  RectD region(cp_.dw_x0, cp_.dw_y0, cp_.dw_x1, cp_.dw_y1);
+  if(region != RectD(0, 0, 0, 0))
+  {
+    if(region.x0 <= 1.0 && region.y0 <= 1.0 && region.x1 <= 1.0 && region.y1 <= 1.0)
+    {
+      width = ceil(region.x1 * width) - floor(region.x0 * width);
+      height = ceil(region.y1 * height) - floor(region.y0 * height);
+    }
+    else
+    {
+      width = std::min(region.x1, width) - region.x0;
+      height = std::min(region.y1, height) - region.y0;
+    }
+  }
+  uint8_t maxReduce = UINT8_MAX;
+  for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+    maxReduce = std::min(maxReduce, (uint8_t)(defaultTcp_->tccps_[compno].numresolutions_ - 1));
+  uint8_t reduce = 0;
+  while(reduce < maxReduce && ceil(ldexp(width, -(reduce + 1))) >= dec.scaledWidth_ &&
+        ceil(ldexp(height, -(reduce + 1))) >= dec.scaledHeight_)
+    ++reduce;
+  // the resampler stores tiles as they finish, so only the composite it replaces is skipped
+  dec.skipAllocateComposite_ = true;
+  if(reduce == dec.reduce_)
+    return;
+  dec.reduce_ = reduce;
+  headerImage_->subsampleAndReduce(reduce);
+  multiTileComposite_->subsampleAndReduce(reduce);
+}
+
+bool CodeStreamDecompress::prepareScaled(void)
+{
+  auto& dec = cp_.codingParams_.dec_;
+  if(!dec.scaledWidth_ || !dec.scaledHeight_)
+  {
+    resampler_.reset();
+    return true;
+  }
+  if(!resampler_)
+    resampler_ = std::make_unique<ImageResampler>();
+  if(!resampler_->init(headerImage_, multiTileComposite_.get(), dec.scaledWidth_,
+                       dec.scaledHeight_, cp_.tx0_, cp_.ty0_, cp_.t_width_, cp_.t_height_,
+                       dec.reduce_))
+  {
+    grklog.error("Unable to allocate the %u x %u scaled image", dec.scaledWidth_,
+                 dec.scaledHeight_);
+    resampler_.reset();
+    return false;
+  }
+  // tiles are resampled as they finish, so cached tiles have to run again
+  tileCache_->setDirty(true);
+
+  return true;
+}
+
+void CodeStreamDecompress::releasePyramid(void)
+{
+  for(auto level : pyramid_)
+  {
+    if(level)
+      grk_unref(level);
+  }
+  pyramid_.clear();
+}
+
+void CodeStreamDecompress::storePyramid(ITileProcessor* tileProcessor)
+{
+  if(!pyramid_.empty())
+    tileProcessor->compositePyramid(pyramid_.data(), (uint8_t)pyramid_.size());
+}
+
+// Memory budget ///////////////////////////////////////////////////
+
+static uint64_t imageBytes(const GrkImage* image)
+{
+  if(!image)
+    return 0;
+  uint64_t bytes = 0;
+  for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+  {
+    auto comp = image->comps + compno;
+    if(!comp->data)
+      continue;
+    uint64_t sampleBytes = sizeof(int32_t);
+    if(comp->data_type == GRK_INT_16)
+      sampleBytes = sizeof(int16_t);
+    else if(comp->data_type == GRK_INT_8)
+      sampleBytes = sizeof(int8_t);
+    else if(comp->data_type == GRK_DOUBLE)
+      sampleBytes = sizeof(double);
+    bytes += (uint64_t)comp->stride * comp->h * sampleBytes;
+  }
+  return bytes;
+}
+
+uint64_t CodeStreamDecompress::tileCoefficientBytes(uint16_t tileIndex) const
+{
+  auto tileBounds = cp_.getTileBounds(headerImage_->getBounds(), tileIndex % cp_.t_grid_width_,
+                                      tileIndex / cp_.t_grid_width_);
+  uint64_t bytes = 0;
+  for(uint16_t compno = 0; compno < headerImage_->numcomps; ++compno)
+  {
+    auto comp = headerImage_->comps + compno;
+    auto bounds = tileBounds.scaleDownCeil(comp->dx, comp->dy)
+                      .scaleDownCeilPow2(cp_.codingParams_.dec_.reduce_);
+    bytes += (uint64_t)bounds.width() * bounds.height() * sizeof(int32_t);
+  }
+  return bytes;
+}
+
+uint64_t CodeStreamDecompress::tileWorkingSetBytes(ITileProcessor* tileProcessor)
+{
+  auto tileIndex = tileProcessor->getIndex();
+  uint64_t compressed = tileProcessor->getCompressedLength();
+  if(!compressed && tilePartFetchByTile_)
+  {
+    auto it = tilePartFetchByTile_->find(tileIndex);
+    if(it != tilePartFetchByTile_->end() && it->second)
+    {
+      for(const auto& part : *it->second)
+        compressed += part->length_;
+    }
+  }
+  // per-worker scratch (wavelet lines, code block buffers) does not grow with the
+  // number of tiles in flight, so it is left out
+  return 2 * tileCoefficientBytes(tileIndex) + compressed;
+}
+
+void CodeStreamDecompress::chargeTile(ITileProcessor* tileProcessor)
+{
+  memoryBudget_.init((uint16_t)(cp_.t_grid_width_ * cp_.t_grid_height_));
+  // a worker must not block: the tiles it would wait for may need its thread,
+  // and an inline executor only runs them once this thread moves on
+  bool mayWait = !TFSingleton::isSingleThreaded() && TFSingleton::get().this_worker_id() < 0;
+  memoryBudget_.acquire(
+      tileProcessor->getIndex(), tileWorkingSetBytes(tileProcessor), mayWait,
+      [this]() {
+        return tileCache_->evictLRU(
+            [this](uint16_t tileIndex) { return memoryBudget_.holdsCoefficients(tileIndex); });
+      },
+      [this]() { return !success_; });
+}
+
+void CodeStreamDecompress::settleTileCharge(uint16_t tileIndex, ITileProcessor* tileProcessor)
+{
+  uint64_t coefficientBytes = 0;
+  uint64_t tileImageBytes = 0;
+  if(tileProcessor)
+  {
+    // what the buffers hold now, so a tile whose buffers were freed keeps no share
+    coefficientBytes = tileProcessor->getAllocatedBytes();
+    tileImageBytes = imageBytes(tileProcessor->getImage());
+  }
+  memoryBudget_.settle(tileIndex, coefficientBytes, tileImageBytes);
+}
+
 // the canvas geometry comes straight from the SIZ header, so allocating up front
 // lets a tiny header claim gigabytes before any tile data is read
 bool CodeStreamDecompress::ensureScratchData(void)
@@ -20,7 +20,12 @@
 #include "ConcurrentQueue.h"
 #include "TFSingleton.h"
 #include "CompressedChunkCache.h"
+#include "CodeblockCache.h"
+#include "MemoryBudget.h"
+#include "TilePriority.h"
+#include "TileReadAhead.h"
 #include "SelectiveFetchRanges.h"
+#include "ImageResampler.h"
 #include <map>
 #include <atomic>
 
@@ -49,21 +54,7 @@ public:
   /**
    * @brief Destroys a CodeStreamDecompress
    */
-  ~CodeStreamDecompress()
-  {
-    if(decompressQueue_)
-      decompressQueue_->close();
-    if(decompressConsumer_.joinable())
-      decompressConsumer_.join();
-    if(decompressWorker_.joinable())
-      decompressWorker_.join();
-    // Wait on this codec's own executor when it owns one (single-threaded mode);
-    // the decode scope has already exited so the thread-local override is gone.
-    if(localExecutor_)
-      localExecutor_->wait_for_all();
-    else
-      TFSingleton::get().wait_for_all();
-  }
+  ~CodeStreamDecompress();
 
   void init(grk_decompress_parameters* param) override;
   void setInputFilePath(const char* path) override
@@ -80,6 +71,20 @@ public:
   {
     return ioBandUserData_;
   }
+  CodeblockCache* getCodeblockCache() override
+  {
+    return codeblockCache_.get();
+  }
+  bool getCodeblockCacheStats(grk_codeblock_cache_stats* stats) override;
+
+  GrkImage* getPyramidImage(uint8_t reduction) override;
+  GrkImage* getScaledImage(void) override;
+
+  bool getMemoryBudgetStats(grk_memory_budget_stats* stats) override;
+
+  bool setFocus(uint32_t x, uint32_t y) override;
+
+  bool setTilePriority(uint16_t tile_index, uint32_t priority) override;
 
   grk_progression_state getProgressionState(uint16_t tile_index) override;
 
@@ -230,6 +235,22 @@ private:
 
   bool schedule(ITileProcessor* tileProcessor, bool multiTile);
 
+  /**
+   * @brief Schedules TLM tiles in @ref TilePriority order, keeping just enough of them in
+   * flight to occupy every worker so that priority changes still reorder the rest.
+   * The read-ahead follows the same order, and is planned again whenever it changes.
+   *
+   * @param pendingTiles tiles to decompress
+   */
+  void scheduleByPriority(const std::set<uint16_t>& pendingTiles);
+
+  /**
+   * @brief Sorts a batch of tiles into @ref TilePriority order, if priorities are set
+   *
+   * @param batch tiles to schedule together
+   */
+  void sortBatch(std::vector<uint16_t>& batch);
+
   /**
    * @brief Parses next slated tile
    *
@@ -347,6 +368,84 @@ private:
    */
   bool ensureScratchData(void);
 
+  /**
+   * @brief Validates the caller's output buffer and resolves its region
+   *
+   * @return true on success, or when no output buffer is set
+   */
+  bool prepareDirectOutput(void);
+
+  /**
+   * @brief Stores a finished tile into the caller's output buffer, if one is set
+   *
+   * @param tileImage image holding the tile's decoded samples
+   */
+  void storeDirectOutput(const grk_image* tileImage);
+
+  /**
+   * @brief Allocates an image for each requested overview level that has none yet
+   *
+   * @param reset if true, first drop the levels of a previous decompress
+   */
+  void preparePyramid(bool reset);
+
+  /**
+   * @brief Drops all overview level images
+   */
+  void releasePyramid(void);
+
+  /**
+   * @brief Stores a finished tile's overview levels into their images
+   *
+   * @param tileProcessor @ref ITileProcessor for the tile
+   */
+  void storePyramid(ITileProcessor* tileProcessor);
+
+  /**
+   * @brief For a scaled decompress, chooses the smallest resolution at least as large
+   * as the scaled size, and reduces the header and composite images to it
+   */
+  void selectScaledReduce(void);
+
+  /**
+   * @brief Allocates the scaled image, if a scaled size is requested
+   *
+   * @return true on success, or when no scaled size is requested
+   */
+  bool prepareScaled(void);
+
+  /**
+   * @brief Estimates the bytes a tile's decompression holds at once: its decoded
+   * coefficients, the tile image extracted from them, and its compressed tile parts
+   *
+   * @param tileProcessor @ref ITileProcessor for the tile
+   */
+  uint64_t tileWorkingSetBytes(ITileProcessor* tileProcessor);
+
+  /**
+   * @brief Bytes of decoded coefficients for a tile at the current reduction
+   *
+   * @param tileIndex tile index
+   */
+  uint64_t tileCoefficientBytes(uint16_t tileIndex) const;
+
+  /**
+   * @brief Charges a tile about to be scheduled to the memory budget. Near the budget,
+   * this evicts cached tiles' coefficients and then waits for running tiles to finish,
+   * unless called on a worker thread.
+   *
+   * @param tileProcessor @ref ITileProcessor for the tile
+   */
+  void chargeTile(ITileProcessor* tileProcessor);
+
+  /**
+   * @brief Replaces a tile's memory budget charge with what the tile cache still holds
+   *
+   * @param tileIndex tile index
+   * @param tileProcessor @ref ITileProcessor for the tile, or nullptr once it is gone
+   */
+  void settleTileCharge(uint16_t tileIndex, ITileProcessor* tileProcessor);
+
   /**
    * @brief Creates a Post Task object
    *
@@ -413,6 +512,20 @@ private:
   /** @brief Selective fetch tile-parts (kept alive for async Phase 2 fetch) */
   TPSEQ_VEC selectiveTileParts_;
 
+  /**
+   * @brief How a tile's selective fetch entries map back onto the tile
+   */
+  struct SelectiveTileLayout
+  {
+    /** source tile-part of each entry; empty when entries map 1:1 onto tile-parts */
+    std::vector<uint8_t> tilePartOfEntry;
+    /** packets inside the fetched ranges; nullptr when whole tile-parts are fetched */
+    std::shared_ptr<const std::vector<bool>> fetchedPackets;
+  };
+
+  /** @brief Selective fetch layouts, indexed like selectiveTileParts_ */
+  std::vector<SelectiveTileLayout> selectiveLayouts_;
+
   /**
    * @brief true if there was an error reading the main header
    */
@@ -449,6 +562,16 @@ private:
    */
   std::unique_ptr<TileCache> tileCache_;
 
+  /**
+   * @brief per-tile charges against grk_decompress_core_params::memory_budget_bytes
+   */
+  TileMemoryBudget memoryBudget_;
+
+  /**
+   * @brief order in which waiting tiles are scheduled
+   */
+  TilePriority tilePriority_;
+
   /**
    * @brief callback for io pixels
    *
@@ -467,6 +590,23 @@ private:
   grk_io_band_callback ioBandCallback_ = nullptr;
   void* ioBandUserData_ = nullptr;
 
+  /**
+   * @brief caller's typed output buffer, and the copy with its region resolved
+   * for the current decompress (null data when disabled)
+   */
+  grk_swath_buffer* outputBuffer_ = nullptr;
+  grk_swath_buffer directOutput_{};
+
+  /**
+   * @brief overview level images indexed by reduction, null where none was requested
+   */
+  std::vector<GrkImage*> pyramid_;
+
+  /**
+   * @brief resamples finished tiles into the scaled image (null when disabled)
+   */
+  std::unique_ptr<ImageResampler> resampler_;
+
   // deferred allocation of the scratch composite/strip buffer, set up by
   // activateScratch and carried out by ensureScratchData
   std::mutex scratchDataMutex_;
@@ -564,32 +704,50 @@ private:
    * @param numTileCols       number of tile columns in the grid
    * @param unreducedImageBounds  unreduced image bounds for decompress tasks
    * @param postGenerator     factory for post-decompress callbacks
+   * @param fetchedPackets    for selectively fetched byte ranges, the packets they hold;
+   * nullptr if the sequence holds whole tile parts
    */
-  void
-      enqueueTileForDecompress(uint16_t tileIndex, std::shared_ptr<TPFetchSeq> decompressSeq,
-                               uint16_t numTileCols, Rect32 unreducedImageBounds,
-                               std::function<std::function<void()>(ITileProcessor*)> postGenerator);
+  void enqueueTileForDecompress(uint16_t tileIndex, std::shared_ptr<TPFetchSeq> decompressSeq,
+                                uint16_t numTileCols, Rect32 unreducedImageBounds,
+                                std::function<std::function<void()>(ITileProcessor*)> postGenerator,
+                                std::shared_ptr<const std::vector<bool>> fetchedPackets);
 
   /**
    * @brief Build selective tile-part entries for a single tile.
    *
    * Uses PLT packet lengths from the Phase 1 header result and the tile's
-   * progression order to compute the minimal fetch ranges for the target
-   * resolution. Populates selectiveTileParts_[tileIndex] with either:
+   * progression order to plan the minimal fetch ranges for the decode:
+   * reduce, layers to decompress, components to decode and the precincts
+   * that the decode window touches. Populates selectiveTileParts_[tileIndex]
+   * and selectiveLayouts_[tileIndex] with either:
    *  - Truncated entries (contiguous case) — one per tile-part, trimmed to
    *    the needed prefix of packet data.
-   *  - Synthetic entries (disjoint case) — header entry + one entry per
-   *    disjoint data range within the tile-part.
-   *  - Full tile-part entries (fallback) — when PLT is invalid or no savings
-   *    are possible.
+   *  - Synthetic entries (disjoint case) — per tile-part, a header entry
+   *    followed by one entry per data range within the tile-part.
+   *  - Full tile-part entries (fallback) — when PLT is invalid, the packet
+   *    order can't be modelled or no savings are possible.
    *
-   * @param tileIndex       tile index
-   * @param hdr             Phase 1 header result for this tile
-   * @param allTileParts    full tile-part offset/length info from TLM
-   * @param reduce          resolution reduction level
+   * @param tileIndex             tile index
+   * @param hdr                   Phase 1 header result for this tile
+   * @param allTileParts          full tile-part offset/length info from TLM
+   * @param unreducedImageBounds  decode window (canvas coordinates)
+   * @param gapThreshold          merge ranges separated by gaps up to this size (bytes)
    */
   void buildSelectiveTileParts(uint16_t tileIndex, const TileHeaderResult& hdr,
-                               const TPSEQ_VEC& allTileParts, uint8_t reduce);
+                               const TPSEQ_VEC& allTileParts, Rect32 unreducedImageBounds,
+                               uint64_t gapThreshold);
+
+  /**
+   * @brief Reassembles a disjoint selective tile into one buffer per tile-part,
+   * each holding the tile-part header followed by its fetched data ranges
+   *
+   * @param tileIndex  tile index
+   * @param entryData  bytes of selective entry i
+   * @return sequence with one memory stream per tile-part
+   */
+  std::shared_ptr<TPFetchSeq>
+      assembleSelectiveTile(uint16_t tileIndex,
+                            const std::function<const uint8_t*(size_t entry)>& entryData);
 
   /**
    * @brief Try to reuse Phase 1 data for tiles whose needed bytes fit in the header fetch.
@@ -679,6 +837,12 @@ private:
   // Compressed chunk cache: stores fetched compressed data for re-decompression
   std::unique_ptr<CompressedChunkCache> compressedChunkCache_;
 
+  // Decoded code block cache: lets overlapping decode windows skip T1 for blocks already decoded
+  std::unique_ptr<CodeblockCache> codeblockCache_;
+
+  // Local file read-ahead: reads upcoming tiles on an I/O thread while the current one decodes
+  std::unique_ptr<TileReadAhead> readAhead_;
+
   // Tile batching
 
   std::mutex batchTileQueueMutex_;
@@ -699,6 +863,12 @@ private:
   uint16_t decompressInFlight_ = 0;
   uint16_t maxDecompressInFlight_ = 0;
 
+  // tiles whose post step has run, so that scheduleByPriority() can admit the next tile
+  std::mutex tilePostedMutex_;
+  std::condition_variable tilePostedCV_;
+  std::vector<uint16_t> postedTiles_;
+  bool trackPostedTiles_ = false;
+
   // Row-based fetch throttle: highest tile row that has been fully fetched
   std::atomic<int32_t> maxFetchedTileRow_{-1};
 
@@ -188,6 +188,7 @@ void CodeStreamDecompress::postReadHeader(void)
   // set up tile completion based on tile and image bounds
   if(headerRead_)
   {
+    selectScaledReduce();
     setDecompressRegion(RectD(cp_.dw_x0, cp_.dw_y0, cp_.dw_x1, cp_.dw_y1));
     // Refresh decompress_width/height/etc. now that region bounds are applied.
     // Without this, formats that write headers before decompress() see stale
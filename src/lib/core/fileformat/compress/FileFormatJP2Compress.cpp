@@ -672,6 +672,10 @@ uint8_t* FileFormatJP2Compress::write_ihdr(uint32_t* p_nb_bytes_written)
 
   return ihdr_data;
 }
+CodingParams* FileFormatJP2Compress::getCodingParams(void)
+{
+  return codeStream ? codeStream->getCodingParams() : nullptr;
+}
 bool FileFormatJP2Compress::start(void)
 {
   /* validation of the parameters codec */
@@ -724,6 +728,10 @@ bool FileFormatJP2Compress::init(grk_cparameters* parameters, GrkImage* image)
     max_res_transcode_ = parameters->max_res_transcode;
     transcode_prog_order_ = parameters->transcode_prog_order;
     transcode_src_ = parameters->transcode_src;
+    crop_transcode_ = parameters->transcode_crop_x1 > parameters->transcode_crop_x0 &&
+                      parameters->transcode_crop_y1 > parameters->transcode_crop_y0;
+    if(crop_transcode_ && !initCrop(parameters))
+      return false;
   }
 
   cmsSetLogErrorHandler(MycmsLogErrorHandlerFunction);
@@ -777,6 +785,11 @@ bool FileFormatJP2Compress::init(grk_cparameters* parameters, GrkImage* image)
 
   h = inputImage_->y1 - inputImage_->y0;
   w = inputImage_->x1 - inputImage_->x0;
+  if(crop_transcode_)
+  {
+    h = cropCanvas_.y1 - cropCanvas_.y0;
+    w = cropCanvas_.x1 - cropCanvas_.x0;
+  }
   depth_0 = (uint8_t)(inputImage_->comps[0].prec - 1);
   sign = inputImage_->comps[0].sgnd;
   bpc = (uint8_t)(depth_0 + (sign << 7));
@@ -966,6 +979,61 @@ uint64_t FileFormatJP2Compress::compress(grk_plugin_tile* tile)
 
   return rc;
 }
+bool FileFormatJP2Compress::initCrop(const grk_cparameters* parameters)
+{
+  // the source tile grid
+  grk_stream_params streamParams = transcode_src_;
+  grk_decompress_parameters dparams{};
+  auto* decCodec = grk_decompress_init(&streamParams, &dparams);
+  if(!decCodec)
+  {
+    grklog.error("transcode: failed to init decompressor for crop");
+    return false;
+  }
+  grk_header_info hdr{};
+  bool rc = grk_decompress_read_header(decCodec, &hdr);
+  grk_object_unref(decCodec);
+  if(!rc || !hdr.t_width || !hdr.t_height)
+  {
+    grklog.error("transcode: failed to read header for crop");
+    return false;
+  }
+
+  // crop region in image coordinates, clipped to the image
+  auto image = inputImage_;
+  uint32_t x0 = image->x0 + std::min(parameters->transcode_crop_x0, image->x1 - image->x0);
+  uint32_t y0 = image->y0 + std::min(parameters->transcode_crop_y0, image->y1 - image->y0);
+  uint32_t x1 = image->x0 + std::min(parameters->transcode_crop_x1, image->x1 - image->x0);
+  uint32_t y1 = image->y0 + std::min(parameters->transcode_crop_y1, image->y1 - image->y0);
+  if(x0 >= x1 || y0 >= y1)
+  {
+    grklog.error("transcode: crop region (%u,%u,%u,%u) does not intersect the image",
+                 parameters->transcode_crop_x0, parameters->transcode_crop_y0,
+                 parameters->transcode_crop_x1, parameters->transcode_crop_y1);
+    return false;
+  }
+
+  // every tile the region touches is kept whole, so its code stream is unchanged
+  cropTiles_ = Rect32((x0 - hdr.tx0) / hdr.t_width, (y0 - hdr.ty0) / hdr.t_height,
+                      ceildiv<uint32_t>(x1 - hdr.tx0, hdr.t_width),
+                      ceildiv<uint32_t>(y1 - hdr.ty0, hdr.t_height));
+  cropTiles_.x1 = std::min<uint32_t>(cropTiles_.x1, hdr.t_grid_width);
+  cropTiles_.y1 = std::min<uint32_t>(cropTiles_.y1, hdr.t_grid_height);
+  cropCanvas_ =
+      Rect32(std::max(image->x0, hdr.tx0 + cropTiles_.x0 * hdr.t_width),
+             std::max(image->y0, hdr.ty0 + cropTiles_.y0 * hdr.t_height),
+             (uint32_t)std::min<uint64_t>(image->x1,
+                                          hdr.tx0 + (uint64_t)cropTiles_.x1 * hdr.t_width),
+             (uint32_t)std::min<uint64_t>(image->y1,
+                                          hdr.ty0 + (uint64_t)cropTiles_.y1 * hdr.t_height));
+  srcTileGridWidth_ = hdr.t_grid_width;
+  grklog.info("transcode: crop keeps %u x %u of %u x %u tiles, %u x %u samples",
+              cropTiles_.x1 - cropTiles_.x0, cropTiles_.y1 - cropTiles_.y0, hdr.t_grid_width,
+              hdr.t_grid_height, cropCanvas_.x1 - cropCanvas_.x0, cropCanvas_.y1 - cropCanvas_.y0);
+
+  return true;
+}
+
 uint64_t FileFormatJP2Compress::transcode(IStream* srcStream)
 {
   if(!srcStream)
@@ -1035,7 +1103,8 @@ uint64_t FileFormatJP2Compress::transcode(IStream* srcStream)
      through to the verbatim copy path and have no effect. */
   bool needMarkerPatching = write_tlm_transcode_ || write_plt_transcode_ || write_sop_transcode_ ||
                             write_eph_transcode_ || max_layers_transcode_ > 0 ||
-                            max_res_transcode_ > 0 || transcode_prog_order_ != GRK_PROG_UNKNOWN;
+                            max_res_transcode_ > 0 || transcode_prog_order_ != GRK_PROG_UNKNOWN ||
+                            crop_transcode_;
   if(needMarkerPatching)
   {
     totalWritten = transcodeCodestream(srcStream, jp2cDataOffset, jp2cDataLength);
@@ -1142,6 +1211,13 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
       return 0;
     }
 
+    // packed packet headers of all tiles can't be split between kept and dropped tiles
+    if(crop_transcode_ && marker == PPM)
+    {
+      grklog.error("transcode: crop is not supported for code streams with PPM markers");
+      return 0;
+    }
+
     MainHeaderMarker mhm;
     mhm.offset = pos;
     mhm.type = marker;
@@ -1168,6 +1244,7 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
   struct TilePartInfo
   {
     uint16_t tileIndex;
+    uint16_t newTileIndex; // index in the output tile grid
     uint32_t length; // byte length from SOT to end of tile-part data
     uint64_t srcOffset; // absolute position of SOT in source
     bool psotWasZero;
@@ -1207,6 +1284,7 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
 
     TilePartInfo tp;
     tp.tileIndex = Isot;
+    tp.newTileIndex = Isot;
     tp.srcOffset = sotPos;
     tp.psotWasZero = (Psot == 0);
 
@@ -1247,7 +1325,19 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
         srcStream->skip(sl - 2);
     }
 
-    tileParts.push_back(tp);
+    // crop: keep only tile parts of kept tiles, renumbered in the output tile grid
+    bool keep = true;
+    if(crop_transcode_)
+    {
+      uint32_t tx = tp.tileIndex % srcTileGridWidth_;
+      uint32_t ty = tp.tileIndex / srcTileGridWidth_;
+      keep = tx >= cropTiles_.x0 && tx < cropTiles_.x1 && ty >= cropTiles_.y0 &&
+             ty < cropTiles_.y1;
+      tp.newTileIndex = (uint16_t)((ty - cropTiles_.y0) * (cropTiles_.x1 - cropTiles_.x0) +
+                                   (tx - cropTiles_.x0));
+    }
+    if(keep)
+      tileParts.push_back(tp);
     if(Psot == 0)
       break;
     srcStream->seek(sotPos + Psot);
@@ -1287,6 +1377,14 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
     // Decompress the source file (T2 only) to record packet info
     grk_stream_params decStreamParams = transcode_src_;
     grk_decompress_parameters dparams{};
+    // crop: only the kept tiles are parsed
+    if(crop_transcode_)
+    {
+      dparams.dw_x0 = cropCanvas_.x0 - inputImage_->x0;
+      dparams.dw_y0 = cropCanvas_.y0 - inputImage_->y0;
+      dparams.dw_x1 = cropCanvas_.x1 - inputImage_->x0;
+      dparams.dw_y1 = cropCanvas_.y1 - inputImage_->y0;
+    }
     auto* decCodec = grk_decompress_init(&decStreamParams, &dparams);
     if(!decCodec)
     {
@@ -1525,6 +1623,9 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
   {
     if(mhm.type == TLM)
       continue;
+    // packet lengths of dropped tiles would remain in PLM, and PLM is optional
+    if(crop_transcode_ && mhm.type == PLM)
+      continue;
 
     uint32_t markerTotalLen = 2 + mhm.segLen;
     srcStream->seek(mhm.offset);
@@ -1574,6 +1675,32 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
       }
     }
 
+    // Patch SIZ marker: crop to the kept tiles, which stay at their canvas positions
+    // SIZ layout: marker(2) + Lsiz(2) + Rsiz(2) + Xsiz(4) + Ysiz(4)
+    //             + XOsiz(4) + YOsiz(4) + XTsiz(4) + YTsiz(4) + XTOsiz(4) + YTOsiz(4) + ...
+    if(mhm.type == SIZ && crop_transcode_ && markerTotalLen >= 42)
+    {
+      auto readBE32 = [](const uint8_t* p) -> uint32_t {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+      };
+      auto writeBE32 = [](uint8_t* p, uint32_t v) {
+        p[0] = (uint8_t)(v >> 24);
+        p[1] = (uint8_t)(v >> 16);
+        p[2] = (uint8_t)(v >> 8);
+        p[3] = (uint8_t)v;
+      };
+      uint32_t XTsiz = readBE32(buf + 22);
+      uint32_t YTsiz = readBE32(buf + 26);
+      uint32_t XTOsiz = readBE32(buf + 30);
+      uint32_t YTOsiz = readBE32(buf + 34);
+      writeBE32(buf + 6, cropCanvas_.x1);
+      writeBE32(buf + 10, cropCanvas_.y1);
+      writeBE32(buf + 14, cropCanvas_.x0);
+      writeBE32(buf + 18, cropCanvas_.y0);
+      writeBE32(buf + 30, XTOsiz + cropTiles_.x0 * XTsiz);
+      writeBE32(buf + 34, YTOsiz + cropTiles_.y0 * YTsiz);
+    }
+
     // Patch SIZ marker: image dimensions if resolution stripping
     // SIZ layout: marker(2) + Lsiz(2) + Rsiz(2) + Xsiz(4) + Ysiz(4)
     //             + XOsiz(4) + YOsiz(4) + XTsiz(4) + YTsiz(4) + XTOsiz(4) + YTOsiz(4) + ...
@@ -1665,7 +1792,7 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
 
     for(uint32_t i = 0; i < numTileParts; ++i)
     {
-      if(!dstStream->write(tileParts[i].tileIndex))
+      if(!dstStream->write(tileParts[i].newTileIndex))
         return 0;
       totalWritten += 2;
       if(!dstStream->write(adjustedLengths[i]))
@@ -1688,7 +1815,9 @@ uint64_t FileFormatJP2Compress::transcodeCodestream(IStream* srcStream, uint64_t
       grklog.error("transcode: failed to read SOT header");
       return 0;
     }
-    // Overwrite Psot with adjusted length
+    // Overwrite Isot with the output tile index, and Psot with adjusted length
+    sotHeader[4] = (uint8_t)(tp.newTileIndex >> 8);
+    sotHeader[5] = (uint8_t)(tp.newTileIndex);
     uint32_t newPsot = adjustedLengths[tpIdx];
     sotHeader[6] = (uint8_t)(newPsot >> 24);
     sotHeader[7] = (uint8_t)(newPsot >> 16);
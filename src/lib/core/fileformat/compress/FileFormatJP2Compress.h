@@ -31,6 +31,7 @@ public:
 
   /* Transcode: write JP2 boxes then copy raw codestream from source */
   uint64_t transcode(IStream* srcStream);
+  CodingParams* getCodingParams(void);
 
 protected:
   GrkImage* getHeaderImage(void) override;
@@ -84,6 +85,13 @@ private:
   uint8_t max_res_transcode_ = 0;
   GRK_PROG_ORDER transcode_prog_order_ = GRK_PROG_UNKNOWN;
   grk_stream_params transcode_src_{};
+  /* transcode crop: the source tiles kept, as a range of tile grid columns and rows,
+   * and the canvas area they cover, which becomes the output image */
+  bool crop_transcode_ = false;
+  Rect32 cropTiles_;
+  Rect32 cropCanvas_;
+  uint16_t srcTileGridWidth_ = 0;
+  bool initCrop(const grk_cparameters* parameters);
   uint64_t transcodeCodestream(IStream* srcStream, uint64_t csStart, uint64_t csLength);
 };
 
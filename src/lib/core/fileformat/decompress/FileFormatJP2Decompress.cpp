@@ -284,6 +284,30 @@ void FileFormatJP2Decompress::setBandCallback(grk_io_band_callback callback, voi
 {
   codeStream->setBandCallback(callback, user_data);
 }
+bool FileFormatJP2Decompress::getCodeblockCacheStats(grk_codeblock_cache_stats* stats)
+{
+  return codeStream->getCodeblockCacheStats(stats);
+}
+bool FileFormatJP2Decompress::getMemoryBudgetStats(grk_memory_budget_stats* stats)
+{
+  return codeStream->getMemoryBudgetStats(stats);
+}
+bool FileFormatJP2Decompress::setFocus(uint32_t x, uint32_t y)
+{
+  return codeStream->setFocus(x, y);
+}
+bool FileFormatJP2Decompress::setTilePriority(uint16_t tile_index, uint32_t priority)
+{
+  return codeStream->setTilePriority(tile_index, priority);
+}
+GrkImage* FileFormatJP2Decompress::getPyramidImage(uint8_t reduction)
+{
+  return codeStream->getPyramidImage(reduction);
+}
+GrkImage* FileFormatJP2Decompress::getScaledImage(void)
+{
+  return codeStream->getScaledImage();
+}
 
 bool FileFormatJP2Decompress::read_xml(uint8_t* p_xml_data, uint32_t xml_size)
 {
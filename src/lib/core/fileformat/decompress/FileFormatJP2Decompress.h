@@ -65,6 +65,12 @@ public:
   void scheduleSwathCopy(const grk_wait_swath* swath, grk_swath_buffer* buf) override;
   void waitSwathCopy() override;
   void setBandCallback(grk_io_band_callback callback, void* user_data) override;
+  bool getCodeblockCacheStats(grk_codeblock_cache_stats* stats) override;
+  bool getMemoryBudgetStats(grk_memory_budget_stats* stats) override;
+  bool setFocus(uint32_t x, uint32_t y) override;
+  bool setTilePriority(uint16_t tile_index, uint32_t priority) override;
+  GrkImage* getPyramidImage(uint8_t reduction) override;
+  GrkImage* getScaledImage(void) override;
   CodingParams* getCodingParams(void);
 
 private:
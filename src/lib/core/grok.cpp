@@ -127,6 +127,7 @@ struct ITileProcessorCompress;
 #include "TileCache.h"
 #include "TileCompletion.h"
 #include "CodeStreamDecompress.h"
+#include "CodeblockTranscoder.h"
 
 using namespace grk;
 
@@ -770,6 +771,38 @@ bool grk_decompress_tile(grk_object* codecWrapper, uint16_t tile_index)
   auto f = codec->queueDecompressTile(tile_index);
   return f.get();
 }
+bool grk_decompress_get_codeblock_cache_stats(grk_object* codecWrapper,
+                                              grk_codeblock_cache_stats* stats)
+{
+  if(!codecWrapper || !stats)
+    return false;
+  auto codec = Codec::getImpl(codecWrapper);
+  return codec->decompressor_ ? codec->decompressor_->getCodeblockCacheStats(stats) : false;
+}
+bool grk_decompress_get_memory_budget_stats(grk_object* codecWrapper,
+                                            grk_memory_budget_stats* stats)
+{
+  if(!codecWrapper || !stats)
+    return false;
+  auto codec = Codec::getImpl(codecWrapper);
+  return codec->decompressor_ ? codec->decompressor_->getMemoryBudgetStats(stats) : false;
+}
+bool grk_decompress_set_focus(grk_object* codecWrapper, uint32_t x, uint32_t y)
+{
+  if(!codecWrapper)
+    return false;
+  auto codec = Codec::getImpl(codecWrapper);
+  return codec->decompressor_ ? codec->decompressor_->setFocus(x, y) : false;
+}
+bool grk_decompress_set_tile_priority(grk_object* codecWrapper, uint16_t tile_index,
+                                      uint32_t priority)
+{
+  if(!codecWrapper)
+    return false;
+  auto codec = Codec::getImpl(codecWrapper);
+  return codec->decompressor_ ? codec->decompressor_->setTilePriority(tile_index, priority)
+                              : false;
+}
 uint32_t grk_decompress_num_samples(grk_object* codecWrapper)
 {
   if(codecWrapper)
@@ -868,6 +901,26 @@ grk_image* grk_decompress_get_image(grk_object* codecWrapper)
   return nullptr;
 }
 
+grk_image* grk_decompress_get_pyramid_image(grk_object* codecWrapper, uint8_t reduction)
+{
+  if(codecWrapper)
+  {
+    auto codec = Codec::getImpl(codecWrapper);
+    return codec->decompressor_ ? codec->decompressor_->getPyramidImage(reduction) : nullptr;
+  }
+  return nullptr;
+}
+
+grk_image* grk_decompress_get_scaled_image(grk_object* codecWrapper)
+{
+  if(codecWrapper)
+  {
+    auto codec = Codec::getImpl(codecWrapper);
+    return codec->decompressor_ ? codec->decompressor_->getScaledImage() : nullptr;
+  }
+  return nullptr;
+}
+
 void grk_decompress_set_band_callback(grk_object* codecWrapper, grk_io_band_callback callback,
                                       void* user_data)
 {
@@ -952,6 +1005,12 @@ void grk_compress_set_default_params(grk_cparameters* parameters)
   parameters->max_layers_transcode = 0;
   parameters->max_res_transcode = 0;
   parameters->transcode_prog_order = GRK_PROG_UNKNOWN;
+  parameters->transcode_ht = false;
+  parameters->transcode_target_size = 0;
+  parameters->transcode_crop_x0 = 0;
+  parameters->transcode_crop_y0 = 0;
+  parameters->transcode_crop_x1 = 0;
+  parameters->transcode_crop_y1 = 0;
   parameters->device_id = 0;
   parameters->repeats = 1;
 }
@@ -1059,6 +1118,65 @@ uint64_t grk_compress_get_compressed_length(grk_object* codecWrapper)
   return 0;
 }
 
+/**
+ * @brief Code block transcode for grk_transcode: the source's code blocks are compressed
+ * again with the HT block coder, or truncated to a target size, with no DWT or MCT in
+ * either direction
+ */
+static uint64_t transcodeCodeblocks(grk_stream_params* srcStream, grk_stream_params* dstStream,
+                                    grk_cparameters* parameters, grk_image* image,
+                                    CodeblockTranscoder::Mode mode)
+{
+  const char* label = mode == CodeblockTranscoder::Mode::HT ? "HT recode" : "truncation";
+  if(parameters->max_res_transcode)
+  {
+    grklog.error("grk_transcode: %s cannot drop resolutions", label);
+    return 0;
+  }
+  CodeblockTranscoder transcoder(mode);
+  if(!transcoder.decompress(srcStream, parameters))
+    return 0;
+  parameters->cod_format = GRK_FMT_JP2;
+  parameters->transcode = false;
+
+  dstStream->is_read_stream = false;
+  StreamGenerator dstSg(dstStream);
+  grk::IStream* outStream = nullptr;
+  try
+  {
+    outStream = dstSg.create();
+  }
+  catch(const std::exception& e)
+  {
+    grklog.error("grk_transcode: failed to create destination stream: %s", e.what());
+    return 0;
+  }
+  if(!outStream)
+  {
+    grklog.error("grk_transcode: failed to create destination stream");
+    return 0;
+  }
+  grk_object* codecWrapper = grk_compress_create(GRK_CODEC_JP2, outStream);
+  if(!codecWrapper)
+  {
+    grklog.error("grk_transcode: failed to create codec");
+    delete outStream;
+    return 0;
+  }
+  auto compressor = dynamic_cast<FileFormatJP2Compress*>(Codec::getImpl(codecWrapper)->compressor_);
+  uint64_t bytesWritten = 0;
+  if(compressor && compressor->init(parameters, (GrkImage*)image) &&
+     transcoder.attach(compressor->getCodingParams(), image->numcomps) && compressor->start())
+    bytesWritten = compressor->compress(nullptr);
+  grk_object_unref(codecWrapper);
+  if(transcoder.failed())
+    bytesWritten = 0;
+  if(!bytesWritten)
+    grklog.error("grk_transcode: %s failed", label);
+
+  return bytesWritten;
+}
+
 uint64_t grk_transcode(grk_stream_params* srcStream, grk_stream_params* dstStream,
                        grk_cparameters* parameters, grk_image* image)
 {
@@ -1070,6 +1188,25 @@ uint64_t grk_transcode(grk_stream_params* srcStream, grk_stream_params* dstStrea
 
   grk_initialize(nullptr, UINT32_MAX, nullptr);
 
+  if(parameters->transcode_ht && parameters->transcode_target_size)
+  {
+    grklog.error("grk_transcode: HT recode and truncation to a target size can't be combined");
+    return 0;
+  }
+  if((parameters->transcode_ht || parameters->transcode_target_size) &&
+     (parameters->transcode_crop_x1 > parameters->transcode_crop_x0 ||
+      parameters->transcode_crop_y1 > parameters->transcode_crop_y0))
+  {
+    grklog.error("grk_transcode: crop can't be combined with code block transcoding");
+    return 0;
+  }
+  if(parameters->transcode_ht)
+    return transcodeCodeblocks(srcStream, dstStream, parameters, image,
+                               CodeblockTranscoder::Mode::HT);
+  if(parameters->transcode_target_size)
+    return transcodeCodeblocks(srcStream, dstStream, parameters, image,
+                               CodeblockTranscoder::Mode::Truncate);
+
   /* Force JP2 format and transcode mode */
   parameters->cod_format = GRK_FMT_JP2;
   parameters->transcode = true;
@@ -748,6 +748,99 @@ typedef struct _grk_decompress_core_params
    */
   uint16_t* comps_to_decode;
   uint16_t num_comps_to_decode;
+  /**
+   * Byte budget for the decoded code block cache (0 = disabled).
+   * When set, the raw T1 output of every decoded code block is kept in an LRU cache
+   * keyed by (tile, component, resolution, band, code block, layers), so a later
+   * decode window that overlaps an earlier one only runs T1 on newly exposed code
+   * blocks. Can be changed with grk_decompress_update(); see
+   * grk_decompress_get_codeblock_cache_stats(). Ignored with GRK_TILE_CACHE_ALL,
+   * which already keeps every tile's decoded data.
+   */
+  uint64_t codeblock_cache_bytes;
+  /**
+   * Number of tiles to read ahead of the decoder for local files (0 = disabled).
+   * A dedicated I/O thread reads the tile parts of the next tiles, using the
+   * ranges from TLM markers, while the current tile decodes; without TLM it pulls
+   * the bytes past the parser into the page cache instead. Helps on cold caches
+   * and network file systems. Ignored for network streams, memory buffers,
+   * GRK_TILE_CACHE_ALL and GRK_TILE_CACHE_LRU.
+   */
+  uint16_t read_ahead_tiles;
+  /**
+   * Caller-provided typed output buffer (NULL = disabled), see @ref grk_swath_buffer.
+   * When set, each tile is clamped and stored straight into this buffer, in its
+   * sample type and pixel/line/band spacing, as soon as the tile's inverse MCT and
+   * DC level shift finish, so interleaved RGBA8 or RGB16 output needs no int32
+   * composite and no repacking pass. skip_allocate_composite is implied, so the
+   * image from grk_decompress_get_image() carries no pixels.
+   * x0/y0/x1/y1 give the region the buffer covers in output (reduced) image
+   * coordinates; if empty, the decompress window is used.
+   * Samples are the raw decoded values: colour conversion, ICC, palette,
+   * upsampling and precision options are not applied, and components must not
+   * be sub-sampled. Not supported together with a band callback.
+   * Memory is owned by the caller and must stay valid until decompression completes.
+   */
+  struct grk_swath_buffer* output_buffer;
+  /**
+   * Precision in bits the caller will reduce decoded samples to (0 = full precision),
+   * e.g. 8 for an 8-bit preview of a 16-bit image.
+   * Code blocks then stop decoding at the bit plane below which, after dequantization
+   * and the inverse wavelet's gain, the skipped planes of all sub-bands together can
+   * move a sample by less than one step at this precision, so a sample converted to
+   * this precision differs from one converted from a full decode by at most one code.
+   * Only applies to components of higher precision, and is ignored with
+   * GRK_TILE_CACHE_ALL, region of interest shifts and Part-2 transforms.
+   */
+  uint8_t target_precision;
+  /**
+   * Bit mask of overview reductions to emit from the same decompress (0 = none):
+   * bit k asks for the image at 1/2^k of full resolution, with the samples a
+   * decompress at reduce = k would produce. The inverse wavelet passes through every
+   * lower resolution on its way up, so each requested level is copied out of a tile as
+   * the synthesis goes by, then gets the inverse MCT and DC level shift; no resolution
+   * is entropy decoded twice. Retrieve the levels with grk_decompress_get_pyramid_image().
+   * Reductions at or below reduce, or beyond a tile's decomposition levels, are skipped.
+   * Samples are raw decoded values, as for output_buffer. Ignored with a decompress
+   * window, Part-2 transforms and custom MCT.
+   */
+  uint32_t pyramid_reductions;
+  /**
+   * Byte budget for the codec's decompression working set (0 = unlimited).
+   * Each tile is charged an estimate of its decoded coefficients and tile image when it
+   * is scheduled, and keeps a charge for whatever the tile cache holds of it afterwards.
+   * Near the budget, the coefficients of least recently used cached tiles are evicted
+   * as with max_active_tiles, and then fewer tiles are started until running ones
+   * finish; decompression is never failed for lack of budget. Charges also count
+   * against the process-wide budget set by the GRK_MEMORY_BUDGET environment variable.
+   * Can be changed with grk_decompress_update(); see grk_decompress_get_memory_budget_stats()
+   * for the high-water mark.
+   */
+  uint64_t memory_budget_bytes;
+  /**
+   * Number of components to decompress together (0 = all), for images with many
+   * components such as hyperspectral bands. Each tile's components then go through
+   * T1 and the inverse wavelet a group at a time, and a group's code blocks, coders
+   * and wavelet scratch are released before the next group starts, so the working
+   * set is bounded by the group size rather than the number of bands. A custom
+   * (Part-2) MCT is applied in row strips once every group of the tile is done.
+   * Ignored with GRK_TILE_CACHE_ALL.
+   */
+  uint16_t component_group_size;
+  /**
+   * Size of a scaled decompress (0 = disabled): the decompress window, or the whole image,
+   * is delivered at scaled_width x scaled_height, any size rather than full resolution
+   * divided by a power of two. The codec picks the smallest resolution at least that
+   * large, overriding reduce, and resamples each tile with an area averaging filter
+   * straight into the scaled image as soon as the tile's inverse MCT and DC level shift
+   * finish, so there is no full size composite and no separate resampling pass. Retrieve
+   * it with grk_decompress_get_scaled_image(). skip_allocate_composite is implied.
+   * Sub-sampled components are scaled to scaled_width / dx by scaled_height / dy.
+   * Samples are raw decoded values, as for output_buffer. A window must be given in
+   * full resolution coordinates: scaling is ignored with dw_reduced.
+   */
+  uint32_t scaled_width;
+  uint32_t scaled_height;
 } grk_decompress_core_params;
 
 /**
@@ -799,6 +892,9 @@ typedef struct _grk_decompress_params
   bool io_xml; /* serialize XML metedata to disk*/
   uint32_t compression; /* compression */
   uint32_t compression_level; /* compression "quality" - meaning depends on output file format */
+  uint32_t output_tile_width; /* tile width for output formats that store tiles (TIFF);
+                                 0 => strips */
+  uint32_t output_tile_height; /* tile height for output formats that store tiles (TIFF) */
   uint32_t duration; /* duration of decompression in seconds */
   uint32_t repeats; /* number of repetitions */
   uint32_t num_threads; /* number of threads. 1 => the codec decompresses on its own
@@ -1121,6 +1217,34 @@ typedef struct grk_wait_swath
   uint16_t tile_y1; /**< Output: Global tile row end (exclusive) */
   uint16_t num_tile_cols; /**< Output: Total tile columns in the image tile grid */
 } grk_wait_swath;
+
+/**
+ * @struct grk_codeblock_cache_stats
+ * @brief Counters for the decoded code block cache
+ * (see grk_decompress_core_params::codeblock_cache_bytes)
+ */
+typedef struct _grk_codeblock_cache_stats
+{
+  uint64_t hits; /**< code blocks replayed from the cache instead of decoded */
+  uint64_t misses; /**< code blocks decoded because they were not cached */
+  uint64_t bytes; /**< bytes currently held */
+  uint64_t entries; /**< code blocks currently held */
+  uint64_t max_bytes; /**< byte budget, 0 when the cache is disabled */
+} grk_codeblock_cache_stats;
+
+/**
+ * @struct grk_memory_budget_stats
+ * @brief Memory budget counters (see grk_decompress_core_params::memory_budget_bytes)
+ */
+typedef struct _grk_memory_budget_stats
+{
+  uint64_t limit; /**< codec byte budget, 0 when unlimited */
+  uint64_t bytes; /**< bytes currently charged to the codec */
+  uint64_t high_water; /**< most bytes ever charged to the codec at once */
+  uint64_t process_limit; /**< process-wide byte budget, 0 when unlimited */
+  uint64_t process_bytes; /**< bytes currently charged by all codecs */
+  uint64_t process_high_water; /**< most bytes ever charged by all codecs at once */
+} grk_memory_budget_stats;
 /**
  * @struct grk_plugin_pass
  * @brief Plugin pass
@@ -1530,6 +1654,33 @@ GRK_API bool GRK_CALLCONV grk_decompress_read_header(grk_object* codec,
 GRK_API grk_image* GRK_CALLCONV grk_decompress_get_tile_image(grk_object* codec,
                                                               uint16_t tile_index, bool wait);
 
+/**
+ * @brief Gets an overview level emitted by the last decompress.
+ *
+ * Levels are requested with grk_decompress_core_params::pyramid_reductions and
+ * filled tile by tile during grk_decompress() or grk_decompress_tile().
+ *
+ * @param codec      decompression codec (see @ref grk_object)
+ * @param reduction  number of discarded resolution levels: the level is the image
+ *                   at 1/2^reduction of full resolution
+ * @return @ref grk_image owned by the codec, or NULL if that level was not requested
+ *         or could not be produced
+ */
+GRK_API grk_image* GRK_CALLCONV grk_decompress_get_pyramid_image(grk_object* codec,
+                                                                uint8_t reduction);
+
+/**
+ * @brief Gets the scaled image of the last decompress.
+ *
+ * The size is requested with grk_decompress_core_params::scaled_width and
+ * grk_decompress_core_params::scaled_height, and the image is filled tile by tile
+ * during grk_decompress().
+ *
+ * @param codec decompression codec (see @ref grk_object)
+ * @return @ref grk_image owned by the codec, or NULL if no scaled size was requested
+ */
+GRK_API grk_image* GRK_CALLCONV grk_decompress_get_scaled_image(grk_object* codec);
+
 /**
  * @brief Gets the composite decompressed image.
  *
@@ -1674,6 +1825,65 @@ GRK_API void GRK_CALLCONV grk_copy_tile_to_swath(const grk_image* tile_img,
  */
 GRK_API bool GRK_CALLCONV grk_decompress_tile(grk_object* codec, uint16_t tile_index);
 
+/**
+ * @brief Gets decoded code block cache counters.
+ *
+ * Counters accumulate over the codec's lifetime, across grk_decompress_update()
+ * window changes. Enable the cache by setting
+ * grk_decompress_core_params::codeblock_cache_bytes.
+ *
+ * @param codec  decompression codec (see @ref grk_object)
+ * @param stats  receives the counters (see @ref grk_codeblock_cache_stats)
+ * @return true if successful, false if the codec does not support the cache
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_get_codeblock_cache_stats(
+    grk_object* codec, grk_codeblock_cache_stats* stats);
+
+/**
+ * @brief Gets memory budget counters, including the high-water mark.
+ *
+ * Bytes are charged whether or not a budget is set, so the high-water mark
+ * can be used to size grk_decompress_core_params::memory_budget_bytes.
+ *
+ * @param codec  decompression codec (see @ref grk_object)
+ * @param stats  receives the counters (see @ref grk_memory_budget_stats)
+ * @return true if successful, false if the codec does not support a budget
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_get_memory_budget_stats(grk_object* codec,
+                                                                 grk_memory_budget_stats* stats);
+
+/**
+ * @brief Schedules the tiles nearest a point first.
+ *
+ * Tiles are ranked by the distance of their centre from (x, y), so a viewer can have the
+ * tiles under its viewport decoded before the rest. Tiles with a priority set by
+ * grk_decompress_set_tile_priority() still come first. May be called before
+ * grk_decompress(), and again while an asynchronous decompress runs, as the user pans:
+ * tiles that have not started yet are reordered. Applies to codestreams with TLM
+ * markers; with swaths, it orders the tiles within each scheduled row batch.
+ *
+ * @param codec  decompression codec (see @ref grk_object)
+ * @param x      reference grid x
+ * @param y      reference grid y
+ * @return true if successful
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_set_focus(grk_object* codec, uint32_t x, uint32_t y);
+
+/**
+ * @brief Sets a tile's scheduling priority.
+ *
+ * Tiles with a priority are scheduled before all others, lowest value first. Like
+ * grk_decompress_set_focus(), this may be called while a decompress runs.
+ *
+ * @param codec      decompression codec (see @ref grk_object)
+ * @param tile_index tile index
+ * @param priority   priority: lower values are scheduled sooner
+ * @return true if successful
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_set_tile_priority(grk_object* codec,
+                                                           uint16_t tile_index,
+                                                           uint32_t priority);
+
 /**
  * @brief Gets the number of samples (frames) in the codec container.
  * For single-image formats (JP2, J2K) this returns 1.
@@ -1716,6 +1926,30 @@ GRK_API grk_image* GRK_CALLCONV grk_decompress_get_sample_tile_image(grk_object*
 
 /* COMPRESSION FUNCTIONS*/
 
+/**
+ * @struct grk_pixel_source
+ * @brief Uncompressed samples read straight from a memory-mapped file
+ *
+ * When @p file is set, the compressor maps the file read-only and fills each
+ * tile buffer directly from the mapping on the worker that compresses the tile,
+ * so full-image component planes are never materialized. The image passed to
+ * grk_compress_init() then only describes the geometry: create it with
+ * alloc_data = false.
+ *
+ * Samples start at @p offset and are stored either pixel-interleaved
+ * (PNM layout: c0 c1 c2 c0 c1 c2 ...) or as consecutive component planes
+ * (RAW layout), with 1 or 2 bytes per sample and no row padding.
+ * All components must share width, height and signedness, with dx = dy = 1.
+ */
+typedef struct _grk_pixel_source
+{
+  char file[GRK_PATH_LEN]; /* file to map; empty string disables pixel source */
+  uint64_t offset; /* byte offset of first sample in file */
+  uint8_t bytes_per_sample; /* 1 or 2 */
+  bool big_endian; /* byte order of 2-byte samples */
+  bool interleaved; /* true: pixel-interleaved, false: planar */
+} grk_pixel_source;
+
 /**
  * @struct grk_cparameters
  * @brief Compression parameters
@@ -1846,6 +2080,28 @@ typedef struct _grk_cparameters
   uint8_t max_res_transcode; /* max resolutions to keep (0 = all) */
   GRK_PROG_ORDER
   transcode_prog_order; /* reorder packets to this progression (GRK_PROG_UNKNOWN = keep) */
+  /* HT recode: code the code blocks of a Part-1 source again with the HT block coder.
+   * Wavelet coefficients, quantization, tiling, code blocks and precincts are kept and
+   * no DWT or MCT runs, so a source whose code blocks end on a bit plane is transcoded
+   * losslessly. Quality layers are merged into one: max_layers_transcode limits the
+   * source layers decoded. max_res_transcode is not supported. */
+  bool transcode_ht;
+  /* Truncating transcode: when non-zero, rewrite a Part-1 source with no more than this
+   * many code stream bytes. Code block contributions are truncated by rate-distortion
+   * slope, estimated from their coded lengths and bit planes, and written to new packets
+   * in one quality layer; nothing is decoded or coded again. Truncation points are the
+   * source's layer and segment boundaries, so a multi-layer source truncates finely.
+   * Not supported with transcode_ht or max_res_transcode. */
+  uint64_t transcode_target_size;
+  /* Crop: when transcode_crop_x1 > transcode_crop_x0 and transcode_crop_y1 >
+   * transcode_crop_y0, keep only the tiles that intersect this region, given in image
+   * coordinates as for a decompress window. Kept tiles are copied whole, with no entropy
+   * decoding: SIZ is rewritten, tile parts are renumbered and TLM is regenerated, so the
+   * output covers the region rounded out to the tile grid. Not supported with PPM. */
+  uint32_t transcode_crop_x0;
+  uint32_t transcode_crop_y0;
+  uint32_t transcode_crop_x1;
+  uint32_t transcode_crop_y1;
 
   /**
    * Apply Rec.709 RGB → DCI X'Y'Z' colour transform on the input image
@@ -1856,6 +2112,13 @@ typedef struct _grk_cparameters
    * Only applied to images with ≥3 components.
    */
   bool apply_xyz_transform;
+
+  /**
+   * Optional memory-mapped sample source (see @ref grk_pixel_source).
+   * Mutually exclusive with apply_icc, apply_xyz_transform and 12-bit cinema reduction,
+   * which all need the whole image in memory.
+   */
+  grk_pixel_source pixel_source;
 } grk_cparameters;
 
 /**
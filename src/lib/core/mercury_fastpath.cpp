@@ -292,6 +292,18 @@ bool mercuryFastPath(CodeStreamDecompress& cs)
   // marker injection — it needs the classic parse, not pixels.
   if(cs.cp_.recordPacketLengths_)
     MFP_BAIL("packet-length recording (transcode) requested");
+  // The HT transcoder takes quantized coefficients from the classic T1.
+  if(cs.cp_.coefficientSink_)
+    MFP_BAIL("coefficient sink (HT transcode) set");
+  // The truncating transcoder takes code blocks as the classic T2 parses them.
+  if(cs.cp_.codeblockSink_)
+    MFP_BAIL("code block sink (truncating transcode) set");
+  // Overview levels are copied out of the classic inverse wavelet's task graph.
+  if(dec.pyramidReductions_)
+    MFP_BAIL("overview pyramid requested");
+  // Scaled output is resampled out of the classic pipeline's tile images.
+  if(dec.scaledWidth_ && dec.scaledHeight_)
+    MFP_BAIL("scaled output requested");
   // Async decode expects grk_decompress() to SCHEDULE work that later
   // grk_decompress_wait()/swath calls drain via the classic pipeline's
   // TileCompletion signalling. The fast path runs synchronously and never
@@ -15,7 +15,14 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <functional>
+#include <limits>
+#include <memory>
 
 #include "hwy_arm_disable_targets.h"
 
@@ -186,6 +193,56 @@ namespace HWY_NAMESPACE
     }
   };
 
+  /**
+   * Apply inverse RCT, with DC shift and clamp, to samples [begin, end) of three
+   * int32 components
+   */
+  void hwy_decompress_rev_rows(int32_t* const* chans, const ShiftInfo* shiftInfo, uint64_t begin,
+                               uint64_t end)
+  {
+    auto chan0 = chans[0];
+    auto chan1 = chans[1];
+    auto chan2 = chans[2];
+    int32_t shift[3] = {shiftInfo[0]._shift, shiftInfo[1]._shift, shiftInfo[2]._shift};
+    int32_t _min[3] = {shiftInfo[0]._min, shiftInfo[1]._min, shiftInfo[2]._min};
+    int32_t _max[3] = {shiftInfo[0]._max, shiftInfo[1]._max, shiftInfo[2]._max};
+
+    const HWY_FULL(int32_t) di;
+    auto vdcr = Set(di, shift[0]);
+    auto vdcg = Set(di, shift[1]);
+    auto vdcb = Set(di, shift[2]);
+    auto minr = Set(di, _min[0]);
+    auto ming = Set(di, _min[1]);
+    auto minb = Set(di, _min[2]);
+    auto maxr = Set(di, _max[0]);
+    auto maxg = Set(di, _max[1]);
+    auto maxb = Set(di, _max[2]);
+
+    const size_t N = Lanes(di);
+    uint64_t j = begin;
+    for(; j + N <= end; j += N)
+    {
+      auto y = LoadU(di, chan0 + j);
+      auto u = LoadU(di, chan1 + j);
+      auto v = LoadU(di, chan2 + j);
+      auto g = y - ShiftRight<2>(u + v);
+      auto r = v + g;
+      auto b = u + g;
+      StoreU(Clamp(r + vdcr, minr, maxr), di, chan0 + j);
+      StoreU(Clamp(g + vdcg, ming, maxg), di, chan1 + j);
+      StoreU(Clamp(b + vdcb, minb, maxb), di, chan2 + j);
+    }
+    for(; j < end; ++j)
+    {
+      int32_t g = chan0[j] - ((chan1[j] + chan2[j]) >> 2);
+      int32_t r = chan2[j] + g;
+      int32_t b = chan1[j] + g;
+      chan0[j] = std::clamp(r + shift[0], _min[0], _max[0]);
+      chan1[j] = std::clamp(g + shift[1], _min[1], _max[1]);
+      chan2[j] = std::clamp(b + shift[2], _min[2], _max[2]);
+    }
+  }
+
   /**
    * Apply MCT with optional DC shift to reversible decompressed image
    */
@@ -208,38 +265,8 @@ namespace HWY_NAMESPACE
           info.tile->comps_[info.compno].getWindow()->getResWindowBufferHighestStride();
       auto index = (uint64_t)info.yBegin * highestResBufferStride;
       auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * highestResBufferStride;
-      const std::vector<ShiftInfo>& shiftInfo = info.shiftInfo;
-      auto chan0 = w0.buf_;
-      auto chan1 = w1.buf_;
-      auto chan2 = w2.buf_;
-      int32_t shift[3] = {shiftInfo[0]._shift, shiftInfo[1]._shift, shiftInfo[2]._shift};
-      int32_t _min[3] = {shiftInfo[0]._min, shiftInfo[1]._min, shiftInfo[2]._min};
-      int32_t _max[3] = {shiftInfo[0]._max, shiftInfo[1]._max, shiftInfo[2]._max};
-
-      const HWY_FULL(int32_t) di;
-      auto vdcr = Set(di, shift[0]);
-      auto vdcg = Set(di, shift[1]);
-      auto vdcb = Set(di, shift[2]);
-      auto minr = Set(di, _min[0]);
-      auto ming = Set(di, _min[1]);
-      auto minb = Set(di, _min[2]);
-      auto maxr = Set(di, _max[0]);
-      auto maxg = Set(di, _max[1]);
-      auto maxb = Set(di, _max[2]);
-
-      size_t begin = index;
-      for(auto j = begin; j < begin + chunkSize; j += Lanes(di))
-      {
-        auto y = Load(di, chan0 + j);
-        auto u = Load(di, chan1 + j);
-        auto v = Load(di, chan2 + j);
-        auto g = y - ShiftRight<2>(u + v);
-        auto r = v + g;
-        auto b = u + g;
-        Store(Clamp(r + vdcr, minr, maxr), di, chan0 + j);
-        Store(Clamp(g + vdcg, ming, maxg), di, chan1 + j);
-        Store(Clamp(b + vdcb, minb, maxb), di, chan2 + j);
-      }
+      int32_t* chans[3] = {w0.buf_, w1.buf_, w2.buf_};
+      hwy_decompress_rev_rows(chans, info.shiftInfo.data(), index, index + chunkSize);
     }
   };
 
@@ -303,6 +330,70 @@ namespace HWY_NAMESPACE
     }
   };
 
+  /**
+   * Apply inverse ICT, with DC shift and clamp, to samples [begin, end) of three
+   * components: float in, int32 out, in place
+   */
+  void hwy_decompress_irrev_rows(int32_t* const* chans, const ShiftInfo* shiftInfo, uint64_t begin,
+                                 uint64_t end)
+  {
+    auto c0 = chans[0];
+    auto c1 = chans[1];
+    auto c2 = chans[2];
+    auto chan0 = (float*)c0;
+    auto chan1 = (float*)c1;
+    auto chan2 = (float*)c2;
+
+    const HWY_FULL(float) df;
+    const HWY_FULL(int32_t) di;
+
+    int32_t shift[3] = {shiftInfo[0]._shift, shiftInfo[1]._shift, shiftInfo[2]._shift};
+    int32_t _min[3] = {shiftInfo[0]._min, shiftInfo[1]._min, shiftInfo[2]._min};
+    int32_t _max[3] = {shiftInfo[0]._max, shiftInfo[1]._max, shiftInfo[2]._max};
+    auto vdcr = Set(di, shift[0]);
+    auto vdcg = Set(di, shift[1]);
+    auto vdcb = Set(di, shift[2]);
+    auto minr = Set(di, _min[0]);
+    auto ming = Set(di, _min[1]);
+    auto minb = Set(di, _min[2]);
+    auto maxr = Set(di, _max[0]);
+    auto maxg = Set(di, _max[1]);
+    auto maxb = Set(di, _max[2]);
+
+    auto vrv = Set(df, 1.402f);
+    auto vgu = Set(df, 0.34413f);
+    auto vgv = Set(df, 0.71414f);
+    auto vbu = Set(df, 1.772f);
+
+    const size_t N = Lanes(di);
+    uint64_t j = begin;
+    for(; j + N <= end; j += N)
+    {
+      auto vy = LoadU(df, chan0 + j);
+      auto vu = LoadU(df, chan1 + j);
+      auto vv = LoadU(df, chan2 + j);
+      auto vr = vy + vv * vrv;
+      auto vg = vy - vu * vgu - vv * vgv;
+      auto vb = vy + vu * vbu;
+
+      StoreU(Clamp(NearestInt(vr) + vdcr, minr, maxr), di, c0 + j);
+      StoreU(Clamp(NearestInt(vg) + vdcg, ming, maxg), di, c1 + j);
+      StoreU(Clamp(NearestInt(vb) + vdcb, minb, maxb), di, c2 + j);
+    }
+    for(; j < end; ++j)
+    {
+      float y = chan0[j];
+      float u = chan1[j];
+      float v = chan2[j];
+      auto r = (int32_t)std::lrintf(y + v * 1.402f);
+      auto g = (int32_t)std::lrintf(y - u * 0.34413f - v * 0.71414f);
+      auto b = (int32_t)std::lrintf(y + u * 1.772f);
+      c0[j] = std::clamp(r + shift[0], _min[0], _max[0]);
+      c1[j] = std::clamp(g + shift[1], _min[1], _max[1]);
+      c2[j] = std::clamp(b + shift[2], _min[2], _max[2]);
+    }
+  }
+
   /**
    * Apply MCT with optional DC shift to irreversible decompressed image
    */
@@ -311,9 +402,9 @@ namespace HWY_NAMESPACE
   public:
     void transform(const ScheduleInfo& info)
     {
-      auto w0 = info.tile->comps_[0].getWindow()->getResWindowBufferHighestSimpleF();
-      auto w1 = info.tile->comps_[1].getWindow()->getResWindowBufferHighestSimpleF();
-      auto w2 = info.tile->comps_[2].getWindow()->getResWindowBufferHighestSimpleF();
+      auto w0 = info.tile->comps_[0].getWindow()->getResWindowBufferHighestSimple();
+      auto w1 = info.tile->comps_[1].getWindow()->getResWindowBufferHighestSimple();
+      auto w2 = info.tile->comps_[2].getWindow()->getResWindowBufferHighestSimple();
 
       if(w0.stride_ != w1.stride_ || w1.stride_ != w2.stride_ || w0.height_ != w1.height_ ||
          w1.height_ != w2.height_)
@@ -325,50 +416,8 @@ namespace HWY_NAMESPACE
           info.tile->comps_[info.compno].getWindow()->getResWindowBufferHighestStride();
       auto index = (uint64_t)info.yBegin * highestResBufferStride;
       auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * highestResBufferStride;
-      const std::vector<ShiftInfo>& shiftInfo = info.shiftInfo;
-      auto chan0 = w0.buf_;
-      auto chan1 = w1.buf_;
-      auto chan2 = w2.buf_;
-
-      auto c0 = (int32_t*)chan0;
-      auto c1 = (int32_t*)chan1;
-      auto c2 = (int32_t*)chan2;
-
-      const HWY_FULL(float) df;
-      const HWY_FULL(int32_t) di;
-
-      int32_t shift[3] = {shiftInfo[0]._shift, shiftInfo[1]._shift, shiftInfo[2]._shift};
-      int32_t _min[3] = {shiftInfo[0]._min, shiftInfo[1]._min, shiftInfo[2]._min};
-      int32_t _max[3] = {shiftInfo[0]._max, shiftInfo[1]._max, shiftInfo[2]._max};
-      auto vdcr = Set(di, shift[0]);
-      auto vdcg = Set(di, shift[1]);
-      auto vdcb = Set(di, shift[2]);
-      auto minr = Set(di, _min[0]);
-      auto ming = Set(di, _min[1]);
-      auto minb = Set(di, _min[2]);
-      auto maxr = Set(di, _max[0]);
-      auto maxg = Set(di, _max[1]);
-      auto maxb = Set(di, _max[2]);
-
-      auto vrv = Set(df, 1.402f);
-      auto vgu = Set(df, 0.34413f);
-      auto vgv = Set(df, 0.71414f);
-      auto vbu = Set(df, 1.772f);
-
-      size_t begin = index;
-      for(auto j = begin; j < begin + chunkSize; j += Lanes(di))
-      {
-        auto vy = Load(df, chan0 + j);
-        auto vu = Load(df, chan1 + j);
-        auto vv = Load(df, chan2 + j);
-        auto vr = vy + vv * vrv;
-        auto vg = vy - vu * vgu - vv * vgv;
-        auto vb = vy + vu * vbu;
-
-        Store(Clamp(NearestInt(vr) + vdcr, minr, maxr), di, c0 + j);
-        Store(Clamp(NearestInt(vg) + vdcg, ming, maxg), di, c1 + j);
-        Store(Clamp(NearestInt(vb) + vdcb, minb, maxb), di, c2 + j);
-      }
+      int32_t* chans[3] = {w0.buf_, w1.buf_, w2.buf_};
+      hwy_decompress_irrev_rows(chans, info.shiftInfo.data(), index, index + chunkSize);
     }
   };
 
@@ -579,6 +628,203 @@ namespace HWY_NAMESPACE
     const float cr = 0.5f / (1.0f - a_r);
   };
 
+  // floats of one block of every component: the block stays in L1 while each output
+  // component is accumulated from all of them
+  constexpr size_t customBlockFloats = 8192;
+  constexpr size_t customMaxBlock = 1024;
+
+  /**
+   * Round, dc shift and clamp a vector of custom MCT outputs, and store its first
+   * count samples
+   */
+  template<class D, class V>
+  HWY_INLINE void storeCustom(D df, V acc, const ShiftInfo& shift, int32_t* dst, size_t count,
+                              int32_t* tail)
+  {
+    const RebindToSigned<D> di;
+    auto v =
+        Clamp(NearestInt(acc) + Set(di, shift._shift), Set(di, shift._min), Set(di, shift._max));
+    if(count >= Lanes(di))
+    {
+      StoreU(v, di, dst);
+    }
+    else if(count)
+    {
+      Store(v, di, tail);
+      memcpy(dst, tail, count * sizeof(int32_t));
+    }
+  }
+
+  /**
+   * Accumulate four output components over a gathered block, two vectors at a time
+   */
+  template<class D>
+  HWY_INLINE void customOutputs4(D df, const float* matrix, uint16_t numComps, uint16_t o,
+                                 const float* block, size_t blockLen, size_t padded, size_t len,
+                                 int32_t* const* out, const ShiftInfo* shiftInfo, int32_t* tail)
+  {
+    const size_t N = Lanes(df);
+    auto m0 = matrix + (size_t)o * numComps;
+    auto m1 = m0 + numComps;
+    auto m2 = m1 + numComps;
+    auto m3 = m2 + numComps;
+    for(size_t i = 0; i < padded; i += 2 * N)
+    {
+      auto a0 = Zero(df), b0 = Zero(df), a1 = Zero(df), b1 = Zero(df);
+      auto a2 = Zero(df), b2 = Zero(df), a3 = Zero(df), b3 = Zero(df);
+      auto in = block + i;
+      for(uint16_t k = 0; k < numComps; ++k, in += blockLen)
+      {
+        auto x = Load(df, in);
+        auto y = Load(df, in + N);
+        auto c = Set(df, m0[k]);
+        a0 = MulAdd(c, x, a0);
+        b0 = MulAdd(c, y, b0);
+        c = Set(df, m1[k]);
+        a1 = MulAdd(c, x, a1);
+        b1 = MulAdd(c, y, b1);
+        c = Set(df, m2[k]);
+        a2 = MulAdd(c, x, a2);
+        b2 = MulAdd(c, y, b2);
+        c = Set(df, m3[k]);
+        a3 = MulAdd(c, x, a3);
+        b3 = MulAdd(c, y, b3);
+      }
+      size_t lo = i < len ? len - i : 0;
+      size_t hi = i + N < len ? len - i - N : 0;
+      storeCustom(df, a0, shiftInfo[o], out[o] + i, lo, tail);
+      storeCustom(df, b0, shiftInfo[o], out[o] + i + N, hi, tail);
+      storeCustom(df, a1, shiftInfo[o + 1], out[o + 1] + i, lo, tail);
+      storeCustom(df, b1, shiftInfo[o + 1], out[o + 1] + i + N, hi, tail);
+      storeCustom(df, a2, shiftInfo[o + 2], out[o + 2] + i, lo, tail);
+      storeCustom(df, b2, shiftInfo[o + 2], out[o + 2] + i + N, hi, tail);
+      storeCustom(df, a3, shiftInfo[o + 3], out[o + 3] + i, lo, tail);
+      storeCustom(df, b3, shiftInfo[o + 3], out[o + 3] + i + N, hi, tail);
+    }
+  }
+
+  /**
+   * Accumulate one output component over a gathered block, two vectors at a time
+   */
+  template<class D>
+  HWY_INLINE void customOutputs1(D df, const float* matrix, uint16_t numComps, uint16_t o,
+                                 const float* block, size_t blockLen, size_t padded, size_t len,
+                                 int32_t* const* out, const ShiftInfo* shiftInfo, int32_t* tail)
+  {
+    const size_t N = Lanes(df);
+    auto m0 = matrix + (size_t)o * numComps;
+    for(size_t i = 0; i < padded; i += 2 * N)
+    {
+      auto a0 = Zero(df), b0 = Zero(df);
+      auto in = block + i;
+      for(uint16_t k = 0; k < numComps; ++k, in += blockLen)
+      {
+        auto c = Set(df, m0[k]);
+        a0 = MulAdd(c, Load(df, in), a0);
+        b0 = MulAdd(c, Load(df, in + N), b0);
+      }
+      size_t lo = i < len ? len - i : 0;
+      size_t hi = i + N < len ? len - i - N : 0;
+      storeCustom(df, a0, shiftInfo[o], out[o] + i, lo, tail);
+      storeCustom(df, b0, shiftInfo[o], out[o] + i + N, hi, tail);
+    }
+  }
+
+  /**
+   * Apply custom (Part 2) inverse MCT with DC shift to samples [begin, end) of every
+   * component.
+   *
+   * The samples are taken a block at a time, sized so that the block of every component
+   * fits in L1. A block is gathered into float scratch, reversible (int32) components
+   * converted on the way, and each output component is then accumulated from all
+   * inputs, GEMM style, four outputs by two vectors at a time. Outputs are rounded,
+   * shifted, clamped and stored in place as int32. Returns false if the scratch cannot
+   * be allocated, leaving the samples untouched.
+   */
+  bool hwy_decompress_custom_rows(const float* matrix, uint16_t numComps, void* const* chans,
+                                  const uint8_t* reversible, const ShiftInfo* shiftInfo,
+                                  uint64_t begin, uint64_t end)
+  {
+    const HWY_FULL(float) df;
+    const HWY_FULL(int32_t) di;
+    const size_t N = Lanes(df);
+    size_t blockLen = (customBlockFloats / numComps) / (2 * N) * (2 * N);
+    blockLen = std::clamp(blockLen, 2 * N, std::max(customMaxBlock, 2 * N));
+    auto scratch = (float*)grk_aligned_malloc(((size_t)numComps * blockLen + N) * sizeof(float));
+    if(!scratch)
+    {
+      grklog.error("Failed to allocate custom MCT scratch");
+      return false;
+    }
+    auto tail = (int32_t*)(scratch + (size_t)numComps * blockLen);
+    std::vector<int32_t*> out(numComps);
+    for(uint64_t j = begin; j < end; j += blockLen)
+    {
+      size_t len = (size_t)std::min<uint64_t>(blockLen, end - j);
+      // padded to whole vector pairs: the padding is accumulated but never stored
+      size_t padded = (len + 2 * N - 1) / (2 * N) * (2 * N);
+      for(uint16_t k = 0; k < numComps; ++k)
+      {
+        auto dst = scratch + (size_t)k * blockLen;
+        if(reversible[k])
+        {
+          auto src = (const int32_t*)chans[k] + j;
+          size_t i = 0;
+          for(; i + N <= len; i += N)
+            Store(ConvertTo(df, LoadU(di, src + i)), df, dst + i);
+          for(; i < len; ++i)
+            dst[i] = (float)src[i];
+        }
+        else
+        {
+          memcpy(dst, (const float*)chans[k] + j, len * sizeof(float));
+        }
+        std::fill(dst + len, dst + padded, 0.0f);
+        out[k] = (int32_t*)chans[k] + j;
+      }
+      uint16_t o = 0;
+      for(; o + 4 <= numComps; o += 4)
+        customOutputs4(df, matrix, numComps, o, scratch, blockLen, padded, len, out.data(),
+                       shiftInfo, tail);
+      for(; o < numComps; ++o)
+        customOutputs1(df, matrix, numComps, o, scratch, blockLen, padded, len, out.data(),
+                       shiftInfo, tail);
+    }
+    grk_aligned_free(scratch);
+
+    return true;
+  }
+
+  /**
+   * Apply custom (Part 2) MCT with DC shift to decompressed image, over all components
+   */
+  class DecompressCustom
+  {
+  public:
+    void transform(const ScheduleInfo& info)
+    {
+      uint16_t numComps = info.tile->numcomps_;
+      auto w0 = info.tile->comps_[0].getWindow()->getResWindowBufferHighestSimple();
+      std::vector<void*> chans(numComps);
+      for(uint16_t k = 0; k < numComps; ++k)
+      {
+        auto w = info.tile->comps_[k].getWindow()->getResWindowBufferHighestSimple();
+        if(w.stride_ != w0.stride_ || w.height_ != w0.height_)
+        {
+          grklog.warn("MCT components have differing dimensions - skipping MCT transform");
+          return;
+        }
+        chans[k] = w.buf_;
+      }
+      auto index = (uint64_t)info.yBegin * w0.stride_;
+      auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * w0.stride_;
+      if(!hwy_decompress_custom_rows(info.matrix, numComps, chans.data(), info.reversible.data(),
+                                     info.shiftInfo.data(), index, index + chunkSize) &&
+         info.success)
+        *info.success = false;
+    }
+  };
+
   template<class T>
   void vscheduler(ScheduleInfo info)
   {
@@ -633,6 +879,11 @@ namespace HWY_NAMESPACE
     vscheduler<DecompressIrrev>(info);
   }
 
+  void hwy_schedule_decompress_custom(ScheduleInfo info)
+  {
+    vscheduler<DecompressCustom>(info);
+  }
+
   void hwy_schedule_decompress_dc_shift_irrev(ScheduleInfo info)
   {
     vscheduler<DecompressDcShiftIrrev>(info);
@@ -708,6 +959,10 @@ HWY_EXPORT(hwy_compress_rev);
 HWY_EXPORT(hwy_compress_irrev);
 HWY_EXPORT(hwy_schedule_decompress_rev);
 HWY_EXPORT(hwy_schedule_decompress_irrev);
+HWY_EXPORT(hwy_schedule_decompress_custom);
+HWY_EXPORT(hwy_decompress_custom_rows);
+HWY_EXPORT(hwy_decompress_rev_rows);
+HWY_EXPORT(hwy_decompress_irrev_rows);
 HWY_EXPORT(hwy_schedule_decompress_dc_shift_irrev);
 HWY_EXPORT(hwy_schedule_decompress_dc_shift_irrev16);
 HWY_EXPORT(hwy_schedule_decompress_dc_shift_rev);
@@ -773,6 +1028,134 @@ void Mct::schedule_decompress_rev(FlowComponent* flow, bool applyDcShift)
   else
     HWY_DYNAMIC_DISPATCH(hwy_schedule_decompress_rev)(info);
 }
+/***
+ * inverse custom (Part 2) MCT (with dc shift), over all components
+ */
+void Mct::schedule_decompress_custom(FlowComponent* flow)
+{
+  ScheduleInfo info(tile_, flow, image_->rows_per_task);
+  info.matrix = tcp_->mctDecodingMatrix_;
+  info.success = &success_;
+  for(uint16_t i = 0; i < tile_->numcomps_; ++i)
+  {
+    genShift(i, 1, info.shiftInfo);
+    info.reversible.push_back((tcp_->tccps_ + i)->qmfbid_ == 1);
+  }
+  HWY_DYNAMIC_DISPATCH(hwy_schedule_decompress_custom)(info);
+}
+
+/***
+ * inverse custom (Part 2) MCT (with dc shift), over the tile's window of a composite image
+ */
+void Mct::schedule_decompress_custom(FlowComponent* flow, GrkImage* composite,
+                                     const std::vector<bool>& hasBlocks)
+{
+  struct Planes
+  {
+    std::vector<int32_t*> origins;
+    std::vector<uint32_t> strides;
+    std::vector<ShiftInfo> shiftInfo;
+    std::vector<uint8_t> reversible;
+  };
+  uint16_t numComps = tile_->numcomps_;
+  auto planes = std::make_shared<Planes>();
+  uint32_t w = 0;
+  uint32_t h = 0;
+  for(uint16_t k = 0; k < numComps; ++k)
+  {
+    auto destComp = composite->comps + k;
+    auto bounds = tile_->comps_[k].windowBounds();
+    Rect32 destBounds(destComp->x0, destComp->y0, destComp->x0 + destComp->w,
+                      destComp->y0 + destComp->h);
+    if(!destComp->data || destComp->data_type != GRK_INT_32 ||
+       !bounds.nonEmptyIntersection(&destBounds))
+    {
+      grklog.warn("MCT component %u is not in the composite - skipping MCT transform", k);
+      return;
+    }
+    auto win =
+        bounds.intersection(destBounds).pan(-(int64_t)destComp->x0, -(int64_t)destComp->y0);
+    if(k == 0)
+    {
+      w = win.width();
+      h = win.height();
+    }
+    else if(win.width() != w || win.height() != h)
+    {
+      grklog.warn("MCT components have differing dimensions - skipping MCT transform");
+      return;
+    }
+    planes->origins.push_back((int32_t*)destComp->data + win.x0 +
+                              (size_t)win.y0 * destComp->stride);
+    planes->strides.push_back(destComp->stride);
+    genShift(k, 1, planes->shiftInfo);
+    planes->reversible.push_back((tcp_->tccps_ + k)->qmfbid_ == 1);
+  }
+  bool transform = std::count(hasBlocks.begin(), hasBlocks.end(), true) == numComps;
+  if(!transform)
+    grklog.warn("MCT components without code blocks - applying DC shift only");
+  auto matrix = tcp_->mctDecodingMatrix_;
+  auto success = &success_;
+  uint32_t linesPerTask = std::max<uint32_t>(image_->rows_per_task, 1);
+  for(uint32_t yBegin = 0; yBegin < h; yBegin += linesPerTask)
+  {
+    uint32_t yEnd = std::min(yBegin + linesPerTask, h);
+    flow->nextTask().work([planes, hasBlocks, transform, matrix, numComps, w, yBegin, yEnd,
+                           success] {
+      std::vector<void*> chans(numComps);
+      for(uint32_t y = yBegin; y < yEnd; ++y)
+      {
+        for(uint16_t k = 0; k < numComps; ++k)
+          chans[k] = planes->origins[k] + (size_t)y * planes->strides[k];
+        if(transform)
+        {
+          if(!decompress_custom(matrix, numComps, chans.data(), planes->reversible.data(),
+                                planes->shiftInfo.data(), w))
+          {
+            *success = false;
+            return;
+          }
+          continue;
+        }
+        for(uint16_t k = 0; k < numComps; ++k)
+        {
+          if(!hasBlocks[k])
+            continue;
+          auto row = (int32_t*)chans[k];
+          auto& shift = planes->shiftInfo[k];
+          for(uint32_t x = 0; x < w; ++x)
+          {
+            int32_t v = planes->reversible[k] ? row[x] : (int32_t)std::lrint(((float*)row)[x]);
+            row[x] = std::clamp(v + shift._shift, shift._min, shift._max);
+          }
+        }
+      }
+    });
+  }
+}
+
+void Mct::decompress_rev(int32_t* const* chans, const ShiftInfo* shiftInfo, uint64_t n)
+{
+  HWY_DYNAMIC_DISPATCH(hwy_decompress_rev_rows)(chans, shiftInfo, 0, n);
+}
+
+void Mct::decompress_irrev(int32_t* const* chans, const ShiftInfo* shiftInfo, uint64_t n)
+{
+  HWY_DYNAMIC_DISPATCH(hwy_decompress_irrev_rows)(chans, shiftInfo, 0, n);
+}
+
+bool Mct::decompress_custom(const float* matrix, uint16_t numComps, void* const* chans,
+                            const uint8_t* reversible, const ShiftInfo* shiftInfo, uint64_t n)
+{
+  return HWY_DYNAMIC_DISPATCH(hwy_decompress_custom_rows)(matrix, numComps, chans, reversible,
+                                                         shiftInfo, 0, n);
+}
+
+bool Mct::hasError(void) const
+{
+  return !success_;
+}
+
 /* <summary> */
 /* Forward reversible MCT. */
 /* </summary> */
@@ -877,6 +1260,189 @@ bool Mct::compress_custom(uint8_t* mct_matrix, uint64_t n, uint8_t** pData, uint
   return true;
 }
 
+namespace
+{
+  /**
+   * Custom MCT test matrix: identity plus a mild mixing term whose size falls with the
+   * number of components. The entries are multiples of 1 / scale.
+   */
+  std::vector<float> customTestMatrix(uint16_t numcomps, float scale)
+  {
+    std::vector<float> matrix((size_t)numcomps * numcomps);
+    for(uint16_t o = 0; o < numcomps; ++o)
+    {
+      for(uint16_t k = 0; k < numcomps; ++k)
+        matrix[(size_t)o * numcomps + k] =
+            (o == k ? 1.0f : 0.0f) + (float)((o * 31 + k * 17) % 13 - 6) / scale;
+    }
+    return matrix;
+  }
+
+  /**
+   * Fill synthetic components with centred 8-bit samples, as int32 for reversible
+   * components and as float for the others
+   */
+  void fillCustomTestComponents(const std::vector<void*>& chans,
+                                const std::vector<uint8_t>& reversible, uint64_t area)
+  {
+    for(uint16_t k = 0; k < chans.size(); ++k)
+    {
+      for(uint64_t i = 0; i < area; ++i)
+      {
+        auto v = (int32_t)(((i + k * 7919u) * 2654435761u) & 255u) - 128;
+        if(reversible[k])
+          ((int32_t*)chans[k])[i] = v;
+        else
+          ((float*)chans[k])[i] = (float)v;
+      }
+    }
+  }
+
+  /**
+   * Custom inverse MCT with dc shift over every component: mode 0 is the per-sample
+   * reference loop, mode 1 the blocked kernel on one thread, mode 2 the blocked
+   * kernel over row strips on the task executor. Returns false if the kernel fails.
+   */
+  bool runCustomTest(uint32_t mode, const std::vector<float>& matrix,
+                     const std::vector<void*>& chans, const std::vector<uint8_t>& reversible,
+                     const std::vector<ShiftInfo>& shiftInfo, uint32_t width, uint32_t height)
+  {
+    auto numcomps = (uint16_t)chans.size();
+    uint64_t area = (uint64_t)width * height;
+    if(mode == 0)
+    {
+      std::vector<float> current(numcomps);
+      for(uint64_t i = 0; i < area; ++i)
+      {
+        for(uint16_t k = 0; k < numcomps; ++k)
+          current[k] =
+              reversible[k] ? (float)((int32_t*)chans[k])[i] : ((float*)chans[k])[i];
+        for(uint16_t o = 0; o < numcomps; ++o)
+        {
+          float sum = 0;
+          for(uint16_t k = 0; k < numcomps; ++k)
+            sum += matrix[(size_t)o * numcomps + k] * current[k];
+          ((int32_t*)chans[o])[i] = std::clamp((int32_t)std::lrintf(sum) + shiftInfo[o]._shift,
+                                               shiftInfo[o]._min, shiftInfo[o]._max);
+        }
+      }
+    }
+    else if(mode == 1)
+    {
+      return HWY_DYNAMIC_DISPATCH(hwy_decompress_custom_rows)(
+          matrix.data(), numcomps, chans.data(), reversible.data(), shiftInfo.data(), 0, area);
+    }
+    else
+    {
+      const uint32_t linesPerTask = 64;
+      std::atomic<bool> success{true};
+      tf::Taskflow taskflow;
+      for(uint32_t y = 0; y < height; y += linesPerTask)
+      {
+        uint64_t begin = (uint64_t)y * width;
+        uint64_t end = (uint64_t)std::min(y + linesPerTask, height) * width;
+        taskflow.emplace([&, begin, end] {
+          if(!HWY_DYNAMIC_DISPATCH(hwy_decompress_custom_rows)(matrix.data(), numcomps,
+                                                               chans.data(), reversible.data(),
+                                                               shiftInfo.data(), begin, end))
+            success = false;
+        });
+      }
+      TFSingleton::get().run(taskflow).wait();
+      return success;
+    }
+
+    return true;
+  }
+
+  bool allocCustomTestComponents(std::vector<void*>& chans, uint64_t area)
+  {
+    bool ok = true;
+    for(auto& chan : chans)
+    {
+      chan = grk_aligned_malloc(area * sizeof(float));
+      ok = ok && chan;
+    }
+    return ok;
+  }
+
+  void freeCustomTestComponents(std::vector<void*>& chans)
+  {
+    for(auto chan : chans)
+      grk_aligned_free(chan);
+  }
+} // namespace
+
+// bench hook: custom inverse MCT on synthetic float components, with a mild mixing
+// matrix and an 8-bit dc shift
+extern "C" double grk_bench_mct_custom(uint16_t numcomps, uint32_t width, uint32_t height,
+                                       uint32_t mode, uint32_t iters)
+{
+  if(!numcomps || !width || !height || !iters || mode > 2)
+    return -1.0;
+  uint64_t area = (uint64_t)width * height;
+  auto matrix = customTestMatrix(numcomps, 8.0f * numcomps);
+  std::vector<ShiftInfo> shiftInfo(numcomps, ShiftInfo(0, 255, 128));
+  std::vector<uint8_t> reversible(numcomps, 0);
+  std::vector<void*> chans(numcomps, nullptr);
+  bool ok = allocCustomTestComponents(chans, area);
+  double best = std::numeric_limits<double>::max();
+  for(uint32_t it = 0; ok && it < iters; ++it)
+  {
+    fillCustomTestComponents(chans, reversible, area);
+    auto start = std::chrono::steady_clock::now();
+    ok = runCustomTest(mode, matrix, chans, reversible, shiftInfo, width, height);
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best = std::min(best, elapsed);
+  }
+  freeCustomTestComponents(chans);
+
+  return ok ? best : -1.0;
+}
+
+// test hook: every third component, from the second, is reversible (int32). The matrix
+// entries are multiples of 1/64 and the samples small integers, so every product and
+// partial sum is exact in float, whatever the order or fusing of the accumulation.
+extern "C" int64_t grk_check_mct_custom(uint16_t numcomps, uint32_t width, uint32_t height,
+                                        uint32_t mode)
+{
+  if(!numcomps || !width || !height || mode < 1 || mode > 2)
+    return -1;
+  uint64_t area = (uint64_t)width * height;
+  auto matrix = customTestMatrix(numcomps, 64.0f);
+  std::vector<ShiftInfo> shiftInfo(numcomps);
+  std::vector<uint8_t> reversible(numcomps);
+  for(uint16_t k = 0; k < numcomps; ++k)
+  {
+    reversible[k] = k % 3 == 1;
+    // 8 bit outputs, alternately unsigned and signed, so the clamp acts on both ends
+    shiftInfo[k] = (k & 1) ? ShiftInfo(-128, 127, 0) : ShiftInfo(0, 255, 128);
+  }
+  std::vector<void*> reference(numcomps, nullptr);
+  std::vector<void*> chans(numcomps, nullptr);
+  int64_t mismatches = -1;
+  if(allocCustomTestComponents(reference, area) && allocCustomTestComponents(chans, area))
+  {
+    fillCustomTestComponents(reference, reversible, area);
+    fillCustomTestComponents(chans, reversible, area);
+    if(runCustomTest(0, matrix, reference, reversible, shiftInfo, width, height) &&
+       runCustomTest(mode, matrix, chans, reversible, shiftInfo, width, height))
+    {
+      mismatches = 0;
+      for(uint16_t k = 0; k < numcomps; ++k)
+      {
+        for(uint64_t i = 0; i < area; ++i)
+          mismatches += ((int32_t*)reference[k])[i] != ((int32_t*)chans[k])[i];
+      }
+    }
+  }
+  freeCustomTestComponents(reference);
+  freeCustomTestComponents(chans);
+
+  return mismatches;
+}
+
 /* <summary> */
 /* This table contains the norms of the basis function of the reversible MCT. */
 /* </summary> */
@@ -17,8 +17,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 
+#include "grk_internal.h"
+
 namespace grk
 {
 struct ShiftInfo
@@ -42,8 +45,27 @@ struct ScheduleInfo
   uint32_t linesPerTask_;
   uint32_t yBegin;
   uint32_t yEnd;
+  /** custom (Part 2) transform: row-major decoding matrix, one row per output component */
+  const float* matrix = nullptr;
+  /** custom (Part 2) transform: true for each component held as int32 rather than float */
+  std::vector<uint8_t> reversible;
+  /** cleared by a task that fails, so the owner can fail the tile */
+  std::atomic<bool>* success = nullptr;
 };
 
+// exported hook for grk_mct_bench: drives the custom inverse MCT kernel on synthetic
+// data. Mode 0 is the per-sample reference loop, mode 1 the blocked kernel on one
+// thread, mode 2 the blocked kernel over row strips on the task executor. Returns best
+// seconds per transform, or a negative value on failure.
+extern "C" GRK_INTERNAL double grk_bench_mct_custom(uint16_t numcomps, uint32_t width,
+                                                    uint32_t height, uint32_t mode,
+                                                    uint32_t iters);
+// exported hook for grk_mct_custom_test: runs the custom inverse MCT kernel in mode 1 or 2
+// and the reference loop on the same synthetic mix of int32 and float components.
+// Returns the number of output samples that differ, or a negative value on failure.
+extern "C" GRK_INTERNAL int64_t grk_check_mct_custom(uint16_t numcomps, uint32_t width,
+                                                     uint32_t height, uint32_t mode);
+
 class Mct
 {
 public:
@@ -84,6 +106,41 @@ public:
    */
   void schedule_decompress_dc_shift_irrev(FlowComponent* flow, uint16_t compno);
 
+  /**
+   Apply a custom (Part 2) multi-component inverse transform, with dc shift, to all
+   components of an image
+   */
+  void schedule_decompress_custom(FlowComponent* flow);
+
+  /**
+   Apply a custom (Part 2) multi-component inverse transform, with dc shift, to the
+   tile's window of every component of a composite image, in row strips. If a component
+   has no code blocks, only the dc shift is applied, to the components that have.
+   */
+  void schedule_decompress_custom(FlowComponent* flow, GrkImage* composite,
+                                  const std::vector<bool>& hasBlocks);
+
+  /**
+   Apply the inverse reversible MCT, with dc shift and clamp, to the first n samples of
+   three contiguous int32 components, such as an overview level held outside the tile
+   */
+  static void decompress_rev(int32_t* const* chans, const ShiftInfo* shiftInfo, uint64_t n);
+
+  /**
+   Apply the inverse irreversible MCT, with dc shift and clamp, to the first n samples of
+   three contiguous float components, storing int32 in place
+   */
+  static void decompress_irrev(int32_t* const* chans, const ShiftInfo* shiftInfo, uint64_t n);
+
+  /**
+   Apply a custom (Part 2) inverse MCT, with dc shift and clamp, to the first n samples of
+   numComps contiguous components, int32 where reversible is set and float elsewhere,
+   storing int32 in place. Returns false if the transform could not be applied.
+   */
+  static bool decompress_custom(const float* matrix, uint16_t numComps, void* const* chans,
+                                const uint8_t* reversible, const ShiftInfo* shiftInfo,
+                                uint64_t n);
+
   /**
    Get wavelet norms for reversible transform
    */
@@ -113,6 +170,11 @@ public:
    */
   static void calculate_norms(double* pNorms, uint16_t nb_comps, float* pMatrix);
 
+  /**
+   True if a scheduled transform task failed, leaving the tile's samples unusable
+   */
+  bool hasError(void) const;
+
 private:
   void genShift(uint16_t compno, int32_t sign, std::vector<ShiftInfo>& shiftInfo);
   void genShift(int32_t sign, std::vector<ShiftInfo>& shiftInfo);
@@ -120,6 +182,7 @@ private:
   Tile* tile_;
   GrkImage* image_;
   TileCodingParams* tcp_;
+  std::atomic<bool> success_{true};
 };
 
 /* ----------------------------------------------------------------------- */
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <future>
 #include <stdexcept>
 #include <unordered_map>
 #include <mutex>
@@ -76,6 +78,18 @@ public:
     return true;
   }
 
+  // Check without waiting whether a tile's future has completed; true if there is none
+  bool ready(uint16_t tile_id) const
+  {
+    std::unique_lock lock(mutex_);
+    auto it = tileFutures_.find(tile_id);
+    if(it == tileFutures_.end())
+    {
+      return true;
+    }
+    return it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }
+
   // Clear the map immediately (no waiting)
   void clear()
   {
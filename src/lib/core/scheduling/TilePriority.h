@@ -0,0 +1,220 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace grk
+{
+
+/**
+ * @class TilePriority
+ * @brief Orders tiles waiting to be scheduled
+ *
+ * Tiles given an explicit priority with set() come first, lowest value first. The rest
+ * follow in order of the distance of their centre from the focus point, if one was set
+ * with setFocus(), and otherwise in tile index (swath) order. Both may be called while a
+ * decompress is scheduling tiles: the tiles that have not been popped yet are reordered.
+ */
+class TilePriority
+{
+public:
+  /**
+   * @brief True once a focus or a tile priority has been set
+   */
+  bool active(void) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hasFocus_ || !priorities_.empty();
+  }
+
+  /**
+   * @brief Sets the tile grid, in reference grid coordinates
+   *
+   * @param tx0 tile grid origin x
+   * @param ty0 tile grid origin y
+   * @param tw tile width
+   * @param th tile height
+   * @param gridWidth number of tile columns
+   * @param x0 image x0
+   * @param y0 image y0
+   * @param x1 image x1
+   * @param y1 image y1
+   */
+  void setGrid(uint32_t tx0, uint32_t ty0, uint32_t tw, uint32_t th, uint16_t gridWidth,
+               uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tx0_ = tx0;
+    ty0_ = ty0;
+    tw_ = tw;
+    th_ = th;
+    gridWidth_ = gridWidth;
+    x0_ = x0;
+    y0_ = y0;
+    x1_ = x1;
+    y1_ = y1;
+    reorder();
+  }
+
+  /**
+   * @brief Ranks tiles without an explicit priority by their distance from a point
+   * on the reference grid
+   */
+  void setFocus(uint32_t x, uint32_t y)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hasFocus_ = true;
+    focusX_ = x;
+    focusY_ = y;
+    reorder();
+  }
+
+  /**
+   * @brief Sets a tile's explicit priority: lower values are scheduled sooner
+   */
+  void set(uint16_t tileIndex, uint32_t priority)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(priorities_.size() <= tileIndex)
+      priorities_.resize((size_t)tileIndex + 1, NONE);
+    priorities_[tileIndex] = priority;
+    reorder();
+  }
+
+  /**
+   * @brief Replaces the waiting tiles
+   */
+  template<typename C>
+  void assign(const C& tiles)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    heap_.assign(tiles.begin(), tiles.end());
+    reorder();
+  }
+
+  /**
+   * @brief Removes the waiting tile that should be scheduled next
+   *
+   * @return false if no tile is waiting
+   */
+  bool pop(uint16_t& tileIndex)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(heap_.empty())
+      return false;
+    auto later = [this](uint16_t a, uint16_t b) { return key(a) > key(b); };
+    if(dirty_)
+    {
+      std::make_heap(heap_.begin(), heap_.end(), later);
+      dirty_ = false;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), later);
+    tileIndex = heap_.back();
+    heap_.pop_back();
+    return true;
+  }
+
+  /**
+   * @brief Sorts @p tiles into scheduling order
+   */
+  void sort(std::vector<uint16_t>& tiles) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::sort(tiles.begin(), tiles.end(),
+              [this](uint16_t a, uint16_t b) { return key(a) < key(b); });
+  }
+
+  /**
+   * @brief Lists the waiting tiles in scheduling order, if they were reordered since
+   * the last call
+   *
+   * @param tiles waiting tiles, next to be popped first
+   * @param version order seen by the last call; updated
+   * @return false if the order is unchanged
+   */
+  bool order(std::vector<uint16_t>& tiles, uint64_t& version) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(version == version_)
+      return false;
+    version = version_;
+    tiles = heap_;
+    std::sort(tiles.begin(), tiles.end(),
+              [this](uint16_t a, uint16_t b) { return key(a) < key(b); });
+    return true;
+  }
+
+private:
+  static constexpr uint64_t NONE = std::numeric_limits<uint64_t>::max();
+
+  void reorder(void)
+  {
+    dirty_ = true;
+    version_++;
+  }
+
+  /**
+   * @brief (explicit priority or none, squared focus distance, index): the smallest
+   * is scheduled first
+   */
+  std::tuple<uint64_t, double, uint16_t> key(uint16_t tileIndex) const
+  {
+    uint64_t priority = tileIndex < priorities_.size() ? priorities_[tileIndex] : NONE;
+    double distance = 0;
+    if(priority == NONE && hasFocus_ && gridWidth_)
+    {
+      // centre of the tile, clipped to the image
+      uint64_t tx = tileIndex % gridWidth_;
+      uint64_t ty = tileIndex / gridWidth_;
+      double left = (double)std::max<uint64_t>(tx0_ + tx * tw_, x0_);
+      double right = (double)std::min<uint64_t>(tx0_ + (tx + 1) * tw_, x1_);
+      double top = (double)std::max<uint64_t>(ty0_ + ty * th_, y0_);
+      double bottom = (double)std::min<uint64_t>(ty0_ + (ty + 1) * th_, y1_);
+      double dx = (left + right) / 2 - (double)focusX_;
+      double dy = (top + bottom) / 2 - (double)focusY_;
+      distance = dx * dx + dy * dy;
+    }
+    return {priority, distance, tileIndex};
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<uint16_t> heap_;
+  std::vector<uint64_t> priorities_;
+  bool dirty_ = false;
+  uint64_t version_ = 1;
+  bool hasFocus_ = false;
+  uint32_t focusX_ = 0;
+  uint32_t focusY_ = 0;
+  uint32_t tx0_ = 0;
+  uint32_t ty0_ = 0;
+  uint32_t tw_ = 0;
+  uint32_t th_ = 0;
+  uint16_t gridWidth_ = 0;
+  uint32_t x0_ = 0;
+  uint32_t y0_ = 0;
+  uint32_t x1_ = 0;
+  uint32_t y1_ = 0;
+};
+
+} // namespace grk
@@ -60,14 +60,48 @@ namespace grk
 {
 CompressScheduler::CompressScheduler(Tile* tile, bool needsRateControl, TileCodingParams* tcp,
                                      const double* mct_norms, uint16_t mct_numcomps,
-                                     bool progressiveRateControl)
+                                     bool progressiveRateControl, bool transcode,
+                                     std::function<bool(t1::CompressBlockExec*)> blockSource)
     : SchedulerStandard(tile->numcomps_), tile_(tile), needsRateControl_(needsRateControl),
-      progressiveRateControl_(progressiveRateControl), blockCount_(-1), tcp_(tcp),
+      progressiveRateControl_(progressiveRateControl), transcode_(transcode),
+      blockSource_(std::move(blockSource)), blockCount_(-1),
+      tcp_(tcp),
       mct_norms_(mct_norms), mct_numcomps_(mct_numcomps)
 {
   rateControlStats_.init(tile->numcomps_);
 }
 
+t1::CompressBlockExec* CompressScheduler::makeBlock(uint16_t compno, uint8_t resno, Subband* band,
+                                                   t1::CodeblockCompress* cblk)
+{
+  auto tilec = tile_->comps_ + compno;
+  auto tccp = tcp_->tccps_ + compno;
+  auto block = new t1::CompressBlockExec();
+  block->tile_width = tilec->getWindow()->getResWindowBufferHighestStride();
+  block->doRateControl = needsRateControl_;
+  block->x = cblk->x0();
+  block->y = cblk->y0();
+  tilec->getWindow()->toRelativeCoordinates(resno, band->orientation_, block->x, block->y);
+  auto highest = tilec->getWindow()->getResWindowBufferHighestSimple();
+  block->tiledp = highest.buf_ + (uint64_t)block->x + block->y * (uint64_t)highest.stride_;
+  block->compno = compno;
+  block->bandOrientation = band->orientation_;
+  block->cblk = cblk;
+  block->cblk_sty = tccp->cblkStyle_;
+  block->qmfbid = tccp->qmfbid_;
+  block->resno = resno;
+  block->level = (uint8_t)(tilec->num_resolutions_ - 1 - resno);
+  block->inv_step_ht = 1.0f / band->stepsize_;
+  block->stepsize = band->stepsize_;
+  block->mct_norms = mct_norms_;
+  block->mct_numcomps = mct_numcomps_;
+  block->k_msbs = (uint8_t)(band->maxBitPlanes_ - cblk->numbps());
+  block->use16BitDwt = tilec->is16BitDwt();
+  block->htTranscode = transcode_;
+
+  return block;
+}
+
 bool CompressScheduler::scheduleT1(ITileProcessor* proc)
 {
   (void)proc;
@@ -96,33 +130,9 @@ bool CompressScheduler::scheduleT1(ITileProcessor* proc)
               continue;
             if(!cblk->allocData(nominalBlockSize))
               continue;
-            auto block = new t1::CompressBlockExec();
-            block->tile_width =
-                (tile_->comps_ + compno)->getWindow()->getResWindowBufferHighestStride();
-            block->doRateControl = needsRateControl_;
-            block->x = cblk->x0();
-            block->y = cblk->y0();
-            tilec->getWindow()->toRelativeCoordinates(resno, band->orientation_, block->x,
-                                                      block->y);
-            auto highest = tilec->getWindow()->getResWindowBufferHighestSimple();
-            block->tiledp =
-                highest.buf_ + (uint64_t)block->x + block->y * (uint64_t)highest.stride_;
             maxCblkW = std::max<uint16_t>(maxCblkW, (uint16_t)(1 << tccp->cblkw_expn_));
             maxCblkH = std::max<uint16_t>(maxCblkH, (uint16_t)(1 << tccp->cblkh_expn_));
-            block->compno = compno;
-            block->bandOrientation = band->orientation_;
-            block->cblk = cblk;
-            block->cblk_sty = tccp->cblkStyle_;
-            block->qmfbid = tccp->qmfbid_;
-            block->resno = resno;
-            block->level = (uint8_t)((tile_->comps_ + compno)->num_resolutions_ - 1 - resno);
-            block->inv_step_ht = 1.0f / band->stepsize_;
-            block->stepsize = band->stepsize_;
-            block->mct_norms = mct_norms_;
-            block->mct_numcomps = mct_numcomps_;
-            block->k_msbs = (uint8_t)(band->maxBitPlanes_ - cblk->numbps());
-            block->use16BitDwt = tilec->is16BitDwt();
-            blocks.push_back(block);
+            blocks.push_back(makeBlock(compno, resno, band, cblk));
           }
         }
       }
@@ -189,33 +199,9 @@ bool CompressScheduler::populateT1Flow(FlowComponent* flow)
               continue;
             if(!cblk->allocData(nominalBlockSize))
               continue;
-            auto block = new t1::CompressBlockExec();
-            block->tile_width =
-                (tile_->comps_ + compno)->getWindow()->getResWindowBufferHighestStride();
-            block->doRateControl = needsRateControl_;
-            block->x = cblk->x0();
-            block->y = cblk->y0();
-            tilec->getWindow()->toRelativeCoordinates(resno, band->orientation_, block->x,
-                                                      block->y);
-            auto highest = tilec->getWindow()->getResWindowBufferHighestSimple();
-            block->tiledp =
-                highest.buf_ + (uint64_t)block->x + block->y * (uint64_t)highest.stride_;
             maxCblkW = std::max<uint16_t>(maxCblkW, (uint16_t)(1 << tccp->cblkw_expn_));
             maxCblkH = std::max<uint16_t>(maxCblkH, (uint16_t)(1 << tccp->cblkh_expn_));
-            block->compno = compno;
-            block->bandOrientation = band->orientation_;
-            block->cblk = cblk;
-            block->cblk_sty = tccp->cblkStyle_;
-            block->qmfbid = tccp->qmfbid_;
-            block->resno = resno;
-            block->level = (uint8_t)((tile_->comps_ + compno)->num_resolutions_ - 1 - resno);
-            block->inv_step_ht = 1.0f / band->stepsize_;
-            block->stepsize = band->stepsize_;
-            block->mct_norms = mct_norms_;
-            block->mct_numcomps = mct_numcomps_;
-            block->k_msbs = (uint8_t)(band->maxBitPlanes_ - cblk->numbps());
-            block->use16BitDwt = tilec->is16BitDwt();
-            blocks.push_back(block);
+            blocks.push_back(makeBlock(compno, resno, band, cblk));
           }
         }
       }
@@ -267,7 +253,10 @@ bool CompressScheduler::compress(size_t workerId, uint64_t maxBlocks)
 }
 void CompressScheduler::compress(t1::ICoder* coder, t1::CompressBlockExec* block)
 {
-  block->open(coder);
+  if(blockSource_)
+    blockSource_(block);
+  else
+    block->open(coder);
   if(needsRateControl_)
   {
     {
@@ -304,39 +293,86 @@ void CompressScheduler::compress(t1::ICoder* coder, t1::CompressBlockExec* block
       slopeEstimator_->updateStats(slopes, rates, numPasses, num_pix);
     }
 
-    // Collect slope stats for both bisect algorithms
-    for(uint8_t passno = 0; passno < cblk->getNumPasses(); passno++)
+    updateRateControlStats(cblk);
+  }
+}
+
+void CompressScheduler::updateRateControlStats(t1::CodeblockCompress* cblk)
+{
+  // Collect slope stats for both bisect algorithms
+  for(uint8_t passno = 0; passno < cblk->getNumPasses(); passno++)
+  {
+    auto pass = cblk->getPass(passno);
+
+    // Feasible bisect: track min/max log-domain slopes from convex hull
+    if(pass->slope_ != 0)
     {
-      auto pass = cblk->getPass(passno);
+      rateControlStats_.updateMinSlope(pass->slope_);
+      rateControlStats_.updateMaxSlope(pass->slope_);
+    }
 
-      // Feasible bisect: track min/max log-domain slopes from convex hull
-      if(pass->slope_ != 0)
-      {
-        rateControlStats_.updateMinSlope(pass->slope_);
-        rateControlStats_.updateMaxSlope(pass->slope_);
-      }
+    // Simple bisect: track min/max raw RD slopes
+    int32_t dr;
+    double dd;
+    if(passno == 0)
+    {
+      dr = (int32_t)pass->rate_;
+      dd = pass->distortiondec_;
+    }
+    else
+    {
+      dr = (int32_t)(pass->rate_ - cblk->getPass(passno - 1)->rate_);
+      dd = pass->distortiondec_ - cblk->getPass(passno - 1)->distortiondec_;
+    }
+    if(dr != 0)
+    {
+      double rdslope = dd / dr;
+      rateControlStats_.updateMinRDSlope(rdslope);
+      rateControlStats_.updateMaxRDSlope(rdslope);
+    }
+  }
+}
 
-      // Simple bisect: track min/max raw RD slopes
-      int32_t dr;
-      double dd;
-      if(passno == 0)
-      {
-        dr = (int32_t)pass->rate_;
-        dd = pass->distortiondec_;
-      }
-      else
-      {
-        dr = (int32_t)(pass->rate_ - cblk->getPass(passno - 1)->rate_);
-        dd = pass->distortiondec_ - cblk->getPass(passno - 1)->distortiondec_;
-      }
-      if(dr != 0)
-      {
-        double rdslope = dd / dr;
-        rateControlStats_.updateMinRDSlope(rdslope);
-        rateControlStats_.updateMaxRDSlope(rdslope);
-      }
+bool CompressScheduler::recodeHT(const std::vector<HTRecode>& recodes)
+{
+  if(recodes.empty())
+    return true;
+  if(coders_.empty())
+    return false;
+  std::atomic<size_t> next{0};
+  std::atomic<bool> success{true};
+  auto work = [this, &recodes, &next, &success](t1::ICoder* coder) {
+    size_t i;
+    while((i = next.fetch_add(1, std::memory_order_relaxed)) < recodes.size())
+    {
+      const auto& r = recodes[i];
+      std::unique_ptr<t1::CompressBlockExec> block(makeBlock(r.compno, r.resno, r.band, r.cblk));
+      // truncations are relative to the bit planes the block was first coded with
+      block->k_msbs = r.band->maxBitPlanes_;
+      block->doRateControl = false;
+      block->htRecode = true;
+      block->htDroppedPlanes = r.droppedPlanes;
+      if(!block->open(coder))
+        success.store(false, std::memory_order_relaxed);
     }
+  };
+  // T1 is done, so the coders are free; each worker uses its own
+  size_t numWorkers = std::min(coders_.size(), recodes.size());
+  if(numWorkers < 2)
+  {
+    work(coders_[0]);
+    return success;
   }
+  tf::Taskflow taskflow;
+  for(size_t w = 0; w < numWorkers; ++w)
+    taskflow.emplace([this, &work] { work(coders_[(size_t)TFSingleton::get().this_worker_id()]); });
+  auto& executor = TFSingleton::get();
+  if(executor.this_worker_id() >= 0)
+    executor.corun(taskflow);
+  else
+    executor.run(taskflow).wait();
+
+  return success;
 }
 
 void CompressScheduler::initSlopeEstimator(const std::vector<t1::CompressBlockExec*>& blocks)
@@ -20,7 +20,9 @@
 #include "SchedulerStandard.h"
 #include "RateControlStats.h"
 #include "ProgressiveSlopeEstimator.h"
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace grk
 {
@@ -34,10 +36,14 @@ public:
    * @param tcp @ref TileCodingParams
    * @param mct_norms array of mct norms
    * @param mct_numcomps number of mct components
+   * @param progressiveRateControl true for progressive rate control
+   * @param transcode true if the tile holds coefficients transcoded from Part 1
+   * @param blockSource if set, gives each block its coding passes in place of T1
    */
   CompressScheduler(Tile* tile, bool needsRateControl, TileCodingParams* tcp,
                     const double* mct_norms, uint16_t mct_numcomps,
-                    bool progressiveRateControl = false);
+                    bool progressiveRateControl = false, bool transcode = false,
+                    std::function<bool(t1::CompressBlockExec*)> blockSource = nullptr);
   /**
    * @brief Destroys a CompressScheduler
    */
@@ -54,7 +60,48 @@ public:
     return rateControlStats_;
   }
 
+  /**
+   * @brief Adds the slopes of a code block's coding passes to the rate control stats
+   *
+   * @param cblk @ref t1::CodeblockCompress code block
+   */
+  void updateRateControlStats(t1::CodeblockCompress* cblk);
+
+  /**
+   * @struct HTRecode
+   * @brief HT code block to code again with least significant bit planes dropped
+   */
+  struct HTRecode
+  {
+    uint16_t compno;
+    uint8_t resno;
+    Subband* band;
+    t1::CodeblockCompress* cblk;
+    uint8_t droppedPlanes;
+  };
+
+  /**
+   * @brief Codes HT code blocks again after T1, in parallel, recording the exact
+   * lengths of their truncations
+   *
+   * @param recodes code blocks and the bit planes to drop from each
+   * @return true if successful
+   */
+  bool recodeHT(const std::vector<HTRecode>& recodes);
+
 private:
+  /**
+   * @brief Creates the compression block for a code block
+   *
+   * @param compno component number
+   * @param resno resolution number
+   * @param band @ref Subband of the code block
+   * @param cblk @ref t1::CodeblockCompress code block
+   * @return @ref t1::CompressBlockExec, owned by the caller
+   */
+  t1::CompressBlockExec* makeBlock(uint16_t compno, uint8_t resno, Subband* band,
+                                   t1::CodeblockCompress* cblk);
+
   /**
    * @brief compress next block
    *
@@ -100,6 +147,15 @@ private:
    * @brief true if progressive rate control (early termination) is enabled
    */
   bool progressiveRateControl_;
+
+  /**
+   * @brief true if the tile holds coefficients transcoded from Part 1
+   */
+  bool transcode_;
+  /**
+   * @brief truncating transcode: source of the blocks' coding passes, in place of T1
+   */
+  std::function<bool(t1::CompressBlockExec*)> blockSource_;
   /**
    * @brief vector of @ref CompressBlockExec encode blocks
    */
@@ -15,6 +15,9 @@
  *
  */
 
+#include <cmath>
+#include <vector>
+
 #include "TFSingleton.h"
 #include "TileFutureManager.h"
 
@@ -63,15 +66,136 @@ struct ITileProcessor;
 #include "mct.h"
 #include "ITileProcessor.h"
 #include "CoderFactory.h"
+#include "CodeblockCache.h"
 #include "DecompressScheduler.h"
 
 namespace grk
 {
 
+/**
+ * @brief Replays a cached code block through its post-processor
+ *
+ * The post-processor modifies its input in place, so the cached samples are
+ * copied to a per-thread scratch buffer laid out the way the coder would have.
+ * @return true on a cache hit
+ */
+static bool replayCachedBlock(CodeblockCache* cache, const CodeblockCacheKey& key,
+                              t1::DecompressBlockExec* block)
+{
+  CodeblockCache::Entry entry;
+  if(!cache->lookup(key, entry))
+    return false;
+  uint32_t stride = entry.coderStride ? entry.coderStride : entry.width;
+  static thread_local Buffer<int32_t, AllocatorAligned> scratch;
+  if(!scratch.alloc((size_t)stride * entry.height))
+    return false;
+  auto dest = scratch.currPtr();
+  auto src = entry.data->data();
+  for(uint32_t j = 0; j < entry.height; ++j)
+    memcpy(dest + (size_t)j * stride, src + (size_t)j * entry.width,
+           entry.width * sizeof(int32_t));
+  block->postProcessor_(dest, block, entry.coderStride);
+
+  return true;
+}
+
+/**
+ * @brief Wraps a block's post-processor so that its T1 output is cached first
+ */
+static void recordBlock(CodeblockCache* cache, const CodeblockCacheKey& key,
+                        t1::DecompressBlockExec* block)
+{
+  block->postProcessor_ = [cache, key, post = std::move(block->postProcessor_)](
+                              int32_t* srcData, t1::DecompressBlockExec* b, uint16_t stride) {
+    cache->store(key, srcData, b->cblk->width(), b->cblk->height(), stride);
+    post(srcData, b, stride);
+  };
+}
+
+/**
+ * @brief Bounds how far a unit error in every coefficient of a band can move one
+ * output sample, in one dimension
+ *
+ * The band's coefficients pass through one lowpass or highpass synthesis stage,
+ * then lowpassLevels lowpass stages; the bound is the largest sum of absolute
+ * impulse response taps over the output sample phases. Taps follow the
+ * decoder's normalization, in which 9/7 highpass bands carry half the
+ * encoder's step size.
+ */
+static double synthesisGain(bool reversible, bool highpass, uint8_t lowpassLevels)
+{
+  static const std::vector<double> low53 = {0.5, 1.0, 0.5};
+  static const std::vector<double> high53 = {-0.125, -0.25, 0.75, -0.25, -0.125};
+  static const std::vector<double> low97 = {-0.091271763114, -0.057543526229, 0.591271763114,
+                                            1.115087052457,  0.591271763114,  -0.057543526229,
+                                            -0.091271763114};
+  static const std::vector<double> high97 = {0.053497514822,  0.033728236886, -0.156446533058,
+                                             -0.533728236886, 1.205898036472, -0.533728236886,
+                                             -0.156446533058, 0.033728236886, 0.053497514822};
+  const auto& low = reversible ? low53 : low97;
+  // the gain has converged long before the response outgrows this
+  lowpassLevels = std::min<uint8_t>(lowpassLevels, 10);
+
+  std::vector<double> response = highpass ? (reversible ? high53 : high97) : low;
+  size_t period = 2;
+  for(uint8_t level = 0; level < lowpassLevels; ++level)
+  {
+    std::vector<double> next(2 * response.size() - 1 + low.size() - 1, 0.0);
+    for(size_t i = 0; i < response.size(); ++i)
+      for(size_t j = 0; j < low.size(); ++j)
+        next[2 * i + j] += response[i] * low[j];
+    response = std::move(next);
+    period *= 2;
+  }
+  double gain = 0;
+  for(size_t phase = 0; phase < period; ++phase)
+  {
+    double sum = 0;
+    for(size_t i = phase; i < response.size(); i += period)
+      sum += std::abs(response[i]);
+    gain = std::max(gain, sum);
+  }
+  return gain;
+}
+
+/**
+ * @brief Gets how many least significant bit planes of a band can stay undecoded
+ *
+ * Stopping k bit planes early leaves every quantization index off by less than 2^k,
+ * so the band moves an output sample by less than 2^k * stepsize * gain.
+ * @param budget largest output sample error the band may contribute
+ * @param resno band resolution
+ * @param outputResno resolution the tile component is reconstructed at
+ */
+static uint8_t skippableBitPlanes(double budget, bool reversible, float stepsize, uint8_t resno,
+                                  uint8_t outputResno, t1::eBandOrientation orientation)
+{
+  double gain;
+  if(resno == 0)
+  {
+    gain = outputResno ? synthesisGain(reversible, false, (uint8_t)(outputResno - 1)) : 1.0;
+    gain *= gain;
+  }
+  else
+  {
+    auto lowpassLevels = (uint8_t)(outputResno - resno);
+    bool highH = orientation == t1::BAND_ORIENT_HL || orientation == t1::BAND_ORIENT_HH;
+    bool highV = orientation == t1::BAND_ORIENT_LH || orientation == t1::BAND_ORIENT_HH;
+    gain = synthesisGain(reversible, highH, lowpassLevels) *
+           synthesisGain(reversible, highV, lowpassLevels);
+  }
+  double unit = (double)stepsize * gain;
+  if(!(unit > 0))
+    return 0;
+  int planes = (int)std::floor(std::log2(budget / unit));
+
+  return (uint8_t)std::clamp(planes, 0, 31);
+}
+
 DecompressScheduler::DecompressScheduler(uint16_t numcomps, uint8_t prec, CoderPool* streamPool)
     : SchedulerStandard(numcomps), prec_(prec), blocksByTile_(TileBlocks(numcomps)),
       differentialInfo_(new DifferentialInfo[numcomps]), prePostProc_(nullptr),
-      streamPool_(streamPool)
+      streamPool_(streamPool), compBegin_(0), compEnd_(numcomps), componentsWithBlocks_(0)
 {
   for(uint16_t compno = 0; compno < numcomps; ++compno)
     waveletReverse_.push_back(nullptr);
@@ -99,15 +223,35 @@ void DecompressScheduler::release(void)
   prePostProc_ = nullptr;
 }
 
+void DecompressScheduler::setComponentRange(uint16_t begin, uint16_t end)
+{
+  compBegin_ = begin;
+  compEnd_ = std::min(end, numcomps_);
+}
+
+uint16_t DecompressScheduler::numComponentsWithBlocks(void) const
+{
+  return componentsWithBlocks_;
+}
+
+bool DecompressScheduler::componentHasBlocks(uint16_t compno)
+{
+  return getImageComponentFlow(compno) != nullptr;
+}
+
 bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
 {
   auto tcp = tileProcessor->getTCP();
   auto mct = tileProcessor->getMCT();
-  auto doPostT1 = tileProcessor->doPostT1();
+  // a coefficient sink takes the tile straight after T1
+  bool coefficientsOnly = tileProcessor->getCodingParams()->coefficientSink_ != nullptr;
+  auto doPostT1 = tileProcessor->doPostT1() && !coefficientsOnly;
   FlowComponent* mctPostProc = nullptr;
   // schedule MCT post processing
   if(doPostT1 && tileProcessor->needsMctDecompress())
     mctPostProc = genPrePostProc();
+  // a custom (Part 2) transform mixes every component, and owns their dc shift
+  bool customMct = mctPostProc && tcp->mct_ == 2;
   uint32_t num_threads = (uint32_t)TFSingleton::num_threads();
   bool cacheAll =
       (tileProcessor->getTileCacheStrategy() & GRK_TILE_CACHE_ALL) == GRK_TILE_CACHE_ALL;
@@ -126,12 +270,23 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
     resMax = std::max(resMax, resUpperBound);
   }
   ResolutionChecker rChecker(numcomps_, tileProcessor->getTile()->comps_, cacheAll);
+  // GRK_TILE_CACHE_ALL keeps decoded tiles and coders, and its differential
+  // decodes resume from coder state, so it bypasses the code block cache
+  auto codeblockCache = cacheAll ? nullptr : tileProcessor->getCodeblockCache();
+  if(codeblockCache && !codeblockCache->enabled())
+    codeblockCache = nullptr;
+  uint16_t tileIndex = tileProcessor->getIndex();
+  componentsWithBlocks_ = 0;
 
-  for(uint16_t compno = 0; compno < numcomps_; ++compno)
+  for(uint16_t compno = compBegin_; compno < compEnd_; ++compno)
   {
     // skip components not selected for decoding
     if(!tileProcessor->shouldDecodeComponent(compno))
+    {
+      // its kept resolutions would miss the coding passes parsed meanwhile
+      tileProcessor->getTile()->comps_[compno].releaseSynthesized();
       continue;
+    }
 
     // schedule blocks
     auto tccp = tcp->tccps_ + compno;
@@ -164,9 +319,48 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
         block.release();
       componentBlocks.clear();
     }
+    // a differential decompress resynthesizes a whole tile from the lowest resolution
+    // whose packets carried coding passes. The resolution below it is restored as kept
+    // from the last decompress, so its code blocks and wavelet levels are skipped
+    uint8_t numResRead = tilec->nextPacketProgressionState_.numResolutionsRead();
+    bool keepSynthesis = cacheAll && wholeTileDecoding && !coefficientsOnly &&
+                         tcp->wholeTileDecompress_ && numResRead > 2;
+    uint8_t firstLevel = 1;
+    if(keepSynthesis)
+    {
+      auto lowest = std::min(tileProcessor->lowestCodedResolution(compno),
+                             (uint8_t)(numResRead - 1));
+      if(lowest >= 2 && tcp->layersToDecompress_ >= diffInfo->layersDecompressed_ &&
+         tilec->hasSynthesizedLevel((uint8_t)(lowest - 1)))
+        firstLevel = lowest;
+      // overview levels are copied out of the synthesis on its way up
+      for(uint8_t r = 0; r + 1 < firstLevel; ++r)
+      {
+        if(tilec->wantsPyramidLevel(r))
+          firstLevel = 1;
+      }
+      if(firstLevel == 1)
+        tilec->releaseSynthesized();
+    }
     diffInfo->layersDecompressed_ = tcp->layersToDecompress_;
     bool finalLayer = tcp->layersToDecompress_ == tcp->numLayers_;
 
+    // with a target output precision, every band gets an equal share of one output
+    // step to spend on undecoded bit planes. An inverse colour transform sums up to
+    // twice the error of one component. Differential decodes resume from coder
+    // state, so GRK_TILE_CACHE_ALL always decodes every bit plane
+    auto targetPrec = tileProcessor->getCodingParams()->codingParams_.dec_.targetPrecision_;
+    auto compPrec = tileProcessor->getHeaderImage()->comps[compno].prec;
+    uint8_t outputResno = (uint8_t)(tilec->nextPacketProgressionState_.numResolutionsRead() - 1);
+    double planeBudget = 0;
+    if(targetPrec && targetPrec < compPrec && !cacheAll && !tccp->roishift_ &&
+       !tccp->usesPart2Transform())
+    {
+      planeBudget = std::ldexp(1.0, compPrec - targetPrec) / (3 * outputResno + 1);
+      if(tileProcessor->needsMctDecompress(compno))
+        planeBudget /= 2;
+    }
+
     auto resBounds = rChecker.getResBounds(compno);
     uint8_t resno = resBounds.first;
     uint8_t resUpperBound = resBounds.second;
@@ -178,6 +372,10 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
       {
         auto band = res->band + bandIndex;
         auto paddedBandWindow = tilec->getBandWindowPadded(resno, band->orientation_);
+        uint8_t skipBitPlanes =
+            planeBudget > 0 ? skippableBitPlanes(planeBudget, tccp->qmfbid_ == 1, band->stepsize_,
+                                                 resno, outputResno, band->orientation_)
+                            : 0;
         for(auto precinct : band->precincts_)
         {
           if(!wholeTileDecoding && !paddedBandWindow->nonEmptyIntersection(precinct))
@@ -212,6 +410,7 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
               block->qShift = tilec->qShift();
               block->resno = resno;
               block->roishift = tccp->roishift_;
+              block->skipBitPlanes = skipBitPlanes;
               block->stepsize = band->stepsize_;
               block->k_msbs = (uint8_t)(band->maxBitPlanes_ - cblk->numbps());
               if(htBlock)
@@ -248,14 +447,39 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
     else
     {
       // 2. prepare for decompression
-      if(compno < 3)
+      componentsWithBlocks_++;
+      if(compno < 3 || customMct)
         mctCompHasBlocks++;
       if(imageComponentFlow_[compno])
         delete imageComponentFlow_[compno];
       imageComponentFlow_[compno] =
           new ImageComponentFlow(tilec->nextPacketProgressionState_.numResolutionsRead());
       if(!tileProcessor->getTile()->comps_->isWholeTileDecoding())
+      {
         imageComponentFlow_[compno]->setRegionDecompression();
+      }
+      else
+      {
+        // restore the resolution the skipped levels would produce, and copy out requested
+        // and kept lower resolutions, before the next level overwrites them
+        for(uint8_t r = 0; r + 1 < numResRead; ++r)
+        {
+          bool restore = firstLevel > 1 && r + 1 == firstLevel;
+          bool pyramid = tilec->wantsPyramidLevel(r);
+          bool keep = keepSynthesis && r >= firstLevel;
+          if(!restore && !pyramid && !keep)
+            continue;
+          auto captureFlow = imageComponentFlow_[compno]->getResflow(r)->getCaptureFlow();
+          captureFlow->nextTask().work([tilec, r, restore, pyramid, keep] {
+            if(restore)
+              tilec->restoreSynthesizedLevel(r);
+            if(pyramid)
+              tilec->capturePyramidLevel(r);
+            if(keep)
+              tilec->retainSynthesizedLevel(r);
+          });
+        }
+      }
 
       // 3. decompress
       success_ = true;
@@ -267,8 +491,10 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
       resFlow = imageComponentFlow_[compno]->resFlows_ + resno;
       for(auto& block : rblocks.blocks_)
       {
+        if(firstLevel > 1 && block && block->resno < firstLevel)
+          continue;
         auto blockFunc = [this, activePool, tileProcessor, &block, tccp, cbw, cbh, cacheAll,
-                          finalLayer] {
+                          finalLayer, codeblockCache, tileIndex, compno, tcp] {
           if(!success_)
           {
             block.reset();
@@ -276,6 +502,23 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
           else
           {
             block->finalLayer_ = finalLayer;
+            if(codeblockCache && !block->cblk->dataChunksEmpty())
+            {
+              CodeblockCacheKey key;
+              key.tileIndex = tileIndex;
+              key.compno = compno;
+              key.resno = block->resno;
+              key.bandIndex = block->bandIndex;
+              key.layers = tcp->layersToDecompress_;
+              key.skipBitPlanes = block->skipBitPlanes;
+              key.x0 = block->x;
+              key.y0 = block->y;
+              key.compressedLength = block->cblk->getDataChunksLength();
+              key.numSegments = block->cblk->getNumDataParsedSegments();
+              if(replayCachedBlock(codeblockCache, key, block.get()))
+                return;
+              recordBlock(codeblockCache, key, block.get());
+            }
             t1::ICoder* coder = nullptr;
             if(block->needsCachedCoder())
             {
@@ -320,7 +563,7 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
       graph(compno);
     }
     uint8_t numRes = tilec->nextPacketProgressionState_.numResolutionsRead();
-    if(numRes > 0)
+    if(numRes > 0 && !coefficientsOnly)
     {
       if(waveletReverse_[compno])
         delete waveletReverse_[compno];
@@ -345,7 +588,8 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
       bool wholeDecompress = tileProcessor->getTCP()->wholeTileDecompress_;
       DcShiftParam dcShift;
       // a Part 2 level may end without a vertical pass, so the shift stays standalone
-      bool fuseDcShift = numRes > 1 && wholeDecompress && !tccp->usesPart2Transform();
+      bool fuseDcShift =
+          numRes > 1 && wholeDecompress && !tccp->usesPart2Transform() && !customMct;
       if(fuseDcShift)
       {
         bool isMctComp = tileProcessor->needsMctDecompress(compno) && tcp->mct_ == 1;
@@ -375,10 +619,11 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
       const TransformKernel* kernel = nullptr;
       if(tccp->atkIndex_)
         kernel = &tcp->cp_->transformKernels_.at(tccp->atkIndex_);
-      waveletReverse_[compno] = new WaveletReverse(
-          tileProcessor->getScheduler(), tilec, compno, tilec->windowUnreducedBounds(), numRes,
-          (tcp->tccps_ + compno)->qmfbid_, maxDim, tileProcessor->getTCP()->wholeTileDecompress_,
-          &waveletPoolData_, dcShift, tccp, kernel);
+      waveletReverse_[compno] =
+          new WaveletReverse(this, tilec, compno, tilec->windowUnreducedBounds(), numRes,
+                             (tcp->tccps_ + compno)->qmfbid_, maxDim,
+                             tileProcessor->getTCP()->wholeTileDecompress_, &waveletPoolData_,
+                             dcShift, tccp, kernel, firstLevel);
 
       if(!waveletReverse_[compno]->decompress())
         return false;
@@ -388,15 +633,15 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
     auto imageComponentFlow = getImageComponentFlow(compno);
     if(imageComponentFlow)
     {
-      if(mctPostProc && compno < 3)
+      if(mctPostProc && (compno < 3 || customMct))
       {
         // link to MCT
         imageComponentFlow->getFinalFlowT1()->precede(*mctPostProc);
       }
       else if(doPostT1)
       {
-        // use with either custom MCT, or no MCT
-        if(!tileProcessor->needsMctDecompress(compno) || tcp->mct_ == 2)
+        // use with no MCT
+        if(!tileProcessor->needsMctDecompress(compno))
         {
           // standalone DC shift when wavelet didn't fuse it
           bool waveletFusedDc = numRes > 1 && tileProcessor->getTCP()->wholeTileDecompress_ &&
@@ -416,37 +661,47 @@ bool DecompressScheduler::scheduleT1(ITileProcessor* tileProcessor)
   }
 
   // sanity check on MCT scheduling
-  if(doPostT1 && numcomps_ >= 3 && mctPostProc && mctCompHasBlocks == 3)
+  // a group of a custom MCT tile leaves the transform to the tile processor
+  bool wholeRange = compBegin_ == 0 && compEnd_ == numcomps_;
+  if(customMct && mctCompHasBlocks == numcomps_)
+  {
+    // custom MCT applies the DC shift of every component
+    mct->schedule_decompress_custom(mctPostProc);
+  }
+  else if(doPostT1 && numcomps_ >= 3 && mctPostProc && !customMct && mctCompHasBlocks == 3)
   {
-    // custom MCT
-    if(tcp->mct_ == 2)
+    // DC shift is never fused into wavelet for MCT components,
+    // so MCT always handles DC shift
+    if(tcp->tccps_->qmfbid_ == 1)
     {
-      /*
-      auto data = new uint8_t*[tile->numcomps_];
-      for(uint16_t i = 0; i < tile->numcomps_; ++i)
-      {
-        auto tile_comp = tile->comps + i;
-        data[i] = (uint8_t*)tile_comp->getWindow()->getResWindowBufferHighestSimple().buf_;
-      }
-      uint64_t samples = tile->comps->getWindow()->stridedArea();
-      bool rc = Mct::decompress_custom((uint8_t*)tcp_->mct_decoding_matrix_, samples, data,
-                                      tile->numcomps_, headerImage->comps->sgnd);
-      return rc;
-      */
-      return false;
+      mct->schedule_decompress_rev(mctPostProc, true);
     }
     else
     {
-      // DC shift is never fused into wavelet for MCT components,
-      // so MCT always handles DC shift
-      if(tcp->tccps_->qmfbid_ == 1)
+      mct->schedule_decompress_irrev(mctPostProc, true);
+    }
+  }
+  else if(mctPostProc && (!customMct || wholeRange))
+  {
+    // the MCT is skipped when one of its components has no code blocks: the
+    // components that do still need the DC shift the MCT would have applied
+    bool warned = false;
+    for(uint16_t compno = compBegin_; compno < compEnd_; ++compno)
+    {
+      auto imageComponentFlow = getImageComponentFlow(compno);
+      if(!imageComponentFlow || !(compno < 3 || customMct))
+        continue;
+      if(!warned)
       {
-        mct->schedule_decompress_rev(mctPostProc, true);
+        grklog.warn("MCT components without code blocks - applying DC shift only");
+        warned = true;
       }
+      auto dcPostProc = imageComponentFlow->getPrePostProc(*this);
+      imageComponentFlow->getFinalFlowT1()->precede(*dcPostProc);
+      if((tcp->tccps_ + compno)->qmfbid_ == 1)
+        mct->schedule_decompress_dc_shift_rev(dcPostProc, compno);
       else
-      {
-        mct->schedule_decompress_irrev(mctPostProc, true);
-      }
+        mct->schedule_decompress_dc_shift_irrev(dcPostProc, compno);
     }
   }
 
@@ -53,6 +53,27 @@ public:
 
   void release(void) override;
 
+  /**
+   * @brief Restricts scheduling to components [begin, end), so that a tile's
+   * components can be decompressed a group at a time
+   *
+   * @param begin first component
+   * @param end one past the last component
+   */
+  void setComponentRange(uint16_t begin, uint16_t end);
+
+  /**
+   * @brief Gets the number of scheduled components that had code blocks
+   */
+  uint16_t numComponentsWithBlocks(void) const;
+
+  /**
+   * @brief Checks whether a scheduled component had code blocks
+   *
+   * @param compno component
+   */
+  bool componentHasBlocks(uint16_t compno);
+
 private:
   /**
    * @brief Generates a new @ref FlowComponet for pre/post processing
@@ -84,6 +105,17 @@ private:
   CoderPool coderPool_;
   CoderPool* streamPool_;
   WaveletPoolData waveletPoolData_;
+
+  /**
+   * @brief components [compBegin_, compEnd_) are scheduled
+   */
+  uint16_t compBegin_;
+  uint16_t compEnd_;
+
+  /**
+   * @brief scheduled components that had code blocks
+   */
+  uint16_t componentsWithBlocks_;
 };
 
 } // namespace grk
@@ -21,7 +21,7 @@ namespace grk
 {
 Resflow::Resflow(void)
     : blocks_(new FlowComponent()), waveletHoriz_(new FlowComponent()),
-      waveletVert_(new FlowComponent()), doWavelet_(true)
+      waveletVert_(new FlowComponent()), capture_(nullptr), doWavelet_(true)
 {}
 
 void Resflow::disableWavelet(void)
@@ -32,7 +32,15 @@ void Resflow::graph(void)
 {
   if(doWavelet_)
   {
-    blocks_->precede(*waveletHoriz_);
+    if(capture_)
+    {
+      blocks_->precede(*capture_);
+      capture_->precede(*waveletHoriz_);
+    }
+    else
+    {
+      blocks_->precede(*waveletHoriz_);
+    }
     waveletHoriz_->precede(*waveletVert_);
   }
 }
@@ -42,6 +50,8 @@ Resflow* Resflow::addTo(tf::Taskflow& composition)
   blocks_->addTo(composition);
   if(doWavelet_)
   {
+    if(capture_)
+      capture_->addTo(composition);
     waveletHoriz_->addTo(composition);
     waveletVert_->addTo(composition);
   }
@@ -70,11 +80,19 @@ FlowComponent* Resflow::getFinalFlowT1(void)
 {
   return doWavelet_ ? waveletVert_ : blocks_;
 }
+FlowComponent* Resflow::getCaptureFlow(void)
+{
+  if(!capture_)
+    capture_ = new FlowComponent();
+
+  return capture_;
+}
 Resflow::~Resflow(void)
 {
   delete blocks_;
   delete waveletHoriz_;
   delete waveletVert_;
+  delete capture_;
 }
 ImageComponentFlow::ImageComponentFlow(uint8_t numresolutions)
     : numResflows_(numresolutions), resFlows_(nullptr), waveletFinalCopy_(nullptr),
@@ -84,6 +84,14 @@ struct Resflow
    * @return FlowComponent*
    */
   FlowComponent* getFinalFlowT1(void);
+  /**
+   * @brief Gets the @ref FlowComponent that runs between this resolution's blocks and
+   * its horizontal wavelet, while the lower resolution it synthesizes from is still
+   * intact, creating it on first use
+   *
+   * @return FlowComponent*
+   */
+  FlowComponent* getCaptureFlow(void);
 
   /**
    * @brief blocks @ref FlowComponent
@@ -100,6 +108,11 @@ struct Resflow
    *
    */
   FlowComponent* waveletVert_;
+  /**
+   * @brief Lower resolution capture @ref FlowComponent (nullptr unless requested)
+   *
+   */
+  FlowComponent* capture_;
   /**
    * @brief if true, perform wavelet, otherwise do not perform wavelet
    *
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
@@ -85,6 +86,47 @@ public:
     }
   }
 
+  // Get an environment variable as a byte count: bytes, or with an M/MB or G/GB suffix
+  // (returns empty optional if unset or invalid)
+  static std::optional<uint64_t> get_size(const char* name)
+  {
+    auto value = get(name);
+    if(!value)
+    {
+      return std::nullopt;
+    }
+    std::string str = *value;
+    if(str.size() > 1 && (str.back() == 'B' || str.back() == 'b'))
+    {
+      str.pop_back();
+    }
+    uint64_t scale = 1;
+    char suffix = str.back();
+    if(suffix == 'M' || suffix == 'm')
+    {
+      scale = 1024 * 1024;
+    }
+    else if(suffix == 'G' || suffix == 'g')
+    {
+      scale = 1024 * 1024 * 1024;
+    }
+    if(scale > 1)
+    {
+      str.pop_back();
+    }
+    if(str.empty() || !std::isdigit(static_cast<unsigned char>(str[0])))
+    {
+      return std::nullopt;
+    }
+    char* end = nullptr;
+    auto bytes = std::strtoull(str.c_str(), &end, 10);
+    if(*end)
+    {
+      return std::nullopt;
+    }
+    return static_cast<uint64_t>(bytes) * scale;
+  }
+
   // Get an environment variable as a string (returns default_value if unset)
   static std::string get_string(const char* name, const std::string& default_value = "")
   {
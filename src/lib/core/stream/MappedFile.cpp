@@ -37,6 +37,7 @@
 #include "MemStream.h"
 #include "StreamGenerator.h"
 #include "BufferedStream.h"
+#include "MappedFile.h"
 
 namespace grk
 {
@@ -298,4 +299,46 @@ cleanup:
   return nullptr;
 }
 
+MappedFileView::~MappedFileView()
+{
+  if(view_ && unmap(view_, (size_t)len_))
+    grklog.error("Unmapping memory mapped file failed");
+}
+
+bool MappedFileView::open(const char* fname, [[maybe_unused]] GrkAccessPattern advice)
+{
+  if(view_)
+    return false;
+  grk_handle fd = open_fd(fname, "r");
+  if(fd == (grk_handle)-1)
+  {
+    grklog.error("Unable to open memory mapped file %s", fname);
+    return false;
+  }
+  uint64_t len = size_proc(fd);
+  void* view = len ? grk_map(fd, (size_t)len, true) : nullptr;
+  // the mapping keeps its own reference to the file
+  close_fd(fd);
+  if(!view)
+  {
+    grklog.error("Unable to map memory mapped file %s", fname);
+    return false;
+  }
+  view_ = view;
+  len_ = len;
+#ifndef _WIN32
+  try
+  {
+    MemAdvisor((uint8_t*)view_, (size_t)len_, 0).advise(0, 0, advice);
+  }
+  catch(const std::exception& e)
+  {
+    // advice is only a hint
+    grklog.warn("%s", e.what());
+  }
+#endif
+
+  return true;
+}
+
 } // namespace grk
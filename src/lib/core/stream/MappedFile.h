@@ -18,6 +18,7 @@
 #pragma once
 
 #include "grok.h"
+#include "IMemAdvisor.h"
 
 namespace grk
 {
@@ -27,4 +28,37 @@ struct IStream;
 IStream* createMappedFileReadStream(grk_stream_params* stream_param);
 IStream* create_mapped_file_write_stream(const char* fname);
 
+/**
+ * @class MappedFileView
+ * @brief Read-only mapping of an entire file, unmapped on destruction
+ */
+class MappedFileView
+{
+public:
+  MappedFileView() = default;
+  ~MappedFileView();
+  MappedFileView(const MappedFileView&) = delete;
+  MappedFileView& operator=(const MappedFileView&) = delete;
+
+  /**
+   * @brief Maps @p fname read-only
+   * @param fname file name
+   * @param advice expected access pattern for the whole mapping
+   * @return true if successful
+   */
+  bool open(const char* fname, GrkAccessPattern advice);
+  const uint8_t* data(void) const
+  {
+    return (const uint8_t*)view_;
+  }
+  uint64_t size(void) const
+  {
+    return len_;
+  }
+
+private:
+  void* view_ = nullptr;
+  uint64_t len_ = 0;
+};
+
 } // namespace grk
@@ -242,7 +242,8 @@ struct TPFetch : public DataSlice
   }
 
   uint16_t tileIndex_ = 0;
-  std::unique_ptr<uint8_t[]> data_;
+  // shared so that SharedTilePartCache can hand the same bytes to every codec
+  std::shared_ptr<uint8_t[]> data_;
   size_t fetchOffset_ = 0;
   std::unique_ptr<IStream> stream_;
 };
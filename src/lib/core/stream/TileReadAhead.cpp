@@ -0,0 +1,364 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "grk_fseek.h"
+#include "buffer.h"
+#include "CodeStreamLimits.h"
+#include "TileWindow.h"
+#include "Quantizer.h"
+#include "IStream.h"
+#include "StreamIO.h"
+#include "FetchCommon.h"
+#include "TPFetchSeq.h"
+#include "MemStream.h"
+#include "TileReadAhead.h"
+
+namespace grk
+{
+
+// size of the scratch reads that pull warm() ranges into the page cache
+static constexpr size_t kWarmChunk = 1024 * 1024;
+
+/**
+ * @class TileReadAhead::BufferPool
+ * @brief Recycles tile part buffers
+ *
+ * A buffer goes back to the pool when the last @ref TPFetch holding it lets
+ * go, so steady-state decoding allocates nothing. The pool outlives the
+ * reader while any buffer is still in use.
+ */
+class TileReadAhead::BufferPool : public std::enable_shared_from_this<BufferPool>
+{
+public:
+  explicit BufferPool(size_t maxFree) : maxFree_(maxFree) {}
+  ~BufferPool()
+  {
+    for(auto& b : free_)
+      delete[] b.first;
+  }
+
+  std::shared_ptr<uint8_t[]> acquire(size_t len)
+  {
+    uint8_t* buf = nullptr;
+    size_t capacity = len;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // best fit among free buffers
+      auto best = free_.end();
+      for(auto it = free_.begin(); it != free_.end(); ++it)
+      {
+        if(it->second >= len && (best == free_.end() || it->second < best->second))
+          best = it;
+      }
+      if(best != free_.end())
+      {
+        buf = best->first;
+        capacity = best->second;
+        free_.erase(best);
+      }
+    }
+    if(!buf)
+      buf = new uint8_t[capacity];
+    auto self = shared_from_this();
+    return std::shared_ptr<uint8_t[]>(buf,
+                                      [self, capacity](uint8_t* p) { self->release(p, capacity); });
+  }
+
+private:
+  void release(uint8_t* buf, size_t capacity)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(free_.size() < maxFree_)
+      {
+        free_.emplace_back(buf, capacity);
+        return;
+      }
+    }
+    delete[] buf;
+  }
+
+  size_t maxFree_;
+  std::mutex mutex_;
+  std::vector<std::pair<uint8_t*, size_t>> free_;
+};
+
+TileReadAhead::TileReadAhead(const std::string& path, GRK_CODEC_FORMAT format, uint16_t depth)
+    : path_(path), format_(format), depth_(depth),
+      pool_(std::make_shared<BufferPool>(2 * (size_t)depth + 2))
+{}
+
+TileReadAhead::~TileReadAhead()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  jobCv_.notify_all();
+  if(thread_.joinable())
+    thread_.join();
+  if(file_)
+    fclose(file_);
+}
+
+bool TileReadAhead::open(void)
+{
+  if(file_ || path_.empty() || !depth_)
+    return false;
+  file_ = fopen(path_.c_str(), "rb");
+  if(!file_)
+  {
+    grklog.warn("Tile read-ahead disabled: unable to open %s", path_.c_str());
+    return false;
+  }
+  thread_ = std::thread([this] { run(); });
+  return true;
+}
+
+void TileReadAhead::plan(const TPSEQ_VEC* allTileParts, std::vector<uint16_t> order)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::unordered_map<uint16_t, size_t> orderIndex;
+  for(size_t i = 0; i < order.size(); ++i)
+    orderIndex.emplace(order[i], i);
+  // drop everything from the old plan except the read in progress and, when the
+  // same tiles are merely reordered, the reads the new plan still wants;
+  // the next take() trims those to its window
+  auto keep = [&](int32_t tileIndex) {
+    return allTileParts_ == allTileParts && orderIndex.contains((uint16_t)tileIndex);
+  };
+  for(auto it = jobs_.begin(); it != jobs_.end();)
+  {
+    if(it->tileIndex >= 0 && !keep(it->tileIndex))
+      it = jobs_.erase(it);
+    else
+      ++it;
+  }
+  for(auto it = slots_.begin(); it != slots_.end();)
+  {
+    if(it->second.state != SlotState::READING && !keep(it->first))
+      it = slots_.erase(it);
+    else
+      ++it;
+  }
+  allTileParts_ = allTileParts;
+  order_ = std::move(order);
+  orderIndex_ = std::move(orderIndex);
+  // a new plan reads from wherever it starts, so nothing counts as warmed any more
+  warmedBegin_ = 0;
+  warmedEnd_ = 0;
+}
+
+void TileReadAhead::planSequential(const TPSEQ_VEC* allTileParts)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(allTileParts_ == allTileParts && order_.empty())
+      return;
+  }
+  plan(allTileParts, {});
+}
+
+void TileReadAhead::queueTile(uint16_t tileIndex)
+{
+  if(!allTileParts_ || tileIndex >= allTileParts_->size() || !(*allTileParts_)[tileIndex])
+    return;
+  if(!slots_.try_emplace(tileIndex).second)
+    return;
+  Job job;
+  job.tileIndex = tileIndex;
+  jobs_.push_back(job);
+  jobCv_.notify_one();
+}
+
+void TileReadAhead::dropJob(uint16_t tileIndex)
+{
+  for(auto job = jobs_.begin(); job != jobs_.end(); ++job)
+  {
+    if(job->tileIndex == (int32_t)tileIndex)
+    {
+      jobs_.erase(job);
+      return;
+    }
+  }
+}
+
+size_t TileReadAhead::numSlots(void)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return slots_.size();
+}
+
+std::shared_ptr<TPFetchSeq> TileReadAhead::take(uint16_t tileIndex)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // the tiles that follow this one
+  std::vector<uint16_t> window;
+  if(order_.empty())
+  {
+    for(uint32_t i = tileIndex + 1u; i <= (uint32_t)tileIndex + depth_ && i <= UINT16_MAX; ++i)
+      window.push_back((uint16_t)i);
+  }
+  else
+  {
+    auto pos = orderIndex_.find(tileIndex);
+    if(pos != orderIndex_.end())
+    {
+      for(size_t i = pos->second + 1; i < order_.size() && i <= pos->second + depth_; ++i)
+        window.push_back(order_[i]);
+    }
+  }
+
+  // drop what a caller skipping around left behind, so that the read-ahead
+  // never holds more than the window; a tile being read is dropped by a later take()
+  for(auto slot = slots_.begin(); slot != slots_.end();)
+  {
+    if(slot->first == tileIndex || slot->second.state == SlotState::READING ||
+       std::find(window.begin(), window.end(), slot->first) != window.end())
+    {
+      ++slot;
+      continue;
+    }
+    if(slot->second.state == SlotState::QUEUED)
+      dropJob(slot->first);
+    slot = slots_.erase(slot);
+  }
+  for(auto i : window)
+    queueTile(i);
+
+  auto it = slots_.find(tileIndex);
+  if(it == slots_.end())
+    return nullptr;
+  if(it->second.state == SlotState::QUEUED)
+  {
+    dropJob(tileIndex);
+    slots_.erase(it);
+    return nullptr;
+  }
+  doneCv_.wait(lock, [this, tileIndex] {
+    auto slot = slots_.find(tileIndex);
+    return stop_ || slot == slots_.end() || slot->second.state == SlotState::DONE;
+  });
+  it = slots_.find(tileIndex);
+  if(it == slots_.end())
+    return nullptr;
+  auto seq = std::move(it->second.seq);
+  slots_.erase(it);
+  return seq;
+}
+
+void TileReadAhead::warm(uint64_t offset, uint64_t length)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t end = offset + length;
+  // a seek back before, or forward past, the warmed run starts a new one
+  if(offset < warmedBegin_ || offset > warmedEnd_)
+  {
+    warmedBegin_ = offset;
+    warmedEnd_ = offset;
+  }
+  offset = std::max(offset, warmedEnd_);
+  if(offset >= end)
+    return;
+  warmedEnd_ = end;
+  Job job;
+  job.offset = offset;
+  job.length = end - offset;
+  jobs_.push_back(job);
+  jobCv_.notify_one();
+}
+
+void TileReadAhead::run(void)
+{
+  std::shared_ptr<uint8_t[]> scratch;
+  while(true)
+  {
+    Job job;
+    const TPSeq* tileParts = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobCv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+      if(stop_)
+        break;
+      job = jobs_.front();
+      jobs_.pop_front();
+      if(job.tileIndex >= 0)
+      {
+        auto slot = slots_.find((uint16_t)job.tileIndex);
+        if(slot == slots_.end())
+          continue;
+        slot->second.state = SlotState::READING;
+        tileParts = (*allTileParts_)[(uint16_t)job.tileIndex].get();
+      }
+    }
+    if(job.tileIndex < 0)
+    {
+      if(!scratch)
+        scratch = pool_->acquire(kWarmChunk);
+      for(uint64_t pos = 0; pos < job.length; pos += kWarmChunk)
+      {
+        auto len = std::min<uint64_t>(kWarmChunk, job.length - pos);
+        if(!readRange(job.offset + pos, scratch.get(), len))
+          break;
+      }
+      continue;
+    }
+    auto seq = readTile((uint16_t)job.tileIndex, *tileParts);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto slot = slots_.find((uint16_t)job.tileIndex);
+      if(slot != slots_.end())
+      {
+        slot->second.seq = std::move(seq);
+        slot->second.state = SlotState::DONE;
+      }
+    }
+    doneCv_.notify_all();
+  }
+  doneCv_.notify_all();
+}
+
+std::shared_ptr<TPFetchSeq> TileReadAhead::readTile(uint16_t tileIndex, const TPSeq& tileParts)
+{
+  auto seq = std::make_shared<TPFetchSeq>();
+  for(auto& part : tileParts)
+  {
+    auto fetch = std::make_shared<TPFetch>(part->offset_, part->length_, tileIndex);
+    fetch->data_ = pool_->acquire((size_t)part->length_);
+    if(!readRange(part->offset_, fetch->data_.get(), part->length_))
+      return nullptr;
+    fetch->fetchOffset_ = (size_t)part->length_;
+    fetch->stream_ = std::unique_ptr<IStream>(
+        memStreamCreate(fetch->data_.get(), (size_t)part->length_, format_, true));
+    if(!fetch->stream_)
+      return nullptr;
+    seq->SharedPtrSeq<TPFetch>::push_back(fetch);
+  }
+  return seq;
+}
+
+bool TileReadAhead::readRange(uint64_t offset, uint8_t* dest, uint64_t length)
+{
+  if(GRK_FSEEK(file_, (int64_t)offset, SEEK_SET))
+    return false;
+  return fread(dest, 1, (size_t)length, file_) == (size_t)length;
+}
+
+} // namespace grk
@@ -0,0 +1,166 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "grk_internal.h"
+
+namespace grk
+{
+
+struct TPSeq;
+struct TPFetchSeq;
+using TPSEQ_VEC = std::vector<std::unique_ptr<TPSeq>>;
+
+/**
+ * @class TileReadAhead
+ * @brief Reads the tile parts of upcoming tiles on a dedicated I/O thread
+ *
+ * Local decodes read tile data straight from the file (or its mapping), so
+ * on a cold page cache every tile stalls its decode on I/O - painful on
+ * network file systems. While tile N is in T2/T1/DWT, this reads the tile
+ * parts of the next tiles in decode order into pooled buffers, using the
+ * ranges already known from TLM. take() hands a tile's buffers back as a
+ * @ref TPFetchSeq backed by memory streams, exactly like a network fetch.
+ *
+ * Without TLM the ranges are unknown until the SOT markers are parsed, so
+ * warm() instead reads the bytes just beyond the parser position into a
+ * scratch buffer, which pulls them into the page cache.
+ */
+class GRK_INTERNAL TileReadAhead
+{
+public:
+  /**
+   * @brief Creates a TileReadAhead
+   * @param path file to read
+   * @param format codec format for the memory streams
+   * @param depth number of tiles to keep in flight ahead of the decoder
+   */
+  TileReadAhead(const std::string& path, GRK_CODEC_FORMAT format, uint16_t depth);
+  ~TileReadAhead();
+
+  /**
+   * @brief Opens the file and starts the I/O thread
+   * @return true if successful
+   */
+  bool open(void);
+
+  uint16_t depth(void) const
+  {
+    return depth_;
+  }
+
+  /**
+   * @brief Sets the tile parts and the order in which tiles will be taken
+   *
+   * Queued and completed reads from an earlier plan are dropped, unless the
+   * new plan reorders the same tile parts and still includes their tiles.
+   * @param allTileParts tile parts from TLM, indexed by tile
+   * @param order tile indices in decode order
+   */
+  void plan(const TPSEQ_VEC* allTileParts, std::vector<uint16_t> order);
+
+  /**
+   * @brief Plans for tiles taken one at a time in index order, as
+   * grk_decompress_tile() loops do. Keeps an existing sequential plan.
+   * @param allTileParts tile parts from TLM, indexed by tile
+   */
+  void planSequential(const TPSEQ_VEC* allTileParts);
+
+  /**
+   * @brief Takes the read-ahead data for a tile and queues the next tiles in
+   * the plan (the next tile indices, for a sequential plan)
+   *
+   * Waits if the tile is being read. A tile that is still queued is dropped
+   * instead, since the caller reads it faster itself. Tiles outside the new
+   * window that were queued or read ahead are dropped as well.
+   * @param tileIndex tile index
+   * @return sequence with buffers and memory streams, or nullptr if the
+   * tile was not read ahead
+   */
+  std::shared_ptr<TPFetchSeq> take(uint16_t tileIndex);
+
+  /**
+   * @brief Number of tiles queued, being read or read ahead
+   */
+  size_t numSlots(void);
+
+  /**
+   * @brief Pulls a byte range into the page cache, skipping what is already warmed
+   * @param offset file offset
+   * @param length number of bytes
+   */
+  void warm(uint64_t offset, uint64_t length);
+
+private:
+  enum class SlotState
+  {
+    QUEUED,
+    READING,
+    DONE
+  };
+  struct Slot
+  {
+    SlotState state = SlotState::QUEUED;
+    std::shared_ptr<TPFetchSeq> seq;
+  };
+  struct Job
+  {
+    int32_t tileIndex = -1; // -1 for warm jobs
+    uint64_t offset = 0;
+    uint64_t length = 0;
+  };
+  class BufferPool;
+
+  void queueTile(uint16_t tileIndex);
+  void dropJob(uint16_t tileIndex);
+  void run(void);
+  std::shared_ptr<TPFetchSeq> readTile(uint16_t tileIndex, const TPSeq& tileParts);
+  bool readRange(uint64_t offset, uint8_t* dest, uint64_t length);
+
+  std::string path_;
+  GRK_CODEC_FORMAT format_;
+  uint16_t depth_;
+  FILE* file_ = nullptr;
+  std::shared_ptr<BufferPool> pool_;
+
+  std::mutex mutex_;
+  std::condition_variable jobCv_;
+  std::condition_variable doneCv_;
+  std::deque<Job> jobs_;
+  std::unordered_map<uint16_t, Slot> slots_;
+  const TPSEQ_VEC* allTileParts_ = nullptr;
+  std::vector<uint16_t> order_;
+  std::unordered_map<uint16_t, size_t> orderIndex_;
+  uint64_t warmedBegin_ = 0;
+  uint64_t warmedEnd_ = 0;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+} // namespace grk
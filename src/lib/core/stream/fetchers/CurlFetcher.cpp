@@ -19,6 +19,8 @@
 
 #ifdef GRK_ENABLE_LIBCURL
 
+#include <cctype>
+
 #include "Logger.h"
 #include "TPFetchSeq.h"
 
@@ -354,6 +356,9 @@ void CurlFetcher::fetch_total_size()
   curl_easy_setopt(curl, CURLOPT_URL, url_.c_str());
   curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
   curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+  etag_.clear();
+  curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+  curl_easy_setopt(curl, CURLOPT_HEADERDATA, &etag_);
   auth(curl);
 
   auto headers = configureHeaders("");
@@ -394,11 +399,47 @@ void CurlFetcher::fetch_total_size()
   {
     grklog.warn("Last modified time not available from server");
   }
+  if(!etag_.empty())
+    grklog.debug("Fetched ETag: %s", etag_.c_str());
 
   curl_easy_cleanup(curl);
   curl_slist_free_all(headers);
 }
 
+size_t CurlFetcher::headerCallback(char* buffer, size_t size, size_t nitems, std::string* etag)
+{
+  size_t len = size * nitems;
+  static const char name[] = "etag:";
+  const size_t nameLen = sizeof(name) - 1;
+  if(len <= nameLen)
+    return len;
+  for(size_t i = 0; i < nameLen; ++i)
+  {
+    if(std::tolower((unsigned char)buffer[i]) != name[i])
+      return len;
+  }
+  size_t begin = nameLen;
+  size_t end = len;
+  while(begin < end && std::isspace((unsigned char)buffer[begin]))
+    ++begin;
+  while(end > begin && std::isspace((unsigned char)buffer[end - 1]))
+    --end;
+  etag->assign(buffer + begin, end - begin);
+  return len;
+}
+
+std::string CurlFetcher::identity() const
+{
+  std::string validator;
+  if(!etag_.empty())
+    validator = etag_;
+  else if(last_modified_time_ != -1)
+    validator = std::to_string((long long)last_modified_time_);
+  else
+    return {};
+  return url_ + '|' + std::to_string(total_size_) + '|' + validator;
+}
+
 CURL* CurlFetcher::configureHandle(uint64_t offset, uint64_t end, FetchResult& result,
                                    CURL_FETCHER_WRITE_CALLBACK callback)
 {
@@ -710,6 +751,14 @@ void CurlFetcher::fetchWorker()
 
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &result->responseCode_);
         result->success_ = (msg->data.result == CURLE_OK && result->responseCode_ == 206);
+        if(result->success_)
+        {
+          curl_off_t firstByteUs = 0, totalUs = 0, bytes = 0;
+          curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &firstByteUs);
+          curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &totalUs);
+          curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+          linkStats_.record((double)firstByteUs / 1e6, (double)totalUs / 1e6, (uint64_t)bytes);
+        }
 
         size_t idx = 0;
         {
@@ -88,6 +88,21 @@ public:
   virtual void notifyThrottleRelease() = 0;
 
   virtual void setBatchSize(size_t batchSize) = 0;
+
+  // Identity of the resource version: stable across fetcher instances for the
+  // same unchanged resource, empty if the version cannot be established.
+  // Keys the process-wide SharedTilePartCache.
+  virtual std::string identity() const
+  {
+    return {};
+  }
+
+  // Gap (bytes) below which neighbouring byte ranges are cheaper to fetch as one
+  // request, from measured latency and transfer rate; 0 if nothing is measured
+  virtual uint64_t rangeGapThreshold() const
+  {
+    return 0;
+  }
 };
 
 struct TileFetchContext : public std::enable_shared_from_this<TileFetchContext>
@@ -140,6 +155,19 @@ public:
     return current_offset_;
   }
 
+  /**
+   * @brief Identity of the fetched resource: URL, size and ETag, falling back
+   * to the modification time when the server sends no ETag
+   *
+   * @return identity, or empty if the server sends neither validator
+   */
+  std::string identity() const override;
+
+  uint64_t rangeGapThreshold() const override
+  {
+    return linkStats_.gapThreshold();
+  }
+
   /**
    * @brief Initiates tile fetch by creating an @ref FetchJob and pushing this
    * onto the tile fetch queue
@@ -276,6 +304,11 @@ protected:
     return size * nmemb;
   }
 
+  /**
+   * @brief HEAD response header callback: captures the ETag
+   */
+  static size_t headerCallback(char* buffer, size_t size, size_t nitems, std::string* etag);
+
   FetchAuth auth_;
   std::string url_;
   std::mutex queue_mutex_;
@@ -306,6 +339,8 @@ protected:
   TileFetchCallback tileFetchCallback_;
   const TPSEQ_VEC* allTileParts_ = nullptr;
   time_t last_modified_time_ = -1;
+  std::string etag_;
+  FetchLinkStats linkStats_;
 
 private:
   CURL_FETCHER_WRITE_CALLBACK tileWriteCallback_;
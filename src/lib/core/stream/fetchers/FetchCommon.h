@@ -24,6 +24,8 @@
 #include <set>
 #include <future>
 #include <functional>
+#include <mutex>
+#include <algorithm>
 
 #include "ChunkBuffer.h"
 
@@ -113,6 +115,64 @@ struct FetchResult
   curl_slist* headers_ = nullptr;
 };
 
+/**
+ * @struct FetchLinkStats
+ * @brief Running estimate of range request latency and transfer rate
+ *
+ * Fed from completed requests. The gap threshold is the number of bytes that
+ * transfer in the time one request round trip costs: two ranges separated by a
+ * smaller gap are cheaper to fetch as one request.
+ */
+struct FetchLinkStats
+{
+  static constexpr uint64_t kDefaultGap = 32 * 1024;
+  static constexpr uint64_t kMinGap = 4 * 1024;
+  static constexpr uint64_t kMaxGap = 1024 * 1024;
+
+  /**
+   * @brief Records one completed request
+   * @param firstByteSec time from request start to first response byte
+   * @param totalSec total request time
+   * @param bytes bytes received
+   */
+  void record(double firstByteSec, double totalSec, uint64_t bytes)
+  {
+    if(firstByteSec <= 0 || totalSec < firstByteSec)
+      return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    latencySec_ = latencySamples_++ ? latencySec_ + kWeight * (firstByteSec - latencySec_)
+                                    : firstByteSec;
+    // small bodies say nothing about throughput
+    double transferSec = totalSec - firstByteSec;
+    if(bytes < kMinRateSampleBytes || transferSec < 1e-3)
+      return;
+    double rate = (double)bytes / transferSec;
+    bytesPerSec_ = rateSamples_++ ? bytesPerSec_ + kWeight * (rate - bytesPerSec_) : rate;
+  }
+
+  /**
+   * @brief Gap below which adjacent ranges should be merged
+   * @return threshold in bytes, @ref kDefaultGap until both latency and rate are measured
+   */
+  uint64_t gapThreshold(void) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(!latencySamples_ || !rateSamples_)
+      return kDefaultGap;
+    return std::clamp<uint64_t>((uint64_t)(latencySec_ * bytesPerSec_), kMinGap, kMaxGap);
+  }
+
+private:
+  static constexpr double kWeight = 0.2;
+  static constexpr uint64_t kMinRateSampleBytes = 64 * 1024;
+
+  mutable std::mutex mutex_;
+  double latencySec_ = 0;
+  double bytesPerSec_ = 0;
+  uint64_t latencySamples_ = 0;
+  uint64_t rateSamples_ = 0;
+};
+
 // Job struct for tile fetch queue
 struct FetchJob
 {
@@ -73,7 +73,12 @@ struct DecompressBlockExec : public BlockExec
     auto activeCoder = cachedCoder_ ? cachedCoder_ : coder;
     if(!activeCoder)
       return false;
-    bool rc = activeCoder->decompress(this);
+    // a cached coder still holds the coefficients of its last decompress, so a block
+    // whose packets added no coding passes since then only has to write them out again
+    bool rc = cachedCoder_ && !cblk->hasUndecompressedPasses() ? activeCoder->replay(this)
+                                                               : activeCoder->decompress(this);
+    if(rc && shouldCacheCoder_)
+      cblk->markDecompressed();
     if(needsCachedCoder())
       cachedCoder_ = coder;
 
@@ -99,6 +104,8 @@ struct DecompressBlockExec : public BlockExec
   CodeblockDecompress* cblk = nullptr;
   uint8_t resno = 0;
   uint8_t roishift = 0;
+  // least significant bit planes the target output precision never needs
+  uint8_t skipBitPlanes = 0;
   ICoder* cachedCoder_ = nullptr;
   bool shouldCacheCoder_ = false;
   bool finalLayer_ = false;
@@ -147,6 +154,19 @@ struct CompressBlockExec : public BlockExec
    */
   uint16_t earlyStopSlope = 0;
 
+  /**
+   * @brief HT rate control: code the block again with @ref htDroppedPlanes least
+   * significant bit planes dropped, recording the result in its HT truncations
+   */
+  bool htRecode = false;
+  uint8_t htDroppedPlanes = 0;
+
+  /**
+   * @brief Codeblock transcoding: the block holds Part 1 coefficients, which the HT
+   * cleanup pass codes with the bit planes the Part 1 block never reached dropped
+   */
+  bool htTranscode = false;
+
   // Delete copy constructor and assignment operator
   CompressBlockExec(const CompressBlockExec&) = delete;
   CompressBlockExec& operator=(const CompressBlockExec&) = delete;
@@ -42,6 +42,12 @@ public:
    * @param pointer to @ref DecompressBlockExec
    */
   virtual bool decompress(DecompressBlockExec* block) = 0;
+
+  /**
+   * @brief write out the coefficients kept from the code block's last decompress
+   * @param pointer to @ref DecompressBlockExec
+   */
+  virtual bool replay(DecompressBlockExec* block) = 0;
 };
 
 } // namespace grk::t1
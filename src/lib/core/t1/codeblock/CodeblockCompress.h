@@ -165,6 +165,30 @@ struct CodeblockCompress : public Codeblock
   {
     getImpl()->setNumPassesInPreviousLayers(numPasses);
   }
+  /**
+   * @brief Gets the HT truncations considered by rate control, see @ref HTTruncation
+   */
+  std::vector<HTTruncation>& getHTTruncations(void)
+  {
+    return getImpl()->getHTTruncations();
+  }
+  /**
+   * @brief Lays out the HT truncations as coding passes for rate control
+   * @param codedOnly only offer truncations whose coded length is known
+   * @param droppedPlanes receives the bit planes dropped by each pass
+   * @return number of passes
+   */
+  uint8_t setHTPasses(bool codedOnly, uint8_t* droppedPlanes)
+  {
+    return getImpl()->setHTPasses(codedOnly, droppedPlanes);
+  }
+  /**
+   * @brief Gets the number of bytes the padded compressed stream can hold
+   */
+  uint32_t getCompressedStreamCapacity(void)
+  {
+    return (uint32_t)getCompressedStream()->num_elts();
+  }
   CodeblockCompressImpl* getImpl(void)
   {
     if(!impl_)
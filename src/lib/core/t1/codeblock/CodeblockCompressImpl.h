@@ -18,6 +18,7 @@
 #pragma once
 
 #include <algorithm>
+#include <vector>
 #include "CodeblockImpl.h"
 const uint8_t grk_cblk_enc_compressed_data_pad_left = 2;
 
@@ -94,6 +95,34 @@ struct Layer
   uint8_t* data;
 };
 
+/**
+ * @struct HTTruncation
+ * @brief HT cleanup pass coded with some least significant bit planes dropped
+ *
+ * HT code blocks have a single cleanup pass, so rate control chooses among truncations
+ * of that pass instead of among coding passes. A block's truncations are indexed by the
+ * number of bit planes they drop.
+ */
+struct HTTruncation
+{
+  /**
+   * @brief distortion decrease over leaving the code block out
+   */
+  double distortiondec = 0;
+  /**
+   * @brief length in bytes: an estimate until the truncation has been coded
+   */
+  uint16_t len = 0;
+  /**
+   * @brief true once @ref len is the coded length
+   */
+  bool coded = false;
+  /**
+   * @brief offset of the coded bytes in the compressed stream, or -1 if not kept
+   */
+  int32_t offset = -1;
+};
+
 struct CodeblockCompressImpl : public CodeblockImpl
 {
   explicit CodeblockCompressImpl(uint16_t numLayers)
@@ -179,6 +208,42 @@ struct CodeblockCompressImpl : public CodeblockImpl
   {
     numPassesInPreviousPackets = numPasses;
   }
+  std::vector<HTTruncation>& getHTTruncations(void)
+  {
+    return htTruncations_;
+  }
+  /**
+   * @brief Lays out the HT truncations as coding passes for rate control, from the one
+   * dropping the most bit planes to the full cleanup pass
+   *
+   * @param codedOnly only offer truncations whose coded length is known
+   * @param droppedPlanes receives the bit planes dropped by each pass
+   * @return number of passes
+   */
+  uint8_t setHTPasses(bool codedOnly, uint8_t* droppedPlanes)
+  {
+    uint8_t numPasses = 0;
+    uint16_t rate = 0;
+    for(auto d = (int32_t)htTruncations_.size() - 1; d >= 0; --d)
+    {
+      const auto& t = htTruncations_[(size_t)d];
+      if(codedOnly && !t.coded)
+        continue;
+      auto pass = passes + numPasses;
+      // coarser truncations are estimated, so keep the rates monotone
+      pass->len_ = (uint16_t)(std::max(t.len, rate) - rate);
+      rate = (uint16_t)(rate + pass->len_);
+      pass->rate_ = rate;
+      pass->distortiondec_ = t.distortiondec;
+      pass->term_ = false;
+      pass->slope_ = 0;
+      droppedPlanes[numPasses++] = (uint8_t)d;
+    }
+    if(numPasses)
+      passes[numPasses - 1].term_ = true;
+    totalPasses_ = numPasses;
+    return numPasses;
+  }
 
 private:
   uint8_t* paddedCompressedStream;
@@ -186,6 +251,7 @@ private:
   CodePass* passes;
   uint8_t numPassesInPreviousPackets;
   uint8_t totalPasses_; /* total number of passes in all layers */
+  std::vector<HTTruncation> htTruncations_;
 #ifdef PLUGIN_DEBUG_ENCODE
   uint32_t* context_stream;
 #endif
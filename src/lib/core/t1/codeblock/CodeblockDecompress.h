@@ -42,6 +42,10 @@ struct CodeblockDecompress : public Codeblock
   {
     getImpl()->setNumBps(bps);
   }
+  void setSkipBitPlanes(uint8_t skip)
+  {
+    getImpl()->setSkipBitPlanes(skip);
+  }
   uint8_t numlenbits()
   {
     return getImpl()->numlenbits();
@@ -83,6 +87,14 @@ struct CodeblockDecompress : public Codeblock
   {
     return getImpl()->getNumDataParsedSegments();
   }
+  bool hasUndecompressedPasses(void)
+  {
+    return getImpl()->hasUndecompressedPasses();
+  }
+  void markDecompressed(void)
+  {
+    getImpl()->markDecompressed();
+  }
   CodeblockDecompressImpl::HTSetLayout htSetLayout(void)
   {
     return getImpl()->htSetLayout();
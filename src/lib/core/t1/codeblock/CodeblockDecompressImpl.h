@@ -172,8 +172,8 @@ struct CodeblockDecompressImpl : public CodeblockImpl
   CodeblockDecompressImpl(uint16_t numLayers)
       : CodeblockImpl(numLayers), numDataParsedSegments_(0), numDecompressedSegments_(0),
         buffers_(nullptr), buffer_lengths_(nullptr), num_buffers_(0), bitPlanesToDecompress_(0),
-        passtype_(2), compressDataOffset_(0), passno_(0), needsSegInit_(true),
-        needsSegUpdate_(false), dataParsedLayers_(0)
+        skipBitPlanes_(0), passtype_(2), compressDataOffset_(0), passno_(0), needsSegInit_(true),
+        needsSegUpdate_(false), dataParsedLayers_(0), decompressedPasses_(0)
   {}
   /**
    * @brief Destroys a CodeblockDecompressImpl
@@ -218,6 +218,14 @@ struct CodeblockDecompressImpl : public CodeblockImpl
     numbps_ = bps;
     bitPlanesToDecompress_ = bps;
   }
+  /**
+   * @brief Sets number of least significant bit planes left undecoded
+   * @param skip number of bit planes
+   */
+  void setSkipBitPlanes(uint8_t skip)
+  {
+    skipBitPlanes_ = skip;
+  }
   /**
    * @brief Gets segment for the specified index
    * If index equals number of segments, then a new
@@ -640,8 +648,8 @@ struct CodeblockDecompressImpl : public CodeblockImpl
 
   bool canDecompress(void)
   {
-    return bitPlanesToDecompress_ != 0 && numDecompressedSegments_ != numDataParsedSegments_ &&
-           !dataChunksEmpty();
+    return bitPlanesToDecompress_ > skipBitPlanes_ &&
+           numDecompressedSegments_ != numDataParsedSegments_ && !dataChunksEmpty();
   }
 
   /**
@@ -681,7 +689,7 @@ struct CodeblockDecompressImpl : public CodeblockImpl
 
     coder->decompressInitOrientation(orientation);
     auto segEnd = toBeDecompressedEnd();
-    while(bitPlanesToDecompress_ > 0 && seg != segEnd)
+    while(bitPlanesToDecompress_ > skipBitPlanes_ && seg != segEnd)
     {
       /* BYPASS mode */
       uint8_t type = ((cblksty & GRK_CBLKSTY_LAZY) && numbps_ >= 4 &&
@@ -705,7 +713,7 @@ struct CodeblockDecompressImpl : public CodeblockImpl
       }
       needsSegUpdate_ = false;
 
-      while(passno_ < (*seg)->totalPasses_ && bitPlanesToDecompress_ > 0)
+      while(passno_ < (*seg)->totalPasses_ && bitPlanesToDecompress_ > skipBitPlanes_)
       {
         coder->decompressPass(passno_, passtype_, bitPlanesToDecompress_, type, cblksty);
         if(++passtype_ == 3)
@@ -721,11 +729,12 @@ struct CodeblockDecompressImpl : public CodeblockImpl
          seg == segBegin + numDataParsedSegments_ - 1)
         break;
 
-      // force end of segment when bitPlanesToDecompress_ reaches zero
-      if((passno_ == (*seg)->totalPasses_ || bitPlanesToDecompress_ == 0))
+      // force end of segment when bitPlanesToDecompress_ reaches the skipped bit planes
+      if((passno_ == (*seg)->totalPasses_ || bitPlanesToDecompress_ <= skipBitPlanes_))
         nextToBeDecompressedSegment(seg);
     }
-    coder->decompressFinish(cblksty, dataParsedLayers_ == numLayers_);
+    // a decode that stops above the skipped bit planes leaves the code word unfinished
+    coder->decompressFinish(cblksty, dataParsedLayers_ == numLayers_ && !skipBitPlanes_);
     needsSegUpdate_ = true;
 
     return true;
@@ -769,6 +778,31 @@ struct CodeblockDecompressImpl : public CodeblockImpl
   {
     return numDataParsedSegments_;
   }
+  /**
+   * @brief Gets number of coding passes whose layer data has been parsed
+   * @return number of passes
+   */
+  uint16_t getNumDataParsedPasses(void) const
+  {
+    return std::accumulate(
+        segs_.begin(), segs_.begin() + numDataParsedSegments_, (uint16_t)0,
+        [](uint16_t s, const Segment* seg) { return (uint16_t)(s + seg->totalPasses_); });
+  }
+  /**
+   * @brief Checks whether packets parsed since the last decompress added coding passes
+   * @return true if the block has passes that have not been decompressed
+   */
+  bool hasUndecompressedPasses(void) const
+  {
+    return getNumDataParsedPasses() != decompressedPasses_;
+  }
+  /**
+   * @brief Records that every parsed coding pass has been decompressed
+   */
+  void markDecompressed(void)
+  {
+    decompressedPasses_ = getNumDataParsedPasses();
+  }
   /**
    * @brief Gets iterator pointing to current segment whose layer data is being parsed
    * @return std::vector<Segment>::iterator
@@ -938,6 +972,10 @@ private:
    * @brief Remaining bit planes to decompress
    */
   uint8_t bitPlanesToDecompress_;
+  /**
+   * @brief Least significant bit planes left undecoded
+   */
+  uint8_t skipBitPlanes_;
   /**
    * @brief Type of pass: cleanup, magnitude refinement or significance propagation
    */
@@ -963,6 +1001,10 @@ private:
    * @brief number of layers whose data has been parsed
    */
   uint16_t dataParsedLayers_;
+  /**
+   * @brief number of parsed coding passes at the last decompress
+   */
+  uint16_t decompressedPasses_;
 };
 
 } // namespace grk::t1
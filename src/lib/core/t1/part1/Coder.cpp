@@ -165,6 +165,7 @@ bool Coder::decompress(DecompressBlockExec* block)
   // 1. allocate
   blockCoder_->setFinalLayer(block->finalLayer_);
   auto cblk = block->cblk;
+  cblk->setSkipBitPlanes(block->skipBitPlanes);
   // 2. decompress
   if(!blockCoder_->decompress_cblk(cblk, block->bandOrientation, block->cblk_sty))
     return false;
@@ -174,5 +175,12 @@ bool Coder::decompress(DecompressBlockExec* block)
 
   return true;
 }
+bool Coder::replay(DecompressBlockExec* block)
+{
+  if(block->postProcessor_)
+    block->postProcessor_(blockCoder_->getUncompressedData(), block, 0);
+
+  return true;
+}
 
 } // namespace  grk::t1::part1
@@ -34,6 +34,7 @@ public:
 
   bool compress(CompressBlockExec* block) override;
   bool decompress(DecompressBlockExec* block) override;
+  bool replay(DecompressBlockExec* block) override;
 
 private:
   bool preCompress(CompressBlockExec* block, uint32_t& max);
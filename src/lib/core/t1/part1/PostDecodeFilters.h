@@ -18,7 +18,9 @@
 #pragma once
 
 #include <cstdint>
+#include <type_traits>
 #include "BlockExec.h"
+#include "BlockCoderSIMD.h"
 
 namespace grk::t1
 {
@@ -53,8 +55,15 @@ public:
   ShiftFilter([[maybe_unused]] DecompressBlockExec* block) {}
   inline void copy(T* dest, const T* src, uint32_t len)
   {
-    for(uint32_t i = 0; i < len; ++i)
-      dest[i] = src[i] / 2;
+    if constexpr(std::is_same_v<T, int32_t>)
+    {
+      hwy_t1_halve_i32(dest, src, len);
+    }
+    else
+    {
+      for(uint32_t i = 0; i < len; ++i)
+        dest[i] = src[i] / 2;
+    }
   }
 };
 
@@ -92,8 +101,15 @@ public:
   ScaleFilter(DecompressBlockExec* block) : scale(block->stepsize / 2) {}
   inline void copy(T* dest, const T* src, uint32_t len)
   {
-    for(uint32_t i = 0; i < len; ++i)
-      ((float*)dest)[i] = (float)src[i] * scale;
+    if constexpr(std::is_same_v<T, int32_t>)
+    {
+      hwy_t1_scale_i32_to_f32((float*)dest, src, len, scale);
+    }
+    else
+    {
+      for(uint32_t i = 0; i < len; ++i)
+        ((float*)dest)[i] = (float)src[i] * scale;
+    }
   }
 
 private:
@@ -107,8 +123,7 @@ public:
   NarrowShiftFilter([[maybe_unused]] DecompressBlockExec* block) {}
   inline void copy(int16_t* dest, const int32_t* src, uint32_t len)
   {
-    for(uint32_t i = 0; i < len; ++i)
-      dest[i] = (int16_t)(src[i] / 2);
+    hwy_t1_halve_i32_to_i16(dest, src, len);
   }
 };
 
@@ -157,17 +172,8 @@ public:
   {}
   inline void copy(int16_t* dest, const int32_t* src, uint32_t len)
   {
-    for(uint32_t i = 0; i < len; ++i)
-    {
-      float val = (float)src[i] * scale_;
-      // Round to nearest and clamp to int16 range
-      int32_t rounded = (int32_t)(val >= 0 ? val + 0.5f : val - 0.5f);
-      if(rounded > 32767)
-        rounded = 32767;
-      else if(rounded < -32768)
-        rounded = -32768;
-      dest[i] = (int16_t)rounded;
-    }
+    // Round to nearest and clamp to int16 range
+    hwy_t1_scale_i32_to_i16(dest, src, len, scale_);
   }
 
 private:
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "grk_internal.h"
 #include "t1_common.h"
 #include "CodeblockCompress.h"
 #include "CodeblockDecompress.h"
@@ -24,8 +25,21 @@
 namespace grk::t1
 {
 
+// exported hook for grk_t1_bench: encodes a synthetic code block, then times
+// each Part-1 decode pass type over iters single-threaded decodes and checks
+// that the last decode reconstructs the block exactly. Returns best seconds
+// per whole code block decode, storing that run's significance propagation,
+// magnitude refinement and cleanup times in passSeconds[0..2], or a negative
+// value on failure or mismatch.
+extern "C" GRK_INTERNAL double grk_bench_t1_passes(uint16_t width, uint16_t height,
+                                                   uint32_t cblksty, uint32_t density,
+                                                   uint32_t iters, double* passSeconds);
+
 class BlockCoder
 {
+  // the bench hook drives the decode passes itself, so it resets the MQ coder
+  friend double grk_bench_t1_passes(uint16_t, uint16_t, uint32_t, uint32_t, uint32_t, double*);
+
 public:
   BlockCoder(bool isCompressor, uint16_t maxCblkW, uint16_t maxCblkH, uint32_t cacheStrategy);
   ~BlockCoder();
@@ -15,10 +15,18 @@
  *
  */
 
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
 #include "CodeblockDecompress.h"
 #include "t1_luts.h"
 #include "BlockCoder.h"
 #include "BlockCoderMacros.h"
+#include "BlockCoderSIMD.h"
 
 namespace grk::t1
 {
@@ -729,4 +737,134 @@ void BlockCoder::dec_clnpass_diff_final(int8_t bpno, uint8_t passno, uint8_t pas
   checkSegSym(cblksty);
 }
 
+namespace
+{
+  /* forwards a code block decode to the block coder, timing each pass by type */
+  struct PassTimer
+  {
+    BlockCoder* coder;
+    double seconds[3] = {};
+
+    void decompressRestore(uint8_t* passno, uint8_t* passtype, uint8_t* numBpsToDecompress)
+    {
+      coder->decompressRestore(passno, passtype, numBpsToDecompress);
+    }
+    void decompressInitOrientation(uint8_t orientation)
+    {
+      coder->decompressInitOrientation(orientation);
+    }
+    void decompressInitSegment(uint8_t type, uint8_t** buffers, uint32_t* buffer_lengths,
+                               uint16_t num_buffers)
+    {
+      coder->decompressInitSegment(type, buffers, buffer_lengths, num_buffers);
+    }
+    void decompressUpdateSegment(uint8_t** buffers, uint32_t* buffer_lengths, uint16_t num_buffers)
+    {
+      coder->decompressUpdateSegment(buffers, buffer_lengths, num_buffers);
+    }
+    bool decompressPass(uint8_t passno, uint8_t passtype, uint8_t numBpsToDecompress, uint8_t type,
+                        uint32_t cblksty)
+    {
+      auto start = std::chrono::steady_clock::now();
+      bool rc = coder->decompressPass(passno, passtype, numBpsToDecompress, type, cblksty);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      seconds[passtype] += elapsed.count();
+      return rc;
+    }
+    void decompressFinish(uint32_t cblksty, bool finalLayer)
+    {
+      coder->decompressFinish(cblksty, finalLayer);
+    }
+  };
+} // namespace
+
+extern "C" double grk_bench_t1_passes(uint16_t width, uint16_t height, uint32_t cblksty,
+                                      uint32_t density, uint32_t iters, double* passSeconds)
+{
+  if(!width || !height || width > 1024 || height > 1024 || (uint32_t)width * height > 4096)
+    return -1.0;
+  const uint32_t area = (uint32_t)width * height;
+
+  // synthetic coefficients: density percent of the samples are non-zero,
+  // with magnitudes of up to 11 bits
+  std::vector<int32_t> samples(area);
+  BlockCoder compressor(true, width, height, 0);
+  if(!compressor.alloc(width, height))
+    return -1.0;
+  auto uncompressed = compressor.getUncompressedData();
+  uint32_t seed = 0x9E3779B9U;
+  uint32_t max = 0;
+  for(uint32_t i = 0; i < area; ++i)
+  {
+    seed = seed * 1664525U + 1013904223U;
+    int32_t val = 0;
+    if((seed >> 8) % 100 < density)
+      val = (int32_t)((seed >> 12) & 0x7FF) - 0x400;
+    samples[i] = val;
+    int32_t scaled = val * (1 << T1_NMSEDEC_FRACBITS);
+    max = std::max(max, (uint32_t)std::abs(scaled));
+    uncompressed[i] = (int32_t)to_smr(scaled);
+  }
+  std::vector<uint8_t> compressed((size_t)area * 8 + 1024);
+  cblk_enc cblk = {};
+  cblk.data = compressed.data() + 1; // the MQ coder writes one byte before the code word
+  cblk.x1 = width;
+  cblk.y1 = height;
+  compressor.compress_cblk(&cblk, max, 0, 0, 0, 1, 1.0, cblksty, nullptr, 0, false);
+  uint8_t numPasses = cblk.numPassesTotal;
+  uint8_t numbps = cblk.numbps;
+  std::vector<int32_t> segLens;
+  int32_t dataLen = 0;
+  for(uint8_t passno = 0; passno < numPasses; ++passno)
+  {
+    auto pass = cblk.getPass(passno);
+    if(pass->term || passno == numPasses - 1)
+    {
+      segLens.push_back((int32_t)pass->rate - dataLen);
+      dataLen = (int32_t)pass->rate;
+    }
+  }
+  compressor.code_block_enc_deallocate(&cblk);
+  if(!numPasses)
+    return -1.0;
+
+  BlockCoder decompressor(false, width, height, 0);
+  double best = std::numeric_limits<double>::max();
+  iters = std::max(iters, 1U);
+  for(uint32_t iter = 0; iter < iters; ++iter)
+  {
+    CodeblockDecompress block(1);
+    block.setRect(Rect32_16(0, 0, width, height));
+    if(!block.getImpl()->directInit((uint8_t)cblksty, numbps, numPasses, compressed.data() + 1,
+                                    dataLen, segLens.data(), (int32_t)segLens.size()) ||
+       !decompressor.alloc(width, height))
+      return -1.0;
+    decompressor.setFinalLayer(true);
+    decompressor.coder.reinit();
+    PassTimer timer{&decompressor};
+    if(!block.decompress<PassTimer>(&timer, 0, cblksty))
+      return -1.0;
+    double total = timer.seconds[0] + timer.seconds[1] + timer.seconds[2];
+    if(total < best)
+    {
+      best = total;
+      if(passSeconds)
+        std::copy(timer.seconds, timer.seconds + 3, passSeconds);
+    }
+  }
+
+  // bit-exact check: every coefficient is recovered
+  auto decompressed = decompressor.getUncompressedData();
+  for(uint16_t y = 0; y < height; ++y)
+  {
+    for(uint16_t x = 0; x < width; ++x)
+    {
+      if(decompressed[(uint32_t)y * width + x] / 2 != samples[(uint32_t)y * width + x])
+        return -1.0;
+    }
+  }
+
+  return best;
+}
+
 } // namespace grk::t1
@@ -20,6 +20,9 @@
 namespace grk::t1
 {
 
+// significance bits of the four samples of a stripe column
+#define T1_SIGMA_STRIPE_COLUMN (T1_SIGMA_4 | T1_SIGMA_7 | T1_SIGMA_10 | T1_SIGMA_13)
+
 // Decode Cleanup Pass
 
 #define DEC_PASS_CLN_STEP(checkFlags, partial, flags, flagsPtr, flagsStride, data, dataStride, \
@@ -56,53 +59,66 @@ namespace grk::t1
     uint8_t d = 0;                                                                                 \
     uint8_t runlen = 0;                                                                            \
     bool partial = false;                                                                          \
-    for(k = 0; k < (h_ & ~3u); k += 4, dataPtr += 3 * w_, flagsPtr += 2)                           \
+    uint64_t active[T1_COLUMN_MASK_WORDS];                                                         \
+    for(k = 0; k < (h_ & ~3u); k += 4, dataPtr += 4 * w_, flagsPtr += flagsStride)                 \
     {                                                                                              \
-      for(i = 0; i < w_; ++i, ++dataPtr, ++flagsPtr)                                               \
+      hwy_t1_cln_columns(flagsPtr, w_, active);                                                    \
+      for(uint32_t word = 0; word < ((w_ + 63U) >> 6); ++word)                                     \
       {                                                                                            \
-        _flags = *flagsPtr;                                                                        \
-        if(_flags == 0)                                                                            \
+        while(active[word])                                                                        \
         {                                                                                          \
-          partial = true;                                                                          \
-          SETCURCTX(curctx, T1_CTXNO_AGG);                                                         \
-          DEC_SYMBOL(d, mqc, curctx, a, c, ct);                                                    \
-          if(!d)                                                                                   \
-            continue;                                                                              \
-          SETCURCTX(curctx, T1_CTXNO_UNI);                                                         \
-          DEC_SYMBOL(runlen, mqc, curctx, a, c, ct);                                               \
-          DEC_SYMBOL(d, mqc, curctx, a, c, ct);                                                    \
-          runlen = (runlen << 1) | d;                                                              \
-          switch(runlen)                                                                           \
+          i = (uint16_t)((word << 6) + (uint32_t)std::countr_zero(active[word]));                  \
+          active[word] &= active[word] - 1;                                                        \
+          auto colFlagsPtr = flagsPtr + i;                                                         \
+          auto colDataPtr = dataPtr + i;                                                           \
+          _flags = *colFlagsPtr;                                                                   \
+          if(_flags == 0)                                                                          \
           {                                                                                        \
-            case 0:                                                                                \
-              DEC_PASS_CLN_STEP(false, true, _flags, flagsPtr, flagsStride, dataPtr, w_, 0, 0,     \
-                                vsc);                                                              \
-              partial = false;                                                                     \
-              /* FALLTHRU */                                                                       \
-            case 1:                                                                                \
-              DEC_PASS_CLN_STEP(false, partial, _flags, flagsPtr, flagsStride, dataPtr, w_, 1, 3,  \
-                                false);                                                            \
-              partial = false;                                                                     \
-              /* FALLTHRU */                                                                       \
-            case 2:                                                                                \
-              DEC_PASS_CLN_STEP(false, partial, _flags, flagsPtr, flagsStride, dataPtr, w_, 2, 6,  \
-                                false);                                                            \
-              partial = false;                                                                     \
-              /* FALLTHRU */                                                                       \
-            case 3:                                                                                \
-              DEC_PASS_CLN_STEP(false, partial, _flags, flagsPtr, flagsStride, dataPtr, w_, 3, 9,  \
-                                false);                                                            \
-              break;                                                                               \
+            partial = true;                                                                        \
+            SETCURCTX(curctx, T1_CTXNO_AGG);                                                       \
+            DEC_SYMBOL(d, mqc, curctx, a, c, ct);                                                  \
+            if(!d)                                                                                 \
+              continue;                                                                            \
+            SETCURCTX(curctx, T1_CTXNO_UNI);                                                       \
+            DEC_SYMBOL(runlen, mqc, curctx, a, c, ct);                                             \
+            DEC_SYMBOL(d, mqc, curctx, a, c, ct);                                                  \
+            runlen = (runlen << 1) | d;                                                            \
+            switch(runlen)                                                                         \
+            {                                                                                      \
+              case 0:                                                                              \
+                DEC_PASS_CLN_STEP(false, true, _flags, colFlagsPtr, flagsStride, colDataPtr, w_, 0,\
+                                  0, vsc);                                                         \
+                partial = false;                                                                   \
+                /* FALLTHRU */                                                                     \
+              case 1:                                                                              \
+                DEC_PASS_CLN_STEP(false, partial, _flags, colFlagsPtr, flagsStride, colDataPtr, w_,\
+                                  1, 3, false);                                                    \
+                partial = false;                                                                   \
+                /* FALLTHRU */                                                                     \
+              case 2:                                                                              \
+                DEC_PASS_CLN_STEP(false, partial, _flags, colFlagsPtr, flagsStride, colDataPtr, w_,\
+                                  2, 6, false);                                                    \
+                partial = false;                                                                   \
+                /* FALLTHRU */                                                                     \
+              case 3:                                                                              \
+                DEC_PASS_CLN_STEP(false, partial, _flags, colFlagsPtr, flagsStride, colDataPtr, w_,\
+                                  3, 9, false);                                                    \
+                break;                                                                             \
+            }                                                                                      \
           }                                                                                        \
+          else                                                                                     \
+          {                                                                                        \
+            DEC_PASS_CLN_STEP(true, false, _flags, colFlagsPtr, flagsStride, colDataPtr, w_, 0, 0, \
+                              vsc);                                                                \
+            DEC_PASS_CLN_STEP(true, false, _flags, colFlagsPtr, flagsStride, colDataPtr, w_, 1, 3, \
+                              false);                                                              \
+            DEC_PASS_CLN_STEP(true, false, _flags, colFlagsPtr, flagsStride, colDataPtr, w_, 2, 6, \
+                              false);                                                              \
+            DEC_PASS_CLN_STEP(true, false, _flags, colFlagsPtr, flagsStride, colDataPtr, w_, 3, 9, \
+                              false);                                                              \
+          }                                                                                        \
+          *colFlagsPtr = _flags & ~(T1_PI_0 | T1_PI_1 | T1_PI_2 | T1_PI_3);                        \
         }                                                                                          \
-        else                                                                                       \
-        {                                                                                          \
-          DEC_PASS_CLN_STEP(true, false, _flags, flagsPtr, flagsStride, dataPtr, w_, 0, 0, vsc);   \
-          DEC_PASS_CLN_STEP(true, false, _flags, flagsPtr, flagsStride, dataPtr, w_, 1, 3, false); \
-          DEC_PASS_CLN_STEP(true, false, _flags, flagsPtr, flagsStride, dataPtr, w_, 2, 6, false); \
-          DEC_PASS_CLN_STEP(true, false, _flags, flagsPtr, flagsStride, dataPtr, w_, 3, 9, false); \
-        }                                                                                          \
-        *flagsPtr = _flags & ~(T1_PI_0 | T1_PI_1 | T1_PI_2 | T1_PI_3);                             \
       }                                                                                            \
     }                                                                                              \
     if(k < h_)                                                                                     \
@@ -147,35 +163,45 @@ namespace grk::t1
     }                                                                                      \
   } while(0)
 
-#define DEC_PASS_SIG_IMPL(bpno, vsc, w_, h_, flagsStride)                                       \
-  {                                                                                             \
-    DEC_PASS_LOCAL_VARIABLES(flagsStride)                                                       \
-    const int32_t half = one >> 1;                                                              \
-    const int32_t oneplushalf = one | half;                                                     \
-    for(k = 0; k < (h_ & ~3u); k += 4, dataPtr += 3 * w_, flagsPtr += 2)                        \
-    {                                                                                           \
-      for(i = 0; i < w_; ++i, ++dataPtr, ++flagsPtr)                                            \
-      {                                                                                         \
-        _flags = *flagsPtr;                                                                     \
-        if(_flags != 0)                                                                         \
-        {                                                                                       \
-          DEC_PASS_SIG_STEP(_flags, flagsPtr, flagsStride, dataPtr, w_, 0, 0, vsc);             \
-          DEC_PASS_SIG_STEP(_flags, flagsPtr, flagsStride, dataPtr, w_, 1, 3, false);           \
-          DEC_PASS_SIG_STEP(_flags, flagsPtr, flagsStride, dataPtr, w_, 2, 6, false);           \
-          DEC_PASS_SIG_STEP(_flags, flagsPtr, flagsStride, dataPtr, w_, 3, 9, false);           \
-          *flagsPtr = _flags;                                                                   \
-        }                                                                                       \
-      }                                                                                         \
-    }                                                                                           \
-    if(k < h_)                                                                                  \
-      for(i = 0; i < w_; ++i, ++dataPtr, ++flagsPtr)                                            \
-        for(j = 0; j < h_ - k; ++j)                                                             \
-        {                                                                                       \
-          _flags = *flagsPtr;                                                                   \
-          DEC_PASS_SIG_STEP(_flags, flagsPtr, flagsStride, dataPtr + j * w_, 0, j, 3 * j, vsc); \
-          *flagsPtr = _flags;                                                                   \
-        }                                                                                       \
-    POP_MQC();                                                                                  \
+#define DEC_PASS_SIG_IMPL(bpno, vsc, w_, h_, flagsStride)                                          \
+  {                                                                                                \
+    DEC_PASS_LOCAL_VARIABLES(flagsStride)                                                          \
+    const int32_t half = one >> 1;                                                                 \
+    const int32_t oneplushalf = one | half;                                                        \
+    uint64_t active[T1_COLUMN_MASK_WORDS];                                                         \
+    for(k = 0; k < (h_ & ~3u); k += 4, dataPtr += 4 * w_, flagsPtr += flagsStride)                 \
+    {                                                                                              \
+      hwy_t1_sig_columns(flagsPtr, w_, active);                                                    \
+      for(uint32_t word = 0; word < ((w_ + 63U) >> 6); ++word)                                     \
+      {                                                                                            \
+        while(active[word])                                                                        \
+        {                                                                                          \
+          i = (uint16_t)((word << 6) + (uint32_t)std::countr_zero(active[word]));                  \
+          active[word] &= active[word] - 1;                                                        \
+          auto colFlagsPtr = flagsPtr + i;                                                         \
+          auto colDataPtr = dataPtr + i;                                                           \
+          _flags = *colFlagsPtr;                                                                   \
+          const grk_flag sigma = _flags & T1_SIGMA_STRIPE_COLUMN;                                  \
+          DEC_PASS_SIG_STEP(_flags, colFlagsPtr, flagsStride, colDataPtr, w_, 0, 0, vsc);          \
+          DEC_PASS_SIG_STEP(_flags, colFlagsPtr, flagsStride, colDataPtr, w_, 1, 3, false);        \
+          DEC_PASS_SIG_STEP(_flags, colFlagsPtr, flagsStride, colDataPtr, w_, 2, 6, false);        \
+          DEC_PASS_SIG_STEP(_flags, colFlagsPtr, flagsStride, colDataPtr, w_, 3, 9, false);        \
+          *colFlagsPtr = _flags;                                                                   \
+          /* a newly significant sample can bring the next column into the pass */                 \
+          if((_flags & T1_SIGMA_STRIPE_COLUMN) != sigma && i + 1U < w_)                            \
+            active[(i + 1U) >> 6] |= 1ULL << ((i + 1U) & 63);                                      \
+        }                                                                                          \
+      }                                                                                            \
+    }                                                                                              \
+    if(k < h_)                                                                                     \
+      for(i = 0; i < w_; ++i, ++dataPtr, ++flagsPtr)                                               \
+        for(j = 0; j < h_ - k; ++j)                                                                \
+        {                                                                                          \
+          _flags = *flagsPtr;                                                                      \
+          DEC_PASS_SIG_STEP(_flags, flagsPtr, flagsStride, dataPtr + j * w_, 0, j, 3 * j, vsc);    \
+          *flagsPtr = _flags;                                                                      \
+        }                                                                                          \
+    POP_MQC();                                                                                     \
   }
 
 // Decode Magnitude Refinement Pass
@@ -193,34 +219,40 @@ namespace grk::t1
     }                                                                                              \
   } while(0)
 
-#define DEC_PASS_REF_IMPL(bpno, w_, h_, flagsStride)                     \
-  {                                                                      \
-    DEC_PASS_LOCAL_VARIABLES(flagsStride)                                \
-    const int32_t poshalf = one >> 1;                                    \
-    for(k = 0; k < (h_ & ~3u); k += 4, dataPtr += 3 * w_, flagsPtr += 2) \
-    {                                                                    \
-      for(i = 0; i < w_; ++i, ++dataPtr, ++flagsPtr)                     \
-      {                                                                  \
-        _flags = *flagsPtr;                                              \
-        if(_flags != 0)                                                  \
-        {                                                                \
-          DEC_PASS_REF_STEP(_flags, dataPtr, w_, 0, 0);                  \
-          DEC_PASS_REF_STEP(_flags, dataPtr, w_, 1, 3);                  \
-          DEC_PASS_REF_STEP(_flags, dataPtr, w_, 2, 6);                  \
-          DEC_PASS_REF_STEP(_flags, dataPtr, w_, 3, 9);                  \
-          *flagsPtr = _flags;                                            \
-        }                                                                \
-      }                                                                  \
-    }                                                                    \
-    if(k < h_)                                                           \
-      for(i = 0; i < w_; ++i, ++dataPtr, ++flagsPtr)                     \
-        for(j = 0; j < h_ - k; ++j)                                      \
-        {                                                                \
-          _flags = *flagsPtr;                                            \
-          DEC_PASS_REF_STEP(_flags, dataPtr + j * w_, 0, j, j * 3);      \
-          *flagsPtr = _flags;                                            \
-        }                                                                \
-    POP_MQC();                                                           \
+#define DEC_PASS_REF_IMPL(bpno, w_, h_, flagsStride)                                               \
+  {                                                                                                \
+    DEC_PASS_LOCAL_VARIABLES(flagsStride)                                                          \
+    const int32_t poshalf = one >> 1;                                                              \
+    uint64_t active[T1_COLUMN_MASK_WORDS];                                                         \
+    for(k = 0; k < (h_ & ~3u); k += 4, dataPtr += 4 * w_, flagsPtr += flagsStride)                 \
+    {                                                                                              \
+      hwy_t1_ref_columns(flagsPtr, w_, active);                                                    \
+      for(uint32_t word = 0; word < ((w_ + 63U) >> 6); ++word)                                     \
+      {                                                                                            \
+        while(active[word])                                                                        \
+        {                                                                                          \
+          i = (uint16_t)((word << 6) + (uint32_t)std::countr_zero(active[word]));                  \
+          active[word] &= active[word] - 1;                                                        \
+          auto colFlagsPtr = flagsPtr + i;                                                         \
+          auto colDataPtr = dataPtr + i;                                                           \
+          _flags = *colFlagsPtr;                                                                   \
+          DEC_PASS_REF_STEP(_flags, colDataPtr, w_, 0, 0);                                         \
+          DEC_PASS_REF_STEP(_flags, colDataPtr, w_, 1, 3);                                         \
+          DEC_PASS_REF_STEP(_flags, colDataPtr, w_, 2, 6);                                         \
+          DEC_PASS_REF_STEP(_flags, colDataPtr, w_, 3, 9);                                         \
+          *colFlagsPtr = _flags;                                                                   \
+        }                                                                                          \
+      }                                                                                            \
+    }                                                                                              \
+    if(k < h_)                                                                                     \
+      for(i = 0; i < w_; ++i, ++dataPtr, ++flagsPtr)                                               \
+        for(j = 0; j < h_ - k; ++j)                                                                \
+        {                                                                                          \
+          _flags = *flagsPtr;                                                                      \
+          DEC_PASS_REF_STEP(_flags, dataPtr + j * w_, 0, j, j * 3);                                \
+          *flagsPtr = _flags;                                                                      \
+        }                                                                                          \
+    POP_MQC();                                                                                     \
   }
 
 } // namespace grk::t1
\ No newline at end of file
@@ -0,0 +1,269 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "hwy_arm_disable_targets.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "t1/part1/block_coder/BlockCoderSIMD.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+#include <cstring>
+#include <algorithm>
+#include "mqc_base.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace grk::t1
+{
+namespace HWY_NAMESPACE
+{
+  namespace hn = hwy::HWY_NAMESPACE;
+
+  /* at most 16 lanes, so one vector's mask bits never straddle a 64-bit mask word
+   * and fit in two bytes */
+  using ColumnTag = hn::CappedTag<uint32_t, 16>;
+
+  /* per-sample flag masks for the four rows of a stripe column */
+  template<uint32_t row>
+  struct RowBits
+  {
+    static constexpr uint32_t shift = 3 * row;
+    static constexpr uint32_t sigmaPi = (T1_SIGMA_THIS | T1_PI_THIS) << shift;
+    static constexpr uint32_t sigma = T1_SIGMA_THIS << shift;
+    static constexpr uint32_t neighbours = T1_SIGMA_NEIGHBOURS << shift;
+  };
+
+  template<uint32_t row, class D, class V>
+  HWY_INLINE auto sigRow(D d, V f)
+  {
+    using B = RowBits<row>;
+    const auto zero = hn::Zero(d);
+    return hn::And(hn::Eq(hn::And(f, hn::Set(d, B::sigmaPi)), zero),
+                   hn::Ne(hn::And(f, hn::Set(d, B::neighbours)), zero));
+  }
+
+  template<uint32_t row, class D, class V>
+  HWY_INLINE auto refRow(D d, V f)
+  {
+    using B = RowBits<row>;
+    return hn::Eq(hn::And(f, hn::Set(d, B::sigmaPi)), hn::Set(d, B::sigma));
+  }
+
+  template<uint32_t row, class D, class V>
+  HWY_INLINE auto clnRow(D d, V f)
+  {
+    using B = RowBits<row>;
+    return hn::Eq(hn::And(f, hn::Set(d, B::sigmaPi)), hn::Zero(d));
+  }
+
+  HWY_INLINE void storeColumnBits(uint64_t* active, size_t i, const uint8_t* bits)
+  {
+    uint64_t v = (uint64_t)bits[0] | ((uint64_t)bits[1] << 8);
+    active[i >> 6] |= v << (i & 63);
+  }
+
+  static void Hwy_t1_sig_columns(const uint32_t* flags, uint16_t w, uint64_t* active)
+  {
+    const ColumnTag d;
+    const size_t N = hn::Lanes(d);
+    memset(active, 0, ((w + 63U) >> 6) * sizeof(uint64_t));
+    for(size_t i = 0; i < w; i += N)
+    {
+      const auto valid = hn::FirstN(d, std::min(N, (size_t)w - i));
+      const auto f = hn::MaskedLoad(valid, d, flags + i);
+      auto m = hn::Or(hn::Or(sigRow<0>(d, f), sigRow<1>(d, f)),
+                      hn::Or(sigRow<2>(d, f), sigRow<3>(d, f)));
+      uint8_t bits[8] = {};
+      hn::StoreMaskBits(d, hn::And(m, valid), bits);
+      storeColumnBits(active, i, bits);
+    }
+  }
+
+  static void Hwy_t1_ref_columns(const uint32_t* flags, uint16_t w, uint64_t* active)
+  {
+    const ColumnTag d;
+    const size_t N = hn::Lanes(d);
+    memset(active, 0, ((w + 63U) >> 6) * sizeof(uint64_t));
+    for(size_t i = 0; i < w; i += N)
+    {
+      const auto valid = hn::FirstN(d, std::min(N, (size_t)w - i));
+      const auto f = hn::MaskedLoad(valid, d, flags + i);
+      auto m = hn::Or(hn::Or(refRow<0>(d, f), refRow<1>(d, f)),
+                      hn::Or(refRow<2>(d, f), refRow<3>(d, f)));
+      uint8_t bits[8] = {};
+      hn::StoreMaskBits(d, hn::And(m, valid), bits);
+      storeColumnBits(active, i, bits);
+    }
+  }
+
+  static void Hwy_t1_cln_columns(uint32_t* flags, uint16_t w, uint64_t* active)
+  {
+    const ColumnTag d;
+    const size_t N = hn::Lanes(d);
+    const auto notPi = hn::Set(d, ~(uint32_t)(T1_PI_0 | T1_PI_1 | T1_PI_2 | T1_PI_3));
+    memset(active, 0, ((w + 63U) >> 6) * sizeof(uint64_t));
+    for(size_t i = 0; i < w; i += N)
+    {
+      const auto valid = hn::FirstN(d, std::min(N, (size_t)w - i));
+      const auto f = hn::MaskedLoad(valid, d, flags + i);
+      auto m = hn::Or(hn::Or(clnRow<0>(d, f), clnRow<1>(d, f)),
+                      hn::Or(clnRow<2>(d, f), clnRow<3>(d, f)));
+      // columns the pass skips still leave it with their visited bits cleared
+      hn::BlendedStore(hn::IfThenElse(m, f, hn::And(f, notPi)), valid, d, flags + i);
+      uint8_t bits[8] = {};
+      hn::StoreMaskBits(d, hn::And(m, valid), bits);
+      storeColumnBits(active, i, bits);
+    }
+  }
+
+  static void Hwy_t1_halve_i32(int32_t* dest, const int32_t* src, uint32_t len)
+  {
+    const HWY_FULL(int32_t) di;
+    const uint32_t L = (uint32_t)Lanes(di);
+    uint32_t i = 0;
+    for(; i + L <= len; i += L)
+    {
+      // round toward zero: add one to negative values before the arithmetic shift
+      auto v = LoadU(di, src + i);
+      StoreU(hn::ShiftRight<1>(Sub(v, hn::ShiftRight<31>(v))), di, dest + i);
+    }
+    for(; i < len; ++i)
+      dest[i] = src[i] / 2;
+  }
+
+  static void Hwy_t1_scale_i32_to_f32(float* dest, const int32_t* src, uint32_t len, float scale)
+  {
+    const HWY_FULL(int32_t) di;
+    const HWY_FULL(float) df;
+    const uint32_t L = (uint32_t)Lanes(di);
+    const auto vScale = Set(df, scale);
+    uint32_t i = 0;
+    for(; i + L <= len; i += L)
+      StoreU(Mul(ConvertTo(df, LoadU(di, src + i)), vScale), df, dest + i);
+    for(; i < len; ++i)
+      dest[i] = (float)src[i] * scale;
+  }
+
+  static void Hwy_t1_halve_i32_to_i16(int16_t* dest, const int32_t* src, uint32_t len)
+  {
+    const HWY_FULL(int32_t) di;
+    const hn::Rebind<uint32_t, decltype(di)> du;
+    const hn::Rebind<uint16_t, decltype(di)> du16;
+    const hn::Rebind<int16_t, decltype(di)> di16;
+    const uint32_t L = (uint32_t)Lanes(di);
+    uint32_t i = 0;
+    for(; i + L <= len; i += L)
+    {
+      auto v = LoadU(di, src + i);
+      v = hn::ShiftRight<1>(Sub(v, hn::ShiftRight<31>(v)));
+      // truncate, matching the scalar narrowing cast
+      auto narrow = hn::TruncateTo(du16, BitCast(du, v));
+      StoreU(BitCast(di16, narrow), di16, dest + i);
+    }
+    for(; i < len; ++i)
+      dest[i] = (int16_t)(src[i] / 2);
+  }
+
+  static void Hwy_t1_scale_i32_to_i16(int16_t* dest, const int32_t* src, uint32_t len,
+                                      float scale)
+  {
+    const HWY_FULL(int32_t) di;
+    const HWY_FULL(float) df;
+    const hn::Rebind<int16_t, decltype(di)> di16;
+    const uint32_t L = (uint32_t)Lanes(di);
+    const auto vScale = Set(df, scale);
+    const auto vHalf = Set(df, 0.5f);
+    const auto vZero = Zero(df);
+    const auto vMin = Set(di, -32768);
+    const auto vMax = Set(di, 32767);
+    uint32_t i = 0;
+    for(; i + L <= len; i += L)
+    {
+      auto val = Mul(ConvertTo(df, LoadU(di, src + i)), vScale);
+      // round half away from zero, then clamp to the int16 range
+      val = IfThenElse(Ge(val, vZero), Add(val, vHalf), Sub(val, vHalf));
+      auto rounded = Clamp(ConvertTo(di, val), vMin, vMax);
+      StoreU(DemoteTo(di16, rounded), di16, dest + i);
+    }
+    for(; i < len; ++i)
+    {
+      float val = (float)src[i] * scale;
+      int32_t rounded = (int32_t)(val >= 0 ? val + 0.5f : val - 0.5f);
+      if(rounded > 32767)
+        rounded = 32767;
+      else if(rounded < -32768)
+        rounded = -32768;
+      dest[i] = (int16_t)rounded;
+    }
+  }
+
+} // namespace HWY_NAMESPACE
+} // namespace grk::t1
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+
+#include "BlockCoderSIMD.h"
+
+namespace grk::t1
+{
+
+HWY_EXPORT(Hwy_t1_sig_columns);
+HWY_EXPORT(Hwy_t1_ref_columns);
+HWY_EXPORT(Hwy_t1_cln_columns);
+HWY_EXPORT(Hwy_t1_halve_i32);
+HWY_EXPORT(Hwy_t1_scale_i32_to_f32);
+HWY_EXPORT(Hwy_t1_halve_i32_to_i16);
+HWY_EXPORT(Hwy_t1_scale_i32_to_i16);
+
+void hwy_t1_sig_columns(const uint32_t* flags, uint16_t w, uint64_t* active)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_t1_sig_columns)(flags, w, active);
+}
+
+void hwy_t1_ref_columns(const uint32_t* flags, uint16_t w, uint64_t* active)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_t1_ref_columns)(flags, w, active);
+}
+
+void hwy_t1_cln_columns(uint32_t* flags, uint16_t w, uint64_t* active)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_t1_cln_columns)(flags, w, active);
+}
+
+void hwy_t1_halve_i32(int32_t* dest, const int32_t* src, uint32_t len)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_t1_halve_i32)(dest, src, len);
+}
+
+void hwy_t1_scale_i32_to_f32(float* dest, const int32_t* src, uint32_t len, float scale)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_t1_scale_i32_to_f32)(dest, src, len, scale);
+}
+
+void hwy_t1_halve_i32_to_i16(int16_t* dest, const int32_t* src, uint32_t len)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_t1_halve_i32_to_i16)(dest, src, len);
+}
+
+void hwy_t1_scale_i32_to_i16(int16_t* dest, const int32_t* src, uint32_t len, float scale)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_t1_scale_i32_to_i16)(dest, src, len, scale);
+}
+
+} // namespace grk::t1
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace grk::t1
+{
+
+/* Number of 64-bit words in a stripe column mask: code blocks are at most 1024 wide */
+const uint32_t T1_COLUMN_MASK_WORDS = 1024 / 64;
+
+/* Stripe column masks for the Part-1 decode passes, one flag word per column.
+ * Bit i of active is set when column i holds at least one sample the pass must
+ * visit; the scalar pass then only walks those columns. */
+
+/* significance propagation: some sample is insignificant, not yet visited and has a
+ * significant neighbour */
+void hwy_t1_sig_columns(const uint32_t* flags, uint16_t w, uint64_t* active);
+
+/* magnitude refinement: some sample is significant and was not coded in this bit plane's
+ * significance propagation pass */
+void hwy_t1_ref_columns(const uint32_t* flags, uint16_t w, uint64_t* active);
+
+/* cleanup: some sample is neither significant nor visited. The visited bits of every
+ * other column are cleared here, as the pass would have done */
+void hwy_t1_cln_columns(uint32_t* flags, uint16_t w, uint64_t* active);
+
+/* Sample reconstruction of decoded code block coefficients (two's complement with
+ * one fractional bit) */
+
+/* dest = src / 2 (reversible) */
+void hwy_t1_halve_i32(int32_t* dest, const int32_t* src, uint32_t len);
+
+/* dest = (float)src * scale (irreversible) */
+void hwy_t1_scale_i32_to_f32(float* dest, const int32_t* src, uint32_t len, float scale);
+
+/* dest = (int16_t)(src / 2) (reversible, 16-bit wavelet) */
+void hwy_t1_halve_i32_to_i16(int16_t* dest, const int32_t* src, uint32_t len);
+
+/* dest = clamp(round(src * scale)) (irreversible, 16-bit wavelet) */
+void hwy_t1_scale_i32_to_i16(int16_t* dest, const int32_t* src, uint32_t len, float scale);
+
+} // namespace grk::t1
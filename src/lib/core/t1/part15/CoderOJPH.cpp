@@ -23,7 +23,11 @@
 #include "ojph_mem.h"
 #include "CoderOJPH.h"
 #include "Coder.h"
+#include "BlockCoder.h"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -189,29 +193,214 @@ bool T1OJPH::preCompress([[maybe_unused]] CompressBlockExec* block)
   }
   return true;
 }
+uint32_t T1OJPH::encode(CompressBlockExec* block, uint8_t droppedPlanes, coded_lists*& coded)
+{
+  auto cblk = block->cblk;
+  uint16_t w = (uint16_t)cblk->width();
+  uint16_t h = (uint16_t)cblk->height();
+  uint32_t pass_length[2] = {0, 0};
+  // the coded bytes are copied out before the next block is coded
+  elastic_alloc->restart();
+  coded = nullptr;
+  g_encode_cb((uint32_t*)unencoded_data, (uint32_t)(block->k_msbs - droppedPlanes), 1, w, h, w,
+              pass_length, elastic_alloc, coded);
+  return pass_length[0];
+}
 bool T1OJPH::compress(CompressBlockExec* block)
 {
   if(!preCompress(block))
     return false;
+  if(block->htRecode)
+    return recode(block);
 
   coded_lists* next_coded = nullptr;
   auto cblk = block->cblk;
+  uint8_t droppedPlanes = block->htTranscode ? transcodedPlanes(block) : 0;
   cblk->setNumBps(0);
   // optimization below was causing errors in compressing
   // if (maximum >= (uint32_t)1<<(31 - (block->k_msbs+1)))
-  uint16_t w = (uint16_t)cblk->width();
-  uint16_t h = (uint16_t)cblk->height();
-
-  uint32_t pass_length[2] = {0, 0};
-  g_encode_cb((uint32_t*)unencoded_data, block->k_msbs, 1, w, h, w, pass_length, elastic_alloc,
-              next_coded);
+  uint32_t length = encode(block, droppedPlanes, next_coded);
 
   cblk->setNumPasses(1);
-  cblk->getPass(0)->len_ = (uint16_t)pass_length[0];
-  cblk->getPass(0)->rate_ = (uint16_t)pass_length[0];
-  cblk->setNumBps(1);
+  cblk->getPass(0)->len_ = (uint16_t)length;
+  cblk->getPass(0)->rate_ = (uint16_t)length;
+  cblk->setNumBps((uint8_t)(1 + droppedPlanes));
   assert(cblk->getPaddedCompressedStream());
-  memcpy(cblk->getPaddedCompressedStream(), next_coded->buf, (size_t)pass_length[0]);
+  memcpy(cblk->getPaddedCompressedStream(), next_coded->buf, (size_t)length);
+  if(block->doRateControl)
+    tabulateTruncations(block, (uint16_t)length);
+
+  return true;
+}
+uint8_t T1OJPH::transcodedPlanes(CompressBlockExec* block)
+{
+  auto cblk = block->cblk;
+  uint32_t numSamples = cblk->width() * cblk->height();
+  int32_t shift = 30 - block->k_msbs;
+  bool reversible = block->qmfbid == 1;
+  if(!reversible && shift < 2)
+    return 0;
+
+  // h is the Part 1 magnitude with its half bit: a block that stopped at bit plane p
+  // leaves every significant h an odd multiple of 2^p, larger than 2^p
+  uint32_t planes = 32;
+  bool uniform = true;
+  for(uint32_t i = 0; i < numSamples; ++i)
+  {
+    uint32_t word = (uint32_t)unencoded_data[i];
+    uint32_t mag = word & 0x7FFFFFFF;
+    uint32_t h = reversible ? (mag >> shift) << 1 : (mag + (1U << (shift - 2))) >> (shift - 1);
+    // irreversible magnitudes carry float rounding below the half bit
+    if(!reversible)
+      unencoded_data[i] = (int32_t)((word & 0x80000000) | (h << (shift - 1)));
+    if(!h)
+      continue;
+    auto p = (uint32_t)std::countr_zero(h);
+    if(planes == 32)
+      planes = p;
+    uniform = uniform && p == planes && h != (1U << p);
+  }
+  // the HT decoder puts samples in the middle of the dropped planes' bin, as Part 1 does
+  if(!uniform || planes == 32 || planes >= block->k_msbs)
+    return 0;
+
+  return (uint8_t)planes;
+}
+void T1OJPH::tabulateTruncations(CompressBlockExec* block, uint16_t fullLength)
+{
+  auto cblk = block->cblk;
+  uint32_t w = cblk->width();
+  uint32_t h = cblk->height();
+  uint32_t shift = 30U - block->k_msbs;
+  bool reversible = block->qmfbid == 1;
+  double fraction = 1.0 / (double)(1U << shift);
+
+  // indexed by the number of bit planes b in a sample's integer magnitude: sample
+  // counts, squared magnitudes and quads whose largest sample has b planes; error[d]
+  // sums the squared reconstruction error, once d planes are dropped, of the samples
+  // that keep some of their planes
+  const uint32_t maxPlanes = 31;
+  uint32_t samples[maxPlanes + 1] = {};
+  double energy[maxPlanes + 1] = {};
+  uint32_t quads[maxPlanes + 1] = {};
+  double error[maxPlanes] = {};
+  uint32_t numPlanes = 0;
+  for(uint32_t y = 0; y < h; y += 2)
+  {
+    for(uint32_t x = 0; x < w; x += 2)
+    {
+      uint32_t quadPlanes = 0;
+      for(uint32_t j = y; j < std::min(y + 2, h); ++j)
+      {
+        for(uint32_t i = x; i < std::min(x + 2, w); ++i)
+        {
+          uint32_t mag = (uint32_t)unencoded_data[j * w + i] & 0x7FFFFFFF;
+          uint32_t q = mag >> shift;
+          if(!q)
+            continue;
+          auto planes = (uint32_t)std::bit_width(q);
+          // irreversible magnitudes keep their fractional part below the shift
+          double v = reversible ? (double)q : (double)mag * fraction;
+          samples[planes]++;
+          energy[planes] += v * v;
+          for(uint32_t d = 0; d < planes; ++d)
+          {
+            // the decoder reconstructs a truncated magnitude at the middle of its bin
+            double rec =
+                reversible && d == 0 ? (double)q : ((double)(q >> d) + 0.5) * (double)(1U << d);
+            error[d] += (v - rec) * (v - rec);
+          }
+          quadPlanes = std::max(quadPlanes, planes);
+        }
+      }
+      quads[quadPlanes]++;
+      numPlanes = std::max(numPlanes, quadPlanes);
+    }
+  }
+
+  double w1 = 1.0;
+  if(block->mct_norms && block->compno < block->mct_numcomps)
+    w1 = block->mct_norms[block->compno];
+  double w2 = BlockCoder::getnorm(block->level, block->bandOrientation, reversible);
+  double weight = w1 * w2 * block->stepsize;
+  weight *= weight;
+
+  // magnitude and sign bits of the significant samples, plus a VLC codeword for each
+  // significant quad and a share of a MEL symbol for each insignificant one
+  uint32_t totalQuads = 0;
+  for(auto q : quads)
+    totalQuads += q;
+  auto estimateBits = [&](uint32_t d) {
+    double bits = 0;
+    uint32_t sigQuads = 0;
+    for(uint32_t b = d + 1; b <= numPlanes; ++b)
+    {
+      bits += samples[b] * (double)(b - d + 1);
+      sigQuads += quads[b];
+    }
+    return bits + 6.0 * sigQuads + 0.5 * (totalQuads - sigQuads);
+  };
+
+  double excluded = 0;
+  for(auto e : energy)
+    excluded += e;
+  // the encoder needs at least one missing MSB, and numbps may not exceed the band's
+  // bit planes
+  uint32_t numTruncations = std::max(1U, std::min<uint32_t>(numPlanes, block->k_msbs));
+  double bytesPerBit = fullLength / std::max(estimateBits(0), 1.0);
+  auto& truncations = cblk->getHTTruncations();
+  truncations.assign(numTruncations, HTTruncation());
+  double zeroed = 0;
+  for(uint32_t d = 0; d < numTruncations; ++d)
+  {
+    zeroed += energy[d];
+    auto& t = truncations[d];
+    t.distortiondec = (excluded - error[d] - zeroed) * weight;
+    if(d == 0)
+    {
+      t.len = fullLength;
+      t.coded = true;
+      t.offset = 0;
+    }
+    else
+    {
+      auto len = std::ceil(estimateBits(d) * bytesPerBit);
+      t.len = (uint16_t)std::clamp(len, 1.0, (double)fullLength);
+    }
+  }
+  uint8_t droppedPlanes[maxPlanes];
+  cblk->setHTPasses(false, droppedPlanes);
+  block->distortion = truncations[0].distortiondec;
+}
+bool T1OJPH::recode(CompressBlockExec* block)
+{
+  auto cblk = block->cblk;
+  auto& truncations = cblk->getHTTruncations();
+  uint8_t d = block->htDroppedPlanes;
+  if(d >= truncations.size() || (d && d >= block->k_msbs))
+    return false;
+  coded_lists* coded = nullptr;
+  uint32_t length = encode(block, d, coded);
+  // keep the bytes after those of the other truncations, or start the stream over
+  // if they do not fit
+  int64_t end = 0;
+  for(const auto& t : truncations)
+  {
+    if(t.offset >= 0)
+      end = std::max<int64_t>(end, (int64_t)t.offset + t.len);
+  }
+  if(end + length > cblk->getCompressedStreamCapacity())
+  {
+    for(auto& t : truncations)
+      t.offset = -1;
+    end = 0;
+  }
+  if(length)
+    memcpy(cblk->getPaddedCompressedStream() + end, coded->buf, (size_t)length);
+  auto& t = truncations[d];
+  t.len = (uint16_t)length;
+  t.coded = true;
+  t.offset = (int32_t)end;
 
   return true;
 }
@@ -237,7 +426,12 @@ bool T1OJPH::decompress(DecompressBlockExec* block)
       return false;
     }
     size_t cleanupLength = layout.cleanup->getDataChunksLength();
-    size_t refinementLength = layout.refinement ? layout.refinement->getDataChunksLength() : 0;
+    // the refinement passes only add the bit plane below the cleanup pass's least
+    // significant one, which the target precision may not need
+    int32_t cleanupLsb = (int32_t)block->bandNumbps - 1 - block->k_msbs;
+    bool skipRefinement = block->skipBitPlanes && cleanupLsb <= (int32_t)block->skipBitPlanes;
+    size_t refinementLength =
+        layout.refinement && !skipRefinement ? layout.refinement->getDataChunksLength() : 0;
     uint32_t numPasses = 1 + (refinementLength ? layout.refinement->totalPasses_ : 0);
     size_t totalLength = cleanupLength + refinementLength;
     size_t paddedLength = 2 * grk_cblk_dec_compressed_data_pad_ht + totalLength;
@@ -269,4 +463,16 @@ bool T1OJPH::decompress(DecompressBlockExec* block)
 
   return true;
 }
+bool T1OJPH::replay(DecompressBlockExec* block)
+{
+  auto cblk = block->cblk;
+  if(!cblk->area())
+    return true;
+  if(cblk->isPart1Block())
+    return part1Coder()->replay(block);
+  if(block->postProcessor_)
+    block->postProcessor_(unencoded_data, block, (uint16_t)((cblk->width() + 7u) & ~7u));
+
+  return true;
+}
 } // namespace grk::t1::ojph
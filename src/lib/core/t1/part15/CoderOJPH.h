@@ -24,6 +24,7 @@ namespace grk::t1::ojph
 {
 class mem_fixed_allocator;
 class mem_elastic_allocator;
+struct coded_lists;
 
 class T1OJPH : public ICoder
 {
@@ -33,9 +34,32 @@ public:
 
   bool compress(CompressBlockExec* block) override;
   bool decompress(DecompressBlockExec* block) override;
+  bool replay(DecompressBlockExec* block) override;
 
 private:
   bool preCompress(CompressBlockExec* block);
+  /**
+   * @brief Codes the cleanup pass with @p droppedPlanes least significant bit planes dropped
+   * @return coded length in bytes
+   */
+  uint32_t encode(CompressBlockExec* block, uint8_t droppedPlanes, coded_lists*& coded);
+  /**
+   * @brief Fills in the block's HT truncations for rate control: the exact distortion
+   * decrease of each, the coded length of the full pass and estimates for the others
+   */
+  void tabulateTruncations(CompressBlockExec* block, uint16_t fullLength);
+  /**
+   * @brief Codes one of the block's HT truncations, to learn its length
+   */
+  bool recode(CompressBlockExec* block);
+  /**
+   * @brief Bit planes to drop when coding a block transcoded from Part 1, so that the
+   * HT decoder reconstructs the samples the Part 1 decoder did
+   *
+   * @return the bit plane the Part 1 block stopped at, or 0 when its samples stopped
+   * at different planes
+   */
+  uint8_t transcodedPlanes(CompressBlockExec* block);
   bool postProcess(DecompressBlockExec* block);
   ICoder* part1Coder();
 
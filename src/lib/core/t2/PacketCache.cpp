@@ -47,12 +47,18 @@ void PacketCache::next(size_t offset, bool dataPresent)
 
 bool PacketCache::isSelectiveFetch(void) const
 {
-  return selectiveFetch_;
+  return fetchedPackets_ != nullptr;
 }
 
-void PacketCache::setSelectiveFetch(bool selective)
+void PacketCache::setSelectiveFetch(std::shared_ptr<const std::vector<bool>> fetchedPackets)
 {
-  selectiveFetch_ = selective;
+  fetchedPackets_ = std::move(fetchedPackets);
+}
+
+bool PacketCache::isPacketFetched(uint64_t packetIndex) const
+{
+  return !fetchedPackets_ ||
+         (packetIndex < fetchedPackets_->size() && (*fetchedPackets_)[packetIndex]);
 }
 
 void PacketCache::rewind(void)
@@ -54,9 +54,16 @@ public:
 
   /**
    * @brief Sets selective fetch mode
-   * @param selective true if only partial packet data was fetched
+   * @param fetchedPackets one flag per packet in progression order, true if the
+   * packet's data was fetched; nullptr if all packet data is present
    */
-  void setSelectiveFetch(bool selective);
+  void setSelectiveFetch(std::shared_ptr<const std::vector<bool>> fetchedPackets);
+
+  /**
+   * @brief Returns true if the packet's data is present in the buffer
+   * @param packetIndex packet index in progression order
+   */
+  bool isPacketFetched(uint64_t packetIndex) const;
 
   /**
    * @brief Resets state to beginning of packet list, and beginning
@@ -88,7 +95,7 @@ private:
 
   std::vector<PacketParser*> parsers_;
   std::vector<PacketParser*>::iterator iter_;
-  bool selectiveFetch_ = false;
+  std::shared_ptr<const std::vector<bool>> fetchedPackets_;
 };
 
 } // namespace grk
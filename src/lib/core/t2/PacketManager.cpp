@@ -253,6 +253,20 @@ void PacketManager::updateCompressParams(const GrkImage* image, CodingParams* p_
   updateCompressTcpProgressions(tcp, image->numcomps, tileBounds, max_precincts, max_res, dx_min,
                                 dy_min, tcp->hasPoc());
 }
+void PacketManager::updateCompressProgressions(const GrkImage* image, CodingParams* p_cp,
+                                               TileCodingParams* tcp, uint16_t tile_no,
+                                               T2_MODE t2_mode)
+{
+  uint8_t max_res;
+  uint64_t max_precincts;
+  Rect32 tileBounds;
+  uint32_t dx_min, dy_min;
+  getParams(image, p_cp, tcp, tile_no, &tileBounds, &dx_min, &dy_min, nullptr, &max_precincts,
+            &max_res, nullptr);
+  bool poc = tcp->hasPoc() && (GRK_IS_CINEMA(p_cp->rsiz_) || t2_mode == FINAL_PASS);
+  updateCompressTcpProgressions(tcp, image->numcomps, tileBounds, max_precincts, max_res, dx_min,
+                                dy_min, poc);
+}
 IncludeTracker* PacketManager::getIncludeTracker(void)
 {
   return includeTracker_;
@@ -209,6 +209,18 @@ public:
    */
   static void updateCompressParams(const GrkImage* image, CodingParams* p_cp, TileCodingParams* tcp,
                                    uint16_t tile_no);
+  /**
+   * Updates the progressions of a tile as the compressor's PacketManager for a T2 pass would,
+   * for a pass that walks a shared @ref PacketOrder instead.
+   *
+   * @param	image		the image being encoded.
+   * @param	p_cp		the coding parameters.
+   * @param	tcp		@ref TileCodingParams of the tile
+   * @param	tile_no	index of the tile being encoded.
+   * @param	t2_mode	@ref T2_MODE of the pass
+   */
+  static void updateCompressProgressions(const GrkImage* image, CodingParams* p_cp,
+                                         TileCodingParams* tcp, uint16_t tile_no, T2_MODE t2_mode);
 
   IncludeTracker* getIncludeTracker(void);
   uint32_t getNumProgressions(void);
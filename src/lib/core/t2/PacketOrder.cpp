@@ -0,0 +1,273 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdlib>
+
+#include "CodeStreamLimits.h"
+#include "TileWindow.h"
+#include "Quantizer.h"
+#include "Logger.h"
+#include "buffer.h"
+#include "GrkObjectWrapper.h"
+#include "TileFutureManager.h"
+#include "FlowComponent.h"
+#include "IStream.h"
+#include "FetchCommon.h"
+#include "TPFetchSeq.h"
+#include "GrkImage.h"
+#include "MarkerParser.h"
+#include "PLMarker.h"
+#include "SIZMarker.h"
+#include "PPMMarker.h"
+namespace grk
+{
+struct ITileProcessor;
+}
+#include "CodeStream.h"
+#include "PacketIter.h"
+#include "PacketLengthCache.h"
+#include "ICoder.h"
+#include "CoderPool.h"
+#include "CodecScheduler.h"
+#include "PacketManager.h"
+#include "PacketOrder.h"
+#include "ITileProcessor.h"
+
+namespace grk
+{
+
+PacketOrderCache::PacketOrderCache()
+    : enabled_(std::getenv("GRK_NO_PACKET_ORDER_TABLES") == nullptr)
+{}
+
+namespace
+{
+  /**
+   * @brief Appends a tile's extent along one axis to its packet order key
+   *
+   * The tile's packets depend on its origin only through the origin modulo the grids
+   * its resolutions round to, sub << depth, and the projected precinct grids,
+   * sub << (precinct exponent + depth), which nest. Resolution bounds round to multiples
+   * of sub << depth, so a grid line within that distance of the tile can still move a
+   * packet; once the lines of one grid are all farther away, those of every coarser
+   * grid are too, and the origin modulo the finer grids is enough.
+   *
+   * @param t0 tile origin
+   * @param t1 tile end
+   * @param sub component subsampling
+   * @param grids bit mask of the grid exponents
+   * @param maxDepth largest decomposition depth
+   * @param key key to append to
+   */
+  void appendAxis(uint32_t t0, uint32_t t1, uint32_t sub, uint64_t grids, uint8_t maxDepth,
+                  std::vector<uint64_t>& key)
+  {
+    uint64_t guard = (uint64_t)sub << maxDepth;
+    uint64_t lo = t0 > guard ? t0 - guard : 0;
+    uint64_t hi = (uint64_t)t1 + guard;
+    uint64_t period = 1;
+    uint8_t exp = 0;
+    for(; exp < 64; ++exp)
+    {
+      if(!(grids & ((uint64_t)1 << exp)))
+        continue;
+      uint64_t grid = (uint64_t)sub << exp;
+      if(lo > 0 && (hi / grid) * grid < lo)
+        break;
+      period = grid;
+    }
+    key.push_back(exp);
+    key.push_back(t0 % period);
+    key.push_back(t1 - t0);
+    // the optimized iterator paths only run for tiles at the origin
+    key.push_back(t0 == 0);
+  }
+} // namespace
+
+bool PacketOrderCache::genKey(ITileProcessor* tileProcessor, bool compression, T2_MODE t2Mode,
+                              uint32_t progIterNum, std::vector<uint64_t>& key)
+{
+  auto cp = tileProcessor->getCodingParams();
+  auto tcp = tileProcessor->getTCP();
+  auto image = tileProcessor->getHeaderImage();
+  if((uint32_t)cp->t_grid_width_ * cp->t_grid_height_ < 2)
+    return false;
+  if(compression)
+  {
+    auto enc = &cp->codingParams_.enc_;
+    if(t2Mode == FINAL_PASS)
+    {
+      if(enc->enableTilePartGeneration_)
+        return false;
+    }
+    else if(cp->rsiz_ == GRK_PROFILE_CINEMA_4K || enc->maxComponentRate_ > 0 ||
+            (enc->enableTilePartGeneration_ &&
+             (GRK_IS_CINEMA(cp->rsiz_) || GRK_IS_IMF(cp->rsiz_))))
+    {
+      return false;
+    }
+  }
+  else if(!tcp->wholeTileDecompress_)
+  {
+    // windowed decode skips precincts, with PLT markers, as it goes
+    return false;
+  }
+
+  key.push_back(compression);
+  key.push_back(t2Mode);
+  key.push_back(compression ? progIterNum : 0);
+  key.push_back(tcp->prg_);
+  key.push_back(tcp->numLayers_);
+  if(!compression)
+  {
+    key.push_back(tcp->layersToDecompress_);
+    key.push_back(tileProcessor->getMaxNumDecompressResolutions());
+  }
+  uint32_t numProgressions = tcp->getNumProgressions();
+  key.push_back(numProgressions);
+  key.push_back(tcp->hasPoc());
+  for(uint32_t i = 0; i < numProgressions; ++i)
+  {
+    // the compressor derives each progression's order from the one it was given
+    auto poc = tcp->progressionOrderChange_ + i;
+    key.push_back(compression ? poc->specified_compression_poc_prog : poc->progression);
+    key.push_back(poc->lay_e);
+    key.push_back(poc->res_s);
+    key.push_back(poc->res_e);
+    key.push_back(poc->comp_s);
+    key.push_back(poc->comp_e);
+  }
+
+  auto dx = image->comps->dx;
+  auto dy = image->comps->dy;
+  uint8_t maxDepthX = 0;
+  uint8_t maxDepthY = 0;
+  uint64_t gridsX = 0;
+  uint64_t gridsY = 0;
+  key.push_back(image->numcomps);
+  key.push_back(dx);
+  key.push_back(dy);
+  for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+  {
+    auto comp = image->comps + compno;
+    if(comp->dx != dx || comp->dy != dy)
+      return false;
+    auto tccp = tcp->tccps_ + compno;
+    key.push_back(tccp->numresolutions_);
+    key.push_back(tccp->usesPart2Transform());
+    for(uint8_t resno = 0; resno < tccp->numresolutions_; ++resno)
+    {
+      uint8_t levelsDone = (uint8_t)(tccp->numresolutions_ - 1U - resno);
+      auto depthX = tccp->horizontalDepth_[levelsDone];
+      auto depthY = tccp->verticalDepth_[levelsDone];
+      auto precWidthExp = tccp->precWidthExp_[resno];
+      auto precHeightExp = tccp->precHeightExp_[resno];
+      key.push_back((uint64_t)precWidthExp | ((uint64_t)precHeightExp << 8) |
+                    ((uint64_t)depthX << 16) | ((uint64_t)depthY << 24));
+      maxDepthX = std::max(maxDepthX, depthX);
+      maxDepthY = std::max(maxDepthY, depthY);
+      gridsX |= ((uint64_t)1 << depthX) | ((uint64_t)1 << (precWidthExp + depthX));
+      gridsY |= ((uint64_t)1 << depthY) | ((uint64_t)1 << (precHeightExp + depthY));
+    }
+  }
+
+  auto tileIndex = tileProcessor->getIndex();
+  auto tileBounds =
+      cp->getTileBounds(image->getBounds(), (uint16_t)(tileIndex % cp->t_grid_width_),
+                        (uint16_t)(tileIndex / cp->t_grid_width_));
+  appendAxis(tileBounds.x0, tileBounds.x1, dx, gridsX, maxDepthX, key);
+  appendAxis(tileBounds.y0, tileBounds.y1, dy, gridsY, maxDepthY, key);
+
+  return true;
+}
+
+bool PacketOrderCache::record(ITileProcessor* tileProcessor, bool compression, T2_MODE t2Mode,
+                              uint32_t progIterNum, PacketOrder& order)
+{
+  auto cp = tileProcessor->getCodingParams();
+  PacketManager packetManager(compression, tileProcessor->getHeaderImage(), cp,
+                              tileProcessor->getIndex(), t2Mode, tileProcessor);
+  uint32_t begin = compression ? progIterNum : 0;
+  uint32_t end = compression ? progIterNum + 1 : tileProcessor->getTCP()->getNumProgressions();
+  for(uint32_t prog_iter_num = begin; prog_iter_num < end; ++prog_iter_num)
+  {
+    auto pi = packetManager.getPacketIter(prog_iter_num);
+    if(compression)
+    {
+      packetManager.enable_tile_part_generation(
+          prog_iter_num, true, cp->codingParams_.enc_.newTilePartProgressionPosition_);
+      if(pi->getProgression() == GRK_PROG_UNKNOWN)
+        return false;
+    }
+    while(pi->next(nullptr))
+    {
+      if(order.size() == maxPackets)
+        return false;
+      order.push_back({pi->getPrecinctIndex(), pi->getCompno(), pi->getLayno(), pi->getResno()});
+    }
+  }
+
+  return true;
+}
+
+std::shared_ptr<const PacketOrder> PacketOrderCache::get(ITileProcessor* tileProcessor,
+                                                         bool compression, T2_MODE t2Mode,
+                                                         uint32_t progIterNum)
+{
+  if(!enabled_)
+    return nullptr;
+  std::vector<uint64_t> key;
+  if(!genKey(tileProcessor, compression, t2Mode, progIterNum, key))
+    return nullptr;
+  std::shared_ptr<const PacketOrder> order;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = orders_.find(key);
+    if(it == orders_.end() && orders_.size() >= maxOrders)
+      return nullptr;
+    if(it != orders_.end())
+    {
+      if(!it->second)
+        return nullptr;
+      order = it->second;
+    }
+  }
+  if(order)
+  {
+    // the pass skips the PacketManager that would have set these
+    if(compression)
+      PacketManager::updateCompressProgressions(tileProcessor->getHeaderImage(),
+                                                tileProcessor->getCodingParams(),
+                                                tileProcessor->getTCP(), tileProcessor->getIndex(),
+                                                t2Mode);
+    return order;
+  }
+
+  // record outside the lock: tiles with other keys need not wait, and a tile that
+  // races to record the same key only repeats the work
+  auto recorded = std::make_shared<PacketOrder>();
+  if(!record(tileProcessor, compression, t2Mode, progIterNum, *recorded))
+    recorded.reset();
+  else
+    recorded->shrink_to_fit();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = orders_.try_emplace(std::move(key), std::move(recorded)).first;
+
+  return it->second;
+}
+
+} // namespace grk
@@ -0,0 +1,119 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace grk
+{
+
+struct ITileProcessor;
+
+/**
+ * @struct PacketOrderEntry
+ * @brief One packet of a @ref PacketOrder: the (layer, resolution, component, precinct)
+ * tuple that @ref PacketIter yields for it
+ */
+struct PacketOrderEntry
+{
+  /** precinct index within its resolution */
+  uint64_t precinctIndex;
+  /** component number */
+  uint16_t compno;
+  /** layer number */
+  uint16_t layno;
+  /** resolution number */
+  uint8_t resno;
+};
+
+/**
+ * @brief Packet sequence of one T2 pass over a tile
+ */
+using PacketOrder = std::vector<PacketOrderEntry>;
+
+/**
+ * @class PacketOrderCache
+ * @brief Packet orders shared by the tiles of a code stream
+ *
+ * The packet sequence of a tile depends only on its coding parameters, its progressions
+ * (with any POC applied) and its position relative to the precinct grids of its
+ * resolutions. Many tiles, typically all but those on the right and bottom edges, share
+ * one sequence, so the first such tile runs its @ref PacketIter once to record it, and
+ * T2 for the others walks the recorded array instead of building a @ref PacketManager.
+ *
+ * A tile's key holds its coding parameters, progressions, size, and origin reduced
+ * modulo the coarsest resolution or precinct grid with lines close enough to the tile
+ * that packet positions depend on them. Tables are only shared when all components have the
+ * same subsampling, so that the precinct grids of all resolutions nest.
+ *
+ * Setting GRK_NO_PACKET_ORDER_TABLES before a codec is created makes every tile of that
+ * codec run its own @ref PacketIter.
+ */
+class PacketOrderCache
+{
+public:
+  PacketOrderCache();
+
+  /**
+   * @brief Gets the packet order of a T2 pass over a tile, recording it on first use
+   *
+   * Decompression walks all progressions of a whole tile decode. Compression walks one
+   * progression, without tile part generation; rate control simulation walks the single
+   * progression it uses outside cinema profiles, without a maximum component rate.
+   *
+   * @param tileProcessor @ref ITileProcessor of tile
+   * @param compression true for the compressor
+   * @param t2Mode @ref T2_MODE of the pass
+   * @param progIterNum progression of a compress pass
+   * @return shared packet order, or nullptr if the tile must run its own @ref PacketIter
+   */
+  std::shared_ptr<const PacketOrder> get(ITileProcessor* tileProcessor, bool compression,
+                                         T2_MODE t2Mode, uint32_t progIterNum);
+
+private:
+  /**
+   * @brief Generates the key of a tile's T2 pass
+   * @return false if the pass cannot share a packet order
+   */
+  static bool genKey(ITileProcessor* tileProcessor, bool compression, T2_MODE t2Mode,
+                     uint32_t progIterNum, std::vector<uint64_t>& key);
+
+  /**
+   * @brief Records the packet order of a tile's T2 pass by running its @ref PacketIter
+   * @return false if the pass has more than @ref maxPackets packets
+   */
+  static bool record(ITileProcessor* tileProcessor, bool compression, T2_MODE t2Mode,
+                     uint32_t progIterNum, PacketOrder& order);
+
+  /** largest packet order recorded, so that huge single tiles keep their iterator */
+  static constexpr size_t maxPackets = (size_t)1 << 18;
+  /** most distinct keys cached, so that irregular tilings keep their iterators */
+  static constexpr size_t maxOrders = 256;
+
+  /** false if every tile runs its own @ref PacketIter */
+  const bool enabled_;
+  std::mutex mutex_;
+  /** packet orders by key; a null order marks a key too large to record */
+  std::map<std::vector<uint64_t>, std::shared_ptr<const PacketOrder>> orders_;
+};
+
+} // namespace grk
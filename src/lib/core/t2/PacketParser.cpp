@@ -326,6 +326,7 @@ void PacketParser::readData(void)
     readDataFinalize();
     return;
   }
+  tileProcessor_->incNumReadCodedPackets(compno_, resno_);
   uint32_t layerDataOffset = 0;
   auto tile = tileProcessor_->getTile();
   auto res = tile->comps_[compno_].resolutions_ + resno_;
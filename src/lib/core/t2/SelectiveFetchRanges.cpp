@@ -49,69 +49,44 @@ uint64_t computeTotalPackets(const TilePacketInfo& info)
   return total;
 }
 
-// Internal: walk packets in progression order, yielding (compno, resno, precinctIndex, layno)
-// and whether the packet is needed for the target resolution.
-// Returns a vector of bools parallel to PLT lengths: true = needed, false = not needed.
-static std::vector<bool> computePacketMask(const TilePacketInfo& info,
-                                           uint8_t resolutionsToDecompress)
+// Internal: walk packets in progression order, calling visit(compno, resno, precinctIndex, layno)
+// for each. Assumes a single progression (no POC), and models the position-driven
+// progressions by precinct index, which matches the real order only when the
+// precinct grids line up (see canModelOrder).
+// Returns false for an unknown progression.
+template<typename V>
+static bool forEachPacket(const TilePacketInfo& info, V&& visit)
 {
-  uint64_t totalPackets = computeTotalPackets(info);
-  std::vector<bool> mask(totalPackets, false);
-
-  // We need to iterate in the same order as PacketIter would.
-  // For simplicity, assume single progression (no POC) and no subsampling
-  // (all components have same number of resolutions).
-
   uint8_t maxRes = 0;
   for(uint16_t c = 0; c < info.numComponents; ++c)
     maxRes = std::max(maxRes, info.numResolutions[c]);
 
-  uint64_t packetIndex = 0;
-
   switch(info.progression)
   {
     case GRK_LRCP:
       // Layer → Resolution → Component → Precinct
       for(uint16_t l = 0; l < info.numLayers; ++l)
-      {
         for(uint8_t r = 0; r < maxRes; ++r)
-        {
           for(uint16_t c = 0; c < info.numComponents; ++c)
           {
             if(r >= info.numResolutions[c])
               continue;
-            uint64_t numPrecincts = info.precinctsPerRes[c][r];
-            for(uint64_t p = 0; p < numPrecincts; ++p)
-            {
-              assert(packetIndex < totalPackets);
-              mask[packetIndex] = (r < resolutionsToDecompress);
-              packetIndex++;
-            }
+            for(uint64_t p = 0; p < info.precinctsPerRes[c][r]; ++p)
+              visit(c, r, p, l);
           }
-        }
-      }
       break;
 
     case GRK_RLCP:
       // Resolution → Layer → Component → Precinct
       for(uint8_t r = 0; r < maxRes; ++r)
-      {
         for(uint16_t l = 0; l < info.numLayers; ++l)
-        {
           for(uint16_t c = 0; c < info.numComponents; ++c)
           {
             if(r >= info.numResolutions[c])
               continue;
-            uint64_t numPrecincts = info.precinctsPerRes[c][r];
-            for(uint64_t p = 0; p < numPrecincts; ++p)
-            {
-              assert(packetIndex < totalPackets);
-              mask[packetIndex] = (r < resolutionsToDecompress);
-              packetIndex++;
-            }
+            for(uint64_t p = 0; p < info.precinctsPerRes[c][r]; ++p)
+              visit(c, r, p, l);
           }
-        }
-      }
       break;
 
     case GRK_RPCL:
@@ -126,21 +101,13 @@ static std::vector<bool> computePacketMask(const TilePacketInfo& info,
             maxPrecincts = std::max(maxPrecincts, info.precinctsPerRes[c][r]);
         }
         for(uint64_t p = 0; p < maxPrecincts; ++p)
-        {
           for(uint16_t c = 0; c < info.numComponents; ++c)
           {
-            if(r >= info.numResolutions[c])
-              continue;
-            if(p >= info.precinctsPerRes[c][r])
+            if(r >= info.numResolutions[c] || p >= info.precinctsPerRes[c][r])
               continue;
             for(uint16_t l = 0; l < info.numLayers; ++l)
-            {
-              assert(packetIndex < totalPackets);
-              mask[packetIndex] = (r < resolutionsToDecompress);
-              packetIndex++;
-            }
+              visit(c, r, p, l);
           }
-        }
       }
       break;
 
@@ -154,22 +121,14 @@ static std::vector<bool> computePacketMask(const TilePacketInfo& info,
             globalMaxPrecincts = std::max(globalMaxPrecincts, info.precinctsPerRes[c][r]);
 
         for(uint64_t p = 0; p < globalMaxPrecincts; ++p)
-        {
           for(uint16_t c = 0; c < info.numComponents; ++c)
-          {
             for(uint8_t r = 0; r < info.numResolutions[c]; ++r)
             {
               if(p >= info.precinctsPerRes[c][r])
                 continue;
               for(uint16_t l = 0; l < info.numLayers; ++l)
-              {
-                assert(packetIndex < totalPackets);
-                mask[packetIndex] = (r < resolutionsToDecompress);
-                packetIndex++;
-              }
+                visit(c, r, p, l);
             }
-          }
-        }
       }
       break;
 
@@ -182,110 +141,138 @@ static std::vector<bool> computePacketMask(const TilePacketInfo& info,
           compMaxPrecincts = std::max(compMaxPrecincts, info.precinctsPerRes[c][r]);
 
         for(uint64_t p = 0; p < compMaxPrecincts; ++p)
-        {
           for(uint8_t r = 0; r < info.numResolutions[c]; ++r)
           {
             if(p >= info.precinctsPerRes[c][r])
               continue;
             for(uint16_t l = 0; l < info.numLayers; ++l)
-            {
-              assert(packetIndex < totalPackets);
-              mask[packetIndex] = (r < resolutionsToDecompress);
-              packetIndex++;
-            }
+              visit(c, r, p, l);
           }
-        }
       }
       break;
 
     default:
-      return {};
+      return false;
   }
 
-  assert(packetIndex == totalPackets);
-  return mask;
+  return true;
 }
 
-std::vector<FetchRange> computeSelectiveFetchRanges(const TilePacketInfo& info,
-                                                    uint8_t resolutionsToDecompress,
-                                                    uint64_t gapThreshold)
+// The position-driven progressions interleave precincts by their position on
+// the canvas, which the index-based model in forEachPacket only reproduces when
+// no resolution has more than one precinct (PCRL, CPRL), or when every
+// component shares the precinct grid at each resolution (RPCL).
+static bool canModelOrder(const TilePacketInfo& info)
 {
-  if(info.pltLengths.empty() || info.numComponents == 0)
-    return {};
-
-  // Validate
-  uint64_t totalPackets = computeTotalPackets(info);
-  if(info.pltLengths.size() != totalPackets)
-    return {};
+  switch(info.progression)
+  {
+    case GRK_PCRL:
+    case GRK_CPRL:
+      for(uint16_t c = 0; c < info.numComponents; ++c)
+        for(uint8_t r = 0; r < info.numResolutions[c]; ++r)
+          if(info.precinctsPerRes[c][r] > 1)
+            return false;
+      return true;
+    case GRK_RPCL:
+      for(uint16_t c = 1; c < info.numComponents; ++c)
+        if(info.precinctsPerRes[c] != info.precinctsPerRes[0])
+          return false;
+      return true;
+    default:
+      return true;
+  }
+}
 
-  // If requesting all resolutions, return single range covering everything
-  uint8_t maxRes = 0;
+static bool keepsEverything(const TilePacketInfo& info, const PacketSelection& selection)
+{
   for(uint16_t c = 0; c < info.numComponents; ++c)
-    maxRes = std::max(maxRes, info.numResolutions[c]);
-  if(resolutionsToDecompress >= maxRes)
   {
-    uint64_t totalBytes = 0;
-    for(auto len : info.pltLengths)
-      totalBytes += len;
-    return {{0, totalBytes}};
+    if(selection.resolutionsToDecompress < info.numResolutions[c])
+      return false;
+    if(!selection.components.empty() &&
+       (c >= selection.components.size() || !selection.components[c]))
+      return false;
+    if(c < selection.precincts.size())
+    {
+      for(auto& mask : selection.precincts[c])
+        if(std::find(mask.begin(), mask.end(), false) != mask.end())
+          return false;
+    }
   }
+  return selection.layersToDecompress >= info.numLayers;
+}
 
-  auto mask = computePacketMask(info, resolutionsToDecompress);
-  if(mask.empty())
-    return {};
+SelectiveFetchPlan planSelectiveFetch(const TilePacketInfo& info, const PacketSelection& selection,
+                                      uint64_t gapThreshold)
+{
+  SelectiveFetchPlan plan;
+  if(info.pltLengths.empty() || info.numComponents == 0 ||
+     info.numResolutions.size() < info.numComponents ||
+     info.precinctsPerRes.size() < info.numComponents)
+    return plan;
 
-  // Build ranges from mask + PLT lengths
-  std::vector<FetchRange> ranges;
-  uint64_t offset = 0;
-  bool inRange = false;
-  uint64_t rangeStart = 0;
+  // Validate
+  uint64_t totalPackets = computeTotalPackets(info);
+  if(info.pltLengths.size() != totalPackets)
+    return plan;
+  for(auto len : info.pltLengths)
+    plan.totalBytes += len;
 
-  for(uint64_t i = 0; i < totalPackets; ++i)
+  // everything requested: single range covering all packets
+  if(keepsEverything(info, selection))
   {
-    if(mask[i])
-    {
-      if(!inRange)
-      {
-        rangeStart = offset;
-        inRange = true;
-      }
-    }
-    else
-    {
-      if(inRange)
-      {
-        ranges.push_back({rangeStart, offset - rangeStart});
-        inRange = false;
-      }
-    }
-    offset += info.pltLengths[i];
+    plan.ranges.push_back({0, plan.totalBytes});
+    plan.fetchedPackets.assign(totalPackets, true);
+    return plan;
   }
-  if(inRange)
-    ranges.push_back({rangeStart, offset - rangeStart});
-
-  // Coalesce ranges separated by small gaps
-  if(gapThreshold > 0 && ranges.size() > 1)
+  if(!canModelOrder(info))
+    return plan;
+
+  std::vector<bool> wanted;
+  wanted.reserve(totalPackets);
+  if(!forEachPacket(info, [&](uint16_t c, uint8_t r, uint64_t p, uint16_t l) {
+       wanted.push_back(selection.keeps(c, r, p, l));
+     }))
+    return plan;
+  assert(wanted.size() == totalPackets);
+
+  // Build ranges from wanted packets + PLT lengths, merging across gaps up to
+  // the threshold. Merged gap packets are fetched too, so they are flagged as such.
+  plan.fetchedPackets.assign(totalPackets, false);
+  uint64_t offset = 0;
+  uint64_t lastWanted = 0; // index of the last wanted packet, valid when ranges exist
+  for(uint64_t i = 0; i < totalPackets; ++i)
   {
-    std::vector<FetchRange> coalesced;
-    coalesced.push_back(ranges[0]);
-    for(size_t i = 1; i < ranges.size(); ++i)
+    uint64_t len = info.pltLengths[i];
+    if(wanted[i])
     {
-      auto& prev = coalesced.back();
-      uint64_t gap = ranges[i].offset - prev.end();
-      if(gap <= gapThreshold)
+      if(!plan.ranges.empty() && offset - plan.ranges.back().end() <= gapThreshold)
       {
-        // Merge: extend previous range to cover gap + next range
-        prev.length = ranges[i].end() - prev.offset;
+        for(uint64_t j = lastWanted + 1; j <= i; ++j)
+          plan.fetchedPackets[j] = true;
+        plan.ranges.back().length = offset + len - plan.ranges.back().offset;
       }
       else
       {
-        coalesced.push_back(ranges[i]);
+        plan.fetchedPackets[i] = true;
+        plan.ranges.push_back({offset, len});
       }
+      lastWanted = i;
     }
-    return coalesced;
+    offset += len;
   }
 
-  return ranges;
+  return plan;
+}
+
+std::vector<FetchRange> computeSelectiveFetchRanges(const TilePacketInfo& info,
+                                                    uint8_t resolutionsToDecompress,
+                                                    uint64_t gapThreshold)
+{
+  PacketSelection selection;
+  selection.resolutionsToDecompress = resolutionsToDecompress;
+
+  return planSelectiveFetch(info, selection, gapThreshold).ranges;
 }
 
 TilePartHeaderInfo extractTilePartHeaderInfo(const uint8_t* headerData, size_t headerSize)
@@ -399,4 +386,52 @@ uint64_t computeNumPrecincts(uint32_t tcx0, uint32_t tcy0, uint32_t tcx1, uint32
   return (uint64_t)gridW * gridH;
 }
 
+std::vector<bool> computeWindowPrecincts(uint32_t tcx0, uint32_t tcy0, uint32_t tcx1,
+                                         uint32_t tcy1, uint8_t numResolutions, uint8_t resno,
+                                         uint8_t precWidthExp, uint8_t precHeightExp, uint32_t wx0,
+                                         uint32_t wy0, uint32_t wx1, uint32_t wy1, uint32_t padding)
+{
+  // Scale tile-component bounds and window to resolution level
+  uint8_t power = (uint8_t)(numResolutions - 1U - resno);
+  uint32_t rx0 = ceildivpow2_local(tcx0, power);
+  uint32_t ry0 = ceildivpow2_local(tcy0, power);
+  uint32_t rx1 = ceildivpow2_local(tcx1, power);
+  uint32_t ry1 = ceildivpow2_local(tcy1, power);
+  if(rx1 <= rx0 || ry1 <= ry0)
+    return {};
+
+  uint64_t winX0 = floordivpow2_local(wx0, power);
+  uint64_t winY0 = floordivpow2_local(wy0, power);
+  uint64_t winX1 = (uint64_t)ceildivpow2_local<uint64_t>(wx1, power) + padding;
+  uint64_t winY1 = (uint64_t)ceildivpow2_local<uint64_t>(wy1, power) + padding;
+  winX0 = winX0 > padding ? winX0 - padding : 0;
+  winY0 = winY0 > padding ? winY0 - padding : 0;
+
+  // Precinct grid, as in computeNumPrecincts
+  uint32_t adjX0 = floordivpow2_local(rx0, precWidthExp) << precWidthExp;
+  uint32_t adjY0 = floordivpow2_local(ry0, precHeightExp) << precHeightExp;
+  uint32_t adjX1 = ceildivpow2_local(rx1, precWidthExp) << precWidthExp;
+  uint32_t adjY1 = ceildivpow2_local(ry1, precHeightExp) << precHeightExp;
+  uint32_t gridW = (adjX1 - adjX0) >> precWidthExp;
+  uint32_t gridH = (adjY1 - adjY0) >> precHeightExp;
+
+  std::vector<bool> mask((uint64_t)gridW * gridH, false);
+  for(uint32_t py = 0; py < gridH; ++py)
+  {
+    uint64_t y0 = std::max<uint64_t>(adjY0 + ((uint64_t)py << precHeightExp), ry0);
+    uint64_t y1 = std::min<uint64_t>(adjY0 + ((uint64_t)(py + 1) << precHeightExp), ry1);
+    if(y1 <= winY0 || y0 >= winY1)
+      continue;
+    for(uint32_t px = 0; px < gridW; ++px)
+    {
+      uint64_t x0 = std::max<uint64_t>(adjX0 + ((uint64_t)px << precWidthExp), rx0);
+      uint64_t x1 = std::min<uint64_t>(adjX0 + ((uint64_t)(px + 1) << precWidthExp), rx1);
+      if(x1 > winX0 && x0 < winX1)
+        mask[(uint64_t)py * gridW + px] = true;
+    }
+  }
+
+  return mask;
+}
+
 } // namespace grk
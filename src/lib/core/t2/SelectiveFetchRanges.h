@@ -22,20 +22,7 @@
 #include <vector>
 
 #include "grok.h"
-
-#ifdef _WIN32
-#ifdef GRK_STATIC
-#define GRK_INTERNAL
-#else
-#ifdef GRK_EXPORTS
-#define GRK_INTERNAL __declspec(dllexport)
-#else
-#define GRK_INTERNAL __declspec(dllimport)
-#endif
-#endif
-#else
-#define GRK_INTERNAL __attribute__((visibility("default")))
-#endif
+#include "grk_internal.h"
 
 namespace grk
 {
@@ -70,6 +57,78 @@ struct TilePacketInfo
   std::vector<uint32_t> pltLengths;
 };
 
+/**
+ * @brief Packets a decode needs, in terms of the tile's packet structure
+ *
+ * A packet is kept when its resolution, layer and component are all kept and
+ * its precinct intersects the decode window. Defaults keep everything.
+ */
+struct PacketSelection
+{
+  uint8_t resolutionsToDecompress = UINT8_MAX; ///< resolutions to keep (1 = lowest only)
+  uint16_t layersToDecompress = UINT16_MAX; ///< quality layers to keep
+  /// components to keep, empty = all
+  std::vector<bool> components;
+  /// precincts to keep per component per resolution [comp][res][precinct], empty = all
+  std::vector<std::vector<std::vector<bool>>> precincts;
+
+  bool keeps(uint16_t compno, uint8_t resno, uint64_t precinctIndex, uint16_t layno) const
+  {
+    if(resno >= resolutionsToDecompress || layno >= layersToDecompress)
+      return false;
+    if(!components.empty() && (compno >= components.size() || !components[compno]))
+      return false;
+    if(precincts.empty() || compno >= precincts.size() || resno >= precincts[compno].size())
+      return true;
+    auto& mask = precincts[compno][resno];
+    return mask.empty() || (precinctIndex < mask.size() && mask[precinctIndex]);
+  }
+};
+
+/**
+ * @brief Byte ranges to fetch for one tile, and the packets they hold
+ */
+struct SelectiveFetchPlan
+{
+  /// ranges within the tile's packet data, in ascending order
+  std::vector<FetchRange> ranges;
+  /// one flag per packet in progression order: true if the packet lies inside a range.
+  /// Gap coalescing can pull in packets the selection did not ask for.
+  std::vector<bool> fetchedPackets;
+  /// size of all of the tile's packet data
+  uint64_t totalBytes = 0;
+
+  uint64_t fetchBytes(void) const
+  {
+    uint64_t bytes = 0;
+    for(auto& r : ranges)
+      bytes += r.length;
+    return bytes;
+  }
+};
+
+/**
+ * @brief Plans a selective fetch down to precinct granularity
+ *
+ * Walks the packets in progression order, keeps those the selection needs and
+ * turns them into byte ranges using the PLT packet lengths. Ranges separated by
+ * a gap of at most @p gapThreshold bytes are merged, since one larger request is
+ * cheaper than two when the gap transfers faster than a request round trip.
+ *
+ * The plan is empty when packet order can't be reproduced from the tile structure
+ * alone: PLT count mismatch, or a position-driven progression (PCRL, CPRL, or RPCL
+ * with differing precinct grids) with more than one precinct per resolution.
+ * Callers then fetch whole tile parts.
+ *
+ * @param info tile packet structure info including PLT lengths
+ * @param selection packets to keep
+ * @param gapThreshold merge ranges separated by gaps up to this size (bytes)
+ * @return plan, with no ranges on error
+ */
+GRK_INTERNAL SelectiveFetchPlan planSelectiveFetch(const TilePacketInfo& info,
+                                                   const PacketSelection& selection,
+                                                   uint64_t gapThreshold = 0);
+
 /**
  * @brief Computes byte ranges needed for selective resolution fetch
  *
@@ -117,7 +176,7 @@ struct TilePartHeaderInfo
 struct TileHeaderResult
 {
   std::vector<TilePartHeaderInfo> headerInfos; ///< parsed PLT + SOD per tile-part
-  std::vector<std::unique_ptr<uint8_t[]>> headerData; ///< raw header bytes per tile-part
+  std::vector<std::shared_ptr<uint8_t[]>> headerData; ///< raw header bytes per tile-part
   std::vector<uint32_t> headerSizes; ///< actual byte count fetched per tile-part
 };
 
@@ -150,4 +209,25 @@ GRK_INTERNAL uint64_t computeNumPrecincts(uint32_t tcx0, uint32_t tcy0, uint32_t
                                           uint32_t tcy1, uint8_t numResolutions, uint8_t resno,
                                           uint8_t precWidthExp, uint8_t precHeightExp);
 
+/**
+ * @brief Flags the precincts of one resolution that intersect a decode window
+ *
+ * The window is padded at the resolution's scale so that precincts feeding the
+ * wavelet filter support around the window are kept as well.
+ *
+ * @param tcx0 tile-component bounds (tile bounds scaled by component subsampling)
+ * @param numResolutions total resolutions for this component
+ * @param resno resolution index (0 = lowest)
+ * @param precWidthExp log2 of precinct width for this resolution
+ * @param precHeightExp log2 of precinct height for this resolution
+ * @param wx0 decode window in tile-component coordinates, at full resolution
+ * @param padding window padding, in samples at resolution @p resno
+ * @return one flag per precinct, in precinct index order
+ */
+GRK_INTERNAL std::vector<bool>
+    computeWindowPrecincts(uint32_t tcx0, uint32_t tcy0, uint32_t tcx1, uint32_t tcy1,
+                           uint8_t numResolutions, uint8_t resno, uint8_t precWidthExp,
+                           uint8_t precHeightExp, uint32_t wx0, uint32_t wy0, uint32_t wx1,
+                           uint32_t wy1, uint32_t padding);
+
 } // namespace grk
@@ -57,6 +57,7 @@ struct ITileProcessorCompress;
 #include "CodecScheduler.h"
 #include "TileComponentWindow.h"
 #include "PacketManager.h"
+#include "PacketOrder.h"
 #include "canvas/tile/Tile.h"
 #include "ITileProcessor.h"
 #include "T2Compress.h"
@@ -82,14 +83,53 @@ bool T2Compress::compressPacketsSimulate(uint16_t tile_no, uint16_t max_layers,
   // each component length meets spec. Otherwise, set to 1.
   uint32_t max_comp = cp->codingParams_.enc_.maxComponentRate_ > 0 ? image->numcomps : 1;
 
-  PacketManager packetManager(true, image, cp, tile_no, THRESH_CALC, tileProcessor);
   *allPacketBytes = 0;
   tileProcessor->getPacketTracker()->clear();
   if(markers)
     markers->pushInit(isFinal);
+  uint64_t componentBytes = 0;
+  auto simulate = [&](const PacketOrderEntry& packet) {
+    if(packet.layno >= max_layers)
+      return true;
+    uint32_t bytesInLayer = 0;
+    if(!compressPacketSimulate(tcp, packet, &bytesInLayer, maxBytes, markers, debug))
+      return false;
+
+    componentBytes += bytesInLayer;
+    if(maxBytes != UINT_MAX)
+    {
+      if(maxBytes < bytesInLayer)
+      {
+        grklog.error("compressPacketsSimulate: max bytes %d is smaller than bytes in layer %d",
+                     maxBytes, bytesInLayer);
+        return false;
+      }
+      maxBytes -= bytesInLayer;
+    }
+    *allPacketBytes += bytesInLayer;
+    if(cp->codingParams_.enc_.maxComponentRate_ &&
+       componentBytes > cp->codingParams_.enc_.maxComponentRate_)
+      return false;
+    return true;
+  };
+
+  // rate control simulates the same packets many times, so tiles that share their
+  // geometry and progression walk one recorded packet order
+  auto packetOrder = cp->packetOrders_->get(tileProcessor, true, THRESH_CALC, 0);
+  if(packetOrder)
+  {
+    for(const auto& packet : *packetOrder)
+    {
+      if(!simulate(packet))
+        return false;
+    }
+    return true;
+  }
+
+  PacketManager packetManager(true, image, cp, tile_no, THRESH_CALC, tileProcessor);
   for(uint16_t compno = 0; compno < max_comp; ++compno)
   {
-    uint64_t componentBytes = 0;
+    componentBytes = 0;
     for(uint32_t poc = 0; poc < pocno; ++poc)
     {
       auto current_pi = packetManager.getPacketIter(poc);
@@ -102,44 +142,24 @@ bool T2Compress::compressPacketsSimulate(uint16_t tile_no, uint16_t max_layers,
       }
       while(current_pi->next(nullptr))
       {
-        if(current_pi->getLayno() < max_layers)
-        {
-          uint32_t bytesInLayer = 0;
-          if(!compressPacketSimulate(tcp, current_pi, &bytesInLayer, maxBytes, markers, debug))
-            return false;
-
-          componentBytes += bytesInLayer;
-          if(maxBytes != UINT_MAX)
-          {
-            if(maxBytes < bytesInLayer)
-            {
-              grklog.error(
-                  "compressPacketsSimulate: max bytes %d is smaller than bytes in layer %d",
-                  maxBytes, bytesInLayer);
-              return false;
-            }
-            maxBytes -= bytesInLayer;
-          }
-          *allPacketBytes += bytesInLayer;
-          if(cp->codingParams_.enc_.maxComponentRate_ &&
-             componentBytes > cp->codingParams_.enc_.maxComponentRate_)
-            return false;
-        }
+        if(!simulate({current_pi->getPrecinctIndex(), current_pi->getCompno(),
+                      current_pi->getLayno(), current_pi->getResno()}))
+          return false;
       }
     }
   }
 
   return true;
 }
-bool T2Compress::compressPacketSimulate(TileCodingParams* tcp, PacketIter* pi,
+bool T2Compress::compressPacketSimulate(TileCodingParams* tcp, const PacketOrderEntry& packet,
                                         uint32_t* packet_bytes_written,
                                         uint32_t max_bytes_available, PLMarker* markers,
                                         [[maybe_unused]] bool debug)
 {
-  uint16_t compno = pi->getCompno();
-  uint8_t resno = pi->getResno();
-  uint64_t precinctIndex = pi->getPrecinctIndex();
-  uint16_t layno = pi->getLayno();
+  uint16_t compno = packet.compno;
+  uint8_t resno = packet.resno;
+  uint64_t precinctIndex = packet.precinctIndex;
+  uint16_t layno = packet.layno;
   auto tile = tileProcessor->getTile();
   auto tilec = tile->comps_ + compno;
   auto res = tilec->resolutions_ + resno;
@@ -229,6 +249,29 @@ bool T2Compress::compressPackets(uint16_t tile_no, uint16_t max_layers, IStream*
   auto cp = tileProcessor->getCodingParams();
   auto image = tileProcessor->getHeaderImage();
   auto tcp = tileProcessor->getTCP();
+  auto compress = [&](const PacketOrderEntry& packet) {
+    if(packet.layno >= max_layers)
+      return true;
+    uint32_t numBytes = 0;
+    if(!compressPacket(tcp, packet, stream, &numBytes))
+      return false;
+    *tileBytesWritten += numBytes;
+    return true;
+  };
+
+  // without tile part generation, the pass walks the progression's whole packet order,
+  // which tiles that share their geometry share
+  auto packetOrder = cp->packetOrders_->get(tileProcessor, true, FINAL_PASS, prog_iter_num);
+  if(packetOrder)
+  {
+    for(const auto& packet : *packetOrder)
+    {
+      if(!compress(packet))
+        return false;
+    }
+    return true;
+  }
+
   PacketManager packetManager(true, image, cp, tile_no, FINAL_PASS, tileProcessor);
   packetManager.enable_tile_part_generation(prog_iter_num, first_poc_tile_part,
                                             newTilePartProgressionPosition);
@@ -240,13 +283,9 @@ bool T2Compress::compressPackets(uint16_t tile_no, uint16_t max_layers, IStream*
   }
   while(current_pi->next(nullptr))
   {
-    if(current_pi->getLayno() < max_layers)
-    {
-      uint32_t numBytes = 0;
-      if(!compressPacket(tcp, current_pi, stream, &numBytes))
-        return false;
-      *tileBytesWritten += numBytes;
-    }
+    if(!compress({current_pi->getPrecinctIndex(), current_pi->getCompno(), current_pi->getLayno(),
+                  current_pi->getResno()}))
+      return false;
   }
 
   return true;
@@ -391,15 +430,15 @@ bool T2Compress::compressHeader(t1_t2::BitIO* bio, Resolution* res, uint16_t lay
 
   return true;
 }
-bool T2Compress::compressPacket(TileCodingParams* tcp, PacketIter* pi, IStream* stream,
-                                uint32_t* packet_bytes_written)
+bool T2Compress::compressPacket(TileCodingParams* tcp, const PacketOrderEntry& packet,
+                                IStream* stream, uint32_t* packet_bytes_written)
 {
   assert(stream);
 
-  uint16_t compno = pi->getCompno();
-  uint8_t resno = pi->getResno();
-  uint64_t precinctIndex = pi->getPrecinctIndex();
-  uint16_t layno = pi->getLayno();
+  uint16_t compno = packet.compno;
+  uint8_t resno = packet.resno;
+  uint64_t precinctIndex = packet.precinctIndex;
+  uint16_t layno = packet.layno;
   auto tile = tileProcessor->getTile();
   auto tilec = tile->comps_ + compno;
   size_t stream_start = stream->tell();
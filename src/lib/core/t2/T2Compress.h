@@ -20,6 +20,7 @@
 namespace grk
 {
 struct ITileProcessor;
+struct PacketOrderEntry;
 
 /**
  Tier-2 coding
@@ -65,18 +66,18 @@ private:
   /**
    Encode a packet of a tile to a destination buffer
    @param tcp 			Tile coding parameters
-   @param pi 				packet iterator
+   @param packet 			packet
    @param stream 			stream
    @param p_data_written  amount of data written
    @return
    */
-  bool compressPacket(TileCodingParams* tcp, PacketIter* pi, IStream* stream,
+  bool compressPacket(TileCodingParams* tcp, const PacketOrderEntry& packet, IStream* stream,
                       uint32_t* p_data_written);
 
   /**
    * Encode a packet of a tile to a destination buffer
    * @param tcp 			Tile coding parameters
-   * @param pi 				packet iterator
+   * @param packet 			packet
    * @param p_data_written  amount of data written
    * @param len 			length of the destination buffer
    * @param markers			packet length markers
@@ -84,8 +85,9 @@ private:
    *
    * @return true if successful
    */
-  bool compressPacketSimulate(TileCodingParams* tcp, PacketIter* pi, uint32_t* p_data_written,
-                              uint32_t len, PLMarker* markers, bool debug);
+  bool compressPacketSimulate(TileCodingParams* tcp, const PacketOrderEntry& packet,
+                              uint32_t* p_data_written, uint32_t len, PLMarker* markers,
+                              bool debug);
 
   bool compressHeader(t1_t2::BitIO* bio, Resolution* res, uint16_t layno, uint64_t precinctIndex);
 };
@@ -56,6 +56,7 @@ struct ITileProcessor;
 #include "CodecScheduler.h"
 #include "TileComponentWindow.h"
 #include "PacketManager.h"
+#include "PacketOrder.h"
 #include "canvas/tile/Tile.h"
 #include "ITileProcessor.h"
 #include "T2Decompress.h"
@@ -68,11 +69,6 @@ bool T2Decompress::parsePackets(uint16_t tile_no, PacketCache* compressedPackets
 {
   auto cp = tileProcessor->getCodingParams();
   auto tcp = tileProcessor->getTCP();
-  PacketManager packetManager(false, tileProcessor->getHeaderImage(), cp, tile_no, FINAL_PASS,
-                              tileProcessor);
-  auto pltMarkers = tileProcessor->getPacketLengthCache()->getMarkers();
-  if(pltMarkers && !pltMarkers->isEnabled())
-    pltMarkers = nullptr;
   // Bound the PLT skip-corrupt-packet path: the smallest legal packet with no
   // SOP/EPH is a 1-byte header, so a tile cannot hold more packets than it has
   // compressed bytes. A malformed precinct grid can declare far more packets
@@ -80,71 +76,96 @@ bool T2Decompress::parsePackets(uint16_t tile_no, PacketCache* compressedPackets
   // grid. Once skips exceed the byte budget the grid is provably lying.
   const size_t maxCorruptSkips = compressedPackets->length();
   size_t corruptSkips = 0;
-  for(auto prog_iter_num = 0U; prog_iter_num < tcp->getNumProgressions(); ++prog_iter_num)
-  {
-    auto currPi = packetManager.getPacketIter(prog_iter_num);
-    while(currPi->next(pltMarkers ? compressedPackets : nullptr))
+  // returns false once the tile is truncated or its packets can no longer be parsed
+  auto parse = [&](uint16_t compno, uint8_t resno, uint64_t precinctIndex, uint16_t layno) {
+    // code below is written this way as chunkLength() can throw, also indicating truncated tile
+    // With selective fetch, the buffer may be exhausted for skipped (unfetched) packets,
+    // so we only check for truncation when not in selective fetch mode.
+    if(!compressedPackets->isSelectiveFetch())
     {
-      // code below is written this way as chunkLength() can throw, also indicating truncated tile
-      // With selective fetch, the buffer may be exhausted for skipped (unfetched) packets,
-      // so we only check for truncation when not in selective fetch mode.
-      if(!compressedPackets->isSelectiveFetch())
+      try
       {
-        try
+        if(compressedPackets->chunkLength() == 0)
         {
-          if(compressedPackets->chunkLength() == 0)
-          {
-            throw SparseBufferIncompleteException();
-          }
-        }
-        catch(SparseBufferIncompleteException& sbie)
-        {
-          grklog.warn("Tile %u is truncated.", tile_no);
-          return true;
+          throw SparseBufferIncompleteException();
         }
       }
+      catch(SparseBufferIncompleteException& sbie)
+      {
+        grklog.warn("Tile %u is truncated.", tile_no);
+        return false;
+      }
+    }
 
-      try
+    try
+    {
+      if(!parsePacket(compno, resno, precinctIndex, layno, compressedPackets))
       {
-        if(!parsePacket(currPi->getCompno(), currPi->getResno(), currPi->getPrecinctIndex(),
-                        currPi->getLayno(), compressedPackets))
-        {
-          return true;
-        }
+        return false;
       }
-      catch([[maybe_unused]] const t1_t2::TruncatedPacketHeaderException& tex)
+    }
+    catch([[maybe_unused]] const t1_t2::TruncatedPacketHeaderException& tex)
+    {
+      grklog.warn("Truncated packet: tile=%u component=%02d resolution=%02d precinct=%03d "
+                  "layer=%02d",
+                  tile_no, compno, resno, precinctIndex, layno);
+      return false;
+    }
+    catch([[maybe_unused]] const t1::CorruptPacketException& cex)
+    {
+      // we can skip corrupt packet if PLT markers are present
+      if(!tileProcessor->getPacketLengthCache()->getMarkers())
       {
-        grklog.warn("Truncated packet: tile=%u component=%02d resolution=%02d precinct=%03d "
+        grklog.warn("Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
                     "layer=%02d",
-                    tile_no, currPi->getCompno(), currPi->getResno(), currPi->getPrecinctIndex(),
-                    currPi->getLayno());
-        return true;
+                    tile_no, compno, resno, precinctIndex, layno);
+        return false;
       }
-      catch([[maybe_unused]] const t1::CorruptPacketException& cex)
+      else
       {
-        // we can skip corrupt packet if PLT markers are present
-        if(!tileProcessor->getPacketLengthCache()->getMarkers())
-        {
-          grklog.warn("Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
-                      "layer=%02d",
-                      tile_no, currPi->getCompno(), currPi->getResno(), currPi->getPrecinctIndex(),
-                      currPi->getLayno());
-          return true;
-        }
-        else
+        grklog.warn("Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
+                    "layer=%02d",
+                    tile_no, compno, resno, precinctIndex, layno);
+        if(++corruptSkips > maxCorruptSkips)
         {
-          grklog.warn("Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
-                      "layer=%02d",
-                      tile_no, currPi->getCompno(), currPi->getResno(), currPi->getPrecinctIndex(),
-                      currPi->getLayno());
-          if(++corruptSkips > maxCorruptSkips)
-          {
-            grklog.warn("Tile %u is truncated.", tile_no);
-            return true;
-          }
+          grklog.warn("Tile %u is truncated.", tile_no);
+          return false;
         }
-        // ToDo: skip corrupt packet if SOP marker is present
       }
+      // ToDo: skip corrupt packet if SOP marker is present
+    }
+    return true;
+  };
+
+  // tiles that share their geometry and progressions walk one recorded packet order
+  auto packetOrder = cp->packetOrders_->get(tileProcessor, false, FINAL_PASS, 0);
+  if(packetOrder)
+  {
+    for(const auto& packet : *packetOrder)
+    {
+      if(!parse(packet.compno, packet.resno, packet.precinctIndex, packet.layno))
+        return true;
+    }
+    return false;
+  }
+
+  PacketManager packetManager(false, tileProcessor->getHeaderImage(), cp, tile_no, FINAL_PASS,
+                              tileProcessor);
+  auto pltMarkers = tileProcessor->getPacketLengthCache()->getMarkers();
+  if(pltMarkers && !pltMarkers->isEnabled())
+    pltMarkers = nullptr;
+  for(auto prog_iter_num = 0U; prog_iter_num < tcp->getNumProgressions(); ++prog_iter_num)
+  {
+    auto currPi = packetManager.getPacketIter(prog_iter_num);
+    // the iterator's PLT precinct skipping assumes every packet's bytes are in the
+    // buffer, which selective fetch breaks, so selective tiles visit every packet
+    auto skipBuffer =
+        pltMarkers && !compressedPackets->isSelectiveFetch() ? compressedPackets : nullptr;
+    while(currPi->next(skipBuffer))
+    {
+      if(!parse(currPi->getCompno(), currPi->getResno(), currPi->getPrecinctIndex(),
+                currPi->getLayno()))
+        return true;
     }
   }
 
@@ -190,6 +211,11 @@ bool T2Decompress::parsePacket(uint16_t compno, uint8_t resno, uint64_t precinct
     }
   }
 
+  // 2.5 with selective fetch, only packets inside the fetched ranges have data
+  bool fetched = packetCache->isPacketFetched(tileProcessor->getNumProcessedPackets());
+  if(!fetched)
+    skip = true;
+
   // read from PL cache or PLM or PLT marker, if available
   auto packetLength = tileProcessor->getPacketLengthCache()->next();
 
@@ -252,8 +278,7 @@ bool T2Decompress::parsePacket(uint16_t compno, uint8_t resno, uint64_t precinct
   // 7. compressedPackets can now increment to next packet
   try
   {
-    bool dataPresent = !skip || !packetCache->isSelectiveFetch();
-    packetCache->next(packetLength, dataPresent);
+    packetCache->next(packetLength, fetched);
   }
   catch([[maybe_unused]] const SparseBufferOverrunException& sboe)
   {
@@ -44,6 +44,7 @@ inline void validateTilePartIndex(uint16_t tileIndex, uint8_t tilePart, uint8_t
 
 class Mct;
 class CodecScheduler;
+class CodeblockCache;
 
 /**
  * @struct ITileProcessor
@@ -253,6 +254,21 @@ struct ITileProcessor
    */
   virtual void incNumReadDataPackets(void) = 0;
 
+  /**
+   * @brief Increments the number of read data packets that carried coding passes
+   * @param compno component of the packet
+   * @param resno resolution of the packet
+   */
+  virtual void incNumReadCodedPackets(uint16_t compno, uint8_t resno) = 0;
+
+  /**
+   * @brief Gets the lowest resolution of a component whose packets carried coding
+   * passes in the current decompress
+   * @param compno component number
+   * @return resolution number, or UINT8_MAX if no packet of the component did
+   */
+  virtual uint8_t lowestCodedResolution(uint16_t compno) = 0;
+
   /**
    * @brief Gets the tile cache strategy
    * @return The tile cache strategy value
@@ -289,6 +305,20 @@ struct ITileProcessor
    */
   virtual std::shared_ptr<PacketLengthCache<uint32_t>> getPacketLengthCache(void) = 0;
 
+  /**
+   * @brief Gets the code stream's decoded code block cache
+   * @return Pointer to CodeblockCache, or nullptr when compressing
+   */
+  virtual CodeblockCache* getCodeblockCache(void) = 0;
+
+  /**
+   * @brief Writes the overview levels captured during the last decompress into their
+   * images, then frees them
+   * @param levels images indexed by reduction, null where no level was requested
+   * @param numLevels number of entries in @p levels
+   */
+  virtual void compositePyramid(GrkImage* const* levels, uint8_t numLevels) = 0;
+
   /**
    * @brief Checks if MCT decompression is needed for a specific component
    * @param compno Component number
@@ -387,6 +417,16 @@ struct ITileProcessor
 
   virtual bool scheduledForDecompression(void) = 0;
 
+  /**
+   * @brief Gets the total length of the tile parts parsed so far
+   */
+  virtual uint64_t getCompressedLength(void) = 0;
+
+  /**
+   * @brief Gets the bytes of coefficient buffers the tile still holds
+   */
+  virtual uint64_t getAllocatedBytes(void) = 0;
+
   /**
    * @brief Reinitialize for re-decompression after LRU eviction.
    *
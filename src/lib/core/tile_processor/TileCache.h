@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <mutex>
 #include <atomic>
+#include <functional>
 
 namespace grk
 {
@@ -179,6 +180,50 @@ public:
     return maxActiveTiles_;
   }
 
+  /**
+   * @brief Keep LRU order even without a max_active_tiles limit, so that a memory
+   * budget can evict through evictLRU(const std::function<bool(uint16_t)>&)
+   */
+  void setTrackLRU(bool track)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trackLRU_ = track;
+    if(!track && maxActiveTiles_ == 0)
+      lruList_.clear();
+  }
+
+  /**
+   * @brief Set a hook that runs whenever a tile's data is released, with the cache locked
+   */
+  void setReleaseHook(std::function<void(uint16_t, ITileProcessor*)> hook)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    releaseHook_ = std::move(hook);
+  }
+
+  /**
+   * @brief Evict the least recently used tile that @p evictable accepts, as
+   * max_active_tiles does: its decompressed coefficients are released via
+   * GRK_TILE_CACHE_LRU, and its image and compressed data are kept.
+   *
+   * @return true if a tile was evicted
+   */
+  bool evictLRU(const std::function<bool(uint16_t)>& evictable)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto it = lruList_.rbegin(); it != lruList_.rend(); ++it)
+    {
+      uint16_t victim = *it;
+      if(victim >= cache_.size() || !cache_[victim] || !cache_[victim]->processor() ||
+         !evictable(victim))
+        continue;
+      lruList_.erase(std::next(it).base());
+      releaseEntry(victim, GRK_TILE_CACHE_LRU);
+      return true;
+    }
+    return false;
+  }
+
   void setTruncated(void)
   {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -265,7 +310,7 @@ public:
     if(tileIndex >= cache_.size())
       return;
     if(cache_[tileIndex] && cache_[tileIndex]->processor())
-      cache_[tileIndex]->processor()->release(strategy_);
+      releaseEntry(tileIndex, strategy_);
   }
 
   /**
@@ -281,7 +326,12 @@ public:
     if(tileIndex >= cache_.size())
       return;
     if(cache_[tileIndex] && cache_[tileIndex]->processor())
-      cache_[tileIndex]->processor()->releaseForSwath();
+    {
+      auto processor = cache_[tileIndex]->processor();
+      processor->releaseForSwath();
+      if(releaseHook_)
+        releaseHook_(tileIndex, processor);
+    }
   }
 
   /**
@@ -291,8 +341,11 @@ public:
   void discardTiles()
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    for(auto*& entry : cache_)
+    for(uint16_t i = 0; i < cache_.size(); ++i)
     {
+      auto*& entry = cache_[i];
+      if(entry && releaseHook_)
+        releaseHook_(i, nullptr);
       delete entry;
       entry = nullptr;
     }
@@ -371,7 +424,7 @@ private:
    */
   void promoteLRU(uint16_t tileIndex)
   {
-    if(maxActiveTiles_ == 0)
+    if(maxActiveTiles_ == 0 && !trackLRU_)
       return; // LRU disabled
 
     // Remove existing entry if present
@@ -396,12 +449,18 @@ private:
       lruList_.pop_back();
 
       if(victim < cache_.size() && cache_[victim] && cache_[victim]->processor())
-      {
-        cache_[victim]->processor()->release(GRK_TILE_CACHE_LRU);
-      }
+        releaseEntry(victim, GRK_TILE_CACHE_LRU);
     }
   }
 
+  void releaseEntry(uint16_t tileIndex, uint32_t strategy)
+  {
+    auto processor = cache_[tileIndex]->processor();
+    processor->release(strategy);
+    if(releaseHook_)
+      releaseHook_(tileIndex, processor);
+  }
+
   // guards cache_ and lruList_ against concurrent access from parser,
   // decompress workers, and the caller thread
   mutable std::mutex mutex_;
@@ -410,6 +469,8 @@ private:
   uint32_t strategy_; // Cache strategy
   bool initialized_; // Flag to prevent reinitialization
   uint16_t maxActiveTiles_; // Max tiles with decompressed data (0 = unlimited)
+  bool trackLRU_ = false; // keep lruList_ for a memory budget
+  std::function<void(uint16_t, ITileProcessor*)> releaseHook_;
 };
 
 } // namespace grk
\ No newline at end of file
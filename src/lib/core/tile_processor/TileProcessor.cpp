@@ -25,6 +25,7 @@
 #include "Quantizer.h"
 
 #include <algorithm>
+#include <cmath>
 #include "ImageComponentFlow.h"
 #include "TileFutureManager.h"
 
@@ -81,7 +82,8 @@ TileProcessor::TileProcessor(uint16_t tile_index, TileCodingParams* tcp, CodeStr
       tile_(new Tile(headerImage_->numcomps)), tileIndex_(tile_index), tcp_(tcp),
       mct_(new Mct(tile_, headerImage_, tcp_)),
       markerParser_(isCompressor ? nullptr : new MarkerParser()), truncated_(false),
-      image_(nullptr), isCompressor_(isCompressor), tileCacheStrategy_(tileCacheStrategy)
+      image_(nullptr), isCompressor_(isCompressor), tileCacheStrategy_(tileCacheStrategy),
+      codeblockCache_(codeStream->getCodeblockCache())
 {
   TileProcessor::setStream(stream, false);
   TileProcessor::setProcessors(markerParser_);
@@ -264,6 +266,26 @@ bool TileProcessor::scheduledForDecompression(void)
   return scheduledForDecompression_;
 }
 
+uint64_t TileProcessor::getCompressedLength(void)
+{
+  uint64_t length = 0;
+  for(const auto& part : tilePartSeq_)
+    length += part->length_;
+
+  return length;
+}
+
+uint64_t TileProcessor::getAllocatedBytes(void)
+{
+  if(!tile_)
+    return 0;
+  uint64_t bytes = 0;
+  for(uint16_t compno = 0; compno < tile_->numcomps_; ++compno)
+    bytes += (tile_->comps_ + compno)->allocatedBytes();
+
+  return bytes;
+}
+
 void TileProcessor::resetSOTParsing()
 {
   numSOTsParsed_ = 0;
@@ -547,7 +569,7 @@ bool TileProcessor::decompressPrepareWithTLM(const std::shared_ptr<TPFetchSeq>&
   prepareForDecompression();
 
   if(selectiveFetch_ && tcp_ && tcp_->packets_)
-    tcp_->packets_->setSelectiveFetch(true);
+    tcp_->packets_->setSelectiveFetch(fetchedPackets_);
 
   return true;
 }
@@ -1091,7 +1113,8 @@ bool TileProcessor::createDecompressTileComponentWindows(void)
 
 bool TileProcessor::hasError(void)
 {
-  return !success_;
+  // a failed inverse MCT task leaves the tile's samples unusable
+  return !success_ || (mct_ && mct_->hasError());
 }
 
 grk_plugin_tile* TileProcessor::getCurrentPluginTile(void) const
@@ -1135,6 +1158,11 @@ std::shared_ptr<PacketLengthCache<uint32_t>> TileProcessor::getPacketLengthCache
   return packetLengthCache_;
 }
 
+CodeblockCache* TileProcessor::getCodeblockCache(void)
+{
+  return codeblockCache_;
+}
+
 uint32_t TileProcessor::getTileCacheStrategy(void)
 {
   return tileCacheStrategy_;
@@ -1175,6 +1203,7 @@ void TileProcessor::setImage(GrkImage* img)
     grk_unref(image_);
     image_ = img;
   }
+  imageCurrent_ = false;
 }
 
 bool TileProcessor::doPostT1(void)
@@ -1184,14 +1213,30 @@ bool TileProcessor::doPostT1(void)
 
 void TileProcessor::post_decompressT2T1(GrkImage* scratch)
 {
+  // the sink takes the coefficients or coded blocks, there is no tile image
+  auto& sink = cp_->coefficientSink_ ? cp_->coefficientSink_ : cp_->codeblockSink_;
+  if(sink)
+  {
+    if(tile_ && !hasError() && !sink(tileIndex_, tile_, tcp_))
+      success_ = false;
+    deallocBuffers();
+    return;
+  }
   if(this->doPostT1())
   {
     if(tile_)
     {
       if(scratch->has_multiple_tiles)
       {
+        // band streaming already copied the tile's samples into the composite
+        if(reusedImage_ || groupsComposited_)
+        {
+          deallocBuffers();
+          return;
+        }
         grk_unref(image_);
         image_ = scratch->extractFrom(tile_);
+        imageCurrent_ = image_ != nullptr;
         // extractFrom() sets image x0/y0/x1/y1 from unreduced tile canvas
         // coordinates.  When caller passed reduced coordinates (dw_reduced),
         // reduce them to match the output coordinate space.
@@ -1207,6 +1252,7 @@ void TileProcessor::post_decompressT2T1(GrkImage* scratch)
       else
       {
         scratch->transferDataFrom(tile_);
+        imageCurrent_ = false;
       }
       deallocBuffers();
     }
@@ -1226,6 +1272,8 @@ void TileProcessor::scheduleAndRunDecompress(CoderPool* coderPool, Rect32 unredu
       packetLengthCache_->rewind();
       numProcessedPackets_ = 0;
       numReadDataPackets_ = 0;
+      numReadCodedPackets_ = 0;
+      lowestCodedResolution_.assign(headerImage_->numcomps, std::numeric_limits<uint8_t>::max());
       getStream()->memAdvise(startPos_, tilePartInfo_.tilePartLength_,
                              GrkAccessPattern::ACCESS_SEQUENTIAL);
       for(uint16_t compno = 0; compno < headerImage_->numcomps; ++compno)
@@ -1276,6 +1324,8 @@ void TileProcessor::scheduleAndRunDecompress(CoderPool* coderPool, Rect32 unredu
   futures.waitAndClear(tileIndex_);
   staleParsing_.clear();
   unreducedImageWindow_ = unreducedImageBounds;
+  reusedImage_ = false;
+  groupsComposited_ = false;
 
   if(!scheduler_)
   {
@@ -1305,6 +1355,8 @@ void TileProcessor::scheduleAndRunDecompress(CoderPool* coderPool, Rect32 unredu
     packetLengthCache_->rewind();
     numProcessedPackets_ = 0;
     numReadDataPackets_ = 0;
+    numReadCodedPackets_ = 0;
+    lowestCodedResolution_.assign(headerImage_->numcomps, std::numeric_limits<uint8_t>::max());
     getStream()->memAdvise(startPos_, tilePartInfo_.tilePartLength_,
                            GrkAccessPattern::ACCESS_SEQUENTIAL);
     for(uint16_t compno = 0; compno < headerImage_->numcomps; ++compno)
@@ -1371,45 +1423,50 @@ void TileProcessor::scheduleAndRunDecompress(CoderPool* coderPool, Rect32 unredu
     }
   };
 
-  auto allocAndSchedule = [this]() {
+  auto allocAndSchedule = [this, coderPool]() {
     if(hasError())
       return;
     if(!tile_)
       return;
-    // skip T1/wavelet/MCT when only recording packet lengths (transcode PLT)
-    if(cp_->recordPacketLengths_)
+    // skip T1/wavelet/MCT when only recording packet lengths (transcode PLT),
+    // or when a truncating transcode takes the code blocks as coded
+    if(cp_->recordPacketLengths_ || cp_->codeblockSink_)
       return;
     // GPU plugin T2-only: skip T1/DWT when GPU handles T1 decode
     if(current_plugin_tile_ && !(current_plugin_tile_->decompress_flags & GRK_DECODE_T1))
       return;
-    for(uint16_t compno = 0; compno < tile_->numcomps_; ++compno)
+    // a differential decompress whose new layers carry no coding passes for this
+    // tile leaves every coefficient, and so the previous tile image, unchanged
+    if(canReuseImage())
     {
-      // skip allocation for components not selected for decoding
-      if(!shouldDecodeComponent(compno))
-        continue;
-
-      auto tilec = tile_->comps_ + compno;
-
-      if(!tcp_->wholeTileDecompress_)
+      for(uint16_t compno = 0; compno < tile_->numcomps_; ++compno)
       {
-        try
-        {
-          tilec->allocRegionWindow(tilec->nextPacketProgressionState_.numResolutionsRead(),
-                                   truncated_);
-        }
-        catch([[maybe_unused]] const std::runtime_error& ex)
-        {
-          continue;
-        }
-        catch([[maybe_unused]] const std::bad_alloc& baex)
-        {
-          success_ = false;
-          return;
-        }
+        auto tilec = tile_->comps_ + compno;
+        tilec->currentPacketProgressionState_ = tilec->nextPacketProgressionState_;
       }
-      if(!tilec->allocWindow())
+      reusedImage_ = true;
+      return;
+    }
+    // resolutions kept from the last synthesis only fit the same window
+    if(unreducedImageWindow_ != decompressedWindow_ ||
+       cp_->codingParams_.dec_.reduce_ != decompressedReduce_)
+    {
+      for(uint16_t compno = 0; compno < tile_->numcomps_; ++compno)
+        tile_->comps_[compno].releaseSynthesized();
+    }
+    decompressedWindow_ = unreducedImageWindow_;
+    decompressedReduce_ = cp_->codingParams_.dec_.reduce_;
+    // band streaming: component groups are decompressed one after the other
+    if(componentGroupSize())
+    {
+      if(!decompressComponentGroups(coderPool))
+        success_ = false;
+      return;
+    }
+    for(uint16_t compno = 0; compno < tile_->numcomps_; ++compno)
+    {
+      if(!allocDecompressWindow(compno))
       {
-        grklog.error("Not enough memory for tile data");
         success_ = false;
         return;
       }
@@ -1470,6 +1527,137 @@ void TileProcessor::scheduleAndRunDecompress(CoderPool* coderPool, Rect32 unredu
   futures.add(tileIndex_, TFSingleton::get().run(*rootFlow_));
 }
 
+bool TileProcessor::allocDecompressWindow(uint16_t compno)
+{
+  // skip allocation for components not selected for decoding
+  if(!shouldDecodeComponent(compno))
+    return true;
+
+  auto tilec = tile_->comps_ + compno;
+
+  if(!tcp_->wholeTileDecompress_)
+  {
+    try
+    {
+      tilec->allocRegionWindow(tilec->nextPacketProgressionState_.numResolutionsRead(),
+                               truncated_);
+    }
+    catch([[maybe_unused]] const std::runtime_error& ex)
+    {
+      return true;
+    }
+    catch([[maybe_unused]] const std::bad_alloc& baex)
+    {
+      return false;
+    }
+  }
+  if(!tilec->allocWindow())
+  {
+    grklog.error("Not enough memory for tile data");
+    return false;
+  }
+  tilec->setPyramidResolutions(pyramidResolutions(compno));
+
+  return true;
+}
+
+uint16_t TileProcessor::componentGroupSize(void)
+{
+  uint16_t groupSize = cp_->codingParams_.dec_.componentGroupSize_;
+  // GRK_TILE_CACHE_ALL resumes from the blocks of the tile's scheduler,
+  // and a plugin decompresses the whole tile
+  if(!groupSize || groupSize >= tile_->numcomps_ || current_plugin_tile_ ||
+     (tileCacheStrategy_ & GRK_TILE_CACHE_ALL) == GRK_TILE_CACHE_ALL)
+    return 0;
+
+  return groupSize;
+}
+
+bool TileProcessor::decompressComponentGroups(CoderPool* coderPool)
+{
+  auto& executor = TFSingleton::get();
+  auto runFlow = [&executor](tf::Taskflow& flow) {
+    if(executor.this_worker_id() >= 0)
+      executor.corun(flow);
+    else
+      executor.run(flow).wait();
+  };
+  uint16_t numcomps = tile_->numcomps_;
+  uint16_t withBlocks = 0;
+  std::vector<bool> hasBlocks(numcomps);
+  bool doPost = doPostT1() && !cp_->coefficientSink_;
+  // each group is copied into the composite, and its samples freed, before the next
+  // group allocates its own, so no more than a group's output is held for the tile
+  auto target = doPost && cp_->componentGroupTarget_ ? cp_->componentGroupTarget_() : nullptr;
+  groupsComposited_ = false;
+  for(uint16_t begin = 0; begin < numcomps;)
+  {
+    uint16_t groupSize = componentGroupSize();
+    // the inverse RCT/ICT needs its three components in the same group
+    if(begin == 0 && tcp_->mct_ == 1 && needsMctDecompress())
+      groupSize = std::max<uint16_t>(groupSize, 3);
+    auto end = (uint16_t)std::min<uint32_t>((uint32_t)begin + groupSize, numcomps);
+    for(uint16_t compno = begin; compno < end; ++compno)
+    {
+      if(!allocDecompressWindow(compno))
+        return false;
+    }
+    // the group's blocks, coders and wavelet scratch are released with its scheduler,
+    // before the next group is decompressed
+    DecompressScheduler groupScheduler(numcomps, headerImage_->comps->prec, coderPool);
+    groupScheduler.setComponentRange(begin, end);
+    if(!groupScheduler.scheduleT1(this))
+      return false;
+    runFlow(groupScheduler);
+    withBlocks = (uint16_t)(withBlocks + groupScheduler.numComponentsWithBlocks());
+    // only the group's output samples outlive it: its sparse canvas, band and
+    // lower resolution buffers are freed before the next group allocates its own
+    for(uint16_t compno = begin; compno < end; ++compno)
+    {
+      hasBlocks[compno] = groupScheduler.componentHasBlocks(compno);
+      tile_->comps_[compno].releaseWorkingBuffers();
+    }
+    if(target && !target->compositeComponents(tile_, begin, end))
+      return false;
+    begin = end;
+  }
+  groupsComposited_ = target != nullptr;
+  // a custom MCT mixes every band: once the last group is reconstructed, the bands
+  // are decorrelated together in row strips, each strip reading only its rows of
+  // every component's output samples, in the composite if the groups were copied there
+  if(doPost && tcp_->mct_ == 2 && needsMctDecompress())
+  {
+    FlowComponent mctFlow;
+    if(target)
+    {
+      mct_->schedule_decompress_custom(&mctFlow, target, hasBlocks);
+    }
+    else if(withBlocks == numcomps)
+    {
+      mct_->schedule_decompress_custom(&mctFlow);
+    }
+    else
+    {
+      // the transform is skipped, but the bands that were decoded still need their shift
+      grklog.warn("MCT components without code blocks - applying DC shift only");
+      for(uint16_t compno = 0; compno < numcomps; ++compno)
+      {
+        if(!hasBlocks[compno])
+          continue;
+        if(tcp_->tccps_[compno].qmfbid_ == 1)
+          mct_->schedule_decompress_dc_shift_rev(&mctFlow, compno);
+        else
+          mct_->schedule_decompress_dc_shift_irrev(&mctFlow, compno);
+      }
+    }
+    runFlow(mctFlow);
+    if(mct_->hasError())
+      return false;
+  }
+
+  return true;
+}
+
 uint8_t TileProcessor::getMaxNumDecompressResolutions(void)
 {
   uint8_t rc = 0;
@@ -1497,6 +1685,170 @@ void TileProcessor::incNumReadDataPackets(void)
   numReadDataPackets_++;
 }
 
+void TileProcessor::incNumReadCodedPackets(uint16_t compno, uint8_t resno)
+{
+  numReadCodedPackets_++;
+  if(compno < lowestCodedResolution_.size())
+    lowestCodedResolution_[compno] = std::min(lowestCodedResolution_[compno], resno);
+}
+
+uint8_t TileProcessor::lowestCodedResolution(uint16_t compno)
+{
+  return compno < lowestCodedResolution_.size() ? lowestCodedResolution_[compno]
+                                                : std::numeric_limits<uint8_t>::max();
+}
+
+bool TileProcessor::canReuseImage(void)
+{
+  if((tileCacheStrategy_ & GRK_TILE_CACHE_ALL) != GRK_TILE_CACHE_ALL)
+    return false;
+  if(!image_ || !imageCurrent_ || numReadCodedPackets_ != 0 || !doPostT1())
+    return false;
+  // overview levels are only captured while the wavelet runs
+  if(cp_->codingParams_.dec_.pyramidReductions_)
+    return false;
+  if(unreducedImageWindow_ != decompressedWindow_ ||
+     cp_->codingParams_.dec_.reduce_ != decompressedReduce_)
+    return false;
+  for(uint16_t compno = 0; compno < tile_->numcomps_; ++compno)
+  {
+    auto tilec = tile_->comps_ + compno;
+    if(tilec->currentPacketProgressionState_.numResolutionsRead() !=
+       tilec->nextPacketProgressionState_.numResolutionsRead())
+      return false;
+  }
+
+  return true;
+}
+
+uint32_t TileProcessor::pyramidResolutions(uint16_t compno)
+{
+  uint32_t reductions = cp_->codingParams_.dec_.pyramidReductions_;
+  if(!reductions || !tcp_->wholeTileDecompress_)
+    return 0;
+  auto tccp = tcp_->tccps_ + compno;
+  auto tilec = tile_->comps_ + compno;
+  if(tccp->usesPart2Transform() || tilec->is16BitDwt())
+    return 0;
+  // resolution resno is synthesized, and can be copied out, only if a higher one is
+  uint8_t numRes = std::min<uint8_t>(tilec->resolutions_to_decompress_,
+                                     tilec->nextPacketProgressionState_.numResolutionsRead());
+  uint32_t mask = 0;
+  for(uint8_t resno = 0; resno + 1 < numRes; ++resno)
+  {
+    uint8_t reduction = (uint8_t)(tilec->num_resolutions_ - 1 - resno);
+    if(reduction < 32 && ((reductions >> reduction) & 1))
+      mask |= 1U << resno;
+  }
+
+  return mask;
+}
+
+void TileProcessor::compositePyramid(GrkImage* const* levels, uint8_t numLevels)
+{
+  uint16_t numcomps = tile_->numcomps_;
+  for(uint8_t reduction = 0; reduction < numLevels; ++reduction)
+  {
+    auto level = levels[reduction];
+    if(!level)
+      continue;
+    std::vector<TileComponent::PyramidLevel*> captured(numcomps, nullptr);
+    for(uint16_t compno = 0; compno < numcomps && compno < level->numcomps; ++compno)
+    {
+      auto tilec = tile_->comps_ + compno;
+      if(reduction < tilec->num_resolutions_)
+        captured[compno] = tilec->pyramidLevel((uint8_t)(tilec->num_resolutions_ - 1 - reduction));
+    }
+    std::vector<ShiftInfo> shiftInfo(numcomps);
+    std::vector<uint8_t> reversible(numcomps);
+    for(uint16_t compno = 0; compno < numcomps; ++compno)
+    {
+      auto headerComp = headerImage_->comps + compno;
+      int32_t minVal = headerComp->sgnd ? -(1 << (headerComp->prec - 1)) : 0;
+      int32_t maxVal = headerComp->sgnd ? (1 << (headerComp->prec - 1)) - 1
+                                        : (int32_t)((1U << headerComp->prec) - 1);
+      shiftInfo[compno] = ShiftInfo(minVal, maxVal, tcp_->tccps_[compno].dcLevelShift_);
+      reversible[compno] = tcp_->tccps_[compno].qmfbid_ == 1;
+    }
+    // the inverse MCT runs on the captured samples, with the tile's kernels, and leaves
+    // the components it transforms shifted, clamped and int32
+    uint16_t numMctComps = 0;
+    if(needsMctDecompress())
+    {
+      uint16_t wanted = tcp_->mct_ == 2 ? numcomps : 3;
+      bool ready = wanted <= numcomps && (tcp_->mct_ != 2 || tcp_->mctDecodingMatrix_);
+      for(uint16_t compno = 0; ready && compno < wanted; ++compno)
+        ready = captured[compno] && captured[compno]->samples.size() == captured[0]->samples.size();
+      if(ready)
+        numMctComps = wanted;
+    }
+    if(numMctComps)
+    {
+      uint64_t len = captured[0]->samples.size();
+      if(tcp_->mct_ == 2)
+      {
+        std::vector<void*> chans(numcomps);
+        for(uint16_t compno = 0; compno < numcomps; ++compno)
+          chans[compno] = captured[compno]->samples.data();
+        if(!Mct::decompress_custom(tcp_->mctDecodingMatrix_, numcomps, chans.data(),
+                                   reversible.data(), shiftInfo.data(), len))
+        {
+          success_ = false;
+          continue;
+        }
+      }
+      else
+      {
+        int32_t* chans[3] = {captured[0]->samples.data(), captured[1]->samples.data(),
+                             captured[2]->samples.data()};
+        if(reversible[0])
+          Mct::decompress_rev(chans, shiftInfo.data(), len);
+        else
+          Mct::decompress_irrev(chans, shiftInfo.data(), len);
+      }
+    }
+    for(uint16_t compno = 0; compno < numcomps; ++compno)
+    {
+      auto src = captured[compno];
+      if(!src)
+        continue;
+      bool transformed = compno < numMctComps;
+      bool isFloat = !reversible[compno] && !transformed;
+      const auto& shift = shiftInfo[compno];
+      auto dest = level->comps + compno;
+      auto bounds = src->bounds.intersection(
+          Rect32(dest->x0, dest->y0, dest->x0 + dest->w, dest->y0 + dest->h));
+      if(bounds.empty())
+        continue;
+      auto destData = (int32_t*)dest->data;
+      for(uint32_t y = bounds.y0; y < bounds.y1; ++y)
+      {
+        auto srcRow = src->samples.data() + (size_t)(y - src->bounds.y0) * src->bounds.width() +
+                      (bounds.x0 - src->bounds.x0);
+        auto destRow = destData + (size_t)(y - dest->y0) * dest->stride + (bounds.x0 - dest->x0);
+        if(transformed)
+        {
+          memcpy(destRow, srcRow, (size_t)bounds.width() * sizeof(int32_t));
+          continue;
+        }
+        for(uint32_t x = 0; x < bounds.width(); ++x)
+        {
+          int32_t val = srcRow[x];
+          if(isFloat)
+          {
+            float f;
+            memcpy(&f, srcRow + x, sizeof(float));
+            val = (int32_t)std::lrintf(f);
+          }
+          destRow[x] = std::clamp(val + shift._shift, shift._min, shift._max);
+        }
+      }
+    }
+  }
+  for(uint16_t compno = 0; compno < numcomps; ++compno)
+    tile_->comps_[compno].releasePyramid();
+}
+
 bool TileProcessor::needsMctDecompress(void)
 {
   if(!tcp_->mct_)
@@ -1513,6 +1865,12 @@ bool TileProcessor::needsMctDecompress(void)
   }
   if(tcp_->mct_ == 2 && !tcp_->mctDecodingMatrix_)
     return false;
+  // a custom transform mixes every component
+  if(tcp_->mct_ == 2 && !headerImage_->componentsEqual(false))
+  {
+    grklog.warn("Not all tiles components have the same dimensions - skipping custom MCT.");
+    return false;
+  }
 
   return true;
 }
@@ -1531,6 +1889,10 @@ bool TileProcessor::shouldDecodeComponent(uint16_t compno)
   if(requested)
     return true;
 
+  // a custom MCT needs every component
+  if(tcp_->mct_ == 2 && needsMctDecompress())
+    return true;
+
   // If MCT=1 is active and any of components 0-2 is requested, decode all three
   if(needsMctDecompress() && compno <= 2)
   {
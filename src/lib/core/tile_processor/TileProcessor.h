@@ -239,6 +239,23 @@ struct TileProcessor : virtual public ITileProcessor
    */
   void incNumReadDataPackets(void) override;
 
+  /**
+   * @brief Increments the number of read packets that carried coding passes
+   *
+   * @param compno component of the packet
+   * @param resno resolution of the packet
+   */
+  void incNumReadCodedPackets(uint16_t compno, uint8_t resno) override;
+
+  /**
+   * @brief Gets the lowest resolution of a component whose packets carried coding
+   * passes in the current decompress
+   *
+   * @param compno component number
+   * @return resolution number, or UINT8_MAX if no packet of the component did
+   */
+  uint8_t lowestCodedResolution(uint16_t compno) override;
+
   /**
    * @brief Gets the Tile Cache Strategy object
    *
@@ -281,6 +298,15 @@ struct TileProcessor : virtual public ITileProcessor
    */
   std::shared_ptr<PacketLengthCache<uint32_t>> getPacketLengthCache(void) override;
 
+  /**
+   * @brief Get the Codeblock Cache object
+   *
+   * @return CodeblockCache*
+   */
+  CodeblockCache* getCodeblockCache(void) override;
+
+  void compositePyramid(GrkImage* const* levels, uint8_t numLevels) override;
+
   /**
    * @brief
    *
@@ -353,12 +379,20 @@ struct TileProcessor : virtual public ITileProcessor
   bool isBestEffortDecompressed(void) override;
   void setBestEffortDecompressed(void) override;
   bool scheduledForDecompression(void) override;
+  uint64_t getCompressedLength(void) override;
+  uint64_t getAllocatedBytes(void) override;
   void resetSOTParsing() override;
   bool reinitForReDecompress(void) override;
 
-  void setSelectiveFetch(bool selective)
+  /**
+   * @brief Marks the tile's data as selectively fetched
+   * @param fetchedPackets one flag per packet in progression order, true if
+   * the packet's bytes were fetched
+   */
+  void setSelectiveFetch(std::shared_ptr<const std::vector<bool>> fetchedPackets)
   {
-    selectiveFetch_ = selective;
+    selectiveFetch_ = fetchedPackets != nullptr;
+    fetchedPackets_ = std::move(fetchedPackets);
   }
 
 protected:
@@ -442,12 +476,76 @@ private:
   std::unique_ptr<FlowComponent> allocAndScheduleFlow_;
   std::unique_ptr<FlowComponent> postDecompressFlow_;
 
+  /**
+   * @brief true if @ref image_ holds the raw samples of the last decompress
+   * of this tile, as extracted for a multi-tile composite
+   */
+  bool imageCurrent_ = false;
+
+  /**
+   * @brief true if the current decompress kept @ref image_ because its packets
+   * carried no new coding passes
+   */
+  bool reusedImage_ = false;
+
+  /**
+   * @brief true if band streaming copied the tile's component groups into the
+   * composite as they were decompressed, leaving no tile image
+   */
+  bool groupsComposited_ = false;
+
+  /**
+   * @brief unreduced image window and reduction of the last decompress that ran T1
+   */
+  Rect32 decompressedWindow_;
+  uint8_t decompressedReduce_ = 0;
+
+  /**
+   * @brief Checks whether a differential decompress can keep the tile image
+   * of the previous one instead of running T1, wavelet and MCT again
+   *
+   * @return true if no packet added coding passes and the window is unchanged
+   */
+  bool canReuseImage(void);
+
+  /**
+   * @brief Selects the resolutions of a component to copy out as overview levels
+   *
+   * @param compno component number
+   * @return bit r set: copy out resolution r
+   */
+  uint32_t pyramidResolutions(uint16_t compno);
+
   /**
    * @brief deallocate buffers
    *
    */
   void deallocBuffers();
 
+  /**
+   * @brief Allocates the window of a component to be decompressed
+   *
+   * @param compno component number
+   * @return false if out of memory
+   */
+  bool allocDecompressWindow(uint16_t compno);
+
+  /**
+   * @brief Gets the number of components decompressed together when band streaming,
+   * or 0 if the tile's components are decompressed all at once
+   */
+  uint16_t componentGroupSize(void);
+
+  /**
+   * @brief Band streaming: decompresses the tile's components a group at a time,
+   * running T1 and the inverse wavelet of each group to completion and releasing its
+   * code blocks before starting the next
+   *
+   * @param coderPool pool of coders
+   * @return true if successful
+   */
+  bool decompressComponentGroups(CoderPool* coderPool);
+
   /**
    * @brief Create a Tile Window Buffers object
    *
@@ -473,6 +571,19 @@ private:
    */
   std::atomic<uint64_t> numReadDataPackets_ = 0;
 
+  /**
+   * @brief number of data packets read that carried coding passes
+   *
+   */
+  std::atomic<uint64_t> numReadCodedPackets_ = 0;
+
+  /**
+   * @brief per component, lowest resolution of the data packets that carried coding
+   * passes. Packet data of a tile is read by a single task.
+   *
+   */
+  std::vector<uint8_t> lowestCodedResolution_;
+
   TilePartInfo tilePartInfo_;
   uint64_t startPos_ = 0;
 
@@ -489,6 +600,7 @@ private:
    * @brief true if selective fetch mode is active (partial tile-part data)
    */
   bool selectiveFetch_ = false;
+  std::shared_ptr<const std::vector<bool>> fetchedPackets_;
 
   /**
    * @brief true if tile was decompressed on a best-effort basis
@@ -521,6 +633,12 @@ private:
    */
   uint32_t tileCacheStrategy_ = 0;
 
+  /**
+   * @brief decoded code block cache, owned by the code stream
+   *
+   */
+  CodeblockCache* codeblockCache_ = nullptr;
+
   void decompress_synch_plugin_with_host(void);
 
   std::shared_ptr<TPFetchSeq> tilePartFetchSeq_;
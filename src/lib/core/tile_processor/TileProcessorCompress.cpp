@@ -113,6 +113,9 @@ bool TileProcessorCompress::preCompressTile([[maybe_unused]] size_t thread_id)
   // don't need to allocate any buffers if this is from the plugin.
   if(current_plugin_tile_)
     return true;
+  // wavelet coefficients or coded blocks from a transcode source skip the DC shift,
+  // MCT and DWT
+  bool fromCoefficients = cp_->coefficientSource_ || cp_->codeblockSource_;
   for(uint16_t compno = 0; compno < tile_->numcomps_; ++compno)
   {
     auto imageComp = headerImage_->comps + compno;
@@ -125,7 +128,7 @@ bool TileProcessorCompress::preCompressTile([[maybe_unused]] size_t thread_id)
     tileComp->createWindow(Rect32(unreducedTileComp));
 
     auto tccp = tcp_->tccps_ + compno;
-    if(tileComp->num_resolutions_ > 1)
+    if(tileComp->num_resolutions_ > 1 && !fromCoefficients)
     {
       bool isMctComp = needsMctDecompress(compno) && tcp_->mct_ == 1;
       if(grk_get_data_type(true, imageComp->prec, isMctComp, tccp->qmfbid_) == GRK_INT_16)
@@ -133,8 +136,9 @@ bool TileProcessorCompress::preCompressTile([[maybe_unused]] size_t thread_id)
     }
   }
   uint32_t numTiles = (uint32_t)cp_->t_grid_height_ * cp_->t_grid_width_;
+  bool fromPixelSource = cp_->codingParams_.enc_.pixelSource_ != nullptr;
 
-  bool attachTileToImage = (numTiles == 1);
+  bool attachTileToImage = (numTiles == 1) && !fromPixelSource && !fromCoefficients;
   /* if we only have one tile, then simply set tile component data equal to
    * image component data. Otherwise, allocate tile data and copy */
   for(uint32_t j = 0; j < headerImage_->numcomps; ++j)
@@ -149,8 +153,17 @@ bool TileProcessorCompress::preCompressTile([[maybe_unused]] size_t thread_id)
       return false;
     }
   }
+  if(cp_->coefficientSource_)
+    return cp_->coefficientSource_(tileIndex_, tile_, tcp_);
+  if(fromCoefficients)
+    return true;
+  // widen samples straight from the mapped source into the tile
+  if(fromPixelSource)
+  {
+    transferTileDataFromPixelSource();
+  }
   // otherwise copy image data to tile
-  if(!attachTileToImage)
+  else if(!attachTileToImage)
   {
     for(uint16_t i = 0; i < headerImage_->numcomps; ++i)
     {
@@ -180,6 +193,63 @@ bool TileProcessorCompress::preCompressTile([[maybe_unused]] size_t thread_id)
   return true;
 }
 
+void TileProcessorCompress::transferTileDataFromPixelSource(void)
+{
+  const auto& enc = cp_->codingParams_.enc_;
+  const uint16_t numComps = headerImage_->numcomps;
+  const uint8_t bps = enc.pixelSourceBytesPerSample_;
+  auto comp0 = headerImage_->comps;
+  // pixel source guarantees identical, unsubsampled components
+  auto tilec0 = tile_->comps_;
+  uint32_t x = tilec0->x0 - headerImage_->x0;
+  uint32_t y = tilec0->y0 - headerImage_->y0;
+  uint32_t w = tilec0->width();
+  uint32_t h = tilec0->height();
+  uint64_t planeLen = (uint64_t)comp0->w * comp0->h * bps;
+
+  std::vector<int32_t*> dest(numComps);
+  std::vector<uint32_t> destStride(numComps);
+  for(uint16_t compno = 0; compno < numComps; ++compno)
+  {
+    auto buf = tile_->comps_[compno].getWindow()->getResWindowBufferHighestSimple();
+    dest[compno] = buf.buf_;
+    destStride[compno] = buf.stride_;
+  }
+  for(uint32_t j = 0; j < h; ++j)
+  {
+    uint64_t pixelIndex = (uint64_t)(y + j) * comp0->w + x;
+    if(enc.pixelSourceInterleaved_)
+    {
+      auto src = enc.pixelSource_ + pixelIndex * numComps * bps;
+      if(bps == 1)
+        hwy_deinterleave_8u_to_i32(src, dest.data(), w, numComps);
+      else
+        hwy_deinterleave_16u_to_i32(src, dest.data(), w, numComps, enc.pixelSourceBigEndian_);
+    }
+    else
+    {
+      for(uint16_t compno = 0; compno < numComps; ++compno)
+      {
+        auto src = enc.pixelSource_ + compno * planeLen + pixelIndex * bps;
+        if(bps == 1)
+          hwy_unpack_8u_to_i32(src, dest[compno], w, false);
+        else
+          hwy_deinterleave_16u_to_i32(src, dest.data() + compno, w, 1, enc.pixelSourceBigEndian_);
+      }
+    }
+    for(uint16_t compno = 0; compno < numComps; ++compno)
+    {
+      auto row = dest[compno];
+      if(comp0->sgnd)
+      {
+        for(uint32_t i = 0; i < w; ++i)
+          row[i] = (bps == 1) ? (int32_t)(int8_t)row[i] : (int32_t)(int16_t)row[i];
+      }
+      dest[compno] += destStride[compno];
+    }
+  }
+}
+
 uint32_t TileProcessorCompress::getPreCalculatedTileLen(void)
 {
   return preCalculatedTileLen_;
@@ -214,6 +284,53 @@ bool TileProcessorCompress::writeTilePartT2(uint32_t* tileBytesWritten)
   return compressT2(tileBytesWritten);
 }
 
+bool TileProcessorCompress::mctShiftsComponent(uint16_t compno)
+{
+  // a custom transform mixes every component
+  if(tcp_->mct_ == 2)
+    return needsMctDecompress();
+  return tcp_->mct_ == 1 && needsMctDecompress(compno);
+}
+
+bool TileProcessorCompress::compressCustomMct(void)
+{
+  if(!tcp_->mctCodingMatrix_ || !needsMctDecompress())
+  {
+    grklog.error("Custom MCT needs a coding matrix and at least three components "
+                 "of equal dimensions");
+    return false;
+  }
+  uint16_t numcomps = tile_->numcomps_;
+  uint64_t samples = tile_->comps_->getWindow()->stridedArea();
+  std::vector<uint8_t*> data(numcomps);
+  for(uint16_t compno = 0; compno < numcomps; ++compno)
+  {
+    auto buf = tile_->comps_[compno].getWindow()->getResWindowBufferHighestSimple().buf_;
+    auto shift = tcp_->tccps_[compno].dcLevelShift_;
+    if(shift)
+    {
+      for(uint64_t i = 0; i < samples; ++i)
+        buf[i] = (int32_t)((int64_t)buf[i] - shift);
+    }
+    data[compno] = (uint8_t*)buf;
+  }
+  if(!Mct::compress_custom((uint8_t*)tcp_->mctCodingMatrix_, samples, data.data(), numcomps,
+                           headerImage_->comps->sgnd))
+    return false;
+  // the transform leaves int32: components with no wavelet take it as float
+  for(uint16_t compno = 0; compno < numcomps; ++compno)
+  {
+    if(tile_->comps_[compno].num_resolutions_ > 1 || tcp_->tccps_[compno].qmfbid_ == 1)
+      continue;
+    auto buf = tile_->comps_[compno].getWindow()->getResWindowBufferHighestSimple().buf_;
+    auto floatBuf = (float*)buf;
+    for(uint64_t i = 0; i < samples; ++i)
+      floatBuf[i] = (float)buf[i];
+  }
+
+  return true;
+}
+
 void TileProcessorCompress::dcLevelShiftCompress(void)
 {
   // DC shift and int→float conversion are fused into the wavelet transform.
@@ -228,7 +345,7 @@ void TileProcessorCompress::dcLevelShiftCompress(void)
       continue;
 
 #ifndef GRK_FORCE_SIGNED_COMPRESS
-    if(needsMctDecompress(compno))
+    if(mctShiftsComponent(compno))
       continue;
 #else
     tccp->dc_level_shift_ = 1 << ((this->headerImage->comps + compno)->prec - 1);
@@ -282,9 +399,19 @@ void TileProcessorCompress::scheduleCompressT1()
   }
 
   scheduler_ = new CompressScheduler(tile_, needsRateControl(), tcp, mct_norms, mct_numcomps,
-                                     cp_->codingParams_.enc_.progressiveRateControl_);
+                                     cp_->codingParams_.enc_.progressiveRateControl_,
+                                     cp_->coefficientSource_ != nullptr, blockSource());
   scheduler_->scheduleT1(nullptr);
 }
+std::function<bool(t1::CompressBlockExec*)> TileProcessorCompress::blockSource(void)
+{
+  if(!cp_->codeblockSource_)
+    return nullptr;
+  return [this](t1::CompressBlockExec* block) {
+    return cp_->codeblockSource_(tileIndex_, block);
+  };
+}
+
 bool TileProcessorCompress::compressT2(uint32_t* tileBytesWritten)
 {
   auto l_t2 = new T2Compress(this);
@@ -307,23 +434,30 @@ void TileProcessorCompress::buildCompressDAG(void)
 {
   compressFlow_ = std::make_unique<tf::Taskflow>();
   dagSuccess_ = true;
+  // transcoded coefficients and code blocks are already in the wavelet domain
+  bool fromCoefficients = cp_->coefficientSource_ || cp_->codeblockSource_;
 
   // 1. DC level shift as a single task, then MCT in its own FlowComponent
   // dcShift is fast and runs as a single task
   auto dcShiftFlow = std::make_unique<FlowComponent>();
-  dcShiftFlow->nextTask().work([this] { dcLevelShiftCompress(); });
+  dcShiftFlow->nextTask().work([this, fromCoefficients] {
+    if(!fromCoefficients)
+      dcLevelShiftCompress();
+  });
   dcShiftFlow->addTo(*compressFlow_);
 
   // MCT gets its own FlowComponent so its parallel tasks can run on the executor
   mctFlow_ = std::make_unique<FlowComponent>();
-  if(tcp_->mct_)
+  if(tcp_->mct_ && !fromCoefficients)
   {
     if(tcp_->mct_ == 2)
     {
-      dagSuccess_ = false;
-      return;
+      mctFlow_->nextTask().work([this] {
+        if(!compressCustomMct())
+          dagSuccess_ = false;
+      });
     }
-    if(tcp_->tccps_->qmfbid_ == 0)
+    else if(tcp_->tccps_->qmfbid_ == 0)
       mct_->compress_irrev(mctFlow_.get(), true);
     else
       mct_->compress_rev(mctFlow_.get(), true);
@@ -340,14 +474,14 @@ void TileProcessorCompress::buildCompressDAG(void)
   {
     auto tile_comp = tile_->comps_ + compno;
     auto tccp = tcp_->tccps_ + compno;
-    if(tile_comp->num_resolutions_ <= 1)
+    if(tile_comp->num_resolutions_ <= 1 || fromCoefficients)
       continue;
 
     uint8_t numLevels = (uint8_t)(tile_comp->num_resolutions_ - 1);
 
     // Compute DC shift for fusion into wavelet first level
     DcShiftParam dcShift;
-    bool isMctComp = needsMctDecompress(compno) && tcp_->mct_ == 1;
+    bool isMctComp = mctShiftsComponent(compno);
     if(!isMctComp)
     {
       auto img_comp = headerImage_->comps + compno;
@@ -378,8 +512,9 @@ void TileProcessorCompress::buildCompressDAG(void)
 
     // Schedule DWT tasks into the FlowComponents
     // For non-MCT irreversible components, the tile buffer still contains int32_t
-    // (MCT handles int→float conversion for its components)
-    bool intInput = !isMctComp && (tccp->qmfbid_ == 0);
+    // (MCT handles int→float conversion for its components, except the custom MCT,
+    // which leaves int32_t)
+    bool intInput = (!isMctComp || tcp_->mct_ == 2) && (tccp->qmfbid_ == 0);
     WaveletFwdImpl w;
     auto scratch = w.scheduleCompress(tile_comp, tccp->qmfbid_, dcShift, levelFlows, intInput);
     if(scratch)
@@ -432,7 +567,8 @@ void TileProcessorCompress::buildCompressDAG(void)
       mct_norms = (const double*)(tcp->mct_norms_);
     }
     scheduler_ = new CompressScheduler(tile_, needsRateControl(), tcp, mct_norms, mct_numcomps,
-                                       cp_->codingParams_.enc_.progressiveRateControl_);
+                                       cp_->codingParams_.enc_.progressiveRateControl_,
+                                       cp_->coefficientSource_ != nullptr, blockSource());
     static_cast<CompressScheduler*>(scheduler_)->populateT1Flow(t1Flow_.get());
   }
   t1Flow_->addTo(*compressFlow_);
@@ -513,32 +649,19 @@ bool TileProcessorCompress::doCompress(void)
   // context formation and MQ coding.
   bool debugEncode = state & GRK_PLUGIN_STATE_DEBUG;
   bool debugMCT = (state & GRK_PLUGIN_STATE_MCT_ONLY) ? true : false;
+  bool fromCoefficients = cp_->coefficientSource_ || cp_->codeblockSource_;
 
   if(!current_plugin_tile_ || debugEncode)
   {
-    if(!debugEncode)
+    if(!debugEncode && !fromCoefficients)
     {
       dcLevelShiftCompress();
       if(tcp_->mct_)
       {
         if(tcp_->mct_ == 2)
         {
-          /*
-          if(!tcp_->mct_coding_matrix_)
-            return true;
-          auto data = new uint8_t*[tile->numcomps_];
-          for(uint32_t i = 0; i < tile->numcomps_; ++i)
-          {
-            auto tile_comp = tile->comps + i;
-            data[i] = (uint8_t*)tile_comp->getWindow()->getResWindowBufferHighestSimple().buf_;
-          }
-          uint64_t samples = tile->comps->getWindow()->stridedArea();
-          bool rc = Mct::compress_custom((uint8_t*)tcp_->mct_coding_matrix_, samples, data,
-                                         tile->numcomps_, headerImage->comps->sgnd);
-          delete[] data;
-          return rc;
-          */
-          return false;
+          if(!compressCustomMct())
+            return false;
         }
         else if(tcp_->tccps_->qmfbid_ == 0)
         {
@@ -551,7 +674,7 @@ bool TileProcessorCompress::doCompress(void)
         }
       }
     }
-    if(!debugEncode || debugMCT)
+    if((!debugEncode || debugMCT) && !fromCoefficients)
     {
       for(uint16_t compno = 0; compno < tile_->numcomps_; ++compno)
       {
@@ -561,7 +684,7 @@ bool TileProcessorCompress::doCompress(void)
         DcShiftParam dcShift;
         if(tile_comp->num_resolutions_ > 1)
         {
-          bool isMctComp = needsMctDecompress(compno) && tcp_->mct_ == 1;
+          bool isMctComp = mctShiftsComponent(compno);
           // Don't fuse DC shift for MCT components:
           // MCT handles DC shift before color transform
           if(!isMctComp)
@@ -583,8 +706,8 @@ bool TileProcessorCompress::doCompress(void)
           }
         }
 
-        bool isMctComp2 = needsMctDecompress(compno) && tcp_->mct_ == 1;
-        bool intInput = !isMctComp2 && (tccp->qmfbid_ == 0);
+        bool isMctComp2 = mctShiftsComponent(compno);
+        bool intInput = (!isMctComp2 || tcp_->mct_ == 2) && (tccp->qmfbid_ == 0);
         WaveletFwdImpl w;
         if(!w.compress(tile_comp, tccp->qmfbid_, dcShift, intInput))
           return false;
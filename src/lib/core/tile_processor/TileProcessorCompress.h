@@ -77,10 +77,22 @@ struct TileProcessorCompress : public ITileProcessorCompress, public TileProcess
 
 private:
   void transferTileDataFromImage(void);
+  void transferTileDataFromPixelSource(void);
   void dcLevelShiftCompress();
+  /**
+   * @brief true if the MCT, rather than the wavelet, removes a component's dc shift
+   */
+  bool mctShiftsComponent(uint16_t compno);
+  /**
+   * @brief Forward custom (Part 2) MCT over all components, dc shift first
+   * @return true if successful
+   */
+  bool compressCustomMct(void);
   void scheduleCompressT1();
   bool compressT2(uint32_t* packet_bytes_written);
   bool rateAllocate(uint32_t* allPacketBytes, bool disableRateControl);
+  bool pcrdBisect(uint32_t* allPacketBytes, bool disableRateControl);
+  bool rateAllocateHT(uint32_t* allPacketBytes, bool disableRateControl);
   bool layerNeedsRateControl(uint16_t layno);
   bool makeSingleLosslessLayer();
   void makeLayerFinal(uint16_t layno);
@@ -90,6 +102,10 @@ private:
   bool makeLayerFeasible(uint16_t layno, uint16_t thresh, bool finalAttempt);
   void syncPluginCodeBlockData();
   void prepareBlockForFirstLayer(t1::CodeblockCompress* cblk);
+  /**
+   * @brief This tile's view of the truncating transcode's code block source, if set
+   */
+  std::function<bool(t1::CompressBlockExec*)> blockSource(void);
 
   uint32_t preCalculatedTileLen_ = 0;
   /** Compression Only
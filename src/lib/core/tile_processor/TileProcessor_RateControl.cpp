@@ -15,6 +15,7 @@
  *
  */
 
+#include <algorithm>
 #include <cfloat>
 
 #include "CodeStreamLimits.h"
@@ -63,6 +64,13 @@ namespace grk
 {
 
 bool TileProcessorCompress::rateAllocate(uint32_t* allPacketBytes, bool disableRateControl)
+{
+  if(tcp_->isHT() && tcp_->numLayers_ == 1 && needsRateControl())
+    return rateAllocateHT(allPacketBytes, disableRateControl);
+
+  return pcrdBisect(allPacketBytes, disableRateControl);
+}
+bool TileProcessorCompress::pcrdBisect(uint32_t* allPacketBytes, bool disableRateControl)
 {
   // rate control by rate/distortion or fixed quality
   switch(cp_->codingParams_.enc_.rateControlAlgorithm_)
@@ -73,6 +81,260 @@ bool TileProcessorCompress::rateAllocate(uint32_t* allPacketBytes, bool disableR
       return pcrdBisectFeasible(allPacketBytes, disableRateControl);
   }
 }
+/*
+ HT rate control: an HT code block has a single cleanup pass, so the bisect chooses
+ among truncations of that pass, each dropping some least significant bit planes.
+ T1 codes every block in full and estimates the lengths of its truncations. The
+ truncations the bisect chooses are then coded, and the allocation repeated with
+ their exact lengths, for a bounded number of rounds; the last round only offers
+ truncations that have been coded. If packet header overhead still leaves the layer
+ over its target, the blocks with the lowest slopes are stepped down to coarser
+ truncations, or left out, until it fits.
+ */
+bool TileProcessorCompress::rateAllocateHT(uint32_t* allPacketBytes, bool disableRateControl)
+{
+  const uint32_t maxRounds = 3;
+  const uint32_t maxCorrections = 4;
+
+  struct HTBlock
+  {
+    CompressScheduler::HTRecode recode;
+    uint8_t droppedPlanes[3 * 32 - 2];
+    // bit planes dropped by the chosen truncation, or -1 if the block is left out
+    int32_t choice;
+  };
+  std::vector<HTBlock> blocks;
+  for(uint16_t compno = 0; compno < tile_->numcomps_; compno++)
+  {
+    auto tilec = tile_->comps_ + compno;
+    for(uint8_t resno = 0; resno < tilec->num_resolutions_; resno++)
+    {
+      auto res = tilec->resolutions_ + resno;
+      for(uint8_t bandIndex = 0; bandIndex < res->numBands_; bandIndex++)
+      {
+        auto band = res->band + bandIndex;
+        for(auto prc : band->precincts_)
+        {
+          for(uint32_t cblkno = 0; cblkno < prc->getNumCblks(); cblkno++)
+          {
+            auto cblk = prc->getCompressBlock(cblkno);
+            if(!cblk->getHTTruncations().empty())
+              blocks.push_back({{compno, resno, band, cblk, 0}, {}, -1});
+          }
+        }
+      }
+    }
+  }
+  // no truncations were tabulated, e.g. T1 ran in a plugin
+  if(blocks.empty())
+    return pcrdBisect(allPacketBytes, disableRateControl);
+
+  auto scheduler = dynamic_cast<CompressScheduler*>(scheduler_);
+  auto recode = [scheduler](const std::vector<CompressScheduler::HTRecode>& recodes) {
+    return recodes.empty() || (scheduler && scheduler->recodeHT(recodes));
+  };
+  auto setPasses = [&](bool codedOnly) {
+    for(auto& b : blocks)
+    {
+      auto cblk = b.recode.cblk;
+      auto numPasses = cblk->setHTPasses(codedOnly, b.droppedPlanes);
+      cblk->setNumPassesInPreviousLayers(0);
+      if(numPasses)
+        RateControl::convexHull(cblk->getPass(0), numPasses);
+      if(scheduler)
+        scheduler->updateRateControlStats(cblk);
+    }
+  };
+  // takes the truncation the last bisect chose for each block
+  auto choose = [&](void) {
+    for(auto& b : blocks)
+    {
+      auto numPasses = b.recode.cblk->getLayer(0)->totalPasses_;
+      b.choice = numPasses ? b.droppedPlanes[numPasses - 1] : -1;
+    }
+  };
+  // truncation chosen for a block, or nullptr if it is left out
+  auto chosen = [](HTBlock& b) -> t1::HTTruncation* {
+    if(b.choice < 0)
+      return nullptr;
+    b.recode.droppedPlanes = (uint8_t)b.choice;
+    return &b.recode.cblk->getHTTruncations()[(size_t)b.choice];
+  };
+  // replaces the passes of each block with its chosen truncation, whose coded bytes
+  // the first layer then points to
+  auto commit = [&](void) {
+    std::vector<CompressScheduler::HTRecode> recodes;
+    for(auto& b : blocks)
+    {
+      auto t = chosen(b);
+      if(t && t->offset < 0)
+        recodes.push_back(b.recode);
+    }
+    if(!recode(recodes))
+      return false;
+    tile_->setLayerDistortion(0, 0);
+    for(auto& b : blocks)
+    {
+      auto cblk = b.recode.cblk;
+      auto layer = cblk->getLayer(0);
+      auto t = chosen(b);
+      cblk->setNumPassesInPreviousLayers(0);
+      if(!t)
+      {
+        cblk->setNumPasses(0);
+        layer->totalPasses_ = 0;
+        layer->distortion = 0;
+        continue;
+      }
+      auto pass = cblk->getPass(0);
+      pass->len_ = t->len;
+      pass->rate_ = t->len;
+      pass->distortiondec_ = t->distortiondec;
+      pass->term_ = true;
+      cblk->setNumPasses(1);
+      cblk->setNumBps((uint8_t)(1 + b.recode.droppedPlanes));
+      layer->totalPasses_ = 1;
+      layer->len = t->len;
+      layer->data = cblk->getPaddedCompressedStream() + t->offset;
+      layer->distortion = t->distortiondec;
+      tile_->incLayerDistortion(0, layer->distortion);
+      cblk->setNumPassesInPreviousLayers(1);
+    }
+    return true;
+  };
+
+  auto t2 = T2Compress(this);
+  if(disableRateControl)
+  {
+    // every block keeps its full cleanup pass
+    setPasses(true);
+    for(auto& b : blocks)
+    {
+      auto cblk = b.recode.cblk;
+      auto numPasses = cblk->getNumPasses();
+      cblk->getLayer(0)->totalPasses_ = numPasses;
+    }
+    choose();
+    if(!commit())
+      return false;
+    return t2.compressPacketsSimulate(tileIndex_, 1, allPacketBytes, UINT_MAX,
+                                      newTilePartProgressionPosition_,
+                                      packetLengthCache_->getMarkers(), true, false);
+  }
+
+  for(uint32_t round = 0; round < maxRounds; ++round)
+  {
+    bool exact = round == maxRounds - 1 || !scheduler;
+    setPasses(exact);
+    // an allocation from estimated lengths is only a guide to what to code next
+    if(!pcrdBisect(allPacketBytes, false) && exact)
+      return false;
+    choose();
+    if(exact)
+      break;
+    std::vector<CompressScheduler::HTRecode> recodes;
+    for(auto& b : blocks)
+    {
+      auto t = chosen(b);
+      if(t && !t->coded)
+        recodes.push_back(b.recode);
+    }
+    // every chosen truncation was already coded, so the allocation is exact
+    if(recodes.empty())
+      break;
+    if(!recode(recodes))
+      return false;
+  }
+  if(!commit())
+    return false;
+
+  // packet headers signal each block's bit planes, which the bisect did not see, so
+  // tighten the target by any overshoot and choose again among coded truncations
+  double rate = tcp_->rates_[0];
+  uint32_t maxLayerLength = rate > 0.0 ? (uint32_t)ceil(rate) : UINT_MAX;
+  auto simulate = [&](void) {
+    return t2.compressPacketsSimulate(tileIndex_, 1, allPacketBytes, UINT_MAX,
+                                      newTilePartProgressionPosition_,
+                                      packetLengthCache_->getMarkers(), false, false);
+  };
+  bool rc = simulate();
+  for(uint32_t i = 0; rc && *allPacketBytes > maxLayerLength && i < maxCorrections; ++i)
+  {
+    tcp_->rates_[0] -= (double)(*allPacketBytes - maxLayerLength);
+    if(tcp_->rates_[0] <= 0.0)
+      break;
+    setPasses(true);
+    // a failed bisect keeps the last committed choices
+    if(pcrdBisect(allPacketBytes, false))
+      choose();
+    rc = commit() && simulate();
+  }
+  tcp_->rates_[0] = rate;
+  if(!rc)
+    return false;
+
+  // still over: step down the blocks whose truncation costs least distortion per byte
+  // saved, until the bytes saved cover the overshoot, and simulate again. Each step
+  // makes a block's truncation coarser or leaves the block out, so this ends
+  struct Step
+  {
+    HTBlock* block;
+    int32_t choice;
+    uint32_t saving;
+    double slope;
+  };
+  std::vector<Step> steps;
+  while(*allPacketBytes > maxLayerLength)
+  {
+    steps.clear();
+    for(auto& b : blocks)
+    {
+      if(b.choice < 0)
+        continue;
+      const auto& truncations = b.recode.cblk->getHTTruncations();
+      const auto& current = truncations[(size_t)b.choice];
+      // coarser truncations that are only estimated may not be smaller
+      auto next = (size_t)b.choice + 1;
+      while(next < truncations.size() && truncations[next].len >= current.len)
+        ++next;
+      uint32_t len = 0;
+      double distortiondec = 0;
+      if(next < truncations.size())
+      {
+        len = truncations[next].len;
+        distortiondec = truncations[next].distortiondec;
+      }
+      uint32_t saving = current.len - len;
+      double slope = saving ? (current.distortiondec - distortiondec) / saving : 0;
+      steps.push_back({&b, next < truncations.size() ? (int32_t)next : -1, saving, slope});
+    }
+    if(steps.empty())
+    {
+      grklog.error("Tile %u: packet headers alone exceed the %u byte rate target", tileIndex_,
+                   maxLayerLength);
+      return false;
+    }
+    std::sort(steps.begin(), steps.end(),
+              [](const Step& a, const Step& b) { return a.slope < b.slope; });
+    uint64_t overshoot = *allPacketBytes - maxLayerLength;
+    uint64_t saved = 0;
+    for(const auto& step : steps)
+    {
+      step.block->choice = step.choice;
+      saved += step.saving;
+      if(saved >= overshoot)
+        break;
+    }
+    if(!commit() || !simulate())
+      return false;
+  }
+
+  // final simulation will generate correct PLT lengths
+  // and correct tile length
+  return t2.compressPacketsSimulate(tileIndex_, 1, allPacketBytes, maxLayerLength,
+                                    newTilePartProgressionPosition_,
+                                    packetLengthCache_->getMarkers(), true, false);
+}
 bool TileProcessorCompress::layerNeedsRateControl(uint16_t layno)
 {
   auto enc_params = &cp_->codingParams_.enc_;
@@ -15,6 +15,7 @@
  *
  */
 
+#include "TFSingleton.h"
 #include "CodeStreamLimits.h"
 #include "TileWindow.h"
 #include "Quantizer.h"
@@ -462,6 +463,92 @@ bool GrkImage::isOpacity(uint16_t compno) const
   return (comp->type == GRK_CHANNEL_TYPE_OPACITY ||
           comp->type == GRK_CHANNEL_TYPE_PREMULTIPLIED_OPACITY);
 }
+// bands smaller than this cost more to schedule than they save
+static constexpr uint64_t kMinBandSamples = 64 * 1024;
+static constexpr uint64_t kBandsPerThread = 2;
+
+void GrkImage::forEachRowBand(uint32_t numRows, uint64_t rowSamples,
+                              const std::function<void(uint32_t yBegin, uint32_t yEnd)>& kernel)
+{
+  if(!numRows)
+    return;
+  uint64_t numThreads = TFSingleton::num_threads();
+  uint64_t minRows = std::max<uint64_t>(1, kMinBandSamples / std::max<uint64_t>(rowSamples, 1));
+  uint64_t numBands = std::min(numThreads * kBandsPerThread, (numRows + minRows - 1) / minRows);
+  if(numThreads <= 1 || numBands <= 1)
+  {
+    kernel(0, numRows);
+    return;
+  }
+  uint64_t bandHeight = (numRows + numBands - 1) / numBands;
+  tf::Taskflow taskflow;
+  for(uint64_t y = 0; y < numRows; y += bandHeight)
+  {
+    auto yBegin = (uint32_t)y;
+    auto yEnd = (uint32_t)std::min<uint64_t>(numRows, y + bandHeight);
+    taskflow.emplace([&kernel, yBegin, yEnd] { kernel(yBegin, yEnd); });
+  }
+  auto& executor = TFSingleton::get();
+  if(executor.this_worker_id() >= 0)
+    executor.corun(taskflow);
+  else
+    executor.run(taskflow).wait();
+}
+
+void GrkImage::planRescale(grk_image_comp* component, const grk_rescale& r,
+                           std::vector<PrecisionOp>& ops)
+{
+  if(!component->data || r.src_max == r.src_min)
+  {
+    grklog.warn("rescaleComponent: skipped (src_min == src_max or null data)");
+    return;
+  }
+  PrecisionOp op{};
+  op.kind = PrecisionOp::RESCALE;
+  op.rescale = r;
+  ops.push_back(op);
+  rescale_precision(r, &component->prec, &component->sgnd);
+}
+
+void GrkImage::planClip(grk_image_comp* component, uint8_t precision,
+                        std::vector<PrecisionOp>& ops)
+{
+  assert(precision <= GRK_MAX_SUPPORTED_IMAGE_PRECISION);
+  PrecisionOp op{};
+  op.kind = PrecisionOp::CLIP;
+  if(component->sgnd)
+  {
+    op.minimum = -(1LL << (precision - 1));
+    op.maximum = (1LL << (precision - 1)) - 1;
+  }
+  else
+  {
+    op.minimum = 0;
+    op.maximum = (int64_t)((1ULL << precision) - 1);
+  }
+  ops.push_back(op);
+  component->prec = precision;
+}
+
+void GrkImage::planScale(grk_image_comp* component, uint8_t precision,
+                         std::vector<PrecisionOp>& ops)
+{
+  if(component->prec == precision)
+    return;
+  uint32_t diff =
+      (precision > component->prec) ? (precision - component->prec) : (component->prec - precision);
+  if(diff >= 64) // prevent overflow
+  {
+    grklog.error("scaleComponent: precision difference %u too large", diff);
+    return;
+  }
+  PrecisionOp op{};
+  op.kind = component->prec < precision ? PrecisionOp::SCALE_UP : PrecisionOp::SCALE_DOWN;
+  op.scale = (int64_t)(1ULL << diff);
+  ops.push_back(op);
+  component->prec = precision;
+}
+
 bool GrkImage::isPostProcessNoOp(void) const
 {
   // applyColour: palette requires processing; channel_definition only blocks
@@ -1043,6 +1130,30 @@ bool GrkImage::composite(const GrkImage* srcImg)
   }
 }
 
+bool GrkImage::compositeComponents(const Tile* src, uint16_t begin, uint16_t end)
+{
+  for(uint16_t compno = begin; compno < end; ++compno)
+  {
+    auto srcComp = src->comps_ + compno;
+    auto srcBounds = srcComp->windowBounds();
+    grk_image_comp comp{};
+    comp.x0 = srcBounds.x0;
+    comp.y0 = srcBounds.y0;
+    comp.w = srcBounds.width();
+    comp.h = srcBounds.height();
+    comp.data_type = srcComp->is16BitDwt() ? GRK_INT_16 : GRK_INT_32;
+    comp.owns_data = true;
+    srcComp->transferWindowData(&comp.data, &comp.stride);
+    bool rc = comp.data_type == GRK_INT_16 ? compositePlanar<int16_t>(1, &comp, compno)
+                                           : compositePlanar<int32_t>(1, &comp, compno);
+    single_component_data_free(&comp);
+    if(!rc)
+      return false;
+  }
+
+  return true;
+}
+
 /***
  * Generate destination window (relative to destination component bounds)
  * Assumption: source region is wholly contained inside destination component region
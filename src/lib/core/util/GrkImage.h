@@ -20,6 +20,9 @@
 #include <set>
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
 
 #define CMS_NO_REGISTER_KEYWORD 1
 #include "lcms2.h"
@@ -115,6 +118,15 @@ public:
   void filterComponents(const std::vector<uint16_t>& compsToKeep);
   GrkImage* extractFrom(const Tile* tile_src) const;
   bool composite(const GrkImage* src);
+  /**
+   * @brief Composites components [begin, end) of a tile, releasing their window data
+   *
+   * @param src tile source
+   * @param begin first component
+   * @param end one past the last component
+   * @return true if successful
+   */
+  bool compositeComponents(const Tile* src, uint16_t begin, uint16_t end);
   bool greyToRGB(void);
   template<typename T>
   bool applyColourManagement(void);
@@ -279,20 +291,61 @@ public:
   bool applyICC(void);
 
 private:
+  /**
+   * @struct PrecisionOp
+   * @brief One per-sample step of convertPrecision()
+   *
+   * Steps are planned up front, updating component precision and sign as they
+   * go, then all of them run together on each band of rows.
+   */
+  struct PrecisionOp
+  {
+    enum Kind
+    {
+      RESCALE,
+      CLIP,
+      SCALE_UP,
+      SCALE_DOWN
+    };
+    Kind kind;
+    grk_rescale rescale;
+    int64_t minimum; // CLIP
+    int64_t maximum; // CLIP
+    int64_t scale; // SCALE_UP, SCALE_DOWN
+  };
+  static void planRescale(grk_image_comp* component, const grk_rescale& r,
+                          std::vector<PrecisionOp>& ops);
+  static void planClip(grk_image_comp* component, uint8_t precision,
+                       std::vector<PrecisionOp>& ops);
+  static void planScale(grk_image_comp* component, uint8_t precision,
+                        std::vector<PrecisionOp>& ops);
   template<typename T>
-  void scaleComponent(grk_image_comp* component, uint8_t precision);
+  void applyPrecisionOps(const std::vector<std::vector<PrecisionOp>>& ops);
 
-  template<typename T>
-  void rescaleComponent(grk_image_comp* component, const grk_rescale& r);
+  /**
+   * @brief Runs a row kernel over bands of rows on the executor
+   *
+   * Post-processing kernels work row by row, so the image is split into bands
+   * (two per thread, each large enough to amortize scheduling) that run
+   * concurrently. Small images and single-threaded executors run the kernel
+   * inline over all rows.
+   * @param numRows number of rows
+   * @param rowSamples samples touched per row, across all planes, used to size bands
+   * @param kernel called with [yBegin, yEnd) for each band
+   */
+  static void forEachRowBand(uint32_t numRows, uint64_t rowSamples,
+                             const std::function<void(uint32_t yBegin, uint32_t yEnd)>& kernel);
 
   /** Copy planar image data to planar composite image
    *
-   * @param src 	source image
+   * @param srcNumComps number of source components
+   * @param srcComps source components
+   * @param destCompno composite component of the first source component
    *
    * @return			true if successful
    **/
   template<typename T>
-  bool compositePlanar(uint16_t srcNumComps, grk_image_comp* srcComps);
+  bool compositePlanar(uint16_t srcNumComps, grk_image_comp* srcComps, uint16_t destCompno = 0);
 
   template<typename T>
   bool sycc444_to_rgb(void);
@@ -371,11 +424,9 @@ bool GrkImage::cieLabToRGB(void)
   bool defaultType = true;
   color_space = GRK_CLRSPC_SRGB;
   defaultType = row[1] == GRK_DEFAULT_CIELAB_SPACE;
-  T *L, *a, *b, *red, *green, *blue;
   // range, offset and precision for L,a and b coordinates
   double r_L, o_L, r_a, o_a, r_b, o_b, prec_L, prec_a, prec_b;
   double minL, maxL, mina, maxa, minb, maxb;
-  cmsUInt16Number RGB[3];
   prec_L = (double)comps[0].prec;
   prec_a = (double)comps[1].prec;
   prec_b = (double)comps[2].prec;
@@ -434,6 +485,15 @@ bool GrkImage::cieLabToRGB(void)
       break;
   }
 
+  auto L = (T*)comps[0].data;
+  auto a = (T*)comps[1].data;
+  auto b = (T*)comps[2].data;
+  if(!L || !a || !b)
+  {
+    grklog.warn("color_cielab_to_rgb: null L*a*b component");
+    return false;
+  }
+
   // Lab input profile
   auto in = cmsCreateLab4Profile(illuminant == GRK_CIE_D50 ? nullptr : &WhitePoint);
   // sRGB output profile
@@ -445,26 +505,20 @@ bool GrkImage::cieLabToRGB(void)
   if(transform == nullptr)
     return false;
 
-  L = (T*)comps[0].data;
-  a = (T*)comps[1].data;
-  b = (T*)comps[2].data;
-
-  if(!L || !a || !b)
-  {
-    grklog.warn("color_cielab_to_rgb: null L*a*b component");
-    return false;
-  }
-
   auto dest_img = createRGB(3, comps[0].w, comps[0].h, comps[0].prec);
   if(!dest_img)
+  {
+    cmsDeleteTransform(transform);
     return false;
+  }
 
-  red = (T*)dest_img->comps[0].data;
-  green = (T*)dest_img->comps[1].data;
-  blue = (T*)dest_img->comps[2].data;
+  auto red = (T*)dest_img->comps[0].data;
+  auto green = (T*)dest_img->comps[1].data;
+  auto blue = (T*)dest_img->comps[2].data;
 
-  uint32_t src_stride_diff = comps[0].stride - comps[0].w;
-  uint32_t dest_stride_diff = dest_img->comps[0].stride - dest_img->comps[0].w;
+  uint32_t w = comps[0].w;
+  uint32_t srcStride = comps[0].stride;
+  uint32_t destStride = dest_img->comps[0].stride;
 
   minL = -(r_L * o_L) / (pow(2, prec_L) - 1);
   maxL = minL + r_L;
@@ -475,31 +529,34 @@ bool GrkImage::cieLabToRGB(void)
   minb = -(r_b * o_b) / (pow(2, prec_b) - 1);
   maxb = minb + r_b;
 
-  size_t dest_index = 0;
-  for(uint32_t j = 0; j < comps[0].h; ++j)
-  {
-    for(uint32_t k = 0; k < comps[0].w; ++k)
+  double scaleL = (maxL - minL) / (pow(2, prec_L) - 1);
+  double scalea = (maxa - mina) / (pow(2, prec_a) - 1);
+  double scaleb = (maxb - minb) / (pow(2, prec_b) - 1);
+
+  // lcms transforms are safe to share between threads; each band transforms
+  // a whole row per call
+  forEachRowBand(comps[0].h, (uint64_t)w * 6, [=](uint32_t yBegin, uint32_t yEnd) {
+    auto Lab = std::make_unique<cmsCIELab[]>(w);
+    auto RGB = std::make_unique<cmsUInt16Number[]>((size_t)w * 3);
+    for(uint32_t j = yBegin; j < yEnd; ++j)
     {
-      cmsCIELab Lab;
-      Lab.L = minL + (double)(*L) * (maxL - minL) / (pow(2, prec_L) - 1);
-      ++L;
-      Lab.a = mina + (double)(*a) * (maxa - mina) / (pow(2, prec_a) - 1);
-      ++a;
-      Lab.b = minb + (double)(*b) * (maxb - minb) / (pow(2, prec_b) - 1);
-      ++b;
-
-      cmsDoTransform(transform, &Lab, RGB, 1);
-
-      red[dest_index] = (T)RGB[0];
-      green[dest_index] = (T)RGB[1];
-      blue[dest_index] = (T)RGB[2];
-      dest_index++;
+      size_t srcIndex = (size_t)j * srcStride;
+      for(uint32_t k = 0; k < w; ++k)
+      {
+        Lab[k].L = minL + (double)L[srcIndex + k] * scaleL;
+        Lab[k].a = mina + (double)a[srcIndex + k] * scalea;
+        Lab[k].b = minb + (double)b[srcIndex + k] * scaleb;
+      }
+      cmsDoTransform(transform, Lab.get(), RGB.get(), w);
+      size_t destIndex = (size_t)j * destStride;
+      for(uint32_t k = 0; k < w; ++k)
+      {
+        red[destIndex + k] = (T)RGB[3 * k];
+        green[destIndex + k] = (T)RGB[3 * k + 1];
+        blue[destIndex + k] = (T)RGB[3 * k + 2];
+      }
     }
-    dest_index += dest_stride_diff;
-    L += src_stride_diff;
-    a += src_stride_diff;
-    b += src_stride_diff;
-  }
+  });
   cmsDeleteTransform(transform);
 
   for(i = 0; i < numcomps; ++i)
@@ -526,69 +583,10 @@ bool GrkImage::cieLabToRGB(void)
   return true;
 }
 
-template<typename T>
-void clip(grk_image_comp* component, uint8_t precision)
-{
-  uint32_t stride_diff = component->stride - component->w;
-  assert(precision <= GRK_MAX_SUPPORTED_IMAGE_PRECISION);
-  auto data = (T*)component->data;
-  size_t index = 0;
-
-  // Define clamping bounds based on type and signedness
-  T minimum, maximum;
-  if constexpr(std::is_floating_point_v<T>)
-  {
-    // For floating-point types, use normalized ranges
-    if(component->sgnd)
-    {
-      minimum = -1.0f;
-      maximum = 1.0f;
-    }
-    else
-    {
-      minimum = 0.0f;
-      maximum = 1.0f;
-    }
-  }
-  else
-  {
-    // For integer types, compute bounds based on precision
-    if(component->sgnd)
-    {
-      minimum = static_cast<T>(-(1LL << (precision - 1)));
-      maximum = static_cast<T>((1LL << (precision - 1)) - 1);
-    }
-    else
-    {
-      minimum = static_cast<T>(0);
-      maximum = static_cast<T>((1ULL << precision) - 1);
-    }
-  }
-
-  // Clip the data
-  if constexpr(std::is_same_v<T, int32_t>)
-  {
-    hwy_clip_i32(data, component->w, component->h, component->stride, (int32_t)minimum,
-                 (int32_t)maximum);
-  }
-  else
-  {
-    for(uint32_t j = 0; j < component->h; ++j)
-    {
-      for(uint32_t i = 0; i < component->w; ++i)
-      {
-        data[index] = std::clamp<T>(data[index], minimum, maximum);
-        index++;
-      }
-      index += stride_diff;
-    }
-  }
-  component->prec = precision;
-}
-
 template<typename T>
 void GrkImage::convertPrecision(void)
 {
+  std::vector<std::vector<PrecisionOp>> ops(numcomps);
   if(rescale && num_rescale)
   {
     for(uint16_t compno = 0; compno < numcomps; ++compno)
@@ -596,7 +594,7 @@ void GrkImage::convertPrecision(void)
       uint32_t rno = compno;
       if(rno >= num_rescale)
         rno = num_rescale - 1U;
-      rescaleComponent<T>(comps + compno, rescale[rno]);
+      planRescale(comps + compno, rescale[rno], ops[compno]);
     }
   }
   if(precision)
@@ -613,10 +611,10 @@ void GrkImage::convertPrecision(void)
       switch(precision[precisionno].mode)
       {
         case GRK_PREC_MODE_CLIP:
-          clip<T>(comp, prec);
+          planClip(comp, prec, ops[compno]);
           break;
         case GRK_PREC_MODE_SCALE:
-          scaleComponent<T>(comp, prec);
+          planScale(comp, prec, ops[compno]);
           break;
         default:
           break;
@@ -629,7 +627,7 @@ void GrkImage::convertPrecision(void)
     if(prec < 8 && numcomps > 1)
     { /* GRAY_ALPHA, RGB, RGB_ALPHA */
       for(uint16_t i = 0; i < numcomps; ++i)
-        scaleComponent<T>(comps + i, 8);
+        planScale(comps + i, 8, ops[i]);
     }
     else if((prec > 1) && (prec < 8) && ((prec == 6) || ((prec & 1) == 1)))
     { /* GRAY with non native precision */
@@ -638,7 +636,7 @@ void GrkImage::convertPrecision(void)
       else
         prec++;
       for(uint16_t i = 0; i < numcomps; ++i)
-        scaleComponent<T>(comps + i, prec);
+        planScale(comps + i, prec, ops[i]);
     }
   }
   else if(decompress_fmt == GRK_FMT_PNG)
@@ -668,8 +666,93 @@ void GrkImage::convertPrecision(void)
         prec++;
     }
     for(uint16_t i = 0; i < nr_comp; ++i)
-      scaleComponent<T>(comps + i, prec);
+      planScale(comps + i, prec, ops[i]);
   }
+  applyPrecisionOps<T>(ops);
+}
+
+template<typename T>
+void GrkImage::applyPrecisionOps(const std::vector<std::vector<PrecisionOp>>& ops)
+{
+  uint32_t numRows = 0;
+  uint64_t rowSamples = 0;
+  for(uint16_t compno = 0; compno < numcomps; ++compno)
+  {
+    if(ops[compno].empty() || !comps[compno].data)
+      continue;
+    numRows = std::max(numRows, comps[compno].h);
+    rowSamples += comps[compno].w;
+  }
+  if(!rowSamples)
+    return;
+
+  // all steps of all components run on a band while it is still in cache
+  forEachRowBand(numRows, rowSamples, [this, &ops](uint32_t yBegin, uint32_t yEnd) {
+    for(uint16_t compno = 0; compno < numcomps; ++compno)
+    {
+      auto comp = comps + compno;
+      if(ops[compno].empty() || !comp->data || yBegin >= comp->h)
+        continue;
+      uint32_t yStop = std::min(yEnd, comp->h);
+      uint32_t rows = yStop - yBegin;
+      auto data = (T*)comp->data + (size_t)yBegin * comp->stride;
+      for(auto& op : ops[compno])
+      {
+        switch(op.kind)
+        {
+          case PrecisionOp::RESCALE:
+            rescale_rows<T>(comp, op.rescale, yBegin, yStop);
+            break;
+          case PrecisionOp::CLIP:
+            if constexpr(std::is_same_v<T, int32_t>)
+            {
+              hwy_clip_i32(data, comp->w, rows, comp->stride, (int32_t)op.minimum,
+                           (int32_t)op.maximum);
+            }
+            else
+            {
+              for(uint32_t j = 0; j < rows; ++j)
+              {
+                auto row = data + (size_t)j * comp->stride;
+                for(uint32_t i = 0; i < comp->w; ++i)
+                  row[i] = std::clamp<T>(row[i], (T)op.minimum, (T)op.maximum);
+              }
+            }
+            break;
+          case PrecisionOp::SCALE_UP:
+            if constexpr(std::is_same_v<T, int32_t>)
+            {
+              hwy_scale_mul_i32(data, comp->w, rows, comp->stride, (int32_t)op.scale);
+            }
+            else
+            {
+              for(uint32_t j = 0; j < rows; ++j)
+              {
+                auto row = data + (size_t)j * comp->stride;
+                for(uint32_t i = 0; i < comp->w; ++i)
+                  row[i] *= (T)op.scale;
+              }
+            }
+            break;
+          case PrecisionOp::SCALE_DOWN:
+            if constexpr(std::is_same_v<T, int32_t>)
+            {
+              hwy_scale_div_i32(data, comp->w, rows, comp->stride, (int32_t)op.scale);
+            }
+            else
+            {
+              for(uint32_t j = 0; j < rows; ++j)
+              {
+                auto row = data + (size_t)j * comp->stride;
+                for(uint32_t i = 0; i < comp->w; ++i)
+                  row[i] /= (T)op.scale;
+              }
+            }
+            break;
+        }
+      }
+    }
+  });
 }
 
 // assuming unsigned data !
@@ -693,59 +776,62 @@ bool GrkImage::color_esycc_to_rgb(void)
   bool sign1 = comps[1].sgnd;
   bool sign2 = comps[2].sgnd;
 
-  uint32_t stride_diff = comps[0].stride - w;
-  size_t dest_index = 0;
+  uint32_t stride = comps[0].stride;
   auto yd = (T*)comps[0].data;
   auto bd = (T*)comps[1].data;
   auto rd = (T*)comps[2].data;
 
-  if constexpr(std::is_same_v<T, int32_t>)
-  {
-    hwy_esycc_to_rgb_i32(yd, bd, rd, w, h, comps[0].stride, max_value, flip_value, sign1, sign2);
-  }
-  else
-  {
-    for(uint32_t j = 0; j < h; ++j)
+  forEachRowBand(h, (uint64_t)w * 3, [=](uint32_t yBegin, uint32_t yEnd) {
+    size_t bandOffset = (size_t)yBegin * stride;
+    if constexpr(std::is_same_v<T, int32_t>)
     {
-      for(uint32_t i = 0; i < w; ++i)
+      hwy_esycc_to_rgb_i32(yd + bandOffset, bd + bandOffset, rd + bandOffset, w, yEnd - yBegin,
+                           stride, max_value, flip_value, sign1, sign2);
+    }
+    else
+    {
+      for(uint32_t j = yBegin; j < yEnd; ++j)
       {
-        T y = yd[dest_index];
-        T cb = bd[dest_index];
-        T cr = rd[dest_index];
-
-        if(!sign1)
-          cb -= flip_value;
-        if(!sign2)
-          cr -= flip_value;
-
-        T val = (T)(y - 0.0000368 * cb + 1.40199 * cr + 0.5);
-
-        if(val > max_value)
-          val = max_value;
-        else if(val < 0)
-          val = 0;
-        yd[dest_index] = val;
-
-        val = (T)(1.0003 * y - 0.344125 * cb - 0.7141128 * cr + 0.5);
-
-        if(val > max_value)
-          val = max_value;
-        else if(val < 0)
-          val = 0;
-        bd[dest_index] = val;
-
-        val = (T)(0.999823 * y + 1.77204 * cb - 0.000008 * cr + 0.5);
-
-        if(val > max_value)
-          val = max_value;
-        else if(val < 0)
-          val = 0;
-        rd[dest_index] = val;
-        dest_index++;
+        size_t dest_index = (size_t)j * stride;
+        for(uint32_t i = 0; i < w; ++i)
+        {
+          T y = yd[dest_index];
+          T cb = bd[dest_index];
+          T cr = rd[dest_index];
+
+          if(!sign1)
+            cb -= flip_value;
+          if(!sign2)
+            cr -= flip_value;
+
+          T val = (T)(y - 0.0000368 * cb + 1.40199 * cr + 0.5);
+
+          if(val > max_value)
+            val = max_value;
+          else if(val < 0)
+            val = 0;
+          yd[dest_index] = val;
+
+          val = (T)(1.0003 * y - 0.344125 * cb - 0.7141128 * cr + 0.5);
+
+          if(val > max_value)
+            val = max_value;
+          else if(val < 0)
+            val = 0;
+          bd[dest_index] = val;
+
+          val = (T)(0.999823 * y + 1.77204 * cb - 0.000008 * cr + 0.5);
+
+          if(val > max_value)
+            val = max_value;
+          else if(val < 0)
+            val = 0;
+          rd[dest_index] = val;
+          dest_index++;
+        }
       }
-      dest_index += stride_diff;
     }
-  }
+  });
   color_space = GRK_CLRSPC_SRGB;
 
   return true;
@@ -771,37 +857,38 @@ bool GrkImage::color_cmyk_to_rgb(void)
   float sY = 1.0F / (float)((1ULL << comps[2].prec) - 1);
   float sK = 1.0F / (float)((1ULL << comps[3].prec) - 1);
 
-  uint32_t stride_diff = comps[0].stride - w;
-  size_t dest_index = 0;
+  uint32_t stride = comps[0].stride;
   auto cd = (T*)comps[0].data;
   auto md = (T*)comps[1].data;
   auto yd = (T*)comps[2].data;
   auto kd = (T*)comps[3].data;
 
-  for(uint32_t j = 0; j < h; ++j)
-  {
-    for(uint32_t i = 0; i < w; ++i)
+  forEachRowBand(h, (uint64_t)w * 4, [=](uint32_t yBegin, uint32_t yEnd) {
+    for(uint32_t j = yBegin; j < yEnd; ++j)
     {
-      /* CMYK values from 0 to 1 */
-      float C = std::clamp((float)(cd[dest_index]) * sC, 0.0f, 1.0f);
-      float M = std::clamp((float)(md[dest_index]) * sM, 0.0f, 1.0f);
-      float Y = std::clamp((float)(yd[dest_index]) * sY, 0.0f, 1.0f);
-      float K = std::clamp((float)(kd[dest_index]) * sK, 0.0f, 1.0f);
-
-      /* Invert all CMYK values */
-      C = 1.0F - C;
-      M = 1.0F - M;
-      Y = 1.0F - Y;
-      K = 1.0F - K;
-
-      /* CMYK -> RGB : RGB results from 0 to 255 */
-      cd[dest_index] = (T)(255.0F * C * K); /* R */
-      md[dest_index] = (T)(255.0F * M * K); /* G */
-      yd[dest_index] = (T)(255.0F * Y * K); /* B */
-      dest_index++;
+      size_t dest_index = (size_t)j * stride;
+      for(uint32_t i = 0; i < w; ++i)
+      {
+        /* CMYK values from 0 to 1 */
+        float C = std::clamp((float)(cd[dest_index]) * sC, 0.0f, 1.0f);
+        float M = std::clamp((float)(md[dest_index]) * sM, 0.0f, 1.0f);
+        float Y = std::clamp((float)(yd[dest_index]) * sY, 0.0f, 1.0f);
+        float K = std::clamp((float)(kd[dest_index]) * sK, 0.0f, 1.0f);
+
+        /* Invert all CMYK values */
+        C = 1.0F - C;
+        M = 1.0F - M;
+        Y = 1.0F - Y;
+        K = 1.0F - K;
+
+        /* CMYK -> RGB : RGB results from 0 to 255 */
+        cd[dest_index] = (T)(255.0F * C * K); /* R */
+        md[dest_index] = (T)(255.0F * M * K); /* G */
+        yd[dest_index] = (T)(255.0F * Y * K); /* B */
+        dest_index++;
+      }
     }
-    dest_index += stride_diff;
-  }
+  });
 
   single_component_data_free(comps + 3);
   comps[0].prec = 8;
@@ -864,83 +951,26 @@ bool GrkImage::color_sycc_to_rgb(bool oddFirstX, bool oddFirstY)
 
 } /* color_sycc_to_rgb() */
 
-template<typename T>
-void GrkImage::scaleComponent(grk_image_comp* component, uint8_t precision)
-{
-  if(component->prec == precision)
-    return;
-  uint32_t diff =
-      (precision > component->prec) ? (precision - component->prec) : (component->prec - precision);
-  if(diff >= 64) // prevent overflow
-  {
-    grklog.error("scaleComponent: precision difference %u too large", diff);
-    return;
-  }
-  uint32_t stride_diff = component->stride - component->w;
-  auto data = (T*)component->data;
-  if(component->prec < precision)
-  {
-    T scale = (T)(1ULL << diff);
-    if constexpr(std::is_same_v<T, int32_t>)
-    {
-      hwy_scale_mul_i32(data, component->w, component->h, component->stride, scale);
-    }
-    else
-    {
-      size_t index = 0;
-      for(uint32_t j = 0; j < component->h; ++j)
-      {
-        for(uint32_t i = 0; i < component->w; ++i)
-          data[index++] *= scale;
-        index += stride_diff;
-      }
-    }
-  }
-  else
-  {
-    T scale = (T)(1ULL << diff);
-    if constexpr(std::is_same_v<T, int32_t>)
-    {
-      hwy_scale_div_i32(data, component->w, component->h, component->stride, scale);
-    }
-    else
-    {
-      size_t index = 0;
-      for(uint32_t j = 0; j < component->h; ++j)
-      {
-        for(uint32_t i = 0; i < component->w; ++i)
-          data[index++] /= scale;
-        index += stride_diff;
-      }
-    }
-  }
-  component->prec = precision;
-}
-
-template<typename T>
-void GrkImage::rescaleComponent(grk_image_comp* component, const grk_rescale& r)
-{
-  if(!rescale_component<T>(component, r))
-    grklog.warn("rescaleComponent: skipped (src_min == src_max or null data)");
-}
-
 /** Copy planar image data to planar composite image
  *
- * @param src 	source image
+ * @param srcNumComps number of source components
+ * @param srcComps source components
+ * @param destCompno composite component of the first source component
  *
  * @return			true if successful
  **/
 template<typename T>
-bool GrkImage::compositePlanar(uint16_t srcNumComps, grk_image_comp* srcComps)
+bool GrkImage::compositePlanar(uint16_t srcNumComps, grk_image_comp* srcComps,
+                               uint16_t destCompno)
 {
   for(uint16_t compno = 0; compno < srcNumComps; compno++)
   {
-    auto destComp = comps + compno;
+    auto destComp = comps + destCompno + compno;
     if(!destComp->data)
       continue;
     Rect32 destWin;
     auto srcComp = srcComps + compno;
-    if(!generateCompositeBounds(srcComp, compno, &destWin))
+    if(!generateCompositeBounds(srcComp, (uint16_t)(destCompno + compno), &destWin))
     {
       grklog.warn("GrkImage::compositePlanar: cannot generate composite bounds for component %u",
                   compno);
@@ -1000,7 +1030,6 @@ bool GrkImage::compositePlanar(uint16_t srcNumComps, grk_image_comp* srcComps)
 template<typename T>
 bool GrkImage::sycc444_to_rgb(void)
 {
-  T *d0, *d1, *d2, *r, *g, *b;
   auto dst = createRGB(3, comps[0].w, comps[0].h, comps[0].prec);
   if(!dst)
     return false;
@@ -1009,46 +1038,47 @@ bool GrkImage::sycc444_to_rgb(void)
   T upb = (T)((1ULL << comps[0].prec) - 1);
 
   uint32_t w = comps[0].w;
-  uint32_t src_stride_diff = comps[0].stride - w;
-  uint32_t dst_stride_diff = dst->comps[0].stride - dst->comps[0].w;
   uint32_t h = comps[0].h;
+  uint32_t srcStride = comps[0].stride;
+  uint32_t dstStride = dst->comps[0].stride;
 
   auto y = (T*)comps[0].data;
   auto cb = (T*)comps[1].data;
   auto cr = (T*)comps[2].data;
 
-  d0 = r = (T*)dst->comps[0].data;
-  d1 = g = (T*)dst->comps[1].data;
-  d2 = b = (T*)dst->comps[2].data;
+  auto r = (T*)dst->comps[0].data;
+  auto g = (T*)dst->comps[1].data;
+  auto b = (T*)dst->comps[2].data;
 
   dst->comps[0].data = nullptr;
   dst->comps[1].data = nullptr;
   dst->comps[2].data = nullptr;
 
-  if constexpr(std::is_same_v<T, int32_t>)
-  {
-    hwy_sycc444_to_rgb_i32(y, cb, cr, r, g, b, w, h, comps[0].stride, dst->comps[0].stride, offset,
-                           upb);
-  }
-  else
-  {
-    for(uint32_t j = 0; j < h; ++j)
+  forEachRowBand(h, (uint64_t)w * 6, [=](uint32_t yBegin, uint32_t yEnd) {
+    size_t srcOffset = (size_t)yBegin * srcStride;
+    size_t dstOffset = (size_t)yBegin * dstStride;
+    if constexpr(std::is_same_v<T, int32_t>)
     {
-      for(uint32_t i = 0; i < w; ++i)
-        sycc_to_rgb<T>(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-      y += src_stride_diff;
-      cb += src_stride_diff;
-      cr += src_stride_diff;
-      r += dst_stride_diff;
-      g += dst_stride_diff;
-      b += dst_stride_diff;
+      hwy_sycc444_to_rgb_i32(y + srcOffset, cb + srcOffset, cr + srcOffset, r + dstOffset,
+                             g + dstOffset, b + dstOffset, w, yEnd - yBegin, srcStride, dstStride,
+                             offset, upb);
     }
-  }
+    else
+    {
+      for(uint32_t j = 0; j < yEnd - yBegin; ++j)
+      {
+        size_t s = srcOffset + (size_t)j * srcStride;
+        size_t d = dstOffset + (size_t)j * dstStride;
+        sycc_row_to_rgb<T>(offset, upb, y + s, cb + s, cr + s, r + d, g + d, b + d, w, false,
+                           false, false);
+      }
+    }
+  });
 
   all_components_data_free();
-  comps[0].data = d0;
-  comps[1].data = d1;
-  comps[2].data = d2;
+  comps[0].data = r;
+  comps[1].data = g;
+  comps[2].data = b;
   color_space = GRK_CLRSPC_SRGB;
 
   for(uint16_t i = 0; i < numcomps; ++i)
@@ -1077,19 +1107,6 @@ bool GrkImage::sycc422_to_rgb(bool oddFirstX)
     return false;
   }
 
-  auto dst = createRGB(3, w, h, comps[0].prec);
-  if(!dst)
-    return false;
-
-  T offset = (T)(1ULL << (comps[0].prec - 1));
-  T upb = (T)((1ULL << comps[0].prec) - 1);
-
-  uint32_t dst_stride_diff = dst->comps[0].stride - dst->comps[0].w;
-  uint32_t src_stride_diff = comps[0].stride - w;
-  uint32_t src_stride_diff_chroma = comps[1].stride - comps[1].w;
-
-  T *d0, *d1, *d2, *r, *g, *b;
-
   auto y = (T*)comps[0].data;
   if(!y)
   {
@@ -1104,40 +1121,39 @@ bool GrkImage::sycc422_to_rgb(bool oddFirstX)
     return false;
   }
 
-  d0 = r = (T*)dst->comps[0].data;
-  d1 = g = (T*)dst->comps[1].data;
-  d2 = b = (T*)dst->comps[2].data;
+  auto dst = createRGB(3, w, h, comps[0].prec);
+  if(!dst)
+    return false;
+
+  T offset = (T)(1ULL << (comps[0].prec - 1));
+  T upb = (T)((1ULL << comps[0].prec) - 1);
+
+  uint32_t lumaStride = comps[0].stride;
+  uint32_t chromaStride = comps[1].stride;
+  uint32_t dstStride = dst->comps[0].stride;
+
+  auto r = (T*)dst->comps[0].data;
+  auto g = (T*)dst->comps[1].data;
+  auto b = (T*)dst->comps[2].data;
 
   dst->comps[0].data = nullptr;
   dst->comps[1].data = nullptr;
   dst->comps[2].data = nullptr;
 
-  for(uint32_t i = 0U; i < h; ++i)
-  {
-    if(oddFirstX)
-      sycc_to_rgb<T>(offset, upb, *y++, 0, 0, r++, g++, b++);
-
-    uint32_t j;
-    for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
+  forEachRowBand(h, (uint64_t)w * 5, [=](uint32_t yBegin, uint32_t yEnd) {
+    for(uint32_t i = yBegin; i < yEnd; ++i)
     {
-      sycc_to_rgb<T>(offset, upb, *y++, *cb, *cr, r++, g++, b++);
-      sycc_to_rgb<T>(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
+      size_t c = (size_t)i * chromaStride;
+      size_t d = (size_t)i * dstStride;
+      sycc_row_to_rgb<T>(offset, upb, y + (size_t)i * lumaStride, cb + c, cr + c, r + d, g + d,
+                         b + d, w, true, oddFirstX, false);
     }
-    if(j < loopWidth)
-      sycc_to_rgb<T>(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-
-    y += src_stride_diff;
-    cb += src_stride_diff_chroma;
-    cr += src_stride_diff_chroma;
-    r += dst_stride_diff;
-    g += dst_stride_diff;
-    b += dst_stride_diff;
-  }
+  });
   all_components_data_free();
 
-  comps[0].data = d0;
-  comps[1].data = d1;
-  comps[2].data = d2;
+  comps[0].data = r;
+  comps[1].data = g;
+  comps[2].data = b;
 
   comps[1].w = comps[2].w = w;
   comps[1].h = comps[2].h = h;
@@ -1190,89 +1206,38 @@ bool GrkImage::sycc420_to_rgb(bool oddFirstX, bool oddFirstY)
   T offset = (T)(1ULL << (comps[0].prec - 1));
   T upb = (T)((1ULL << comps[0].prec) - 1);
 
-  uint32_t stride_src[3];
-  uint32_t stride_src_diff[3];
-
-  uint32_t stride_dest = rgbImg->comps[0].stride;
-  uint32_t stride_dest_diff = rgbImg->comps[0].stride - w;
-
-  T* src[3];
-  T* dest_ptr[3];
-  for(uint32_t i = 0; i < 3; ++i)
-  {
-    auto srcComp = comps + i;
-    src[i] = (T*)srcComp->data;
-    stride_src[i] = srcComp->stride;
-    stride_src_diff[i] = srcComp->stride - srcComp->w;
-
-    dest_ptr[i] = (T*)rgbImg->comps[i].data;
-  }
-  // if img->y0 is odd, then first line shall use Cb/Cr = 0
-  if(oddFirstY)
-  {
-    for(size_t j = 0U; j < w; ++j)
-      sycc_to_rgb<T>(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-    src[0] += stride_src_diff[0];
-    for(uint32_t i = 0; i < 3; ++i)
-      dest_ptr[i] += stride_dest_diff;
-  }
-
-  size_t i;
-  for(i = 0U; i < (loopHeight & ~(size_t)1U); i += 2U)
-  {
-    auto nextY = src[0] + stride_src[0];
-    auto nextRed = dest_ptr[0] + stride_dest;
-    auto nextGreen = dest_ptr[1] + stride_dest;
-    auto nextBlue = dest_ptr[2] + stride_dest;
-    // if img->x0 is odd, then first column shall use Cb/Cr = 0
-    if(oddFirstX)
-    {
-      sycc_to_rgb<T>(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-      sycc_to_rgb<T>(offset, upb, *nextY++, *src[1], *src[2], nextRed++, nextGreen++, nextBlue++);
-    }
-    uint32_t j;
-    for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
-    {
-      sycc_to_rgb<T>(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-                     dest_ptr[2]++);
-      sycc_to_rgb<T>(offset, upb, *nextY++, *src[1], *src[2], nextRed++, nextGreen++, nextBlue++);
-
-      sycc_to_rgb<T>(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-                     dest_ptr[2]++);
-      sycc_to_rgb<T>(offset, upb, *nextY++, *src[1]++, *src[2]++, nextRed++, nextGreen++,
-                     nextBlue++);
-    }
-    if(j < loopWidth)
-    {
-      sycc_to_rgb<T>(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-                     dest_ptr[2]++);
-      sycc_to_rgb<T>(offset, upb, *nextY++, *src[1]++, *src[2]++, nextRed++, nextGreen++,
-                     nextBlue++);
-    }
-    for(uint32_t k = 0; k < 3; ++k)
-    {
-      dest_ptr[k] += stride_dest_diff + stride_dest;
-      src[k] += stride_src_diff[k];
-    }
-    src[0] += stride_src[0];
-  }
-  // final odd row has no sub-sampling
-  if(i < loopHeight)
-  {
-    // if img->x0 is odd, then first column shall use Cb/Cr = 0
-    if(oddFirstX)
-      sycc_to_rgb<T>(offset, upb, *src[0]++, 0, 0, dest_ptr[0]++, dest_ptr[1]++, dest_ptr[2]++);
-    uint32_t j;
-    for(j = 0U; j < (loopWidth & ~(size_t)1U); j += 2U)
+  uint32_t lumaStride = comps[0].stride;
+  uint32_t chromaStride = comps[1].stride;
+  uint32_t dstStride = rgbImg->comps[0].stride;
+  auto y = (T*)comps[0].data;
+  auto cb = (T*)comps[1].data;
+  auto cr = (T*)comps[2].data;
+  auto r = (T*)rgbImg->comps[0].data;
+  auto g = (T*)rgbImg->comps[1].data;
+  auto b = (T*)rgbImg->comps[2].data;
+
+  // if img->y0 is odd, then first line shall use Cb/Cr = 0. Every other line takes
+  // the chroma line of its pair; in the second line of a pair, an odd first column
+  // reuses the first chroma sample.
+  forEachRowBand(h, (uint64_t)w * 4, [=](uint32_t yBegin, uint32_t yEnd) {
+    for(uint32_t row = yBegin; row < yEnd; ++row)
     {
-      sycc_to_rgb<T>(offset, upb, *src[0]++, *src[1], *src[2], dest_ptr[0]++, dest_ptr[1]++,
-                     dest_ptr[2]++);
-      sycc_to_rgb<T>(offset, upb, *src[0]++, *src[1]++, *src[2]++, dest_ptr[0]++, dest_ptr[1]++,
-                     dest_ptr[2]++);
+      const T* cbRow = nullptr;
+      const T* crRow = nullptr;
+      bool secondOfPair = false;
+      if(!oddFirstY || row > 0)
+      {
+        uint32_t pairRow = row - (oddFirstY ? 1 : 0);
+        size_t c = (size_t)(pairRow >> 1) * chromaStride;
+        cbRow = cb + c;
+        crRow = cr + c;
+        secondOfPair = (pairRow & 1) != 0;
+      }
+      size_t d = (size_t)row * dstStride;
+      sycc_row_to_rgb<T>(offset, upb, y + (size_t)row * lumaStride, cbRow, crRow, r + d, g + d,
+                         b + d, w, true, oddFirstX, secondOfPair);
     }
-    if(j < loopWidth)
-      sycc_to_rgb<T>(offset, upb, *src[0], *src[1], *src[2], dest_ptr[0], dest_ptr[1], dest_ptr[2]);
-  }
+  });
 
   all_components_data_free();
   for(uint32_t k = 0; k < 3; ++k)
@@ -1405,37 +1370,31 @@ bool GrkImage::apply_palette_clr()
     // do palette mapping
     auto src = (T*)oldComps[compno].data;
     auto dst = (T*)newComps[channel].data;
-    size_t num_pixels = (size_t)newComps[channel].stride * newComps[channel].h;
-    uint32_t srcDiff = (uint32_t)(oldComps[compno].stride - oldComps[compno].w);
-    uint32_t dstDiff = (uint32_t)(newComps[channel].stride - newComps[channel].w);
-    size_t srcInd = 0;
-    size_t dstInd = 0;
-
-    switch(mapping->mapping_type)
-    {
-      case 0: {
-        memcpy(dst, src, num_pixels * sizeof(T));
-      }
-      break;
-      case 1: {
-        uint16_t palette_column = mapping->palette_column;
+    uint32_t srcStride = oldComps[compno].stride;
+    uint32_t dstStride = newComps[channel].stride;
+    uint32_t w = newComps[channel].w;
+    bool direct = mapping->mapping_type == 0;
+    uint16_t palette_column = mapping->palette_column;
+    forEachRowBand(newComps[channel].h, w, [=](uint32_t yBegin, uint32_t yEnd) {
+      for(uint32_t n = yBegin; n < yEnd; ++n)
+      {
+        auto srcRow = src + (size_t)n * srcStride;
+        auto dstRow = dst + (size_t)n * dstStride;
+        if(direct)
+        {
+          memcpy(dstRow, srcRow, (size_t)w * sizeof(T));
+          continue;
+        }
         // note: 1 <= n <= 255
-        for(uint32_t n = 0; n < newComps[channel].h; ++n)
+        for(uint32_t m = 0; m < w; ++m)
         {
-          for(uint32_t m = 0; m < newComps[channel].w; ++m)
-          {
-            uint32_t k =
-                static_cast<uint32_t>(src[srcInd++]); // unsigned cast to avoid signed issues
-            if(k > top_k)
-              k = top_k;
-            dst[dstInd++] = (T)lut[k * num_channels + palette_column];
-          }
-          srcInd += srcDiff;
-          dstInd += dstDiff;
+          uint32_t k = static_cast<uint32_t>(srcRow[m]); // unsigned cast to avoid signed issues
+          if(k > top_k)
+            k = top_k;
+          dstRow[m] = (T)lut[k * num_channels + palette_column];
         }
       }
-      break;
-    }
+    });
   }
 
   // finalize
@@ -1503,71 +1462,40 @@ bool GrkImage::execUpsample(void)
       if((xoff >= org_cmp->dx) || (yoff >= org_cmp->dy))
       {
         grklog.error("upsample: Invalid image/component parameters found when upsampling");
+        for(uint16_t i = 0; i < numcomps; ++i)
+          single_component_data_free(new_components + i);
         delete[] new_components;
         return false;
       }
 
-      uint32_t y;
-      for(y = 0U; y < yoff; ++y)
-      {
-        memset(dst, 0U, (size_t)new_cmp->w * sizeof(T));
-        dst += new_cmp->stride;
-      }
-
-      if(new_cmp->h > (org_cmp->dy - 1U))
-      { /* check subtraction overflow for really small images */
-        for(; y < new_cmp->h - (org_cmp->dy - 1U); y += org_cmp->dy)
+      // each destination row replicates source row (y - yoff) / dy, so bands are independent
+      uint32_t dx = org_cmp->dx;
+      uint32_t dy = org_cmp->dy;
+      uint32_t w = new_cmp->w;
+      uint32_t srcStride = org_cmp->stride;
+      uint32_t dstStride = new_cmp->stride;
+      uint32_t lastSrcRow = org_cmp->h ? org_cmp->h - 1 : 0;
+      forEachRowBand(new_cmp->h, w, [=](uint32_t yBegin, uint32_t yEnd) {
+        for(uint32_t y = yBegin; y < yEnd; ++y)
         {
-          uint32_t x, dy;
-          uint32_t xorg = 0;
-          for(x = 0U; x < xoff; ++x)
-            dst[x] = 0;
-
-          if(new_cmp->w > (org_cmp->dx - 1U))
-          { /* check subtraction overflow for really small images */
-            for(; x < new_cmp->w - (org_cmp->dx - 1U); x += org_cmp->dx, ++xorg)
-            {
-              for(uint32_t dx = 0U; dx < org_cmp->dx; ++dx)
-                dst[x + dx] = src[xorg];
-            }
-          }
-          for(; x < new_cmp->w; ++x)
-            dst[x] = src[xorg];
-          dst += new_cmp->stride;
-
-          for(dy = 1U; dy < org_cmp->dy; ++dy)
+          auto dstRow = dst + (size_t)y * dstStride;
+          if(y < yoff)
           {
-            memcpy(dst, dst - new_cmp->stride, (size_t)new_cmp->w * sizeof(T));
-            dst += new_cmp->stride;
+            memset(dstRow, 0U, (size_t)w * sizeof(T));
+            continue;
           }
-          src += org_cmp->stride;
-        }
-      }
-      if(y < new_cmp->h)
-      {
-        uint32_t x;
-        uint32_t xorg = 0;
-        for(x = 0U; x < xoff; ++x)
-          dst[x] = 0;
-
-        if(new_cmp->w > (org_cmp->dx - 1U))
-        { /* check subtraction overflow for really small images */
-          for(; x < new_cmp->w - (org_cmp->dx - 1U); x += org_cmp->dx, ++xorg)
+          auto srcRow = src + (size_t)std::min((y - yoff) / dy, lastSrcRow) * srcStride;
+          uint32_t x = 0;
+          for(; x < std::min(xoff, w); ++x)
+            dstRow[x] = 0;
+          for(uint32_t xorg = 0; x < w; ++xorg)
           {
-            for(uint32_t dx = 0U; dx < org_cmp->dx; ++dx)
-              dst[x + dx] = src[xorg];
+            uint32_t xEnd = std::min(x + dx, w);
+            for(; x < xEnd; ++x)
+              dstRow[x] = srcRow[xorg];
           }
         }
-        for(; x < new_cmp->w; ++x)
-          dst[x] = src[xorg];
-        dst += new_cmp->stride;
-        ++y;
-        for(; y < new_cmp->h; ++y)
-        {
-          memcpy(dst, dst - new_cmp->stride, (size_t)new_cmp->w * sizeof(T));
-          dst += new_cmp->stride;
-        }
-      }
+      });
     }
     else
     {
@@ -1648,7 +1576,7 @@ bool GrkImage::applyICC(void)
   cmsHPROFILE out_prof = nullptr;
   cmsUInt32Number in_type, out_type;
   size_t nr_samples, componentSize;
-  uint32_t prec, w, stride_diff, h;
+  uint32_t prec, w, h;
   GRK_COLOR_SPACE oldspace;
   bool rc = false;
 
@@ -1676,7 +1604,6 @@ bool GrkImage::applyICC(void)
   intent = cmsGetHeaderRenderingIntent(in_prof);
 
   w = comps[0].w;
-  stride_diff = comps[0].stride - w;
   h = comps[0].h;
   if(!w || !h)
     goto cleanup;
@@ -1767,138 +1694,67 @@ bool GrkImage::applyICC(void)
 
   if(numcomps > 2)
   { /* RGB, RGBA */
-    if(prec <= 8)
+    if(w > UINT32_MAX / (3 * sizeof(uint16_t)))
     {
-      nr_samples = componentSize * 3U;
-      if(nr_samples / 3U != componentSize) // overflow check
-      {
-        grklog.error("nr_samples overflow in applyICC");
-        goto cleanup;
-      }
-      if(w > UINT32_MAX / 3)
-      {
-        grklog.error("Image width of {} converted to sample size 3 will overflow.", w);
-        goto cleanup;
-      }
-      auto inbuf = new uint8_t[nr_samples];
-      auto outbuf = new uint8_t[nr_samples];
-
-      auto r = (T*)comps[0].data;
-      auto g = (T*)comps[1].data;
-      auto b = (T*)comps[2].data;
-
-      if constexpr(std::is_same_v<T, int32_t>)
-      {
-        hwy_planar_to_packed_8(r, g, b, inbuf, w, h, comps[0].stride);
-      }
-      else
-      {
-        size_t src_index = 0;
-        size_t dest_index = 0;
-        for(uint32_t j = 0; j < h; ++j)
+      grklog.error("Image width of {} converted to sample size 3 will overflow.", w);
+      goto cleanup;
+    }
+    auto r = (T*)comps[0].data;
+    auto g = (T*)comps[1].data;
+    auto b = (T*)comps[2].data;
+    uint32_t stride = comps[0].stride;
+
+    // pack, transform and unpack one row at a time, so each band stays in cache
+    auto transformRGB = [&](auto sample) {
+      using S = decltype(sample);
+      forEachRowBand(h, (uint64_t)w * 3, [=](uint32_t yBegin, uint32_t yEnd) {
+        auto inbuf = std::make_unique<S[]>((size_t)w * 3);
+        auto outbuf = std::make_unique<S[]>((size_t)w * 3);
+        for(uint32_t j = yBegin; j < yEnd; ++j)
         {
-          for(uint32_t i = 0; i < w; ++i)
+          size_t row = (size_t)j * stride;
+          if constexpr(std::is_same_v<T, int32_t> && sizeof(S) == 1)
           {
-            inbuf[dest_index++] = (uint8_t)r[src_index];
-            inbuf[dest_index++] = (uint8_t)g[src_index];
-            inbuf[dest_index++] = (uint8_t)b[src_index];
-            src_index++;
+            hwy_planar_to_packed_8(r + row, g + row, b + row, inbuf.get(), w, 1, stride);
           }
-          src_index += stride_diff;
-        }
-      }
-
-      cmsDoTransformLineStride(transform, inbuf, outbuf, w, h, 3 * w, 3 * w, 0, 0);
-
-      if constexpr(std::is_same_v<T, int32_t>)
-      {
-        hwy_packed_to_planar_8(outbuf, r, g, b, w, h, comps[0].stride);
-      }
-      else
-      {
-        size_t src_index = 0;
-        size_t dest_index = 0;
-        for(uint32_t j = 0; j < h; ++j)
-        {
-          for(uint32_t i = 0; i < w; ++i)
+          else if constexpr(std::is_same_v<T, int32_t>)
           {
-            r[dest_index] = (T)outbuf[src_index++];
-            g[dest_index] = (T)outbuf[src_index++];
-            b[dest_index] = (T)outbuf[src_index++];
-            dest_index++;
+            hwy_planar_to_packed_16(r + row, g + row, b + row, inbuf.get(), w, 1, stride);
           }
-          dest_index += stride_diff;
-        }
-      }
-      delete[] inbuf;
-      delete[] outbuf;
-    }
-    else
-    {
-      if(componentSize > (SIZE_MAX / 3) / sizeof(uint16_t)) // overflow check
-      {
-        grklog.error("nr_samples overflow in applyICC");
-        goto cleanup;
-      }
-      if(w > UINT32_MAX / (3 * sizeof(uint16_t)))
-      {
-        grklog.error("Image width of {} converted to sample size 3 @ 16 bits will overflow.", w);
-        goto cleanup;
-      }
-      nr_samples = componentSize * 3U * sizeof(uint16_t);
-      auto inbuf = new uint16_t[nr_samples / sizeof(uint16_t)];
-      auto outbuf = new uint16_t[nr_samples / sizeof(uint16_t)];
-
-      auto r = (T*)comps[0].data;
-      auto g = (T*)comps[1].data;
-      auto b = (T*)comps[2].data;
-
-      if constexpr(std::is_same_v<T, int32_t>)
-      {
-        hwy_planar_to_packed_16(r, g, b, inbuf, w, h, comps[0].stride);
-      }
-      else
-      {
-        size_t src_index = 0;
-        size_t dest_index = 0;
-        for(uint32_t j = 0; j < h; ++j)
-        {
-          for(uint32_t i = 0; i < w; ++i)
+          else
           {
-            inbuf[dest_index++] = (uint16_t)r[src_index];
-            inbuf[dest_index++] = (uint16_t)g[src_index];
-            inbuf[dest_index++] = (uint16_t)b[src_index];
-            src_index++;
+            for(uint32_t i = 0; i < w; ++i)
+            {
+              inbuf[3 * i] = (S)r[row + i];
+              inbuf[3 * i + 1] = (S)g[row + i];
+              inbuf[3 * i + 2] = (S)b[row + i];
+            }
           }
-          src_index += stride_diff;
-        }
-      }
-
-      cmsDoTransformLineStride(transform, inbuf, outbuf, w, h, 3 * w * sizeof(uint16_t),
-                               3 * w * sizeof(uint16_t), 0, 0);
-      if constexpr(std::is_same_v<T, int32_t>)
-      {
-        hwy_packed_to_planar_16(outbuf, r, g, b, w, h, comps[0].stride);
-      }
-      else
-      {
-        size_t src_index = 0;
-        size_t dest_index = 0;
-        for(uint32_t j = 0; j < h; ++j)
-        {
-          for(uint32_t i = 0; i < w; ++i)
+          cmsDoTransform(transform, inbuf.get(), outbuf.get(), w);
+          if constexpr(std::is_same_v<T, int32_t> && sizeof(S) == 1)
+          {
+            hwy_packed_to_planar_8(outbuf.get(), r + row, g + row, b + row, w, 1, stride);
+          }
+          else if constexpr(std::is_same_v<T, int32_t>)
           {
-            r[dest_index] = (T)outbuf[src_index++];
-            g[dest_index] = (T)outbuf[src_index++];
-            b[dest_index] = (T)outbuf[src_index++];
-            dest_index++;
+            hwy_packed_to_planar_16(outbuf.get(), r + row, g + row, b + row, w, 1, stride);
+          }
+          else
+          {
+            for(uint32_t i = 0; i < w; ++i)
+            {
+              r[row + i] = (T)outbuf[3 * i];
+              g[row + i] = (T)outbuf[3 * i + 1];
+              b[row + i] = (T)outbuf[3 * i + 2];
+            }
           }
-          dest_index += stride_diff;
         }
-      }
-      delete[] inbuf;
-      delete[] outbuf;
-    }
+      });
+    };
+    if(prec <= 8)
+      transformRGB(uint8_t{});
+    else
+      transformRGB(uint16_t{});
   }
   else
   { /* GRAY, GRAYA */
@@ -1908,12 +1764,12 @@ bool GrkImage::applyICC(void)
       grklog.error("nr_samples overflow in applyICC");
       goto cleanup;
     }
-    auto newComps = new grk_image_comp[numcomps + 2U];
-    if(!newComps)
+    if(w > UINT32_MAX / (3 * sizeof(uint16_t)))
     {
-      grklog.error("Memory allocation failure in applyICC");
+      grklog.error("Image width of {} converted to sample size 3 will overflow.", w);
       goto cleanup;
     }
+    auto newComps = new grk_image_comp[numcomps + 2U];
     for(uint16_t i = 0; i < numcomps + 2U; ++i)
     {
       if(i < numcomps)
@@ -1923,133 +1779,52 @@ bool GrkImage::applyICC(void)
     }
     delete[] comps;
     comps = newComps;
-    if(prec <= 8)
-    {
-      if(w > UINT32_MAX / 3)
-      {
-        grklog.error("Image width of {} converted to sample size 3 will overflow.", w);
-        goto cleanup;
-      }
-      auto inbuf = new uint8_t[componentSize];
-      auto outbuf = new uint8_t[nr_samples];
 
-      auto r = (T*)comps[0].data;
-      size_t src_index = 0;
-      size_t dest_index = 0;
-      for(uint32_t j = 0; j < h; ++j)
-      {
-        for(uint32_t i = 0; i < w; ++i)
-          inbuf[dest_index++] = (uint8_t)r[src_index++];
-        src_index += stride_diff;
-      }
-      cmsDoTransformLineStride(transform, inbuf, outbuf, w, h, w, 3 * w, 0, 0);
-      T *g = nullptr, *b = nullptr;
-      if(force_rgb)
-      {
-        if(numcomps == 2)
-          comps[3] = comps[1];
-        comps[1] = comps[0];
-        setDataToNull(comps + 1);
-        allocData(comps + 1);
-        comps[2] = comps[0];
-        setDataToNull(comps + 2);
-        allocData(comps + 2);
-        numcomps = (uint16_t)(2 + numcomps);
-        g = (T*)comps[1].data;
-        b = (T*)comps[2].data;
-      }
-      src_index = 0;
-      dest_index = 0;
-      for(uint32_t j = 0; j < h; ++j)
-      {
-        for(uint32_t i = 0; i < w; ++i)
-        {
-          r[dest_index] = (T)outbuf[src_index++];
-          if(force_rgb)
-          {
-            g[dest_index] = (T)outbuf[src_index++];
-            b[dest_index] = (T)outbuf[src_index++];
-          }
-          else
-          {
-            src_index += 2;
-          }
-          dest_index++;
-        }
-        dest_index += stride_diff;
-      }
-      delete[] inbuf;
-      delete[] outbuf;
-    }
-    else
+    T *g = nullptr, *b = nullptr;
+    if(force_rgb)
     {
-      if(componentSize > SIZE_MAX / sizeof(uint16_t))
-      {
-        grklog.error("componentSize overflow in applyICC");
-        goto cleanup;
-      }
-      if(componentSize * 3U > SIZE_MAX / sizeof(uint16_t))
-      {
-        grklog.error("nr_samples overflow in applyICC");
-        goto cleanup;
-      }
-      if(w > UINT32_MAX / (3 * sizeof(uint16_t)))
-      {
-        grklog.error("Image width of {} converted to sample size 3 @ 16 bits will overflow.", w);
-        goto cleanup;
-      }
-      auto inbuf = new uint16_t[componentSize];
-      auto outbuf = new uint16_t[componentSize * 3U];
-
-      auto r = (T*)comps[0].data;
-      size_t src_index = 0;
-      size_t dest_index = 0;
-      for(uint32_t j = 0; j < h; ++j)
-      {
-        for(uint32_t i = 0; i < w; ++i)
-          inbuf[dest_index++] = (uint16_t)r[src_index++];
-        src_index += stride_diff;
-      }
-      cmsDoTransformLineStride(transform, inbuf, outbuf, w, h, w * sizeof(uint16_t),
-                               3 * w * sizeof(uint16_t), 0, 0);
-      T *g = nullptr, *b = nullptr;
-      if(force_rgb)
-      {
-        if(numcomps == 2)
-          comps[3] = comps[1];
-        comps[1] = comps[0];
-        setDataToNull(comps + 1);
-        allocData(comps + 1);
-        comps[2] = comps[0];
-        setDataToNull(comps + 2);
-        allocData(comps + 2);
-        numcomps = (uint16_t)(2 + numcomps);
-        g = (T*)comps[1].data;
-        b = (T*)comps[2].data;
-      }
-      src_index = 0;
-      dest_index = 0;
-      for(uint32_t j = 0; j < h; ++j)
-      {
-        for(uint32_t i = 0; i < w; ++i)
+      if(numcomps == 2)
+        comps[3] = comps[1];
+      comps[1] = comps[0];
+      setDataToNull(comps + 1);
+      allocData(comps + 1);
+      comps[2] = comps[0];
+      setDataToNull(comps + 2);
+      allocData(comps + 2);
+      numcomps = (uint16_t)(2 + numcomps);
+      g = (T*)comps[1].data;
+      b = (T*)comps[2].data;
+    }
+    auto r = (T*)comps[0].data;
+    uint32_t stride = comps[0].stride;
+
+    auto transformGray = [&](auto sample) {
+      using S = decltype(sample);
+      forEachRowBand(h, (uint64_t)w * (g ? 3 : 1), [=](uint32_t yBegin, uint32_t yEnd) {
+        auto inbuf = std::make_unique<S[]>(w);
+        auto outbuf = std::make_unique<S[]>((size_t)w * 3);
+        for(uint32_t j = yBegin; j < yEnd; ++j)
         {
-          r[dest_index] = (T)outbuf[src_index++];
-          if(force_rgb)
-          {
-            g[dest_index] = (T)outbuf[src_index++];
-            b[dest_index] = (T)outbuf[src_index++];
-          }
-          else
+          size_t row = (size_t)j * stride;
+          for(uint32_t i = 0; i < w; ++i)
+            inbuf[i] = (S)r[row + i];
+          cmsDoTransform(transform, inbuf.get(), outbuf.get(), w);
+          for(uint32_t i = 0; i < w; ++i)
           {
-            src_index += 2;
+            r[row + i] = (T)outbuf[3 * i];
+            if(g)
+            {
+              g[row + i] = (T)outbuf[3 * i + 1];
+              b[row + i] = (T)outbuf[3 * i + 2];
+            }
           }
-          dest_index++;
         }
-        dest_index += stride_diff;
-      }
-      delete[] inbuf;
-      delete[] outbuf;
-    }
+      });
+    };
+    if(prec <= 8)
+      transformGray(uint8_t{});
+    else
+      transformGray(uint16_t{});
   } /* if(image->numcomps */
   rc = true;
   delete[] meta->color.icc_profile_buf;
@@ -21,6 +21,8 @@
 #define HWY_TARGET_INCLUDE "util/GrkImageSIMD.cpp"
 #include <hwy/foreach_target.h>
 #include <hwy/highway.h>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include "util/SyccToRGB.h"
 
@@ -617,6 +619,127 @@ namespace HWY_NAMESPACE
     }
   }
 
+  /* ─── Deinterleave packed uint8 → separate int32 component planes ─── */
+  static void Hwy_deinterleave_8u_to_i32(const uint8_t* HWY_RESTRICT src, int32_t* const* dest,
+                                         uint32_t w, uint16_t numComps)
+  {
+    if(numComps == 1)
+    {
+      Hwy_unpack_8u_to_i32(src, dest[0], w, false);
+      return;
+    }
+
+    const HWY_FULL(int32_t) di;
+    const hn::Rebind<uint8_t, decltype(di)> du8_part;
+    const uint32_t L = (uint32_t)Lanes(di);
+
+    uint32_t i = 0;
+    if(numComps == 3)
+    {
+      for(; i + L <= w; i += L)
+      {
+        hn::VFromD<decltype(du8_part)> v0, v1, v2;
+        LoadInterleaved3(du8_part, src + (size_t)i * 3, v0, v1, v2);
+        StoreU(PromoteTo(di, v0), di, dest[0] + i);
+        StoreU(PromoteTo(di, v1), di, dest[1] + i);
+        StoreU(PromoteTo(di, v2), di, dest[2] + i);
+      }
+    }
+    else if(numComps == 4)
+    {
+      for(; i + L <= w; i += L)
+      {
+        hn::VFromD<decltype(du8_part)> v0, v1, v2, v3;
+        LoadInterleaved4(du8_part, src + (size_t)i * 4, v0, v1, v2, v3);
+        StoreU(PromoteTo(di, v0), di, dest[0] + i);
+        StoreU(PromoteTo(di, v1), di, dest[1] + i);
+        StoreU(PromoteTo(di, v2), di, dest[2] + i);
+        StoreU(PromoteTo(di, v3), di, dest[3] + i);
+      }
+    }
+    /* scalar tail, and generic fallback for other component counts */
+    size_t src_index = (size_t)i * numComps;
+    for(; i < w; ++i)
+      for(uint16_t j = 0; j < numComps; ++j)
+        dest[j][i] = src[src_index++];
+  }
+
+  /* Load Lanes(d) 16-bit samples from a possibly odd byte address, in host order */
+  template<class D16>
+  static HWY_INLINE hn::VFromD<D16> Load16(D16 d16, const uint8_t* HWY_RESTRICT p, bool bigEndian)
+  {
+    const hn::Repartition<uint8_t, D16> du8;
+    auto v = BitCast(d16, LoadU(du8, p));
+    if(bigEndian)
+      v = Or(ShiftLeft<8>(v), ShiftRight<8>(v));
+    return v;
+  }
+
+  /* ─── Deinterleave packed 16-bit samples (either byte order) → int32 planes ─── */
+  static void Hwy_deinterleave_16u_to_i32(const uint8_t* HWY_RESTRICT src, int32_t* const* dest,
+                                          uint32_t w, uint16_t numComps, bool bigEndian)
+  {
+    const HWY_FULL(int32_t) di;
+    const hn::Rebind<uint16_t, decltype(di)> du16_part;
+    const uint32_t L = (uint32_t)Lanes(di);
+
+    uint32_t i = 0;
+    if(numComps <= 4)
+    {
+      for(; i + L <= w; i += L)
+      {
+        const uint8_t* p = src + (size_t)i * numComps * 2;
+        if(numComps == 1)
+        {
+          StoreU(PromoteTo(di, Load16(du16_part, p, bigEndian)), di, dest[0] + i);
+          continue;
+        }
+        /* gather the L pixels of this block, then split them component by component */
+        HWY_ALIGN uint16_t tmp[4 * HWY_MAX_LANES_D(HWY_FULL(int32_t))];
+        for(uint16_t k = 0; k < numComps; ++k)
+          StoreU(Load16(du16_part, p + (size_t)k * L * 2, bigEndian), du16_part,
+                 tmp + (size_t)k * L);
+        if(numComps == 3)
+        {
+          hn::VFromD<decltype(du16_part)> v0, v1, v2;
+          LoadInterleaved3(du16_part, tmp, v0, v1, v2);
+          StoreU(PromoteTo(di, v0), di, dest[0] + i);
+          StoreU(PromoteTo(di, v1), di, dest[1] + i);
+          StoreU(PromoteTo(di, v2), di, dest[2] + i);
+        }
+        else if(numComps == 4)
+        {
+          hn::VFromD<decltype(du16_part)> v0, v1, v2, v3;
+          LoadInterleaved4(du16_part, tmp, v0, v1, v2, v3);
+          StoreU(PromoteTo(di, v0), di, dest[0] + i);
+          StoreU(PromoteTo(di, v1), di, dest[1] + i);
+          StoreU(PromoteTo(di, v2), di, dest[2] + i);
+          StoreU(PromoteTo(di, v3), di, dest[3] + i);
+        }
+        else
+        {
+          for(uint32_t k = 0; k < L; ++k)
+          {
+            dest[0][i + k] = tmp[k * 2];
+            dest[1][i + k] = tmp[k * 2 + 1];
+          }
+        }
+      }
+    }
+    /* scalar tail, and generic fallback for other component counts */
+    size_t src_index = (size_t)i * numComps * 2;
+    for(; i < w; ++i)
+    {
+      for(uint16_t j = 0; j < numComps; ++j)
+      {
+        int32_t b0 = src[src_index];
+        int32_t b1 = src[src_index + 1];
+        dest[j][i] = bigEndian ? ((b0 << 8) | b1) : ((b1 << 8) | b0);
+        src_index += 2;
+      }
+    }
+  }
+
   /* ─── Pack N planar int32 → interleaved uint8, one row ─── */
   static void Hwy_pack_planar_to_8(const int32_t* const* src, uint32_t numPlanes, uint8_t* dest,
                                    uint32_t w, int32_t adjust)
@@ -847,6 +970,109 @@ namespace HWY_NAMESPACE
     }
   }
 
+  /* ─── resample: weighted sum of int32_t rows → float row ─── */
+  static void Hwy_resample_rows_i32(const int32_t* const* rows, const float* weights,
+                                    uint32_t taps, float* HWY_RESTRICT out, uint32_t w)
+  {
+    const HWY_FULL(float) df;
+    const hn::RebindToSigned<decltype(df)> di;
+    const uint32_t L = (uint32_t)Lanes(df);
+
+    uint32_t i = 0;
+    for(; i + L <= w; i += L)
+    {
+      auto acc = Zero(df);
+      for(uint32_t k = 0; k < taps; ++k)
+        acc = MulAdd(Set(df, weights[k]), ConvertTo(df, LoadU(di, rows[k] + i)), acc);
+      StoreU(acc, df, out + i);
+    }
+    for(; i < w; ++i)
+    {
+      float acc = 0;
+      for(uint32_t k = 0; k < taps; ++k)
+        acc += weights[k] * (float)rows[k][i];
+      out[i] = acc;
+    }
+  }
+
+  /* ─── resample: weighted sum of int16_t rows → float row ─── */
+  static void Hwy_resample_rows_i16(const int16_t* const* rows, const float* weights,
+                                    uint32_t taps, float* HWY_RESTRICT out, uint32_t w)
+  {
+    const HWY_FULL(float) df;
+    const hn::RebindToSigned<decltype(df)> di;
+    const hn::Rebind<int16_t, decltype(df)> di16;
+    const uint32_t L = (uint32_t)Lanes(df);
+
+    uint32_t i = 0;
+    for(; i + L <= w; i += L)
+    {
+      auto acc = Zero(df);
+      for(uint32_t k = 0; k < taps; ++k)
+      {
+        auto v = ConvertTo(df, PromoteTo(di, LoadU(di16, rows[k] + i)));
+        acc = MulAdd(Set(df, weights[k]), v, acc);
+      }
+      StoreU(acc, df, out + i);
+    }
+    for(; i < w; ++i)
+    {
+      float acc = 0;
+      for(uint32_t k = 0; k < taps; ++k)
+        acc += weights[k] * (float)rows[k][i];
+      out[i] = acc;
+    }
+  }
+
+  /* ─── resample: weighted sums of a float row → scaled float samples ─── */
+  static void Hwy_resample_columns(const float* HWY_RESTRICT row, uint32_t origin,
+                                   const uint32_t* first, const float* weights,
+                                   uint32_t weightStride, uint32_t taps, float* HWY_RESTRICT out,
+                                   uint32_t n)
+  {
+    const HWY_FULL(float) df;
+    const hn::RebindToSigned<decltype(df)> di;
+    const uint32_t L = (uint32_t)Lanes(df);
+    const auto vOrigin = Set(di, (int32_t)origin);
+
+    uint32_t o = 0;
+    for(; o + L <= n; o += L)
+    {
+      auto index = Sub(LoadU(di, (const int32_t*)first + o), vOrigin);
+      auto acc = Zero(df);
+      for(uint32_t k = 0; k < taps; ++k)
+      {
+        auto v = hn::GatherIndex(df, row, Add(index, Set(di, (int32_t)k)));
+        acc = MulAdd(LoadU(df, weights + (size_t)k * weightStride + o), v, acc);
+      }
+      StoreU(acc, df, out + o);
+    }
+    for(; o < n; ++o)
+    {
+      float acc = 0;
+      for(uint32_t k = 0; k < taps; ++k)
+        acc += weights[(size_t)k * weightStride + o] * row[first[o] - origin + k];
+      out[o] = acc;
+    }
+  }
+
+  /* ─── round float samples to nearest, and clip ─── */
+  static void Hwy_round_clip_f32(const float* HWY_RESTRICT src, int32_t* HWY_RESTRICT dest,
+                                 uint32_t w, int32_t minVal, int32_t maxVal)
+  {
+    const HWY_FULL(float) df;
+    const hn::RebindToSigned<decltype(df)> di;
+    const uint32_t L = (uint32_t)Lanes(df);
+    const auto vMin = Set(di, minVal);
+    const auto vMax = Set(di, maxVal);
+
+    uint32_t i = 0;
+    for(; i + L <= w; i += L)
+      StoreU(Clamp(NearestInt(LoadU(df, src + i)), vMin, vMax), di, dest + i);
+    for(; i < w; ++i)
+      dest[i] = std::clamp((int32_t)std::lrintf(src[i]), minVal, maxVal);
+  }
+
 } // namespace HWY_NAMESPACE
 } // namespace grk
 HWY_AFTER_NAMESPACE();
@@ -878,11 +1104,17 @@ HWY_EXPORT(Hwy_unpack_8u_to_i32);
 HWY_EXPORT(Hwy_unpack_16be_to_i32);
 HWY_EXPORT(Hwy_unpack_16le_to_i32);
 HWY_EXPORT(Hwy_deinterleave_i32);
+HWY_EXPORT(Hwy_deinterleave_8u_to_i32);
+HWY_EXPORT(Hwy_deinterleave_16u_to_i32);
 HWY_EXPORT(Hwy_pack_planar_to_8);
 HWY_EXPORT(Hwy_pack_planar_to_16);
 HWY_EXPORT(Hwy_pack_planar_to_16be);
 HWY_EXPORT(Hwy_scale_component_up);
 HWY_EXPORT(Hwy_scale_component_down);
+HWY_EXPORT(Hwy_resample_rows_i32);
+HWY_EXPORT(Hwy_resample_rows_i16);
+HWY_EXPORT(Hwy_resample_columns);
+HWY_EXPORT(Hwy_round_clip_f32);
 
 void hwy_clip_i32(int32_t* data, uint32_t w, uint32_t h, uint32_t stride, int32_t minVal,
                   int32_t maxVal)
@@ -961,6 +1193,18 @@ GRK_SIMD_API void hwy_deinterleave_i32(const int32_t* src, int32_t* const* dest,
   HWY_DYNAMIC_DISPATCH(Hwy_deinterleave_i32)(src, dest, w, numComps);
 }
 
+GRK_SIMD_API void hwy_deinterleave_8u_to_i32(const uint8_t* src, int32_t* const* dest, uint32_t w,
+                                             uint16_t numComps)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_deinterleave_8u_to_i32)(src, dest, w, numComps);
+}
+
+GRK_SIMD_API void hwy_deinterleave_16u_to_i32(const uint8_t* src, int32_t* const* dest, uint32_t w,
+                                              uint16_t numComps, bool bigEndian)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_deinterleave_16u_to_i32)(src, dest, w, numComps, bigEndian);
+}
+
 GRK_SIMD_API void hwy_pack_planar_to_8(const int32_t* const* src, uint32_t numPlanes, uint8_t* dest,
                                        uint32_t w, int32_t adjust)
 {
@@ -991,6 +1235,32 @@ GRK_SIMD_API void hwy_scale_component_down(int32_t* data, uint32_t w, uint32_t h
   HWY_DYNAMIC_DISPATCH(Hwy_scale_component_down)(data, w, h, stride, scale);
 }
 
+void hwy_resample_rows_i32(const int32_t* const* rows, const float* weights, uint32_t taps,
+                           float* out, uint32_t w)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_resample_rows_i32)(rows, weights, taps, out, w);
+}
+
+void hwy_resample_rows_i16(const int16_t* const* rows, const float* weights, uint32_t taps,
+                           float* out, uint32_t w)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_resample_rows_i16)(rows, weights, taps, out, w);
+}
+
+void hwy_resample_columns(const float* row, uint32_t origin, const uint32_t* first,
+                          const float* weights, uint32_t weightStride, uint32_t taps, float* out,
+                          uint32_t n)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_resample_columns)(row, origin, first, weights, weightStride, taps,
+                                             out, n);
+}
+
+void hwy_round_clip_f32(const float* src, int32_t* dest, uint32_t w, int32_t minVal,
+                        int32_t maxVal)
+{
+  HWY_DYNAMIC_DISPATCH(Hwy_round_clip_f32)(src, dest, w, minVal, maxVal);
+}
+
 void hwy_copy_tile_to_swath(const grk_image* tile_img, const grk_swath_buffer* buf)
 {
   if(!tile_img || !buf || !buf->data)
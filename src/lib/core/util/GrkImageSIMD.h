@@ -106,6 +106,16 @@ GRK_SIMD_API void hwy_unpack_16le_to_i32(const uint16_t* src, int32_t* dest, siz
 GRK_SIMD_API void hwy_deinterleave_i32(const int32_t* src, int32_t* const* dest, uint32_t w,
                                        uint16_t numComps);
 
+/* Deinterleave packed uint8 samples [R0,G0,B0,R1,...] straight into int32 component
+ * planes. Optimised for numComps == 1, 3 and 4; falls back to scalar for others. */
+GRK_SIMD_API void hwy_deinterleave_8u_to_i32(const uint8_t* src, int32_t* const* dest, uint32_t w,
+                                             uint16_t numComps);
+
+/* Deinterleave packed 16-bit samples of either byte order into int32 component planes.
+ * src need not be 2-byte aligned. Optimised for numComps <= 4. */
+GRK_SIMD_API void hwy_deinterleave_16u_to_i32(const uint8_t* src, int32_t* const* dest, uint32_t w,
+                                              uint16_t numComps, bool bigEndian);
+
 /* Pack N planar int32 components into interleaved uint8 output, one row at a time.
  * Each src[k] points to the start of the k-th component for this row.
  * adjust is added to each sample before narrowing to uint8. */
@@ -130,4 +140,25 @@ GRK_SIMD_API void hwy_scale_component_up(int32_t* data, uint32_t w, uint32_t h,
 GRK_SIMD_API void hwy_scale_component_down(int32_t* data, uint32_t w, uint32_t h, uint32_t stride,
                                            int32_t scale);
 
+/* Weighted sum of taps int32 rows into a float row: out[i] = sum_k weights[k] * rows[k][i].
+ * The vertical pass of the separable resampling filter. */
+void hwy_resample_rows_i32(const int32_t* const* rows, const float* weights, uint32_t taps,
+                           float* out, uint32_t w);
+
+/* Weighted sum of taps int16 rows into a float row, as hwy_resample_rows_i32. */
+void hwy_resample_rows_i16(const int16_t* const* rows, const float* weights, uint32_t taps,
+                           float* out, uint32_t w);
+
+/* Weighted sums of a float row into n scaled samples, the horizontal pass of the
+ * separable resampling filter: out[o] = sum_k weights[k * weightStride + o] *
+ * row[first[o] - origin + k]. Each footprint is padded to taps with zero weights, and
+ * row must hold taps - 1 readable samples past the last footprint. */
+void hwy_resample_columns(const float* row, uint32_t origin, const uint32_t* first,
+                          const float* weights, uint32_t weightStride, uint32_t taps, float* out,
+                          uint32_t n);
+
+/* Round float samples to nearest, ties to even as lrintf, and clip to [minVal, maxVal]. */
+void hwy_round_clip_f32(const float* src, int32_t* dest, uint32_t w, int32_t minVal,
+                        int32_t maxVal);
+
 } // namespace grk
@@ -0,0 +1,332 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "CodeStreamLimits.h"
+#include "Logger.h"
+#include "MemManager.h"
+#include "intmath.h"
+#include "geometry.h"
+#include "GrkObjectWrapper.h"
+#include "GrkImageMeta.h"
+#include "GrkImage.h"
+#include "ImageResampler.h"
+
+namespace grk
+{
+
+namespace
+{
+  /** fixed point scale of seam sums */
+  constexpr double seamScale = 65536.0;
+  constexpr uint32_t seamShift = 16;
+} // namespace
+
+void ImageResampler::Axis::init(uint32_t src, uint32_t dst, const std::vector<uint32_t>& boundaries)
+{
+  srcSize = src;
+  dstSize = dst;
+  first.resize(dst);
+  last.resize(dst);
+  offset.resize(dst);
+  weights.clear();
+  weights.reserve((size_t)src + dst);
+  // in units of 1/dst of a source sample, source sample i spans [i * dst, (i + 1) * dst)
+  // and scaled sample o spans [o * src, (o + 1) * src)
+  for(uint32_t o = 0; o < dst; ++o)
+  {
+    uint64_t lo = (uint64_t)o * src;
+    uint64_t hi = lo + src;
+    first[o] = (uint32_t)(lo / dst);
+    last[o] = (uint32_t)((hi + dst - 1) / dst);
+    offset[o] = (uint32_t)weights.size();
+    for(uint32_t i = first[o]; i < last[o]; ++i)
+    {
+      uint64_t a = std::max<uint64_t>(lo, (uint64_t)i * dst);
+      uint64_t b = std::min<uint64_t>(hi, (uint64_t)(i + 1) * dst);
+      weights.push_back((float)((double)(b - a) / src));
+    }
+  }
+  maxTaps = 0;
+  for(uint32_t o = 0; o < dst; ++o)
+    maxTaps = std::max(maxTaps, last[o] - first[o]);
+  tapWeights.assign((size_t)maxTaps * dst, 0);
+  for(uint32_t o = 0; o < dst; ++o)
+  {
+    for(uint32_t k = 0; k < last[o] - first[o]; ++k)
+      tapWeights[(size_t)k * dst + o] = weights[offset[o] + k];
+  }
+  seam.assign(dst, -1);
+  numSeams = 0;
+  for(auto b : boundaries)
+  {
+    if(b == 0 || b >= src)
+      continue;
+    // the footprint of the scaled sample holding b straddles it unless it starts there
+    uint64_t unit = (uint64_t)b * dst;
+    auto o = (uint32_t)(unit / src);
+    if(unit % src && o < dst && seam[o] < 0)
+      seam[o] = (int32_t)numSeams++;
+  }
+}
+
+uint32_t ImageResampler::Axis::begin(uint32_t s0) const
+{
+  return (uint32_t)((uint64_t)s0 * dstSize / srcSize);
+}
+
+uint32_t ImageResampler::Axis::end(uint32_t s1) const
+{
+  return (uint32_t)std::min<uint64_t>(((uint64_t)s1 * dstSize + srcSize - 1) / srcSize, dstSize);
+}
+
+ImageResampler::~ImageResampler()
+{
+  release();
+}
+
+void ImageResampler::release(void)
+{
+  if(image_)
+    grk_unref(image_);
+  image_ = nullptr;
+  comps_.clear();
+}
+
+GrkImage* ImageResampler::getImage(void)
+{
+  return image_;
+}
+
+bool ImageResampler::init(const GrkImage* header, const GrkImage* source, uint32_t width,
+                          uint32_t height, uint32_t tx0, uint32_t ty0, uint32_t tileWidth,
+                          uint32_t tileHeight, uint8_t reduce)
+{
+  release();
+  if(!width || !height || !tileWidth || !tileHeight || source->numcomps != header->numcomps)
+    return false;
+  image_ = new GrkImage();
+  header->copyHeaderTo(image_);
+  image_->x0 = 0;
+  image_->y0 = 0;
+  image_->x1 = width;
+  image_->y1 = height;
+  comps_.resize(image_->numcomps);
+
+  // tile boundaries along one axis, relative to the first source sample
+  auto boundaries = [reduce](uint32_t t0, uint32_t tileSize, uint32_t sub, uint32_t s0,
+                             uint32_t s1) {
+    std::vector<uint32_t> rc;
+    for(uint64_t canvas = (uint64_t)t0 + tileSize; canvas < UINT32_MAX; canvas += tileSize)
+    {
+      uint32_t b = ceildivpow2<uint32_t>(ceildiv<uint32_t>((uint32_t)canvas, sub), reduce);
+      if(b >= s1)
+        break;
+      if(b > s0)
+        rc.push_back(b - s0);
+    }
+    return rc;
+  };
+  for(uint16_t compno = 0; compno < image_->numcomps; ++compno)
+  {
+    auto src = source->comps + compno;
+    auto comp = image_->comps + compno;
+    auto& c = comps_[compno];
+    comp->data = nullptr;
+    comp->x0 = 0;
+    comp->y0 = 0;
+    comp->w = ceildiv<uint32_t>(width, comp->dx);
+    comp->h = ceildiv<uint32_t>(height, comp->dy);
+    comp->data_type = GRK_INT_32;
+    if(!src->w || !src->h || !GrkImage::allocData(comp, true))
+    {
+      release();
+      return false;
+    }
+    c.x0 = src->x0;
+    c.y0 = src->y0;
+    c.x.init(src->w, comp->w, boundaries(tx0, tileWidth, comp->dx, src->x0, src->x0 + src->w));
+    c.y.init(src->h, comp->h, boundaries(ty0, tileHeight, comp->dy, src->y0, src->y0 + src->h));
+    c.minVal = comp->sgnd ? -(1 << (comp->prec - 1)) : 0;
+    c.maxVal = comp->sgnd ? (1 << (comp->prec - 1)) - 1 : (int32_t)((1U << comp->prec) - 1);
+    c.seamRows.assign((size_t)c.y.numSeams * comp->w, 0);
+    c.seamColumns.assign((size_t)c.x.numSeams * comp->h, 0);
+  }
+
+  return true;
+}
+
+void ImageResampler::resample(const grk_image* tile)
+{
+  if(!image_ || !tile)
+    return;
+  for(uint16_t compno = 0; compno < image_->numcomps && compno < tile->numcomps; ++compno)
+    resample(compno, tile->comps + compno);
+}
+
+void ImageResampler::resample(uint16_t compno, const grk_image_comp* src)
+{
+  auto& c = comps_[compno];
+  auto dest = image_->comps + compno;
+  if(!src->data || !src->w || !src->h)
+    return;
+
+  // tile samples inside the resampled region, relative to its first sample
+  uint32_t x0 = std::max(src->x0, c.x0);
+  uint32_t y0 = std::max(src->y0, c.y0);
+  uint32_t x1 = std::min<uint64_t>((uint64_t)src->x0 + src->w, (uint64_t)c.x0 + c.x.srcSize);
+  uint32_t y1 = std::min<uint64_t>((uint64_t)src->y0 + src->h, (uint64_t)c.y0 + c.y.srcSize);
+  if(x0 >= x1 || y0 >= y1)
+    return;
+  int64_t srcOffset = (int64_t)(x0 - src->x0) + ((int64_t)c.y0 - src->y0) * src->stride;
+  x0 -= c.x0;
+  x1 -= c.x0;
+  y0 -= c.y0;
+  y1 -= c.y0;
+
+  // scaled samples whose footprint lies inside the tile: their columns are not seams
+  uint32_t ox0 = c.x.begin(x0);
+  uint32_t ox1 = c.x.end(x1);
+  uint32_t inner0 = ox0;
+  while(inner0 < ox1 && c.x.first[inner0] < x0)
+    inner0++;
+  uint32_t inner1 = ox1;
+  while(inner1 > inner0 && c.x.last[inner1 - 1] > x1)
+    inner1--;
+
+  bool src16 = src->data_type == GRK_INT_16;
+  // padded so that the last footprints' zero weighted taps stay inside the row
+  std::vector<float> row(x1 - x0 + c.x.maxTaps, 0);
+  std::vector<float> scaled(inner1 - inner0);
+  std::vector<const int32_t*> rows32;
+  std::vector<const int16_t*> rows16;
+  auto destData = (int32_t*)dest->data;
+  for(uint32_t oy = c.y.begin(y0); oy < c.y.end(y1); ++oy)
+  {
+    // vertical pass: this tile's rows of the scaled row's footprint
+    uint32_t j0 = std::max(c.y.first[oy], y0);
+    uint32_t j1 = std::min(c.y.last[oy], y1);
+    if(j0 >= j1)
+      continue;
+    uint32_t taps = j1 - j0;
+    auto wy = c.y.weights.data() + c.y.offset[oy] + (j0 - c.y.first[oy]);
+    if(src16)
+    {
+      rows16.resize(taps);
+      for(uint32_t k = 0; k < taps; ++k)
+        rows16[k] = (const int16_t*)src->data + srcOffset + (int64_t)(j0 + k) * src->stride;
+      hwy_resample_rows_i16(rows16.data(), wy, taps, row.data(), x1 - x0);
+    }
+    else
+    {
+      rows32.resize(taps);
+      for(uint32_t k = 0; k < taps; ++k)
+        rows32[k] = (const int32_t*)src->data + srcOffset + (int64_t)(j0 + k) * src->stride;
+      hwy_resample_rows_i32(rows32.data(), wy, taps, row.data(), x1 - x0);
+    }
+
+    // horizontal pass: samples cut by the tile's edges sum their clipped footprint
+    auto clipped = [&](uint32_t ox) {
+      uint32_t i0 = std::max(c.x.first[ox], x0);
+      uint32_t i1 = std::min(c.x.last[ox], x1);
+      auto wx = c.x.weights.data() + c.x.offset[ox] + (i0 - c.x.first[ox]);
+      float val = 0;
+      for(uint32_t i = i0; i < i1; ++i)
+        val += wx[i - i0] * row[i - x0];
+      store(c, dest, ox, oy, val);
+    };
+    for(uint32_t ox = ox0; ox < inner0; ++ox)
+      clipped(ox);
+    if(inner0 < inner1)
+    {
+      hwy_resample_columns(row.data(), x0, c.x.first.data() + inner0,
+                           c.x.tapWeights.data() + inner0, c.x.dstSize, c.x.maxTaps,
+                           scaled.data(), inner1 - inner0);
+      if(c.y.seam[oy] < 0)
+      {
+        hwy_round_clip_f32(scaled.data(), destData + (size_t)oy * dest->stride + inner0,
+                           inner1 - inner0, c.minVal, c.maxVal);
+      }
+      else
+      {
+        for(uint32_t ox = inner0; ox < inner1; ++ox)
+          store(c, dest, ox, oy, scaled[ox - inner0]);
+      }
+    }
+    for(uint32_t ox = inner1; ox < ox1; ++ox)
+      clipped(ox);
+  }
+}
+
+void ImageResampler::store(Component& c, grk_image_comp* dest, uint32_t x, uint32_t y, float val)
+{
+  int32_t rowSeam = c.y.seam[y];
+  int32_t columnSeam = c.x.seam[x];
+  if(rowSeam < 0 && columnSeam < 0)
+  {
+    ((int32_t*)dest->data)[(size_t)y * dest->stride + x] =
+        std::clamp((int32_t)std::lrintf(val), c.minVal, c.maxVal);
+    return;
+  }
+  auto sum = rowSeam >= 0 ? &c.seamRows[(size_t)rowSeam * c.x.dstSize + x]
+                          : &c.seamColumns[(size_t)columnSeam * c.y.dstSize + y];
+  std::atomic_ref<int64_t>(*sum).fetch_add(std::llrint(val * seamScale),
+                                           std::memory_order_relaxed);
+}
+
+void ImageResampler::finish(void)
+{
+  if(!image_)
+    return;
+  for(uint16_t compno = 0; compno < image_->numcomps; ++compno)
+  {
+    auto& c = comps_[compno];
+    auto dest = image_->comps + compno;
+    auto data = (int32_t*)dest->data;
+    auto round = [&c](int64_t sum) {
+      return (int32_t)std::clamp<int64_t>((sum + (1 << (seamShift - 1))) >> seamShift, c.minVal,
+                                          c.maxVal);
+    };
+    for(uint32_t y = 0; y < c.y.dstSize; ++y)
+    {
+      int32_t rowSeam = c.y.seam[y];
+      if(rowSeam < 0)
+        continue;
+      auto sums = c.seamRows.data() + (size_t)rowSeam * c.x.dstSize;
+      for(uint32_t x = 0; x < c.x.dstSize; ++x)
+        data[(size_t)y * dest->stride + x] = round(sums[x]);
+    }
+    // samples on both a seam row and a seam column were summed in the row
+    for(uint32_t x = 0; x < c.x.dstSize; ++x)
+    {
+      int32_t columnSeam = c.x.seam[x];
+      if(columnSeam < 0)
+        continue;
+      auto sums = c.seamColumns.data() + (size_t)columnSeam * c.y.dstSize;
+      for(uint32_t y = 0; y < c.y.dstSize; ++y)
+      {
+        if(c.y.seam[y] < 0)
+          data[(size_t)y * dest->stride + x] = round(sums[y]);
+      }
+    }
+  }
+}
+
+} // namespace grk
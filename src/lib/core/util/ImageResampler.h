@@ -0,0 +1,166 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "grok.h"
+
+namespace grk
+{
+
+class GrkImage;
+
+/**
+ * @class ImageResampler
+ * @brief Resamples decompressed tiles straight into an image of arbitrary size
+ *
+ * The filter is separable area averaging: each scaled sample is the mean of the source
+ * samples its footprint covers, weighted by the fraction of each it covers. It is linear,
+ * so a tile can add its share of every scaled sample it touches without its neighbours:
+ * a scaled sample whose footprint lies inside one tile is written by that tile alone, and
+ * only samples on the seams between tiles are summed, in fixed point so that the order
+ * tiles finish in cannot change the result, and written once all tiles are done.
+ *
+ * Each tile runs the vertical pass first, over whole source rows with SIMD, so that the
+ * horizontal pass only sees one row per scaled row. The horizontal pass gathers each
+ * scaled sample's footprint from that row with SIMD too, over weights padded to the
+ * widest footprint, except for the few samples whose footprint the tile's edges cut.
+ */
+class ImageResampler
+{
+public:
+  ImageResampler(void) = default;
+  ~ImageResampler();
+
+  /**
+   * @brief Allocates the scaled image and computes the filter weights
+   *
+   * @param header header image, for the component properties of the scaled image
+   * @param source image whose components give the region to resample, in reduced
+   * component coordinates
+   * @param width scaled width of components that are not sub-sampled
+   * @param height scaled height of components that are not sub-sampled
+   * @param tx0 tile grid origin x, in canvas coordinates
+   * @param ty0 tile grid origin y, in canvas coordinates
+   * @param tileWidth nominal tile width
+   * @param tileHeight nominal tile height
+   * @param reduce number of discarded resolutions
+   * @return true if successful
+   */
+  bool init(const GrkImage* header, const GrkImage* source, uint32_t width, uint32_t height,
+            uint32_t tx0, uint32_t ty0, uint32_t tileWidth, uint32_t tileHeight, uint8_t reduce);
+
+  /**
+   * @brief Adds a decompressed tile's share of the scaled image
+   *
+   * May be called for different tiles concurrently.
+   *
+   * @param tile tile image, with the samples after inverse MCT and DC level shift
+   */
+  void resample(const grk_image* tile);
+
+  /**
+   * @brief Writes the samples on the seams between tiles, once every tile is resampled
+   */
+  void finish(void);
+
+  /**
+   * @brief Gets the scaled image
+   * @return @ref GrkImage owned by the resampler, or nullptr before @ref init
+   */
+  GrkImage* getImage(void);
+
+private:
+  /**
+   * @struct Axis
+   * @brief Filter footprints and weights of the scaled samples along one axis
+   */
+  struct Axis
+  {
+    /**
+     * @brief Computes footprints, weights and seams
+     *
+     * @param srcSize number of source samples
+     * @param dstSize number of scaled samples
+     * @param boundaries tile boundaries, relative to the first source sample
+     */
+    void init(uint32_t srcSize, uint32_t dstSize, const std::vector<uint32_t>& boundaries);
+    /** first scaled sample whose footprint reaches source sample @p s0 or later */
+    uint32_t begin(uint32_t s0) const;
+    /** one past the last scaled sample whose footprint starts before source sample @p s1 */
+    uint32_t end(uint32_t s1) const;
+
+    uint32_t srcSize = 0;
+    uint32_t dstSize = 0;
+    /** first source sample of each scaled sample's footprint */
+    std::vector<uint32_t> first;
+    /** one past the last source sample of each scaled sample's footprint */
+    std::vector<uint32_t> last;
+    /** offset of each scaled sample's first weight in @ref weights */
+    std::vector<uint32_t> offset;
+    std::vector<float> weights;
+    /** number of source samples in the widest footprint */
+    uint32_t maxTaps = 0;
+    /** weights by tap, then scaled sample, each footprint padded to @ref maxTaps with zeros */
+    std::vector<float> tapWeights;
+    /** seam index of each scaled sample whose footprint crosses a tile boundary, or -1 */
+    std::vector<int32_t> seam;
+    uint32_t numSeams = 0;
+  };
+
+  /**
+   * @struct Component
+   * @brief Resampling state of one component
+   */
+  struct Component
+  {
+    /** first source sample, in reduced component coordinates */
+    uint32_t x0 = 0;
+    uint32_t y0 = 0;
+    Axis x;
+    Axis y;
+    int32_t minVal = 0;
+    int32_t maxVal = 0;
+    /** sums of seam rows, a row of the scaled width per seam */
+    std::vector<int64_t> seamRows;
+    /** sums of seam columns, a column of the scaled height per seam */
+    std::vector<int64_t> seamColumns;
+  };
+
+  /**
+   * @brief Adds one tile component's share of the scaled component
+   */
+  void resample(uint16_t compno, const grk_image_comp* src);
+
+  /**
+   * @brief Stores a scaled sample, or adds it to its seam
+   */
+  void store(Component& c, grk_image_comp* dest, uint32_t x, uint32_t y, float val);
+
+  /**
+   * @brief Drops the scaled image
+   */
+  void release(void);
+
+  GrkImage* image_ = nullptr;
+  std::vector<Component> comps_;
+};
+
+} // namespace grk
@@ -71,4 +71,46 @@ void sycc_to_rgb(T offset, T upb, T y, T cb, T cr, T* out_r, T* out_g, T* out_b)
   *out_b = (T)std::min(std::max(blue, 0), upper);
 }
 
+/**
+ * Converts one row of luma samples, with chroma subsampled 2:1 horizontally when
+ * @p subsampledX is set. A null @p cb converts with zero chroma. When @p oddFirstX
+ * is set, the first column has no chroma sample of its own: it takes zero chroma,
+ * or the first chroma sample if @p chromaInFirstColumn is set.
+ */
+template<typename T>
+void sycc_row_to_rgb(T offset, T upb, const T* y, const T* cb, const T* cr, T* r, T* g, T* b,
+                     uint32_t w, bool subsampledX, bool oddFirstX, bool chromaInFirstColumn)
+{
+  if(!cb)
+  {
+    for(uint32_t i = 0; i < w; ++i)
+      sycc_to_rgb<T>(offset, upb, y[i], 0, 0, r + i, g + i, b + i);
+    return;
+  }
+  if(!subsampledX)
+  {
+    for(uint32_t i = 0; i < w; ++i)
+      sycc_to_rgb<T>(offset, upb, y[i], cb[i], cr[i], r + i, g + i, b + i);
+    return;
+  }
+  uint32_t x = 0;
+  if(oddFirstX && w)
+  {
+    if(chromaInFirstColumn)
+      sycc_to_rgb<T>(offset, upb, y[0], cb[0], cr[0], r, g, b);
+    else
+      sycc_to_rgb<T>(offset, upb, y[0], 0, 0, r, g, b);
+    x = 1;
+  }
+  for(uint32_t c = 0; x < w; ++c)
+  {
+    sycc_to_rgb<T>(offset, upb, y[x], cb[c], cr[c], r + x, g + x, b + x);
+    if(++x < w)
+    {
+      sycc_to_rgb<T>(offset, upb, y[x], cb[c], cr[c], r + x, g + x, b + x);
+      ++x;
+    }
+  }
+}
+
 } // namespace grk
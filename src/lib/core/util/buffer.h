@@ -535,6 +535,13 @@ struct Buffer2d : protected Buffer<T, A>, public Rect32
   {
     return this->currPtr();
   }
+  /**
+   * @brief Gets the bytes this buffer allocated and still owns
+   */
+  uint64_t ownedBytes(void) const
+  {
+    return this->owns_data_ && this->buf_ ? (uint64_t)this->num_elts_ * sizeof(T) : 0;
+  }
   T* address(uint32_t x, uint32_t y)
   {
     return this->currPtr() + (uint64_t)x + (uint64_t)y * stride;
@@ -0,0 +1,33 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+/* Exports library internals that unit tests and benchmarks link against */
+#ifdef _WIN32
+#ifdef GRK_STATIC
+#define GRK_INTERNAL
+#else
+#ifdef GRK_EXPORTS
+#define GRK_INTERNAL __declspec(dllexport)
+#else
+#define GRK_INTERNAL __declspec(dllimport)
+#endif
+#endif
+#else
+#define GRK_INTERNAL __attribute__((visibility("default")))
+#endif
@@ -623,10 +623,11 @@ WaveletReverse::WaveletReverse(CodecScheduler* scheduler, TileComponent* tilec,
                                Rect32 unreducedWindow, uint8_t numres, uint8_t qmfbid,
                                uint32_t maxDim, bool wholeTileDecompress, WaveletPoolData* poolData,
                                DcShiftParam dcShift, const TileComponentCodingParams* tccp,
-                               const TransformKernel* kernel)
+                               const TransformKernel* kernel, uint8_t firstLevel)
     : poolData_(poolData), scheduler_(scheduler), tilec_(tilec), compno_(compno),
       unreducedWindow_(unreducedWindow), numres_(numres), qmfbid_(qmfbid), maxDim_(maxDim),
-      wholeTileDecompress_(wholeTileDecompress), dcShift_(dcShift), tccp_(tccp), kernel_(kernel)
+      wholeTileDecompress_(wholeTileDecompress), dcShift_(dcShift), tccp_(tccp), kernel_(kernel),
+      firstLevel_(firstLevel)
 {}
 DecompositionSplit WaveletReverse::splitOf(uint8_t res) const
 {
@@ -749,8 +750,8 @@ void WaveletReverse::kernelColumns(Buffer2dSimple<T> winL, Buffer2dSimple<T> win
 
 template<typename T, typename GetRes, typename GetBand, typename GetSplit>
 static bool kernelLevels(
-    WaveletReverse* self, TileComponent* tilec, uint8_t numres, CodecScheduler* scheduler,
-    uint16_t compno, GetRes getRes, GetBand getBand, GetSplit getSplit,
+    WaveletReverse* self, TileComponent* tilec, uint8_t numres, uint8_t firstLevel,
+    CodecScheduler* scheduler, uint16_t compno, GetRes getRes, GetBand getBand, GetSplit getSplit,
     void (WaveletReverse::*rows)(Buffer2dSimple<T>, Buffer2dSimple<T>, Buffer2dSimple<T>, uint32_t,
                                  uint32_t, uint32_t, uint32_t),
     void (WaveletReverse::*columns)(Buffer2dSimple<T>, Buffer2dSimple<T>, Buffer2dSimple<T>,
@@ -769,7 +770,7 @@ static bool kernelLevels(
     uint32_t resWidth = current->width();
     uint32_t resHeight = current->height();
     lower = current;
-    if(resWidth == 0 || resHeight == 0)
+    if(resWidth == 0 || resHeight == 0 || res < firstLevel)
       continue;
     auto split = tccp ? tccp->splitOfResolution(res) : DecompositionSplit::both;
     auto resFlow = imageComponentFlow->getResflow(res - 1);
@@ -822,7 +823,7 @@ bool WaveletReverse::tile_kernel(void)
   if(kernel_->reversible)
   {
     return kernelLevels<int32_t>(
-        this, tilec_, numres_, scheduler_, compno_,
+        this, tilec_, numres_, firstLevel_, scheduler_, compno_,
         [buf](uint8_t res) { return buf->getResWindowBufferSimple(res); },
         [buf](uint8_t res, t1::eBandOrientation o) {
           return buf->getBandWindowBufferPaddedSimple(res, o);
@@ -833,7 +834,7 @@ bool WaveletReverse::tile_kernel(void)
         &WaveletReverse::kernelRows<int32_t>, &WaveletReverse::kernelColumns<int32_t>, tccp_);
   }
   return kernelLevels<float>(
-      this, tilec_, numres_, scheduler_, compno_,
+      this, tilec_, numres_, firstLevel_, scheduler_, compno_,
       [buf](uint8_t res) { return buf->getResWindowBufferSimpleF(res); },
       [buf](uint8_t res, t1::eBandOrientation o) {
         return buf->getBandWindowBufferPaddedSimpleF(res, o);
@@ -1338,7 +1339,7 @@ bool WaveletReverse::tile_53(void)
     ++bandLL;
     auto resWidth = bandLL->width();
     auto resHeight = bandLL->height();
-    if(resWidth == 0 || resHeight == 0)
+    if(resWidth == 0 || resHeight == 0 || res < firstLevel_)
       continue;
     // an axis the level does not split keeps every sample in the low half
     horiz_.sn = splitsHorizontally(split) ? lowWidth : resWidth;
@@ -1834,7 +1835,7 @@ bool WaveletReverse::tile_16_53(void)
     ++bandLL;
     auto resWidth = bandLL->width();
     auto resHeight = bandLL->height();
-    if(resWidth == 0 || resHeight == 0)
+    if(resWidth == 0 || resHeight == 0 || res < firstLevel_)
       continue;
     horiz16_.dn = resWidth - horiz16_.sn;
     horiz16_.parity = bandLL->x0 & 1;
@@ -133,7 +133,7 @@ public:
                  uint8_t numres, uint8_t qmfbid, uint32_t maxDim, bool wholeTileDecompress,
                  WaveletPoolData* poolData, DcShiftParam dcShift = {},
                  const TileComponentCodingParams* tccp = nullptr,
-                 const TransformKernel* kernel = nullptr);
+                 const TransformKernel* kernel = nullptr, uint8_t firstLevel = 1);
   ~WaveletReverse(void);
   bool decompress(void);
 
@@ -153,6 +153,9 @@ private:
   // Part 2: per level splits and, for ATK streams, the lifting kernel
   const TileComponentCodingParams* tccp_ = nullptr;
   const TransformKernel* kernel_ = nullptr;
+  // whole-tile levels below this one are not synthesized: the scheduler restores
+  // the resolution they would produce from the last differential decompress
+  uint8_t firstLevel_ = 1;
   DecompositionSplit splitOf(uint8_t res) const;
   // arbitrary kernel ////////////////////////////////////////////////////////////////////////
   bool tile_kernel(void);
@@ -975,7 +975,7 @@ bool WaveletReverse::tile_97(void)
     ++tr;
     resWidth = tr->width();
     resHeight = tr->height();
-    if(resWidth == 0 || resHeight == 0)
+    if(resWidth == 0 || resHeight == 0 || res < firstLevel_)
       continue;
     // an axis the level does not split keeps every sample in the low half
     horiz97.sn = splitsHorizontally(split) ? lowWidth : resWidth;
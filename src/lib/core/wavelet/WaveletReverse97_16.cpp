@@ -1198,7 +1198,7 @@ bool WaveletReverse::tile_16_97(void)
     ++bandLL;
     auto resWidth = bandLL->width();
     auto resHeight = bandLL->height();
-    if(resWidth == 0 || resHeight == 0)
+    if(resWidth == 0 || resHeight == 0 || res < firstLevel_)
       continue;
     horiz16_.dn = resWidth - horiz16_.sn;
     horiz16_.parity = bandLL->x0 & 1;
@@ -0,0 +1,201 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// A batch directory decompressed with --batch-lanes 3, each lane with its own
+// parameters and output format, must write the same files, byte for byte, as the same
+// batch decompressed in a single lane, for images of different sizes, precisions and
+// component counts sharing the directory.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "grok_codec.h"
+
+namespace
+{
+const char* SOURCE_DIR = "batch_lanes_src";
+const uint32_t TILE_SIZE = 64;
+// few enough for the smallest image
+const uint8_t NUM_RESOLUTIONS = 3;
+
+struct Config
+{
+  const char* label;
+  uint32_t width;
+  uint32_t height;
+  uint16_t numcomps;
+  uint8_t prec;
+};
+
+bool readWholeFile(const std::string& path, std::vector<uint8_t>& contents)
+{
+  FILE* file = fopen(path.c_str(), "rb");
+  if(!file)
+    return false;
+  contents.clear();
+  uint8_t chunk[65536];
+  size_t got = 0;
+  while((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    contents.insert(contents.end(), chunk, chunk + got);
+  fclose(file);
+
+  return true;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image_comp params[3] = {};
+  for(uint16_t compno = 0; compno < config.numcomps; ++compno)
+  {
+    auto& p = params[compno];
+    p.dx = 1;
+    p.dy = 1;
+    p.w = config.width;
+    p.h = config.height;
+    p.prec = config.prec;
+    p.sgnd = false;
+  }
+  auto colourSpace = config.numcomps >= 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY;
+  grk_image* image = grk_image_new(config.numcomps, params, colourSpace, true);
+  if(!image)
+    return false;
+  uint32_t mask = (1U << config.prec) - 1;
+  for(uint16_t compno = 0; compno < config.numcomps; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < config.height; ++y)
+    {
+      for(uint32_t x = 0; x < config.width; ++x)
+      {
+        uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 22;
+        data[(size_t)y * stride + x] = (int32_t)((x * 37U + y * (11U + compno) + noise) & mask);
+      }
+    }
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_SIZE;
+  parameters.t_height = TILE_SIZE;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+
+  return ok;
+}
+
+bool decompressBatch(const std::string& outDir, const char* numLanes)
+{
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  fs::remove_all(outDir, ec);
+  if(!fs::create_directory(outDir, ec))
+  {
+    fprintf(stderr, "could not create %s\n", outDir.c_str());
+    return false;
+  }
+  const char* argv[] = {"grk_decompress", "-y", SOURCE_DIR, "-a",          outDir.c_str(),
+                        "-O",             "pnm", "--batch-lanes", numLanes};
+  if(grk_codec_decompress(9, argv) != EXIT_SUCCESS)
+  {
+    fprintf(stderr, "batch decompress with %s lanes failed\n", numLanes);
+    return false;
+  }
+  return true;
+}
+
+bool compareDirs(const std::string& lanesDir, const std::string& singleDir, size_t numFiles)
+{
+  namespace fs = std::filesystem;
+  std::vector<std::string> lanesFiles;
+  std::vector<std::string> singleFiles;
+  for(const auto& entry : fs::directory_iterator(lanesDir))
+    lanesFiles.push_back(entry.path().filename().string());
+  for(const auto& entry : fs::directory_iterator(singleDir))
+    singleFiles.push_back(entry.path().filename().string());
+  std::sort(lanesFiles.begin(), lanesFiles.end());
+  std::sort(singleFiles.begin(), singleFiles.end());
+  if(lanesFiles != singleFiles || lanesFiles.size() != numFiles)
+  {
+    fprintf(stderr, "%zu files written with lanes, %zu in a single lane, expected %zu\n",
+            lanesFiles.size(), singleFiles.size(), numFiles);
+    return false;
+  }
+  for(const auto& name : lanesFiles)
+  {
+    std::vector<uint8_t> a;
+    std::vector<uint8_t> b;
+    if(!readWholeFile((fs::path(lanesDir) / name).string(), a) ||
+       !readWholeFile((fs::path(singleDir) / name).string(), b) || a.empty() || a != b)
+    {
+      fprintf(stderr, "%s differs from the single lane output\n", name.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+int main(void)
+{
+  namespace fs = std::filesystem;
+  grk_initialize(nullptr, 0, nullptr);
+
+  // more files than lanes, so that lanes take several files each
+  const Config configs[] = {
+      {"rgb8_wide", 211, 67, 3, 8},    {"grey8_small", 31, 17, 1, 8},
+      {"rgb8_tall", 73, 181, 3, 8},    {"grey16", 150, 101, 1, 16},
+      {"rgb8_one_tile", 64, 64, 3, 8}, {"grey12", 97, 130, 1, 12},
+      {"rgb8_tiny", 9, 7, 3, 8},
+  };
+  std::error_code ec;
+  fs::remove_all(SOURCE_DIR, ec);
+  bool ok = fs::create_directory(SOURCE_DIR, ec);
+  if(!ok)
+    fprintf(stderr, "could not create %s\n", SOURCE_DIR);
+  for(const auto& config : configs)
+  {
+    if(!ok)
+      break;
+    ok = compress((fs::path(SOURCE_DIR) / (std::string(config.label) + ".j2k")).string(),
+                  config);
+    if(!ok)
+      fprintf(stderr, "%s: compress failed\n", config.label);
+  }
+  std::string lanesDir = "batch_lanes_3";
+  std::string singleDir = "batch_lanes_1";
+  ok = ok && decompressBatch(lanesDir, "3") && decompressBatch(singleDir, "1") &&
+       compareDirs(lanesDir, singleDir, sizeof(configs) / sizeof(configs[0]));
+  if(ok)
+    printf("3 lanes write the same %zu files as a single lane\n",
+           sizeof(configs) / sizeof(configs[0]));
+  fs::remove_all(SOURCE_DIR, ec);
+  fs::remove_all(lanesDir, ec);
+  fs::remove_all(singleDir, ec);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,248 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// BatchPipeline hands every file of a batch to exactly one lane, whatever the number of
+// lanes, and counts successes, failures (out of memory included) and unsuitable files
+// apart. A lane index never reaches the number of files, an automatic lane count follows
+// the number of threads within its bounds, and a directory is listed in name order,
+// regular files only.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BatchPipeline.h"
+
+namespace
+{
+const char* BATCH_DIR = "batch_pipeline_dir";
+
+enum Outcome
+{
+  FAIL,
+  SUCCESS,
+  UNSUITABLE,
+  OUT_OF_MEMORY
+};
+
+// outcome of the i-th file of a batch
+Outcome outcomeOf(size_t i)
+{
+  if(i % 5 == 0)
+    return FAIL;
+  if(i % 5 == 1)
+    return UNSUITABLE;
+  if(i % 7 == 3)
+    return OUT_OF_MEMORY;
+  return SUCCESS;
+}
+
+std::string fileName(size_t i)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "file_%03zu.j2k", i);
+  return name;
+}
+
+bool checkLanes(void)
+{
+  const struct
+  {
+    uint32_t numLanes;
+    uint32_t numThreads;
+    uint32_t expected;
+  } cases[] = {{0, 1, 1}, {0, 7, 1}, {0, 8, 2}, {0, 16, 4}, {0, 1000, 8}, {3, 1, 3}, {12, 64, 12}};
+  bool ok = true;
+  for(const auto& c : cases)
+  {
+    grk::BatchPipeline pipeline(c.numLanes, c.numThreads);
+    if(pipeline.numLanes() != c.expected)
+    {
+      fprintf(stderr, "%u lanes with %u threads gives %u lanes, expected %u\n", c.numLanes,
+              c.numThreads, pipeline.numLanes(), c.expected);
+      ok = false;
+    }
+  }
+  // no thread count picks from the cores, within the same bounds
+  auto numLanes = grk::BatchPipeline(0, 0).numLanes();
+  if(numLanes < 1 || numLanes > 8)
+  {
+    fprintf(stderr, "automatic lane count is %u\n", numLanes);
+    ok = false;
+  }
+  if(ok)
+    printf("lane counts are as expected\n");
+  return ok;
+}
+
+bool checkListFiles(void)
+{
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  fs::remove_all(BATCH_DIR, ec);
+  if(!fs::create_directory(BATCH_DIR, ec))
+  {
+    fprintf(stderr, "could not create %s\n", BATCH_DIR);
+    return false;
+  }
+  const char* names[] = {"c.j2k", "a.jp2", "B.j2k", "b.j2k", "a.j2k", "10.j2k", "9.j2k"};
+  for(auto name : names)
+  {
+    FILE* file = fopen((fs::path(BATCH_DIR) / name).string().c_str(), "wb");
+    if(file)
+      fclose(file);
+  }
+  // a sub directory is not a file of the batch
+  fs::create_directory(fs::path(BATCH_DIR) / "a.sub", ec);
+  const std::vector<std::string> expected = {"10.j2k", "9.j2k", "B.j2k", "a.j2k",
+                                             "a.jp2",  "b.j2k", "c.j2k"};
+  auto files = grk::BatchPipeline::listFiles(BATCH_DIR);
+  bool ok = files == expected;
+  if(ok)
+  {
+    printf("directory is listed in name order\n");
+  }
+  else
+  {
+    fprintf(stderr, "directory is listed as");
+    for(const auto& f : files)
+      fprintf(stderr, " %s", f.c_str());
+    fprintf(stderr, "\n");
+  }
+  fs::remove_all(BATCH_DIR, ec);
+
+  return ok;
+}
+
+bool checkRun(uint32_t numLanes, size_t numFiles)
+{
+  grk::BatchPipeline pipeline(numLanes, 0);
+  std::vector<std::string> files;
+  for(size_t i = 0; i < numFiles; ++i)
+    files.push_back(fileName(i));
+  std::vector<uint32_t> visits(numFiles, 0);
+  std::vector<uint32_t> lanesUsed;
+  std::mutex mutex;
+  uint32_t badLane = UINT32_MAX;
+  auto job = [&](uint32_t lane, const std::string& name, uint64_t& pixels) {
+    size_t i = (size_t)std::stoul(name.substr(5, 3));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      visits[i]++;
+      if(lane >= std::min<size_t>(pipeline.numLanes(), numFiles))
+        badLane = lane;
+      else if(std::find(lanesUsed.begin(), lanesUsed.end(), lane) == lanesUsed.end())
+        lanesUsed.push_back(lane);
+    }
+    // keep the lanes busy long enough to overlap
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    pixels = 100;
+    switch(outcomeOf(i))
+    {
+      case FAIL:
+        return 0;
+      case UNSUITABLE:
+        return 2;
+      case OUT_OF_MEMORY:
+        throw std::bad_alloc();
+      default:
+        return 1;
+    }
+  };
+
+  uint32_t expectedSuccess = 0;
+  uint32_t expectedFailed = 0;
+  uint32_t expectedUnsuitable = 0;
+  for(size_t i = 0; i < numFiles; ++i)
+  {
+    auto outcome = outcomeOf(i);
+    if(outcome == SUCCESS)
+      expectedSuccess++;
+    else if(outcome == UNSUITABLE)
+      expectedUnsuitable++;
+    else
+      expectedFailed++;
+  }
+  // a second run adds to the counters, and visits every file once more
+  const uint32_t numRuns = 2;
+  bool ok = true;
+  for(uint32_t run = 1; ok && run <= numRuns; ++run)
+  {
+    uint32_t processed = pipeline.run(files, job);
+    if(processed != expectedSuccess)
+    {
+      fprintf(stderr, "%u lanes, %zu files: run %u returned %u, expected %u\n", numLanes,
+              numFiles, run, processed, expectedSuccess);
+      ok = false;
+    }
+  }
+  for(size_t i = 0; ok && i < numFiles; ++i)
+  {
+    if(visits[i] != numRuns)
+    {
+      fprintf(stderr, "%u lanes, %zu files: %s was processed %u times in %u runs\n", numLanes,
+              numFiles, files[i].c_str(), visits[i], numRuns);
+      ok = false;
+    }
+  }
+  if(ok && badLane != UINT32_MAX)
+  {
+    fprintf(stderr, "%u lanes, %zu files: a job ran in lane %u\n", numLanes, numFiles, badLane);
+    ok = false;
+  }
+  if(ok && (pipeline.numProcessed() != numRuns * expectedSuccess ||
+            pipeline.numFailed() != numRuns * expectedFailed ||
+            pipeline.numUnsuitable() != numRuns * expectedUnsuitable))
+  {
+    fprintf(stderr,
+            "%u lanes, %zu files: %u processed, %u failed, %u unsuitable, "
+            "expected %u, %u, %u\n",
+            numLanes, numFiles, pipeline.numProcessed(), pipeline.numFailed(),
+            pipeline.numUnsuitable(), numRuns * expectedSuccess, numRuns * expectedFailed,
+            numRuns * expectedUnsuitable);
+    ok = false;
+  }
+  if(ok)
+    printf("%u lanes, %zu files: every file processed once per run in %zu lanes\n", numLanes,
+           numFiles, lanesUsed.size());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  bool ok = checkLanes();
+  ok = checkListFiles() && ok;
+  const struct
+  {
+    uint32_t numLanes;
+    size_t numFiles;
+  } runs[] = {{1, 23}, {3, 23}, {4, 64}, {8, 2}, {5, 5}, {3, 1}, {4, 0}};
+  for(const auto& r : runs)
+    ok = checkRun(r.numLanes, r.numFiles) && ok;
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,237 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// the Part-1 block decoder must stay bit exact across code block styles and
+// sizes: a lossless decode recovers the source samples, and a decode truncated
+// to the first quality layer matches the one produced by the cached decode
+// passes (GRK_TILE_CACHE_ALL), which take the scalar differential path.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+// odd dimensions leave partial stripes and partial code blocks on every edge
+const uint32_t IMAGE_WIDTH = 157;
+const uint32_t IMAGE_HEIGHT = 93;
+const uint16_t NUM_COMPS = 2;
+const uint8_t PREC = 12;
+
+struct Config
+{
+  const char* label;
+  uint8_t cblkSty;
+  uint32_t cblkw;
+  uint32_t cblkh;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+// flat areas, edges and noise, so code blocks range from all-zero stripes to dense ones
+int32_t sourceSample(uint16_t compno, uint32_t x, uint32_t y)
+{
+  const int32_t mask = (1 << PREC) - 1;
+  if(y < IMAGE_HEIGHT / 3)
+    return compno ? 2048 : 17;
+  if(x < IMAGE_WIDTH / 2)
+    return (int32_t)(((x / 9) * 311 + (y / 7) * 97 + compno * 1000) & mask);
+  uint32_t h = (x * 73856093U) ^ (y * 19349663U) ^ (compno * 83492791U);
+  h ^= h >> 13;
+  h *= 0x5bd1e995U;
+  return (int32_t)((h ^ (h >> 15)) & mask);
+}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = PREC;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_GRAY, true);
+  if(!image)
+    return nullptr;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+        data[(size_t)y * stride + x] = sourceSample(compno, x, y);
+  }
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage();
+  if(!image)
+  {
+    fprintf(stderr, "%s: could not build the source image\n", config.label);
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.irreversible = false;
+  parameters.numresolution = 4;
+  parameters.cblockw_init = config.cblkw;
+  parameters.cblockh_init = config.cblkh;
+  parameters.cblk_sty = config.cblkSty;
+  // two lossy layers, then lossless
+  parameters.numlayers = 3;
+  parameters.allocation_by_rate_distortion = true;
+  parameters.layer_rate[0] = 40;
+  parameters.layer_rate[1] = 10;
+  parameters.layer_rate[2] = 0;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+bool decompress(const std::string& path, uint16_t layers, uint32_t cacheStrategy,
+                std::vector<int32_t>& out)
+{
+  grk_decompress_parameters params = {};
+  params.core.layers_to_decompress = layers;
+  params.core.tile_cache_strategy = cacheStrategy;
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool ok = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+  grk_image* image = ok ? grk_decompress_get_image(codec) : nullptr;
+  ok = image && image->numcomps == NUM_COMPS && image->comps[0].data &&
+       image->comps[0].w == IMAGE_WIDTH && image->comps[0].h == IMAGE_HEIGHT;
+  if(ok)
+  {
+    out.resize((size_t)IMAGE_WIDTH * IMAGE_HEIGHT * NUM_COMPS);
+    for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+    {
+      const auto& comp = image->comps[compno];
+      for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+        for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+          out[((size_t)compno * IMAGE_HEIGHT + y) * IMAGE_WIDTH + x] =
+              sampleAt(comp, (uint64_t)y * comp.stride + x);
+    }
+  }
+  grk_object_unref(codec);
+  return ok;
+}
+
+bool check(const Config& config)
+{
+  std::string path = std::string("block_coder_conformance_") + config.label + ".j2k";
+  if(!compress(path, config))
+    return false;
+  bool ok = true;
+
+  std::vector<int32_t> lossless;
+  if(!decompress(path, 0, GRK_TILE_CACHE_NONE, lossless))
+  {
+    fprintf(stderr, "%s: lossless decode failed\n", config.label);
+    ok = false;
+  }
+  for(size_t i = 0; ok && i < lossless.size(); ++i)
+  {
+    uint32_t x = (uint32_t)(i % IMAGE_WIDTH);
+    uint32_t y = (uint32_t)((i / IMAGE_WIDTH) % IMAGE_HEIGHT);
+    uint16_t compno = (uint16_t)(i / ((size_t)IMAGE_WIDTH * IMAGE_HEIGHT));
+    if(lossless[i] != sourceSample(compno, x, y))
+    {
+      fprintf(stderr, "%s: component %u sample (%u,%u) is %d, source has %d\n", config.label,
+              compno, x, y, lossless[i], sourceSample(compno, x, y));
+      ok = false;
+    }
+  }
+
+  std::vector<int32_t> truncated, cached;
+  if(ok && (!decompress(path, 1, GRK_TILE_CACHE_NONE, truncated) ||
+            !decompress(path, 1, GRK_TILE_CACHE_ALL, cached)))
+  {
+    fprintf(stderr, "%s: single layer decode failed\n", config.label);
+    ok = false;
+  }
+  for(size_t i = 0; ok && i < truncated.size(); ++i)
+  {
+    if(truncated[i] != cached[i])
+    {
+      fprintf(stderr, "%s: single layer sample %zu is %d, cached decode has %d\n", config.label,
+              i, truncated[i], cached[i]);
+      ok = false;
+    }
+  }
+  if(ok)
+    printf("%s: bit exact\n", config.label);
+  remove(path.c_str());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"default_64x64", 0, 64, 64},
+      {"default_32x16", 0, 32, 16},
+      {"vsc", GRK_CBLKSTY_VSC, 64, 64},
+      {"reset_segsym", GRK_CBLKSTY_RESET | GRK_CBLKSTY_SEGSYM, 64, 64},
+      {"termall", GRK_CBLKSTY_TERMALL, 16, 64},
+      {"lazy", GRK_CBLKSTY_LAZY, 64, 64},
+      {"lazy_termall_vsc", GRK_CBLKSTY_LAZY | GRK_CBLKSTY_TERMALL | GRK_CBLKSTY_VSC, 32, 32},
+      {"pterm_1024x4", GRK_CBLKSTY_PTERM, 1024, 4},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// panning a decode window with the code block cache enabled must replay the
+// code blocks the previous window decoded, and produce exactly what a fresh
+// codec without the cache produces, for Part-1 and HTJ2K, 5/3 and 9/7.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 157;
+const uint32_t IMAGE_HEIGHT = 139;
+const uint32_t TILE_SIZE = 64;
+const uint32_t CBLK_SIZE = 16;
+const uint64_t CACHE_BYTES = 64ULL * 1024 * 1024;
+
+struct Window
+{
+  uint32_t x0, y0, x1, y1;
+};
+
+// the second window shares most of its code blocks with the first
+const Window FIRST_WINDOW = {10, 12, 90, 80};
+const Window SECOND_WINDOW = {30, 20, 120, 96};
+
+struct Config
+{
+  const char* label;
+  bool irreversible;
+  bool ht;
+  bool tiled;
+};
+
+struct Plane
+{
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<int32_t> samples;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+bool capture(grk_image* image, Plane& out)
+{
+  const auto& source = image->comps[0];
+  if(!source.data || source.w == 0 || source.h == 0)
+  {
+    fprintf(stderr, "decoded component is empty: %ux%u\n", source.w, source.h);
+    return false;
+  }
+  out.width = source.w;
+  out.height = source.h;
+  out.samples.resize((size_t)source.w * source.h);
+  for(uint32_t y = 0; y < source.h; ++y)
+    for(uint32_t x = 0; x < source.w; ++x)
+      out.samples[(size_t)y * source.w + x] = sampleAt(source, (uint64_t)y * source.stride + x);
+  return true;
+}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params = {};
+  params.dx = 1;
+  params.dy = 1;
+  params.w = IMAGE_WIDTH;
+  params.h = IMAGE_HEIGHT;
+  params.prec = 8;
+  params.sgnd = false;
+  grk_image* image = grk_image_new(1, &params, GRK_CLRSPC_GRAY, true);
+  if(!image)
+    return nullptr;
+  auto* data = static_cast<int32_t*>(image->comps[0].data);
+  uint32_t stride = image->comps[0].stride;
+  for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      data[(size_t)y * stride + x] = (int32_t)((x * 5 + y * 11 + ((x * y) % 37) * 3) & 0xFF);
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage();
+  if(!image)
+  {
+    fprintf(stderr, "could not build the source image\n");
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.irreversible = config.irreversible;
+  parameters.cblockw_init = CBLK_SIZE;
+  parameters.cblockh_init = CBLK_SIZE;
+  parameters.numresolution = 4;
+  if(config.ht)
+    parameters.cblk_sty = GRK_CBLKSTY_HT_ONLY;
+  if(config.tiled)
+  {
+    parameters.tile_size_on = true;
+    parameters.t_width = TILE_SIZE;
+    parameters.t_height = TILE_SIZE;
+  }
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+void fillParams(grk_decompress_parameters& params, const Window& window, uint64_t cacheBytes)
+{
+  params = {};
+  params.dw_x0 = window.x0;
+  params.dw_y0 = window.y0;
+  params.dw_x1 = window.x1;
+  params.dw_y1 = window.y1;
+  params.core.codeblock_cache_bytes = cacheBytes;
+}
+
+grk_object* openCodec(const std::string& path, grk_decompress_parameters& params)
+{
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return nullptr;
+  grk_header_info headerInfo = {};
+  if(!grk_decompress_read_header(codec, &headerInfo))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  return codec;
+}
+
+bool decodeTo(grk_object* codec, Plane& out)
+{
+  if(!grk_decompress(codec, nullptr))
+    return false;
+  grk_image* image = grk_decompress_get_image(codec);
+  return image && capture(image, out);
+}
+
+bool samePlane(const char* label, const Plane& got, const Plane& expected)
+{
+  if(got.width != expected.width || got.height != expected.height)
+  {
+    fprintf(stderr, "%s: cached decode is %ux%u, a fresh codec gives %ux%u\n", label, got.width,
+            got.height, expected.width, expected.height);
+    return false;
+  }
+  for(size_t i = 0; i < expected.samples.size(); ++i)
+  {
+    if(got.samples[i] != expected.samples[i])
+    {
+      fprintf(stderr, "%s: sample (%u,%u) is %d, a fresh codec gives %d\n", label,
+              (uint32_t)(i % expected.width), (uint32_t)(i / expected.width), got.samples[i],
+              expected.samples[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool check(const Config& config)
+{
+  std::string path = std::string("codeblock_cache_") + config.label + ".j2k";
+  if(!compress(path, config))
+    return false;
+
+  bool ok = false;
+  Plane fresh;
+  grk_decompress_parameters params;
+  fillParams(params, SECOND_WINDOW, 0);
+  auto codec = openCodec(path, params);
+  if(codec)
+  {
+    ok = decodeTo(codec, fresh);
+    grk_codeblock_cache_stats stats = {};
+    if(ok && (!grk_decompress_get_codeblock_cache_stats(codec, &stats) || stats.hits ||
+              stats.misses || stats.max_bytes))
+    {
+      fprintf(stderr, "%s: disabled cache reported activity\n", config.label);
+      ok = false;
+    }
+    grk_object_unref(codec);
+  }
+  if(!ok)
+  {
+    fprintf(stderr, "%s: reference decode failed\n", config.label);
+    remove(path.c_str());
+    return false;
+  }
+
+  ok = false;
+  fillParams(params, FIRST_WINDOW, CACHE_BYTES);
+  codec = openCodec(path, params);
+  if(codec)
+  {
+    Plane first;
+    Plane panned;
+    grk_codeblock_cache_stats firstStats = {};
+    grk_codeblock_cache_stats pannedStats = {};
+    grk_decompress_parameters panParams;
+    fillParams(panParams, SECOND_WINDOW, CACHE_BYTES);
+    if(!decodeTo(codec, first) || !grk_decompress_get_codeblock_cache_stats(codec, &firstStats))
+      fprintf(stderr, "%s: first window decode failed\n", config.label);
+    else if(!grk_decompress_update(&panParams, codec) || !decodeTo(codec, panned) ||
+            !grk_decompress_get_codeblock_cache_stats(codec, &pannedStats))
+      fprintf(stderr, "%s: panned window decode failed\n", config.label);
+    else if(firstStats.hits || !firstStats.misses || !firstStats.entries)
+      fprintf(stderr, "%s: first window: %llu hits, %llu misses, %llu entries\n", config.label,
+              (unsigned long long)firstStats.hits, (unsigned long long)firstStats.misses,
+              (unsigned long long)firstStats.entries);
+    else if(!pannedStats.hits || pannedStats.misses == firstStats.misses)
+      fprintf(stderr, "%s: panned window: %llu hits, %llu new misses\n", config.label,
+              (unsigned long long)pannedStats.hits,
+              (unsigned long long)(pannedStats.misses - firstStats.misses));
+    else if(pannedStats.bytes > CACHE_BYTES)
+      fprintf(stderr, "%s: cache holds %llu bytes, over its budget\n", config.label,
+              (unsigned long long)pannedStats.bytes);
+    else
+    {
+      ok = samePlane(config.label, panned, fresh);
+      if(ok)
+        printf("%s: panned window replayed %llu code blocks and decoded %llu\n", config.label,
+               (unsigned long long)pannedStats.hits,
+               (unsigned long long)(pannedStats.misses - firstStats.misses));
+    }
+    grk_object_unref(codec);
+  }
+  remove(path.c_str());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"part1_53", false, false, false},    {"part1_97", true, false, false},
+      {"part1_53_tiled", false, false, true}, {"ht_53", false, true, false},
+      {"ht_97_tiled", true, true, true},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// A decompress with grk_decompress_core_params::component_group_size must decode each
+// tile's components a group at a time to exactly the samples of a decompress of all
+// components at once: reversible and irreversible, with MCT or a custom MCT, tiles and a
+// window. Tiled groups are copied into the composite image one group at a time.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t WIDTH = 260;
+const uint32_t HEIGHT = 196;
+const uint8_t PRECISION = 12;
+
+struct Case
+{
+  const char* label;
+  uint16_t numComps;
+  bool irreversible;
+  uint32_t tileSize;
+  uint16_t groupSize;
+  bool window;
+  bool customMct;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+uint32_t xorshift32(uint32_t& state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// smooth spectra that vary across the bands, with some noise
+grk_image* makeImage(uint16_t numComps)
+{
+  std::vector<grk_image_comp> params(numComps);
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = WIDTH;
+    p.h = HEIGHT;
+    p.prec = PRECISION;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(numComps, params.data(),
+                             numComps == 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY, true);
+  if(!image)
+    return nullptr;
+  uint32_t state = 0x9e3779b9u;
+  for(uint16_t compno = 0; compno < numComps; ++compno)
+  {
+    auto comp = image->comps + compno;
+    auto data = (int32_t*)comp->data;
+    for(uint32_t y = 0; y < HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < WIDTH; ++x)
+      {
+        double v = 1800.0 + 4.0 * x - 3.0 * y +
+                   900.0 * std::sin(x * 0.03 + compno * 0.2) * std::cos(y * 0.04) +
+                   (double)(xorshift32(state) % 64);
+        data[(size_t)y * comp->stride + x] = std::clamp((int32_t)v, 0, 4095);
+      }
+    }
+  }
+  return image;
+}
+
+// compresses a J2K code stream; returns its length, or 0 on failure
+uint64_t compress(const Case& c, std::vector<uint8_t>& out)
+{
+  auto image = makeImage(c.numComps);
+  if(!image)
+    return 0;
+  grk_cparameters parameters;
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.irreversible = c.irreversible;
+  parameters.numresolution = 4;
+  parameters.cblockw_init = 32;
+  parameters.cblockh_init = 32;
+  if(c.tileSize)
+  {
+    parameters.tile_size_on = true;
+    parameters.t_width = c.tileSize;
+    parameters.t_height = c.tileSize;
+  }
+  std::vector<float> matrix;
+  std::vector<int32_t> dcShift;
+  if(c.customMct)
+  {
+    // a Householder reflection, I - 2vv'/v'v with v all ones: orthogonal, and its own inverse
+    for(uint16_t o = 0; o < c.numComps; ++o)
+    {
+      for(uint16_t k = 0; k < c.numComps; ++k)
+        matrix.push_back((o == k ? 1.0f : 0.0f) - 2.0f / c.numComps);
+      dcShift.push_back(1 << (PRECISION - 1));
+    }
+    if(!grk_set_MCT(&parameters, matrix.data(), dcShift.data(), c.numComps))
+    {
+      grk_object_unref(&image->obj);
+      return 0;
+    }
+  }
+
+  out.assign((size_t)c.numComps * WIDTH * HEIGHT * 4 + 4096, 0);
+  grk_stream_params streamParams = {};
+  streamParams.buf = out.data();
+  streamParams.buf_len = out.size();
+  uint64_t length = 0;
+  auto codec = grk_compress_init(&streamParams, &parameters, image);
+  if(codec)
+    length = grk_compress(codec, nullptr);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  out.resize(length);
+
+  return length;
+}
+
+bool decompress(std::vector<uint8_t>& file, const Case& c, uint16_t groupSize,
+                std::vector<std::vector<int32_t>>& samples)
+{
+  grk_decompress_parameters params = {};
+  params.core.component_group_size = groupSize;
+  if(c.window)
+  {
+    params.dw_x0 = 37;
+    params.dw_y0 = 21;
+    params.dw_x1 = 201;
+    params.dw_y1 = 170;
+  }
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  streamParams.buf = file.data();
+  streamParams.buf_len = file.size();
+  auto codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool ok = false;
+  if(grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr))
+  {
+    auto image = grk_decompress_get_image(codec);
+    ok = image && image->numcomps == c.numComps;
+    samples.clear();
+    for(uint16_t compno = 0; ok && compno < image->numcomps; ++compno)
+    {
+      const auto& comp = image->comps[compno];
+      if(!comp.data)
+      {
+        ok = false;
+        break;
+      }
+      auto& s = samples.emplace_back((size_t)comp.w * comp.h);
+      for(uint32_t y = 0; y < comp.h; ++y)
+      {
+        for(uint32_t x = 0; x < comp.w; ++x)
+        {
+          uint64_t index = (uint64_t)y * comp.stride + x;
+          s[(size_t)y * comp.w + x] = comp.data_type == GRK_INT_16 ? ((int16_t*)comp.data)[index]
+                                                                   : ((int32_t*)comp.data)[index];
+        }
+      }
+    }
+  }
+  grk_object_unref(codec);
+
+  return ok;
+}
+
+bool check(const Case& c)
+{
+  std::vector<uint8_t> file;
+  if(!compress(c, file))
+  {
+    fprintf(stderr, "%s: compress failed\n", c.label);
+    return false;
+  }
+  std::vector<std::vector<int32_t>> expected;
+  std::vector<std::vector<int32_t>> actual;
+  if(!decompress(file, c, 0, expected) || !decompress(file, c, c.groupSize, actual))
+  {
+    fprintf(stderr, "%s: decompress failed\n", c.label);
+    return false;
+  }
+  for(size_t compno = 0; compno < expected.size(); ++compno)
+  {
+    if(actual[compno] != expected[compno])
+    {
+      fprintf(stderr, "%s: component %zu differs with groups of %u\n", c.label, compno,
+              c.groupSize);
+      return false;
+    }
+  }
+  printf("%s: %u components in groups of %u match\n", c.label, c.numComps, c.groupSize);
+
+  return true;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Case cases[] = {
+      {"reversible_bands", 16, false, 0, 5, false, false},
+      {"irreversible_tiled_bands", 12, true, 128, 4, false, false},
+      {"reversible_rgb_mct", 3, false, 0, 1, false, false},
+      {"irreversible_bands_window", 9, true, 100, 2, true, false},
+      {"custom_mct_tiled_bands", 8, true, 100, 3, false, true},
+      {"custom_mct_bands_window", 6, true, 64, 4, true, true},
+  };
+  bool ok = true;
+  for(const auto& c : cases)
+    ok = check(c) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// decoding straight into a caller's interleaved uint8/uint16 buffer
+// (grk_decompress_core_params::output_buffer) must produce the samples a
+// regular decode leaves in the composite image, for tiled and single-tile
+// images, reduced resolutions and decode windows.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 300;
+const uint32_t IMAGE_HEIGHT = 220;
+const uint16_t NUM_COMPS = 3;
+
+struct Config
+{
+  const char* label;
+  uint32_t tileSize; // 0 = single tile
+  uint8_t prec;
+  uint8_t reduce;
+  bool window;
+};
+
+struct Reference
+{
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<int32_t> samples; // interleaved
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+grk_image* makeImage(uint8_t prec)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = prec;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  int32_t mask = (1 << prec) - 1;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+        data[(size_t)y * stride + x] =
+            (int32_t)((x * (5 + compno) * 37 + y * 11 + ((x ^ y) % 23) * 97) & mask);
+  }
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage(config.prec);
+  if(!image)
+  {
+    fprintf(stderr, "%s: could not build the source image\n", config.label);
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = 4;
+  if(config.tileSize)
+  {
+    parameters.tile_size_on = true;
+    parameters.t_width = config.tileSize;
+    parameters.t_height = config.tileSize;
+  }
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+grk_decompress_parameters decompressParams(const Config& config)
+{
+  grk_decompress_parameters params = {};
+  params.core.reduce = config.reduce;
+  if(config.window)
+  {
+    params.dw_x0 = 37;
+    params.dw_y0 = 51;
+    params.dw_x1 = 241;
+    params.dw_y1 = 190;
+  }
+  return params;
+}
+
+grk_object* openCodec(const std::string& path, grk_decompress_parameters& params)
+{
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return nullptr;
+  grk_header_info headerInfo = {};
+  if(!grk_decompress_read_header(codec, &headerInfo))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  return codec;
+}
+
+bool decodeReference(const std::string& path, const Config& config, Reference& out)
+{
+  auto params = decompressParams(config);
+  auto codec = openCodec(path, params);
+  if(!codec)
+    return false;
+  bool ok = grk_decompress(codec, nullptr);
+  grk_image* image = ok ? grk_decompress_get_image(codec) : nullptr;
+  ok = image && image->numcomps == NUM_COMPS && image->comps[0].data;
+  if(ok)
+  {
+    out.width = image->comps[0].w;
+    out.height = image->comps[0].h;
+    out.samples.resize((size_t)out.width * out.height * NUM_COMPS);
+    for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+    {
+      const auto& comp = image->comps[compno];
+      for(uint32_t y = 0; y < out.height; ++y)
+        for(uint32_t x = 0; x < out.width; ++x)
+          out.samples[((size_t)y * out.width + x) * NUM_COMPS + compno] =
+              sampleAt(comp, (uint64_t)y * comp.stride + x);
+    }
+  }
+  grk_object_unref(codec);
+  return ok;
+}
+
+template<typename T>
+bool decodeDirect(const std::string& path, const Config& config, const Reference& reference)
+{
+  // interleaved with a padded line, the way a viewer lays out its frame buffer
+  const int64_t lineSamples = (int64_t)reference.width * NUM_COMPS + 5;
+  std::vector<T> pixels((size_t)lineSamples * reference.height, (T)0xABCD);
+  grk_swath_buffer buf = {};
+  buf.data = pixels.data();
+  buf.prec = (uint8_t)(sizeof(T) * 8);
+  buf.numcomps = NUM_COMPS;
+  buf.pixel_space = (int64_t)sizeof(T) * NUM_COMPS;
+  buf.line_space = lineSamples * (int64_t)sizeof(T);
+  buf.band_space = sizeof(T);
+  buf.promote_alpha = -1;
+
+  auto params = decompressParams(config);
+  params.core.output_buffer = &buf;
+  auto codec = openCodec(path, params);
+  if(!codec)
+    return false;
+  bool ok = grk_decompress(codec, nullptr);
+  grk_object_unref(codec);
+  if(!ok)
+  {
+    fprintf(stderr, "%s: direct decode failed\n", config.label);
+    return false;
+  }
+  for(uint32_t y = 0; y < reference.height; ++y)
+  {
+    for(uint32_t x = 0; x < reference.width; ++x)
+    {
+      for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+      {
+        int32_t value = pixels[(size_t)y * lineSamples + (size_t)x * NUM_COMPS + compno];
+        int32_t expected =
+            reference.samples[((size_t)y * reference.width + x) * NUM_COMPS + compno];
+        if(value != expected)
+        {
+          fprintf(stderr, "%s: component %u sample (%u,%u) is %d, composite has %d\n",
+                  config.label, compno, x, y, value, expected);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool check(const Config& config)
+{
+  std::string path = std::string("direct_output_") + config.label + ".j2k";
+  if(!compress(path, config))
+    return false;
+  Reference reference;
+  bool ok = false;
+  if(!decodeReference(path, config, reference))
+    fprintf(stderr, "%s: reference decode failed\n", config.label);
+  else if(config.prec <= 8)
+    ok = decodeDirect<uint8_t>(path, config, reference);
+  else
+    ok = decodeDirect<uint16_t>(path, config, reference);
+  if(ok)
+    printf("%s: direct output matches\n", config.label);
+  remove(path.c_str());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"rgb8_tiled", 64, 8, 0, false},
+      {"rgb8_single_tile", 0, 8, 0, false},
+      {"rgb16_tiled", 64, 12, 0, false},
+      {"rgb8_tiled_reduced", 64, 8, 1, false},
+      {"rgb8_tiled_window", 64, 8, 0, true},
+      {"rgb16_single_tile_window", 0, 12, 0, true},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// HTJ2K compression with a compression ratio or max_cs_size must produce a code stream
+// no larger than the target, and not far below it when the lossless code stream is
+// larger. The code stream must decode, and PSNR must rise with the target size.
+// Tight targets, where packet headers take a large share of the bytes, must still give
+// a code stream rather than fail the compress. For an absolute bound on quality, which
+// a wrong reconstruction of truncated blocks would break, PSNR must be within a few dB
+// of a Part-1 code stream of the same size.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t WIDTH = 384;
+const uint32_t HEIGHT = 320;
+const uint8_t PRECISION = 8;
+const double MIN_FILL = 0.5;
+const double MAX_PSNR_LOSS = 3.0;
+
+struct Case
+{
+  const char* label;
+  uint16_t numComps;
+  bool irreversible;
+  bool maxCodestreamSize;
+  std::vector<double> ratios;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+uint32_t xorshift32(uint32_t& state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// gradients and ripples with some noise, so that every sub-band has content
+std::vector<std::vector<int32_t>> makeSamples(uint16_t numComps)
+{
+  std::vector<std::vector<int32_t>> samples(numComps);
+  uint32_t state = 0x9e3779b9u;
+  for(uint16_t compno = 0; compno < numComps; ++compno)
+  {
+    auto& s = samples[compno];
+    s.resize((size_t)WIDTH * HEIGHT);
+    for(uint32_t y = 0; y < HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < WIDTH; ++x)
+      {
+        double v = 96.0 + 0.2 * x + 0.1 * (y + 30.0 * compno) +
+                   40.0 * std::sin(x * 0.07 + compno) * std::cos(y * 0.05) +
+                   (double)(xorshift32(state) % 24);
+        s[(size_t)y * WIDTH + x] = std::clamp((int32_t)v, 0, 255);
+      }
+    }
+  }
+  return samples;
+}
+
+size_t imageBytes(uint16_t numComps)
+{
+  return (size_t)numComps * WIDTH * HEIGHT * PRECISION / 8;
+}
+
+// compresses with a compression ratio, or with max_cs_size set to the size the ratio
+// gives; a ratio of 0 is lossless. Part-1 code blocks are used instead of HT if ht is
+// false. Returns the code stream length, or 0 on failure
+uint64_t compress(const Case& c, const std::vector<std::vector<int32_t>>& samples, double ratio,
+                  std::vector<uint8_t>& out, bool ht = true)
+{
+  std::vector<grk_image_comp> params(c.numComps);
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = WIDTH;
+    p.h = HEIGHT;
+    p.prec = PRECISION;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(c.numComps, params.data(),
+                             c.numComps == 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY, true);
+  if(!image)
+    return 0;
+  for(uint16_t compno = 0; compno < c.numComps; ++compno)
+  {
+    auto comp = image->comps + compno;
+    auto data = (int32_t*)comp->data;
+    for(uint32_t y = 0; y < HEIGHT; ++y)
+      std::copy_n(samples[compno].data() + (size_t)y * WIDTH, WIDTH,
+                  data + (size_t)y * comp->stride);
+  }
+
+  grk_cparameters parameters;
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  if(ht)
+    parameters.cblk_sty = GRK_CBLKSTY_HT_ONLY;
+  parameters.irreversible = c.irreversible;
+  parameters.numresolution = 5;
+  parameters.numlayers = 1;
+  if(ratio > 0 && c.maxCodestreamSize)
+    parameters.max_cs_size = (uint64_t)(imageBytes(c.numComps) / ratio);
+  else
+    parameters.layer_rate[0] = ratio;
+  parameters.allocation_by_rate_distortion = true;
+
+  out.assign(imageBytes(c.numComps) * 2 + 4096, 0);
+  grk_stream_params streamParams = {};
+  streamParams.buf = out.data();
+  streamParams.buf_len = out.size();
+  uint64_t length = 0;
+  auto codec = grk_compress_init(&streamParams, &parameters, image);
+  if(codec)
+    length = grk_compress(codec, nullptr);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  out.resize(length);
+
+  return length;
+}
+
+// decompresses a code stream and returns its PSNR against the source samples, or a
+// negative value on failure
+double decompressPSNR(std::vector<uint8_t>& codestream,
+                      const std::vector<std::vector<int32_t>>& samples)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  streamParams.buf = codestream.data();
+  streamParams.buf_len = codestream.size();
+  auto codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return -1;
+  grk_header_info headerInfo = {};
+  double psnr = -1;
+  if(grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr))
+  {
+    auto image = grk_decompress_get_image(codec);
+    if(image && image->numcomps == samples.size())
+    {
+      double se = 0;
+      bool ok = true;
+      for(uint16_t compno = 0; ok && compno < image->numcomps; ++compno)
+      {
+        const auto& comp = image->comps[compno];
+        if(!comp.data || comp.w != WIDTH || comp.h != HEIGHT)
+        {
+          ok = false;
+          break;
+        }
+        for(uint32_t y = 0; y < HEIGHT; ++y)
+        {
+          for(uint32_t x = 0; x < WIDTH; ++x)
+          {
+            uint64_t index = (uint64_t)y * comp.stride + x;
+            int32_t v = comp.data_type == GRK_INT_16 ? ((int16_t*)comp.data)[index]
+                                                      : ((int32_t*)comp.data)[index];
+            double e = (double)v - samples[compno][(size_t)y * WIDTH + x];
+            se += e * e;
+          }
+        }
+      }
+      if(ok)
+      {
+        double mse = se / ((double)samples.size() * WIDTH * HEIGHT);
+        psnr = mse == 0 ? 999.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+      }
+    }
+  }
+  grk_object_unref(codec);
+
+  return psnr;
+}
+
+bool check(const Case& c)
+{
+  auto samples = makeSamples(c.numComps);
+  std::vector<uint8_t> codestream;
+  uint64_t lossless = compress(c, samples, 0, codestream);
+  if(!lossless)
+  {
+    fprintf(stderr, "%s: unconstrained compress failed\n", c.label);
+    return false;
+  }
+  double prevPSNR = 0;
+  for(auto ratio : c.ratios)
+  {
+    auto target = (uint64_t)(imageBytes(c.numComps) / ratio);
+    uint64_t length = compress(c, samples, ratio, codestream);
+    if(!length)
+    {
+      fprintf(stderr, "%s: compress at ratio %.1f failed\n", c.label, ratio);
+      return false;
+    }
+    if(length > target)
+    {
+      fprintf(stderr, "%s: ratio %.1f gave %llu bytes, over the %llu byte target\n", c.label,
+              ratio, (unsigned long long)length, (unsigned long long)target);
+      return false;
+    }
+    if(length < MIN_FILL * (double)std::min(target, lossless))
+    {
+      fprintf(stderr, "%s: ratio %.1f gave %llu bytes, far below the %llu byte target\n",
+              c.label, ratio, (unsigned long long)length, (unsigned long long)target);
+      return false;
+    }
+    double psnr = decompressPSNR(codestream, samples);
+    if(psnr < 0)
+    {
+      fprintf(stderr, "%s: ratio %.1f does not decompress\n", c.label, ratio);
+      return false;
+    }
+    // the Part-1 reference gets the HT code stream's size as its target
+    std::vector<uint8_t> reference;
+    Case part1 = c;
+    part1.maxCodestreamSize = true;
+    double part1PSNR =
+        compress(part1, samples, (double)imageBytes(c.numComps) / (double)length, reference,
+                 false)
+            ? decompressPSNR(reference, samples)
+            : -1;
+    if(part1PSNR < 0)
+    {
+      fprintf(stderr, "%s: Part-1 reference at ratio %.1f failed\n", c.label, ratio);
+      return false;
+    }
+    if(psnr < part1PSNR - MAX_PSNR_LOSS)
+    {
+      fprintf(stderr, "%s: ratio %.1f gave %.2f dB, Part-1 gives %.2f dB at the same size\n",
+              c.label, ratio, psnr, part1PSNR);
+      return false;
+    }
+    if(psnr < prevPSNR)
+    {
+      fprintf(stderr, "%s: PSNR fell from %.2f to %.2f dB at ratio %.1f\n", c.label, prevPSNR,
+              psnr, ratio);
+      return false;
+    }
+    printf("%s: ratio %.1f: %llu of %llu bytes, %.2f dB (Part-1 %.2f dB)\n", c.label, ratio,
+           (unsigned long long)length, (unsigned long long)target, psnr, part1PSNR);
+    prevPSNR = psnr;
+  }
+  return true;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  // ratios in descending order, so that each target is larger than the last
+  const Case cases[] = {
+      {"reversible_gray", 1, false, false, {40, 20, 10, 5}},
+      {"irreversible_rgb", 3, true, false, {80, 40, 20, 10}},
+      {"irreversible_max_cs_size", 1, true, true, {30, 15, 8}},
+      {"reversible_tight", 1, false, false, {300, 150}},
+      {"irreversible_tight_max_cs_size", 3, true, true, {600, 300}},
+  };
+  bool ok = true;
+  for(const auto& c : cases)
+    ok = check(c) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
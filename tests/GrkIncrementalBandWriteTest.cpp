@@ -61,35 +61,66 @@ int decompressToTiff(const std::string& input, const std::string& output)
   return grk_codec_decompress(5, argv);
 }
 
-// a decompress region turns off the incremental band write, so the same pixels
-// travel through the whole-image writer instead
-int decompressRegionToTiff(const std::string& input, const std::string& region,
-                           const std::string& output)
+// a precision option makes post-processing more than a no-op, which turns the
+// incremental band write off, so the same pixels travel through the whole-image
+// writer instead.  Scaling to the codestream's own precision leaves them unchanged.
+int decompressWholeToTiff(const std::string& input, uint8_t precision,
+                          const std::string& output)
 {
+  std::string precisionArg = std::to_string(precision) + "S";
   const char* argv[] = {"grk_decompress", "-i", input.c_str(), "-o",
-                        output.c_str(),   "-d", region.c_str()};
+                        output.c_str(),   "-p", precisionArg.c_str()};
   return grk_codec_decompress(7, argv);
 }
+
+bool readPrecision(const std::string& input, uint8_t* precision)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", input.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool rc = grk_decompress_read_header(codec, &headerInfo);
+  if(rc)
+  {
+    auto image = grk_decompress_get_image(codec);
+    rc = image && image->numcomps;
+    if(rc)
+      *precision = image->comps[0].prec;
+  }
+  grk_object_unref(codec);
+
+  return rc;
+}
 } // namespace
 
 int main(int argc, char** argv)
 {
-  if(argc < 3)
+  if(argc < 2)
   {
-    fprintf(stderr, "Usage: %s <codestream> <x0,y0,x1,y1 covering the whole image>\n", argv[0]);
+    fprintf(stderr, "Usage: %s <codestream>\n", argv[0]);
     return EXIT_FAILURE;
   }
   std::string input = argv[1];
-  std::string region = argv[2];
   std::string bandTiff = outputNameFor(input, "_band.tif");
   std::string wholeTiff = outputNameFor(input, "_whole.tif");
 
+  grk_initialize(nullptr, 0, nullptr);
+  uint8_t precision = 0;
+  if(!readPrecision(input, &precision))
+  {
+    fprintf(stderr, "%s: could not read the codestream header\n", input.c_str());
+    return EXIT_FAILURE;
+  }
   if(decompressToTiff(input, bandTiff) != EXIT_SUCCESS)
   {
     fprintf(stderr, "%s: incremental band write decompress failed\n", input.c_str());
     return EXIT_FAILURE;
   }
-  if(decompressRegionToTiff(input, region, wholeTiff) != EXIT_SUCCESS)
+  if(decompressWholeToTiff(input, precision, wholeTiff) != EXIT_SUCCESS)
   {
     fprintf(stderr, "%s: whole image decompress failed\n", input.c_str());
     return EXIT_FAILURE;
@@ -0,0 +1,273 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// with GRK_TILE_CACHE_ALL, raising a tile's layer budget one layer at a time resumes
+// its code blocks from their retained coder state, and blocks that gain no coding
+// passes only write out their retained coefficients. After every step the tile must
+// match a fresh decode of the same number of layers, for Part-1 and HT code blocks.
+// One tile is flat, so its later layers carry no coding passes at all. Another is a
+// fine checkerboard under a smooth envelope: nearly all of its energy sits in the
+// highest resolution, so its later layers leave the lower resolutions alone and they
+// are restored from the last decode instead of being synthesized again.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 211;
+const uint32_t IMAGE_HEIGHT = 167;
+const uint32_t TILE_WIDTH = 128;
+const uint32_t TILE_HEIGHT = 96;
+const uint16_t NUM_COMPS = 3;
+const uint16_t NUM_LAYERS = 4;
+const uint8_t NUM_RESOLUTIONS = 4;
+
+struct Config
+{
+  const char* label;
+  bool irreversible;
+  bool ht;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = 8;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        // the top left tile is flat, the top right one a checkerboard, the others textured
+        int32_t value = 90 + compno * 40;
+        if(x >= TILE_WIDTH && y < TILE_HEIGHT)
+        {
+          double envelope = 30.0 + 15.0 * std::sin(x / 7.0 + compno) * std::cos(y / 5.0);
+          value = 128 + (int32_t)std::lrint(((x + y) & 1) ? envelope : -envelope);
+        }
+        else if(x >= TILE_WIDTH || y >= TILE_HEIGHT)
+        {
+          uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 26;
+          value = (int32_t)((x * 3U + y * (2U + compno) + noise) & 0xFF);
+        }
+        data[(size_t)y * stride + x] = value;
+      }
+    }
+  }
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage();
+  if(!image)
+  {
+    fprintf(stderr, "%s: could not build the source image\n", config.label);
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.irreversible = config.irreversible;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_WIDTH;
+  parameters.t_height = TILE_HEIGHT;
+  parameters.numlayers = NUM_LAYERS;
+  parameters.allocation_by_rate_distortion = true;
+  for(uint16_t i = 0; i < NUM_LAYERS; ++i)
+    parameters.layer_rate[i] = (double)(40 - i * 9);
+  if(config.ht)
+    parameters.cblk_sty = GRK_CBLKSTY_HT_ONLY;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+grk_object* openCodec(const std::string& path, uint16_t layers, uint32_t tileCacheStrategy,
+                      grk_header_info& headerInfo)
+{
+  grk_decompress_parameters params = {};
+  params.core.layers_to_decompress = layers;
+  params.core.tile_cache_strategy = tileCacheStrategy;
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return nullptr;
+  if(!grk_decompress_read_header(codec, &headerInfo))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  return codec;
+}
+
+bool capture(grk_object* codec, uint16_t tileIndex, std::vector<int32_t>& out)
+{
+  if(!grk_decompress_tile(codec, tileIndex))
+    return false;
+  grk_image* image = grk_decompress_get_tile_image(codec, tileIndex, true);
+  if(!image || image->numcomps != NUM_COMPS)
+    return false;
+  out.clear();
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    const auto& comp = image->comps[compno];
+    if(!comp.data)
+      return false;
+    for(uint32_t y = 0; y < comp.h; ++y)
+      for(uint32_t x = 0; x < comp.w; ++x)
+        out.push_back(sampleAt(comp, (uint64_t)y * comp.stride + x));
+  }
+  return true;
+}
+
+bool check(const Config& config)
+{
+  std::string path = std::string("incremental_layers_") + config.label + ".j2k";
+  if(!compress(path, config))
+    return false;
+  const uint16_t numTiles = (uint16_t)(((IMAGE_WIDTH + TILE_WIDTH - 1) / TILE_WIDTH) *
+                                       ((IMAGE_HEIGHT + TILE_HEIGHT - 1) / TILE_HEIGHT));
+
+  // reference[layers - 1][tile] comes from a fresh codec for every layer count
+  std::vector<std::vector<std::vector<int32_t>>> reference(NUM_LAYERS);
+  bool ok = true;
+  for(uint16_t layers = 1; ok && layers <= NUM_LAYERS; ++layers)
+  {
+    grk_header_info headerInfo = {};
+    grk_object* codec = openCodec(path, layers, GRK_TILE_CACHE_IMAGE, headerInfo);
+    ok = codec != nullptr;
+    reference[layers - 1].resize(numTiles);
+    for(uint16_t t = 0; ok && t < numTiles; ++t)
+      ok = capture(codec, t, reference[layers - 1][t]);
+    if(!ok)
+      fprintf(stderr, "%s: reference decode of %u layers failed\n", config.label, layers);
+    grk_object_unref(codec);
+  }
+
+  grk_header_info headerInfo = {};
+  grk_object* codec =
+      ok ? openCodec(path, 1, GRK_TILE_CACHE_IMAGE | GRK_TILE_CACHE_ALL, headerInfo) : nullptr;
+  if(ok && !codec)
+  {
+    fprintf(stderr, "%s: could not open the progressive codec\n", config.label);
+    ok = false;
+  }
+  for(uint16_t t = 0; ok && t < numTiles; ++t)
+  {
+    std::vector<int32_t> samples;
+    for(uint16_t layers = 1; ok && layers <= NUM_LAYERS; ++layers)
+    {
+      if(layers > 1)
+      {
+        grk_progression_state state = {};
+        state.single_tile = true;
+        state.tile_index = t;
+        state.num_resolutions = headerInfo.numresolutions;
+        for(uint8_t r = 0; r < state.num_resolutions; ++r)
+          state.layers_per_resolution[r] = layers;
+        if(!grk_decompress_set_progression_state(codec, state))
+        {
+          fprintf(stderr, "%s: tile %u: could not raise the layer budget to %u\n", config.label,
+                  t, layers);
+          ok = false;
+          break;
+        }
+      }
+      if(!capture(codec, t, samples))
+      {
+        fprintf(stderr, "%s: tile %u: decode of %u layers failed\n", config.label, t, layers);
+        ok = false;
+      }
+      else if(samples != reference[layers - 1][t])
+      {
+        fprintf(stderr, "%s: tile %u: %u incremental layers differ from a fresh decode\n",
+                config.label, t, layers);
+        ok = false;
+      }
+    }
+  }
+  grk_object_unref(codec);
+  if(ok)
+    printf("%s: %u tiles match fresh decodes at every layer\n", config.label, numTiles);
+  remove(path.c_str());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"reversible", false, false},
+      {"irreversible", true, false},
+      {"ht_reversible", false, true},
+      {"ht_irreversible", true, true},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -21,8 +21,11 @@
 #include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <filesystem>
+#include <optional>
+#include <utility>
 
 #include "grk_apps_config.h"
 #include "grok.h"
@@ -32,6 +35,8 @@
 // Self-contained cache headers for unit testing
 #include "LRUCache.h"
 #include "DiskCache.h"
+#include "EnvVarManager.h"
+#include "SharedTilePartCache.h"
 #include "SelectiveFetchRanges.h"
 
 template<size_t N>
@@ -419,6 +424,188 @@ static bool testLRUCacheEviction()
   return true;
 }
 
+///////////////////////////////////////////////////////////////////
+// Test 3a: byte counts from GRK_CACHEMAX-style environment variables
+///////////////////////////////////////////////////////////////////
+static bool testEnvSize()
+{
+  spdlog::info("=== Test: EnvVarManager::get_size ===");
+
+  const char* name = "GRK_TEST_ENV_SIZE";
+  const std::pair<const char*, std::optional<uint64_t>> cases[] = {
+      {"268435456", 268435456ULL},
+      {"256M", 256ULL << 20},
+      {"256MB", 256ULL << 20},
+      {"1g", 1ULL << 30},
+      {"1GB", 1ULL << 30},
+      {"0", 0ULL},
+      {"MB", std::nullopt},
+      {"lots", std::nullopt},
+      {"12X", std::nullopt},
+      {"-5", std::nullopt},
+  };
+  bool ok = true;
+  for(const auto& [value, expected] : cases)
+  {
+#ifdef _WIN32
+    _putenv_s(name, value);
+#else
+    setenv(name, value, 1);
+#endif
+    auto bytes = EnvVarManager::get_size(name);
+    if(bytes != expected)
+    {
+      spdlog::error("get_size(\"{}\") returned {}, expected {}", value,
+                    bytes ? std::to_string(*bytes) : "nothing",
+                    expected ? std::to_string(*expected) : "nothing");
+      ok = false;
+    }
+  }
+#ifdef _WIN32
+  _putenv_s(name, "");
+#else
+  unsetenv(name);
+#endif
+  if(EnvVarManager::get_size(name))
+  {
+    spdlog::error("get_size returned a value for an unset variable");
+    ok = false;
+  }
+  if(ok)
+    spdlog::info("PASS: EnvVarManager::get_size");
+
+  return ok;
+}
+
+///////////////////////////////////////////////////////////////////
+// Test 3b: SharedTilePartCache lookup, budget and fetch coalescing
+///////////////////////////////////////////////////////////////////
+static bool testSharedTilePartCache()
+{
+  spdlog::info("=== Test: SharedTilePartCache ===");
+
+  auto makeBuffer = [](size_t len, uint8_t value) {
+    std::shared_ptr<uint8_t[]> buf(new uint8_t[len]);
+    std::memset(buf.get(), value, len);
+    return buf;
+  };
+
+  SharedTilePartCache cache(4096);
+  SharedTilePartKey key{"https://host/a.jp2|1000|\"v1\"", 3, 0, 120, 1000};
+  if(cache.get(key))
+  {
+    spdlog::error("SharedTilePartCache returned data for an empty cache");
+    return false;
+  }
+  auto buf = makeBuffer(1000, 7);
+  cache.put(key, buf);
+  auto hit = cache.get(key);
+  if(hit.get() != buf.get())
+  {
+    spdlog::error("SharedTilePartCache did not share the stored buffer");
+    return false;
+  }
+
+  // a new version of the resource must not see the old bytes
+  auto stale = key;
+  stale.identity = "https://host/a.jp2|1000|\"v2\"";
+  if(cache.get(stale))
+  {
+    spdlog::error("SharedTilePartCache matched a different resource version");
+    return false;
+  }
+
+  // filling past the budget evicts the oldest tile part
+  for(uint16_t tile = 4; tile < 8; ++tile)
+  {
+    SharedTilePartKey next{key.identity, tile, 0, 1120u + tile * 1000u, 1000};
+    cache.put(next, makeBuffer(1000, (uint8_t)tile));
+  }
+  if(cache.currentBytes() > 4096 || cache.get(key))
+  {
+    spdlog::error("SharedTilePartCache exceeded its budget: {} bytes", cache.currentBytes());
+    return false;
+  }
+  // evicted entries stay alive while a codec still holds them
+  if(hit[999] != 7)
+  {
+    spdlog::error("SharedTilePartCache eviction invalidated a held buffer");
+    return false;
+  }
+
+  // concurrent misses on one tile coalesce into a single owner
+  std::shared_future<bool> inFlight;
+  uint64_t ticket = 0;
+  if(!cache.claim(key.identity, 3, inFlight, ticket))
+  {
+    spdlog::error("SharedTilePartCache refused the first claim");
+    return false;
+  }
+  const int numWaiters = 4;
+  std::atomic<int> owners{0};
+  std::atomic<int> woken{0};
+  std::vector<std::thread> waiters;
+  for(int i = 0; i < numWaiters; ++i)
+  {
+    waiters.emplace_back([&cache, &key, &owners, &woken]() {
+      std::shared_future<bool> other;
+      uint64_t otherTicket = 0;
+      if(cache.claim(key.identity, 3, other, otherTicket))
+      {
+        owners++;
+        cache.release(key.identity, 3, otherTicket, false);
+        return;
+      }
+      if(other.get() && cache.get(key))
+        woken++;
+    });
+  }
+  // publish only once every waiter has found the tile in flight
+  while(cache.coalesced() < (uint64_t)numWaiters && owners == 0)
+    std::this_thread::yield();
+  cache.put(key, buf);
+  cache.release(key.identity, 3, ticket, true);
+  for(auto& t : waiters)
+    t.join();
+  if(owners != 0 || woken != numWaiters || cache.coalesced() != (uint64_t)numWaiters)
+  {
+    spdlog::error("SharedTilePartCache coalescing: {} extra owners, {} of {} waiters served",
+                  owners.load(), woken.load(), numWaiters);
+    return false;
+  }
+
+  // a released claim can be taken again, and releasing twice is harmless
+  cache.release(key.identity, 3, ticket, false);
+  uint64_t staleTicket = ticket;
+  if(!cache.claim(key.identity, 3, inFlight, ticket))
+  {
+    spdlog::error("SharedTilePartCache did not free a released claim");
+    return false;
+  }
+  // releasing an ended claim leaves the tile's new claim in place
+  cache.release(key.identity, 3, staleTicket, false);
+  std::shared_future<bool> stillInFlight;
+  uint64_t otherTicket = 0;
+  if(cache.claim(key.identity, 3, stillInFlight, otherTicket))
+  {
+    spdlog::error("SharedTilePartCache released a claim with an ended claim's ticket");
+    return false;
+  }
+  cache.release(key.identity, 3, ticket, false);
+
+  // a zero budget disables the cache
+  SharedTilePartCache disabled(0);
+  disabled.put(key, buf);
+  if(disabled.enabled() || disabled.get(key))
+  {
+    spdlog::error("Disabled SharedTilePartCache stored data");
+    return false;
+  }
+
+  spdlog::info("PASS: SharedTilePartCache");
+  return true;
+}
+
 ///////////////////////////////////////////////////////////////////
 // Test 4: LRU eviction + re-decompress from cached SOT offsets
 //
@@ -2579,6 +2766,128 @@ static bool testSelectiveFetchSimulation()
   return pass;
 }
 
+///////////////////////////////////////////////////////////////////
+// Test 20: Precinct-granular selective fetch planning
+//
+// Tests planSelectiveFetch() with layer, component and precinct
+// selections. Verifies that:
+// - Only packets of kept layers/components are fetched
+// - Gap coalescing flags the packets it pulls in as fetched
+// - Window precinct masks select the right precincts
+// - Position progressions with several precincts produce no plan
+///////////////////////////////////////////////////////////////////
+static bool testSelectiveFetchPlan()
+{
+  using namespace grk;
+  spdlog::info("=== Test: Precinct-granular selective fetch planning ===");
+
+  bool pass = true;
+
+  // LRCP: 2 components, 2 layers, 2 resolutions, 1 precinct per res
+  // Packet order: L0[R0(C0,C1), R1(C0,C1)], L1[R0(C0,C1), R1(C0,C1)]
+  // Keeping layer 0 of component 0 → packets 0 and 2
+  {
+    TilePacketInfo info;
+    info.progression = GRK_LRCP;
+    info.numComponents = 2;
+    info.numLayers = 2;
+    info.numResolutions = {2, 2};
+    info.precinctsPerRes = {{1, 1}, {1, 1}};
+    info.pltLengths = {10, 10, 10, 10, 10, 10, 10, 10};
+
+    PacketSelection selection;
+    selection.layersToDecompress = 1;
+    selection.components = {true, false};
+
+    auto plan = planSelectiveFetch(info, selection);
+    std::vector<bool> expected = {true, false, true, false, false, false, false, false};
+    if(plan.ranges.size() != 2 || plan.ranges[0].offset != 0 || plan.ranges[0].length != 10 ||
+       plan.ranges[1].offset != 20 || plan.ranges[1].length != 10 ||
+       plan.fetchedPackets != expected || plan.totalBytes != 80)
+    {
+      spdlog::error("FAIL: LRCP layer+component: expected [0,10) [20,30), got {} ranges",
+                    plan.ranges.size());
+      pass = false;
+    }
+
+    // a 10 byte gap threshold merges both ranges, pulling in packet 1
+    plan = planSelectiveFetch(info, selection, 10);
+    expected = {true, true, true, false, false, false, false, false};
+    if(plan.ranges.size() != 1 || plan.ranges[0].length != 30 || plan.fetchedPackets != expected)
+    {
+      spdlog::error("FAIL: LRCP gap merge: expected [0,30) with packets 0-2 fetched");
+      pass = false;
+    }
+  }
+
+  // Window precincts: 256x256 tile, 1 resolution, 128x128 precincts → 2x2 grid
+  {
+    auto mask = computeWindowPrecincts(0, 0, 256, 256, 1, 0, 7, 7, 0, 0, 64, 64, 0);
+    std::vector<bool> expected = {true, false, false, false};
+    if(mask != expected)
+    {
+      spdlog::error("FAIL: window precincts: expected only precinct 0");
+      pass = false;
+    }
+    // window straddling the vertical precinct boundary
+    auto straddle = computeWindowPrecincts(0, 0, 256, 256, 1, 0, 7, 7, 120, 0, 140, 64, 0);
+    expected = {true, true, false, false};
+    if(straddle != expected)
+    {
+      spdlog::error("FAIL: window precincts: expected precincts 0 and 1");
+      pass = false;
+    }
+
+    // RLCP: 1 component, 1 layer, 1 resolution, 4 precincts
+    TilePacketInfo info;
+    info.progression = GRK_RLCP;
+    info.numComponents = 1;
+    info.numLayers = 1;
+    info.numResolutions = {1};
+    info.precinctsPerRes = {{4}};
+    info.pltLengths = {10, 20, 30, 40};
+
+    PacketSelection selection;
+    selection.precincts = {{straddle}};
+    auto plan = planSelectiveFetch(info, selection);
+    if(plan.ranges.size() != 1 || plan.ranges[0].offset != 0 || plan.ranges[0].length != 30 ||
+       plan.fetchBytes() != 30)
+    {
+      spdlog::error("FAIL: RLCP precincts: expected [0,30), got {} ranges", plan.ranges.size());
+      pass = false;
+    }
+  }
+
+  // PCRL with several precincts per resolution: packet order depends on
+  // precinct positions, so no plan is produced
+  {
+    TilePacketInfo info;
+    info.progression = GRK_PCRL;
+    info.numComponents = 1;
+    info.numLayers = 1;
+    info.numResolutions = {2};
+    info.precinctsPerRes = {{1, 4}};
+    info.pltLengths = {10, 10, 10, 10, 10};
+
+    PacketSelection selection;
+    selection.resolutionsToDecompress = 1;
+    auto plan = planSelectiveFetch(info, selection);
+    if(!plan.ranges.empty())
+    {
+      spdlog::error("FAIL: PCRL multi-precinct: expected no plan, got {} ranges",
+                    plan.ranges.size());
+      pass = false;
+    }
+  }
+
+  if(pass)
+    spdlog::info("PASS: Precinct-granular selective fetch planning");
+  else
+    spdlog::error("FAIL: Precinct-granular selective fetch planning");
+
+  return pass;
+}
+
 ///////////////////////////////////////////////////////////////////
 // Main
 ///////////////////////////////////////////////////////////////////
@@ -2593,6 +2902,10 @@ int GrkLRUCacheTest::main(int argc, char** argv)
     failures++;
   if(!testLRUCacheEviction())
     failures++;
+  if(!testEnvSize())
+    failures++;
+  if(!testSharedTilePartCache())
+    failures++;
 
   // Integration test: compress a test image and verify LRU output
   std::string testFile = (std::filesystem::temp_directory_path() / "grk_lru_test.j2k").string();
@@ -2745,6 +3058,10 @@ int GrkLRUCacheTest::main(int argc, char** argv)
   if(!testSelectiveFetchSimulation())
     failures++;
 
+  // Test 20: Precinct-granular selective fetch planning
+  if(!testSelectiveFetchPlan())
+    failures++;
+
   if(failures > 0)
   {
     spdlog::error("{} test(s) FAILED", failures);
@@ -0,0 +1,210 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// An RCT code stream that carries no packets for its third component can not undo the
+// colour transform, but the two components it does carry must still come out DC
+// shifted. The stream is compressed in CPRL with one tile part per component, and the
+// last tile part is dropped. Lossless 5/3 then gives back the luma and blue difference
+// of the RCT exactly, shifted to unsigned samples.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint16_t NUM_COMPS = 3;
+const uint32_t WIDTH = 64;
+const uint32_t HEIGHT = 48;
+const uint8_t NUM_RESOLUTIONS = 3;
+const uint16_t SOT = 0xFF90;
+const uint16_t EOC = 0xFFD9;
+
+void discardLog(const char*, void*) {}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = WIDTH;
+    p.h = HEIGHT;
+    p.prec = 8;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  for(uint32_t y = 0; y < HEIGHT; ++y)
+  {
+    for(uint32_t x = 0; x < WIDTH; ++x)
+    {
+      uint32_t noise = ((x * 2654435761U) ^ (y * 40503U)) >> 27;
+      int32_t green = (int32_t)(40 + x * 2 + y);
+      // blue stays within 16 of green, so that no shifted difference needs a clamp
+      int32_t rgb[NUM_COMPS] = {(int32_t)((x * 5 + y * 3) & 255), green,
+                                green + (int32_t)noise - 16};
+      for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+      {
+        auto comp = image->comps + compno;
+        ((int32_t*)comp->data)[(size_t)y * comp->stride + x] = rgb[compno];
+      }
+    }
+  }
+  return image;
+}
+
+uint64_t compress(grk_image* image, std::vector<uint8_t>& out)
+{
+  grk_cparameters parameters;
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.mct = 1;
+  parameters.prog_order = GRK_CPRL;
+  parameters.enable_tile_part_generation = true;
+  parameters.new_tile_part_progression_divider = 'C';
+
+  out.assign((size_t)NUM_COMPS * WIDTH * HEIGHT * 2 + 4096, 0);
+  grk_stream_params streamParams = {};
+  streamParams.buf = out.data();
+  streamParams.buf_len = out.size();
+  uint64_t length = 0;
+  auto codec = grk_compress_init(&streamParams, &parameters, image);
+  if(codec)
+    length = grk_compress(codec, nullptr);
+  grk_object_unref(codec);
+  out.resize(length);
+
+  return length;
+}
+
+uint16_t readMarker(const std::vector<uint8_t>& file, size_t pos)
+{
+  return (uint16_t)((file[pos] << 8) | file[pos + 1]);
+}
+
+// keeps the tile parts of the first two components, and ends the code stream after them
+bool dropLastTilePart(std::vector<uint8_t>& file)
+{
+  size_t pos = 0;
+  while(pos + 1 < file.size() && readMarker(file, pos) != SOT)
+    ++pos;
+  std::vector<size_t> tileParts;
+  while(pos + 12 <= file.size() && readMarker(file, pos) == SOT)
+  {
+    tileParts.push_back(pos);
+    uint32_t psot = ((uint32_t)file[pos + 6] << 24) | ((uint32_t)file[pos + 7] << 16) |
+                    ((uint32_t)file[pos + 8] << 8) | file[pos + 9];
+    if(psot == 0)
+      break;
+    pos += psot;
+  }
+  if(tileParts.size() != NUM_COMPS)
+  {
+    fprintf(stderr, "expected %u tile parts, found %zu\n", NUM_COMPS, tileParts.size());
+    return false;
+  }
+  // TNsot of the tile parts that are kept
+  for(size_t i = 0; i + 1 < tileParts.size(); ++i)
+    file[tileParts[i] + 11] = (uint8_t)(NUM_COMPS - 1);
+  file.resize(tileParts.back());
+  file.push_back((uint8_t)(EOC >> 8));
+  file.push_back((uint8_t)(EOC & 0xFF));
+
+  return true;
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint32_t x, uint32_t y)
+{
+  size_t index = (size_t)y * comp.stride + x;
+  if(comp.data_type == GRK_INT_16)
+    return ((int16_t*)comp.data)[index];
+  return ((int32_t*)comp.data)[index];
+}
+
+bool checkShifted(std::vector<uint8_t>& file, const grk_image* source)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  streamParams.buf = file.data();
+  streamParams.buf_len = file.size();
+  auto codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool ok = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+  auto image = ok ? grk_decompress_get_image(codec) : nullptr;
+  ok = image && image->numcomps == NUM_COMPS && image->comps[0].data && image->comps[1].data;
+  if(!ok)
+    fprintf(stderr, "decompress failed\n");
+  for(uint32_t y = 0; ok && y < HEIGHT; ++y)
+  {
+    for(uint32_t x = 0; x < WIDTH; ++x)
+    {
+      int32_t rgb[NUM_COMPS];
+      for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+      {
+        auto comp = source->comps + compno;
+        rgb[compno] = ((int32_t*)comp->data)[(size_t)y * comp->stride + x];
+      }
+      int32_t luma = (rgb[0] + 2 * rgb[1] + rgb[2]) >> 2;
+      int32_t blueDifference = rgb[2] - rgb[1] + 128;
+      int32_t gotLuma = sampleAt(image->comps[0], x, y);
+      int32_t gotBlueDifference = sampleAt(image->comps[1], x, y);
+      if(gotLuma != luma || gotBlueDifference != blueDifference)
+      {
+        fprintf(stderr, "(%u,%u): got %d and %d, expected shifted %d and %d\n", x, y, gotLuma,
+                gotBlueDifference, luma, blueDifference);
+        ok = false;
+        break;
+      }
+    }
+  }
+  grk_object_unref(codec);
+
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.warn_callback = discardLog;
+  grk_set_msg_handlers(handlers);
+  auto image = makeImage();
+  std::vector<uint8_t> file;
+  bool ok = image && compress(image, file) != 0;
+  if(!ok)
+    fprintf(stderr, "compress failed\n");
+  ok = ok && dropLastTilePart(file) && checkShifted(file, image);
+  if(ok)
+    printf("components decoded without the colour transform are DC shifted\n");
+  if(image)
+    grk_object_unref(&image->obj);
+  grk_deinitialize();
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
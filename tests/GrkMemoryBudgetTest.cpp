@@ -0,0 +1,257 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// grk_decompress_core_params::memory_budget_bytes throttles how many tiles are in
+// flight, and evicts cached tile coefficients, but never changes the output or fails
+// a decompress. A decompress with a budget far below the unbudgeted high-water mark
+// must match the unbudgeted one and peak no higher, with and without GRK_TILE_CACHE_ALL.
+// Concurrent tryCharge() calls on nested budgets must never take either past its limit.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "grok.h"
+#include "MemoryBudget.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 389;
+const uint32_t IMAGE_HEIGHT = 317;
+const uint32_t TILE_WIDTH = 64;
+const uint32_t TILE_HEIGHT = 64;
+const uint16_t NUM_COMPS = 3;
+const uint8_t NUM_RESOLUTIONS = 4;
+
+struct Result
+{
+  std::vector<int32_t> samples;
+  grk_memory_budget_stats stats = {};
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+bool compress(const std::string& path)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = 8;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return false;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 26;
+        data[(size_t)y * stride + x] = (int32_t)((x * 3U + y * (2U + compno) + noise) & 0xFF);
+      }
+    }
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_WIDTH;
+  parameters.t_height = TILE_HEIGHT;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+bool decompress(const std::string& path, uint32_t tileCacheStrategy, uint64_t budget,
+                Result& result)
+{
+  grk_decompress_parameters params = {};
+  params.core.tile_cache_strategy = tileCacheStrategy;
+  params.core.memory_budget_bytes = budget;
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool ok = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+  grk_image* image = ok ? grk_decompress_get_image(codec) : nullptr;
+  ok = image && image->numcomps == NUM_COMPS &&
+       grk_decompress_get_memory_budget_stats(codec, &result.stats);
+  result.samples.clear();
+  for(uint16_t compno = 0; ok && compno < NUM_COMPS; ++compno)
+  {
+    const auto& comp = image->comps[compno];
+    if(!comp.data)
+    {
+      ok = false;
+      break;
+    }
+    for(uint32_t y = 0; y < comp.h; ++y)
+      for(uint32_t x = 0; x < comp.w; ++x)
+        result.samples.push_back(sampleAt(comp, (uint64_t)y * comp.stride + x));
+  }
+  grk_object_unref(codec);
+  return ok;
+}
+
+bool check(const char* label, const std::string& path, uint32_t tileCacheStrategy)
+{
+  Result reference, budgeted;
+  if(!decompress(path, tileCacheStrategy, 0, reference))
+  {
+    fprintf(stderr, "%s: unbudgeted decompress failed\n", label);
+    return false;
+  }
+  if(!reference.stats.high_water)
+  {
+    fprintf(stderr, "%s: no bytes were charged\n", label);
+    return false;
+  }
+  uint64_t budget = (std::max)(reference.stats.high_water / 16, (uint64_t)1);
+  if(!decompress(path, tileCacheStrategy, budget, budgeted))
+  {
+    fprintf(stderr, "%s: decompress with a %llu byte budget failed\n", label,
+            (unsigned long long)budget);
+    return false;
+  }
+  if(budgeted.samples != reference.samples)
+  {
+    fprintf(stderr, "%s: budgeted decompress differs from the unbudgeted one\n", label);
+    return false;
+  }
+  if(budgeted.stats.limit != budget)
+  {
+    fprintf(stderr, "%s: limit is %llu, expected %llu\n", label,
+            (unsigned long long)budgeted.stats.limit, (unsigned long long)budget);
+    return false;
+  }
+  // a tile over the budget only starts once nothing else is in flight, so the peak
+  // is at most the larger of the budget and one tile
+  if(budgeted.stats.high_water > reference.stats.high_water)
+  {
+    fprintf(stderr, "%s: budgeted high-water mark %llu exceeds the unbudgeted %llu\n", label,
+            (unsigned long long)budgeted.stats.high_water,
+            (unsigned long long)reference.stats.high_water);
+    return false;
+  }
+  if(budgeted.stats.process_high_water < budgeted.stats.high_water)
+  {
+    fprintf(stderr, "%s: process high-water mark is below the codec's\n", label);
+    return false;
+  }
+  printf("%s: high-water mark %llu bytes unbudgeted, %llu with a %llu byte budget\n", label,
+         (unsigned long long)reference.stats.high_water,
+         (unsigned long long)budgeted.stats.high_water, (unsigned long long)budget);
+  return true;
+}
+bool checkConcurrentCharges(void)
+{
+  constexpr uint64_t parentLimit = 500;
+  constexpr uint64_t childLimit = 300;
+  constexpr uint64_t bytes = 100;
+  grk::MemoryBudget parent(parentLimit);
+  grk::MemoryBudget children[] = {grk::MemoryBudget(childLimit, &parent),
+                                  grk::MemoryBudget(childLimit, &parent)};
+  std::vector<std::thread> threads;
+  for(uint32_t t = 0; t < 16; ++t)
+  {
+    threads.emplace_back([&children, t] {
+      auto& child = children[t & 1];
+      for(uint32_t i = 0; i < 2000; ++i)
+      {
+        if(!child.tryCharge(bytes))
+          continue;
+        std::this_thread::yield();
+        child.release(bytes);
+      }
+    });
+  }
+  for(auto& thread : threads)
+    thread.join();
+  bool ok = true;
+  for(const auto& child : children)
+  {
+    if(child.highWater() > childLimit)
+    {
+      fprintf(stderr, "concurrent charges took a budget to %llu bytes, limit %llu\n",
+              (unsigned long long)child.highWater(), (unsigned long long)childLimit);
+      ok = false;
+    }
+  }
+  if(parent.highWater() > parentLimit || parent.used())
+  {
+    fprintf(stderr, "concurrent charges took the parent to %llu bytes, limit %llu, %llu left\n",
+            (unsigned long long)parent.highWater(), (unsigned long long)parentLimit,
+            (unsigned long long)parent.used());
+    ok = false;
+  }
+  if(ok)
+    printf("concurrent charges: high-water marks %llu and %llu, parent %llu\n",
+           (unsigned long long)children[0].highWater(),
+           (unsigned long long)children[1].highWater(), (unsigned long long)parent.highWater());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const std::string path = "memory_budget.j2k";
+  bool ok = checkConcurrentCharges();
+  ok = compress(path) && ok;
+  if(!ok)
+    fprintf(stderr, "compress failed\n");
+  ok = ok && check("no_cache", path, GRK_TILE_CACHE_NONE);
+  ok = ok && check("cache_all", path, GRK_TILE_CACHE_ALL);
+  remove(path.c_str());
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
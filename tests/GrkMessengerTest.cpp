@@ -323,9 +323,10 @@ static void testMessengerSendVariadic()
   auto proc = [](const std::string&) {};
   MessengerInit init(true, "outBuf", "outSent", "outReady", "inBuf", "inSent", "inReady", proc, 0,
                      0, 0, 0);
+  init.transport_ = MESSENGER_TRANSPORT_SEMAPHORE;
   // construct but do not start threads (isClient with 0 frames means no server init)
   Messenger m(init);
-  m.send(GRK_MSGR_BATCH_SUBMIT_UNCOMPRESSED, 42, 7);
+  TEST_ASSERT(m.send(GRK_MSGR_BATCH_SUBMIT_UNCOMPRESSED, 42, 7), "send should succeed");
 
   std::string msg;
   TEST_ASSERT(m.sendQueue.pop(msg), "sendQueue should have a message");
@@ -339,8 +340,9 @@ static void testMessengerSendNoArgs()
   auto proc = [](const std::string&) {};
   MessengerInit init(true, "outBuf", "outSent", "outReady", "inBuf", "inSent", "inReady", proc, 0,
                      0, 0, 0);
+  init.transport_ = MESSENGER_TRANSPORT_SEMAPHORE;
   Messenger m(init);
-  m.send(GRK_MSGR_BATCH_SHUTDOWN);
+  TEST_ASSERT(m.send(GRK_MSGR_BATCH_SHUTDOWN), "send should succeed");
 
   std::string msg;
   TEST_ASSERT(m.sendQueue.pop(msg), "sendQueue should have a message");
@@ -348,6 +350,80 @@ static void testMessengerSendNoArgs()
   TEST_PASS("testMessengerSendNoArgs");
 }
 
+static void testMessengerSendDropped()
+{
+  // the ring refuses a message longer than a slot; send() must report the drop
+  auto proc = [](const std::string&) {};
+  MessengerInit init(true, "grk_test_send_out", "outSent", "outReady", "grk_test_send_in",
+                     "inSent", "inReady", proc, 0, 0, 0, 0);
+  init.transport_ = MESSENGER_TRANSPORT_RING;
+  // stand in for the server, which creates the ring the client maps
+  auto ringName = MessengerInit::ringName(init.outboundMessageBuf);
+  grk_handle ringFd = 0;
+  char* ringMem = nullptr;
+  TEST_ASSERT(SharedMemoryManager::initShm(ringName, MessengerRing::bytes(), &ringFd, &ringMem,
+                                           true),
+              "ring should be created");
+  bool sent = false;
+  bool dropped = false;
+  {
+    Messenger m(init);
+    sent = m.send(GRK_MSGR_BATCH_SHUTDOWN);
+    dropped = !m.send(std::string(MessengerRing::maxMessageLen + 1, 'x'));
+  }
+  SharedMemoryManager::deinitShm(ringName, MessengerRing::bytes(), ringFd, &ringMem);
+  TEST_ASSERT(sent, "send should succeed when the message fits the ring");
+  TEST_ASSERT(dropped, "send should fail when the ring drops the message");
+  TEST_PASS("testMessengerSendDropped");
+}
+
+/*************************** MessengerRing Tests *******************************/
+// producer and consumer threads on a heap-backed ring: every message arrives, in order,
+// including while the producer repeatedly fills the ring and has to wait
+static void testRingOrdering()
+{
+  std::vector<uint64_t> storage(MessengerRing::bytes() / sizeof(uint64_t) + 1, 0);
+  MessengerRing ring(reinterpret_cast<char*>(storage.data()));
+  std::atomic_bool running{true};
+  const uint32_t numMessages = 10 * MessengerRing::numSlots + 17;
+
+  std::thread producer([&] {
+    for(uint32_t i = 0; i < numMessages; ++i)
+      ring.push(GRK_MSGR_BATCH_SUBMIT_UNCOMPRESSED + "," + std::to_string(i), running);
+  });
+  bool inOrder = true;
+  for(uint32_t i = 0; i < numMessages && inOrder; ++i)
+  {
+    std::string message;
+    if(!ring.pop(message, running))
+      break;
+    Msg msg(message);
+    inOrder = msg.next() == GRK_MSGR_BATCH_SUBMIT_UNCOMPRESSED && msg.nextUint() == i;
+  }
+  running = false;
+  producer.join();
+  TEST_ASSERT(inOrder, "ring should deliver every message in order");
+  TEST_PASS("testRingOrdering");
+}
+
+static void testRingLimits()
+{
+  std::vector<uint64_t> storage(MessengerRing::bytes() / sizeof(uint64_t) + 1, 0);
+  MessengerRing ring(reinterpret_cast<char*>(storage.data()));
+  std::atomic_bool running{true};
+  std::string tooLong(MessengerRing::maxMessageLen + 1, 'x');
+  TEST_ASSERT(!ring.push(tooLong, running), "oversized message should be rejected");
+  std::string fits(MessengerRing::maxMessageLen, 'y');
+  TEST_ASSERT(ring.push(fits, running), "message filling a slot should be accepted");
+  std::string out;
+  TEST_ASSERT(ring.pop(out, running) && out == fits, "full-slot message should round trip");
+
+  // a stopped consumer on an empty ring returns instead of blocking
+  running = false;
+  TEST_ASSERT(!ring.pop(out, running), "pop on an empty stopped ring should fail");
+  TEST_PASS("testRingLimits");
+}
+
 /*************************** Uncompressed Frame Size *******************************/
 static void testUncompressedFrameSize()
 {
@@ -578,6 +654,12 @@ int GrkMessengerTest::main(int argc, char** argv)
   fprintf(stdout, "\n[Messenger::send]\n");
   testMessengerSendVariadic();
   testMessengerSendNoArgs();
+  testMessengerSendDropped();
+
+  // MessengerRing tests
+  fprintf(stdout, "\n[MessengerRing]\n");
+  testRingOrdering();
+  testRingLimits();
 
   // Utility tests
   fprintf(stdout, "\n[Utility]\n");
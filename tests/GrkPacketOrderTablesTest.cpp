@@ -0,0 +1,338 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Tiles of equal geometry share one packet order (GRK_NO_PACKET_ORDER_TABLES).
+// With the shared orders on, a code stream must be byte for byte the one each tile's own
+// PacketIter writes, and must decompress to the same pixels, for image and tile origins
+// off the grid, partial edge tiles, subsampled components, custom precincts, progression
+// order changes, several layers and every progression, at full and reduced resolution.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+void usePacketOrderTables(bool on)
+{
+#if defined(_WIN32)
+  _putenv_s("GRK_NO_PACKET_ORDER_TABLES", on ? "" : "1");
+#else
+  if(on)
+    unsetenv("GRK_NO_PACKET_ORDER_TABLES");
+  else
+    setenv("GRK_NO_PACKET_ORDER_TABLES", "1", 1);
+#endif
+}
+
+const uint16_t NUM_COMPS = 3;
+const uint16_t NUM_LAYERS = 3;
+const uint8_t NUM_RESOLUTIONS = 4;
+
+struct Config
+{
+  const char* label;
+  GRK_PROG_ORDER prog;
+  uint32_t width;
+  uint32_t height;
+  // image origin on the reference grid
+  uint32_t x0;
+  uint32_t y0;
+  // tile grid origin and tile size
+  uint32_t tx0;
+  uint32_t ty0;
+  uint32_t tileWidth;
+  uint32_t tileHeight;
+  // subsampling of the second and third components
+  uint32_t chromaSub;
+  // log2 of the precinct size at the highest resolution, or 0 for the maximum
+  uint32_t precinctExp;
+  bool poc;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+uint32_t ceildiv(uint32_t a, uint32_t b)
+{
+  return (a + b - 1) / b;
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+grk_image* makeImage(const Config& config)
+{
+  uint32_t x1 = config.x0 + config.width;
+  uint32_t y1 = config.y0 + config.height;
+  grk_image_comp params[NUM_COMPS] = {};
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto& p = params[compno];
+    uint32_t sub = compno ? config.chromaSub : 1;
+    p.dx = sub;
+    p.dy = sub;
+    p.x0 = ceildiv(config.x0, sub);
+    p.y0 = ceildiv(config.y0, sub);
+    p.w = ceildiv(x1, sub) - p.x0;
+    p.h = ceildiv(y1, sub) - p.y0;
+    p.prec = 8;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  image->x0 = config.x0;
+  image->y0 = config.y0;
+  image->x1 = x1;
+  image->y1 = y1;
+  uint32_t state = 0x9e3779b9u;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto comp = image->comps + compno;
+    auto data = (int32_t*)comp->data;
+    for(uint32_t y = 0; y < comp->h; ++y)
+    {
+      for(uint32_t x = 0; x < comp->w; ++x)
+      {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[(size_t)y * comp->stride + x] =
+            (int32_t)((x * 3 + y * 5 + compno * 40 + (state & 31)) & 255);
+      }
+    }
+  }
+  return image;
+}
+
+bool compress(const Config& config, std::vector<uint8_t>& out)
+{
+  auto image = makeImage(config);
+  if(!image)
+    return false;
+  grk_cparameters parameters;
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.cblockw_init = 16;
+  parameters.cblockh_init = 16;
+  parameters.prog_order = config.prog;
+  parameters.image_offset_x0 = config.x0;
+  parameters.image_offset_y0 = config.y0;
+  parameters.tile_size_on = true;
+  parameters.tx0 = config.tx0;
+  parameters.ty0 = config.ty0;
+  parameters.t_width = config.tileWidth;
+  parameters.t_height = config.tileHeight;
+  parameters.numlayers = NUM_LAYERS;
+  for(uint16_t i = 0; i < NUM_LAYERS - 1; ++i)
+    parameters.layer_rate[i] = 60.0 / (1 << i);
+  parameters.layer_rate[NUM_LAYERS - 1] = 0;
+  parameters.allocation_by_rate_distortion = true;
+  if(config.precinctExp)
+  {
+    // precincts halve at each lower resolution, down to 8x8
+    parameters.csty |= 0x01;
+    parameters.res_spec = NUM_RESOLUTIONS;
+    for(uint32_t i = 0; i < NUM_RESOLUTIONS; ++i)
+    {
+      uint32_t exp = config.precinctExp > i + 3 ? config.precinctExp - i : 3;
+      parameters.prcw_init[i] = 1U << exp;
+      parameters.prch_init[i] = 1U << exp;
+    }
+  }
+  if(config.poc)
+  {
+    // every tile walks the whole tile in CPRL; tile 0 first sends its lower
+    // resolutions and layers in RLCP, and its second progression skips those packets
+    uint32_t numTiles = ceildiv(config.x0 + config.width - config.tx0, config.tileWidth) *
+                        ceildiv(config.y0 + config.height - config.ty0, config.tileHeight);
+    uint32_t numProgressions = numTiles + 1;
+    if(numProgressions > GRK_MAXRLVLS)
+    {
+      grk_object_unref(&image->obj);
+      return false;
+    }
+    for(uint32_t i = 0; i < numProgressions; ++i)
+    {
+      auto& prog = parameters.progression[i];
+      bool partial = i == 0;
+      prog.tileno = i ? i - 1 : 0;
+      prog.res_s = 0;
+      prog.comp_s = 0;
+      prog.lay_e = partial ? NUM_LAYERS - 1 : NUM_LAYERS;
+      prog.res_e = partial ? NUM_RESOLUTIONS - 1 : NUM_RESOLUTIONS;
+      prog.comp_e = NUM_COMPS;
+      prog.specified_compression_poc_prog = partial ? GRK_RLCP : GRK_CPRL;
+    }
+    parameters.numpocs = numProgressions - 1;
+  }
+
+  out.assign((size_t)NUM_COMPS * (config.x0 + config.width) * (config.y0 + config.height) * 2,
+             0);
+  grk_stream_params streamParams = {};
+  streamParams.buf = out.data();
+  streamParams.buf_len = out.size();
+  uint64_t length = 0;
+  auto codec = grk_compress_init(&streamParams, &parameters, image);
+  if(codec)
+    length = grk_compress(codec, nullptr);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  out.resize(length);
+
+  return length != 0;
+}
+
+grk_object* decompress(std::vector<uint8_t>& stream, uint8_t reduce, uint16_t layers)
+{
+  grk_decompress_parameters params = {};
+  params.core.reduce = reduce;
+  params.core.layers_to_decompress = layers;
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  streamParams.buf = stream.data();
+  streamParams.buf_len = stream.size();
+  auto codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return nullptr;
+  grk_header_info headerInfo = {};
+  if(!grk_decompress_read_header(codec, &headerInfo) || !grk_decompress(codec, nullptr))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  return codec;
+}
+
+bool samePixels(const char* label, const grk_image* a, const grk_image* b)
+{
+  if(!a || !b || a->numcomps != b->numcomps)
+  {
+    fprintf(stderr, "%s: decompressed image is missing\n", label);
+    return false;
+  }
+  for(uint16_t compno = 0; compno < a->numcomps; ++compno)
+  {
+    const auto& ca = a->comps[compno];
+    const auto& cb = b->comps[compno];
+    if(ca.w != cb.w || ca.h != cb.h || !ca.data || !cb.data)
+    {
+      fprintf(stderr, "%s: component %u is %ux%u with shared orders, %ux%u without\n", label,
+              compno, ca.w, ca.h, cb.w, cb.h);
+      return false;
+    }
+    for(uint32_t y = 0; y < ca.h; ++y)
+    {
+      for(uint32_t x = 0; x < ca.w; ++x)
+      {
+        int32_t va = sampleAt(ca, (uint64_t)y * ca.stride + x);
+        int32_t vb = sampleAt(cb, (uint64_t)y * cb.stride + x);
+        if(va != vb)
+        {
+          fprintf(stderr, "%s: component %u sample (%u,%u) is %d with shared orders, %d without\n",
+                  label, compno, x, y, va, vb);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool check(const Config& config)
+{
+  std::vector<uint8_t> perTile;
+  std::vector<uint8_t> shared;
+  usePacketOrderTables(false);
+  bool ok = compress(config, perTile);
+  usePacketOrderTables(true);
+  ok = ok && compress(config, shared);
+  if(!ok)
+  {
+    fprintf(stderr, "%s: compress failed\n", config.label);
+    return false;
+  }
+  if(perTile != shared)
+  {
+    fprintf(stderr, "%s: code stream is %zu bytes with shared orders, %zu without\n", config.label,
+            shared.size(), perTile.size());
+    return false;
+  }
+
+  const struct
+  {
+    uint8_t reduce;
+    uint16_t layers;
+  } decodes[] = {{0, 0}, {1, 0}, {0, 1}, {2, 2}};
+  for(const auto& decode : decodes)
+  {
+    usePacketOrderTables(false);
+    auto reference = decompress(shared, decode.reduce, decode.layers);
+    usePacketOrderTables(true);
+    auto codec = decompress(shared, decode.reduce, decode.layers);
+    ok = reference && codec;
+    if(!ok)
+      fprintf(stderr, "%s: decompress at reduce %u, %u layers failed\n", config.label,
+              decode.reduce, decode.layers);
+    else
+      ok = samePixels(config.label, grk_decompress_get_image(codec),
+                      grk_decompress_get_image(reference));
+    grk_object_unref(codec);
+    grk_object_unref(reference);
+    if(!ok)
+      return false;
+  }
+  printf("%s: %zu byte code stream and its decodes match\n", config.label, shared.size());
+
+  return true;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"lrcp", GRK_LRCP, 150, 110, 0, 0, 0, 0, 32, 32, 1, 0, false},
+      {"rlcp_offsets", GRK_RLCP, 181, 127, 37, 29, 5, 3, 48, 40, 1, 0, false},
+      {"rpcl_precincts", GRK_RPCL, 211, 167, 0, 0, 0, 0, 64, 64, 1, 5, false},
+      {"pcrl_subsampled", GRK_PCRL, 173, 141, 19, 11, 0, 0, 48, 48, 2, 5, false},
+      {"cprl_offsets_precincts", GRK_CPRL, 190, 150, 70, 45, 33, 20, 56, 40, 1, 4, false},
+      {"poc", GRK_LRCP, 150, 130, 13, 7, 0, 0, 64, 64, 1, 5, true},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+  usePacketOrderTables(true);
+
+  grk_deinitialize();
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
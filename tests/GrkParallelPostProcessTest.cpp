@@ -0,0 +1,268 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// colour conversion, upsampling and precision post-processing run as row
+// bands on the executor. A decode with many threads must produce exactly
+// what a single-threaded decode produces, including the odd-origin chroma
+// siting of sub-sampled sYCC.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 521;
+const uint32_t IMAGE_HEIGHT = 403;
+const uint32_t MANY_THREADS = 8;
+
+struct Config
+{
+  const char* label;
+  GRK_COLOR_SPACE colourSpace;
+  uint16_t numComps;
+  uint32_t chromaDx;
+  uint32_t chromaDy;
+  uint32_t origin; // image x0 and y0
+  bool upsample;
+  uint8_t clipPrecision; // 0 = no precision change
+};
+
+struct Plane
+{
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<int32_t> samples;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+bool capture(grk_image* image, std::vector<Plane>& out)
+{
+  out.clear();
+  for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+  {
+    const auto& source = image->comps[compno];
+    if(!source.data || source.w == 0 || source.h == 0)
+    {
+      fprintf(stderr, "decoded component %u is empty\n", compno);
+      return false;
+    }
+    Plane plane;
+    plane.width = source.w;
+    plane.height = source.h;
+    plane.samples.resize((size_t)source.w * source.h);
+    for(uint32_t y = 0; y < source.h; ++y)
+      for(uint32_t x = 0; x < source.w; ++x)
+        plane.samples[(size_t)y * source.w + x] = sampleAt(source, (uint64_t)y * source.stride + x);
+    out.push_back(std::move(plane));
+  }
+  return true;
+}
+
+grk_image* makeImage(const Config& config)
+{
+  uint32_t x1 = config.origin + IMAGE_WIDTH;
+  uint32_t y1 = config.origin + IMAGE_HEIGHT;
+  std::vector<grk_image_comp> params(config.numComps);
+  for(uint16_t compno = 0; compno < config.numComps; ++compno)
+  {
+    auto& p = params[compno];
+    bool chroma = compno == 1 || compno == 2;
+    p.dx = chroma ? config.chromaDx : 1;
+    p.dy = chroma ? config.chromaDy : 1;
+    p.x0 = (config.origin + p.dx - 1) / p.dx;
+    p.y0 = (config.origin + p.dy - 1) / p.dy;
+    p.w = (x1 + p.dx - 1) / p.dx - p.x0;
+    p.h = (y1 + p.dy - 1) / p.dy - p.y0;
+    p.prec = 8;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(config.numComps, params.data(), config.colourSpace, true);
+  if(!image)
+    return nullptr;
+  image->x0 = config.origin;
+  image->y0 = config.origin;
+  image->x1 = x1;
+  image->y1 = y1;
+  for(uint16_t compno = 0; compno < config.numComps; ++compno)
+  {
+    auto& comp = image->comps[compno];
+    auto* data = static_cast<int32_t*>(comp.data);
+    for(uint32_t y = 0; y < comp.h; ++y)
+      for(uint32_t x = 0; x < comp.w; ++x)
+        data[(size_t)y * comp.stride + x] =
+            (int32_t)((x * (3 + compno) + y * 5 + ((x ^ y) % 37) * 7) & 0xFF);
+  }
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage(config);
+  if(!image)
+  {
+    fprintf(stderr, "%s: could not build the source image\n", config.label);
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = 4;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+bool decode(const std::string& path, const Config& config, std::vector<Plane>& out)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_precision precision = {config.clipPrecision, GRK_PREC_MODE_CLIP};
+  grk_header_info headerInfo = {};
+  headerInfo.color_space = config.colourSpace;
+  headerInfo.decompress_fmt = GRK_FMT_BMP;
+  headerInfo.upsample = config.upsample;
+  if(config.clipPrecision)
+  {
+    headerInfo.precision = &precision;
+    headerInfo.num_precision = 1;
+  }
+  bool ok = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+  grk_image* image = ok ? grk_decompress_get_image(codec) : nullptr;
+  ok = image && capture(image, out);
+  grk_object_unref(codec);
+  return ok;
+}
+
+bool samePlanes(const Config& config, const std::vector<Plane>& got,
+                const std::vector<Plane>& reference)
+{
+  if(got.size() != reference.size())
+  {
+    fprintf(stderr, "%s: %zu components, single-threaded decode has %zu\n", config.label,
+            got.size(), reference.size());
+    return false;
+  }
+  for(size_t compno = 0; compno < got.size(); ++compno)
+  {
+    const auto& a = got[compno];
+    const auto& b = reference[compno];
+    if(a.width != b.width || a.height != b.height)
+    {
+      fprintf(stderr, "%s: component %zu is %ux%u, single-threaded decode has %ux%u\n",
+              config.label, compno, a.width, a.height, b.width, b.height);
+      return false;
+    }
+    for(size_t i = 0; i < a.samples.size(); ++i)
+    {
+      if(a.samples[i] != b.samples[i])
+      {
+        fprintf(stderr, "%s: component %zu sample (%zu,%zu) is %d, single-threaded it is %d\n",
+                config.label, compno, i % a.width, i / a.width, a.samples[i], b.samples[i]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::string pathFor(const Config& config)
+{
+  return std::string("parallel_post_process_") + config.label + ".j2k";
+}
+} // namespace
+
+int main(void)
+{
+  const Config configs[] = {
+      {"sycc420_odd_origin", GRK_CLRSPC_SYCC, 3, 2, 2, 1, false, 0},
+      {"sycc420", GRK_CLRSPC_SYCC, 3, 2, 2, 0, false, 0},
+      {"sycc422_odd_origin", GRK_CLRSPC_SYCC, 3, 2, 1, 1, false, 0},
+      {"sycc444", GRK_CLRSPC_SYCC, 3, 1, 1, 0, false, 0},
+      {"eycc444", GRK_CLRSPC_EYCC, 3, 1, 1, 0, false, 0},
+      {"cmyk", GRK_CLRSPC_CMYK, 4, 1, 1, 0, false, 0},
+      {"upsample420", GRK_CLRSPC_SRGB, 3, 2, 2, 1, true, 0},
+      {"clip_precision", GRK_CLRSPC_SRGB, 3, 1, 1, 0, false, 5},
+  };
+  const size_t numConfigs = sizeof(configs) / sizeof(configs[0]);
+
+  grk_initialize(nullptr, 1, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  bool ok = true;
+  std::vector<std::vector<Plane>> reference(numConfigs);
+  std::vector<bool> usable(numConfigs, false);
+  for(size_t i = 0; i < numConfigs; ++i)
+  {
+    if(!compress(pathFor(configs[i]), configs[i]))
+      ok = false;
+    else if(!decode(pathFor(configs[i]), configs[i], reference[i]))
+      fprintf(stderr, "%s: single-threaded decode failed\n", configs[i].label);
+    else
+      usable[i] = true;
+    ok = ok && usable[i];
+  }
+
+  grk_initialize(nullptr, MANY_THREADS, nullptr);
+  for(size_t i = 0; i < numConfigs; ++i)
+  {
+    if(!usable[i])
+      continue;
+    std::vector<Plane> planes;
+    bool match = false;
+    if(!decode(pathFor(configs[i]), configs[i], planes))
+      fprintf(stderr, "%s: multi-threaded decode failed\n", configs[i].label);
+    else
+      match = samePlanes(configs[i], planes, reference[i]);
+    if(match)
+      printf("%s: banded post-processing matches\n", configs[i].label);
+    ok = ok && match;
+  }
+  for(const auto& config : configs)
+    remove(pathFor(config).c_str());
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
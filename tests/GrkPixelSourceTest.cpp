@@ -0,0 +1,242 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// compressing from a memory-mapped pixel source must produce exactly the
+// codestream that compressing the same samples from image planes produces,
+// for interleaved and planar layouts, both sample sizes and byte orders, signed
+// samples, and tile grids that do and do not divide the image.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+  const uint32_t WIDTH = 97;
+  const uint32_t HEIGHT = 61;
+  // odd-sized header so 16-bit samples start on an odd address
+  const uint64_t HEADER_BYTES = 13;
+
+  struct Layout
+  {
+    uint16_t numcomps;
+    uint8_t bytesPerSample;
+    uint8_t precision;
+    bool sgnd;
+    bool bigEndian;
+    bool interleaved;
+    uint32_t tile; // 0 = single tile
+  };
+
+  int32_t sampleValue(uint32_t x, uint32_t y, uint16_t c, const Layout& layout)
+  {
+    uint32_t range = 1U << layout.precision;
+    uint32_t v = (x * 7 + y * 13 + c * 101 + ((x * y) >> 3)) % range;
+    return layout.sgnd ? (int32_t)v - (int32_t)(range >> 1) : (int32_t)v;
+  }
+
+  std::string describe(const Layout& layout)
+  {
+    return std::to_string(layout.numcomps) + " comps, " + std::to_string(layout.precision) +
+           (layout.sgnd ? " bit signed, " : " bit unsigned, ") +
+           (layout.bytesPerSample == 2 ? (layout.bigEndian ? "BE, " : "LE, ") : "") +
+           (layout.interleaved ? "interleaved" : "planar") + ", tile " +
+           std::to_string(layout.tile);
+  }
+
+  bool writeSource(const Layout& layout, const std::string& path)
+  {
+    std::vector<uint8_t> bytes(HEADER_BYTES, 'h');
+    auto put = [&](int32_t v) {
+      auto u = (uint32_t)v;
+      if(layout.bytesPerSample == 1)
+      {
+        bytes.push_back((uint8_t)u);
+      }
+      else if(layout.bigEndian)
+      {
+        bytes.push_back((uint8_t)(u >> 8));
+        bytes.push_back((uint8_t)u);
+      }
+      else
+      {
+        bytes.push_back((uint8_t)u);
+        bytes.push_back((uint8_t)(u >> 8));
+      }
+    };
+    if(layout.interleaved)
+    {
+      for(uint32_t y = 0; y < HEIGHT; ++y)
+        for(uint32_t x = 0; x < WIDTH; ++x)
+          for(uint16_t c = 0; c < layout.numcomps; ++c)
+            put(sampleValue(x, y, c, layout));
+    }
+    else
+    {
+      for(uint16_t c = 0; c < layout.numcomps; ++c)
+        for(uint32_t y = 0; y < HEIGHT; ++y)
+          for(uint32_t x = 0; x < WIDTH; ++x)
+            put(sampleValue(x, y, c, layout));
+    }
+    std::ofstream out(path, std::ios::binary);
+    out.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+    return out.good();
+  }
+
+  grk_image* makeImage(const Layout& layout, bool withData)
+  {
+    std::vector<grk_image_comp> params(layout.numcomps);
+    for(auto& p : params)
+    {
+      p = {};
+      p.dx = 1;
+      p.dy = 1;
+      p.w = WIDTH;
+      p.h = HEIGHT;
+      p.prec = layout.precision;
+      p.sgnd = layout.sgnd;
+    }
+    auto clrspc = layout.numcomps == 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY;
+    grk_image* image = grk_image_new(layout.numcomps, params.data(), clrspc, withData);
+    if(!image || !withData)
+      return image;
+    for(uint16_t c = 0; c < layout.numcomps; ++c)
+    {
+      auto data = static_cast<int32_t*>(image->comps[c].data);
+      uint32_t stride = image->comps[c].stride;
+      for(uint32_t y = 0; y < HEIGHT; ++y)
+        for(uint32_t x = 0; x < WIDTH; ++x)
+          data[(size_t)y * stride + x] = sampleValue(x, y, c, layout);
+    }
+    return image;
+  }
+
+  bool compress(const Layout& layout, const std::string& source, const std::string& out)
+  {
+    bool mapped = !source.empty();
+    grk_image* image = makeImage(layout, !mapped);
+    if(!image)
+      return false;
+    grk_cparameters parameters;
+    grk_compress_set_default_params(&parameters);
+    parameters.cod_format = GRK_FMT_J2K;
+    if(layout.tile)
+    {
+      parameters.tile_size_on = true;
+      parameters.t_width = layout.tile;
+      parameters.t_height = layout.tile;
+    }
+    if(mapped)
+    {
+      auto src = &parameters.pixel_source;
+      snprintf(src->file, sizeof(src->file), "%s", source.c_str());
+      src->offset = HEADER_BYTES;
+      src->bytes_per_sample = layout.bytesPerSample;
+      src->big_endian = layout.bigEndian;
+      src->interleaved = layout.interleaved;
+    }
+    grk_stream_params streamParams = {};
+    snprintf(streamParams.file, sizeof(streamParams.file), "%s", out.c_str());
+    grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+    bool ok = codec && grk_compress(codec, nullptr) != 0;
+    grk_object_unref(codec);
+    grk_object_unref(&image->obj);
+    return ok;
+  }
+
+  std::vector<char> readAll(const std::string& path)
+  {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  bool run(const Layout& layout)
+  {
+    const std::string source = "pixel_source.bin";
+    const std::string fromPlanes = "pixel_source_planes.j2k";
+    const std::string fromMap = "pixel_source_mapped.j2k";
+    bool ok = writeSource(layout, source) && compress(layout, "", fromPlanes) &&
+              compress(layout, source, fromMap);
+    if(!ok)
+      fprintf(stderr, "%s: compress failed\n", describe(layout).c_str());
+    else
+    {
+      auto expected = readAll(fromPlanes);
+      ok = !expected.empty() && expected == readAll(fromMap);
+      if(!ok)
+        fprintf(stderr, "%s: codestreams differ\n", describe(layout).c_str());
+    }
+    remove(source.c_str());
+    remove(fromPlanes.c_str());
+    remove(fromMap.c_str());
+    return ok;
+  }
+
+  // a pixel source file shorter than the image must be rejected, not read past
+  bool rejectsShortFile(void)
+  {
+    const std::string source = "pixel_source_short.bin";
+    const std::string out = "pixel_source_short.j2k";
+    Layout layout = {1, 1, 8, false, false, true, 0};
+    {
+      std::ofstream f(source, std::ios::binary);
+      std::vector<char> bytes(HEADER_BYTES + (size_t)WIDTH * HEIGHT - 1);
+      f.write(bytes.data(), (std::streamsize)bytes.size());
+    }
+    bool ok = !compress(layout, source, out);
+    if(!ok)
+      fprintf(stderr, "short pixel source was accepted\n");
+    remove(source.c_str());
+    remove(out.c_str());
+    return ok;
+  }
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+
+  const Layout layouts[] = {
+      {3, 1, 8, false, false, true, 0},   {3, 1, 8, false, false, true, 32},
+      {4, 1, 8, false, false, true, 24},  {1, 1, 8, false, false, true, 32},
+      {2, 1, 8, false, false, true, 32},  {3, 2, 16, false, true, true, 32},
+      {3, 2, 12, false, true, true, 0},   {4, 2, 16, false, false, true, 24},
+      {1, 2, 16, false, true, true, 32},  {5, 2, 10, false, false, true, 32},
+      {3, 1, 8, false, false, false, 32}, {3, 2, 16, false, true, false, 32},
+      {2, 2, 16, false, false, false, 0}, {1, 1, 8, true, false, false, 32},
+      {3, 2, 16, true, true, true, 32},   {1, 2, 12, true, false, false, 24},
+  };
+  int result = 0;
+  for(const auto& layout : layouts)
+  {
+    if(run(layout))
+      printf("%s: identical\n", describe(layout).c_str());
+    else
+      result = 1;
+  }
+  if(!rejectsShortFile())
+    result = 1;
+
+  grk_deinitialize();
+  return result;
+}
@@ -0,0 +1,281 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// one decompress with grk_decompress_core_params::pyramid_reductions emits overview
+// levels copied out of the inverse wavelet: each must match a fresh decompress at that
+// reduction, exactly for the reversible transform and within one code for the
+// irreversible one, for Part-1 and HT code blocks, with a reduced full image, and with
+// a custom (Part 2) multi-component transform.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 211;
+const uint32_t IMAGE_HEIGHT = 167;
+const uint32_t TILE_WIDTH = 128;
+const uint32_t TILE_HEIGHT = 96;
+const uint16_t NUM_COMPS = 3;
+const uint8_t PREC = 16;
+const uint8_t NUM_RESOLUTIONS = 5;
+
+struct Config
+{
+  const char* label;
+  bool irreversible;
+  bool ht;
+  uint8_t reduce;
+  bool customMct;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = PREC;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 22;
+        uint32_t edge = ((x / 37 + y / 29) & 1) ? 12000U : 0U;
+        data[(size_t)y * stride + x] =
+            (int32_t)((x * 211U + y * (97U + compno * 31U) + noise + edge) & 0xFFFF);
+      }
+    }
+  }
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage();
+  if(!image)
+  {
+    fprintf(stderr, "%s: could not build the source image\n", config.label);
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.irreversible = config.irreversible;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_WIDTH;
+  parameters.t_height = TILE_HEIGHT;
+  if(config.ht)
+    parameters.cblk_sty = GRK_CBLKSTY_HT_ONLY;
+  if(config.customMct)
+  {
+    // a Householder reflection, I - 2vv'/v'v with v all ones: its own inverse
+    float matrix[NUM_COMPS * NUM_COMPS];
+    int32_t dcShift[NUM_COMPS];
+    for(uint16_t o = 0; o < NUM_COMPS; ++o)
+    {
+      for(uint16_t k = 0; k < NUM_COMPS; ++k)
+        matrix[o * NUM_COMPS + k] = (o == k ? 1.0f : 0.0f) - 2.0f / NUM_COMPS;
+      dcShift[o] = 1 << (PREC - 1);
+    }
+    if(!grk_set_MCT(&parameters, matrix, dcShift, NUM_COMPS))
+    {
+      grk_object_unref(&image->obj);
+      return false;
+    }
+  }
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+bool collect(const grk_image* image, std::vector<int32_t>& out, uint32_t& width,
+             uint32_t& height)
+{
+  if(!image || image->numcomps != NUM_COMPS || !image->comps[0].data)
+    return false;
+  width = image->comps[0].w;
+  height = image->comps[0].h;
+  out.resize((size_t)width * height * NUM_COMPS);
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    const auto& comp = image->comps[compno];
+    if(!comp.data || comp.w != width || comp.h != height)
+      return false;
+    for(uint32_t y = 0; y < height; ++y)
+      for(uint32_t x = 0; x < width; ++x)
+        out[((size_t)compno * height + y) * width + x] =
+            sampleAt(comp, (uint64_t)y * comp.stride + x);
+  }
+  return true;
+}
+
+grk_object* openCodec(const std::string& path, uint8_t reduce, uint32_t pyramidReductions)
+{
+  grk_decompress_parameters params = {};
+  params.core.reduce = reduce;
+  params.core.pyramid_reductions = pyramidReductions;
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return nullptr;
+  grk_header_info headerInfo = {};
+  if(!grk_decompress_read_header(codec, &headerInfo) || !grk_decompress(codec, nullptr))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  return codec;
+}
+
+bool compare(const Config& config, uint8_t reduction, const std::vector<int32_t>& level,
+             const std::vector<int32_t>& reference)
+{
+  const int32_t tolerance = config.irreversible ? 1 : 0;
+  for(size_t i = 0; i < level.size(); ++i)
+  {
+    int32_t diff = level[i] - reference[i];
+    if(diff < -tolerance || diff > tolerance)
+    {
+      fprintf(stderr, "%s: reduction %u: sample %zu is %d, reduce decode has %d\n", config.label,
+              reduction, i, level[i], reference[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool check(const Config& config)
+{
+  std::string path = std::string("pyramid_") + config.label + ".j2k";
+  if(!compress(path, config))
+    return false;
+  uint32_t requested = 0;
+  for(uint8_t k = (uint8_t)(config.reduce + 1); k < NUM_RESOLUTIONS; ++k)
+    requested |= 1U << k;
+  // reduction 0, at or below reduce, and beyond the resolution count are all ignored
+  grk_object* codec = openCodec(path, config.reduce, requested | 1U | (1U << NUM_RESOLUTIONS));
+  bool ok = codec != nullptr;
+  if(!ok)
+    fprintf(stderr, "%s: pyramid decompress failed\n", config.label);
+  for(uint8_t k = 0; ok && k <= NUM_RESOLUTIONS; ++k)
+  {
+    grk_image* level = grk_decompress_get_pyramid_image(codec, k);
+    bool wanted = (requested >> k) & 1;
+    if(!wanted)
+    {
+      if(level)
+      {
+        fprintf(stderr, "%s: reduction %u was emitted but not requested\n", config.label, k);
+        ok = false;
+      }
+      continue;
+    }
+    std::vector<int32_t> samples, reference;
+    uint32_t w = 0, h = 0, refW = 0, refH = 0;
+    if(!collect(level, samples, w, h))
+    {
+      fprintf(stderr, "%s: reduction %u is missing\n", config.label, k);
+      ok = false;
+      break;
+    }
+    grk_object* refCodec = openCodec(path, k, 0);
+    ok = refCodec && collect(grk_decompress_get_image(refCodec), reference, refW, refH);
+    grk_object_unref(refCodec);
+    if(!ok)
+    {
+      fprintf(stderr, "%s: reference decompress at reduction %u failed\n", config.label, k);
+    }
+    else if(w != refW || h != refH)
+    {
+      fprintf(stderr, "%s: reduction %u is %ux%u, reduce decode is %ux%u\n", config.label, k, w,
+              h, refW, refH);
+      ok = false;
+    }
+    else
+    {
+      ok = compare(config, k, samples, reference);
+    }
+  }
+  grk_object_unref(codec);
+  if(ok)
+    printf("%s: every overview level matches its reduce decode\n", config.label);
+  remove(path.c_str());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"reversible", false, false, 0, false},
+      {"irreversible", true, false, 0, false},
+      {"reversible_reduced", false, false, 1, false},
+      {"ht_reversible", false, true, 0, false},
+      {"ht_irreversible", true, true, 0, false},
+      {"custom_mct", true, false, 0, true},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
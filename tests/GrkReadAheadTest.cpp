@@ -0,0 +1,371 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// decoding a local file with tile read-ahead enabled, whole-image and one
+// tile at a time, must produce exactly what a decode without read-ahead
+// produces, with and without TLM markers. Taking tiles out of order must
+// not leave read-ahead buffers behind, and planning the same tiles again in
+// a new order must not drop reads that are still wanted.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+#include "TPFetchSeq.h"
+#include "TileReadAhead.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 300;
+const uint32_t IMAGE_HEIGHT = 220;
+const uint32_t TILE_SIZE = 64;
+const uint16_t READ_AHEAD_TILES = 3;
+
+struct Config
+{
+  const char* label;
+  bool tlm;
+  uint32_t numTileParts; // tile parts per tile, split by resolution when > 1
+};
+
+struct Plane
+{
+  uint32_t x0 = 0;
+  uint32_t y0 = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<int32_t> samples;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+bool capture(grk_image* image, Plane& out)
+{
+  const auto& source = image->comps[0];
+  if(!source.data || source.w == 0 || source.h == 0)
+  {
+    fprintf(stderr, "decoded component is empty: %ux%u\n", source.w, source.h);
+    return false;
+  }
+  out.x0 = image->x0;
+  out.y0 = image->y0;
+  out.width = source.w;
+  out.height = source.h;
+  out.samples.resize((size_t)source.w * source.h);
+  for(uint32_t y = 0; y < source.h; ++y)
+    for(uint32_t x = 0; x < source.w; ++x)
+      out.samples[(size_t)y * source.w + x] = sampleAt(source, (uint64_t)y * source.stride + x);
+  return true;
+}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params = {};
+  params.dx = 1;
+  params.dy = 1;
+  params.w = IMAGE_WIDTH;
+  params.h = IMAGE_HEIGHT;
+  params.prec = 8;
+  params.sgnd = false;
+  grk_image* image = grk_image_new(1, &params, GRK_CLRSPC_GRAY, true);
+  if(!image)
+    return nullptr;
+  auto* data = static_cast<int32_t*>(image->comps[0].data);
+  uint32_t stride = image->comps[0].stride;
+  for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      data[(size_t)y * stride + x] = (int32_t)((x * 7 + y * 3 + ((x ^ y) % 29) * 5) & 0xFF);
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage();
+  if(!image)
+  {
+    fprintf(stderr, "could not build the source image\n");
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = 4;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_SIZE;
+  parameters.t_height = TILE_SIZE;
+  parameters.write_tlm = config.tlm;
+  if(config.numTileParts > 1)
+  {
+    parameters.enable_tile_part_generation = true;
+    parameters.new_tile_part_progression_divider = 'R';
+  }
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+grk_object* openCodec(const std::string& path, uint16_t readAheadTiles)
+{
+  grk_decompress_parameters params = {};
+  params.core.read_ahead_tiles = readAheadTiles;
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return nullptr;
+  grk_header_info headerInfo = {};
+  if(!grk_decompress_read_header(codec, &headerInfo))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  return codec;
+}
+
+bool decodeImage(const std::string& path, uint16_t readAheadTiles, Plane& out)
+{
+  auto codec = openCodec(path, readAheadTiles);
+  if(!codec)
+    return false;
+  bool ok = grk_decompress(codec, nullptr);
+  grk_image* image = ok ? grk_decompress_get_image(codec) : nullptr;
+  ok = image && capture(image, out);
+  grk_object_unref(codec);
+  return ok;
+}
+
+bool sameRegion(const char* label, const Plane& got, const Plane& reference)
+{
+  if(got.x0 + got.width > reference.width || got.y0 + got.height > reference.height)
+  {
+    fprintf(stderr, "%s: region %u,%u %ux%u lies outside the image\n", label, got.x0, got.y0,
+            got.width, got.height);
+    return false;
+  }
+  for(uint32_t y = 0; y < got.height; ++y)
+  {
+    for(uint32_t x = 0; x < got.width; ++x)
+    {
+      auto value = got.samples[(size_t)y * got.width + x];
+      auto expected = reference.samples[(size_t)(got.y0 + y) * reference.width + got.x0 + x];
+      if(value != expected)
+      {
+        fprintf(stderr, "%s: sample (%u,%u) is %d, without read-ahead it is %d\n", label,
+                got.x0 + x, got.y0 + y, value, expected);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool decodeTiles(const std::string& path, const Config& config, const Plane& reference)
+{
+  auto codec = openCodec(path, READ_AHEAD_TILES);
+  if(!codec)
+    return false;
+  uint32_t tilesX = (IMAGE_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+  uint32_t tilesY = (IMAGE_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+  bool ok = true;
+  for(uint16_t tileIndex = 0; ok && tileIndex < tilesX * tilesY; ++tileIndex)
+  {
+    Plane tile;
+    grk_image* image = nullptr;
+    if(grk_decompress_tile(codec, tileIndex))
+      image = grk_decompress_get_tile_image(codec, tileIndex, true);
+    ok = image && capture(image, tile) && sameRegion(config.label, tile, reference);
+    if(!ok)
+      fprintf(stderr, "%s: tile %u differs\n", config.label, tileIndex);
+  }
+  grk_object_unref(codec);
+  return ok;
+}
+
+bool check(const Config& config)
+{
+  std::string path = std::string("read_ahead_") + config.label + ".j2k";
+  if(!compress(path, config))
+    return false;
+
+  bool ok = false;
+  Plane reference;
+  Plane readAhead;
+  if(!decodeImage(path, 0, reference))
+    fprintf(stderr, "%s: reference decode failed\n", config.label);
+  else if(!decodeImage(path, READ_AHEAD_TILES, readAhead))
+    fprintf(stderr, "%s: read-ahead decode failed\n", config.label);
+  else if(readAhead.width != reference.width || readAhead.height != reference.height)
+    fprintf(stderr, "%s: read-ahead decode is %ux%u, expected %ux%u\n", config.label,
+            readAhead.width, readAhead.height, reference.width, reference.height);
+  else
+    ok = sameRegion(config.label, readAhead, reference) && decodeTiles(path, config, reference);
+  if(ok)
+    printf("%s: read-ahead decodes match\n", config.label);
+  remove(path.c_str());
+  return ok;
+}
+// takes scattered tiles, as a random-access grk_decompress_tile() loop does,
+// and checks that the reader holds no more than its window plus the tile in flight
+bool checkSlotsBounded(bool sequential)
+{
+  const char* label = sequential ? "slots_sequential" : "slots_planned";
+  const uint16_t numTiles = 64;
+  const uint32_t tileBytes = 4096;
+  std::string path = std::string("read_ahead_") + label + ".bin";
+  FILE* file = fopen(path.c_str(), "wb");
+  if(!file)
+    return false;
+  std::vector<uint8_t> bytes((size_t)numTiles * tileBytes, 0x5A);
+  bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+  fclose(file);
+
+  grk::TPSEQ_VEC allTileParts;
+  for(uint16_t i = 0; i < numTiles; ++i)
+  {
+    auto tileParts = std::make_unique<grk::TPSeq>();
+    tileParts->grk::SharedPtrSeq<grk::DataSlice>::push_back(
+        std::make_shared<grk::DataSlice>((uint64_t)i * tileBytes, tileBytes));
+    allTileParts.push_back(std::move(tileParts));
+  }
+  {
+    grk::TileReadAhead readAhead(path, GRK_CODEC_J2K, READ_AHEAD_TILES);
+    ok = ok && readAhead.open();
+    if(sequential)
+    {
+      readAhead.planSequential(&allTileParts);
+    }
+    else
+    {
+      std::vector<uint16_t> order;
+      for(uint16_t i = 0; i < numTiles; ++i)
+        order.push_back(i);
+      readAhead.plan(&allTileParts, order);
+    }
+    const uint16_t scattered[] = {0, 40, 7, 58, 3, 21, 33, 12, 50, 1, 27, 45, 9, 61, 16};
+    for(auto tileIndex : scattered)
+    {
+      if(!ok)
+        break;
+      readAhead.take(tileIndex);
+      auto held = readAhead.numSlots();
+      if(held > (size_t)READ_AHEAD_TILES + 1)
+      {
+        fprintf(stderr, "%s: %zu tiles held after taking tile %u\n", label, held, tileIndex);
+        ok = false;
+      }
+    }
+  }
+  if(ok)
+    printf("%s: read-ahead stays within its window\n", label);
+  remove(path.c_str());
+  return ok;
+}
+
+// planning the same tiles again in a new order, as a priority change does,
+// must keep the reads already queued for tiles the new plan still wants
+bool checkReplanKeepsReads(void)
+{
+  const char* label = "replan";
+  const uint16_t numTiles = 16;
+  const uint32_t tileBytes = 4096;
+  std::string path = std::string("read_ahead_") + label + ".bin";
+  FILE* file = fopen(path.c_str(), "wb");
+  if(!file)
+    return false;
+  std::vector<uint8_t> bytes((size_t)numTiles * tileBytes, 0x5A);
+  bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+  fclose(file);
+
+  grk::TPSEQ_VEC allTileParts;
+  for(uint16_t i = 0; i < numTiles; ++i)
+  {
+    auto tileParts = std::make_unique<grk::TPSeq>();
+    tileParts->grk::SharedPtrSeq<grk::DataSlice>::push_back(
+        std::make_shared<grk::DataSlice>((uint64_t)i * tileBytes, tileBytes));
+    allTileParts.push_back(std::move(tileParts));
+  }
+  {
+    grk::TileReadAhead readAhead(path, GRK_CODEC_J2K, READ_AHEAD_TILES);
+    ok = ok && readAhead.open();
+    std::vector<uint16_t> order;
+    for(uint16_t i = 0; i < numTiles; ++i)
+      order.push_back(i);
+    if(ok)
+    {
+      readAhead.plan(&allTileParts, order);
+      // queues tiles 1 to READ_AHEAD_TILES
+      readAhead.take(0);
+      std::vector<uint16_t> reordered(order.rbegin(), order.rend() - 1);
+      readAhead.plan(&allTileParts, reordered);
+      auto held = readAhead.numSlots();
+      if(held != READ_AHEAD_TILES)
+      {
+        fprintf(stderr, "%s: %zu tiles held after planning again, expected %u\n", label, held,
+                READ_AHEAD_TILES);
+        ok = false;
+      }
+    }
+  }
+  if(ok)
+    printf("%s: read-ahead keeps its reads across plans\n", label);
+  remove(path.c_str());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"tlm", true, 1},
+      {"tlm_tile_parts", true, 4},
+      {"no_tlm", false, 1},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+  ok = checkSlotsBounded(true) && ok;
+  ok = checkSlotsBounded(false) && ok;
+  ok = checkReplanKeepsReads() && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,282 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// a decompress with grk_decompress_core_params::scaled_width and scaled_height resamples
+// each tile straight into an image of that size: it must match an area average of a
+// decompress at the smallest resolution at least that large, within one code, for
+// sizes that do and do not need a reduce, with a window, and for Part-1 and HT blocks.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 211;
+const uint32_t IMAGE_HEIGHT = 167;
+const uint32_t TILE_WIDTH = 64;
+const uint32_t TILE_HEIGHT = 48;
+const uint16_t NUM_COMPS = 3;
+const uint8_t PREC = 12;
+const uint8_t NUM_RESOLUTIONS = 5;
+
+struct Config
+{
+  const char* label;
+  bool irreversible;
+  bool ht;
+  uint32_t scaledWidth;
+  uint32_t scaledHeight;
+  // decompress window, or all zero for the whole image
+  double window[4];
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = PREC;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 26;
+        uint32_t edge = ((x / 37 + y / 29) & 1) ? 1500U : 0U;
+        data[(size_t)y * stride + x] =
+            (int32_t)((x * 7U + y * (5U + compno * 3U) + noise + edge) & 0xFFF);
+      }
+    }
+  }
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage();
+  if(!image)
+  {
+    fprintf(stderr, "%s: could not build the source image\n", config.label);
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.irreversible = config.irreversible;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_WIDTH;
+  parameters.t_height = TILE_HEIGHT;
+  if(config.ht)
+    parameters.cblk_sty = GRK_CBLKSTY_HT_ONLY;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+grk_object* openCodec(const std::string& path, const Config& config, uint8_t reduce,
+                      bool scaled)
+{
+  grk_decompress_parameters params = {};
+  params.core.reduce = reduce;
+  if(scaled)
+  {
+    params.core.scaled_width = config.scaledWidth;
+    params.core.scaled_height = config.scaledHeight;
+  }
+  params.dw_x0 = config.window[0];
+  params.dw_y0 = config.window[1];
+  params.dw_x1 = config.window[2];
+  params.dw_y1 = config.window[3];
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return nullptr;
+  grk_header_info headerInfo = {};
+  if(!grk_decompress_read_header(codec, &headerInfo) || !grk_decompress(codec, nullptr))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  return codec;
+}
+
+// smallest resolution whose window is at least the scaled size in both directions
+uint8_t expectedReduce(const Config& config)
+{
+  double width = IMAGE_WIDTH;
+  double height = IMAGE_HEIGHT;
+  if(config.window[2] > 0)
+  {
+    width = config.window[2] - config.window[0];
+    height = config.window[3] - config.window[1];
+  }
+  uint8_t reduce = 0;
+  while(reduce + 1 < NUM_RESOLUTIONS &&
+        std::ceil(width / (2 << reduce)) >= config.scaledWidth &&
+        std::ceil(height / (2 << reduce)) >= config.scaledHeight)
+    ++reduce;
+  return reduce;
+}
+
+// area average of a decompressed component, resampled to w x h
+std::vector<double> areaAverage(const grk_image_comp& comp, uint32_t w, uint32_t h)
+{
+  auto weights = [](uint32_t src, uint32_t dst, uint32_t o, uint32_t i) {
+    double lo = std::max((double)o * src, (double)i * dst);
+    double hi = std::min((double)(o + 1) * src, (double)(i + 1) * dst);
+    return hi > lo ? (hi - lo) / src : 0.0;
+  };
+  std::vector<double> out((size_t)w * h, 0.0);
+  for(uint32_t oy = 0; oy < h; ++oy)
+  {
+    uint32_t y0 = (uint32_t)((uint64_t)oy * comp.h / h);
+    uint32_t y1 = (uint32_t)std::min<uint64_t>(((uint64_t)(oy + 1) * comp.h + h - 1) / h, comp.h);
+    for(uint32_t ox = 0; ox < w; ++ox)
+    {
+      uint32_t x0 = (uint32_t)((uint64_t)ox * comp.w / w);
+      uint32_t x1 =
+          (uint32_t)std::min<uint64_t>(((uint64_t)(ox + 1) * comp.w + w - 1) / w, comp.w);
+      double sum = 0;
+      for(uint32_t y = y0; y < y1; ++y)
+        for(uint32_t x = x0; x < x1; ++x)
+          sum += weights(comp.h, h, oy, y) * weights(comp.w, w, ox, x) *
+                 sampleAt(comp, (uint64_t)y * comp.stride + x);
+      out[(size_t)oy * w + ox] = sum;
+    }
+  }
+  return out;
+}
+
+bool compare(const Config& config, const grk_image* scaled, const grk_image* reference)
+{
+  if(!scaled || scaled->numcomps != NUM_COMPS || !reference ||
+     reference->numcomps != NUM_COMPS)
+  {
+    fprintf(stderr, "%s: scaled or reference image is missing\n", config.label);
+    return false;
+  }
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    const auto& comp = scaled->comps[compno];
+    if(!comp.data || comp.w != config.scaledWidth || comp.h != config.scaledHeight)
+    {
+      fprintf(stderr, "%s: component %u is %ux%u, requested %ux%u\n", config.label, compno,
+              comp.w, comp.h, config.scaledWidth, config.scaledHeight);
+      return false;
+    }
+    auto expected = areaAverage(reference->comps[compno], comp.w, comp.h);
+    for(uint32_t y = 0; y < comp.h; ++y)
+    {
+      for(uint32_t x = 0; x < comp.w; ++x)
+      {
+        int32_t val = sampleAt(comp, (uint64_t)y * comp.stride + x);
+        double ref = expected[(size_t)y * comp.w + x];
+        if(std::fabs(val - ref) > 1.0)
+        {
+          fprintf(stderr, "%s: component %u sample (%u,%u) is %d, area average is %.2f\n",
+                  config.label, compno, x, y, val, ref);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool check(const Config& config)
+{
+  std::string path = std::string("scaled_") + config.label + ".j2k";
+  if(!compress(path, config))
+    return false;
+  grk_object* codec = openCodec(path, config, 0, true);
+  uint8_t reduce = expectedReduce(config);
+  grk_object* refCodec = openCodec(path, config, reduce, false);
+  bool ok = codec && refCodec;
+  if(!ok)
+    fprintf(stderr, "%s: decompress failed\n", config.label);
+  else
+    ok = compare(config, grk_decompress_get_scaled_image(codec),
+                 grk_decompress_get_image(refCodec));
+  grk_object_unref(refCodec);
+  grk_object_unref(codec);
+  if(ok)
+    printf("%s: %ux%u matches the area average of reduction %u\n", config.label,
+           config.scaledWidth, config.scaledHeight, reduce);
+  remove(path.c_str());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"reversible_full", false, false, 150, 120, {0, 0, 0, 0}},
+      {"reversible_reduced", false, false, 70, 50, {0, 0, 0, 0}},
+      {"irreversible_reduced", true, false, 40, 30, {0, 0, 0, 0}},
+      {"reversible_window", false, false, 60, 40, {13, 9, 190, 150}},
+      {"ht_reversible", false, true, 97, 61, {0, 0, 0, 0}},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,313 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Outputs that cannot seek get their bands front to back.  A TIFF written to a FIFO
+// carries a directory built up front, without libtiff: read back through libtiff, its
+// tags and scanlines must match a TIFF that libtiff wrote to a file.  A RAW file with
+// several components takes one band at a time into every component plane, and must
+// match the whole-image writer byte for byte; a single component RAW streams to a FIFO.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tiffio.h>
+
+#include "grok_codec.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 211;
+const uint32_t IMAGE_HEIGHT = 167;
+const uint32_t TILE_WIDTH = 64;
+const uint32_t TILE_HEIGHT = 48;
+
+struct Config
+{
+  const char* label;
+  uint16_t numcomps;
+  uint8_t prec;
+};
+
+bool readWholeFile(const std::string& path, std::vector<uint8_t>& contents)
+{
+  FILE* file = fopen(path.c_str(), "rb");
+  if(!file)
+    return false;
+  contents.clear();
+  uint8_t chunk[65536];
+  size_t got = 0;
+  while((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    contents.insert(contents.end(), chunk, chunk + got);
+  fclose(file);
+
+  return true;
+}
+
+bool writeWholeFile(const std::string& path, const std::vector<uint8_t>& contents)
+{
+  FILE* file = fopen(path.c_str(), "wb");
+  if(!file)
+    return false;
+  bool rc = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+
+  return fclose(file) == 0 && rc;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image_comp params[4] = {};
+  for(uint16_t compno = 0; compno < config.numcomps; ++compno)
+  {
+    auto& p = params[compno];
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = config.prec;
+    p.sgnd = false;
+  }
+  auto colourSpace = config.numcomps >= 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY;
+  grk_image* image = grk_image_new(config.numcomps, params, colourSpace, true);
+  if(!image)
+    return false;
+  uint32_t mask = (1U << config.prec) - 1;
+  for(uint16_t compno = 0; compno < config.numcomps; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 20;
+        data[(size_t)y * stride + x] = (int32_t)((x * 37U + y * (11U + compno) + noise) & mask);
+      }
+    }
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_WIDTH;
+  parameters.t_height = TILE_HEIGHT;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+
+  return ok;
+}
+
+int decompress(const std::string& input, const std::string& output, uint8_t precision = 0)
+{
+  // a precision option turns the incremental band write off
+  std::string precisionArg = std::to_string(precision) + "S";
+  const char* argv[] = {"grk_decompress", "-i", input.c_str(), "-o", output.c_str(),
+                        "-p",             precisionArg.c_str()};
+  return grk_codec_decompress(precision ? 7 : 5, argv);
+}
+
+// decompresses into a FIFO while a reader thread collects what comes out of it
+bool decompressToFifo(const std::string& input, const std::string& fifo,
+                      std::vector<uint8_t>& contents)
+{
+  remove(fifo.c_str());
+  if(mkfifo(fifo.c_str(), 0600) != 0)
+  {
+    fprintf(stderr, "could not create FIFO %s\n", fifo.c_str());
+    return false;
+  }
+  std::thread reader([&fifo, &contents]() { readWholeFile(fifo, contents); });
+  int rc = decompress(input, fifo);
+  // a decompress that never opened the FIFO leaves the reader waiting for a writer
+  int fd = open(fifo.c_str(), O_WRONLY | O_NONBLOCK);
+  if(fd >= 0)
+    close(fd);
+  reader.join();
+  remove(fifo.c_str());
+
+  return rc == EXIT_SUCCESS;
+}
+
+bool compareTiffs(const Config& config, const std::string& streamed, const std::string& written)
+{
+  TIFF* a = TIFFOpen(streamed.c_str(), "r");
+  TIFF* b = TIFFOpen(written.c_str(), "r");
+  bool ok = a && b;
+  if(!ok)
+    fprintf(stderr, "%s: libtiff could not open %s or %s\n", config.label, streamed.c_str(),
+            written.c_str());
+  const uint32_t tags[] = {TIFFTAG_IMAGEWIDTH,      TIFFTAG_IMAGELENGTH,   TIFFTAG_BITSPERSAMPLE,
+                           TIFFTAG_SAMPLESPERPIXEL, TIFFTAG_PHOTOMETRIC,   TIFFTAG_SAMPLEFORMAT,
+                           TIFFTAG_PLANARCONFIG,    TIFFTAG_ROWSPERSTRIP, TIFFTAG_COMPRESSION};
+  for(size_t i = 0; ok && i < sizeof(tags) / sizeof(tags[0]); ++i)
+  {
+    uint32_t va = 0;
+    uint32_t vb = 0;
+    if(tags[i] == TIFFTAG_IMAGEWIDTH || tags[i] == TIFFTAG_IMAGELENGTH ||
+       tags[i] == TIFFTAG_ROWSPERSTRIP)
+    {
+      TIFFGetFieldDefaulted(a, tags[i], &va);
+      TIFFGetFieldDefaulted(b, tags[i], &vb);
+    }
+    else
+    {
+      uint16_t sa = 0;
+      uint16_t sb = 0;
+      TIFFGetFieldDefaulted(a, tags[i], &sa);
+      TIFFGetFieldDefaulted(b, tags[i], &sb);
+      va = sa;
+      vb = sb;
+    }
+    if(va != vb)
+    {
+      fprintf(stderr, "%s: tag %u is %u in the stream, %u in the file\n", config.label, tags[i],
+              va, vb);
+      ok = false;
+    }
+  }
+  if(ok)
+  {
+    uint16_t extraA = 0;
+    uint16_t extraB = 0;
+    uint16_t* typesA = nullptr;
+    uint16_t* typesB = nullptr;
+    TIFFGetFieldDefaulted(a, TIFFTAG_EXTRASAMPLES, &extraA, &typesA);
+    TIFFGetFieldDefaulted(b, TIFFTAG_EXTRASAMPLES, &extraB, &typesB);
+    for(uint16_t i = 0; ok && i < extraA && i < extraB; ++i)
+      ok = typesA[i] == typesB[i];
+    if(!ok || extraA != extraB)
+    {
+      fprintf(stderr, "%s: extra samples differ\n", config.label);
+      ok = false;
+    }
+  }
+  if(ok)
+  {
+    tmsize_t lineBytes = TIFFScanlineSize(a);
+    std::vector<uint8_t> la((size_t)lineBytes);
+    std::vector<uint8_t> lb((size_t)lineBytes);
+    ok = lineBytes == TIFFScanlineSize(b);
+    for(uint32_t y = 0; ok && y < IMAGE_HEIGHT; ++y)
+    {
+      ok = TIFFReadScanline(a, la.data(), y, 0) == 1 && TIFFReadScanline(b, lb.data(), y, 0) == 1 &&
+           la == lb;
+      if(!ok)
+        fprintf(stderr, "%s: scanline %u differs\n", config.label, y);
+    }
+  }
+  if(a)
+    TIFFClose(a);
+  if(b)
+    TIFFClose(b);
+
+  return ok;
+}
+
+bool checkTiff(const std::string& input, const Config& config)
+{
+  std::string fifo = std::string("stream_") + config.label + "_fifo.tif";
+  std::string streamed = std::string("stream_") + config.label + "_piped.tif";
+  std::string written = std::string("stream_") + config.label + "_file.tif";
+  std::vector<uint8_t> contents;
+  bool ok = decompressToFifo(input, fifo, contents) && writeWholeFile(streamed, contents);
+  if(!ok)
+    fprintf(stderr, "%s: TIFF stream decompress failed\n", config.label);
+  else if(decompress(input, written) != EXIT_SUCCESS)
+  {
+    fprintf(stderr, "%s: TIFF file decompress failed\n", config.label);
+    ok = false;
+  }
+  else
+  {
+    ok = compareTiffs(config, streamed, written);
+  }
+  remove(streamed.c_str());
+  remove(written.c_str());
+
+  return ok;
+}
+
+bool checkRaw(const std::string& input, const Config& config)
+{
+  std::string bands = std::string("stream_") + config.label + "_bands.raw";
+  std::string whole = std::string("stream_") + config.label + "_whole.raw";
+  std::vector<uint8_t> bandBytes;
+  std::vector<uint8_t> wholeBytes;
+  bool ok = decompress(input, bands) == EXIT_SUCCESS &&
+            decompress(input, whole, config.prec) == EXIT_SUCCESS &&
+            readWholeFile(bands, bandBytes) && readWholeFile(whole, wholeBytes);
+  if(!ok)
+    fprintf(stderr, "%s: RAW decompress failed\n", config.label);
+  else if(bandBytes != wholeBytes)
+  {
+    fprintf(stderr, "%s: RAW band write differs from the whole-image writer\n", config.label);
+    ok = false;
+  }
+  if(ok && config.numcomps == 1)
+  {
+    std::vector<uint8_t> piped;
+    std::string fifo = std::string("stream_") + config.label + "_fifo.raw";
+    ok = decompressToFifo(input, fifo, piped) && piped == wholeBytes;
+    if(!ok)
+      fprintf(stderr, "%s: RAW streamed to a FIFO differs from the file\n", config.label);
+  }
+  remove(bands.c_str());
+  remove(whole.c_str());
+
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  TIFFSetWarningHandler(nullptr);
+
+  const Config configs[] = {
+      {"rgb8", 3, 8},
+      {"grey16", 1, 16},
+      {"rgba12", 4, 12},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+  {
+    std::string input = std::string("stream_") + config.label + ".j2k";
+    if(!compress(input, config))
+    {
+      fprintf(stderr, "%s: compress failed\n", config.label);
+      ok = false;
+      continue;
+    }
+    bool rc = checkTiff(input, config) && checkRaw(input, config);
+    if(rc)
+      printf("%s: streamed output matches the file writers\n", config.label);
+    ok = rc && ok;
+    remove(input.c_str());
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,227 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// a decode with grk_decompress_core_params::target_precision skips the code block
+// bit planes that cannot matter at that precision: reduced to the target precision,
+// its samples must stay within one code of a full decode's, for Part-1 and HT
+// code blocks, reversible and irreversible transforms, and reduced resolutions.
+// Part-1 decodes must also differ from the full decode somewhere, or no pass was
+// skipped. The HT encoder writes only the cleanup pass, which is all or nothing, so
+// HT decodes skip nothing and must match the full decode exactly.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 211;
+const uint32_t IMAGE_HEIGHT = 167;
+const uint16_t NUM_COMPS = 3;
+const uint8_t PREC = 16;
+const uint8_t TARGET_PREC = 8;
+
+struct Config
+{
+  const char* label;
+  bool irreversible;
+  bool ht;
+  uint8_t reduce;
+  // some passes are skipped, so full precision samples differ
+  bool skips;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = PREC;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        // smooth gradients with texture and a few hard edges
+        uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 22;
+        uint32_t edge = ((x / 37 + y / 29) & 1) ? 12000U : 0U;
+        data[(size_t)y * stride + x] =
+            (int32_t)((x * 211U + y * (97U + compno * 31U) + noise + edge) & 0xFFFF);
+      }
+    }
+  }
+  return image;
+}
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image* image = makeImage();
+  if(!image)
+  {
+    fprintf(stderr, "%s: could not build the source image\n", config.label);
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.irreversible = config.irreversible;
+  parameters.numresolution = 5;
+  if(config.ht)
+    parameters.cblk_sty = GRK_CBLKSTY_HT_ONLY;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "%s: compress failed\n", config.label);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+bool decompress(const std::string& path, const Config& config, uint8_t targetPrecision,
+                std::vector<int32_t>& out, uint32_t& width, uint32_t& height)
+{
+  grk_decompress_parameters params = {};
+  params.core.reduce = config.reduce;
+  params.core.target_precision = targetPrecision;
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool ok = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+  grk_image* image = ok ? grk_decompress_get_image(codec) : nullptr;
+  ok = image && image->numcomps == NUM_COMPS && image->comps[0].data;
+  if(ok)
+  {
+    width = image->comps[0].w;
+    height = image->comps[0].h;
+    out.resize((size_t)width * height * NUM_COMPS);
+    for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+    {
+      const auto& comp = image->comps[compno];
+      for(uint32_t y = 0; y < height; ++y)
+        for(uint32_t x = 0; x < width; ++x)
+          out[((size_t)compno * height + y) * width + x] =
+              sampleAt(comp, (uint64_t)y * comp.stride + x);
+    }
+  }
+  grk_object_unref(codec);
+  return ok;
+}
+
+bool check(const Config& config)
+{
+  std::string path = std::string("target_precision_") + config.label + ".j2k";
+  if(!compress(path, config))
+    return false;
+  std::vector<int32_t> full, reduced;
+  uint32_t fullW = 0, fullH = 0, w = 0, h = 0;
+  bool ok = decompress(path, config, 0, full, fullW, fullH) &&
+            decompress(path, config, TARGET_PREC, reduced, w, h);
+  if(!ok)
+    fprintf(stderr, "%s: decompress failed\n", config.label);
+  else if(w != fullW || h != fullH)
+  {
+    fprintf(stderr, "%s: dimensions %ux%u differ from %ux%u\n", config.label, w, h, fullW,
+            fullH);
+    ok = false;
+  }
+  const int32_t shift = PREC - TARGET_PREC;
+  size_t changed = 0;
+  for(size_t i = 0; ok && i < full.size(); ++i)
+  {
+    changed += full[i] != reduced[i];
+    int32_t diff = (full[i] >> shift) - (reduced[i] >> shift);
+    if(diff < -1 || diff > 1)
+    {
+      fprintf(stderr, "%s: sample %zu is %d at %u bits, full decode has %d\n", config.label, i,
+              reduced[i] >> shift, TARGET_PREC, full[i] >> shift);
+      ok = false;
+    }
+  }
+  if(ok && config.skips && !changed)
+  {
+    fprintf(stderr, "%s: matches the full decode, so no pass was skipped\n", config.label);
+    ok = false;
+  }
+  else if(ok && !config.skips && changed)
+  {
+    fprintf(stderr, "%s: %zu samples differ from the full decode, with no pass to skip\n",
+            config.label, changed);
+    ok = false;
+  }
+  if(ok)
+    printf("%s: within one code at %u bits, %zu samples changed\n", config.label, TARGET_PREC,
+           changed);
+  remove(path.c_str());
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Config configs[] = {
+      {"reversible", false, false, 0, true},
+      {"irreversible", true, false, 0, true},
+      {"reversible_reduced", false, false, 1, true},
+      {"ht_reversible", false, true, 0, false},
+      {"ht_irreversible", true, true, 0, false},
+  };
+  bool ok = true;
+  for(const auto& config : configs)
+    ok = check(config) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// grk_decompress_set_focus() and grk_decompress_set_tile_priority() reorder the tiles of a
+// TLM codestream. With two threads, at most four tiles are in flight, and a tile only
+// starts once the oldest one in flight is done, so the k-th tile to complete must be
+// among the first k + 3 in priority order. The output must match an unprioritized decode.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 256;
+const uint32_t IMAGE_HEIGHT = 256;
+const uint32_t TILE_WIDTH = 32;
+const uint32_t TILE_HEIGHT = 32;
+const uint16_t GRID_WIDTH = IMAGE_WIDTH / TILE_WIDTH;
+const uint16_t NUM_TILES = GRID_WIDTH * (IMAGE_HEIGHT / TILE_HEIGHT);
+const uint32_t NUM_THREADS = 2;
+const size_t MAX_IN_FLIGHT = 2 * NUM_THREADS;
+
+struct Config
+{
+  const char* label;
+  bool focus;
+  uint32_t focusX;
+  uint32_t focusY;
+  std::vector<std::pair<uint16_t, uint32_t>> priorities;
+};
+
+struct Completions
+{
+  std::mutex mutex;
+  std::vector<uint16_t> tiles;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+void onTile(void*, uint16_t tileIndex, grk_image*, uint8_t, void* userData)
+{
+  auto completions = static_cast<Completions*>(userData);
+  std::lock_guard<std::mutex> lock(completions->mutex);
+  completions->tiles.push_back(tileIndex);
+}
+
+bool compress(const std::string& path)
+{
+  grk_image_comp params = {};
+  params.dx = 1;
+  params.dy = 1;
+  params.w = IMAGE_WIDTH;
+  params.h = IMAGE_HEIGHT;
+  params.prec = 8;
+  params.sgnd = false;
+  grk_image* image = grk_image_new(1, &params, GRK_CLRSPC_GRAY, true);
+  if(!image)
+    return false;
+  auto* data = static_cast<int32_t*>(image->comps[0].data);
+  uint32_t stride = image->comps[0].stride;
+  for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+  {
+    for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+    {
+      uint32_t noise = ((x * 2654435761U) ^ (y * 40503U)) >> 26;
+      data[(size_t)y * stride + x] = (int32_t)((x * 3U + y * 5U + noise) & 0xFF);
+    }
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = 3;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_WIDTH;
+  parameters.t_height = TILE_HEIGHT;
+  parameters.write_tlm = true;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+/**
+ * Tiles in the order the decompressor should start them: explicit priorities first,
+ * then by distance of the tile centre from the focus, then by index
+ */
+std::vector<uint16_t> expectedOrder(const Config& config)
+{
+  std::vector<uint16_t> order(NUM_TILES);
+  for(uint16_t i = 0; i < NUM_TILES; ++i)
+    order[i] = i;
+  auto key = [&config](uint16_t t) {
+    uint64_t priority = UINT64_MAX;
+    for(const auto& p : config.priorities)
+      if(p.first == t)
+        priority = p.second;
+    double distance = 0;
+    if(priority == UINT64_MAX && config.focus)
+    {
+      double dx = (t % GRID_WIDTH) * TILE_WIDTH + TILE_WIDTH / 2.0 - config.focusX;
+      double dy = (t / GRID_WIDTH) * TILE_HEIGHT + TILE_HEIGHT / 2.0 - config.focusY;
+      distance = dx * dx + dy * dy;
+    }
+    return std::make_tuple(priority, distance, t);
+  };
+  std::sort(order.begin(), order.end(),
+            [&key](uint16_t a, uint16_t b) { return key(a) < key(b); });
+  return order;
+}
+
+bool decompress(const std::string& path, const Config* config, std::vector<int32_t>& samples,
+                Completions& completions)
+{
+  grk_decompress_parameters params = {};
+  params.decompress_callback = onTile;
+  params.decompress_callback_user_data = &completions;
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool ok = grk_decompress_read_header(codec, &headerInfo);
+  if(ok && config)
+  {
+    if(config->focus)
+      ok = grk_decompress_set_focus(codec, config->focusX, config->focusY);
+    for(const auto& p : config->priorities)
+      ok = ok && grk_decompress_set_tile_priority(codec, p.first, p.second);
+  }
+  ok = ok && grk_decompress(codec, nullptr);
+  grk_image* image = ok ? grk_decompress_get_image(codec) : nullptr;
+  ok = image && image->comps[0].data;
+  samples.clear();
+  if(ok)
+  {
+    const auto& comp = image->comps[0];
+    for(uint32_t y = 0; y < comp.h; ++y)
+      for(uint32_t x = 0; x < comp.w; ++x)
+        samples.push_back(static_cast<int32_t*>(comp.data)[(uint64_t)y * comp.stride + x]);
+  }
+  grk_object_unref(codec);
+  return ok;
+}
+
+bool check(const std::string& path, const Config& config, const std::vector<int32_t>& reference)
+{
+  std::vector<int32_t> samples;
+  Completions completions;
+  if(!decompress(path, &config, samples, completions))
+  {
+    fprintf(stderr, "%s: decompress failed\n", config.label);
+    return false;
+  }
+  if(samples != reference)
+  {
+    fprintf(stderr, "%s: output differs from the unprioritized decode\n", config.label);
+    return false;
+  }
+  if(completions.tiles.size() != NUM_TILES)
+  {
+    fprintf(stderr, "%s: %zu tiles completed, expected %u\n", config.label,
+            completions.tiles.size(), NUM_TILES);
+    return false;
+  }
+  auto order = expectedOrder(config);
+  for(size_t k = 0; k < completions.tiles.size(); ++k)
+  {
+    auto tile = completions.tiles[k];
+    size_t rank = (size_t)(std::find(order.begin(), order.end(), tile) - order.begin());
+    if(rank >= k + MAX_IN_FLIGHT)
+    {
+      fprintf(stderr, "%s: tile %u has priority rank %zu but was completion %zu\n",
+              config.label, tile, rank, k);
+      return false;
+    }
+  }
+  printf("%s: first tile to complete was %u\n", config.label, completions.tiles.front());
+  return true;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, NUM_THREADS, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const std::string path = "tile_priority.j2k";
+  bool ok = compress(path);
+  if(!ok)
+    fprintf(stderr, "compress failed\n");
+  std::vector<int32_t> reference;
+  Completions unprioritized;
+  if(ok && !decompress(path, nullptr, reference, unprioritized))
+  {
+    fprintf(stderr, "unprioritized decompress failed\n");
+    ok = false;
+  }
+  const Config configs[] = {
+      {"focus_bottom_right", true, IMAGE_WIDTH - 1, IMAGE_HEIGHT - 1, {}},
+      {"focus_centre", true, IMAGE_WIDTH / 2, IMAGE_HEIGHT / 2, {}},
+      {"tile_priorities", true, 0, 0, {{NUM_TILES - 1, 1}, {GRID_WIDTH, 0}}},
+  };
+  for(const auto& config : configs)
+    ok = ok && check(path, config, reference);
+  remove(path.c_str());
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
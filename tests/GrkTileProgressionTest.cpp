@@ -0,0 +1,181 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Each tile is compressed with the progression order changes carrying its own tile number.
+// Tile 0 first sends its lowest layer in RLCP and then the rest in LRCP, while tile 1
+// sends everything in CPRL: a tile that took the first entries of the list instead of its
+// own would stop after the lowest layer, and the lossless code stream would no longer
+// decompress to the source image.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint16_t NUM_COMPS = 3;
+const uint16_t NUM_LAYERS = 2;
+const uint8_t NUM_RESOLUTIONS = 4;
+const uint32_t WIDTH = 128;
+const uint32_t HEIGHT = 64;
+const uint32_t TILE_SIZE = 64;
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = WIDTH;
+    p.h = HEIGHT;
+    p.prec = 8;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  uint32_t state = 0x9e3779b9u;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto comp = image->comps + compno;
+    auto data = (int32_t*)comp->data;
+    for(uint32_t y = 0; y < comp->h; ++y)
+    {
+      for(uint32_t x = 0; x < comp->w; ++x)
+      {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[(size_t)y * comp->stride + x] =
+            (int32_t)((x * 3 + y * 5 + compno * 40 + (state & 31)) & 255);
+      }
+    }
+  }
+  return image;
+}
+
+void setProgression(grk_progression& prog, uint16_t tileno, uint16_t numLayers,
+                    GRK_PROG_ORDER order)
+{
+  prog.tileno = tileno;
+  prog.res_s = 0;
+  prog.comp_s = 0;
+  prog.lay_e = numLayers;
+  prog.res_e = NUM_RESOLUTIONS;
+  prog.comp_e = NUM_COMPS;
+  prog.specified_compression_poc_prog = order;
+}
+
+uint64_t compress(grk_image* image, std::vector<uint8_t>& out)
+{
+  grk_cparameters parameters;
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_SIZE;
+  parameters.t_height = TILE_SIZE;
+  parameters.numlayers = NUM_LAYERS;
+  parameters.layer_rate[0] = 40;
+  parameters.layer_rate[1] = 0;
+  parameters.allocation_by_rate_distortion = true;
+  // tile 1's only entry sits between the two entries of tile 0
+  setProgression(parameters.progression[0], 0, 1, GRK_RLCP);
+  setProgression(parameters.progression[1], 1, NUM_LAYERS, GRK_CPRL);
+  setProgression(parameters.progression[2], 0, NUM_LAYERS, GRK_LRCP);
+  parameters.numpocs = 2;
+
+  out.assign((size_t)NUM_COMPS * WIDTH * HEIGHT * 2 + 4096, 0);
+  grk_stream_params streamParams = {};
+  streamParams.buf = out.data();
+  streamParams.buf_len = out.size();
+  uint64_t length = 0;
+  auto codec = grk_compress_init(&streamParams, &parameters, image);
+  if(codec)
+    length = grk_compress(codec, nullptr);
+  grk_object_unref(codec);
+  out.resize(length);
+
+  return length;
+}
+
+bool matchesSource(std::vector<uint8_t>& file, const grk_image* source)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  streamParams.buf = file.data();
+  streamParams.buf_len = file.size();
+  auto codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool ok = false;
+  if(grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr))
+  {
+    auto image = grk_decompress_get_image(codec);
+    ok = image && image->numcomps == NUM_COMPS;
+    for(uint16_t compno = 0; ok && compno < NUM_COMPS; ++compno)
+    {
+      auto comp = image->comps + compno;
+      auto src = source->comps + compno;
+      ok = comp->data && comp->w == src->w && comp->h == src->h;
+      for(uint32_t y = 0; ok && y < comp->h; ++y)
+      {
+        for(uint32_t x = 0; x < comp->w; ++x)
+        {
+          int32_t v = comp->data_type == GRK_INT_16
+                          ? ((int16_t*)comp->data)[(size_t)y * comp->stride + x]
+                          : ((int32_t*)comp->data)[(size_t)y * comp->stride + x];
+          if(v != ((int32_t*)src->data)[(size_t)y * src->stride + x])
+          {
+            fprintf(stderr, "component %u differs at (%u,%u), in tile %u\n", compno, x, y,
+                    x / TILE_SIZE);
+            ok = false;
+            break;
+          }
+        }
+      }
+    }
+  }
+  grk_object_unref(codec);
+
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  auto image = makeImage();
+  std::vector<uint8_t> file;
+  bool ok = image && compress(image, file) != 0;
+  if(!ok)
+    fprintf(stderr, "compress failed\n");
+  ok = ok && matchesSource(file, image);
+  if(ok)
+    printf("each tile follows its own progression order changes\n");
+  if(image)
+    grk_object_unref(&image->obj);
+  grk_deinitialize();
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
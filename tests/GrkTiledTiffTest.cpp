@@ -0,0 +1,372 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// TIFF output written as tiles with --tiff-tile-size, tiles compressed concurrently and
+// stored in order, must read back through libtiff to the pixels of the strip writer, for
+// several compressions and for tile sizes that leave padded tiles on the right and bottom
+// edges. With --pyramid, every overview directory is tiled too, and must match the strip
+// writer's overview of the same reduction. Overview levels are not post-processed, so
+// --pyramid with a precision conversion of TIFF output must be refused. JPEG tiles,
+// whose tables live in the directory, must decode to close to the uncompressed tiles.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <tiffio.h>
+
+#include "grok_codec.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 211;
+const uint32_t IMAGE_HEIGHT = 167;
+const uint32_t TILE_WIDTH = 64;
+const uint32_t TILE_HEIGHT = 48;
+const uint8_t NUM_RESOLUTIONS = 5;
+const char* PYRAMID = "1,2";
+// the full image and one overview per pyramid reduction
+const uint16_t NUM_DIRECTORIES = 3;
+
+struct Config
+{
+  const char* label;
+  uint16_t numcomps;
+  uint8_t prec;
+};
+
+// samples of one TIFF directory, as libtiff decodes them
+struct Directory
+{
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t subfileType = 0;
+  uint16_t compression = 0;
+  std::vector<uint8_t> pixels;
+};
+
+bool compress(const std::string& path, const Config& config)
+{
+  grk_image_comp params[3] = {};
+  for(uint16_t compno = 0; compno < config.numcomps; ++compno)
+  {
+    auto& p = params[compno];
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = config.prec;
+    p.sgnd = false;
+  }
+  auto colourSpace = config.numcomps >= 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY;
+  grk_image* image = grk_image_new(config.numcomps, params, colourSpace, true);
+  if(!image)
+    return false;
+  uint32_t mask = (1U << config.prec) - 1;
+  for(uint16_t compno = 0; compno < config.numcomps; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 22;
+        data[(size_t)y * stride + x] = (int32_t)((x * 37U + y * (11U + compno) + noise) & mask);
+      }
+    }
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_WIDTH;
+  parameters.t_height = TILE_HEIGHT;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+
+  return ok;
+}
+
+// tileSize is empty for strips
+int decompress(const std::string& input, const std::string& output, const char* compression,
+               const char* tileSize)
+{
+  std::vector<const char*> argv = {"grk_decompress", "-i",      input.c_str(), "-o",
+                                   output.c_str(),   "-c",      compression,   "--pyramid",
+                                   PYRAMID};
+  if(*tileSize)
+  {
+    argv.push_back("--tiff-tile-size");
+    argv.push_back(tileSize);
+  }
+  return grk_codec_decompress((int)argv.size(), argv.data());
+}
+
+// lossy tiles are not checked for blank padding
+bool readDirectory(TIFF* tif, const std::string& label, bool lossy, Directory& dir)
+{
+  TIFFGetFieldDefaulted(tif, TIFFTAG_IMAGEWIDTH, &dir.width);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_IMAGELENGTH, &dir.height);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_SUBFILETYPE, &dir.subfileType);
+  TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &dir.compression);
+  tmsize_t lineBytes = TIFFScanlineSize(tif);
+  dir.pixels.assign((size_t)lineBytes * dir.height, 0);
+  if(!TIFFIsTiled(tif))
+  {
+    for(uint32_t y = 0; y < dir.height; ++y)
+    {
+      if(TIFFReadScanline(tif, dir.pixels.data() + (size_t)y * lineBytes, y, 0) != 1)
+      {
+        fprintf(stderr, "%s: scanline %u could not be read\n", label.c_str(), y);
+        return false;
+      }
+    }
+    return true;
+  }
+  uint32_t tileWidth = 0;
+  uint32_t tileHeight = 0;
+  TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tileWidth);
+  TIFFGetField(tif, TIFFTAG_TILELENGTH, &tileHeight);
+  size_t pixelBytes = (size_t)lineBytes / dir.width;
+  size_t tileRowBytes = (size_t)tileWidth * pixelBytes;
+  tmsize_t tileBytes = TIFFTileSize(tif);
+  std::vector<uint8_t> tile((size_t)tileBytes);
+  for(uint32_t ty = 0; ty < dir.height; ty += tileHeight)
+  {
+    for(uint32_t tx = 0; tx < dir.width; tx += tileWidth)
+    {
+      // edge tiles are stored at full size
+      if(TIFFReadTile(tif, tile.data(), tx, ty, 0, 0) != tileBytes)
+      {
+        fprintf(stderr, "%s: tile at (%u,%u) could not be read\n", label.c_str(), tx, ty);
+        return false;
+      }
+      uint32_t w = std::min(tileWidth, dir.width - tx);
+      uint32_t h = std::min(tileHeight, dir.height - ty);
+      for(uint32_t y = 0; y < tileHeight; ++y)
+      {
+        auto row = tile.data() + y * tileRowBytes;
+        if(y < h)
+          std::copy(row, row + w * pixelBytes,
+                    dir.pixels.data() + (size_t)(ty + y) * lineBytes + tx * pixelBytes);
+        // and their padding is blank
+        if(lossy)
+          continue;
+        size_t padFrom = y < h ? w * pixelBytes : 0;
+        for(size_t i = padFrom; i < tileRowBytes; ++i)
+        {
+          if(row[i])
+          {
+            fprintf(stderr, "%s: padding of the tile at (%u,%u) is not blank\n", label.c_str(),
+                    tx, ty);
+            return false;
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool readTiff(const std::string& path, bool tiled, bool lossy, std::vector<Directory>& dirs)
+{
+  TIFF* tif = TIFFOpen(path.c_str(), "r");
+  if(!tif)
+  {
+    fprintf(stderr, "libtiff could not open %s\n", path.c_str());
+    return false;
+  }
+  bool ok = true;
+  dirs.clear();
+  do
+  {
+    std::string label = path + " directory " + std::to_string(dirs.size());
+    if(!TIFFIsTiled(tif) != !tiled)
+    {
+      fprintf(stderr, "%s is %s\n", label.c_str(), tiled ? "not tiled" : "tiled");
+      ok = false;
+      break;
+    }
+    dirs.emplace_back();
+    ok = readDirectory(tif, label, lossy, dirs.back());
+  } while(ok && TIFFReadDirectory(tif));
+  TIFFClose(tif);
+
+  return ok;
+}
+
+bool check(const std::string& input, const Config& config, const char* compression,
+           const char* tileSize)
+{
+  std::string prefix = std::string("tiled_") + config.label + "_" + compression;
+  std::string tiledPath = prefix + "_tiles.tif";
+  std::string stripPath = prefix + "_strips.tif";
+  std::string label = prefix + " " + tileSize;
+  std::vector<Directory> tiled;
+  std::vector<Directory> strips;
+  bool ok = decompress(input, tiledPath, compression, tileSize) == EXIT_SUCCESS &&
+            decompress(input, stripPath, compression, "") == EXIT_SUCCESS;
+  if(!ok)
+    fprintf(stderr, "%s: decompress failed\n", label.c_str());
+  ok = ok && readTiff(tiledPath, true, false, tiled) && readTiff(stripPath, false, false, strips);
+  if(ok && (tiled.size() != NUM_DIRECTORIES || strips.size() != NUM_DIRECTORIES))
+  {
+    fprintf(stderr, "%s: %zu tiled and %zu strip directories, expected %u\n", label.c_str(),
+            tiled.size(), strips.size(), NUM_DIRECTORIES);
+    ok = false;
+  }
+  for(size_t i = 0; ok && i < tiled.size(); ++i)
+  {
+    const auto& a = tiled[i];
+    const auto& b = strips[i];
+    if(a.width != b.width || a.height != b.height || a.subfileType != b.subfileType ||
+       a.compression != b.compression)
+    {
+      fprintf(stderr, "%s: directory %zu is %ux%u, type %u, compression %u tiled, "
+              "%ux%u, type %u, compression %u in strips\n",
+              label.c_str(), i, a.width, a.height, a.subfileType, a.compression, b.width,
+              b.height, b.subfileType, b.compression);
+      ok = false;
+    }
+    else if(a.pixels != b.pixels)
+    {
+      fprintf(stderr, "%s: directory %zu pixels differ from the strip writer\n", label.c_str(),
+              i);
+      ok = false;
+    }
+  }
+  if(ok)
+    printf("%s: %zu tiled directories match the strip writer\n", label.c_str(), tiled.size());
+  remove(tiledPath.c_str());
+  remove(stripPath.c_str());
+
+  return ok;
+}
+// JPEG tiles are compressed on the output handle, so that they share its tables
+bool checkJpeg(const std::string& input, const Config& config, const char* tileSize)
+{
+  std::string prefix = std::string("tiled_") + config.label + "_JPEG";
+  std::string jpegPath = prefix + "_tiles.tif";
+  std::string plainPath = prefix + "_plain.tif";
+  std::string label = prefix + " " + tileSize;
+  std::vector<Directory> jpeg;
+  std::vector<Directory> plain;
+  bool ok = decompress(input, jpegPath, "JPEG", tileSize) == EXIT_SUCCESS &&
+            decompress(input, plainPath, "NONE", tileSize) == EXIT_SUCCESS;
+  if(!ok)
+    fprintf(stderr, "%s: decompress failed\n", label.c_str());
+  ok = ok && readTiff(jpegPath, true, true, jpeg) && readTiff(plainPath, true, false, plain);
+  if(ok && (jpeg.size() != NUM_DIRECTORIES || plain.size() != NUM_DIRECTORIES))
+  {
+    fprintf(stderr, "%s: %zu JPEG and %zu uncompressed directories, expected %u\n",
+            label.c_str(), jpeg.size(), plain.size(), NUM_DIRECTORIES);
+    ok = false;
+  }
+  for(size_t i = 0; ok && i < jpeg.size(); ++i)
+  {
+    const auto& a = jpeg[i];
+    const auto& b = plain[i];
+    if(a.width != b.width || a.height != b.height || a.compression != COMPRESSION_JPEG)
+    {
+      fprintf(stderr, "%s: directory %zu is %ux%u, compression %u, expected %ux%u JPEG\n",
+              label.c_str(), i, a.width, a.height, a.compression, b.width, b.height);
+      ok = false;
+      continue;
+    }
+    // the test image is mostly noise, which JPEG only approximates
+    uint64_t error = 0;
+    for(size_t j = 0; j < a.pixels.size(); ++j)
+      error += (uint64_t)std::abs((int)a.pixels[j] - (int)b.pixels[j]);
+    double meanError = a.pixels.empty() ? 0 : (double)error / (double)a.pixels.size();
+    if(meanError > 40.0)
+    {
+      fprintf(stderr, "%s: directory %zu is off by %.1f per sample on average\n", label.c_str(),
+              i, meanError);
+      ok = false;
+    }
+  }
+  if(ok)
+    printf("%s: %zu JPEG tiled directories decode\n", label.c_str(), jpeg.size());
+  remove(jpegPath.c_str());
+  remove(plainPath.c_str());
+
+  return ok;
+}
+
+bool checkRefused(const std::string& input, const Config& config)
+{
+  std::string output = std::string("tiled_") + config.label + "_precision.tif";
+  const char* argv[] = {"grk_decompress", "-i", input.c_str(), "-o", output.c_str(),
+                        "--pyramid",      PYRAMID, "-p",      "4"};
+  bool ok = grk_codec_decompress(9, argv) != EXIT_SUCCESS;
+  if(ok)
+    printf("%s: --pyramid with a precision conversion is refused\n", config.label);
+  else
+    fprintf(stderr, "%s: --pyramid with a precision conversion was accepted\n", config.label);
+  remove(output.c_str());
+
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  TIFFSetWarningHandler(nullptr);
+
+  const Config configs[] = {
+      {"rgb8", 3, 8},
+      {"grey16", 1, 16},
+  };
+  const char* compressions[] = {"NONE", "LZW", "PACKBITS"};
+  // neither size divides the image, nor its overviews
+  const char* tileSizes[] = {"32", "48,16"};
+  bool ok = true;
+  for(const auto& config : configs)
+  {
+    std::string input = std::string("tiled_") + config.label + ".j2k";
+    if(!compress(input, config))
+    {
+      fprintf(stderr, "%s: compress failed\n", config.label);
+      ok = false;
+      continue;
+    }
+    for(auto compression : compressions)
+    {
+      for(auto tileSize : tileSizes)
+        ok = check(input, config, compression, tileSize) && ok;
+    }
+    // JPEG in TIFF takes 8-bit samples
+    if(config.prec == 8 && TIFFIsCODECConfigured(COMPRESSION_JPEG))
+    {
+      for(auto tileSize : tileSizes)
+        ok = checkJpeg(input, config, tileSize) && ok;
+    }
+    ok = checkRefused(input, config) && ok;
+    remove(input.c_str());
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
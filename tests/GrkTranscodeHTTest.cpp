@@ -0,0 +1,299 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// grk_transcode with transcode_ht must recode a Part 1 code stream with the HT block
+// coder, and the result must decompress to exactly the samples the source decompresses
+// to: reversible and irreversible, with MCT, tiles, precincts and several layers.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t WIDTH = 300;
+const uint32_t HEIGHT = 236;
+const uint8_t PRECISION = 8;
+
+struct Case
+{
+  const char* label;
+  uint16_t numComps;
+  bool irreversible;
+  uint32_t tileSize;
+  bool precincts;
+  uint16_t numLayers;
+};
+
+struct Decoded
+{
+  bool ht = false;
+  std::vector<std::vector<int32_t>> samples;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+uint32_t xorshift32(uint32_t& state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// gradients and ripples with some noise, so that every sub-band has content
+grk_image* makeImage(uint16_t numComps)
+{
+  std::vector<grk_image_comp> params(numComps);
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = WIDTH;
+    p.h = HEIGHT;
+    p.prec = PRECISION;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(numComps, params.data(),
+                             numComps == 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY, true);
+  if(!image)
+    return nullptr;
+  uint32_t state = 0x9e3779b9u;
+  for(uint16_t compno = 0; compno < numComps; ++compno)
+  {
+    auto comp = image->comps + compno;
+    auto data = (int32_t*)comp->data;
+    for(uint32_t y = 0; y < HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < WIDTH; ++x)
+      {
+        double v = 96.0 + 0.2 * x + 0.1 * (y + 30.0 * compno) +
+                   40.0 * std::sin(x * 0.07 + compno) * std::cos(y * 0.05) +
+                   (double)(xorshift32(state) % 24);
+        data[(size_t)y * comp->stride + x] = std::clamp((int32_t)v, 0, 255);
+      }
+    }
+  }
+  return image;
+}
+
+// compresses a Part 1 JP2 file; returns its length, or 0 on failure
+uint64_t compress(const Case& c, std::vector<uint8_t>& out)
+{
+  auto image = makeImage(c.numComps);
+  if(!image)
+    return 0;
+  grk_cparameters parameters;
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_JP2;
+  parameters.irreversible = c.irreversible;
+  parameters.numresolution = 5;
+  parameters.cblockw_init = 32;
+  parameters.cblockh_init = 32;
+  if(c.tileSize)
+  {
+    parameters.tile_size_on = true;
+    parameters.t_width = c.tileSize;
+    parameters.t_height = c.tileSize;
+  }
+  if(c.precincts)
+  {
+    parameters.csty |= 0x01;
+    parameters.res_spec = 2;
+    parameters.prcw_init[0] = parameters.prch_init[0] = 64;
+    parameters.prcw_init[1] = parameters.prch_init[1] = 32;
+  }
+  parameters.numlayers = c.numLayers;
+  if(c.numLayers > 1)
+  {
+    for(uint16_t i = 0; i < c.numLayers - 1; ++i)
+      parameters.layer_rate[i] = 40.0 / (i + 1);
+    parameters.layer_rate[c.numLayers - 1] = 0;
+    parameters.allocation_by_rate_distortion = true;
+  }
+
+  out.assign((size_t)c.numComps * WIDTH * HEIGHT * 2 + 4096, 0);
+  grk_stream_params streamParams = {};
+  streamParams.buf = out.data();
+  streamParams.buf_len = out.size();
+  uint64_t length = 0;
+  auto codec = grk_compress_init(&streamParams, &parameters, image);
+  if(codec)
+    length = grk_compress(codec, nullptr);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  out.resize(length);
+
+  return length;
+}
+
+// recodes a Part 1 file with the HT block coder; returns its length, or 0 on failure
+uint64_t transcode(std::vector<uint8_t>& src, std::vector<uint8_t>& out)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params headerStream = {};
+  headerStream.is_read_stream = true;
+  headerStream.buf = src.data();
+  headerStream.buf_len = src.size();
+  auto codec = grk_decompress_init(&headerStream, &params);
+  if(!codec)
+    return 0;
+  grk_header_info headerInfo = {};
+  uint64_t length = 0;
+  grk_image* image = nullptr;
+  if(grk_decompress_read_header(codec, &headerInfo))
+    image = grk_decompress_get_image(codec);
+  if(image)
+  {
+    grk_cparameters parameters;
+    grk_compress_set_default_params(&parameters);
+    parameters.cod_format = GRK_FMT_JP2;
+    parameters.transcode_ht = true;
+    grk_stream_params srcStream = {};
+    srcStream.buf = src.data();
+    srcStream.buf_len = src.size();
+    out.assign(src.size() * 2 + 4096, 0);
+    grk_stream_params dstStream = {};
+    dstStream.buf = out.data();
+    dstStream.buf_len = out.size();
+    length = grk_transcode(&srcStream, &dstStream, &parameters, image);
+    out.resize(length);
+  }
+  grk_object_unref(codec);
+
+  return length;
+}
+
+bool decompress(std::vector<uint8_t>& file, Decoded& decoded)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  streamParams.buf = file.data();
+  streamParams.buf_len = file.size();
+  auto codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return false;
+  grk_header_info headerInfo = {};
+  bool ok = false;
+  if(grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr))
+  {
+    auto image = grk_decompress_get_image(codec);
+    ok = image != nullptr;
+    decoded.ht = (headerInfo.cblk_sty & GRK_CBLKSTY_HT_ONLY) != 0;
+    decoded.samples.clear();
+    for(uint16_t compno = 0; ok && compno < image->numcomps; ++compno)
+    {
+      const auto& comp = image->comps[compno];
+      if(!comp.data || comp.w != WIDTH || comp.h != HEIGHT)
+      {
+        ok = false;
+        break;
+      }
+      auto& s = decoded.samples.emplace_back((size_t)WIDTH * HEIGHT);
+      for(uint32_t y = 0; y < HEIGHT; ++y)
+      {
+        for(uint32_t x = 0; x < WIDTH; ++x)
+        {
+          uint64_t index = (uint64_t)y * comp.stride + x;
+          s[(size_t)y * WIDTH + x] = comp.data_type == GRK_INT_16 ? ((int16_t*)comp.data)[index]
+                                                                  : ((int32_t*)comp.data)[index];
+        }
+      }
+    }
+  }
+  grk_object_unref(codec);
+
+  return ok;
+}
+
+bool check(const Case& c)
+{
+  std::vector<uint8_t> source;
+  std::vector<uint8_t> recoded;
+  if(!compress(c, source))
+  {
+    fprintf(stderr, "%s: compress failed\n", c.label);
+    return false;
+  }
+  if(!transcode(source, recoded))
+  {
+    fprintf(stderr, "%s: transcode failed\n", c.label);
+    return false;
+  }
+  Decoded expected;
+  Decoded actual;
+  if(!decompress(source, expected) || !decompress(recoded, actual))
+  {
+    fprintf(stderr, "%s: decompress failed\n", c.label);
+    return false;
+  }
+  if(expected.ht || !actual.ht)
+  {
+    fprintf(stderr, "%s: transcoded code stream is not HTJ2K\n", c.label);
+    return false;
+  }
+  if(actual.samples.size() != expected.samples.size())
+  {
+    fprintf(stderr, "%s: component count changed\n", c.label);
+    return false;
+  }
+  for(size_t compno = 0; compno < expected.samples.size(); ++compno)
+  {
+    auto mismatch = std::mismatch(expected.samples[compno].begin(), expected.samples[compno].end(),
+                                  actual.samples[compno].begin());
+    if(mismatch.first != expected.samples[compno].end())
+    {
+      auto i = (size_t)(mismatch.first - expected.samples[compno].begin());
+      fprintf(stderr, "%s: component %zu differs at (%zu,%zu): %d != %d\n", c.label, compno,
+              i % WIDTH, i / WIDTH, *mismatch.first, *mismatch.second);
+      return false;
+    }
+  }
+  printf("%s: %zu Part 1 bytes, %zu HTJ2K bytes\n", c.label, source.size(), recoded.size());
+
+  return true;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Case cases[] = {
+      {"reversible_gray", 1, false, 0, false, 1},
+      {"irreversible_rgb", 3, true, 0, false, 1},
+      {"reversible_tiled_precincts_layers", 3, false, 128, true, 3},
+      {"irreversible_tiled", 1, true, 100, false, 1},
+  };
+  bool ok = true;
+  for(const auto& c : cases)
+    ok = check(c) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
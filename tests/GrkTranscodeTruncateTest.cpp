@@ -0,0 +1,328 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// grk_transcode with transcode_target_size must truncate a multi-layer Part 1 code
+// stream to about the target size without decoding it: the result must decompress,
+// and its PSNR against the original image must rise with the target, for reversible
+// and irreversible sources, with MCT, tiles, precincts and coding bypass.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t WIDTH = 300;
+const uint32_t HEIGHT = 236;
+const uint8_t PRECISION = 8;
+const uint16_t NUM_LAYERS = 8;
+// JP2 boxes and headers outside the rate controlled packets
+const uint64_t OVERHEAD = 1024;
+
+struct Case
+{
+  const char* label;
+  uint16_t numComps;
+  bool irreversible;
+  uint32_t tileSize;
+  bool precincts;
+  uint8_t cblkSty;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+uint32_t xorshift32(uint32_t& state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// gradients and ripples with some noise, so that every sub-band has content
+grk_image* makeImage(uint16_t numComps)
+{
+  std::vector<grk_image_comp> params(numComps);
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = WIDTH;
+    p.h = HEIGHT;
+    p.prec = PRECISION;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(numComps, params.data(),
+                             numComps == 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY, true);
+  if(!image)
+    return nullptr;
+  uint32_t state = 0x9e3779b9u;
+  for(uint16_t compno = 0; compno < numComps; ++compno)
+  {
+    auto comp = image->comps + compno;
+    auto data = (int32_t*)comp->data;
+    for(uint32_t y = 0; y < HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < WIDTH; ++x)
+      {
+        double v = 96.0 + 0.2 * x + 0.1 * (y + 30.0 * compno) +
+                   40.0 * std::sin(x * 0.07 + compno) * std::cos(y * 0.05) +
+                   (double)(xorshift32(state) % 24);
+        data[(size_t)y * comp->stride + x] = std::clamp((int32_t)v, 0, 255);
+      }
+    }
+  }
+  return image;
+}
+
+std::vector<std::vector<int32_t>> samplesOf(const grk_image* image)
+{
+  std::vector<std::vector<int32_t>> samples;
+  for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+  {
+    const auto& comp = image->comps[compno];
+    auto& s = samples.emplace_back((size_t)WIDTH * HEIGHT);
+    for(uint32_t y = 0; y < HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < WIDTH; ++x)
+      {
+        uint64_t index = (uint64_t)y * comp.stride + x;
+        s[(size_t)y * WIDTH + x] = comp.data_type == GRK_INT_16 ? ((int16_t*)comp.data)[index]
+                                                                : ((int32_t*)comp.data)[index];
+      }
+    }
+  }
+  return samples;
+}
+
+// compresses a Part 1 JP2 file with many layers; returns its length, or 0 on failure
+uint64_t compress(const Case& c, std::vector<uint8_t>& out,
+                  std::vector<std::vector<int32_t>>& original)
+{
+  auto image = makeImage(c.numComps);
+  if(!image)
+    return 0;
+  original = samplesOf(image);
+  grk_cparameters parameters;
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_JP2;
+  parameters.irreversible = c.irreversible;
+  parameters.numresolution = 5;
+  parameters.cblockw_init = 32;
+  parameters.cblockh_init = 32;
+  parameters.cblk_sty = c.cblkSty;
+  if(c.tileSize)
+  {
+    parameters.tile_size_on = true;
+    parameters.t_width = c.tileSize;
+    parameters.t_height = c.tileSize;
+  }
+  if(c.precincts)
+  {
+    parameters.csty |= 0x01;
+    parameters.res_spec = 2;
+    parameters.prcw_init[0] = parameters.prch_init[0] = 64;
+    parameters.prcw_init[1] = parameters.prch_init[1] = 32;
+  }
+  parameters.numlayers = NUM_LAYERS;
+  for(uint16_t i = 0; i < NUM_LAYERS - 1; ++i)
+    parameters.layer_rate[i] = 160.0 / (1 << i);
+  parameters.layer_rate[NUM_LAYERS - 1] = 0;
+  parameters.allocation_by_rate_distortion = true;
+
+  out.assign((size_t)c.numComps * WIDTH * HEIGHT * 2 + 4096, 0);
+  grk_stream_params streamParams = {};
+  streamParams.buf = out.data();
+  streamParams.buf_len = out.size();
+  uint64_t length = 0;
+  auto codec = grk_compress_init(&streamParams, &parameters, image);
+  if(codec)
+    length = grk_compress(codec, nullptr);
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  out.resize(length);
+
+  return length;
+}
+
+// truncates a Part 1 file to targetSize; returns its length, or 0 on failure
+uint64_t transcode(std::vector<uint8_t>& src, uint64_t targetSize, std::vector<uint8_t>& out)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params headerStream = {};
+  headerStream.is_read_stream = true;
+  headerStream.buf = src.data();
+  headerStream.buf_len = src.size();
+  auto codec = grk_decompress_init(&headerStream, &params);
+  if(!codec)
+    return 0;
+  grk_header_info headerInfo = {};
+  uint64_t length = 0;
+  grk_image* image = nullptr;
+  if(grk_decompress_read_header(codec, &headerInfo))
+    image = grk_decompress_get_image(codec);
+  if(image)
+  {
+    grk_cparameters parameters;
+    grk_compress_set_default_params(&parameters);
+    parameters.cod_format = GRK_FMT_JP2;
+    parameters.transcode_target_size = targetSize;
+    grk_stream_params srcStream = {};
+    srcStream.buf = src.data();
+    srcStream.buf_len = src.size();
+    out.assign(src.size() + 4096, 0);
+    grk_stream_params dstStream = {};
+    dstStream.buf = out.data();
+    dstStream.buf_len = out.size();
+    length = grk_transcode(&srcStream, &dstStream, &parameters, image);
+    out.resize(length);
+  }
+  grk_object_unref(codec);
+
+  return length;
+}
+
+// decompresses a file and returns its PSNR against the original, or a negative value
+double psnr(std::vector<uint8_t>& file, const std::vector<std::vector<int32_t>>& original)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  streamParams.buf = file.data();
+  streamParams.buf_len = file.size();
+  auto codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return -1;
+  grk_header_info headerInfo = {};
+  double rc = -1;
+  if(grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr))
+  {
+    auto image = grk_decompress_get_image(codec);
+    bool ok = image && image->numcomps == original.size();
+    for(uint16_t compno = 0; ok && compno < image->numcomps; ++compno)
+    {
+      const auto& comp = image->comps[compno];
+      ok = comp.data && comp.w == WIDTH && comp.h == HEIGHT;
+    }
+    if(ok)
+    {
+      auto decoded = samplesOf(image);
+      double sse = 0;
+      size_t count = 0;
+      for(size_t compno = 0; compno < original.size(); ++compno)
+      {
+        for(size_t i = 0; i < original[compno].size(); ++i)
+        {
+          double d = decoded[compno][i] - original[compno][i];
+          sse += d * d;
+        }
+        count += original[compno].size();
+      }
+      double mse = sse / (double)count;
+      rc = mse > 0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 100.0;
+    }
+  }
+  grk_object_unref(codec);
+
+  return rc;
+}
+
+bool check(const Case& c)
+{
+  std::vector<uint8_t> source;
+  std::vector<std::vector<int32_t>> original;
+  if(!compress(c, source, original))
+  {
+    fprintf(stderr, "%s: compress failed\n", c.label);
+    return false;
+  }
+  double sourcePsnr = psnr(source, original);
+  if(sourcePsnr < 0)
+  {
+    fprintf(stderr, "%s: source decompress failed\n", c.label);
+    return false;
+  }
+  printf("%s: %zu source bytes, PSNR %.2f dB\n", c.label, source.size(), sourcePsnr);
+
+  // from coarse to fine, quality must not fall as the target grows
+  double previousPsnr = 0;
+  for(uint32_t divisor : {16U, 8U, 4U, 2U})
+  {
+    uint64_t target = source.size() / divisor;
+    std::vector<uint8_t> truncated;
+    if(!transcode(source, target, truncated))
+    {
+      fprintf(stderr, "%s: transcode to %llu bytes failed\n", c.label,
+              (unsigned long long)target);
+      return false;
+    }
+    if(truncated.size() > target + OVERHEAD || truncated.size() >= source.size())
+    {
+      fprintf(stderr, "%s: transcode to %llu bytes wrote %zu bytes\n", c.label,
+              (unsigned long long)target, truncated.size());
+      return false;
+    }
+    double truncatedPsnr = psnr(truncated, original);
+    if(truncatedPsnr < 0)
+    {
+      fprintf(stderr, "%s: decompress of %zu byte transcode failed\n", c.label,
+              truncated.size());
+      return false;
+    }
+    if(truncatedPsnr + 0.01 < previousPsnr || truncatedPsnr > sourcePsnr + 0.01)
+    {
+      fprintf(stderr, "%s: %zu byte transcode has PSNR %.2f dB, after %.2f dB\n", c.label,
+              truncated.size(), truncatedPsnr, previousPsnr);
+      return false;
+    }
+    printf("%s: target %llu, %zu bytes, PSNR %.2f dB\n", c.label, (unsigned long long)target,
+           truncated.size(), truncatedPsnr);
+    previousPsnr = truncatedPsnr;
+  }
+
+  return true;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  const Case cases[] = {
+      {"reversible_gray", 1, false, 0, false, 0},
+      {"irreversible_rgb", 3, true, 0, false, 0},
+      {"reversible_tiled_precincts", 3, false, 128, true, 0},
+      {"irreversible_bypass_termall", 1, true, 100, false,
+       GRK_CBLKSTY_LAZY | GRK_CBLKSTY_TERMALL},
+  };
+  bool ok = true;
+  for(const auto& c : cases)
+    ok = check(c) && ok;
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// a decompress with a band callback and a window only schedules the tile rows the window
+// crosses, and hands each one over clipped to the window: stacked up, the bands must
+// equal a windowed decompress into a whole image, row for row, for windows that start
+// and end inside a tile row, that fit in a single tile row, and at a reduced resolution.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t IMAGE_WIDTH = 211;
+const uint32_t IMAGE_HEIGHT = 167;
+const uint32_t TILE_WIDTH = 64;
+const uint32_t TILE_HEIGHT = 48;
+const uint16_t NUM_COMPS = 3;
+const uint8_t PREC = 12;
+const uint8_t NUM_RESOLUTIONS = 5;
+
+struct Config
+{
+  const char* label;
+  uint8_t reduce;
+  // decompress window, or all zero for the whole image
+  double window[4];
+};
+
+// rows of each component, in the order the band callback delivered them
+struct Bands
+{
+  std::vector<std::vector<int32_t>> rows[NUM_COMPS];
+  uint32_t width[NUM_COMPS] = {};
+  uint32_t numBands = 0;
+};
+
+void reportLog(const char* message, void*)
+{
+  fprintf(stderr, "%s\n", message);
+}
+
+int32_t sampleAt(const grk_image_comp& comp, uint64_t index)
+{
+  if(comp.data_type == GRK_INT_16)
+    return static_cast<int16_t*>(comp.data)[index];
+  return static_cast<int32_t*>(comp.data)[index];
+}
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = IMAGE_WIDTH;
+    p.h = IMAGE_HEIGHT;
+    p.prec = PREC;
+    p.sgnd = false;
+  }
+  grk_image* image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto* data = static_cast<int32_t*>(image->comps[compno].data);
+    uint32_t stride = image->comps[compno].stride;
+    for(uint32_t y = 0; y < IMAGE_HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < IMAGE_WIDTH; ++x)
+      {
+        uint32_t noise = ((x * 2654435761U) ^ (y * 40503U) ^ (compno * 97U)) >> 26;
+        data[(size_t)y * stride + x] =
+            (int32_t)((x * 7U + y * (5U + compno * 3U) + noise) & 0xFFF);
+      }
+    }
+  }
+  return image;
+}
+
+bool compress(const std::string& path)
+{
+  grk_image* image = makeImage();
+  if(!image)
+  {
+    fprintf(stderr, "could not build the source image\n");
+    return false;
+  }
+  grk_cparameters parameters = {};
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = NUM_RESOLUTIONS;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_WIDTH;
+  parameters.t_height = TILE_HEIGHT;
+  grk_stream_params streamParams = {};
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_compress_init(&streamParams, &parameters, image);
+  bool ok = codec && grk_compress(codec, nullptr) != 0;
+  if(!ok)
+    fprintf(stderr, "compress failed\n");
+  grk_object_unref(codec);
+  grk_object_unref(&image->obj);
+  return ok;
+}
+
+bool collectBand(uint32_t yBegin, uint32_t yEnd, grk_image* image, void* userData)
+{
+  auto bands = static_cast<Bands*>(userData);
+  if(!image || image->numcomps != NUM_COMPS)
+    return false;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    const auto& comp = image->comps[compno];
+    if(!comp.data)
+      return false;
+    bands->width[compno] = comp.w;
+    for(uint32_t y = yBegin; y < yEnd; ++y)
+    {
+      std::vector<int32_t> row(comp.w);
+      for(uint32_t x = 0; x < comp.w; ++x)
+        row[x] = sampleAt(comp, (uint64_t)y * comp.stride + x);
+      bands->rows[compno].push_back(std::move(row));
+    }
+  }
+  bands->numBands++;
+  return true;
+}
+
+grk_object* openCodec(const std::string& path, const Config& config, Bands* bands)
+{
+  grk_decompress_parameters params = {};
+  params.core.reduce = config.reduce;
+  params.dw_x0 = config.window[0];
+  params.dw_y0 = config.window[1];
+  params.dw_x1 = config.window[2];
+  params.dw_y1 = config.window[3];
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  snprintf(streamParams.file, sizeof(streamParams.file), "%s", path.c_str());
+  grk_object* codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return nullptr;
+  grk_header_info headerInfo = {};
+  if(!grk_decompress_read_header(codec, &headerInfo))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  if(bands)
+    grk_decompress_set_band_callback(codec, collectBand, bands);
+  if(!grk_decompress(codec, nullptr))
+  {
+    grk_object_unref(codec);
+    return nullptr;
+  }
+  return codec;
+}
+
+bool compare(const Config& config, const Bands& bands, const grk_image* reference)
+{
+  if(!reference || reference->numcomps != NUM_COMPS)
+  {
+    fprintf(stderr, "%s: reference image is missing\n", config.label);
+    return false;
+  }
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    const auto& comp = reference->comps[compno];
+    const auto& rows = bands.rows[compno];
+    if(rows.size() != comp.h || bands.width[compno] != comp.w)
+    {
+      fprintf(stderr, "%s: component %u bands cover %ux%zu, window is %ux%u\n", config.label,
+              compno, bands.width[compno], rows.size(), comp.w, comp.h);
+      return false;
+    }
+    for(uint32_t y = 0; y < comp.h; ++y)
+    {
+      for(uint32_t x = 0; x < comp.w; ++x)
+      {
+        int32_t expected = sampleAt(comp, (uint64_t)y * comp.stride + x);
+        if(rows[y][x] != expected)
+        {
+          fprintf(stderr, "%s: component %u sample (%u,%u) is %d in the bands, %d in the image\n",
+                  config.label, compno, x, y, rows[y][x], expected);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool check(const std::string& path, const Config& config)
+{
+  Bands bands;
+  grk_object* codec = openCodec(path, config, &bands);
+  grk_object* refCodec = openCodec(path, config, nullptr);
+  bool ok = codec && refCodec;
+  if(!ok)
+    fprintf(stderr, "%s: decompress failed\n", config.label);
+  else
+    ok = compare(config, bands, grk_decompress_get_image(refCodec));
+  grk_object_unref(refCodec);
+  grk_object_unref(codec);
+  if(ok)
+    printf("%s: %u bands match the windowed image\n", config.label, bands.numBands);
+  return ok;
+}
+} // namespace
+
+int main(void)
+{
+  grk_initialize(nullptr, 0, nullptr);
+  grk_msg_handlers handlers = {};
+  handlers.error_callback = reportLog;
+  grk_set_msg_handlers(handlers);
+
+  std::string path = "windowed_band.j2k";
+  bool ok = compress(path);
+  if(ok)
+  {
+    const Config configs[] = {
+        {"full", 0, {0, 0, 0, 0}},
+        {"window", 0, {13, 9, 190, 150}},
+        {"single_tile_row", 0, {70, 50, 100, 60}},
+        {"reduced_window", 1, {13, 9, 190, 150}},
+    };
+    for(const auto& config : configs)
+      ok = check(path, config) && ok;
+  }
+  remove(path.c_str());
+
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
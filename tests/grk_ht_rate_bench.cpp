@@ -0,0 +1,156 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// HTJ2K compress throughput at fixed compression ratios, against an unconstrained
+// compress, for a synthetic RGB image. Usage: grk_ht_rate_bench [iterations] [threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+const uint32_t WIDTH = 3840;
+const uint32_t HEIGHT = 2160;
+const uint16_t NUM_COMPS = 3;
+const uint8_t PRECISION = 8;
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = WIDTH;
+    p.h = HEIGHT;
+    p.prec = PRECISION;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  uint32_t state = 0x9e3779b9u;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto comp = image->comps + compno;
+    auto data = (int32_t*)comp->data;
+    for(uint32_t y = 0; y < HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < WIDTH; ++x)
+      {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        double v = 96.0 + 0.02 * x + 0.03 * y +
+                   40.0 * std::sin(x * 0.013 + compno) * std::cos(y * 0.011) +
+                   (double)(state % 16);
+        data[(size_t)y * comp->stride + x] = std::clamp((int32_t)v, 0, 255);
+      }
+    }
+  }
+  return image;
+}
+
+// best of iters compress times in seconds, or a negative value on failure
+double timeCompress(grk_image* image, double ratio, uint32_t iters, std::vector<uint8_t>& buf,
+                    uint64_t& length)
+{
+  double best = -1;
+  for(uint32_t i = 0; i < iters; ++i)
+  {
+    grk_cparameters parameters;
+    grk_compress_set_default_params(&parameters);
+    parameters.cod_format = GRK_FMT_J2K;
+    parameters.cblk_sty = GRK_CBLKSTY_HT_ONLY;
+    parameters.irreversible = true;
+    parameters.numlayers = 1;
+    parameters.layer_rate[0] = ratio;
+    parameters.allocation_by_rate_distortion = true;
+
+    grk_stream_params streamParams = {};
+    streamParams.buf = buf.data();
+    streamParams.buf_len = buf.size();
+    auto start = std::chrono::steady_clock::now();
+    auto codec = grk_compress_init(&streamParams, &parameters, image);
+    length = codec ? grk_compress(codec, nullptr) : 0;
+    grk_object_unref(codec);
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(!length)
+      return -1;
+    if(best < 0 || seconds < best)
+      best = seconds;
+  }
+  return best;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint32_t iters = 5;
+  uint32_t threads = 0;
+  if(argc > 1)
+    iters = std::max(1, atoi(argv[1]));
+  if(argc > 2)
+    threads = (uint32_t)atoi(argv[2]);
+  grk_initialize(nullptr, threads, nullptr);
+
+  auto image = makeImage();
+  if(!image)
+  {
+    grk_deinitialize();
+    return 1;
+  }
+  std::vector<uint8_t> buf((size_t)NUM_COMPS * WIDTH * HEIGHT * 2);
+  const double megapixels = (double)WIDTH * HEIGHT / 1e6;
+  const double ratios[] = {0, 4, 10, 20, 50, 100};
+
+  printf("HTJ2K 9/7 compress of %ux%u RGB, best of %u runs\n", WIDTH, HEIGHT, iters);
+  printf("%8s %12s %12s %10s %10s\n", "ratio", "bytes", "target", "ms", "MP/s");
+  bool ok = true;
+  double unconstrained = 0;
+  for(auto ratio : ratios)
+  {
+    uint64_t length = 0;
+    double seconds = timeCompress(image, ratio, iters, buf, length);
+    if(seconds < 0)
+    {
+      printf("%8.0f compress failed\n", ratio);
+      ok = false;
+      continue;
+    }
+    if(ratio == 0)
+      unconstrained = seconds;
+    uint64_t target = ratio > 0 ? (uint64_t)(buf.size() / 2 / ratio) : 0;
+    printf("%8.0f %12llu %12llu %10.1f %10.1f", ratio, (unsigned long long)length,
+           (unsigned long long)target, seconds * 1e3, megapixels / seconds);
+    if(ratio > 0 && unconstrained > 0)
+      printf("  (%.2fx unconstrained time)", seconds / unconstrained);
+    printf("\n");
+  }
+
+  grk_object_unref(&image->obj);
+  grk_deinitialize();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Benchmark of the custom (Part 2) inverse MCT (grk_bench_mct_custom hook): the
+// per-sample reference loop vs the blocked SIMD kernel, on one thread and over row
+// strips on all threads. Synthetic float components, 16, 64 and 224 of them.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" double grk_bench_mct_custom(uint16_t numcomps, uint32_t width, uint32_t height,
+                                       uint32_t mode, uint32_t iters);
+
+static void formatRate(char* buf, size_t len, double megapixels, double seconds)
+{
+  if(seconds > 0)
+    snprintf(buf, len, "%.1f", megapixels / seconds);
+  else
+    snprintf(buf, len, "n/a");
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t iters = 5;
+  if(argc > 1)
+    iters = (uint32_t)atoi(argv[1]);
+  const uint32_t width = 1024;
+  const uint32_t height = 1024;
+  const uint16_t numComps[] = {16, 64, 224};
+
+  printf("custom inverse MCT, %ux%u, best of %u runs, megapixels/s\n", width, height, iters);
+  printf("%-6s %12s %12s %12s\n", "comps", "reference", "simd", "simd+mt");
+  double mp = (double)width * height / 1e6;
+  for(auto n : numComps)
+  {
+    char rates[3][32];
+    for(uint32_t mode = 0; mode < 3; ++mode)
+      formatRate(rates[mode], sizeof(rates[mode]), mp,
+                 grk_bench_mct_custom(n, width, height, mode, iters));
+    printf("%-6u %12s %12s %12s\n", n, rates[0], rates[1], rates[2]);
+  }
+  return 0;
+}
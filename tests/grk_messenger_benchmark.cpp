@@ -0,0 +1,184 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Multi-process loopback benchmark for the shared memory Messenger transports.
+ *
+ * Usage:
+ *   grk_messenger_benchmark [--quick] [num_messages]  — client mode: benchmarks each transport
+ *   grk_messenger_benchmark --server                  — server mode: echoes every message
+ *
+ * For each transport (semaphore, then ring) the client launches the server as a
+ * child process, streams num_messages GRK_MSGR_BATCH_SUBMIT_UNCOMPRESSED messages
+ * and waits for one GRK_MSGR_BATCH_PROCESSED_UNCOMPRESSED reply per message, so
+ * every message crosses the control plane twice. Messages per second counts both
+ * directions. The server inherits GRK_MESSENGER_RING, which selects its transport.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Messenger.h"
+
+using namespace grk_plugin;
+using namespace std::chrono_literals;
+
+static const uint32_t DEFAULT_NUM_MESSAGES = 100000;
+static const uint32_t QUICK_NUM_MESSAGES = 2000;
+
+/*************************** Server Mode *******************************/
+static int runServer()
+{
+  setMessengerLogger(new MessengerLogger("[Server] "));
+
+  std::mutex doneMutex;
+  std::condition_variable doneCondition;
+  bool done = false;
+  Messenger* server = nullptr;
+
+  auto proc = [&](const std::string& str) {
+    Msg msg(str);
+    auto tag = msg.next();
+    if(tag == GRK_MSGR_BATCH_SUBMIT_UNCOMPRESSED)
+    {
+      msg.nextUint(); // client frame id
+      server->send(GRK_MSGR_BATCH_PROCESSED_UNCOMPRESSED, msg.nextUint());
+    }
+    else if(tag == GRK_MSGR_BATCH_SHUTDOWN)
+    {
+      std::lock_guard<std::mutex> lk(doneMutex);
+      done = true;
+      doneCondition.notify_one();
+    }
+  };
+
+  // no frame buffers: only the control plane is measured
+  MessengerInit init(false, grokToClientMessageBuf, grokSentSynch, clientReceiveReadySynch,
+                     clientToGrokMessageBuf, clientSentSynch, grokReceiveReadySynch, proc, 1, 0, 0,
+                     0);
+  server = new Messenger(init);
+  server->send(GRK_MSGR_BATCH_COMPRESS_INIT, 0, 0, 0, 0, 0, 0, 0);
+  {
+    std::unique_lock<std::mutex> lk(doneMutex);
+    doneCondition.wait(lk, [&] { return done; });
+  }
+  delete server;
+  return 0;
+}
+
+/*************************** Client Mode *******************************/
+static bool runTransport(const char* selfPath, MessengerTransport transport, uint32_t numMessages)
+{
+  const char* label = transport == MESSENGER_TRANSPORT_RING ? "ring" : "semaphore";
+#ifdef _WIN32
+  _putenv_s("GRK_MESSENGER_RING", transport == MESSENGER_TRANSPORT_RING ? "1" : "0");
+#else
+  setenv("GRK_MESSENGER_RING", transport == MESSENGER_TRANSPORT_RING ? "1" : "0", 1);
+#endif
+
+  std::atomic<uint32_t> replies{0};
+  std::mutex completeMutex;
+  std::condition_variable completeCondition;
+
+  auto proc = [&](const std::string& str) {
+    Msg msg(str);
+    if(msg.next() != GRK_MSGR_BATCH_PROCESSED_UNCOMPRESSED)
+      return;
+    if(++replies == numMessages)
+    {
+      std::lock_guard<std::mutex> lk(completeMutex);
+      completeCondition.notify_one();
+    }
+  };
+
+  MessengerInit init(true, clientToGrokMessageBuf, clientSentSynch, grokReceiveReadySynch,
+                     grokToClientMessageBuf, grokSentSynch, clientReceiveReadySynch, proc, 1);
+  auto messenger = new Messenger(init);
+
+  std::string serverCmd = std::string(selfPath) + " --server";
+  if(!messenger->launch(serverCmd, "") || !messenger->waitForClientInit())
+  {
+    getMessengerLogger()->error("%s: server did not start", label);
+    delete messenger;
+    return false;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for(uint32_t i = 0; i < numMessages; ++i)
+    messenger->send(GRK_MSGR_BATCH_SUBMIT_UNCOMPRESSED, i, i);
+  bool complete;
+  {
+    std::unique_lock<std::mutex> lk(completeMutex);
+    complete =
+        completeCondition.wait_for(lk, 120s, [&] { return replies.load() >= numMessages; });
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  messenger->send(GRK_MSGR_BATCH_SHUTDOWN);
+  int result = messenger->async_result_.valid() ? messenger->async_result_.get() : 0;
+  delete messenger;
+
+  if(!complete)
+  {
+    getMessengerLogger()->error("%s: timeout with %u of %u replies", label, replies.load(),
+                                numMessages);
+    return false;
+  }
+  if(result != 0)
+  {
+    getMessengerLogger()->error("%s: server exited with code %d", label, result);
+    return false;
+  }
+  fprintf(stdout, "%-10s %8u round trips in %8.3f s: %12.0f messages/s\n", label, numMessages,
+          elapsed.count(), 2.0 * numMessages / elapsed.count());
+  return true;
+}
+
+static int runClient(const char* selfPath, uint32_t numMessages)
+{
+  setMessengerLogger(new MessengerLogger("[Client] "));
+  bool ok = runTransport(selfPath, MESSENGER_TRANSPORT_SEMAPHORE, numMessages);
+  ok = runTransport(selfPath, MESSENGER_TRANSPORT_RING, numMessages) && ok;
+  return ok ? 0 : 1;
+}
+
+/*************************** Main *******************************/
+int main(int argc, char** argv)
+{
+  if(argc > 1 && std::string(argv[1]) == "--server")
+    return runServer();
+
+  uint32_t numMessages = DEFAULT_NUM_MESSAGES;
+  for(int i = 1; i < argc; ++i)
+  {
+    if(std::string(argv[i]) == "--quick")
+      numMessages = QUICK_NUM_MESSAGES;
+    else
+      numMessages = (uint32_t)std::strtoul(argv[i], nullptr, 10);
+  }
+  if(!numMessages)
+    numMessages = DEFAULT_NUM_MESSAGES;
+
+  return runClient(argv[0], numMessages);
+}
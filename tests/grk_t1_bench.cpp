@@ -0,0 +1,76 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Per-pass benchmark of the Part-1 block decoder (grk_bench_t1_passes hook):
+// significance propagation, magnitude refinement and cleanup times for one
+// synthetic code block, across block sizes, coefficient densities and code
+// block styles. Single-threaded; every configuration is also checked for
+// exact reconstruction, so a non-zero exit code flags a decoder mismatch.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "grok.h"
+
+extern "C" double grk_bench_t1_passes(uint16_t width, uint16_t height, uint32_t cblksty,
+                                      uint32_t density, uint32_t iters, double* passSeconds);
+
+int main(int argc, char** argv)
+{
+  uint32_t iters = 200;
+  if(argc > 1)
+    iters = (uint32_t)atoi(argv[1]);
+  const uint16_t sizes[][2] = {{64, 64}, {32, 32}, {1024, 4}, {61, 45}};
+  const uint32_t densities[] = {100, 25, 5};
+  const struct
+  {
+    const char* name;
+    uint32_t cblksty;
+  } styles[] = {
+      {"default", 0},
+      {"vsc", GRK_CBLKSTY_VSC},
+      {"termall", GRK_CBLKSTY_TERMALL | GRK_CBLKSTY_RESET},
+  };
+
+  printf("Part-1 code block decode, single thread, best of %u runs, microseconds\n", iters);
+  printf("%-9s %-8s %7s %10s %10s %10s %10s\n", "size", "style", "density", "sigprop", "magref",
+         "cleanup", "total");
+  bool ok = true;
+  for(auto& wh : sizes)
+  {
+    char sizeStr[24];
+    snprintf(sizeStr, sizeof(sizeStr), "%ux%u", wh[0], wh[1]);
+    for(auto& style : styles)
+    {
+      for(auto density : densities)
+      {
+        double passSeconds[3] = {};
+        double total =
+            grk_bench_t1_passes(wh[0], wh[1], style.cblksty, density, iters, passSeconds);
+        if(total < 0)
+        {
+          printf("%-9s %-8s %6u%% decode mismatch\n", sizeStr, style.name, density);
+          ok = false;
+          continue;
+        }
+        printf("%-9s %-8s %6u%% %10.2f %10.2f %10.2f %10.2f\n", sizeStr, style.name, density,
+               passSeconds[0] * 1e6, passSeconds[1] * 1e6, passSeconds[2] * 1e6, total * 1e6);
+      }
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+/*
+ *    Copyright (C) 2016-2026 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Benchmark of the shared packet order tables (GRK_NO_PACKET_ORDER_TABLES):
+// compress, with rate control, and decompress of a synthetic image with about 10k small
+// tiles, several layers and resolutions, with each tile driving its own PacketIter vs
+// walking the table its geometry shares. The tiles are small, so T2 is a large part of
+// the time.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "grok.h"
+
+namespace
+{
+void usePacketOrderTables(bool on)
+{
+#if defined(_WIN32)
+  _putenv_s("GRK_NO_PACKET_ORDER_TABLES", on ? "" : "1");
+#else
+  if(on)
+    unsetenv("GRK_NO_PACKET_ORDER_TABLES");
+  else
+    setenv("GRK_NO_PACKET_ORDER_TABLES", "1", 1);
+#endif
+}
+
+const uint32_t WIDTH = 1600;
+const uint32_t HEIGHT = 1600;
+const uint32_t TILE_SIZE = 16;
+const uint16_t NUM_COMPS = 3;
+const uint16_t NUM_LAYERS = 4;
+
+grk_image* makeImage(void)
+{
+  grk_image_comp params[NUM_COMPS] = {};
+  for(auto& p : params)
+  {
+    p.dx = 1;
+    p.dy = 1;
+    p.w = WIDTH;
+    p.h = HEIGHT;
+    p.prec = 8;
+    p.sgnd = false;
+  }
+  auto image = grk_image_new(NUM_COMPS, params, GRK_CLRSPC_SRGB, true);
+  if(!image)
+    return nullptr;
+  uint32_t state = 0x9e3779b9u;
+  for(uint16_t compno = 0; compno < NUM_COMPS; ++compno)
+  {
+    auto comp = image->comps + compno;
+    auto data = (int32_t*)comp->data;
+    for(uint32_t y = 0; y < HEIGHT; ++y)
+    {
+      for(uint32_t x = 0; x < WIDTH; ++x)
+      {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[(size_t)y * comp->stride + x] = (int32_t)((x + y + compno * 40 + (state & 15)) & 255);
+      }
+    }
+  }
+  return image;
+}
+
+// compresses the image; returns seconds, or a negative value on failure
+double compress(grk_image* image, std::vector<uint8_t>& out)
+{
+  grk_cparameters parameters;
+  grk_compress_set_default_params(&parameters);
+  parameters.cod_format = GRK_FMT_J2K;
+  parameters.numresolution = 4;
+  parameters.cblockw_init = 16;
+  parameters.cblockh_init = 16;
+  parameters.tile_size_on = true;
+  parameters.t_width = TILE_SIZE;
+  parameters.t_height = TILE_SIZE;
+  parameters.numlayers = NUM_LAYERS;
+  for(uint16_t i = 0; i < NUM_LAYERS - 1; ++i)
+    parameters.layer_rate[i] = 80.0 / (1 << i);
+  parameters.layer_rate[NUM_LAYERS - 1] = 0;
+  parameters.allocation_by_rate_distortion = true;
+
+  out.assign((size_t)NUM_COMPS * WIDTH * HEIGHT * 2, 0);
+  grk_stream_params streamParams = {};
+  streamParams.buf = out.data();
+  streamParams.buf_len = out.size();
+  auto start = std::chrono::high_resolution_clock::now();
+  uint64_t length = 0;
+  auto codec = grk_compress_init(&streamParams, &parameters, image);
+  if(codec)
+    length = grk_compress(codec, nullptr);
+  grk_object_unref(codec);
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+  out.resize(length);
+
+  return length ? elapsed.count() : -1;
+}
+
+// decompresses a code stream; returns seconds, or a negative value on failure
+double decompress(std::vector<uint8_t>& file)
+{
+  grk_decompress_parameters params = {};
+  grk_stream_params streamParams = {};
+  streamParams.is_read_stream = true;
+  streamParams.buf = file.data();
+  streamParams.buf_len = file.size();
+  auto start = std::chrono::high_resolution_clock::now();
+  auto codec = grk_decompress_init(&streamParams, &params);
+  if(!codec)
+    return -1;
+  grk_header_info headerInfo = {};
+  bool ok = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+  grk_object_unref(codec);
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return ok ? elapsed.count() : -1;
+}
+
+void formatTime(char* buf, size_t len, double seconds)
+{
+  if(seconds >= 0)
+    snprintf(buf, len, "%.1f", seconds * 1000);
+  else
+    snprintf(buf, len, "failed");
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  uint32_t iters = 3;
+  if(argc > 1)
+    iters = (uint32_t)atoi(argv[1]);
+  grk_initialize(nullptr, 0, nullptr);
+  auto image = makeImage();
+  if(!image)
+    return 1;
+
+  printf("T2 packet order tables, %ux%u, %ux%u tiles (%u), %u layers, best of %u runs, ms\n",
+         WIDTH, HEIGHT, TILE_SIZE, TILE_SIZE,
+         ((WIDTH + TILE_SIZE - 1) / TILE_SIZE) * ((HEIGHT + TILE_SIZE - 1) / TILE_SIZE),
+         NUM_LAYERS, iters);
+  printf("%-12s %12s %12s\n", "", "iterator", "tables");
+  double compressTimes[2] = {-1, -1};
+  double decompressTimes[2] = {-1, -1};
+  for(uint32_t tables = 0; tables < 2; ++tables)
+  {
+    usePacketOrderTables(tables != 0);
+    for(uint32_t i = 0; i < iters; ++i)
+    {
+      std::vector<uint8_t> file;
+      double c = compress(image, file);
+      double d = c >= 0 ? decompress(file) : -1;
+      if(c >= 0 && (compressTimes[tables] < 0 || c < compressTimes[tables]))
+        compressTimes[tables] = c;
+      if(d >= 0 && (decompressTimes[tables] < 0 || d < decompressTimes[tables]))
+        decompressTimes[tables] = d;
+    }
+  }
+  char times[4][32];
+  formatTime(times[0], sizeof(times[0]), compressTimes[0]);
+  formatTime(times[1], sizeof(times[1]), compressTimes[1]);
+  formatTime(times[2], sizeof(times[2]), decompressTimes[0]);
+  formatTime(times[3], sizeof(times[3]), decompressTimes[1]);
+  printf("%-12s %12s %12s\n", "compress", times[0], times[1]);
+  printf("%-12s %12s %12s\n", "decompress", times[2], times[3]);
+  usePacketOrderTables(true);
+
+  grk_object_unref(&image->obj);
+  grk_deinitialize();
+  return 0;
+}